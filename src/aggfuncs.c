@@ -54,6 +54,10 @@ Datum pgstrom_covariance_float8_accum(PG_FUNCTION_ARGS);
 Datum pgstrom_int8_avg_accum(PG_FUNCTION_ARGS);
 Datum pgstrom_numeric_avg_accum(PG_FUNCTION_ARGS);
 Datum pgstrom_numeric_avg_final(PG_FUNCTION_ARGS);
+Datum pgstrom_sum_numeric_fixed_accum(PG_FUNCTION_ARGS);
+Datum pgstrom_avg_numeric_fixed_accum(PG_FUNCTION_ARGS);
+Datum pgstrom_sum_numeric_fixed_final(PG_FUNCTION_ARGS);
+Datum pgstrom_avg_numeric_fixed_final(PG_FUNCTION_ARGS);
 Datum pgstrom_numeric_var_accum(PG_FUNCTION_ARGS);
 Datum pgstrom_numeric_var_samp(PG_FUNCTION_ARGS);
 Datum pgstrom_numeric_var_pop(PG_FUNCTION_ARGS);
@@ -441,6 +445,168 @@ pgstrom_numeric_avg_final(PG_FUNCTION_ARGS)
 }
 PG_FUNCTION_INFO_V1(pgstrom_numeric_avg_final);
 
+/*
+ * numeric_fixed_state - internal state of sum/avg(numeric) being
+ * processed in fixed-point. GpuPreAgg gives partial sums of the upper
+ * and the lower 32bits of X * 10^scale, then we accumulate them with
+ * carry. The accumulated value is moved to numeric on demand, prior to
+ * the overflow of 64bit integer.
+ */
+typedef struct
+{
+	int64	N;
+	int64	sum_hi;
+	int64	sum_lo;
+	int32	scale;
+	bool	has_value;
+	Datum	sumX;		/* numeric; carried over from sum_hi/sum_lo */
+} numeric_fixed_state;
+
+#define NUMERIC_FIXED_HI_LIMIT		(INT64CONST(1) << 62)
+
+static Datum
+numeric_fixed_merge(numeric_fixed_state *state)
+{
+	Datum	vHi = DirectFunctionCall1(int8_numeric,
+									  Int64GetDatum(state->sum_hi));
+	Datum	vLo = DirectFunctionCall1(int8_numeric,
+									  Int64GetDatum(state->sum_lo));
+	Datum	vShift = DirectFunctionCall1(int8_numeric,
+										 Int64GetDatum(INT64CONST(1) << 32));
+	Datum	temp;
+
+	temp = DirectFunctionCall2(numeric_mul, vHi, vShift);
+	temp = DirectFunctionCall2(numeric_add, temp, vLo);
+	return DirectFunctionCall2(numeric_add, state->sumX, temp);
+}
+
+static numeric_fixed_state *
+numeric_fixed_accum(FunctionCallInfo fcinfo, int32 nrows, int argbase)
+{
+	MemoryContext	aggcxt;
+	MemoryContext	oldcxt;
+	numeric_fixed_state *state;
+
+	if (!AggCheckCallContext(fcinfo, &aggcxt))
+		elog(ERROR, "aggregate function called in non-aggregate context");
+
+	oldcxt = MemoryContextSwitchTo(aggcxt);
+	state = PG_ARGISNULL(0) ? NULL : (numeric_fixed_state *)PG_GETARG_POINTER(0);
+	if (!state)
+	{
+		state = palloc0(sizeof(numeric_fixed_state));
+		state->scale = PG_GETARG_INT32(argbase + 2);
+		state->sumX = DirectFunctionCall3(numeric_in,
+										  CStringGetDatum("0"),
+										  ObjectIdGetDatum(0),
+										  Int32GetDatum(-1));
+	}
+
+	if (nrows > 0 && !PG_ARGISNULL(argbase) && !PG_ARGISNULL(argbase + 1))
+	{
+		state->N += nrows;
+		state->sum_hi += PG_GETARG_INT64(argbase);
+		state->sum_lo += PG_GETARG_INT64(argbase + 1);
+		/* carry; partial sum of the lower 32bits is never negative */
+		state->sum_hi += (state->sum_lo >> 32);
+		state->sum_lo &= INT64CONST(0xffffffff);
+		state->has_value = true;
+
+		if (state->sum_hi > NUMERIC_FIXED_HI_LIMIT ||
+			state->sum_hi < -NUMERIC_FIXED_HI_LIMIT)
+		{
+			state->sumX = numeric_fixed_merge(state);
+			state->sum_hi = 0;
+			state->sum_lo = 0;
+		}
+	}
+	MemoryContextSwitchTo(oldcxt);
+
+	return state;
+}
+
+static Datum
+numeric_fixed_total(numeric_fixed_state *state)
+{
+	Datum	sumX = numeric_fixed_merge(state);
+	char	buf[80];
+
+	if (state->scale > 0)
+	{
+		Datum	vScale;
+
+		if (state->scale >= sizeof(buf) - 2)
+			elog(ERROR, "Bug? too large scale of fixed-point numeric: %d",
+				 state->scale);
+		/* multiply 10^(-scale) to restore the original scale */
+		buf[0] = '0';
+		buf[1] = '.';
+		memset(buf + 2, '0', state->scale - 1);
+		buf[state->scale + 1] = '1';
+		buf[state->scale + 2] = '\0';
+		vScale = DirectFunctionCall3(numeric_in,
+									 CStringGetDatum(buf),
+									 ObjectIdGetDatum(0),
+									 Int32GetDatum(-1));
+		sumX = DirectFunctionCall2(numeric_mul, sumX, vScale);
+	}
+	return sumX;
+}
+
+Datum
+pgstrom_sum_numeric_fixed_accum(PG_FUNCTION_ARGS)
+{
+	/* sum_numeric_fixed(int8 hi, int8 lo, int4 scale) */
+	PG_RETURN_POINTER(numeric_fixed_accum(fcinfo, 1, 1));
+}
+PG_FUNCTION_INFO_V1(pgstrom_sum_numeric_fixed_accum);
+
+Datum
+pgstrom_avg_numeric_fixed_accum(PG_FUNCTION_ARGS)
+{
+	/* avg_numeric_fixed(int4 nrows, int8 hi, int8 lo, int4 scale) */
+	int32		nrows = PG_GETARG_INT32(1);
+
+	if (PG_ARGISNULL(1))
+		nrows = 0;
+	else if (nrows < 0)
+		elog(ERROR, "Bug? negative nrows were given");
+
+	PG_RETURN_POINTER(numeric_fixed_accum(fcinfo, nrows, 2));
+}
+PG_FUNCTION_INFO_V1(pgstrom_avg_numeric_fixed_accum);
+
+Datum
+pgstrom_sum_numeric_fixed_final(PG_FUNCTION_ARGS)
+{
+	numeric_fixed_state *state;
+
+	state = PG_ARGISNULL(0) ? NULL : (numeric_fixed_state *)PG_GETARG_POINTER(0);
+	/* If there were no non-null inputs, return NULL */
+	if (state == NULL || !state->has_value)
+		PG_RETURN_NULL();
+
+	PG_RETURN_DATUM(numeric_fixed_total(state));
+}
+PG_FUNCTION_INFO_V1(pgstrom_sum_numeric_fixed_final);
+
+Datum
+pgstrom_avg_numeric_fixed_final(PG_FUNCTION_ARGS)
+{
+	numeric_fixed_state *state;
+	Datum		vN;
+
+	state = PG_ARGISNULL(0) ? NULL : (numeric_fixed_state *)PG_GETARG_POINTER(0);
+	/* If there were no non-null inputs, return NULL */
+	if (state == NULL || state->N == 0)
+		PG_RETURN_NULL();
+
+	vN = DirectFunctionCall1(int8_numeric, Int64GetDatum(state->N));
+	PG_RETURN_DATUM(DirectFunctionCall2(numeric_div,
+										numeric_fixed_total(state), vN));
+}
+PG_FUNCTION_INFO_V1(pgstrom_avg_numeric_fixed_final);
+
 /* logic copied from utils/adt/float.c */
 static inline float8 *
 check_float8_array(ArrayType *transarray, int nitems)
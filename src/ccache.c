@@ -0,0 +1,774 @@
+/*
+ * ccache.c
+ *
+ * Columnar cache of the heap blocks on the shared memory segment
+ * ----
+ * Copyright 2011-2016 (C) KaiGai Kohei <kaigai@kaigai.gr.jp>
+ * Copyright 2014-2016 (C) The PG-Strom Development Team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+#include "postgres.h"
+#include "access/hash.h"
+#include "access/htup_details.h"
+#include "access/relscan.h"
+#include "access/visibilitymap.h"
+#include "access/xlog.h"
+#include "funcapi.h"
+#include "miscadmin.h"
+#include "storage/bufmgr.h"
+#include "storage/ipc.h"
+#include "storage/shmem.h"
+#include "utils/guc.h"
+#include "utils/inval.h"
+#include "utils/rel.h"
+#include "utils/tqual.h"
+#include "pg_strom.h"
+
+/*
+ * ccache_entry - a chunk of KDS_FORMAT_COLUMN that keeps the contents of
+ * all-visible blocks in [block_start, block_start + block_nums). 'lsn'
+ * is the WAL insert position when the blocks were loaded.
+ */
+typedef struct
+{
+	dlist_node		hash_chain;	/* link to hash slot, or free list */
+	dlist_node		lru_chain;	/* link to LRU list, if active */
+	int				shift;		/* block class of this entry */
+	int				refcnt;		/* 0 means free entry */
+	RelFileNode		rnode;		/* physical identifier of the relation */
+	Oid				table_oid;	/* OID of the relation */
+	BlockNumber		block_start;/* first block number of the chunk */
+	BlockNumber		block_nums;	/* number of blocks in the chunk */
+	XLogRecPtr		lsn;		/* WAL position at the chunk load */
+	Size			kds_length;	/* length of the KDS image */
+	char			data[FLEXIBLE_ARRAY_MEMBER];
+} ccache_entry;
+
+#define CCACHE_ENTRY_KDS(entry)					\
+	((kern_data_store *)TYPEALIGN(STROMALIGN_LEN, (entry)->data))
+#define CCACHE_ACTIVE_ENTRY(entry)				\
+	((entry)->lru_chain.prev && (entry)->lru_chain.next)
+
+#define CCACHE_MIN_BITS		16		/* 64KB */
+#define CCACHE_MAX_BITS		28		/* 256MB */
+#define CCACHE_HASH_SIZE	1024
+
+typedef struct
+{
+	volatile slock_t lock;
+	dlist_head	free_list[CCACHE_MAX_BITS + 1];
+	dlist_head	hash_slot[CCACHE_HASH_SIZE];
+	cl_ulong	generation[CCACHE_HASH_SIZE];
+	dlist_head	lru_list;
+	/* statistics */
+	cl_ulong	num_hits;
+	cl_ulong	num_misses;
+	cl_ulong	num_invalidated;
+	ccache_entry *entry_begin;	/* start address of entries */
+	ccache_entry *entry_end;	/* end address of entries */
+	char		data[FLEXIBLE_ARRAY_MEMBER];
+} ccache_head;
+
+/* ---- GUC variables ---- */
+static Size		ccache_size;
+static bool		enable_ccache;
+
+/* ---- static variables ---- */
+static shmem_startup_hook_type shmem_startup_next;
+static ccache_head *cc_head = NULL;
+
+static void ccache_free(ccache_entry *entry);
+
+static inline int
+ccache_hash_index(Oid table_oid)
+{
+	Oid			keys[2];
+
+	keys[0] = MyDatabaseId;
+	keys[1] = table_oid;
+	return hash_any((unsigned char *)keys, sizeof(keys)) % CCACHE_HASH_SIZE;
+}
+
+/*
+ * ccache_unlink - detach the entry from hash/LRU list, then release it
+ * if nobody references. Caller must hold cc_head->lock.
+ */
+static void
+ccache_unlink(ccache_entry *entry)
+{
+	Assert(CCACHE_ACTIVE_ENTRY(entry));
+	dlist_delete(&entry->hash_chain);
+	dlist_delete(&entry->lru_chain);
+	memset(&entry->hash_chain, 0, sizeof(dlist_node));
+	memset(&entry->lru_chain, 0, sizeof(dlist_node));
+	if (--entry->refcnt == 0)
+		ccache_free(entry);
+}
+
+/*
+ * ccache_reclaim - it tries to release entries according to LRU
+ */
+static bool
+ccache_reclaim(int shift_min)
+{
+	ccache_entry   *entry;
+	int				shift;
+
+	while (!dlist_is_empty(&cc_head->lru_list))
+	{
+		dlist_node *dnode = dlist_tail_node(&cc_head->lru_list);
+
+		entry = dlist_container(ccache_entry, lru_chain, dnode);
+		ccache_unlink(entry);
+
+		for (shift = shift_min; shift <= CCACHE_MAX_BITS; shift++)
+		{
+			if (!dlist_is_empty(&cc_head->free_list[shift]))
+				return true;
+		}
+	}
+	return false;
+}
+
+/*
+ * ccache_split / ccache_alloc / ccache_free
+ *
+ * a simple buddy memory allocation on the shared memory segment, like
+ * as program cache doing.
+ */
+static bool
+ccache_split(int shift)
+{
+	ccache_entry   *entry;
+	dlist_node	   *dnode;
+
+	Assert(shift > CCACHE_MIN_BITS && shift <= CCACHE_MAX_BITS);
+	if (dlist_is_empty(&cc_head->free_list[shift]))
+	{
+		if (shift == CCACHE_MAX_BITS || !ccache_split(shift + 1))
+			return false;
+	}
+	Assert(!dlist_is_empty(&cc_head->free_list[shift]));
+
+	dnode = dlist_pop_head_node(&cc_head->free_list[shift]);
+	entry = dlist_container(ccache_entry, hash_chain, dnode);
+	Assert(entry->shift == shift);
+	shift--;
+
+	/* earlier half */
+	memset(entry, 0, offsetof(ccache_entry, data));
+	entry->shift = shift;
+	dlist_push_tail(&cc_head->free_list[shift], &entry->hash_chain);
+
+	/* later half */
+	entry = (ccache_entry *)((char *)entry + (1UL << shift));
+	memset(entry, 0, offsetof(ccache_entry, data));
+	entry->shift = shift;
+	dlist_push_tail(&cc_head->free_list[shift], &entry->hash_chain);
+
+	return true;
+}
+
+static ccache_entry *
+ccache_alloc(Size kds_length)
+{
+	ccache_entry   *entry;
+	dlist_node	   *dnode;
+	Size			total_size;
+	int				shift;
+
+	total_size = offsetof(ccache_entry, data) + STROMALIGN_LEN + kds_length;
+	if (total_size > (1UL << CCACHE_MAX_BITS))
+		return NULL;
+	shift = Max(get_next_log2(total_size), CCACHE_MIN_BITS);
+
+	while (dlist_is_empty(&cc_head->free_list[shift]) &&
+		   (shift == CCACHE_MAX_BITS || !ccache_split(shift + 1)))
+	{
+		if (!ccache_reclaim(shift))
+			return NULL;
+	}
+	Assert(!dlist_is_empty(&cc_head->free_list[shift]));
+
+	dnode = dlist_pop_head_node(&cc_head->free_list[shift]);
+	entry = dlist_container(ccache_entry, hash_chain, dnode);
+	Assert(entry->shift == shift);
+
+	memset(entry, 0, offsetof(ccache_entry, data));
+	entry->shift = shift;
+	entry->refcnt = 1;
+	entry->kds_length = kds_length;
+
+	return entry;
+}
+
+static void
+ccache_free(ccache_entry *entry)
+{
+	int			shift = entry->shift;
+	Size		offset;
+
+	Assert(entry->refcnt == 0);
+	Assert(!entry->hash_chain.next && !entry->hash_chain.prev);
+	Assert(!entry->lru_chain.next && !entry->lru_chain.prev);
+
+	/* try to merge buddy entry, if it is also free */
+	while (shift < CCACHE_MAX_BITS)
+	{
+		ccache_entry   *buddy;
+
+		offset = (uintptr_t) entry - (uintptr_t) cc_head->entry_begin;
+		if ((offset & (1UL << shift)) == 0)
+			buddy = (ccache_entry *)((char *)entry + (1UL << shift));
+		else
+			buddy = (ccache_entry *)((char *)entry - (1UL << shift));
+
+		if (buddy >= cc_head->entry_end ||		/* out of range? */
+			buddy->shift != shift ||			/* same size? */
+			buddy->refcnt > 0)					/* and free entry? */
+			break;
+		/* OK, chunk and buddy can be merged */
+		dlist_delete(&buddy->hash_chain);		/* remove from free_list */
+		memset(&buddy->hash_chain, 0, sizeof(dlist_node));
+		if (buddy < entry)
+			entry = buddy;
+		entry->shift = ++shift;
+	}
+	dlist_push_head(&cc_head->free_list[shift], &entry->hash_chain);
+}
+
+/*
+ * ccache_invalidate_slot - it drops the entries of the relation (or all
+ * the relations of the database if InvalidOid) in the hash slot, and
+ * makes advance the generation of the slot even if no entries are
+ * dropped, to prevent concurrent insertion of the chunk loaded under
+ * the older definition. Caller must hold cc_head->lock.
+ */
+static void
+ccache_invalidate_slot(int index, Oid relid)
+{
+	dlist_mutable_iter iter;
+
+	cc_head->generation[index]++;
+	dlist_foreach_modify(iter, &cc_head->hash_slot[index])
+	{
+		ccache_entry   *entry = dlist_container(ccache_entry,
+												hash_chain, iter.cur);
+		if (entry->rnode.dbNode != MyDatabaseId)
+			continue;
+		if (OidIsValid(relid) && entry->table_oid != relid)
+			continue;
+		ccache_unlink(entry);
+		cc_head->num_invalidated++;
+	}
+}
+
+/*
+ * ccache_relcache_callback
+ *
+ * Any relcache invalidation (DDL, TRUNCATE, ANALYZE, ...) drops the entries
+ * of the relation, because we cannot ensure the cached layout is still
+ * valid. Modification of the heap contents is detected by the visibility-
+ * map at the lookup, not here.
+ */
+static void
+ccache_relcache_callback(Datum arg, Oid relid)
+{
+	int			index;
+
+	if (!cc_head)
+		return;
+
+	SpinLockAcquire(&cc_head->lock);
+	if (OidIsValid(relid))
+		ccache_invalidate_slot(ccache_hash_index(relid), relid);
+	else
+	{
+		for (index=0; index < CCACHE_HASH_SIZE; index++)
+			ccache_invalidate_slot(index, InvalidOid);
+	}
+	SpinLockRelease(&cc_head->lock);
+}
+
+/*
+ * ccache_blocks_unchanged
+ *
+ * It checks whether the blocks are not modified since the WAL position
+ * 'lsn'. Only all-visible blocks are cached, and any modification of an
+ * all-visible block clears its visibility-map bit; the bit can be set
+ * again only by VACUUM, and it updates LSN of the visibility-map page
+ * using the WAL record. So, the blocks are not modified since 'lsn' if
+ * all the bits are still set and LSN of the visibility-map pages are not
+ * newer than 'lsn'. It is conservative; VACUUM on the other blocks covered
+ * by the same visibility-map page also makes the blocks changed.
+ */
+static bool
+ccache_blocks_unchanged(Relation rel,
+						BlockNumber block_start,
+						BlockNumber block_nums,
+						XLogRecPtr lsn)
+{
+	Buffer		vmbuffer = InvalidBuffer;
+	BlockNumber	vmblock = InvalidBlockNumber;
+	BlockNumber	i;
+
+	for (i=0; i < block_nums; i++)
+	{
+#if PG_VERSION_NUM >= 90600
+		if (!VM_ALL_VISIBLE(rel, block_start + i, &vmbuffer))
+			break;
+#else
+		if (!visibilitymap_test(rel, block_start + i, &vmbuffer))
+			break;
+#endif
+		if (BufferGetBlockNumber(vmbuffer) != vmblock)
+		{
+			XLogRecPtr	vm_lsn;
+
+			LockBuffer(vmbuffer, BUFFER_LOCK_SHARE);
+			vm_lsn = BufferGetLSNAtomic(vmbuffer);
+			LockBuffer(vmbuffer, BUFFER_LOCK_UNLOCK);
+			if (vm_lsn > lsn)
+				break;
+			vmblock = BufferGetBlockNumber(vmbuffer);
+		}
+	}
+	if (BufferIsValid(vmbuffer))
+		ReleaseBuffer(vmbuffer);
+
+	return (i == block_nums);
+}
+
+/*
+ * pgstrom_ccache_enabled
+ *
+ * It checks whether the columnar cache is available on the relation.
+ * Validity of the cached chunks is checked by the visibility-map; see
+ * the comment at ccache_blocks_unchanged. So, it is available only on
+ * the relations with WAL-logging, and not during recovery.
+ */
+bool
+pgstrom_ccache_enabled(Relation rel, Snapshot snapshot)
+{
+	if (!cc_head || !enable_ccache)
+		return false;
+	if (!IsMVCCSnapshot(snapshot) ||
+		!RelationNeedsWAL(rel) ||
+		RecoveryInProgress())
+		return false;
+	return true;
+}
+
+/*
+ * pgstrom_ccache_generation
+ *
+ * It returns the current generation of the hash slot that relation
+ * belongs to, and the current WAL insert position on 'p_lsn'. Caller has
+ * to give these values on pgstrom_ccache_insert prior to the chunk load,
+ * to ensure no invalidation and modification happen during the load.
+ */
+cl_ulong
+pgstrom_ccache_generation(Relation rel, XLogRecPtr *p_lsn)
+{
+	int			index = ccache_hash_index(RelationGetRelid(rel));
+	cl_ulong	generation;
+
+	Assert(cc_head != NULL);
+	SpinLockAcquire(&cc_head->lock);
+	generation = cc_head->generation[index];
+	SpinLockRelease(&cc_head->lock);
+	*p_lsn = GetXLogInsertRecPtr();
+
+	return generation;
+}
+
+/*
+ * pgstrom_ccache_lookup
+ *
+ * It looks up a cached chunk that begins from 'block_start' and has all
+ * the referenced columns, then returns a copy of the chunk. 'block_nums'
+ * shall be set, and has to be less than or equal to 'block_limit'.
+ */
+pgstrom_data_store *
+pgstrom_ccache_lookup(GpuContext *gcontext,
+					  Relation rel,
+					  Bitmapset *column_refs,
+					  BlockNumber block_start,
+					  BlockNumber block_limit,
+					  BlockNumber *p_block_nums)
+{
+	TupleDesc		tupdesc = RelationGetDescr(rel);
+	int				index = ccache_hash_index(RelationGetRelid(rel));
+	ccache_entry   *entry = NULL;
+	pgstrom_data_store *pds;
+	dlist_iter		iter;
+
+	SpinLockAcquire(&cc_head->lock);
+	dlist_foreach(iter, &cc_head->hash_slot[index])
+	{
+		ccache_entry	   *temp = dlist_container(ccache_entry,
+												   hash_chain, iter.cur);
+		kern_data_store	   *kds = CCACHE_ENTRY_KDS(temp);
+		cl_uint			   *column_offset;
+		int					anum = -1;
+
+		if (!RelFileNodeEquals(temp->rnode, rel->rd_node) ||
+			temp->block_start != block_start ||
+			temp->block_nums > block_limit ||
+			kds->ncols != tupdesc->natts)
+			continue;
+		/* all the referenced columns must be loaded */
+		column_offset = KERN_DATA_STORE_COLUMN_OFFSET(kds);
+		while ((anum = bms_next_member(column_refs, anum)) >= 0)
+		{
+			if (anum > kds->ncols || column_offset[anum - 1] == 0)
+				break;
+		}
+		if (anum < 0)
+		{
+			entry = temp;
+			break;
+		}
+	}
+
+	if (!entry)
+	{
+		cc_head->num_misses++;
+		SpinLockRelease(&cc_head->lock);
+		return NULL;
+	}
+	entry->refcnt++;
+	dlist_move_head(&cc_head->lru_list, &entry->lru_chain);
+	SpinLockRelease(&cc_head->lock);
+
+	/* drop the entry if any blocks are modified since the load */
+	if (!ccache_blocks_unchanged(rel, entry->block_start,
+								 entry->block_nums, entry->lsn))
+	{
+		SpinLockAcquire(&cc_head->lock);
+		if (CCACHE_ACTIVE_ENTRY(entry))
+		{
+			ccache_unlink(entry);
+			cc_head->num_invalidated++;
+		}
+		cc_head->num_misses++;
+		if (--entry->refcnt == 0)
+			ccache_free(entry);
+		SpinLockRelease(&cc_head->lock);
+		return NULL;
+	}
+
+	/* make a copy of the cached chunk, without lock */
+	PG_TRY();
+	{
+		pds = MemoryContextAllocZero(gcontext->memcxt,
+									 sizeof(pgstrom_data_store));
+		pds->refcnt = 1;
+		pds->kds_length = entry->kds_length;
+		pds->kds = MemoryContextAllocHuge(gcontext->memcxt,
+										  pds->kds_length);
+		memcpy(pds->kds, CCACHE_ENTRY_KDS(entry), entry->kds_length);
+		pds->kds->hostptr = (hostptr_t) &pds->kds->hostptr;
+		pds->kds->table_oid = RelationGetRelid(rel);
+		dlist_push_tail(&gcontext->pds_list, &pds->pds_chain);
+		*p_block_nums = entry->block_nums;
+	}
+	PG_CATCH();
+	{
+		SpinLockAcquire(&cc_head->lock);
+		if (--entry->refcnt == 0)
+			ccache_free(entry);
+		SpinLockRelease(&cc_head->lock);
+		PG_RE_THROW();
+	}
+	PG_END_TRY();
+
+	SpinLockAcquire(&cc_head->lock);
+	cc_head->num_hits++;
+	if (--entry->refcnt == 0)
+		ccache_free(entry);
+	SpinLockRelease(&cc_head->lock);
+
+	return pds;
+}
+
+/*
+ * pgstrom_ccache_insert
+ *
+ * It inserts a chunk of KDS_FORMAT_COLUMN onto the columnar cache, if all
+ * the blocks are all-visible, and no invalidation and modification happen
+ * since 'generation' and 'lsn' are taken.
+ */
+void
+pgstrom_ccache_insert(Relation rel,
+					  pgstrom_data_store *pds,
+					  BlockNumber block_start,
+					  BlockNumber block_nums,
+					  cl_ulong generation,
+					  XLogRecPtr lsn)
+{
+	kern_data_store *kds = pds->kds;
+	int				index = ccache_hash_index(RelationGetRelid(rel));
+	ccache_entry   *entry;
+	dlist_mutable_iter iter;
+
+	Assert(kds->format == KDS_FORMAT_COLUMN);
+	if (block_nums == 0)
+		return;
+
+	/*
+	 * Only all-visible blocks can be cached, because its contents are
+	 * independent from the snapshot. If a block gets modified during the
+	 * load, the visibility-map tells us.
+	 */
+	if (!ccache_blocks_unchanged(rel, block_start, block_nums, lsn))
+		return;
+
+	/* allocation of a new entry; invisible to others yet */
+	SpinLockAcquire(&cc_head->lock);
+	entry = ccache_alloc(kds->length);
+	SpinLockRelease(&cc_head->lock);
+	if (!entry)
+		return;
+
+	memcpy(CCACHE_ENTRY_KDS(entry), kds, kds->length);
+	entry->rnode = rel->rd_node;
+	entry->table_oid = RelationGetRelid(rel);
+	entry->block_start = block_start;
+	entry->block_nums = block_nums;
+	entry->lsn = lsn;
+
+	SpinLockAcquire(&cc_head->lock);
+	if (cc_head->generation[index] != generation)
+	{
+		/* someone invalidated the relation during the load */
+		if (--entry->refcnt == 0)
+			ccache_free(entry);
+		SpinLockRelease(&cc_head->lock);
+		return;
+	}
+	/* older chunk that begins from the same block shall be replaced */
+	dlist_foreach_modify(iter, &cc_head->hash_slot[index])
+	{
+		ccache_entry   *temp = dlist_container(ccache_entry,
+											   hash_chain, iter.cur);
+		if (RelFileNodeEquals(temp->rnode, rel->rd_node) &&
+			temp->block_start == block_start)
+			ccache_unlink(temp);
+	}
+	dlist_push_head(&cc_head->hash_slot[index], &entry->hash_chain);
+	dlist_push_head(&cc_head->lru_list, &entry->lru_chain);
+	SpinLockRelease(&cc_head->lock);
+}
+
+/*
+ * pgstrom_ccache_info
+ *
+ * SQL function to dump the current columnar cache entries
+ */
+typedef struct
+{
+	Oid			database_oid;
+	Oid			table_oid;
+	BlockNumber	block_start;
+	BlockNumber	block_nums;
+	cl_uint		nitems;
+	Size		length;
+	int			refcnt;
+} ccache_info;
+
+Datum
+pgstrom_ccache_info(PG_FUNCTION_ARGS)
+{
+	FuncCallContext *fncxt;
+	ccache_info	   *cc_info;
+	HeapTuple		tuple;
+	Datum			values[7];
+	bool			isnull[7];
+
+	if (SRF_IS_FIRSTCALL())
+	{
+		TupleDesc		tupdesc;
+		MemoryContext	oldcxt;
+		List		   *cc_info_list = NIL;
+		int				index;
+
+		fncxt = SRF_FIRSTCALL_INIT();
+		oldcxt = MemoryContextSwitchTo(fncxt->multi_call_memory_ctx);
+
+		tupdesc = CreateTemplateTupleDesc(7, false);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 1, "database_oid",
+						   OIDOID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 2, "table_oid",
+						   OIDOID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 3, "block_start",
+						   INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 4, "block_nums",
+						   INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 5, "nitems",
+						   INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 6, "length",
+						   INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 7, "refcnt",
+						   INT4OID, -1, 0);
+		fncxt->tuple_desc = BlessTupleDesc(tupdesc);
+
+		if (cc_head)
+		{
+			SpinLockAcquire(&cc_head->lock);
+			PG_TRY();
+			{
+				for (index=0; index < CCACHE_HASH_SIZE; index++)
+				{
+					dlist_iter	iter;
+
+					dlist_foreach(iter, &cc_head->hash_slot[index])
+					{
+						ccache_entry   *entry
+							= dlist_container(ccache_entry,
+											  hash_chain, iter.cur);
+
+						cc_info = palloc(sizeof(ccache_info));
+						cc_info->database_oid = entry->rnode.dbNode;
+						cc_info->table_oid = entry->table_oid;
+						cc_info->block_start = entry->block_start;
+						cc_info->block_nums = entry->block_nums;
+						cc_info->nitems = CCACHE_ENTRY_KDS(entry)->nitems;
+						cc_info->length = entry->kds_length;
+						cc_info->refcnt = entry->refcnt;
+						cc_info_list = lappend(cc_info_list, cc_info);
+					}
+				}
+			}
+			PG_CATCH();
+			{
+				SpinLockRelease(&cc_head->lock);
+				PG_RE_THROW();
+			}
+			PG_END_TRY();
+			SpinLockRelease(&cc_head->lock);
+		}
+		fncxt->user_fctx = cc_info_list;
+
+		MemoryContextSwitchTo(oldcxt);
+	}
+	fncxt = SRF_PERCALL_SETUP();
+
+	if (fncxt->user_fctx == NIL)
+		SRF_RETURN_DONE(fncxt);
+
+	cc_info = linitial((List *) fncxt->user_fctx);
+	fncxt->user_fctx = list_delete_first((List *) fncxt->user_fctx);
+
+	memset(isnull, 0, sizeof(isnull));
+	values[0] = ObjectIdGetDatum(cc_info->database_oid);
+	values[1] = ObjectIdGetDatum(cc_info->table_oid);
+	values[2] = Int64GetDatum(cc_info->block_start);
+	values[3] = Int64GetDatum(cc_info->block_nums);
+	values[4] = Int64GetDatum(cc_info->nitems);
+	values[5] = Int64GetDatum(cc_info->length);
+	values[6] = Int32GetDatum(cc_info->refcnt);
+
+	tuple = heap_form_tuple(fncxt->tuple_desc, values, isnull);
+
+	SRF_RETURN_NEXT(fncxt, HeapTupleGetDatum(tuple));
+}
+PG_FUNCTION_INFO_V1(pgstrom_ccache_info);
+
+static void
+pgstrom_startup_ccache(void)
+{
+	ccache_entry   *entry;
+	bool			found;
+	int				i;
+	int				shift;
+	char		   *curr_addr;
+	char		   *end_addr;
+
+	if (shmem_startup_next)
+		(*shmem_startup_next)();
+
+	cc_head = ShmemInitStruct("PG-Strom columnar cache",
+							  ccache_size, &found);
+	if (found)
+		elog(ERROR, "Bug? shared memory for columnar cache already exists");
+
+	/* initialize columnar cache header */
+	memset(cc_head, 0, offsetof(ccache_head, data));
+	SpinLockInit(&cc_head->lock);
+	for (i=0; i <= CCACHE_MAX_BITS; i++)
+		dlist_init(&cc_head->free_list[i]);
+	for (i=0; i < CCACHE_HASH_SIZE; i++)
+		dlist_init(&cc_head->hash_slot[i]);
+	dlist_init(&cc_head->lru_list);
+	cc_head->entry_begin = (ccache_entry *) BUFFERALIGN(cc_head->data);
+
+	/* makes free entries */
+	curr_addr = (char *) cc_head->entry_begin;
+	end_addr = ((char *) cc_head) + ccache_size;
+	shift = CCACHE_MAX_BITS;
+	while (shift >= CCACHE_MIN_BITS)
+	{
+		if (curr_addr + (1UL << shift) > end_addr)
+		{
+			shift--;
+			continue;
+		}
+		entry = (ccache_entry *) curr_addr;
+		memset(entry, 0, offsetof(ccache_entry, data));
+		entry->shift = shift;
+		dlist_push_tail(&cc_head->free_list[shift], &entry->hash_chain);
+
+		curr_addr += (1UL << shift);
+	}
+	cc_head->entry_end = (ccache_entry *) curr_addr;
+}
+
+void
+pgstrom_init_ccache(void)
+{
+	static int	__ccache_size;
+
+	/*
+	 * size of the columnar cache; 0 means disabled
+	 */
+	DefineCustomIntVariable("pg_strom.ccache_size",
+							"size of shared columnar cache",
+							NULL,
+							&__ccache_size,
+							0,
+							0,
+							INT_MAX,
+							PGC_POSTMASTER,
+							GUC_NOT_IN_SAMPLE | GUC_UNIT_KB,
+							NULL, NULL, NULL);
+	ccache_size = (Size)__ccache_size * 1024L;
+
+	DefineCustomBoolVariable("pg_strom.enable_ccache",
+							 "Enables to use the columnar cache",
+							 NULL,
+							 &enable_ccache,
+							 true,
+							 PGC_USERSET,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
+
+	/* invalidation of the relation layout changes */
+	CacheRegisterRelcacheCallback(ccache_relcache_callback, 0);
+
+	/* allocation of static shared memory, if enabled */
+	if (ccache_size > 0)
+	{
+		RequestAddinShmemSpace(ccache_size);
+		shmem_startup_next = shmem_startup_hook;
+		shmem_startup_hook = pgstrom_startup_ccache;
+	}
+}
@@ -22,6 +22,7 @@
 #include "catalog/pg_namespace.h"
 #include "catalog/pg_proc.h"
 #include "catalog/pg_type.h"
+#include "nodes/makefuncs.h"
 #include "nodes/nodeFuncs.h"
 #include "nodes/pg_list.h"
 #include "optimizer/clauses.h"
@@ -34,6 +35,7 @@
 #include "utils/syscache.h"
 #include "utils/typcache.h"
 #include "pg_strom.h"
+#include "cuda_textlib.h"
 
 static MemoryContext	devinfo_memcxt;
 static bool		devtype_info_is_built;
@@ -290,10 +292,15 @@ pgstrom_codegen_typeoid_declarations(StringInfo source)
  * 'a' : this function needs an alias, instead of SQL function name
  * 'c' : this function is locale aware, thus, available only if simple
  *       collation configuration (none, and C-locale).
+ * 'i' : the pattern of 'p' or 'x' is matched case-insensitively
  * 'm' : this function needs cuda_mathlib.h
  * 'n' : this function needs cuda_numeric.h
+ * 'p' : 2nd argument is LIKE pattern; it can be compiled on the host side
+ *       if constant
  * 's' : this function needs cuda_textlib.h
  * 't' : this function needs cuda_timelib.h
+ * 'x' : 2nd argument is regular expression; available only if constant
+ *       pattern can be compiled on the host side
  * 'y' : this function needs cuda_money.h
  *
  * class character:
@@ -893,17 +900,26 @@ static devfunc_catalog_t devfunc_common_catalog[] = {
 	{ "bttextcmp", 2, {TEXTOID, TEXTOID},     "sc/F:text_cmp" },
 	{ "length",    1, {TEXTOID},              "sc/F:textlen" },
 	/* LIKE operators */
-	{ "like",        2, {TEXTOID, TEXTOID},   "s/F:textlike" },
-	{ "textlike",    2, {TEXTOID, TEXTOID},   "s/F:textlike" },
-	{ "bpcharlike",  2, {BPCHAROID, TEXTOID}, "s/F:textlike" },
-	{ "notlike",     2, {TEXTOID, TEXTOID},   "s/F:textnlike" },
-	{ "textnlike",   2, {TEXTOID, TEXTOID},   "s/F:textnlike" },
-	{ "bpcharnlike", 2, {BPCHAROID, TEXTOID}, "s/F:textnlike" },
+	{ "like",        2, {TEXTOID, TEXTOID},   "ps/F:textlike" },
+	{ "textlike",    2, {TEXTOID, TEXTOID},   "ps/F:textlike" },
+	{ "bpcharlike",  2, {BPCHAROID, TEXTOID}, "ps/F:textlike" },
+	{ "notlike",     2, {TEXTOID, TEXTOID},   "ps/F:textnlike" },
+	{ "textnlike",   2, {TEXTOID, TEXTOID},   "ps/F:textnlike" },
+	{ "bpcharnlike", 2, {BPCHAROID, TEXTOID}, "ps/F:textnlike" },
 	/* ILIKE operators */
-	{ "texticlike",    2, {TEXTOID, TEXTOID},   "sc/F:texticlike" },
-	{ "bpchariclike",  2, {TEXTOID, TEXTOID},   "sc/F:texticlike" },
-	{ "texticnlike",   2, {TEXTOID, TEXTOID},   "sc/F:texticnlike" },
-	{ "bpcharicnlike", 2, {BPCHAROID, TEXTOID}, "sc/F:texticnlike" },	
+	{ "texticlike",    2, {TEXTOID, TEXTOID},   "ipsc/F:texticlike" },
+	{ "bpchariclike",  2, {TEXTOID, TEXTOID},   "ipsc/F:texticlike" },
+	{ "texticnlike",   2, {TEXTOID, TEXTOID},   "ipsc/F:texticnlike" },
+	{ "bpcharicnlike", 2, {BPCHAROID, TEXTOID}, "ipsc/F:texticnlike" },
+	/* regular expression operators; compiled pattern only */
+	{ "textregexeq",     2, {TEXTOID, TEXTOID},   "xs/F:textregexeq" },
+	{ "bpcharregexeq",   2, {BPCHAROID, TEXTOID}, "xs/F:textregexeq" },
+	{ "textregexne",     2, {TEXTOID, TEXTOID},   "xs/F:textregexne" },
+	{ "bpcharregexne",   2, {BPCHAROID, TEXTOID}, "xs/F:textregexne" },
+	{ "texticregexeq",   2, {TEXTOID, TEXTOID},   "ixsc/F:texticregexeq" },
+	{ "bpcharicregexeq", 2, {BPCHAROID, TEXTOID}, "ixsc/F:texticregexeq" },
+	{ "texticregexne",   2, {TEXTOID, TEXTOID},   "ixsc/F:texticregexne" },
+	{ "bpcharicregexne", 2, {BPCHAROID, TEXTOID}, "ixsc/F:texticregexne" },
 };
 
 static void
@@ -1150,6 +1166,7 @@ pgstrom_devfunc_construct(Oid func_oid,
 			const char *pos;
 			const char *end;
 			int32		flags = 0;
+			int32		pattern = 0;
 			bool		has_alias = false;
 			bool		has_collation = false;
 
@@ -1178,6 +1195,15 @@ pgstrom_devfunc_construct(Oid func_oid,
 						case 'c':
 							has_collation = true;
 							break;
+						case 'i':
+							pattern |= DEVFUNC_PATTERN_ICASE;
+							break;
+						case 'p':
+							pattern |= DEVFUNC_PATTERN_LIKE;
+							break;
+						case 'x':
+							pattern |= DEVFUNC_PATTERN_REGEX;
+							break;
 						case 'n':
 							flags |= DEVKERNEL_NEEDS_NUMERIC;
 							break;
@@ -1203,6 +1229,7 @@ pgstrom_devfunc_construct(Oid func_oid,
 				template = end + 1;
 			}
 			entry->func_flags = flags;
+			entry->func_pattern = pattern;
 
 			/* In case when function is collation aware but not supported
 			 * to run on GPU device, we have to give up.
@@ -1353,6 +1380,350 @@ pgstrom_devfunc_lookup_and_track(Oid func_oid, Oid func_collid,
 	return dfunc;
 }
 
+/*
+ * Compile LIKE/regex patterns for bit-parallel matching
+ *
+ * Only the subset of the pattern syntax below is supported; we give up
+ * compilation for the rest, then the CPU (or the generic LIKE matcher on
+ * the device) will process it.
+ *  LIKE  : literal characters, '%', '_' and escape by '\'
+ *  regex : literal characters, '.', bracket expression without character
+ *          class, '*', '+', '?', escape of punctuation by '\' and the
+ *          anchors '^' at the head and '$' at the tail
+ * Because the device walks on the text byte-by-byte, the atoms that match
+ * a multibyte character (like '_', '.' or negative brackets) are supported
+ * only on single-byte encodings. Only UTF-8 is supported on multibyte
+ * encodings, because a byte sequence of the character never appears at
+ * the middle of other characters.
+ */
+static bool
+textpattern_add_position(kern_textpattern *tpat, bool chars[256], bool icase)
+{
+	cl_ulong	bit;
+	int			c;
+
+	if (tpat->npos >= TEXTPATTERN_MAX_POSITIONS)
+		return false;
+	bit = (1UL << tpat->npos);
+	for (c=0; c < 256; c++)
+	{
+		if (!chars[c])
+			continue;
+		tpat->mask_chars[c] |= bit;
+		if (icase && c >= 'A' && c <= 'Z')
+			tpat->mask_chars[c + ('a' - 'A')] |= bit;
+		else if (icase && c >= 'a' && c <= 'z')
+			tpat->mask_chars[c - ('a' - 'A')] |= bit;
+	}
+	tpat->npos++;
+
+	return true;
+}
+
+static bool
+textpattern_add_literal(kern_textpattern *tpat, int c, bool icase)
+{
+	bool		chars[256];
+
+	memset(chars, 0, sizeof(chars));
+	chars[c & 0xff] = true;
+	return textpattern_add_position(tpat, chars, icase);
+}
+
+static bool
+textpattern_add_anychar(kern_textpattern *tpat)
+{
+	bool		chars[256];
+
+	memset(chars, 1, sizeof(chars));
+	return textpattern_add_position(tpat, chars, false);
+}
+
+static kern_textpattern *
+codegen_compile_text_pattern(Node *pattern, int32 func_pattern)
+{
+	kern_textpattern *tpat;
+	text	   *ptext;
+	const char *pos;
+	const char *end;
+	bool		icase = ((func_pattern & DEVFUNC_PATTERN_ICASE) != 0);
+	bool		multibyte = (pg_database_encoding_max_length() > 1);
+	bool		last_single = false;	/* last atom is a single position */
+	bool		chars[256];
+	int			c;
+
+	if (!IsA(pattern, Const) ||
+		((Const *) pattern)->constisnull ||
+		((Const *) pattern)->consttype != TEXTOID)
+		return NULL;
+	if (multibyte && GetDatabaseEncoding() != PG_UTF8)
+		return NULL;
+
+	ptext = DatumGetTextPP(((Const *) pattern)->constvalue);
+	pos = VARDATA_ANY(ptext);
+	end = pos + VARSIZE_ANY_EXHDR(ptext);
+
+	tpat = palloc0(sizeof(kern_textpattern));
+	SET_VARSIZE(tpat, sizeof(kern_textpattern));
+
+	if (func_pattern & DEVFUNC_PATTERN_LIKE)
+	{
+		tpat->flags = TEXTPATTERN_ANCHOR_HEAD | TEXTPATTERN_ANCHOR_TAIL;
+		while (pos < end)
+		{
+			c = (unsigned char) *pos++;
+			if (c == '%')
+			{
+				/* a series of '%' is equivalent to a single '%' */
+				if (last_single &&
+					(tpat->mask_rep & (1UL << (tpat->npos - 1))) != 0)
+					continue;
+				if (!textpattern_add_anychar(tpat))
+					goto giveup;
+				tpat->mask_opt |= (1UL << (tpat->npos - 1));
+				tpat->mask_rep |= (1UL << (tpat->npos - 1));
+				last_single = true;
+				continue;
+			}
+			else if (c == '_')
+			{
+				if (multibyte || !textpattern_add_anychar(tpat))
+					goto giveup;
+			}
+			else
+			{
+				if (c == '\\')
+				{
+					/* trailing escape raises an error on the CPU side */
+					if (pos >= end)
+						goto giveup;
+					c = (unsigned char) *pos++;
+				}
+				if (!textpattern_add_literal(tpat, c, icase))
+					goto giveup;
+			}
+			last_single = false;
+		}
+	}
+	else if (func_pattern & DEVFUNC_PATTERN_REGEX)
+	{
+		if (pos < end && *pos == '^')
+		{
+			tpat->flags |= TEXTPATTERN_ANCHOR_HEAD;
+			pos++;
+		}
+		while (pos < end)
+		{
+			c = (unsigned char) *pos;
+			switch (c)
+			{
+				case '*':
+				case '+':
+				case '?':
+					if (!last_single)
+						goto giveup;
+					if (c != '+')
+						tpat->mask_opt |= (1UL << (tpat->npos - 1));
+					if (c != '?')
+						tpat->mask_rep |= (1UL << (tpat->npos - 1));
+					pos++;
+					/* non-greedy quantifier makes no difference here */
+					if (pos < end && *pos == '?')
+						pos++;
+					last_single = false;
+					continue;
+
+				case '.':
+					if (multibyte || !textpattern_add_anychar(tpat))
+						goto giveup;
+					pos++;
+					break;
+
+				case '[':
+					{
+						bool	negative = false;
+						bool	first = true;
+						int		lo, hi;
+
+						memset(chars, 0, sizeof(chars));
+						if (++pos < end && *pos == '^')
+						{
+							negative = true;
+							pos++;
+						}
+						for (;;)
+						{
+							if (pos >= end)
+								goto giveup;
+							lo = (unsigned char) *pos;
+							if (lo == ']' && !first)
+								break;
+							if (lo == '[' || lo == '\\' || lo >= 0x80)
+								goto giveup;
+							pos++;
+							if (pos + 1 < end && pos[0] == '-' && pos[1] != ']')
+							{
+								hi = (unsigned char) pos[1];
+								if (hi == '[' || hi == '\\' || hi >= 0x80 ||
+									hi < lo)
+									goto giveup;
+								pos += 2;
+							}
+							else
+								hi = lo;
+							while (lo <= hi)
+								chars[lo++] = true;
+							first = false;
+						}
+						pos++;	/* ']' */
+
+						if (negative)
+						{
+							if (multibyte)
+								goto giveup;
+							/* case folding has to be applied prior to inversion */
+							if (icase)
+							{
+								for (c='A'; c <= 'Z'; c++)
+								{
+									if (chars[c] || chars[c + ('a' - 'A')])
+										chars[c] = chars[c + ('a' - 'A')] = true;
+								}
+							}
+							for (c=0; c < 256; c++)
+								chars[c] = !chars[c];
+						}
+						if (!textpattern_add_position(tpat, chars, icase))
+							goto giveup;
+					}
+					break;
+
+				case '\\':
+					if (++pos >= end)
+						goto giveup;
+					c = (unsigned char) *pos++;
+					/* escape of alphanumeric has special meaning */
+					if (isalnum(c) || c >= 0x80 ||
+						!textpattern_add_literal(tpat, c, icase))
+						goto giveup;
+					break;
+
+				case '$':
+					/* only the anchor at the tail is supported */
+					if (pos + 1 != end)
+						goto giveup;
+					tpat->flags |= TEXTPATTERN_ANCHOR_TAIL;
+					pos++;
+					last_single = false;
+					continue;
+
+				case '(':
+				case ')':
+				case '|':
+				case '{':
+				case '}':
+				case '^':
+				case ']':
+					goto giveup;
+
+				default:
+					if (c >= 0x80 && multibyte)
+					{
+						int		i, len = pg_mblen(pos);
+
+						if (pos + len > end)
+							goto giveup;
+						for (i=0; i < len; i++)
+						{
+							if (!textpattern_add_literal(tpat, pos[i], false))
+								goto giveup;
+						}
+						pos += len;
+						/* quantifier cannot be applied on a multibyte char */
+						last_single = (len == 1);
+						continue;
+					}
+					if (!textpattern_add_literal(tpat, c, icase))
+						goto giveup;
+					pos++;
+					break;
+			}
+			last_single = true;
+		}
+	}
+	else
+		goto giveup;
+
+	if ((Pointer) ptext != DatumGetPointer(((Const *) pattern)->constvalue))
+		pfree(ptext);
+	return tpat;
+
+giveup:
+	if ((Pointer) ptext != DatumGetPointer(((Const *) pattern)->constvalue))
+		pfree(ptext);
+	pfree(tpat);
+	return NULL;
+}
+
+/*
+ * codegen_check_text_pattern
+ *
+ * It checks whether the pattern can be compiled on the host, for the
+ * planner; the compiled pattern is released immediately.
+ */
+static bool
+codegen_check_text_pattern(Node *pattern, int32 func_pattern)
+{
+	kern_textpattern *tpat;
+
+	tpat = codegen_compile_text_pattern(pattern, func_pattern);
+	if (!tpat)
+		return false;
+	pfree(tpat);
+	return true;
+}
+
+/*
+ * codegen_text_pattern_expression
+ *
+ * It writes out a call of pattern matching function using a compiled
+ * pattern, if possible. Otherwise, it returns false and caller should
+ * write out the generic one.
+ */
+static bool
+codegen_text_pattern_expression(devfunc_info *dfunc, List *args,
+								codegen_context *context)
+{
+	kern_textpattern *tpat;
+	Const	   *con;
+	cl_uint		index;
+
+	Assert(dfunc->func_pattern != 0 && list_length(args) == 2);
+	tpat = codegen_compile_text_pattern(lsecond(args), dfunc->func_pattern);
+	if (!tpat)
+	{
+		if (dfunc->func_pattern & DEVFUNC_PATTERN_REGEX)
+			elog(ERROR, "codegen: failed to compile regular expression: %s",
+				 nodeToString(lsecond(args)));
+		return false;
+	}
+	if (!pgstrom_devtype_lookup_and_track(BYTEAOID, context))
+		elog(ERROR, "codegen: faied to lookup device type: %s",
+			 format_type_be(BYTEAOID));
+	con = makeConst(BYTEAOID, -1, InvalidOid, -1,
+					PointerGetDatum(tpat), false, false);
+	context->used_params = lappend(context->used_params, con);
+	index = list_length(context->used_params) - 1;
+	context->param_refs = bms_add_member(context->param_refs, index);
+
+	appendStringInfo(&context->str,
+					 "pgfn_%s_bitap(kcxt, ", dfunc->func_devname);
+	codegen_expression_walker(linitial(args), context);
+	appendStringInfo(&context->str, ", KPARAM_%u)", index);
+
+	return true;
+}
+
 /*
  * codegen_expression_walker - main logic of run-time code generator
  */
@@ -1476,6 +1847,9 @@ codegen_expression_walker(Node *node, codegen_context *context)
 		if (!dfunc)
 			elog(ERROR, "codegen: failed to lookup device function: %s",
 				 format_procedure(func->funcid));
+		if (dfunc->func_pattern != 0 &&
+			codegen_text_pattern_expression(dfunc, func->args, context))
+			return;
 
 		appendStringInfo(&context->str,
 						 "pgfn_%s(kcxt", dfunc->func_devname);
@@ -1499,6 +1873,9 @@ codegen_expression_walker(Node *node, codegen_context *context)
 		if (!dfunc)
 			elog(ERROR, "codegen: failed to lookup device function: %s",
                  format_procedure(op_funcid));
+		if (dfunc->func_pattern != 0 &&
+			codegen_text_pattern_expression(dfunc, op->args, context))
+			return;
 
 		appendStringInfo(&context->str,
 						 "pgfn_%s(kcxt", dfunc->func_devname);
@@ -2515,9 +2892,14 @@ pgstrom_device_expression(Expr *expr)
 	else if (IsA(expr, FuncExpr))
 	{
 		FuncExpr   *func = (FuncExpr *) expr;
-
-		if (!pgstrom_devfunc_lookup(func->funcid,
-									func->inputcollid))
+		devfunc_info *dfunc = pgstrom_devfunc_lookup(func->funcid,
+													 func->inputcollid);
+		if (!dfunc)
+			goto unable_node;
+		/* regular expression has to be compiled on the host */
+		if ((dfunc->func_pattern & DEVFUNC_PATTERN_REGEX) != 0 &&
+			!codegen_check_text_pattern(lsecond(func->args),
+										dfunc->func_pattern))
 			goto unable_node;
 
 		return pgstrom_device_expression((Expr *) func->args);
@@ -2525,9 +2907,14 @@ pgstrom_device_expression(Expr *expr)
 	else if (IsA(expr, OpExpr) || IsA(expr, DistinctExpr))
 	{
 		OpExpr	   *op = (OpExpr *) expr;
-
-		if (!pgstrom_devfunc_lookup(get_opcode(op->opno),
-									op->inputcollid))
+		devfunc_info *dfunc = pgstrom_devfunc_lookup(get_opcode(op->opno),
+													 op->inputcollid);
+		if (!dfunc)
+			goto unable_node;
+		/* regular expression has to be compiled on the host */
+		if ((dfunc->func_pattern & DEVFUNC_PATTERN_REGEX) != 0 &&
+			!codegen_check_text_pattern(lsecond(op->args),
+										dfunc->func_pattern))
 			goto unable_node;
 
 		return pgstrom_device_expression((Expr *) op->args);
@@ -188,8 +188,16 @@ typedef uintptr_t		hostptr_t;
 #ifdef __CUDACC__
 #define STATIC_INLINE(RET_TYPE)						\
 	__device__ __forceinline__ static RET_TYPE __attribute__ ((unused))
+#ifndef PGSTROM_DEVICE_LIBRARY
 #define STATIC_FUNCTION(RET_TYPE)					\
 	__device__ static RET_TYPE __attribute__ ((unused))
+#else
+/* functions in the precompiled device library have to be visible */
+#define STATIC_FUNCTION(RET_TYPE)					\
+	__device__ RET_TYPE __attribute__ ((unused))
+#endif
+#define DEVICE_LIBRARY_FUNCTION(RET_TYPE)			\
+	extern __device__ RET_TYPE
 #define KERNEL_FUNCTION(RET_TYPE)	__global__ RET_TYPE
 #if __CUDA_ARCH__ < 200
 #define KERNEL_FUNCTION_MAXTHREADS(RET_TYPE)	\
@@ -246,6 +254,7 @@ typedef uintptr_t		hostptr_t;
 #define StromKernel_gpujoin_projection_row			0x0206
 #define StromKernel_gpujoin_projection_slot			0x0207
 #define StromKernel_gpujoin_count_rows_dist			0x0208
+#define StromKernel_gpujoin_exec_rangejoin			0x0209
 #define StromKernel_gpujoin_main					0x0299
 #define StromKernel_gpupreagg_preparation			0x0301
 #define StromKernel_gpupreagg_local_reduction		0x0302
@@ -623,6 +632,24 @@ get_uint64_val(const void *addr)
  * |      :        |     :        |     :         |
  * |      :        |     :        |     :         |
  * +---------------+--------------+---------------+
+ *
+ * <column format> keeps the referenced attributes only, as individual
+ * arrays transposed from the heap tuples. column_offset[] has offset to
+ * the null-bitmap of each column, or 0 if the column is not loaded.
+ * Fixed-length values are stored in the array just after the bitmap;
+ * variable-length values have cl_uint offset to the extra area at the
+ * tail of the data store, like kern_tupitem of row format.
+ *
+ * +----------------------------------------------+
+ * | column_offset[0] ... column_offset[M-1]      |
+ * +----------------------------------------------+
+ * | nullmap of column-X (nrooms bits)            |
+ * | values of column-X  (unitsz * nrooms)        |
+ * +----------------------------------------------+
+ * |       :                                      |
+ * +----------------------------------------------+
+ * | extra area for variable-length values        |
+ * +----------------------------------------------+
  */
 typedef struct {
 	/* true, if column is held by value. Elsewhere, a reference */
@@ -659,13 +686,15 @@ typedef struct
 	cl_uint				hash;	/* 32-bit hash value */
 	cl_uint				next;	/* offset of the next */
 	cl_uint				rowid;	/* unique identifier of this hash entry */
-	cl_uint				__padding__; /* for alignment */
+	cl_uint				heavy_base;	/* 1 + first rowid of the heavy-hitter
+									 * group, or 0 if regular entry */
 	kern_tupitem		t;		/* HeapTuple of this entry */
 } kern_hashitem;
 
 #define KDS_FORMAT_ROW			1
 #define KDS_FORMAT_SLOT			2
 #define KDS_FORMAT_HASH			3	/* inner hash table for GpuHashJoin */
+#define KDS_FORMAT_COLUMN		4	/* referenced columns only */
 
 typedef struct {
 	hostptr_t		hostptr;	/* address of kds on the host */
@@ -767,6 +796,35 @@ typedef struct {
 #define KERN_DATA_STORE_ISNULL(kds,kds_index)				\
 	((char *)(KERN_DATA_STORE_VALUES((kds),(kds_index)) + (kds)->ncols))
 
+/* access macro for column-format */
+#define KERN_DATA_STORE_COLUMN_OFFSET(kds)					\
+	((cl_uint *)KERN_DATA_STORE_BODY(kds))
+
+/*
+ * NOTE: fixed-length values are placed on the unit size rounded up to the
+ * alignment, because attlen is not always multiple of attalign (timetz)
+ */
+#define KDS_COLUMN_UNITSZ(attlen,attalign)					\
+	((attlen) > 0 ? TYPEALIGN((attalign),(attlen)) : sizeof(cl_uint))
+
+#define KDS_COLUMN_NULLMAP_LENGTH(nrooms)					\
+	STROMALIGN(((nrooms) + BITS_PER_BYTE - 1) / BITS_PER_BYTE)
+
+#define KDS_CALCULATE_COLUMN_HEAD_LENGTH(ncols)				\
+	(KDS_CALCULATE_HEAD_LENGTH(ncols) +						\
+	 STROMALIGN(sizeof(cl_uint) * (ncols)))
+
+#define KDS_CALCULATE_COLUMN_LENGTH(attlen,attalign,nrooms)	\
+	(KDS_COLUMN_NULLMAP_LENGTH(nrooms) +					\
+	 STROMALIGN(KDS_COLUMN_UNITSZ((attlen),(attalign)) * (nrooms)))
+
+#define KERN_DATA_STORE_COLUMN_NULLMAP(kds,colidx)			\
+	((cl_uchar *)(kds) + KERN_DATA_STORE_COLUMN_OFFSET(kds)[(colidx)])
+
+#define KERN_DATA_STORE_COLUMN_VALUES(kds,colidx)			\
+	((char *)KERN_DATA_STORE_COLUMN_NULLMAP((kds),(colidx)) +	\
+	 KDS_COLUMN_NULLMAP_LENGTH((kds)->nrooms))
+
 
 STATIC_INLINE(kern_hashitem *)
 KERN_HASH_FIRST_ITEM(kern_data_store *kds, cl_uint hash)
@@ -806,6 +864,144 @@ pointer_on_kds(void *ptr, kern_data_store *kds)
 				   (char *)ptr <  (char *)kds + kds->length);
 }
 
+/*
+ * kern_compressed_kds
+ *
+ * Compressed image of kern_data_store for DMA send. KDS is split into the
+ * segments of KDS_COMPRESS_SEGMENT_SZ, then each segment is compressed
+ * individually, so a warp can decompress a segment on the device side.
+ * A segment that is not compressible is stored as is; it is identified by
+ * its length.
+ * A compressed segment is a series of sequences (LZ77 like). A sequence
+ * begins with a tag byte; upper 4bits is length of the literals, and lower
+ * 4bits is length of the match - KDS_COMPRESS_MIN_MATCH. 15 means extra
+ * bytes follow; 255 of them continue the next byte. The literals follow the
+ * tag, then 2-bytes offset of the match (little endian) and extra bytes of
+ * the match length. The last sequence of the segment may have literals only.
+ */
+#define KDS_COMPRESS_SEGMENT_SZ		8192
+#define KDS_COMPRESS_MIN_MATCH		4
+
+typedef struct {
+	cl_uint		length;		/* length of the original kern_data_store */
+	cl_uint		nsegments;	/* number of the segments */
+	cl_uint		seg_offset[FLEXIBLE_ARRAY_MEMBER];	/* (nsegments + 1) items;
+													 * offset from the head */
+} kern_compressed_kds;
+
+#define KERN_COMPRESSED_KDS_HEAD_LENGTH(nsegments)		\
+	STROMALIGN(offsetof(kern_compressed_kds, seg_offset[(nsegments) + 1]))
+#define KERN_COMPRESSED_KDS_LENGTH(kcmp)				\
+	((kcmp)->seg_offset[(kcmp)->nsegments])
+
+#ifdef __CUDACC__
+/*
+ * kern_decompress_kds
+ *
+ * It decompresses kern_compressed_kds into the kern_data_store. A warp
+ * takes a segment; all the lanes walk on the sequences together, and copy
+ * the literals or matches in parallel. Length of the thread block must be
+ * multiple of warpSize.
+ * A match may refer the bytes written by other lanes in the previous copy
+ * step, so all the lanes must be synchronized after each step. Because
+ * pos/dpos are uniform within a warp, all the lanes reach the steps
+ * together; __syncwarp() makes it sure on CUDA 9.0 or later, which does
+ * not assume lockstep execution of the warp any more. Elsewhere, we rely
+ * on the lockstep execution, and the memory fence only.
+ */
+#if defined(__CUDACC_VER_MAJOR__) && __CUDACC_VER_MAJOR__ >= 9
+#define KDS_DECOMPRESS_SYNC()		__syncwarp()
+#else
+#define KDS_DECOMPRESS_SYNC()		__threadfence_block()
+#endif
+
+KERNEL_FUNCTION(void)
+kern_decompress_kds(kern_compressed_kds *kcmp, kern_data_store *kds_dst)
+{
+	cl_uint		lane_id = get_local_id() % warpSize;
+	cl_uint		nwarps = get_global_size() / warpSize;
+	cl_uint		seg_index;
+
+	for (seg_index = get_global_id() / warpSize;
+		 seg_index < kcmp->nsegments;
+		 seg_index += nwarps)
+	{
+		const cl_uchar *pos = (const cl_uchar *)kcmp +
+			kcmp->seg_offset[seg_index];
+		const cl_uchar *end = (const cl_uchar *)kcmp +
+			kcmp->seg_offset[seg_index + 1];
+		cl_uchar   *dst = (cl_uchar *)kds_dst +
+			(size_t)seg_index * KDS_COMPRESS_SEGMENT_SZ;
+		cl_uint		rawsz = Min(KDS_COMPRESS_SEGMENT_SZ,
+								kcmp->length -
+								seg_index * KDS_COMPRESS_SEGMENT_SZ);
+		cl_uint		dpos = 0;
+		cl_uint		nbytes;
+		cl_uint		offset;
+		cl_uint		i, c;
+
+		/* uncompressed segment */
+		if (end - pos == rawsz)
+		{
+			for (i=lane_id; i < rawsz; i += warpSize)
+				dst[i] = pos[i];
+			continue;
+		}
+
+		while (pos < end)
+		{
+			cl_uint		tag = *pos++;
+
+			/* literals */
+			nbytes = (tag >> 4);
+			if (nbytes == 15)
+			{
+				do {
+					c = *pos++;
+					nbytes += c;
+				} while (c == 255);
+			}
+			for (i=lane_id; i < nbytes; i += warpSize)
+				dst[dpos + i] = pos[i];
+			KDS_DECOMPRESS_SYNC();
+			pos += nbytes;
+			dpos += nbytes;
+			if (pos >= end)
+				break;		/* last sequence */
+
+			/* match */
+			offset = (cl_uint)pos[0] | ((cl_uint)pos[1] << 8);
+			pos += 2;
+			nbytes = (tag & 0x0f);
+			if (nbytes == 15)
+			{
+				do {
+					c = *pos++;
+					nbytes += c;
+				} while (c == 255);
+			}
+			nbytes += KDS_COMPRESS_MIN_MATCH;
+
+			/*
+			 * The match may overlap with the bytes to be written, so we
+			 * copy at most 'offset' bytes at once; these are already
+			 * written by the previous steps.
+			 */
+			while (nbytes > 0)
+			{
+				cl_uint		n = Min(nbytes, offset);
+
+				for (i=lane_id; i < n; i += warpSize)
+					dst[dpos + i] = dst[dpos - offset + i];
+				KDS_DECOMPRESS_SYNC();
+				dpos += n;
+				nbytes -= n;
+			}
+		}
+	}
+}
+#endif	/* __CUDACC__ */
+
 /*
  * kern_parambuf
  *
@@ -821,6 +1017,7 @@ typedef struct kern_parambuf
 	 * Fields of system information on execution
 	 */
 	cl_long		xactStartTimestamp;	/* timestamp when transaction start */
+	cl_uint		session_tz_offset;	/* offset of kern_session_tz, or 0 */
 
 	/* variable length parameters / constants */
 	cl_uint		length;		/* total length of parambuf */
@@ -1564,6 +1761,27 @@ kern_get_datum_slot(kern_data_store *kds,
 	return (char *)values[colidx];
 }
 
+STATIC_FUNCTION(void *)
+kern_get_datum_column(kern_data_store *kds,
+					  cl_uint colidx, cl_uint rowidx)
+{
+	kern_colmeta	cmeta = kds->colmeta[colidx];
+	cl_uchar	   *nullmap;
+	char		   *values;
+
+	/* not a referenced column */
+	if (KERN_DATA_STORE_COLUMN_OFFSET(kds)[colidx] == 0)
+		return NULL;
+	nullmap = KERN_DATA_STORE_COLUMN_NULLMAP(kds, colidx);
+	if (att_isnull(rowidx, nullmap))
+		return NULL;
+	values = KERN_DATA_STORE_COLUMN_VALUES(kds, colidx);
+	if (cmeta.attlen > 0)
+		return values + KDS_COLUMN_UNITSZ(cmeta.attlen,
+										  cmeta.attalign) * rowidx;
+	return (char *)kds + ((cl_uint *)values)[rowidx];
+}
+
 STATIC_INLINE(void *)
 kern_get_datum(kern_data_store *kds,
 			   cl_uint colidx, cl_uint rowidx)
@@ -1576,6 +1794,8 @@ kern_get_datum(kern_data_store *kds,
 		return kern_get_datum_row(kds, colidx, rowidx);
 	if (kds->format == KDS_FORMAT_SLOT)
 		return kern_get_datum_slot(kds, colidx, rowidx);
+	if (kds->format == KDS_FORMAT_COLUMN)
+		return kern_get_datum_column(kds, colidx, rowidx);
 	/* TODO: put StromError_DataStoreCorruption error here */
 	return NULL;
 }
@@ -16,12 +16,14 @@
  * GNU General Public License for more details.
  */
 #include "postgres.h"
+#include "access/hash.h"
 #include "catalog/pg_type.h"
 #include "executor/instrument.h"
 #include "funcapi.h"
 #include "lib/ilist.h"
 #include "port/atomics.h"
 #include "storage/bufmgr.h"
+#include "storage/fd.h"
 #include "storage/ipc.h"
 #include "storage/latch.h"
 #include "storage/proc.h"
@@ -31,7 +33,9 @@
 #include "utils/memutils.h"
 #include "utils/pg_crc.h"
 #include "utils/resowner.h"
+#include "utils/timestamp.h"
 #include <math.h>
+#include <sched.h>
 #include "pg_strom.h"
 #include "cuda_dynpara.h"
 
@@ -39,6 +43,8 @@
 static List		   *cuda_device_ordinals = NIL;
 static List		   *cuda_device_capabilities = NIL;
 static List		   *cuda_device_mem_sizes = NIL;	/* in MB */
+static List		   *cuda_device_throughputs = NIL;	/* cores x MHz */
+static List		   *cuda_device_numa_nodes = NIL;	/* -1, if unknown */
 static size_t		cuda_max_malloc_size = INT_MAX;
 static size_t		cuda_max_threads_per_block = INT_MAX;
 static size_t		cuda_local_mem_size = INT_MAX;
@@ -55,6 +61,8 @@ static CUcontext   *cuda_last_contexts = NULL;	/* last used sanity context */
 /* misc static variables */
 static shmem_startup_hook_type shmem_startup_next;
 
+static void reset_workgroup_size_cache(void);
+
 /* ----------------------------------------------------------------
  *
  * Routines to share the status of device resource consumption
@@ -66,7 +74,17 @@ typedef struct {
 	pg_atomic_uint32	num_gcontext;	/* total number of GpuContext */
 	struct {
 		cl_ulong			gmem_size;	/* never updated */
+		cl_uint				throughput;	/* never updated */
+		cl_int				numa_node;	/* never updated */
 		pg_atomic_uint64	gmem_used;	/* total amount of DRAM usage */
+		/* statistics of the device memory pool */
+		pg_atomic_uint64	gmem_retained;	/* DRAM retained across queries */
+		pg_atomic_uint64	num_dev_malloc;	/* # of cuMemAlloc calls */
+		pg_atomic_uint64	num_dev_mfree;	/* # of cuMemFree calls */
+		pg_atomic_uint64	num_pool_alloc;	/* # of allocation from pool */
+		/* statistics of the task admission control */
+		pg_atomic_uint32	num_running;	/* # of running tasks */
+		pg_atomic_uint64	num_throttled;	/* # of throttled launches */
 	} gpu[FLEXIBLE_ARRAY_MEMBER];
 } GpuScoreBoard;
 
@@ -88,6 +106,185 @@ static GpuScoreBoard	   *gpuScoreBoard;
 								(size));					\
 		(gcontext)->gpu[(cuda_index)].gmem_used -= (size);	\
 	} while(0)
+#define GpuScoreCurrRunning(cuda_index)			\
+	pg_atomic_read_u32(&gpuScoreBoard->gpu[(cuda_index)].num_running)
+#define GpuScoreInclRunning(gcontext,cuda_index,count)		\
+	do {													\
+		pg_atomic_fetch_add_u32(&gpuScoreBoard->gpu[(cuda_index)].num_running, \
+								(count));					\
+		(gcontext)->gpu[(cuda_index)].num_running += (count);	\
+	} while(0)
+#define GpuScoreDeclRunning(gcontext,cuda_index,count)		\
+	do {													\
+		pg_atomic_fetch_sub_u32(&gpuScoreBoard->gpu[(cuda_index)].num_running, \
+								(count));					\
+		(gcontext)->gpu[(cuda_index)].num_running -= (count);	\
+	} while(0)
+
+/*
+ * GUC variables of the admission control. Both are PGC_SUSET, so they can
+ * be assigned per role by ALTER ROLE ... SET.
+ */
+static int			gpu_max_device_tasks;	/* GUC */
+static int			gpu_memory_quota_kb;	/* GUC */
+
+#define gpu_memory_quota		((size_t)gpu_memory_quota_kb << 10)
+
+/*
+ * NUMA awareness; a backend prefers the devices, and the host pinned memory,
+ * on the NUMA node local to its CPU. Score of the device on the remote node
+ * is multiplied by GPU_NUMA_REMOTE_PENALTY, so remote devices are used only
+ * when local ones are busy enough.
+ */
+static bool			gpu_numa_aware;			/* GUC */
+
+#define GPU_NUMA_REMOTE_PENALTY		2.0
+
+/* ----------------------------------------------------------------
+ *
+ * Cumulative performance statistics across the backends
+ *
+ * Performance counters of GpuTaskState (pgstrom_perfmon) are per query
+ * execution, and gone at the end of the query. GpuStatBoard accumulates
+ * the delta of them for each device and for each type of GPU node,
+ * according to the device the task was launched on, so we can observe
+ * the GPU workload of the whole system by pgstrom.perfmon_stat view.
+ *
+ * ----------------------------------------------------------------
+ */
+#define GPUSTAT_NODE_GPUSCAN		0
+#define GPUSTAT_NODE_GPUJOIN		1
+#define GPUSTAT_NODE_GPUPREAGG		2
+#define GPUSTAT_NODE_GPUSORT		3
+#define GPUSTAT_NUM_NODES			4
+
+static const char  *gpustat_node_names[GPUSTAT_NUM_NODES] = {
+	"GpuScan",
+	"GpuJoin",
+	"GpuPreAgg",
+	"GpuSort",
+};
+
+/*
+ * gpustat_items - counters of pgstrom_perfmon to be accumulated. node < 0
+ * means the item is common for all the node types. Offset of bytes or time
+ * is negative if the counter has no such kind of values.
+ */
+typedef struct
+{
+	cl_int		node;			/* one of GPUSTAT_NODE_*, or -1 */
+	const char *label;
+	ssize_t		num_offset;		/* offset of cl_uint counter */
+	ssize_t		bytes_offset;	/* offset of cl_ulong counter, or -1 */
+	ssize_t		tv_offset;		/* offset of cl_double counter, or -1 */
+} gpustat_item;
+
+#define GPUSTAT_COMMON(label,num,bytes,tv)				\
+	{ -1, (label), offsetof(pgstrom_perfmon, num),		\
+	  offsetof(pgstrom_perfmon, bytes),					\
+	  offsetof(pgstrom_perfmon, tv) }
+#define GPUSTAT_KERNEL(node,label,subf,num_field,tv_field)			\
+	{ (node), (label), offsetof(pgstrom_perfmon, subf.num_field),	\
+	  -1, offsetof(pgstrom_perfmon, subf.tv_field) }
+
+static const gpustat_item gpustat_items[] = {
+	{ -1, "tasks", offsetof(pgstrom_perfmon, num_tasks), -1, -1 },
+	GPUSTAT_COMMON("DMA send",
+				   num_dma_send, bytes_dma_send, time_dma_send),
+	GPUSTAT_COMMON("DMA recv",
+				   num_dma_recv, bytes_dma_recv, time_dma_recv),
+	GPUSTAT_COMMON("DMA compress",
+				   num_dma_compress, bytes_dma_compress, time_dma_compress),
+	{ GPUSTAT_NODE_GPUJOIN, "DMA send (inner)",
+	  offsetof(pgstrom_perfmon, gjoin.num_inner_dma_send),
+	  offsetof(pgstrom_perfmon, gjoin.bytes_inner_dma_send),
+	  offsetof(pgstrom_perfmon, gjoin.tv_inner_dma_send) },
+	/* GpuScan */
+	GPUSTAT_KERNEL(GPUSTAT_NODE_GPUSCAN, "gpuscan_exec_quals",
+				   gscan, num_kern_exec_quals, tv_kern_exec_quals),
+	GPUSTAT_KERNEL(GPUSTAT_NODE_GPUSCAN, "gpuscan_projection",
+				   gscan, num_kern_projection, tv_kern_projection),
+	/* GpuJoin */
+	GPUSTAT_KERNEL(GPUSTAT_NODE_GPUJOIN, "gpujoin_main",
+				   gjoin, num_kern_main, tv_kern_main),
+	GPUSTAT_KERNEL(GPUSTAT_NODE_GPUJOIN, "gpujoin_exec_outerscan",
+				   gjoin, num_kern_outer_scan, tv_kern_outer_scan),
+	GPUSTAT_KERNEL(GPUSTAT_NODE_GPUJOIN, "gpujoin_exec_nestloop",
+				   gjoin, num_kern_exec_nestloop, tv_kern_exec_nestloop),
+	GPUSTAT_KERNEL(GPUSTAT_NODE_GPUJOIN, "gpujoin_exec_hashjoin",
+				   gjoin, num_kern_exec_hashjoin, tv_kern_exec_hashjoin),
+	GPUSTAT_KERNEL(GPUSTAT_NODE_GPUJOIN, "gpujoin_outer_nestloop",
+				   gjoin, num_kern_outer_nestloop, tv_kern_outer_nestloop),
+	GPUSTAT_KERNEL(GPUSTAT_NODE_GPUJOIN, "gpujoin_outer_hashjoin",
+				   gjoin, num_kern_outer_hashjoin, tv_kern_outer_hashjoin),
+	GPUSTAT_KERNEL(GPUSTAT_NODE_GPUJOIN, "gpujoin_projection",
+				   gjoin, num_kern_projection, tv_kern_projection),
+	GPUSTAT_KERNEL(GPUSTAT_NODE_GPUJOIN, "gpujoin_count_rows_dist",
+				   gjoin, num_kern_rows_dist, tv_kern_rows_dist),
+	/* GpuPreAgg */
+	GPUSTAT_KERNEL(GPUSTAT_NODE_GPUPREAGG, "gpupreagg_main",
+				   gpreagg, num_kern_main, tv_kern_main),
+	GPUSTAT_KERNEL(GPUSTAT_NODE_GPUPREAGG, "gpupreagg_preparation",
+				   gpreagg, num_kern_prep, tv_kern_prep),
+	GPUSTAT_KERNEL(GPUSTAT_NODE_GPUPREAGG, "gpupreagg_nogroup_reduction",
+				   gpreagg, num_kern_nogrp, tv_kern_nogrp),
+	GPUSTAT_KERNEL(GPUSTAT_NODE_GPUPREAGG, "gpupreagg_local_reduction",
+				   gpreagg, num_kern_lagg, tv_kern_lagg),
+	GPUSTAT_KERNEL(GPUSTAT_NODE_GPUPREAGG, "gpupreagg_global_reduction",
+				   gpreagg, num_kern_gagg, tv_kern_gagg),
+	GPUSTAT_KERNEL(GPUSTAT_NODE_GPUPREAGG, "gpupreagg_final_reduction",
+				   gpreagg, num_kern_fagg, tv_kern_fagg),
+	GPUSTAT_KERNEL(GPUSTAT_NODE_GPUPREAGG, "gpupreagg_fixup_varlena",
+				   gpreagg, num_kern_fixvar, tv_kern_fixvar),
+	/* GpuSort */
+	GPUSTAT_KERNEL(GPUSTAT_NODE_GPUSORT, "gpusort_projection",
+				   gsort, num_kern_proj, tv_kern_proj),
+	GPUSTAT_KERNEL(GPUSTAT_NODE_GPUSORT, "gpusort_main",
+				   gsort, num_kern_main, tv_kern_main),
+	GPUSTAT_KERNEL(GPUSTAT_NODE_GPUSORT, "gpusort_bitonic_local",
+				   gsort, num_kern_lsort, tv_kern_lsort),
+	GPUSTAT_KERNEL(GPUSTAT_NODE_GPUSORT, "gpusort_bitonic_step",
+				   gsort, num_kern_ssort, tv_kern_ssort),
+	GPUSTAT_KERNEL(GPUSTAT_NODE_GPUSORT, "gpusort_bitonic_merge",
+				   gsort, num_kern_msort, tv_kern_msort),
+	GPUSTAT_KERNEL(GPUSTAT_NODE_GPUSORT, "gpusort_fixup_pointers",
+				   gsort, num_kern_fixvar, tv_kern_fixvar),
+};
+#undef GPUSTAT_COMMON
+#undef GPUSTAT_KERNEL
+#define GPUSTAT_NUM_ITEMS	lengthof(gpustat_items)
+
+typedef struct
+{
+	cl_ulong	count;
+	cl_ulong	bytes;
+	cl_double	time;			/* in milliseconds */
+} gpustat_counter;
+
+typedef struct
+{
+	cl_ulong		num_fallback;	/* # of tasks with CPU fallback */
+	gpustat_counter	items[GPUSTAT_NUM_ITEMS];
+} gpustat_node;
+
+typedef struct {
+	slock_t			lock;
+	TimestampTz		stats_reset;	/* last time of reset */
+	/* statistics of the program cache */
+	cl_ulong		num_cache_hit;	/* # of lookup on the built program */
+	cl_ulong		num_cache_miss;	/* # of new program cache entries */
+	cl_ulong		num_file_load;	/* # of load from the persistent cache */
+	cl_ulong		num_build;		/* # of run-time compile */
+	cl_ulong		num_build_failed; /* # of compile errors */
+	cl_double		tv_build;		/* time of run-time compile in ms */
+	/* statistics for each device and GPU node */
+	gpustat_node	stat[FLEXIBLE_ARRAY_MEMBER];	/* [device][node] */
+} GpuStatBoard;
+
+static GpuStatBoard	   *gpuStatBoard;
+
+#define GPUSTAT_NODE_ENTRY(cuda_index,node)						\
+	(&gpuStatBoard->stat[(cuda_index) * GPUSTAT_NUM_NODES + (node)])
 
 /* ----------------------------------------------------------------
  *
@@ -97,12 +294,11 @@ static GpuScoreBoard	   *gpuScoreBoard;
  */
 typedef struct GpuMemBlock
 {
-	dlist_node		chain;			/* link to active/unused_blocks */
+	dlist_node		chain;			/* link to blocks or retained_blocks */
 	CUdeviceptr		block_addr;		/* head of device address */
 	size_t			block_size;		/* length of the block */
-	size_t			max_free_size;	/* max available space in this block */
+	bool			is_large;		/* true, if dedicated to a large chunk */
 	dlist_head		addr_chunks;	/* chunks in order of address */
-	dlist_head		free_chunks;	/* free chunks */
 } GpuMemBlock;
 
 typedef struct GpuMemChunk
@@ -112,18 +308,45 @@ typedef struct GpuMemChunk
 	dlist_node		free_chain;	/* link to free_chunks, or zero if active */
 	dlist_node		hash_chain;	/* link to hash_table, or zero if free  */
 	CUdeviceptr		chunk_addr;
-	size_t			chunk_size;
+	int				chunk_class;/* size of the chunk in 2^N bytes */
 } GpuMemChunk;
 
+#define GPUMEM_CHUNK_IS_FREE(gm_chunk)					\
+	((gm_chunk)->free_chain.prev && (gm_chunk)->free_chain.next)
+#define GPUMEM_CHUNK_SIZE(gm_chunk)						\
+	((gm_chunk)->gm_block->is_large						\
+	 ? (gm_chunk)->gm_block->block_size					\
+	 : (1UL << (gm_chunk)->chunk_class))
+#define GPUMEM_BLOCK_IS_EMPTY(gm_block)					\
+	(dlist_head_node(&(gm_block)->addr_chunks) ==		\
+	 dlist_tail_node(&(gm_block)->addr_chunks) &&		\
+	 GPUMEM_CHUNK_IS_FREE(dlist_container(GpuMemChunk, addr_chain,	\
+							dlist_head_node(&(gm_block)->addr_chunks))))
+
+/*
+ * Device memory pool per backend process. GpuMemBlock and GpuMemChunk are
+ * allocated on the gpumem_cxt, because empty blocks are retained on the
+ * gpumem_retained_blocks across GpuContexts (thus, queries) as long as the
+ * CUDA context is cached. All the stuff is backend local, so no locks are
+ * needed to manipulate the free lists.
+ */
+static MemoryContext gpumem_cxt = NULL;
+static dlist_head	gpumem_unused_blocks;	/* cache for GpuMemBlock */
+static dlist_head	gpumem_unused_chunks;	/* cache for GpuMemChunk */
+static dlist_head  *gpumem_retained_blocks = NULL;	/* for each device */
+static int			gpumem_retain_size_kb;	/* GUC */
+
+#define gpumem_retain_size		((size_t)gpumem_retain_size_kb << 10)
+
 static inline void
 gpuMemHeadInit(GpuMemHead *gm_head)
 {
 	int		i;
 
-	gm_head->empty_block = NULL;
-	dlist_init(&gm_head->active_blocks);
-	dlist_init(&gm_head->unused_chunks);
-	dlist_init(&gm_head->unused_blocks);
+	dlist_init(&gm_head->blocks);
+	for (i=0; i < lengthof(gm_head->free_chunks); i++)
+		dlist_init(&gm_head->free_chunks[i]);
+	gm_head->empty_size = 0;
 	for (i=0; i < lengthof(gm_head->hash_slots); i++)
 		dlist_init(&gm_head->hash_slots[i]);
 }
@@ -152,23 +375,36 @@ gpuMemMaxAllocSize(void)
 	return cuda_max_malloc_size;
 }
 
+/*
+ * gpuMemBlockSize
+ *
+ * size of the device memory block to be split into the size classes.
+ * Any request larger than this size has a dedicated block.
+ */
+static inline size_t
+gpuMemBlockSize(void)
+{
+	size_t		block_size = 8 * pgstrom_chunk_size();
+
+	return (1UL << Min(get_next_log2(block_size), GPUMEM_CHUNKSZ_MAX_BIT));
+}
+
 /*
  * gpuMemDump
  *
  * For debug, it dumps all the device memory chunks
  */
 static void
-__gpuMemDump(GpuMemBlock *gm_block, bool is_active)
+__gpuMemDump(GpuMemBlock *gm_block)
 {
 	GpuMemChunk	   *gm_chunk;
 	dlist_iter		iter;
 
-	elog(INFO, "GpuMemBlock: %p - %p (size: %zu, free: %zu, %s)",
+	elog(INFO, "GpuMemBlock: %p - %p (size: %zu%s)",
 		 (char *)(gm_block->block_addr),
 		 (char *)(gm_block->block_addr + gm_block->block_size),
 		 gm_block->block_size,
-		 gm_block->max_free_size,
-		 is_active ? "active" : "unused");
+		 gm_block->is_large ? ", large" : "");
 
 	dlist_foreach (iter, &gm_block->addr_chunks)
 	{
@@ -176,11 +412,10 @@ __gpuMemDump(GpuMemBlock *gm_block, bool is_active)
 
 		elog(INFO, "GpuMemChunk: %p - %p (offset: %08zx size: %08zx, %s)",
 			 (char *)(gm_chunk->chunk_addr),
-			 (char *)(gm_chunk->chunk_addr + gm_chunk->chunk_size),
+			 (char *)(gm_chunk->chunk_addr + GPUMEM_CHUNK_SIZE(gm_chunk)),
 			 (char *)gm_chunk->chunk_addr - (char *)gm_block->block_addr,
-			 gm_chunk->chunk_size,
-			 (!gm_chunk->free_chain.prev &&
-			  !gm_chunk->free_chain.next) ? "active" : "free");
+			 GPUMEM_CHUNK_SIZE(gm_chunk),
+			 GPUMEM_CHUNK_IS_FREE(gm_chunk) ? "free" : "active");
 	}
 }
 
@@ -191,154 +426,241 @@ gpuMemDump(GpuContext *gcontext, int cuda_index)
 	GpuMemBlock	   *gm_block;
 	dlist_iter		iter;
 
-	dlist_foreach (iter, &gm_head->active_blocks)
+	dlist_foreach (iter, &gm_head->blocks)
 	{
 		gm_block = dlist_container(GpuMemBlock, chain, iter.cur);
-		__gpuMemDump(gm_block, true);
+		__gpuMemDump(gm_block);
 	}
-	if (gm_head->empty_block)
-		__gpuMemDump(gm_head->empty_block, false);
 }
 
-#ifdef NOT_USED
-static void
-__gpuMemSanityCheck(GpuMemHead *gm_head, GpuMemBlock *gm_block)
+/*
+ * Routines to manage GpuMemBlock / GpuMemChunk entries
+ */
+static GpuMemChunk *
+gpuMemChunkAlloc(void)
 {
 	GpuMemChunk	   *gm_chunk;
-	GpuMemChunk	   *gm_temp;
-	dlist_iter		iter;
-	dlist_iter		hiter;
-	CUdeviceptr		curr_addr = gm_block->block_addr;
 
-	dlist_foreach (iter, &gm_block->addr_chunks)
+	if (dlist_is_empty(&gpumem_unused_chunks))
+		gm_chunk = MemoryContextAlloc(gpumem_cxt, sizeof(GpuMemChunk));
+	else
+		gm_chunk = dlist_container(GpuMemChunk, addr_chain,
+							dlist_pop_head_node(&gpumem_unused_chunks));
+	memset(gm_chunk, 0, sizeof(GpuMemChunk));
+	return gm_chunk;
+}
+
+static void
+gpuMemChunkRelease(GpuMemChunk *gm_chunk)
+{
+	memset(gm_chunk, 0, sizeof(GpuMemChunk));
+	dlist_push_head(&gpumem_unused_chunks, &gm_chunk->addr_chain);
+}
+
+static GpuMemBlock *
+gpuMemBlockAlloc(void)
+{
+	GpuMemBlock	   *gm_block;
+
+	if (dlist_is_empty(&gpumem_unused_blocks))
+		gm_block = MemoryContextAlloc(gpumem_cxt, sizeof(GpuMemBlock));
+	else
+		gm_block = dlist_container(GpuMemBlock, chain,
+							dlist_pop_head_node(&gpumem_unused_blocks));
+	memset(gm_block, 0, sizeof(GpuMemBlock));
+	dlist_init(&gm_block->addr_chunks);
+	return gm_block;
+}
+
+static void
+gpuMemBlockRelease(GpuMemBlock *gm_block)
+{
+	while (!dlist_is_empty(&gm_block->addr_chunks))
 	{
-		gm_chunk = dlist_container(GpuMemChunk, addr_chain, iter.cur);
-		Assert(gm_chunk->chunk_addr == curr_addr);
-		curr_addr += gm_chunk->chunk_size;
-		Assert(curr_addr <= gm_block->block_addr + gm_block->block_size);
+		dlist_node	   *dnode = dlist_pop_head_node(&gm_block->addr_chunks);
 
-		if (gm_chunk->hash_chain.prev && gm_chunk->hash_chain.next)
-		{
-			int		index = gpuMemHashIndex(gm_head, gm_chunk->chunk_addr);
-			bool	found = false;
+		gpuMemChunkRelease(dlist_container(GpuMemChunk, addr_chain, dnode));
+	}
+	memset(gm_block, 0, sizeof(GpuMemBlock));
+	dlist_push_head(&gpumem_unused_blocks, &gm_block->chain);
+}
 
-			Assert(!gm_chunk->free_chain.prev && !gm_chunk->free_chain.next);
-			dlist_foreach (hiter, &gm_head->hash_slots[index])
-			{
-				gm_temp = dlist_container(GpuMemChunk, hash_chain, hiter.cur);
-				if (gm_temp->chunk_addr == gm_chunk->chunk_addr)
-				{
-					found = true;
-					break;
-				}
-			}
-			Assert(found);
-			elog(INFO, "sanity %zx - %zx (active)",
-				 (Size)(gm_chunk->chunk_addr),
-				 (Size)(gm_chunk->chunk_addr + gm_chunk->chunk_size));
-		}
-		else if (gm_chunk->free_chain.prev && gm_chunk->free_chain.next)
-		{
-			bool	found = false;
+/*
+ * gpuMemPushFreeChunk / gpuMemPopFreeChunk
+ *
+ * It put or pick up a free chunk of the size class, and tracks the total
+ * size of the empty blocks.
+ */
+static void
+gpuMemPushFreeChunk(GpuMemHead *gm_head, GpuMemChunk *gm_chunk)
+{
+	GpuMemBlock	   *gm_block = gm_chunk->gm_block;
+
+	Assert(!gm_block->is_large);
+	Assert(!GPUMEM_CHUNK_IS_FREE(gm_chunk));
+	dlist_push_head(&gm_head->free_chunks[gm_chunk->chunk_class],
+					&gm_chunk->free_chain);
+	if ((1UL << gm_chunk->chunk_class) == gm_block->block_size)
+		gm_head->empty_size += gm_block->block_size;
+}
 
-			Assert(!gm_chunk->hash_chain.prev && !gm_chunk->hash_chain.next);
-			dlist_foreach (hiter, &gm_block->free_chunks)
-			{
-				gm_temp = dlist_container(GpuMemChunk, free_chain, hiter.cur);
-				if (gm_temp->chunk_addr == gm_chunk->chunk_addr)
-				{
-					found = true;
-					break;
-				}
-			}
-			Assert(found);
-			elog(INFO, "sanity %zx - %zx (free)",
-				 (Size)(gm_chunk->chunk_addr),
-				 (Size)(gm_chunk->chunk_addr + gm_chunk->chunk_size));
-		}
-		else
-			Assert(false);	/* neither active nor free */
+static GpuMemChunk *
+gpuMemPopFreeChunk(GpuMemHead *gm_head, int chunk_class)
+{
+	GpuMemChunk	   *gm_chunk;
+	GpuMemBlock	   *gm_block;
+	dlist_node	   *dnode;
+
+	Assert(!dlist_is_empty(&gm_head->free_chunks[chunk_class]));
+	dnode = dlist_pop_head_node(&gm_head->free_chunks[chunk_class]);
+	gm_chunk = dlist_container(GpuMemChunk, free_chain, dnode);
+	memset(&gm_chunk->free_chain, 0, sizeof(dlist_node));
+	Assert(gm_chunk->chunk_class == chunk_class);
+
+	gm_block = gm_chunk->gm_block;
+	if ((1UL << chunk_class) == gm_block->block_size)
+	{
+		Assert(gm_head->empty_size >= gm_block->block_size);
+		gm_head->empty_size -= gm_block->block_size;
 	}
-	Assert(curr_addr == gm_block->block_addr + gm_block->block_size);
+	return gm_chunk;
 }
 
+/*
+ * gpuMemSplit
+ *
+ * It splits a free chunk of the supplied class into two buddies.
+ */
+static bool
+gpuMemSplit(GpuMemHead *gm_head, int chunk_class)
+{
+	GpuMemChunk	   *gm_chunk1;
+	GpuMemChunk	   *gm_chunk2;
+
+	if (chunk_class > GPUMEM_CHUNKSZ_MAX_BIT)
+		return false;	/* nothing to split any more */
+	if (dlist_is_empty(&gm_head->free_chunks[chunk_class]))
+	{
+		if (!gpuMemSplit(gm_head, chunk_class + 1))
+			return false;	/* no larger free chunk any more */
+	}
+	gm_chunk2 = gpuMemChunkAlloc();
+	gm_chunk1 = gpuMemPopFreeChunk(gm_head, chunk_class);
+	gm_chunk1->chunk_class = chunk_class - 1;
+
+	gm_chunk2->gm_block = gm_chunk1->gm_block;
+	gm_chunk2->chunk_addr = gm_chunk1->chunk_addr + (1UL << (chunk_class - 1));
+	gm_chunk2->chunk_class = chunk_class - 1;
+	dlist_insert_after(&gm_chunk1->addr_chain, &gm_chunk2->addr_chain);
+
+	gpuMemPushFreeChunk(gm_head, gm_chunk2);
+	gpuMemPushFreeChunk(gm_head, gm_chunk1);
+
+	return true;
+}
+
+/*
+ * __gpuMemFreeBlock
+ *
+ * It releases the device memory of the block, and its entries.
+ * Caller has to detach the block from the list, and update the scoreboard.
+ */
 static void
-gpuMemSanityCheck(GpuContext *gcontext, int cuda_index)
+__gpuMemFreeBlock(GpuContext *gcontext, CUcontext cuda_context,
+				  int cuda_index, GpuMemBlock *gm_block)
+{
+	CUresult		rc;
+	struct timeval	tv1, tv2;
+
+	gettimeofday(&tv1, NULL);
+
+	rc = cuCtxPushCurrent(cuda_context);
+	if (rc != CUDA_SUCCESS)
+		elog(ERROR, "failed on cuCtxPushCurrent: %s", errorText(rc));
+
+	rc = cuMemFree(gm_block->block_addr);
+	if (rc != CUDA_SUCCESS)
+		elog(ERROR, "failed on cuMemFree: %s", errorText(rc));
+
+	rc = cuCtxPopCurrent(NULL);
+	if (rc != CUDA_SUCCESS)
+		elog(WARNING, "failed on cuCtxPopCurrent: %s", errorText(rc));
+
+	/* update performance statistics */
+	gettimeofday(&tv2, NULL);
+	if (gcontext)
+	{
+		gcontext->num_dev_mfree++;
+		PFMON_ADD_TIMEVAL(&gcontext->tv_dev_mfree, &tv1, &tv2);
+	}
+	pg_atomic_fetch_add_u64(&gpuScoreBoard->gpu[cuda_index].num_dev_mfree, 1);
+
+	elog(DEBUG1, "cuMemFree(%08zx - %08zx, size=%zuMB)",
+		 (size_t)gm_block->block_addr,
+		 ((size_t)gm_block->block_addr + gm_block->block_size),
+		 ((size_t)gm_block->block_size) >> 20);
+
+	gpuMemBlockRelease(gm_block);
+}
+
+/*
+ * gpuMemReleaseEmptyBlocks
+ *
+ * It releases empty blocks of the GpuContext, to make room for a new
+ * block. It returns true, if any.
+ */
+static bool
+gpuMemReleaseEmptyBlocks(GpuContext *gcontext, int cuda_index)
 {
 	GpuMemHead	   *gm_head = &gcontext->gpu[cuda_index].cuda_memory;
 	GpuMemBlock	   *gm_block;
-	dlist_iter		iter;
+	dlist_mutable_iter iter;
+	bool			released = false;
 
-	dlist_foreach (iter, &gm_head->active_blocks)
+	dlist_foreach_modify(iter, &gm_head->blocks)
 	{
+		GpuMemChunk	   *gm_chunk;
+		size_t			block_size;
+
 		gm_block = dlist_container(GpuMemBlock, chain, iter.cur);
-		__gpuMemSanityCheck(gm_head, gm_block);
+		if (gm_block->is_large || !GPUMEM_BLOCK_IS_EMPTY(gm_block))
+			continue;
+		gm_chunk = dlist_container(GpuMemChunk, addr_chain,
+								   dlist_head_node(&gm_block->addr_chunks));
+		dlist_delete(&gm_chunk->free_chain);
+		memset(&gm_chunk->free_chain, 0, sizeof(dlist_node));
+		gm_head->empty_size -= gm_block->block_size;
+		dlist_delete(&gm_block->chain);
+
+		block_size = gm_block->block_size;
+		__gpuMemFreeBlock(gcontext, gcontext->gpu[cuda_index].cuda_context,
+						  cuda_index, gm_block);
+		GpuScoreDeclMemUsage(gcontext, cuda_index, block_size);
+		released = true;
 	}
-	if (gm_head->empty_block)
-		__gpuMemSanityCheck(gm_head, gm_head->empty_block);
-	elog(INFO, "looks to sanity...");
+	return released;
 }
-#endif
 
-CUdeviceptr
-__gpuMemAlloc(GpuContext *gcontext, int cuda_index, size_t bytesize)
+/*
+ * gpuMemAllocBlock
+ *
+ * It allocates a new device memory block, and returns the chunk that
+ * covers the whole block. NULL means resource starvation, so caller shall
+ * wait for release of the device memory by other tasks.
+ */
+static GpuMemChunk *
+gpuMemAllocBlock(GpuContext *gcontext, int cuda_index,
+				 size_t block_size, bool is_large)
 {
-	GpuMemHead	   *gm_head;
+	GpuMemHead	   *gm_head = &gcontext->gpu[cuda_index].cuda_memory;
 	GpuMemBlock	   *gm_block;
 	GpuMemChunk	   *gm_chunk;
-	GpuMemChunk	   *new_chunk;
-	dlist_node	   *dnode;
-	dlist_iter		iter;
 	CUdeviceptr		block_addr;
 	CUresult		rc;
-	int				index;
 	uint32			curr_numcxt;
 	size_t			curr_limit;
-	size_t			required;
 	struct timeval	tv1, tv2;
 
-	/* round up to 1KB align */
-	bytesize = TYPEALIGN(1024, bytesize);
-
-	/* try to find out preliminary allocated block */
-	Assert(cuda_index < gcontext->num_context);
-	gm_head = &gcontext->gpu[cuda_index].cuda_memory;
-
-	dlist_foreach(iter, &gm_head->active_blocks)
-	{
-		gm_block = dlist_container(GpuMemBlock, chain, iter.cur);
-		if (gm_block->max_free_size > bytesize)
-			goto found;
-	}
-
-#ifdef NOT_USED
-	/*
-	 * MEMO: Device memory reuse seems doubtful; that may cause unexpected
-	 * allocation on a different context, then it will lead memory access
-	 * violation. So, we tentatively disable the feature.
-	 */
-	if (gm_head->empty_block)
-	{
-		gm_block = gm_head->empty_block;
-		if (gm_block->max_free_size > bytesize)
-		{
-			Assert(!gm_block->chain.prev && !gm_block->chain.next);
-			gm_head->empty_block = NULL;
-			dlist_push_head(&gm_head->active_blocks, &gm_block->chain);
-			goto found;
-		}
-	}
-#endif
-	/*
-	 * no space available on the preliminary allocated block,
-	 * so we try to allocate device memory in advance.
-	 *
-	 * NOTE: we should give more practical estimation for
-	 * device memory requirement. smaller number of kernel
-	 * driver call makes better performance!
-	 */
-	required = Max(pgstrom_chunk_size() * 11, bytesize);
-	required = TYPEALIGN(1024 * 1024, required);	/* round up to 1MB */
 #ifdef USE_ASSERT_CHECKING
 	{
 		/*
@@ -353,6 +675,7 @@ __gpuMemAlloc(GpuContext *gcontext, int cuda_index, size_t bytesize)
 		Assert(curr_context == gcontext->gpu[cuda_index].cuda_context);
 	}
 #endif
+retry:
 	/*
 	 * NOTE: GPU device memory allocation limit.
 	 * We assume GPU has relatively small amount of RAM compared to the
@@ -367,6 +690,10 @@ __gpuMemAlloc(GpuContext *gcontext, int cuda_index, size_t bytesize)
 				  sqrt((double)(curr_numcxt + 1)));
 	if (gcontext->gpu[cuda_index].gmem_used >= curr_limit)
 	{
+		/* empty blocks of unfit size classes are released first */
+		if (gpuMemReleaseEmptyBlocks(gcontext, cuda_index))
+			goto retry;
+
 		/*
 		 * Even if GPU memory usage is larger than threshold, we may be
 		 * able to allocate amount of actually allocated is smaller than
@@ -377,7 +704,22 @@ __gpuMemAlloc(GpuContext *gcontext, int cuda_index, size_t bytesize)
 		/* GpuScoreCurrMemUsage(cuda_index) */
 		elog(DEBUG1, "gpuMemAlloc failed due to resource limitation");
 
-		return 0UL;		/* need to wait... */
+		return NULL;	/* need to wait... */
+	}
+
+	/*
+	 * NOTE: Device memory quota of the role, if any. The first block is
+	 * always allowed, so the backend can make progress by itself.
+	 */
+	if (gpu_memory_quota_kb > 0 &&
+		gcontext->gpu[cuda_index].gmem_used > 0 &&
+		gcontext->gpu[cuda_index].gmem_used + block_size > gpu_memory_quota)
+	{
+		if (gpuMemReleaseEmptyBlocks(gcontext, cuda_index))
+			goto retry;
+		elog(DEBUG1, "gpuMemAlloc failed due to device memory quota");
+
+		return NULL;	/* need to wait... */
 	}
 
 	/*
@@ -385,13 +727,15 @@ __gpuMemAlloc(GpuContext *gcontext, int cuda_index, size_t bytesize)
 	 * down the system. We may need to have cooling-down time here.
 	 */
 	gettimeofday(&tv1, NULL);
-	rc = cuMemAlloc(&block_addr, required);
+	rc = cuMemAlloc(&block_addr, block_size);
 	if (rc != CUDA_SUCCESS)
 	{
 		if (rc == CUDA_ERROR_OUT_OF_MEMORY)
 		{
+			if (gpuMemReleaseEmptyBlocks(gcontext, cuda_index))
+				goto retry;
 			elog(DEBUG1, "cuMemAlloc failed due to CUDA_ERROR_OUT_OF_MEMORY");
-			return 0UL;		/* need to wait... */
+			return NULL;	/* need to wait... */
 		}
 		elog(ERROR, "failed on cuMemAlloc: %s", errorText(rc));
 	}
@@ -399,122 +743,89 @@ __gpuMemAlloc(GpuContext *gcontext, int cuda_index, size_t bytesize)
 	gettimeofday(&tv2, NULL);
 	gcontext->num_dev_malloc++;
 	PFMON_ADD_TIMEVAL(&gcontext->tv_dev_malloc, &tv1, &tv2);
+	pg_atomic_fetch_add_u64(&gpuScoreBoard->gpu[cuda_index].num_dev_malloc, 1);
 
 	/* update scoreboard for resource control */
-	GpuScoreInclMemUsage(gcontext, cuda_index, required);
+	GpuScoreInclMemUsage(gcontext, cuda_index, block_size);
 
 	elog(DEBUG1, "cuMemAlloc(%08zx - %08zx, size=%zuMB)",
 		 (size_t)(block_addr),
-		 (size_t)(block_addr + required),
-		 (size_t)required >> 20);
+		 (size_t)(block_addr + block_size),
+		 (size_t)block_size >> 20);
 
-	if (dlist_is_empty(&gm_head->unused_blocks))
-		gm_block = MemoryContextAlloc(gcontext->memcxt, sizeof(GpuMemBlock));
-	else
-	{
-		dnode = dlist_pop_head_node(&gm_head->unused_blocks);
-		gm_block = dlist_container(GpuMemBlock, chain, dnode);
-	}
-	memset(gm_block, 0, sizeof(GpuMemBlock));
+	gm_block = gpuMemBlockAlloc();
 	gm_block->block_addr = block_addr;
-	gm_block->block_size = required;
-	gm_block->max_free_size = required;
-	dlist_init(&gm_block->addr_chunks);
-	dlist_init(&gm_block->free_chunks);
+	gm_block->block_size = block_size;
+	gm_block->is_large = is_large;
 
-	if (dlist_is_empty(&gm_head->unused_chunks))
-		gm_chunk = MemoryContextAlloc(gcontext->memcxt, sizeof(GpuMemChunk));
-	else
-	{
-		dnode = dlist_pop_head_node(&gm_head->unused_chunks);
-		gm_chunk = dlist_container(GpuMemChunk, addr_chain, dnode);
-	}
-	memset(gm_chunk, 0, sizeof(GpuMemChunk));
+	gm_chunk = gpuMemChunkAlloc();
 	gm_chunk->gm_block = gm_block;
-	dlist_push_head(&gm_block->addr_chunks, &gm_chunk->addr_chain);
-	dlist_push_head(&gm_block->free_chunks, &gm_chunk->free_chain);
-	memset(&gm_chunk->hash_chain, 0, sizeof(dlist_node));
 	gm_chunk->chunk_addr = block_addr;
-	gm_chunk->chunk_size = required;
+	gm_chunk->chunk_class = (is_large ? 0 : get_next_log2(block_size));
+	dlist_push_head(&gm_block->addr_chunks, &gm_chunk->addr_chain);
 
-	dlist_push_head(&gm_head->active_blocks, &gm_block->chain);
+	dlist_push_head(&gm_head->blocks, &gm_block->chain);
 
-found:
-	dlist_foreach(iter, &gm_block->free_chunks)
-	{
-		gm_chunk = dlist_container(GpuMemChunk, free_chain, iter.cur);
+	return gm_chunk;
+}
 
-		Assert(!gm_chunk->hash_chain.prev && !gm_chunk->hash_chain.next);
-		if (gm_chunk->chunk_size < bytesize)
-			continue;
+CUdeviceptr
+__gpuMemAlloc(GpuContext *gcontext, int cuda_index, size_t bytesize)
+{
+	GpuMemHead	   *gm_head;
+	GpuMemChunk	   *gm_chunk;
+	size_t			block_size = gpuMemBlockSize();
+	int				chunk_class;
+	int				index;
 
-		/* no need to split, just replace free chunk */
-		if (gm_chunk->chunk_size == bytesize)
-		{
-			dlist_delete(&gm_chunk->free_chain);
-			memset(&gm_chunk->free_chain, 0, sizeof(dlist_node));
+	Assert(cuda_index < gcontext->num_context);
+	gm_head = &gcontext->gpu[cuda_index].cuda_memory;
 
-			index = gpuMemHashIndex(gm_head, gm_chunk->chunk_addr);
-			dlist_push_tail(&gm_head->hash_slots[index],
-							&gm_chunk->hash_chain);
-			if (gm_block->max_free_size == gm_chunk->chunk_size)
-			{
-				gm_block->max_free_size = 0;
-				dlist_foreach(iter, &gm_block->free_chunks)
-				{
-					GpuMemChunk	   *temp = dlist_container(GpuMemChunk,
-														   free_chain,
-														   iter.cur);
-					gm_block->max_free_size = Max(gm_block->max_free_size,
-												  temp->chunk_size);
-				}
-			}
-			return gm_chunk->chunk_addr;
-		}
+	if (bytesize > block_size)
+	{
+		/*
+		 * Large request has a dedicated block, because 2^N rounding up
+		 * wastes too much device memory.
+		 */
+		bytesize = TYPEALIGN(1024 * 1024, bytesize);	/* round up to 1MB */
+		gm_chunk = gpuMemAllocBlock(gcontext, cuda_index, bytesize, true);
+		if (!gm_chunk)
+			return 0UL;		/* need to wait... */
+	}
+	else
+	{
+		/* round up to the size class; 1KB at least */
+		chunk_class = Max(get_next_log2(bytesize), GPUMEM_CHUNKSZ_MIN_BIT);
 
-		/* larger free chunk found, so let's split it */
-		if (dlist_is_empty(&gm_head->unused_chunks))
-			new_chunk = MemoryContextAlloc(gcontext->memcxt,
-										   sizeof(GpuMemChunk));
-		else
+		if (!dlist_is_empty(&gm_head->free_chunks[chunk_class]) ||
+			gpuMemSplit(gm_head, chunk_class + 1))
 		{
-			dnode = dlist_pop_head_node(&gm_head->unused_chunks);
-			new_chunk = dlist_container(GpuMemChunk, addr_chain, dnode);
+			/* the request could be served by the memory pool */
+			pg_atomic_fetch_add_u64(&gpuScoreBoard->gpu[cuda_index].
+									num_pool_alloc, 1);
 		}
-		memset(new_chunk, 0, sizeof(GpuMemChunk));
-		new_chunk->gm_block = gm_block;
-		new_chunk->chunk_addr = gm_chunk->chunk_addr + bytesize;
-		new_chunk->chunk_size = gm_chunk->chunk_size - bytesize;
-		gm_chunk->chunk_size = bytesize;
-
-		/* add new one just after the old one */
-		dlist_insert_after(&gm_chunk->addr_chain, &new_chunk->addr_chain);
-		/* remove old one from the free list */
-		dlist_delete(&gm_chunk->free_chain);
-		memset(&gm_chunk->free_chain, 0, sizeof(dlist_node));
-		/* add new one to the free list */
-		dlist_push_tail(&gm_block->free_chunks, &new_chunk->free_chain);
-
-		/* add active portion to the hash table */
-		index = gpuMemHashIndex(gm_head, gm_chunk->chunk_addr);
-		dlist_push_tail(&gm_head->hash_slots[index],
-						&gm_chunk->hash_chain);
-		if (gm_block->max_free_size == new_chunk->chunk_size + bytesize)
+		else
 		{
-			gm_block->max_free_size = 0;
-			dlist_foreach(iter, &gm_block->free_chunks)
+			gm_chunk = gpuMemAllocBlock(gcontext, cuda_index,
+										block_size, false);
+			if (!gm_chunk)
+				return 0UL;		/* need to wait... */
+			gpuMemPushFreeChunk(gm_head, gm_chunk);
+
+			if (dlist_is_empty(&gm_head->free_chunks[chunk_class]) &&
+				!gpuMemSplit(gm_head, chunk_class + 1))
 			{
-				GpuMemChunk    *temp = dlist_container(GpuMemChunk,
-													   free_chain,
-													   iter.cur);
-				gm_block->max_free_size = Max(gm_block->max_free_size,
-											  temp->chunk_size);
+				gpuMemDump(gcontext, cuda_index);
+				elog(ERROR, "Bug? we could not find a free chunk in GpuMemBlock (%zu)", bytesize);
 			}
 		}
-		return gm_chunk->chunk_addr;
+		gm_chunk = gpuMemPopFreeChunk(gm_head, chunk_class);
 	}
-	gpuMemDump(gcontext, cuda_index);
-	elog(ERROR, "Bug? we could not find a free chunk in GpuMemBlock (%zu)", bytesize);
+	/* add active chunk to the hash table */
+	index = gpuMemHashIndex(gm_head, gm_chunk->chunk_addr);
+	dlist_push_tail(&gm_head->hash_slots[index], &gm_chunk->hash_chain);
+
+	return gm_chunk->chunk_addr;
 }
 
 CUdeviceptr
@@ -534,13 +845,12 @@ __gpuMemFree(GpuContext *gcontext, int cuda_index, CUdeviceptr chunk_addr)
 	GpuMemHead	   *gm_head;
 	GpuMemBlock	   *gm_block;
 	GpuMemChunk	   *gm_chunk;
-	GpuMemChunk	   *gm_prev;
-	GpuMemChunk	   *gm_next;
+	GpuMemChunk	   *gm_buddy;
 	dlist_node	   *dnode;
 	dlist_iter		iter;
-	CUresult		rc;
+	size_t			offset;
+	size_t			block_size;
 	int				index;
-	struct timeval	tv1, tv2;
 
 	/* find out the cuda-context */
 	Assert(cuda_index < gcontext->num_context);
@@ -562,132 +872,69 @@ found:
 	dlist_delete(&gm_chunk->hash_chain);
 	memset(&gm_chunk->hash_chain, 0, sizeof(dlist_node));
 
-	/* sanity check; chunks should be within block */
 	gm_block = gm_chunk->gm_block;
+	block_size = gm_block->block_size;
+	if (gm_block->is_large)
+	{
+		/* dedicated block is released immediately */
+		dlist_delete(&gm_block->chain);
+		__gpuMemFreeBlock(gcontext, gcontext->gpu[cuda_index].cuda_context,
+						  cuda_index, gm_block);
+		GpuScoreDeclMemUsage(gcontext, cuda_index, block_size);
+		return;
+	}
+
+	/* sanity check; chunks should be within block */
 	Assert(gm_chunk->chunk_addr >= gm_block->block_addr &&
-		   (gm_chunk->chunk_addr + gm_chunk->chunk_size) <=
+		   (gm_chunk->chunk_addr + GPUMEM_CHUNK_SIZE(gm_chunk)) <=
 		   (gm_block->block_addr + gm_block->block_size));
-	gm_block->max_free_size = Max(gm_block->max_free_size,
-								  gm_chunk->chunk_size);
-
-	/* back to the free_list */
-	Assert(!gm_chunk->free_chain.prev && !gm_chunk->free_chain.next);
-	dlist_push_head(&gm_block->free_chunks, &gm_chunk->free_chain);
-
-	if (dlist_has_prev(&gm_block->addr_chunks,
-					   &gm_chunk->addr_chain))
-	{
-		dnode = dlist_prev_node(&gm_block->addr_chunks,
-								&gm_chunk->addr_chain);
-		gm_prev = dlist_container(GpuMemChunk, addr_chain, dnode);
-		Assert(gm_prev->chunk_addr +
-			   gm_prev->chunk_size == gm_chunk->chunk_addr);
-		if (gm_prev->free_chain.prev && gm_prev->free_chain.next)
-		{
-			Assert(!gm_prev->hash_chain.prev &&
-				   !gm_prev->hash_chain.next);
-			/* OK, it can be merged */
-			dlist_delete(&gm_chunk->addr_chain);
-			dlist_delete(&gm_chunk->free_chain);
-			gm_prev->chunk_size += gm_chunk->chunk_size;
-
-			/* update max_free_size if needed */
-			gm_block->max_free_size = Max(gm_block->max_free_size,
-										  gm_prev->chunk_size);
-
-			/* GpuMemChunk entry may be reused soon */
-			memset(gm_chunk, 0, sizeof(GpuMemChunk));
-			dlist_push_head(&gm_head->unused_chunks, &gm_chunk->addr_chain);
-
-			gm_chunk = gm_prev;
-		}
-		else
-			Assert(!gm_prev->free_chain.prev && !gm_prev->free_chain.next);
-	}
 
-	if (dlist_has_next(&gm_block->addr_chunks,
-					   &gm_chunk->addr_chain))
+	/* try to merge with the buddy chunk, if it is also free */
+	while ((1UL << gm_chunk->chunk_class) < block_size)
 	{
-		dnode = dlist_next_node(&gm_block->addr_chunks,
-								&gm_chunk->addr_chain);
-		gm_next = dlist_container(GpuMemChunk, addr_chain, dnode);
-		Assert(gm_chunk->chunk_addr +
-			   gm_chunk->chunk_size == gm_next->chunk_addr);
-		if (gm_next->free_chain.prev && gm_next->free_chain.next)
+		offset = gm_chunk->chunk_addr - gm_block->block_addr;
+		if ((offset & (1UL << gm_chunk->chunk_class)) != 0)
 		{
-			Assert(!gm_next->hash_chain.prev &&
-				   !gm_next->hash_chain.next);
-			/* OK, it can be merged */
-			dlist_delete(&gm_next->addr_chain);
-			dlist_delete(&gm_next->free_chain);
-			gm_chunk->chunk_size += gm_next->chunk_size;
-
-			/* update max_free_size if needed */
-			gm_block->max_free_size = Max(gm_block->max_free_size,
-										  gm_chunk->chunk_size);
-
-			/* GpuMemChunk entry may be reused soon */
-			memset(gm_next, 0, sizeof(GpuMemChunk));
-			dlist_push_head(&gm_head->unused_chunks, &gm_next->addr_chain);
+			Assert(dlist_has_prev(&gm_block->addr_chunks,
+								  &gm_chunk->addr_chain));
+			dnode = dlist_prev_node(&gm_block->addr_chunks,
+									&gm_chunk->addr_chain);
 		}
 		else
-			Assert(!gm_next->free_chain.prev && !gm_next->free_chain.next);
+		{
+			Assert(dlist_has_next(&gm_block->addr_chunks,
+								  &gm_chunk->addr_chain));
+			dnode = dlist_next_node(&gm_block->addr_chunks,
+									&gm_chunk->addr_chain);
+		}
+		gm_buddy = dlist_container(GpuMemChunk, addr_chain, dnode);
+		if (!GPUMEM_CHUNK_IS_FREE(gm_buddy) ||
+			gm_buddy->chunk_class != gm_chunk->chunk_class)
+			break;
+
+		/* OK, chunk and buddy can be merged */
+		dlist_delete(&gm_buddy->free_chain);
+		dlist_delete(&gm_buddy->addr_chain);
+		if (gm_buddy->chunk_addr < gm_chunk->chunk_addr)
+			gm_chunk->chunk_addr = gm_buddy->chunk_addr;
+		gm_chunk->chunk_class++;
+		/* GpuMemChunk entry may be reused soon */
+		gpuMemChunkRelease(gm_buddy);
 	}
+	gpuMemPushFreeChunk(gm_head, gm_chunk);
 
 	/*
-	 * Try to check GpuMemBlock is still active or not
+	 * Empty blocks are kept in the memory pool unless total size of the
+	 * empty blocks exceeds pg_strom.gpumem_retain_size.
 	 */
-	if (!dlist_has_prev(&gm_block->addr_chunks, &gm_chunk->addr_chain) &&
-		!dlist_has_next(&gm_block->addr_chunks, &gm_chunk->addr_chain))
-	{
-		Assert(gm_chunk->free_chain.prev && gm_chunk->free_chain.next);
-		Assert(!gm_chunk->hash_chain.prev && !gm_chunk->hash_chain.next);
-		Assert(gm_block->block_addr == gm_chunk->chunk_addr &&
-			   gm_block->block_size == gm_chunk->chunk_size);
-		Assert(gm_block->max_free_size == gm_block->block_size);
-		/* OK, it looks to up an empty block */
+	if ((1UL << gm_chunk->chunk_class) == block_size &&
+		gm_head->empty_size > gpumem_retain_size)
+	{
+		gm_chunk = gpuMemPopFreeChunk(gm_head, gm_chunk->chunk_class);
 		dlist_delete(&gm_block->chain);
-		memset(&gm_block->chain, 0, sizeof(dlist_node));
-
-#ifdef NOT_USED
-		/* One empty block shall be kept, but no more */
-		if (!gm_head->empty_block)
-			gm_head->empty_block = gm_block;
-		else
-#endif
-		{
-			gettimeofday(&tv1, NULL);
-
-			rc = cuCtxPushCurrent(gcontext->gpu[cuda_index].cuda_context);
-			if (rc != CUDA_SUCCESS)
-				elog(ERROR, "failed on cuCtxPushCurrent: %s", errorText(rc));
-
-			rc = cuMemFree(gm_block->block_addr);
-			if (rc != CUDA_SUCCESS)
-				elog(ERROR, "failed on cuMemFree: %s", errorText(rc));
-
-			rc = cuCtxPopCurrent(NULL);
-			if (rc != CUDA_SUCCESS)
-				elog(WARNING, "failed on cuCtxPopCurrent: %s", errorText(rc));
-
-			/* update performance statistics */
-			gettimeofday(&tv2, NULL);
-			gcontext->num_dev_mfree++;
-			PFMON_ADD_TIMEVAL(&gcontext->tv_dev_mfree, &tv1, &tv2);
-
-			/* update scoreboard for resource control */
-			GpuScoreDeclMemUsage(gcontext, cuda_index, gm_block->block_size);
-
-			elog(DEBUG1, "cuMemFree(%08zx - %08zx, size=%zuMB)",
-				 (size_t)gm_block->block_addr,
-				 ((size_t)gm_block->block_addr + gm_block->block_size),
-				 ((size_t)gm_block->block_size) >> 20);
-
-			memset(gm_chunk, 0, sizeof(GpuMemChunk));
-			dlist_push_head(&gm_head->unused_chunks, &gm_chunk->addr_chain);
-			memset(gm_block, 0, sizeof(GpuMemBlock));
-			dlist_push_head(&gm_head->unused_blocks, &gm_block->chain);
-		}
+		__gpuMemFreeBlock(gcontext, gcontext->gpu[cuda_index].cuda_context,
+						  cuda_index, gm_block);
+		GpuScoreDeclMemUsage(gcontext, cuda_index, block_size);
 	}
 }
 
@@ -697,6 +944,24 @@ gpuMemFree(GpuTask *gtask, CUdeviceptr chunk_addr)
 	__gpuMemFree(gtask->gts->gcontext, gtask->cuda_index, chunk_addr);
 }
 
+/*
+ * gpuMemHasActiveChunks
+ *
+ * It checks whether any device memory chunks are still in use.
+ */
+static bool
+gpuMemHasActiveChunks(GpuMemHead *gm_head)
+{
+	int		i;
+
+	for (i=0; i < lengthof(gm_head->hash_slots); i++)
+	{
+		if (!dlist_is_empty(&gm_head->hash_slots[i]))
+			return true;
+	}
+	return false;
+}
+
 /*
  * gpuMemFreeAll
  *
@@ -709,41 +974,147 @@ gpuMemFreeAll(GpuContext *gcontext)
 	GpuMemHead	   *gm_head;
 	GpuMemBlock	   *gm_block;
 	dlist_node	   *dnode;
+	size_t			block_size;
 	int				index;
-	CUresult		rc;
 
 	for (index=0; index < cuda_num_devices; index++)
 	{
-		rc = cuCtxPushCurrent(gcontext->gpu[index].cuda_context);
-		if (rc != CUDA_SUCCESS)
-			elog(WARNING, "failed on cuCtxPushCurrent: %s", errorText(rc));
-
 		gm_head = &gcontext->gpu[index].cuda_memory;
-#ifdef NOT_USED
-		if (gm_head->empty_block)
+		while (!dlist_is_empty(&gm_head->blocks))
 		{
-			gm_block = gm_head->empty_block;
-			rc = cuMemFree(gm_block->block_addr);
-			if (rc != CUDA_SUCCESS)
-				elog(ERROR, "failed on cuMemFree: %s", errorText(rc));
-			GpuScoreDeclMemUsage(gcontext, index, gm_block->block_size);
-			gm_head->empty_block = NULL;
+			dnode = dlist_pop_head_node(&gm_head->blocks);
+			gm_block = dlist_container(GpuMemBlock, chain, dnode);
+			block_size = gm_block->block_size;
+			__gpuMemFreeBlock(gcontext, gcontext->gpu[index].cuda_context,
+							  index, gm_block);
+			GpuScoreDeclMemUsage(gcontext, index, block_size);
 		}
-#endif
-		while (!dlist_is_empty(&gm_head->active_blocks))
+		gpuMemHeadInit(gm_head);
+	}
+}
+
+/*
+ * gpuMemRetainAll
+ *
+ * It moves empty blocks of the GpuContext to the memory pool, up to
+ * pg_strom.gpumem_retain_size per device, and releases the others.
+ * Caller has to ensure the CUDA context is cached for the next GpuContext.
+ */
+static void
+gpuMemRetainAll(GpuContext *gcontext)
+{
+	GpuMemHead	   *gm_head;
+	GpuMemBlock	   *gm_block;
+	GpuMemChunk	   *gm_chunk;
+	dlist_node	   *dnode;
+	size_t			block_size;
+	size_t			retained;
+	int				index;
+
+	for (index=0; index < cuda_num_devices; index++)
+	{
+		Assert(dlist_is_empty(&gpumem_retained_blocks[index]));
+		gm_head = &gcontext->gpu[index].cuda_memory;
+		retained = 0;
+		while (!dlist_is_empty(&gm_head->blocks))
 		{
-			dnode = dlist_pop_head_node(&gm_head->active_blocks);
+			dnode = dlist_pop_head_node(&gm_head->blocks);
 			gm_block = dlist_container(GpuMemBlock, chain, dnode);
+			block_size = gm_block->block_size;
 
-			rc = cuMemFree(gm_block->block_addr);
-			if (rc != CUDA_SUCCESS)
-				elog(ERROR, "failed on cuMemFree: %s", errorText(rc));
-			GpuScoreDeclMemUsage(gcontext, index, gm_block->block_size);
+			if (!gm_block->is_large &&
+				GPUMEM_BLOCK_IS_EMPTY(gm_block) &&
+				retained + block_size <= gpumem_retain_size)
+			{
+				gm_chunk = dlist_container(GpuMemChunk, addr_chain,
+									dlist_head_node(&gm_block->addr_chunks));
+				dlist_delete(&gm_chunk->free_chain);
+				memset(&gm_chunk->free_chain, 0, sizeof(dlist_node));
+				dlist_push_tail(&gpumem_retained_blocks[index],
+								&gm_block->chain);
+				retained += block_size;
+
+				/* block is no longer owned by GpuContext */
+				gcontext->gpu[index].gmem_used -= block_size;
+				pg_atomic_fetch_add_u64(&gpuScoreBoard->gpu[index].
+										gmem_retained, block_size);
+			}
+			else
+			{
+				__gpuMemFreeBlock(gcontext,
+								  gcontext->gpu[index].cuda_context,
+								  index, gm_block);
+				GpuScoreDeclMemUsage(gcontext, index, block_size);
+			}
 		}
+		gpuMemHeadInit(gm_head);
+	}
+}
 
-		rc = cuCtxPopCurrent(NULL);
-		if (rc != CUDA_SUCCESS)
-			elog(WARNING, "failed on cuCtxPopCurrent: %s", errorText(rc));
+/*
+ * gpuMemAdoptRetained
+ *
+ * It moves the retained blocks to the new GpuContext which reuses the
+ * cached CUDA context.
+ */
+static void
+gpuMemAdoptRetained(GpuContext *gcontext)
+{
+	GpuMemHead	   *gm_head;
+	GpuMemBlock	   *gm_block;
+	GpuMemChunk	   *gm_chunk;
+	dlist_node	   *dnode;
+	int				index;
+
+	for (index=0; index < cuda_num_devices; index++)
+	{
+		gm_head = &gcontext->gpu[index].cuda_memory;
+		while (!dlist_is_empty(&gpumem_retained_blocks[index]))
+		{
+			dnode = dlist_pop_head_node(&gpumem_retained_blocks[index]);
+			gm_block = dlist_container(GpuMemBlock, chain, dnode);
+			gm_chunk = dlist_container(GpuMemChunk, addr_chain,
+									dlist_head_node(&gm_block->addr_chunks));
+			dlist_push_tail(&gm_head->blocks, &gm_block->chain);
+			gpuMemPushFreeChunk(gm_head, gm_chunk);
+
+			gcontext->gpu[index].gmem_used += gm_block->block_size;
+			pg_atomic_fetch_sub_u64(&gpuScoreBoard->gpu[index].gmem_retained,
+									gm_block->block_size);
+		}
+	}
+}
+
+/*
+ * gpuMemFreeRetained
+ *
+ * It releases the retained blocks prior to destroy of the cached CUDA
+ * context.
+ */
+static void
+gpuMemFreeRetained(CUcontext *cuda_contexts)
+{
+	GpuMemBlock	   *gm_block;
+	dlist_node	   *dnode;
+	size_t			block_size;
+	int				index;
+
+	if (!gpumem_retained_blocks)
+		return;
+	for (index=0; index < cuda_num_devices; index++)
+	{
+		while (!dlist_is_empty(&gpumem_retained_blocks[index]))
+		{
+			dnode = dlist_pop_head_node(&gpumem_retained_blocks[index]);
+			gm_block = dlist_container(GpuMemBlock, chain, dnode);
+			block_size = gm_block->block_size;
+			__gpuMemFreeBlock(NULL, cuda_contexts[index], index, gm_block);
+
+			pg_atomic_fetch_sub_u64(&gpuScoreBoard->gpu[index].gmem_used,
+									block_size);
+			pg_atomic_fetch_sub_u64(&gpuScoreBoard->gpu[index].gmem_retained,
+									block_size);
+		}
 	}
 }
 
@@ -779,6 +1150,20 @@ pgstrom_init_cuda(void)
 	cuda_last_contexts = MemoryContextAllocZero(TopMemoryContext,
 												sizeof(CUcontext) *
 												cuda_num_devices);
+
+	/* device memory pool */
+	gpumem_cxt = AllocSetContextCreate(TopMemoryContext,
+									   "GPU Memory Pool",
+									   ALLOCSET_DEFAULT_MINSIZE,
+									   ALLOCSET_DEFAULT_INITSIZE,
+									   ALLOCSET_DEFAULT_MAXSIZE);
+	dlist_init(&gpumem_unused_blocks);
+	dlist_init(&gpumem_unused_chunks);
+	gpumem_retained_blocks = MemoryContextAlloc(TopMemoryContext,
+												sizeof(dlist_head) *
+												cuda_num_devices);
+	for (i=0; i < cuda_num_devices; i++)
+		dlist_init(&gpumem_retained_blocks[i]);
 }
 
 /*
@@ -813,6 +1198,9 @@ pgstrom_cleanup_cuda(int code, Datum arg)
 	{
 		int		i;
 
+		/* device memory retained on the cached CUDA context */
+		gpuMemFreeRetained(cuda_last_contexts);
+
 		for (i=0; i < cuda_num_devices; i++)
 		{
 			CUcontext	context = cuda_last_contexts[i];
@@ -833,6 +1221,99 @@ pgstrom_cleanup_cuda(int code, Datum arg)
 			 context_cached ? " and cached CUDA context" : "");
 }
 
+/*
+ * pci_device_numa_node
+ *
+ * It returns the NUMA node where the PCI device is connected to, or -1 if
+ * unknown (including non-NUMA system).
+ */
+static int
+pci_device_numa_node(int pci_domain, int pci_bus, int pci_device)
+{
+	char		path[MAXPGPATH];
+	FILE	   *filp;
+	int			numa_node;
+
+	snprintf(path, sizeof(path),
+			 "/sys/bus/pci/devices/%04x:%02x:%02x.0/numa_node",
+			 pci_domain, pci_bus, pci_device);
+	filp = AllocateFile(path, "r");
+	if (!filp)
+		return -1;
+	if (fscanf(filp, "%d", &numa_node) != 1)
+		numa_node = -1;
+	FreeFile(filp);
+
+	return numa_node;
+}
+
+/*
+ * current_numa_node
+ *
+ * It returns the NUMA node of the CPU where the current process is running
+ * on, or -1 if unknown. Note that process may migrate to another CPU later,
+ * so it is just a hint.
+ */
+static int
+current_numa_node(void)
+{
+	char		path[MAXPGPATH];
+	DIR		   *dir;
+	struct dirent *dent;
+	int			cpu = sched_getcpu();
+	int			numa_node = -1;
+
+	if (cpu < 0)
+		return -1;
+	snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d", cpu);
+	dir = AllocateDir(path);
+	if (!dir)
+		return -1;
+	while ((dent = ReadDir(dir, path)) != NULL)
+	{
+		if (strncmp(dent->d_name, "node", 4) == 0 &&
+			isdigit(dent->d_name[4]))
+		{
+			numa_node = atoi(dent->d_name + 4);
+			break;
+		}
+	}
+	FreeDir(dir);
+
+	return numa_node;
+}
+
+/*
+ * choose_gpucontext_numa_node
+ *
+ * It chooses the preferable NUMA node of the new GpuContext. If any devices
+ * are local to the CPU of the backend, it is the NUMA node of the CPU.
+ * Elsewhere, NUMA node of a device is chosen in round-robin manner, then
+ * the backend prefers the devices on the same node for the host pinned
+ * memory being local. -1 means no preference.
+ */
+static int
+choose_gpucontext_numa_node(void)
+{
+	int			numa_node;
+	int			i;
+
+	if (!gpu_numa_aware)
+		return -1;
+
+	numa_node = current_numa_node();
+	if (numa_node >= 0)
+	{
+		for (i=0; i < cuda_num_devices; i++)
+		{
+			if (gpuScoreBoard->gpu[i].numa_node == numa_node)
+				return numa_node;
+		}
+	}
+	/* no local devices on the CPU */
+	return gpuScoreBoard->gpu[MyProc->pgprocno % cuda_num_devices].numa_node;
+}
+
 static GpuContext *
 pgstrom_create_gpucontext(ResourceOwner resowner, bool *context_reused)
 {
@@ -845,10 +1326,12 @@ pgstrom_create_gpucontext(ResourceOwner resowner, bool *context_reused)
 	struct timeval *p_tv_host_malloc;
 	struct timeval *p_tv_host_mfree;
 	CUcontext	   *cuda_context_temp;
+	volatile bool	cuda_context_cached = false;
 	Size			length_gcxt;
 	Size			length_init;
 	Size			length_max;
 	char			namebuf[200];
+	int				numa_node;
 	int				index;
 	CUresult		rc;
 
@@ -875,6 +1358,7 @@ pgstrom_create_gpucontext(ResourceOwner resowner, bool *context_reused)
 				   sizeof(CUcontext) * cuda_num_devices);
 			memset(cuda_last_contexts, 0,
 				   sizeof(CUcontext) * cuda_num_devices);
+			cuda_context_cached = true;
 			*context_reused = true;
 		}
 		else
@@ -900,10 +1384,12 @@ pgstrom_create_gpucontext(ResourceOwner resowner, bool *context_reused)
 		snprintf(namebuf, sizeof(namebuf), "GPU DMA Buffer (%p)", resowner);
 		length_init = 4 * (1UL << get_next_log2(pgstrom_chunk_size()));
 		length_max = 1024 * length_init;
+		numa_node = choose_gpucontext_numa_node();
 
 		memcxt = HostPinMemContextCreate(NULL,
 										 namebuf,
 										 cuda_context_temp[0],
+										 numa_node,
 										 length_init,
 										 length_max,
 										 &p_keep_freemem,
@@ -930,15 +1416,23 @@ pgstrom_create_gpucontext(ResourceOwner resowner, bool *context_reused)
 		}
 		gcontext->num_context = cuda_num_devices;
         gcontext->next_context = (MyProc->pgprocno % cuda_num_devices);
+		gcontext->numa_node = numa_node;
 
 		/* Update the scoreboard of GPU usage */
 		pg_atomic_fetch_add_u32(&gpuScoreBoard->num_gcontext, 1);
+
+		/* device memory retained on the cached CUDA context, if any */
+		if (cuda_context_cached)
+			gpuMemAdoptRetained(gcontext);
 	}
 	PG_CATCH();
 	{
 		if (memcxt != NULL)
 			MemoryContextDelete(memcxt);
 
+		if (cuda_context_cached)
+			gpuMemFreeRetained(cuda_context_temp);
+
 		for (index=0; index < cuda_num_devices; index++)
 		{
 			if (cuda_context_temp[index])
@@ -1045,22 +1539,33 @@ pgstrom_release_gpucontext(GpuContext *gcontext, bool sanity_release)
 		keep_context = false;
 	}
 
-	/*
-	 * Release all the GPU device memory
-	 */
-	gpuMemFreeAll(gcontext);
-
 	for (i=0; i < gcontext->num_context; i++)
 	{
 		/* No device memory should be acquired if sanity release */
-		if (gcontext->gpu[i].gmem_used > 0)
+		if (gpuMemHasActiveChunks(&gcontext->gpu[i].cuda_memory))
 		{
 			elog(sanity_release ? NOTICE : DEBUG1,
 				 "Orphan GPU memory %zuKB on device %u",
 				 gcontext->gpu[i].gmem_used / 1024, i);
 			keep_context = false;
 		}
+	}
+
+	/*
+	 * Release all the GPU device memory, or retain empty blocks on the
+	 * memory pool if CUDA context shall be cached.
+	 */
+	if (keep_context && cuda_last_contexts[0] == NULL)
+		gpuMemRetainAll(gcontext);
+	else
+		gpuMemFreeAll(gcontext);
+
+	for (i=0; i < gcontext->num_context; i++)
+	{
+		Assert(gcontext->gpu[i].gmem_used == 0);
 		GpuScoreDeclMemUsage(gcontext, i, gcontext->gpu[i].gmem_used);
+		/* tasks might be still counted if aborted */
+		GpuScoreDeclRunning(gcontext, i, gcontext->gpu[i].num_running);
 	}
 
 	/*
@@ -1095,6 +1600,7 @@ pgstrom_release_gpucontext(GpuContext *gcontext, bool sanity_release)
 	 * So, we have to drop non-primary CUDA context, memory context, then
 	 * the primary CUDA context.
 	 */
+	reset_workgroup_size_cache();
 	cuda_context = gcontext->gpu[0].cuda_context;
 	for (i = gcontext->num_context - 1; i > 0; i--)
 	{
@@ -1131,6 +1637,7 @@ pgstrom_cleanup_gputaskstate(GpuTaskState *gts)
 	GpuContext	   *gcontext = gts->gcontext;
 	GpuTask		   *gtask;
 	dlist_node	   *dnode;
+	dlist_iter		iter;
 	CUresult		rc;
 	int				i;
 
@@ -1159,9 +1666,16 @@ pgstrom_cleanup_gputaskstate(GpuTaskState *gts)
 	}
 
 	/*
-	 * Release GpuTasks tracked by this GpuTaskState
+	 * Release GpuTasks tracked by this GpuTaskState; running tasks are
+	 * no longer counted by the admission control.
 	 */
 	SpinLockAcquire(&gts->lock);
+	dlist_foreach(iter, &gts->running_tasks)
+	{
+		gtask = dlist_container(GpuTask, chain, iter.cur);
+		if (!gtask->no_cuda_setup)
+			GpuScoreDeclRunning(gcontext, gtask->cuda_index, 1);
+	}
 	while (!dlist_is_empty(&gts->tracked_tasks))
 	{
 		dnode = dlist_pop_head_node(&gts->tracked_tasks);
@@ -1179,6 +1693,7 @@ pgstrom_cleanup_gputaskstate(GpuTaskState *gts)
 	gts->num_running_tasks = 0;
 	gts->num_pending_tasks = 0;
 	gts->num_ready_tasks = 0;
+	pg_atomic_write_u64(&gts->completed_stack, 0);
 	SpinLockRelease(&gts->lock);
 
 	gts->curr_task = NULL;
@@ -1214,6 +1729,8 @@ pgstrom_release_gputaskstate(GpuTaskState *gts)
 						 errorText(rc));
 			}
 			gts->cuda_modules = NULL;
+			/* CUfunction handles may be reused by the next module */
+			reset_workgroup_size_cache();
 		}
 		/* put reference to the GpuContext */
 		pgstrom_put_gpucontext(gts->gcontext);
@@ -1230,6 +1747,7 @@ pgstrom_init_gputaskstate(GpuContext *gcontext,
 	gts->kern_source = NULL;	/* to be set later */
 	gts->extra_flags = 0;		/* to be set later */
 	gts->cuda_modules = NULL;
+	gts->program_crc = 0;
 	gts->scan_done = false;
 	if (gcontext)
 		(*gcontext->p_keep_freemem)++;
@@ -1250,9 +1768,30 @@ pgstrom_init_gputaskstate(GpuContext *gcontext,
 		HeapScanDesc	scan_desc = heap_beginscan(scan_rel,
 												   estate->es_snapshot,
 												   0, NULL);
+		int				natts = RelationGetNumberOfAttributes(scan_rel);
+
 		gts->css.ss.ss_currentScanDesc = scan_desc;
+		gts->scan_pagebuf = MemoryContextAlloc(estate->es_query_cxt, BLCKSZ);
+		gts->scan_tup_values = MemoryContextAlloc(estate->es_query_cxt,
+												  sizeof(Datum) * natts);
+		gts->scan_tup_isnull = MemoryContextAlloc(estate->es_query_cxt,
+												  sizeof(bool) * natts);
+	}
+	else
+	{
+		gts->scan_pagebuf = NULL;
+		gts->scan_tup_values = NULL;
+		gts->scan_tup_isnull = NULL;
 	}
 	gts->scan_overflow = NULL;
+	gts->scan_prefetch_pos = 0;
+	gts->scan_block_map = NULL;
+	gts->scan_block_map_nblocks = 0;
+	gts->scan_block_skipped = 0;
+	gts->chunk_size_curr = 0;
+	gts->chunk_size_ceil = 0;
+	gts->chunk_overflow = 0;
+	pg_atomic_init_u64(&gts->completed_stack, 0);
 	SpinLockInit(&gts->lock);
 	dlist_init(&gts->tracked_tasks);
 	dlist_init(&gts->running_tasks);
@@ -1304,6 +1843,179 @@ pgstrom_deactivate_gputaskstate(GpuTaskState *gts)
 	}
 }
 
+/*
+ * pgstrom_complete_gputask
+ *
+ * It is called by the respond callback of CUDA stream, on the thread
+ * managed by CUDA runtime, to inform completion of the task. Task is
+ * pushed onto the lock-free completed_stack, then the backend is waked
+ * up by the latch. So, CUDA callbacks never contend with the backend on
+ * the spinlock of GpuTaskState, and the backend does not need to poll
+ * the task lists while nothing gets completed.
+ * The backend moves the tasks into completed_tasks at the next
+ * drain_completed_stack().
+ */
+void
+pgstrom_complete_gputask(GpuTask *gtask)
+{
+	GpuTaskState   *gts = gtask->gts;
+	uint64			oldval;
+
+	oldval = pg_atomic_read_u64(&gts->completed_stack);
+	do {
+		gtask->completed_next = (GpuTask *)(uintptr_t) oldval;
+	} while (!pg_atomic_compare_exchange_u64(&gts->completed_stack,
+											 &oldval,
+											 (uint64)(uintptr_t) gtask));
+	SetLatch(&MyProc->procLatch);
+}
+
+/*
+ * gpustat_account_task
+ *
+ * It accumulates the delta of the performance counters from the @pfm_base
+ * to the shared statistics for the device the task is assigned to.
+ * Caller has to take a snapshot of gts->pfm prior to the callback which
+ * may update the performance counters.
+ */
+static void
+gpustat_account_task(GpuTaskState *gts, cl_uint cuda_index,
+					 const pgstrom_perfmon *pfm_base, bool cpu_fallback)
+{
+	const char	   *curr = (const char *) &gts->pfm;
+	const char	   *base = (const char *) pfm_base;
+	gpustat_node   *gsnode;
+	int				node;
+	int				i;
+
+	if ((gts->extra_flags & DEVKERNEL_NEEDS_GPUSORT) != 0)
+		node = GPUSTAT_NODE_GPUSORT;
+	else if ((gts->extra_flags & DEVKERNEL_NEEDS_GPUPREAGG) != 0)
+		node = GPUSTAT_NODE_GPUPREAGG;
+	else if ((gts->extra_flags & DEVKERNEL_NEEDS_GPUJOIN) != 0)
+		node = GPUSTAT_NODE_GPUJOIN;
+	else if ((gts->extra_flags & DEVKERNEL_NEEDS_GPUSCAN) != 0)
+		node = GPUSTAT_NODE_GPUSCAN;
+	else
+		return;		/* not a target of the statistics */
+
+	Assert(cuda_index < gpuScoreBoard->num_devices);
+	gsnode = GPUSTAT_NODE_ENTRY(cuda_index, node);
+
+	SpinLockAcquire(&gpuStatBoard->lock);
+	if (cpu_fallback)
+		gsnode->num_fallback++;
+	for (i=0; i < GPUSTAT_NUM_ITEMS; i++)
+	{
+		const gpustat_item *item = &gpustat_items[i];
+		gpustat_counter	   *counter = &gsnode->items[i];
+
+		if (item->node >= 0 && item->node != node)
+			continue;
+		counter->count += (*((cl_uint *)(curr + item->num_offset)) -
+						   *((cl_uint *)(base + item->num_offset)));
+		if (item->bytes_offset >= 0)
+			counter->bytes += (*((cl_ulong *)(curr + item->bytes_offset)) -
+							   *((cl_ulong *)(base + item->bytes_offset)));
+		if (item->tv_offset >= 0)
+			counter->time += (*((cl_double *)(curr + item->tv_offset)) -
+							  *((cl_double *)(base + item->tv_offset)));
+	}
+	SpinLockRelease(&gpuStatBoard->lock);
+}
+
+/*
+ * pgstrom_gpustat_program_cache
+ *
+ * It counts a lookup of the program cache. A hit means the lookup found
+ * an entry already built, and a miss means a new entry was made.
+ */
+void
+pgstrom_gpustat_program_cache(bool cache_hit)
+{
+	SpinLockAcquire(&gpuStatBoard->lock);
+	if (cache_hit)
+		gpuStatBoard->num_cache_hit++;
+	else
+		gpuStatBoard->num_cache_miss++;
+	SpinLockRelease(&gpuStatBoard->lock);
+}
+
+/*
+ * pgstrom_gpustat_program_build
+ *
+ * It counts a build of the CUDA program, and time of the run-time compile
+ * in milliseconds if it was not loaded from the persistent program cache.
+ */
+void
+pgstrom_gpustat_program_build(bool from_file, bool build_failed,
+							  cl_double tv_build)
+{
+	SpinLockAcquire(&gpuStatBoard->lock);
+	if (from_file)
+		gpuStatBoard->num_file_load++;
+	else
+	{
+		gpuStatBoard->num_build++;
+		if (build_failed)
+			gpuStatBoard->num_build_failed++;
+		gpuStatBoard->tv_build += tv_build;
+	}
+	SpinLockRelease(&gpuStatBoard->lock);
+}
+
+/*
+ * drain_completed_stack
+ *
+ * It detaches all the tasks on the completed_stack at once, then moves
+ * them from the running_tasks to the completed_tasks in order of the
+ * completion. Only the backend consumes the stack, so no ABA problem
+ * happen here.
+ * Note that the task may not be attached on the running_tasks yet, if
+ * CUDA runtime called back prior to the end of launch_pending_tasks();
+ * however, it is never the case here because both of them are run by
+ * the backend.
+ *
+ * NOTE: spinlock has to be acquired before call
+ */
+static inline void
+drain_completed_stack(GpuTaskState *gts)
+{
+	GpuTask	   *gtask;
+	GpuTask	   *gnext;
+	GpuTask	   *ghead = NULL;
+
+	gtask = (GpuTask *)(uintptr_t)
+		pg_atomic_exchange_u64(&gts->completed_stack, 0);
+	/* reverse the LIFO order */
+	while (gtask)
+	{
+		gnext = gtask->completed_next;
+		gtask->completed_next = ghead;
+		ghead = gtask;
+		gtask = gnext;
+	}
+
+	for (gtask = ghead; gtask != NULL; gtask = gnext)
+	{
+		gnext = gtask->completed_next;
+		gtask->completed_next = NULL;
+
+		if (gtask->chain.prev && gtask->chain.next)
+		{
+			dlist_delete(&gtask->chain);
+			gts->num_running_tasks--;
+			if (!gtask->no_cuda_setup)
+				GpuScoreDeclRunning(gts->gcontext, gtask->cuda_index, 1);
+		}
+		if (gtask->kerror.errcode == StromError_Success)
+			dlist_push_tail(&gts->completed_tasks, &gtask->chain);
+		else
+			dlist_push_head(&gts->completed_tasks, &gtask->chain);
+		gts->num_completed_tasks++;
+	}
+}
+
 /*
  * check_completed_tasks
  *
@@ -1319,7 +2031,10 @@ check_completed_tasks(GpuTaskState *gts)
 {
 	GpuTask		   *gtask;
 	dlist_node	   *dnode;
+	cl_uint			cuda_index;
+	pgstrom_perfmon	pfm_base;
 
+	drain_completed_stack(gts);
 	while (!dlist_is_empty(&gts->completed_tasks))
 	{
 		dnode = dlist_pop_head_node(&gts->completed_tasks);
@@ -1338,8 +2053,14 @@ check_completed_tasks(GpuTaskState *gts)
 		 * shall do all the necessary stuff - like retrying with
 		 * larger buffer.
 		 */
+		cuda_index = gtask->cuda_index;
+		pfm_base = gts->pfm;
 		if (gts->cb_task_complete(gtask))
 		{
+			gpustat_account_task(gts, cuda_index, &pfm_base,
+								 gtask->cpu_fallback);
+			pgstrom_update_chunk_size(gts);
+
 			/* release common cuda fields and its stream */
 			pgstrom_cleanup_gputask_cuda_resources(gtask);
 
@@ -1353,15 +2074,100 @@ check_completed_tasks(GpuTaskState *gts)
 		else
 		{
 			/* all the exception handling was done on the callback */
+			gpustat_account_task(gts, cuda_index, &pfm_base, false);
+			pgstrom_update_chunk_size(gts);
 			SpinLockAcquire(&gts->lock);
 		}
 	}
 }
 
 /*
+ * __pgstrom_select_cuda_index
  *
+ * It chooses the least loaded device for a new task. Load of a device is
+ * estimated by number of running tasks of this GpuTaskState, normalized by
+ * the computing capacity of the device, and weighted by the device memory
+ * consumption of the whole system. Devices on the NUMA node other than the
+ * preferable one of the GpuContext are penalized, because DMA across the
+ * inter-socket link is much slower. Devices in the 'starved' set are not
+ * chosen unless all the devices are starved.
+ *
+ * NOTE: spinlock has to be acquired before call
+ */
+static cl_uint
+__pgstrom_select_cuda_index(GpuTaskState *gts, Bitmapset *starved)
+{
+	GpuContext	   *gcontext = gts->gcontext;
+	cl_int			num_context = gcontext->num_context;
+	cl_uint			base = gcontext->next_context++;
+	cl_uint			index = base % num_context;
+	double			best_score = -1.0;
+	dlist_iter		iter;
+	cl_int			i;
+
+	if (num_context == 1)
+		return 0;
+
+	/* round-robin start position, to break ties */
+	for (i=0; i < num_context; i++)
+	{
+		cl_uint		k = (base + i) % num_context;
+		cl_uint		num_running = 0;
+		double		usage;
+		double		score;
+
+		if (bms_is_member(k, starved))
+			continue;
+		dlist_foreach(iter, &gts->running_tasks)
+		{
+			GpuTask	   *gtask = dlist_container(GpuTask, chain, iter.cur);
+
+			if (gtask->cuda_index == k)
+				num_running++;
+		}
+		usage = ((double) GpuScoreCurrMemUsage(k) /
+				 (double) Max(gpuScoreBoard->gpu[k].gmem_size, 1));
+		score = ((double)(num_running + 1) /
+				 (double) Max(gpuScoreBoard->gpu[k].throughput, 1)) /
+			Max(1.0 - usage, 0.05);
+		if (gcontext->numa_node >= 0 &&
+			gpuScoreBoard->gpu[k].numa_node >= 0 &&
+			gpuScoreBoard->gpu[k].numa_node != gcontext->numa_node)
+			score *= GPU_NUMA_REMOTE_PENALTY;
+		if (best_score < 0.0 || score < best_score)
+		{
+			best_score = score;
+			index = k;
+		}
+	}
+	return index;
+}
+
+/*
+ * pgstrom_select_cuda_index
  *
+ * It returns index of the device to be used for a series of tasks that
+ * shall be bound to a particular device, like sorting segment.
+ */
+cl_uint
+pgstrom_select_cuda_index(GpuTaskState *gts)
+{
+	cl_uint		index;
+
+	SpinLockAcquire(&gts->lock);
+	index = __pgstrom_select_cuda_index(gts, NULL);
+	SpinLockRelease(&gts->lock);
+
+	return index;
+}
+
+/*
+ * launch_pending_tasks
  *
+ * It launches the pending tasks on the least loaded device. If a task that
+ * is not bound to a particular device could not be launched because of
+ * resource starvation, it is re-assigned to the other devices prior to
+ * giving up; so idle devices steal the stalled tasks.
  */
 static void
 launch_pending_tasks(GpuTaskState *gts)
@@ -1369,8 +2175,11 @@ launch_pending_tasks(GpuTaskState *gts)
 	GpuContext	   *gcontext = gts->gcontext;
 	GpuTask		   *gtask;
 	dlist_node	   *dnode;
+	Bitmapset	   *starved = NULL;
+	bool			auto_assign;
 	bool			launch;
 	struct timeval	tv1, tv2;
+	pgstrom_perfmon	pfm_base;
 
 	/*
 	 * Unless kernel build is completed, we cannot launch it.
@@ -1388,6 +2197,41 @@ launch_pending_tasks(GpuTaskState *gts)
 		gtask = dlist_container(GpuTask, chain, dnode);
 		gts->num_pending_tasks--;
 		memset(&gtask->chain, 0, sizeof(dlist_node));
+
+		auto_assign = (!gtask->cuda_stream &&
+					   !gtask->no_cuda_setup &&
+					   gtask->cuda_index == UINT_MAX);
+	retry:
+		if (auto_assign)
+			gtask->cuda_index = __pgstrom_select_cuda_index(gts, starved);
+
+		/*
+		 * Admission control; the task is kept pending if the device is
+		 * already busy with the tasks of the whole system, unless this
+		 * GpuTaskState has no running tasks (to ensure progress).
+		 */
+		if (!gtask->cuda_stream && !gtask->no_cuda_setup &&
+			gpu_max_device_tasks > 0 &&
+			gts->num_running_tasks > 0 &&
+			GpuScoreCurrRunning(gtask->cuda_index) >= gpu_max_device_tasks)
+		{
+			pg_atomic_fetch_add_u64(&gpuScoreBoard->gpu[gtask->cuda_index].
+									num_throttled, 1);
+			if (auto_assign)
+			{
+				/* no palloc under the spinlock */
+				SpinLockRelease(&gts->lock);
+				starved = bms_add_member(starved, gtask->cuda_index);
+				SpinLockAcquire(&gts->lock);
+				if (bms_num_members(starved) < gcontext->num_context)
+					goto retry;
+				/* all the devices are busy; device is chosen again later */
+				gtask->cuda_index = UINT_MAX;
+			}
+			dlist_push_head(&gts->pending_tasks, &gtask->chain);
+			gts->num_pending_tasks++;
+			break;
+		}
 		SpinLockRelease(&gts->lock);
 
 		/*
@@ -1400,14 +2244,9 @@ launch_pending_tasks(GpuTaskState *gts)
 			CUmodule	cuda_module;
 			CUstream	cuda_stream;
 			CUresult	rc;
-			int			index;
+			int			index = gtask->cuda_index;
 
-			Assert(gtask->cuda_index == UINT_MAX ||
-				   gtask->cuda_index < gcontext->num_context);
-			if (gtask->cuda_index == UINT_MAX)
-				index = (gcontext->next_context++ % gcontext->num_context);
-			else
-				index = gtask->cuda_index;
+			Assert(index < gcontext->num_context);
 
 			cuda_device = gcontext->gpu[index].cuda_device;
 			cuda_context = gcontext->gpu[index].cuda_context;
@@ -1434,7 +2273,9 @@ launch_pending_tasks(GpuTaskState *gts)
 		/*
 		 * Then, tries to launch this task.
 		 */
+		pfm_base = gts->pfm;
 		launch = gts->cb_task_process(gtask);
+		gpustat_account_task(gts, gtask->cuda_index, &pfm_base, false);
 
 		/*
 		 * NOTE: cb_process may complete task immediately, prior to get
@@ -1448,15 +2289,28 @@ launch_pending_tasks(GpuTaskState *gts)
 			{
 				dlist_push_tail(&gts->running_tasks, &gtask->chain);
 				gts->num_running_tasks++;
+				if (!gtask->no_cuda_setup)
+					GpuScoreInclRunning(gcontext, gtask->cuda_index, 1);
 			}
 			else
 			{
 				/*
 				 * NOTE: In case when callback required to keep the
 				 * GpuTask in the pending queue, it implies device
-				 * resources are in starvation. It does not make
+				 * resources are in starvation. If the task is not bound
+				 * to a particular device, we try other devices that
+				 * have not been starved yet. Elsewhere, it does not make
 				 * sense to enqueue tasks any more, at this moment.
 				 */
+				if (auto_assign)
+				{
+					SpinLockRelease(&gts->lock);
+					starved = bms_add_member(starved, gtask->cuda_index);
+					pgstrom_cleanup_gputask_cuda_resources(gtask);
+					SpinLockAcquire(&gts->lock);
+					if (bms_num_members(starved) < gcontext->num_context)
+						goto retry;
+				}
 				dlist_push_head(&gts->pending_tasks, &gtask->chain);
 				gts->num_pending_tasks++;
 				break;
@@ -1464,6 +2318,7 @@ launch_pending_tasks(GpuTaskState *gts)
 		}
 	}
 	PERFMON_END(&gts->pfm, time_launch_cuda, &tv1, &tv2);
+	bms_free(starved);
 }
 
 /*
@@ -1489,6 +2344,7 @@ __waitfor_ready_tasks(GpuTaskState *gts)
 	if (gts->cuda_modules || pgstrom_load_cuda_program(gts, false))
 	{
 		SpinLockAcquire(&gts->lock);
+		drain_completed_stack(gts);
 		if (!dlist_is_empty(&gts->ready_tasks))
 		{
 			/*
@@ -1976,6 +2832,17 @@ gpuMaxThreadsPerBlock(void)
 	return cuda_max_threads_per_block;
 }
 
+/*
+ * gpuNumaNodes
+ *
+ * It returns a list of the NUMA node for each device; -1 if unknown.
+ */
+List *
+gpuNumaNodes(void)
+{
+	return cuda_device_numa_nodes;
+}
+
 /*
  * optimal_workgroup_size - calculates the optimal block size
  * according to the function and device attributes
@@ -1990,6 +2857,42 @@ blocksize_to_shmemsize_helper(int blocksize)
 			__dynamic_shmem_per_thread * (size_t)blocksize);
 }
 
+/*
+ * Cache of the optimal block size per kernel function. Every chunk
+ * launches the same set of kernel functions, so occupancy calculation
+ * for each launch is waste of CPU cycles. Entries are valid unless
+ * CUmodule is unloaded; see pgstrom_release_gputaskstate().
+ */
+#define WORKGROUP_SIZE_CACHE_NSLOTS		64
+
+typedef struct
+{
+	CUfunction	function;
+	CUdevice	device;
+	size_t		dynamic_shmem_per_block;
+	size_t		dynamic_shmem_per_thread;
+	cl_int		max_block_sz;
+} workgroup_size_cache;
+
+static workgroup_size_cache	workgroup_size_cache_slots[WORKGROUP_SIZE_CACHE_NSLOTS];
+
+static inline workgroup_size_cache *
+lookup_workgroup_size_cache(CUfunction function, CUdevice device)
+{
+	cl_uint		index = (hash_uint32((cl_uint)((uintptr_t) function) ^
+									 (cl_uint)((uintptr_t) function >> 32) ^
+									 (cl_uint) device)
+						 % WORKGROUP_SIZE_CACHE_NSLOTS);
+	return &workgroup_size_cache_slots[index];
+}
+
+static void
+reset_workgroup_size_cache(void)
+{
+	memset(workgroup_size_cache_slots, 0,
+		   sizeof(workgroup_size_cache_slots));
+}
+
 void
 optimal_workgroup_size(size_t *p_grid_size,
 					   size_t *p_block_size,
@@ -1999,16 +2902,25 @@ optimal_workgroup_size(size_t *p_grid_size,
 					   size_t dynamic_shmem_per_block,
 					   size_t dynamic_shmem_per_thread)
 {
+	workgroup_size_cache *wcache;
 	cl_int		min_grid_sz;
 	cl_int		max_block_sz;
-	cl_int		warpSize;
 	CUresult	rc;
 
-	rc = cuDeviceGetAttribute(&warpSize,
-							  CU_DEVICE_ATTRIBUTE_WARP_SIZE,
-							  device);
-	if (rc != CUDA_SUCCESS)
-		elog(ERROR, "failed on cuDeviceGetAttribute: %s", errorText(rc));
+	/*
+	 * Optimal block size is independent from nitems as long as nitems is
+	 * larger than the block size. So, we can reuse the cached one.
+	 */
+	wcache = lookup_workgroup_size_cache(function, device);
+	if (wcache->function == function &&
+		wcache->device == device &&
+		wcache->dynamic_shmem_per_block == dynamic_shmem_per_block &&
+		wcache->dynamic_shmem_per_thread == dynamic_shmem_per_thread &&
+		(size_t)wcache->max_block_sz <= nitems)
+	{
+		max_block_sz = wcache->max_block_sz;
+		goto found;
+	}
 
 	__dynamic_shmem_per_block = dynamic_shmem_per_block;
 	__dynamic_shmem_per_thread = dynamic_shmem_per_thread;
@@ -2032,6 +2944,16 @@ optimal_workgroup_size(size_t *p_grid_size,
 		elog(ERROR, "failed on cuOccupancyMaxPotentialBlockSize: %s",
 			 errorText(rc));
 
+	/* only unconstrained result is worth to cache */
+	if ((size_t)max_block_sz < nitems)
+	{
+		wcache->function = function;
+		wcache->device = device;
+		wcache->dynamic_shmem_per_block = dynamic_shmem_per_block;
+		wcache->dynamic_shmem_per_thread = dynamic_shmem_per_thread;
+		wcache->max_block_sz = max_block_sz;
+	}
+found:
 	if ((size_t)max_block_sz * (size_t)INT_MAX < nitems)
 		elog(ERROR, "to large nitems (%zu) to launch kernel (blockSz=%d)",
 			 nitems, max_block_sz);
@@ -2040,6 +2962,29 @@ optimal_workgroup_size(size_t *p_grid_size,
 	*p_grid_size  = (nitems + (size_t)max_block_sz - 1) / (size_t)max_block_sz;
 }
 
+/*
+ * tuning_workgroup_size - shrinks the block size according to the hint
+ * of the kernel launch autotuner. A smaller block size is always legal
+ * because the occupancy calculation gives the upper limit.
+ */
+void
+tuning_workgroup_size(size_t *p_grid_size,
+					  size_t *p_block_size,
+					  size_t nitems,
+					  cl_uint block_shift)
+{
+	size_t		block_size = *p_block_size;
+
+	if (block_shift == 0 || block_size <= 32)
+		return;
+	block_size = Max(((block_size >> block_shift) / 32) * 32, 32);
+	if (block_size * (size_t)INT_MAX < nitems)
+		return;
+
+	*p_block_size = block_size;
+	*p_grid_size = (nitems + block_size - 1) / block_size;
+}
+
 void
 largest_workgroup_size(size_t *p_grid_size,
 					   size_t *p_block_size,
@@ -2135,6 +3080,9 @@ struct target_cuda_device
 	int		dev_mpu_clk;
 	int		dev_max_threads_per_block;
 	int		dev_local_mem_sz;
+	int		dev_pci_domain;
+	int		dev_pci_bus;
+	int		dev_pci_device;
 };
 
 static inline void
@@ -2144,6 +3092,11 @@ check_target_cuda_device(struct target_cuda_device *dattr)
 	cl_int		cores_per_mpu = -1;
 	cl_bool		supported = true;
 	cl_ulong	dev_cap;
+	cl_int		numa_node;
+
+	numa_node = pci_device_numa_node(dattr->dev_pci_domain,
+									 dattr->dev_pci_bus,
+									 dattr->dev_pci_device);
 
 	/*
 	 * CUDA device older than Computing Capability 3.5 is not supported
@@ -2197,10 +3150,16 @@ check_target_cuda_device(struct target_cuda_device *dattr)
 		list_append_unique_int(cuda_device_capabilities, dev_cap);
 	cuda_device_mem_sizes = lappend_int(cuda_device_mem_sizes,
 										(int)(dattr->dev_mem_sz >> 20));
+	/* rough computing capacity, to balance the load on mixed GPUs */
+	cuda_device_throughputs =
+		lappend_int(cuda_device_throughputs,
+					Max((cores_per_mpu > 0 ? cores_per_mpu : 128) *
+						dattr->dev_mpu_nums * (dattr->dev_mpu_clk / 1000), 1));
+	cuda_device_numa_nodes = lappend_int(cuda_device_numa_nodes, numa_node);
 	MemoryContextSwitchTo(oldcxt);
 out:
 	/* Log the brief CUDA device properties */
-	elog(LOG, "GPU%d %s (%d %s, %dMHz), L2 %dKB, RAM %zuMB (%dbits, %dMHz), capability %d.%d%s",
+	elog(LOG, "GPU%d %s (%d %s, %dMHz), L2 %dKB, RAM %zuMB (%dbits, %dMHz), capability %d.%d, NUMA node %d%s",
 		 dattr->dev_id,
 		 dattr->dev_name,
 		 (cores_per_mpu > 0 ? cores_per_mpu : 1) * dattr->dev_mpu_nums,
@@ -2212,6 +3171,7 @@ out:
 		 dattr->dev_mem_clk / 1000,
 		 dattr->dev_cap_major,
 		 dattr->dev_cap_minor,
+		 numa_node,
 		 !supported ? ", NOT SUPPORTED" : "");
 
 	/* clear the target_cuda_device structure */
@@ -2298,6 +3258,12 @@ pickup_target_cuda_devices(void)
 				dattr.dev_mpu_nums = atoi(attval);
 			else if (strcmp(attkey, "CLOCK_RATE") == 0)
 				dattr.dev_mpu_clk = atoi(attval);
+			else if (strcmp(attkey, "PCI_DOMAIN_ID") == 0)
+				dattr.dev_pci_domain = atoi(attval);
+			else if (strcmp(attkey, "PCI_BUS_ID") == 0)
+				dattr.dev_pci_bus = atoi(attval);
+			else if (strcmp(attkey, "PCI_DEVICE_ID") == 0)
+				dattr.dev_pci_device = atoi(attval);
 		}
 		else if (strcmp(linebuf, "\n") != 0)
 			elog(LOG, "Unknown attribute: %s", linebuf);
@@ -2337,6 +3303,31 @@ pgstrom_startup_cuda_control(void)
 		gpuScoreBoard->gpu[i].gmem_size = ((size_t)lfirst_int(lc) << 20);
 		i++;
 	}
+	i = 0;
+	foreach (lc, cuda_device_throughputs)
+	{
+		gpuScoreBoard->gpu[i].throughput = lfirst_int(lc);
+		i++;
+	}
+	i = 0;
+	foreach (lc, cuda_device_numa_nodes)
+	{
+		gpuScoreBoard->gpu[i].numa_node = lfirst_int(lc);
+		i++;
+	}
+
+	/* shared statistics of the GPU nodes */
+	gpuStatBoard = ShmemInitStruct("PG-Strom GPU Statistics",
+								   offsetof(GpuStatBoard,
+											stat[num_devices *
+												 GPUSTAT_NUM_NODES]),
+								   &found);
+	if (found)
+		elog(ERROR, "Bug? shared memory for GPU statistics already exists");
+	memset(gpuStatBoard, 0, offsetof(GpuStatBoard,
+									 stat[num_devices * GPUSTAT_NUM_NODES]));
+	SpinLockInit(&gpuStatBoard->lock);
+	gpuStatBoard->stats_reset = GetCurrentTimestamp();
 }
 
 void
@@ -2362,6 +3353,57 @@ pgstrom_init_cuda_control(void)
 			elog(ERROR, "failed to set CUDA_VISIBLE_DEVICES");
 	}
 
+	/*
+	 * Size of empty device memory blocks to be retained per device
+	 */
+	DefineCustomIntVariable("pg_strom.gpumem_retain_size",
+							"size of empty device memory to be retained",
+							NULL,
+							&gpumem_retain_size_kb,
+							262144,		/* 256MB */
+							0,
+							INT_MAX,
+							PGC_USERSET,
+							GUC_NOT_IN_SAMPLE | GUC_UNIT_KB,
+							NULL, NULL, NULL);
+
+	/*
+	 * Admission control of the GPU tasks across the backends
+	 */
+	DefineCustomIntVariable("pg_strom.max_device_tasks",
+							"max number of concurrent tasks per device",
+							"0 means no limitation",
+							&gpu_max_device_tasks,
+							0,
+							0,
+							INT_MAX,
+							PGC_SUSET,
+							GUC_NOT_IN_SAMPLE,
+							NULL, NULL, NULL);
+
+	DefineCustomIntVariable("pg_strom.gpu_memory_quota",
+							"max device memory per backend and device",
+							"0 means no limitation",
+							&gpu_memory_quota_kb,
+							0,
+							0,
+							INT_MAX,
+							PGC_SUSET,
+							GUC_NOT_IN_SAMPLE | GUC_UNIT_KB,
+							NULL, NULL, NULL);
+
+	/*
+	 * NUMA aware device selection and host pinned memory allocation
+	 */
+	DefineCustomBoolVariable("pg_strom.numa_aware",
+							 "Prefers devices and memory local to the CPU",
+							 NULL,
+							 &gpu_numa_aware,
+							 true,
+							 PGC_USERSET,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
+
 	/*
 	 * Picks up target CUDA devices
 	 */
@@ -2382,6 +3424,9 @@ pgstrom_init_cuda_control(void)
 	 */
 	count = list_length(cuda_device_ordinals);
 	RequestAddinShmemSpace(MAXALIGN(offsetof(GpuScoreBoard, gpu[count])));
+	RequestAddinShmemSpace(MAXALIGN(offsetof(GpuStatBoard,
+											 stat[count *
+												  GPUSTAT_NUM_NODES])));
 	shmem_startup_next = shmem_startup_hook;
 	shmem_startup_hook = pgstrom_startup_cuda_control;
 }
@@ -2484,6 +3529,7 @@ errorTextKernel(kern_errorbuf *kerror)
 		KERN_ENTRY(gpujoin_projection_row);
 		KERN_ENTRY(gpujoin_projection_slot);
 		KERN_ENTRY(gpujoin_count_rows_dist);
+		KERN_ENTRY(gpujoin_exec_rangejoin);
 		KERN_ENTRY(gpujoin_main);
 		KERN_ENTRY(gpupreagg_preparation);
 		KERN_ENTRY(gpupreagg_local_reduction);
@@ -2595,6 +3641,228 @@ pgstrom_scoreboard_info(PG_FUNCTION_ARGS)
 }
 PG_FUNCTION_INFO_V1(pgstrom_scoreboard_info);
 
+/*
+ * pgstrom_perfmon_info
+ *
+ * A SQL function to dump the cumulative statistics of the GPU nodes for
+ * each device, and of the program cache and the device memory allocator.
+ */
+typedef struct
+{
+	const char *node;		/* NULL, if not a statistics of GPU node */
+	cl_int		device;		/* -1, if not a statistics of device */
+	const char *item;
+	int64		count;
+	int64		bytes;
+	cl_double	time;
+	bool		has_bytes;
+	bool		has_time;
+	TimestampTz	stats_reset;
+} perfmon_info;
+
+static List *
+__collect_perfmon_info(GpuStatBoard *gsboard)
+{
+	List		   *results = NIL;
+	perfmon_info   *pminfo;
+	cl_uint			num_devices = gpuScoreBoard->num_devices;
+	int				i, j, k;
+
+#define NEW_PERFMON_INFO(_node,_device,_item)			\
+	do {												\
+		pminfo = palloc0(sizeof(perfmon_info));			\
+		pminfo->node = (_node);							\
+		pminfo->device = (_device);						\
+		pminfo->item = (_item);							\
+		pminfo->stats_reset = gsboard->stats_reset;		\
+		results = lappend(results, pminfo);				\
+	} while(0)
+
+	/* statistics of GPU nodes */
+	for (i=0; i < num_devices; i++)
+	{
+		for (j=0; j < GPUSTAT_NUM_NODES; j++)
+		{
+			gpustat_node   *gsnode = &gsboard->stat[i * GPUSTAT_NUM_NODES + j];
+
+			for (k=0; k < GPUSTAT_NUM_ITEMS; k++)
+			{
+				const gpustat_item *item = &gpustat_items[k];
+
+				if (item->node >= 0 && item->node != j)
+					continue;
+				NEW_PERFMON_INFO(gpustat_node_names[j], i, item->label);
+				pminfo->count = gsnode->items[k].count;
+				pminfo->bytes = gsnode->items[k].bytes;
+				pminfo->time = gsnode->items[k].time;
+				pminfo->has_bytes = (item->bytes_offset >= 0);
+				pminfo->has_time = (item->tv_offset >= 0);
+			}
+			NEW_PERFMON_INFO(gpustat_node_names[j], i, "CPU fallback");
+			pminfo->count = gsnode->num_fallback;
+		}
+	}
+
+	/* statistics of the program cache */
+	NEW_PERFMON_INFO(NULL, -1, "program cache hit");
+	pminfo->count = gsboard->num_cache_hit;
+	NEW_PERFMON_INFO(NULL, -1, "program cache miss");
+	pminfo->count = gsboard->num_cache_miss;
+	NEW_PERFMON_INFO(NULL, -1, "program file load");
+	pminfo->count = gsboard->num_file_load;
+	NEW_PERFMON_INFO(NULL, -1, "program build");
+	pminfo->count = gsboard->num_build;
+	pminfo->time = gsboard->tv_build;
+	pminfo->has_time = true;
+	NEW_PERFMON_INFO(NULL, -1, "program build failed");
+	pminfo->count = gsboard->num_build_failed;
+
+	/* statistics of the device memory allocator */
+	for (i=0; i < num_devices; i++)
+	{
+		NEW_PERFMON_INFO(NULL, i, "cuMemAlloc");
+		pminfo->count =
+			pg_atomic_read_u64(&gpuScoreBoard->gpu[i].num_dev_malloc);
+		NEW_PERFMON_INFO(NULL, i, "cuMemFree");
+		pminfo->count =
+			pg_atomic_read_u64(&gpuScoreBoard->gpu[i].num_dev_mfree);
+		NEW_PERFMON_INFO(NULL, i, "pooled allocation");
+		pminfo->count =
+			pg_atomic_read_u64(&gpuScoreBoard->gpu[i].num_pool_alloc);
+		NEW_PERFMON_INFO(NULL, i, "retained memory");
+		pminfo->bytes =
+			pg_atomic_read_u64(&gpuScoreBoard->gpu[i].gmem_retained);
+		pminfo->has_bytes = true;
+		NEW_PERFMON_INFO(NULL, i, "throttled launch");
+		pminfo->count =
+			pg_atomic_read_u64(&gpuScoreBoard->gpu[i].num_throttled);
+	}
+#undef NEW_PERFMON_INFO
+
+	return results;
+}
+
+Datum
+pgstrom_perfmon_info(PG_FUNCTION_ARGS)
+{
+	FuncCallContext *fncxt;
+	perfmon_info   *pminfo;
+	List		   *pminfo_list;
+	Datum			values[7];
+	bool			isnull[7];
+	HeapTuple		tuple;
+
+	if (SRF_IS_FIRSTCALL())
+	{
+		TupleDesc		tupdesc;
+		MemoryContext	oldcxt;
+		GpuStatBoard   *gsboard;
+		Size			length;
+
+		fncxt = SRF_FIRSTCALL_INIT();
+		oldcxt = MemoryContextSwitchTo(fncxt->multi_call_memory_ctx);
+
+		tupdesc = CreateTemplateTupleDesc(7, false);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 1, "node",
+						   TEXTOID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 2, "device",
+						   INT4OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 3, "item",
+						   TEXTOID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 4, "count",
+						   INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 5, "bytes",
+						   INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 6, "time",
+						   FLOAT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 7, "stats_reset",
+						   TIMESTAMPTZOID, -1, 0);
+		fncxt->tuple_desc = BlessTupleDesc(tupdesc);
+
+		/* take a snapshot not to hold the spinlock during palloc */
+		length = offsetof(GpuStatBoard, stat[gpuScoreBoard->num_devices *
+											 GPUSTAT_NUM_NODES]);
+		gsboard = palloc(length);
+		SpinLockAcquire(&gpuStatBoard->lock);
+		memcpy(gsboard, gpuStatBoard, length);
+		SpinLockRelease(&gpuStatBoard->lock);
+
+		fncxt->user_fctx = __collect_perfmon_info(gsboard);
+		MemoryContextSwitchTo(oldcxt);
+	}
+	fncxt = SRF_PERCALL_SETUP();
+
+	/* fetch the first entry */
+	pminfo_list = fncxt->user_fctx;
+	if (pminfo_list == NIL)
+		SRF_RETURN_DONE(fncxt);
+	pminfo = linitial(pminfo_list);
+	fncxt->user_fctx = list_delete_first(pminfo_list);
+
+	/* make a heap-tuple */
+	memset(isnull, 0, sizeof(isnull));
+	if (!pminfo->node)
+		isnull[0] = true;
+	else
+		values[0] = CStringGetTextDatum(pminfo->node);
+	if (pminfo->device < 0)
+		isnull[1] = true;
+	else
+		values[1] = Int32GetDatum(pminfo->device);
+	values[2] = CStringGetTextDatum(pminfo->item);
+	values[3] = Int64GetDatum(pminfo->count);
+	if (!pminfo->has_bytes)
+		isnull[4] = true;
+	else
+		values[4] = Int64GetDatum(pminfo->bytes);
+	if (!pminfo->has_time)
+		isnull[5] = true;
+	else
+		values[5] = Float8GetDatum(pminfo->time);
+	values[6] = TimestampTzGetDatum(pminfo->stats_reset);
+
+	tuple = heap_form_tuple(fncxt->tuple_desc, values, isnull);
+
+	SRF_RETURN_NEXT(fncxt, HeapTupleGetDatum(tuple));
+}
+PG_FUNCTION_INFO_V1(pgstrom_perfmon_info);
+
+/*
+ * pgstrom_perfmon_reset
+ *
+ * A SQL function to reset the cumulative statistics of pgstrom_perfmon_info
+ */
+Datum
+pgstrom_perfmon_reset(PG_FUNCTION_ARGS)
+{
+	TimestampTz	now = GetCurrentTimestamp();
+	int			i;
+
+	if (!superuser())
+		ereport(ERROR,
+				(errcode(ERRCODE_INSUFFICIENT_PRIVILEGE),
+				 errmsg("must be superuser to reset PG-Strom statistics")));
+
+	SpinLockAcquire(&gpuStatBoard->lock);
+	memset(&gpuStatBoard->num_cache_hit, 0,
+		   offsetof(GpuStatBoard,
+					stat[gpuScoreBoard->num_devices * GPUSTAT_NUM_NODES]) -
+		   offsetof(GpuStatBoard, num_cache_hit));
+	gpuStatBoard->stats_reset = now;
+	SpinLockRelease(&gpuStatBoard->lock);
+
+	/* cumulative counters of the device memory allocator also */
+	for (i=0; i < gpuScoreBoard->num_devices; i++)
+	{
+		pg_atomic_write_u64(&gpuScoreBoard->gpu[i].num_dev_malloc, 0);
+		pg_atomic_write_u64(&gpuScoreBoard->gpu[i].num_dev_mfree, 0);
+		pg_atomic_write_u64(&gpuScoreBoard->gpu[i].num_pool_alloc, 0);
+		pg_atomic_write_u64(&gpuScoreBoard->gpu[i].num_throttled, 0);
+	}
+	PG_RETURN_VOID();
+}
+PG_FUNCTION_INFO_V1(pgstrom_perfmon_reset);
+
 
 /*
  * pgstrom_device_info
@@ -2734,8 +4002,8 @@ pgstrom_device_info(PG_FUNCTION_ARGS)
 	}
 	fncxt = SRF_PERCALL_SETUP();
 
-	dindex = fncxt->call_cntr / (lengthof(catalog) + 2);
-	aindex = fncxt->call_cntr % (lengthof(catalog) + 2);
+	dindex = fncxt->call_cntr / (lengthof(catalog) + 9);
+	aindex = fncxt->call_cntr % (lengthof(catalog) + 9);
 
 	if (cuda_num_devices < 0)
 		pgstrom_init_cuda();
@@ -2763,9 +4031,54 @@ pgstrom_device_info(PG_FUNCTION_ARGS)
 		att_name = "Total global memory size";
 		att_value = psprintf("%zu MBytes", dev_memsz >> 20);
 	}
+	else if (aindex == 2)
+	{
+		att_name = "Device memory pool: retained size";
+		att_value = psprintf("%zu MBytes",
+			(size_t)pg_atomic_read_u64(&gpuScoreBoard->gpu[dindex].
+									   gmem_retained) >> 20);
+	}
+	else if (aindex == 3)
+	{
+		att_name = "Device memory pool: number of cuMemAlloc";
+		att_value = psprintf(UINT64_FORMAT,
+			pg_atomic_read_u64(&gpuScoreBoard->gpu[dindex].num_dev_malloc));
+	}
+	else if (aindex == 4)
+	{
+		att_name = "Device memory pool: number of cuMemFree";
+		att_value = psprintf(UINT64_FORMAT,
+			pg_atomic_read_u64(&gpuScoreBoard->gpu[dindex].num_dev_mfree));
+	}
+	else if (aindex == 5)
+	{
+		att_name = "Device memory pool: number of pooled allocation";
+		att_value = psprintf(UINT64_FORMAT,
+			pg_atomic_read_u64(&gpuScoreBoard->gpu[dindex].num_pool_alloc));
+	}
+	else if (aindex == 6)
+	{
+		att_name = "Admission control: number of running tasks";
+		att_value = psprintf("%u",
+			pg_atomic_read_u32(&gpuScoreBoard->gpu[dindex].num_running));
+	}
+	else if (aindex == 7)
+	{
+		att_name = "Admission control: number of throttled launches";
+		att_value = psprintf(UINT64_FORMAT,
+			pg_atomic_read_u64(&gpuScoreBoard->gpu[dindex].num_throttled));
+	}
+	else if (aindex == 8)
+	{
+		att_name = "NUMA node of the device";
+		if (gpuScoreBoard->gpu[dindex].numa_node < 0)
+			att_value = "unknown";
+		else
+			att_value = psprintf("%d", gpuScoreBoard->gpu[dindex].numa_node);
+	}
 	else
 	{
-		int		pindex = aindex - 2;
+		int		pindex = aindex - 9;
 		int		property;
 
 		rc = cuDeviceGetAttribute(&property,
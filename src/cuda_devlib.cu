@@ -0,0 +1,39 @@
+/*
+ * cuda_devlib.cu
+ *
+ * Entrypoint of the precompiled device library; built by nvcc at make
+ * time then linked to the run-time compiled GPU code.
+ * --
+ * Copyright 2011-2016 (C) KaiGai Kohei <kaigai@kaigai.gr.jp>
+ * Copyright 2014-2016 (C) The PG-Strom Development Team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+#include <cuda_device_runtime_api.h>
+
+/*
+ * NOTE: HOSTPTRLEN, DEVICEPTRLEN, BLCKSZ and MAXIMUM_ALIGNOF are given
+ * by the Makefile, according to the same configuration that
+ * construct_flat_cuda_source() puts on the run-time built code.
+ * Only libraries that don't depend on per-session definitions (like
+ * timezone or database encoding) can be packed here.
+ */
+#ifndef PGSTROM_DEVICE_LIBRARY
+#error "PGSTROM_DEVICE_LIBRARY must be defined"
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif	/* __cplusplus */
+#include "cuda_common.h"
+#include "cuda_numeric.h"
+#ifdef __cplusplus
+}
+#endif	/* __cplusplus */
@@ -221,6 +221,29 @@ optimal_workgroup_size(dim3 *p_grid_sz,
 	return cudaSuccess;
 }
 
+/*
+ * tuning_workgroup_size - shrinks the block_size led by the
+ * optimal_workgroup_size according to the hint of the host side
+ * autotuner. A smaller block size is always legal.
+ */
+STATIC_FUNCTION(void)
+tuning_workgroup_size(dim3 *p_grid_sz,
+					  dim3 *p_block_sz,
+					  size_t nitems,
+					  cl_uint block_shift)
+{
+	size_t		block_size = p_block_sz->x;
+
+	if (block_shift == 0 || block_size <= warpSize)
+		return;
+	block_size = Max(((block_size >> block_shift) / warpSize) * warpSize,
+					 warpSize);
+	if (block_size * (size_t)INT_MAX < nitems)
+		return;
+	p_block_sz->x = block_size;
+	p_grid_sz->x = (nitems + block_size - 1) / block_size;
+}
+
 /*
  * largest_workgroup_size - lead an optimal block_size from the standpoint
  * of number of threads per block
@@ -28,6 +28,8 @@ typedef struct
 	cl_uint			pg_crc32_table[256];	/* used to hashjoin */
 	cl_uint			nrels;			/* number of relations */
 	cl_uint			ojmap_length;	/* length of outer-join map, if any */
+	cl_uint			bloom_offset;	/* offset to bloom filter, if any */
+	cl_uint			bloom_nbits;	/* number of bits; power of 2 */
 	struct
 	{
 		cl_uint		chunk_offset;	/* offset to KDS or Hash */
@@ -35,10 +37,16 @@ typedef struct
 		cl_bool		is_nestloop;	/* true, if NestLoop. */
 		cl_bool		left_outer;		/* true, if JOIN_LEFT or JOIN_FULL */
 		cl_bool		right_outer;	/* true, if JOIN_RIGHT or JOIN_FULL */
-		cl_char		__padding__[1];
+		cl_bool		is_rangejoin;	/* true, if NestLoop on sorted inner */
 	} chunks[FLEXIBLE_ARRAY_MEMBER];
 } kern_multirels;
 
+/*
+ * Number of outer rows which reference heavy-hitter of the inner hash
+ * table, and can be processed by all the threads in a block.
+ */
+#define GPUJOIN_HEAVY_HITTER_QUEUE_SIZE		256
+
 #define KERN_MULTIRELS_INNER_KDS(kmrels, depth)	\
 	((kern_data_store *)						\
 	 ((char *)(kmrels) + (kmrels)->chunks[(depth)-1].chunk_offset))
@@ -55,6 +63,28 @@ typedef struct
 #define KERN_MULTIRELS_RIGHT_OUTER_JOIN(kmrels, depth)	\
 	((kmrels)->chunks[(depth)-1].right_outer)
 
+#define KERN_MULTIRELS_RANGE_JOIN(kmrels, depth)		\
+	((kmrels)->chunks[(depth)-1].is_rangejoin)
+
+/*
+ * Bloom filter of the depth-1 inner hash values. Each entry sets two bits
+ * derived from the hash value; outer rows which don't hit both bits never
+ * match any inner rows, so we can drop them at the outer scan.
+ */
+#define KERN_MULTIRELS_BLOOM_FILTER(kmrels)				\
+	((kmrels)->bloom_nbits == 0							\
+	 ? NULL												\
+	 : (cl_uint *)((char *)(kmrels) + (kmrels)->bloom_offset))
+
+#define BLOOM_FILTER_HASH1(hash, nbits)					\
+	((hash) & ((nbits) - 1))
+#define BLOOM_FILTER_HASH2(hash, nbits)					\
+	(((((hash) >> 16) | ((hash) << 16)) * 0x9e3779b1U) & ((nbits) - 1))
+#define BLOOM_FILTER_SET(bloom, bit)					\
+	((bloom)[(bit) >> 5] |= (1U << ((bit) & 31)))
+#define BLOOM_FILTER_TEST(bloom, bit)					\
+	(((bloom)[(bit) >> 5] & (1U << ((bit) & 31))) != 0)
+
 /*
  * kern_gpujoin - control object of GpuJoin
  */
@@ -83,6 +113,8 @@ typedef struct
 	cl_uint			kresults_max_items;	/* max items kresult_buf can hold */
 	/* number of inner relations */
 	cl_uint			num_rels;
+	/* block size shift by the launch autotuner (IN) */
+	cl_uint			block_size_shift;
 	/* error status to be backed (OUT) */
 	kern_errorbuf	kerror;
 	/* performance profiler */
@@ -156,6 +188,26 @@ gpujoin_join_quals(kern_context *kcxt,
 				   HeapTupleHeaderData *inner_htup,
 				   cl_bool *joinquals_matched);
 
+/*
+ * gpujoin_range_qual
+ *
+ * Evaluation of the lower (is_upper = false) or upper (is_upper = true)
+ * bound qualifier of range-join in the given depth. The inner rows are
+ * sorted by the range key, and the qualifier is true on the leading part;
+ * e.g, (inner_key < outer_key) for lower bound, (inner_key <= outer_key)
+ * for upper bound of equi-join. So, the lower bound is the first row that
+ * the lower qualifier gets false, and the upper bound is the first row
+ * that the upper qualifier gets false.
+ */
+STATIC_FUNCTION(cl_bool)
+gpujoin_range_qual(kern_context *kcxt,
+				   kern_data_store *kds,
+				   kern_multirels *kmrels,
+				   cl_int depth,
+				   cl_uint *x_buffer,
+				   HeapTupleHeaderData *inner_htup,
+				   cl_bool is_upper);
+
 /*
  * gpujoin_hash_value
  *
@@ -216,9 +268,45 @@ gpujoin_outer_quals(kern_context *kcxt,
 					kern_data_store *kds,
 					size_t kds_index);
 
+/*
+ * gpujoin_outer_bloom_filter
+ *
+ * It checks the outer row with bloom filter of the depth-1 inner hash
+ * values. False means the row never match any inner rows.
+ */
+STATIC_INLINE(cl_bool)
+gpujoin_outer_bloom_filter(kern_context *kcxt,
+						   kern_data_store *kds,
+						   kern_multirels *kmrels,
+						   cl_uint *bloom,
+						   size_t kds_index)
+{
+	HeapTupleHeaderData *htup = kern_get_tuple_row(kds, kds_index);
+	cl_uint		x_buffer[1];
+	cl_uint		hash_value;
+	cl_uint		nbits = kmrels->bloom_nbits;
+	cl_bool		is_null_keys;
+
+	x_buffer[0] = (size_t)htup - (size_t)kds;
+	hash_value = gpujoin_hash_value(kcxt,
+									kmrels->pg_crc32_table,
+									kds,
+									kmrels,
+									1,
+									x_buffer,
+									&is_null_keys);
+	/* NOTE: NULL-keys never match, and bloom filter is built only if
+	 * outer rows without inner pair is not needed */
+	if (is_null_keys)
+		return false;
+	return (BLOOM_FILTER_TEST(bloom, BLOOM_FILTER_HASH1(hash_value, nbits)) &&
+			BLOOM_FILTER_TEST(bloom, BLOOM_FILTER_HASH2(hash_value, nbits)));
+}
+
 KERNEL_FUNCTION(void)
 gpujoin_exec_outerscan(kern_gpujoin *kgjoin,
 					   kern_data_store *kds,
+					   kern_multirels *kmrels,
 					   kern_resultbuf *kresults)
 {
 	kern_parambuf  *kparams = KERN_GPUJOIN_PARAMBUF(kgjoin);
@@ -228,6 +316,7 @@ gpujoin_exec_outerscan(kern_gpujoin *kgjoin,
 	cl_uint			kds_index = window_base + get_global_id();
 	cl_uint			count;
 	cl_uint			offset;
+	cl_uint		   *bloom = KERN_MULTIRELS_BLOOM_FILTER(kmrels);
 	cl_bool			matched;
 	__shared__ cl_int base;
 
@@ -235,7 +324,13 @@ gpujoin_exec_outerscan(kern_gpujoin *kgjoin,
 	assert(kresults->nrels == 1);	/* only happen if depth == 1 */
 
 	if (kds_index < min(kds->nitems, window_base + window_size))
+	{
 		matched = gpujoin_outer_quals(&kcxt, kds, kds_index);
+		/* drop the outer rows which never match with depth-1 */
+		if (matched && bloom)
+			matched = gpujoin_outer_bloom_filter(&kcxt, kds, kmrels,
+												 bloom, kds_index);
+	}
 	else
 		matched = false;
 
@@ -363,6 +458,142 @@ gpujoin_exec_nestloop(kern_gpujoin *kgjoin,
 	kern_writeback_error_status(&kresults_dst->kerror, kcxt.e);
 }
 
+/*
+ * gpujoin_range_search
+ *
+ * It looks up the first inner row on which the lower/upper bound qualifier
+ * of range-join gets false, using binary search.
+ */
+STATIC_FUNCTION(cl_uint)
+gpujoin_range_search(kern_context *kcxt,
+					 kern_data_store *kds,
+					 kern_multirels *kmrels,
+					 cl_int depth,
+					 cl_uint *x_buffer,
+					 kern_data_store *kds_in,
+					 cl_bool is_upper)
+{
+	cl_uint		head = 0;
+	cl_uint		tail = kds_in->nitems;
+
+	while (head < tail)
+	{
+		cl_uint		curr = head + (tail - head) / 2;
+
+		if (gpujoin_range_qual(kcxt, kds, kmrels, depth, x_buffer,
+							   kern_get_tuple_row(kds_in, curr), is_upper))
+			head = curr + 1;
+		else
+			tail = curr;
+	}
+	return head;
+}
+
+/*
+ * gpujoin_exec_rangejoin
+ *
+ * A variation of nested-loop when inner rows are sorted by the range key.
+ * Each thread takes an outer row, then looks up the range of inner rows
+ * to be checked according to the lower/upper bound qualifiers, instead of
+ * the evaluation of join qualifiers towards all the inner rows.
+ */
+KERNEL_FUNCTION(void)
+gpujoin_exec_rangejoin(kern_gpujoin *kgjoin,
+					   kern_data_store *kds,
+					   kern_multirels *kmrels,
+					   kern_resultbuf *kresults_src,
+					   kern_resultbuf *kresults_dst,
+					   cl_bool *outer_join_map,
+					   cl_int depth,
+					   cl_int cuda_index,
+					   cl_uint window_base,
+					   cl_uint window_size)
+{
+	kern_parambuf	   *kparams = KERN_GPUJOIN_PARAMBUF(kgjoin);
+	kern_context		kcxt;
+	kern_data_store	   *kds_in;
+	cl_bool			   *oj_map;
+	HeapTupleHeaderData *y_htup = NULL;
+	cl_uint			   *x_buffer = NULL;
+	cl_uint			   *r_buffer;
+	cl_uint				y_index = 0;
+	cl_uint				y_limit = 0;
+	cl_bool				is_matched;
+	cl_uint				offset;
+	cl_uint				count;
+	__shared__ cl_uint	base;
+
+	INIT_KERNEL_CONTEXT(&kcxt,gpujoin_exec_rangejoin,kparams);
+
+	/* sanity checks */
+	assert(depth > 0 && depth <= kgjoin->num_rels);
+	assert(kresults_dst->nrels == depth + 1);
+	assert(kresults_src->nrels == depth);
+	assert(kresults_src->nitems <= kresults_src->nrooms);
+
+	kds_in = KERN_MULTIRELS_INNER_KDS(kmrels, depth);
+	assert(kds_in != NULL && KERN_MULTIRELS_RANGE_JOIN(kmrels, depth));
+
+	/* will be valid, if LEFT OUTER JOIN */
+	oj_map = KERN_MULTIRELS_OUTER_JOIN_MAP(kmrels, depth, outer_join_map);
+
+	/* range of the inner rows to be checked, within the window */
+	if (get_global_id() < kresults_src->nitems)
+	{
+		x_buffer = KERN_GET_RESULT(kresults_src, get_global_id());
+		y_index = gpujoin_range_search(&kcxt, kds, kmrels, depth,
+									   x_buffer, kds_in, false);
+		y_limit = gpujoin_range_search(&kcxt, kds, kmrels, depth,
+									   x_buffer, kds_in, true);
+		y_index = max(y_index, window_base);
+		y_limit = min(y_limit, window_base + window_size);
+	}
+
+	do {
+		if (y_index < y_limit)
+		{
+			y_htup = kern_get_tuple_row(kds_in, y_index);
+			is_matched = gpujoin_join_quals(&kcxt,
+											kds,
+											kmrels,
+											depth,
+											x_buffer,
+											y_htup,
+											NULL);
+			if (is_matched && oj_map && !oj_map[y_index])
+				oj_map[y_index] = true;
+		}
+		else
+			is_matched = false;
+
+		/* Expand kresults_dst->nitems, and put values */
+		offset = pgstromStairlikeSum(is_matched ? 1 : 0, &count);
+		if (count > 0)
+		{
+			if (get_local_id() == 0)
+				base = atomicAdd(&kresults_dst->nitems, count);
+			__syncthreads();
+
+			/* still have space to store? */
+			if (base + count >= kresults_dst->nrooms)
+				STROM_SET_ERROR(&kcxt.e, StromError_DataStoreNoSpace);
+			else if (is_matched)
+			{
+				r_buffer = KERN_GET_RESULT(kresults_dst, base + offset);
+				memcpy(r_buffer, x_buffer, sizeof(cl_int) * depth);
+				r_buffer[depth] = (size_t)y_htup - (size_t)kds_in;
+			}
+		}
+		__syncthreads();
+
+		/* checks whether any threads still have inner rows to be checked */
+		y_index++;
+		pgstromStairlikeSum(y_index < y_limit ? 1 : 0, &count);
+	} while (count > 0);
+
+	kern_writeback_error_status(&kresults_dst->kerror, kcxt.e);
+}
+
 /*
  * gpujoin_exec_hashjoin
  *
@@ -395,8 +626,15 @@ gpujoin_exec_hashjoin(kern_gpujoin *kgjoin,
 	cl_bool				is_matched;
 	cl_bool				needs_outer_row = false;
 	cl_bool				is_null_keys;
+	cl_int				heavy_index = -1;
+	cl_uint				heavy_nqueued;
+	cl_uint				i, j;
 	__shared__ cl_uint	base;
 	__shared__ cl_uint	pg_crc32_table[256];
+	__shared__ cl_uint	heavy_count;
+	__shared__ cl_uint	heavy_owner[GPUJOIN_HEAVY_HITTER_QUEUE_SIZE];
+	__shared__ cl_uint	heavy_khitem[GPUJOIN_HEAVY_HITTER_QUEUE_SIZE];
+	__shared__ cl_bool	heavy_matched[GPUJOIN_HEAVY_HITTER_QUEUE_SIZE];
 
 	INIT_KERNEL_CONTEXT(&kcxt,gpujoin_exec_hashjoin,kparams);
 
@@ -420,6 +658,8 @@ gpujoin_exec_hashjoin(kern_gpujoin *kgjoin,
 	{
 		pg_crc32_table[crc_index] = kmrels->pg_crc32_table[crc_index];
 	}
+	if (get_local_id() == 0)
+		heavy_count = 0;
 	__syncthreads();
 
 	/* will be valid, if RIGHT OUTER JOIN */
@@ -451,6 +691,27 @@ gpujoin_exec_hashjoin(kern_gpujoin *kgjoin,
 	 * Walks on the hash entries chain from the khitem
 	 */
 	do {
+		/*
+		 * Entries of heavy-hitter are located on the tail of the chain.
+		 * Outer row which references a heavy-hitter is queued, then
+		 * processed by all the threads in this block later, unless queue
+		 * is already full.
+		 */
+		if (khitem && khitem->hash == hash_value &&
+			khitem->heavy_base > 0 && heavy_index < 0)
+		{
+			cl_uint		index = atomicAdd(&heavy_count, 1);
+
+			if (index < GPUJOIN_HEAVY_HITTER_QUEUE_SIZE)
+			{
+				heavy_owner[index] = get_local_id();
+				heavy_khitem[index] = (size_t)khitem - (size_t)kds_hash;
+				heavy_matched[index] = false;
+				heavy_index = index;
+				khitem = NULL;
+			}
+		}
+
 		if (khitem && (khitem->hash  == hash_value &&
 					   khitem->rowid >= window_base &&
 					   khitem->rowid <  window_base + window_size))
@@ -507,6 +768,83 @@ gpujoin_exec_hashjoin(kern_gpujoin *kgjoin,
 		pgstromStairlikeSum(khitem != NULL ? 1 : 0, &count);
 	} while (count > 0);
 
+	/*
+	 * Block-wide processing of the queued heavy-hitters. The entries of
+	 * a heavy-hitter have sequential rowid, between heavy_base - 1 and
+	 * rowid of the entry at the head of its group, so all the threads
+	 * can pick up the entries in parallel.
+	 */
+	heavy_nqueued = Min(heavy_count, GPUJOIN_HEAVY_HITTER_QUEUE_SIZE);
+	for (i=0; i < heavy_nqueued; i++)
+	{
+		cl_uint		   *h_buffer = KERN_GET_RESULT(kresults_src,
+												   get_global_base() +
+												   heavy_owner[i]);
+		kern_hashitem  *khtop = (kern_hashitem *)
+			((char *)kds_hash + heavy_khitem[i]);
+		cl_uint			rowid_min = khtop->heavy_base - 1;
+		cl_uint			nitems = khtop->rowid - rowid_min + 1;
+
+		for (j=0; j < nitems; j += get_local_size())
+		{
+			cl_uint		rowid = rowid_min + j + get_local_id();
+
+			khitem = NULL;
+			if (j + get_local_id() < nitems &&
+				rowid >= window_base &&
+				rowid <  window_base + window_size)
+			{
+				HeapTupleHeaderData *h_htup;
+				cl_bool			joinquals_matched;
+
+				khitem = KERN_DATA_STORE_HASHITEM(kds_hash, rowid);
+				assert(khitem->rowid == rowid &&
+					   khitem->hash == khtop->hash);
+				h_htup = &khitem->t.htup;
+				is_matched = gpujoin_join_quals(&kcxt,
+												kds,
+												kmrels,
+												depth,
+												h_buffer,
+												h_htup,
+												&joinquals_matched);
+				if (joinquals_matched)
+				{
+					/* no need LEFT/FULL OUTER JOIN */
+					heavy_matched[i] = true;
+					/* no need RIGHT/FULL OUTER JOIN */
+					if (oj_map && !oj_map[rowid])
+						oj_map[rowid] = true;
+				}
+			}
+			else
+				is_matched = false;
+
+			/* Expand kresults_dst->nitems */
+			offset = pgstromStairlikeSum(is_matched ? 1 : 0, &count);
+			if (count > 0)
+			{
+				if (get_local_id() == 0)
+					base = atomicAdd(&kresults_dst->nitems, count);
+				__syncthreads();
+
+				/* kresults_dst still have enough space? */
+				if (base + count >= kresults_dst->nrooms)
+					STROM_SET_ERROR(&kcxt.e, StromError_DataStoreNoSpace);
+				else if (is_matched)
+				{
+					r_buffer = KERN_GET_RESULT(kresults_dst, base + offset);
+					memcpy(r_buffer, h_buffer, sizeof(cl_int) * depth);
+					r_buffer[depth] = ((size_t)&khitem->t.htup -
+									   (size_t)kds_hash);
+				}
+			}
+			__syncthreads();
+		}
+	}
+	if (heavy_index >= 0 && heavy_matched[heavy_index])
+		needs_outer_row = false;
+
 	/*
 	 * If no inner rows were matched on LEFT OUTER JOIN case, we fill up
 	 * the inner-side of result tuple with NULL.
@@ -1445,6 +1783,8 @@ gpujoin_main(kern_gpujoin *kgjoin,		/* in/out: misc stuffs */
 	kern_join_scale	   *jscale = kgjoin->jscale;
 	kern_context		kcxt;
 	const void		   *kernel_projection;
+	const void		   *kern_nestloop;
+	size_t				nestloop_nitems;
 	void			  **kern_args;
 	kern_join_args_t   *kern_join_args;
 	dim3				grid_sz;
@@ -1511,13 +1851,14 @@ retry_major:
 				/* Launch:
 				 * gpujoin_exec_outerscan(kern_gpujoin *kgjoin,
 				 *                        kern_data_store *kds,
+				 *                        kern_multirels *kmrels,
 				 *                        kern_resultbuf *kresults)
 				 */
 				tv_start = GlobalTimer();
 
 				kern_args = (void **)
 					cudaGetParameterBuffer(sizeof(void *),
-										   sizeof(void *) * 3);
+										   sizeof(void *) * 4);
 				if (!kern_args)
 				{
 					STROM_SET_ERROR(&kcxt.e, StromError_OutOfKernelArgs);
@@ -1525,7 +1866,8 @@ retry_major:
 				}
 				kern_args[0] = kgjoin;
 				kern_args[1] = kds_src;
-				kern_args[2] = kresults_src;
+				kern_args[2] = kmrels;
+				kern_args[3] = kresults_src;
 
 				window_size = kgjoin->jscale[0].window_size;
 				status = optimal_workgroup_size(&grid_sz,
@@ -1539,6 +1881,8 @@ retry_major:
 					STROM_SET_RUNTIME_ERROR(&kcxt.e, status);
 					goto out;
 				}
+				tuning_workgroup_size(&grid_sz, &block_sz, window_size,
+									  kgjoin->block_size_shift);
 
 				status = cudaLaunchDevice((void *)gpujoin_exec_outerscan,
 										  kern_args, grid_sz, block_sz,
@@ -1619,19 +1963,35 @@ retry_major:
 				}
 				SETUP_KERN_JOIN_ARGS(kern_join_args);
 
+				/*
+				 * Range-join takes an outer row per thread, and walks on
+				 * the inner rows between lower and upper bound.
+				 */
+				if (KERN_MULTIRELS_RANGE_JOIN(kmrels, depth))
+				{
+					kern_nestloop = (const void *)gpujoin_exec_rangejoin;
+					nestloop_nitems = kresults_src->nitems;
+				}
+				else
+				{
+					kern_nestloop = (const void *)gpujoin_exec_nestloop;
+					nestloop_nitems = ((size_t)kresults_src->nitems *
+									   (size_t)window_size);
+				}
 				status = optimal_workgroup_size(&grid_sz,
 												&block_sz,
-												(const void *)
-												gpujoin_exec_nestloop,
-												(size_t)kresults_src->nitems *
-												(size_t)window_size,
+												kern_nestloop,
+												nestloop_nitems,
 												0, sizeof(kern_errorbuf));
 				if (status != cudaSuccess)
 				{
 					STROM_SET_RUNTIME_ERROR(&kcxt.e, status);
 					goto out;
 				}
-				status = cudaLaunchDevice((void *)gpujoin_exec_nestloop,
+				tuning_workgroup_size(&grid_sz, &block_sz,
+									  nestloop_nitems,
+									  kgjoin->block_size_shift);
+				status = cudaLaunchDevice((void *)kern_nestloop,
 										  kern_join_args,
 										  grid_sz, block_sz,
 										  sizeof(cl_uint) * block_sz.x,
@@ -1729,6 +2089,8 @@ retry_major:
 					STROM_SET_RUNTIME_ERROR(&kcxt.e, status);
 					goto out;
 				}
+				tuning_workgroup_size(&grid_sz, &block_sz, window_size,
+									  kgjoin->block_size_shift);
 
 				status = cudaLaunchDevice((void *)gpujoin_outer_nestloop,
 										  kern_join_args,
@@ -1820,6 +2182,9 @@ retry_major:
 					STROM_SET_RUNTIME_ERROR(&kcxt.e, status);
 					goto out;
 				}
+				tuning_workgroup_size(&grid_sz, &block_sz,
+									  kresults_src->nitems,
+									  kgjoin->block_size_shift);
 
 				status = cudaLaunchDevice((void *)gpujoin_exec_hashjoin,
 										  kern_join_args,
@@ -1912,6 +2277,8 @@ retry_major:
 					STROM_SET_RUNTIME_ERROR(&kcxt.e, status);
 					goto out;
 				}
+				tuning_workgroup_size(&grid_sz, &block_sz, window_size,
+									  kgjoin->block_size_shift);
 
 				status = cudaLaunchDevice((void *)gpujoin_outer_hashjoin,
 										  kern_join_args,
@@ -2053,6 +2420,8 @@ retry_major:
 			STROM_SET_RUNTIME_ERROR(&kcxt.e, status);
 			goto out;
 		}
+		tuning_workgroup_size(&grid_sz, &block_sz, kresults_src->nitems,
+							  kgjoin->block_size_shift);
 
 		status = cudaLaunchDevice((void *)kernel_projection,
 								  kern_args, grid_sz, block_sz,
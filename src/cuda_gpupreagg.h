@@ -57,6 +57,7 @@ typedef struct
 	cl_uint			varlena_usage;		/* out: size of varlena usage */
 	cl_uint			ghash_conflicts;	/* out: # of ghash conflicts */
 	cl_uint			fhash_conflicts;	/* out: # of fhash conflicts */
+	cl_uint			num_distinct;		/* out: # of distinct keys in chunk */
 	/* -- performance monitor -- */
 	struct {
 		cl_uint		num_kern_prep;		/* # of kern_preparation calls */
@@ -739,6 +740,9 @@ gpupreagg_local_reduction(kern_gpupreagg *kgpreagg,
 	cl_uint			i, ncols = kds_slot->ncols;
 	cl_uint			count;
 	cl_uint			index;
+	cl_uint			lane_id = (get_local_id() & (warpSize - 1));
+	cl_uint			warp_mask;
+	cl_uint			warp_peers = 0;
 	pg_int4_t		key_dist_factor;
 	pagg_hashslot	old_slot;
 	pagg_hashslot	new_slot;
@@ -871,6 +875,34 @@ gpupreagg_local_reduction(kern_gpupreagg *kgpreagg,
 	/* Number of items should not be larger than nrooms  */
 	assert(base + count <= kresults->nrooms);
 
+	/*
+	 * Warp aggregation
+	 *
+	 * Non-owner threads in a warp that share the same owner are grouped,
+	 * then the first one (warp leader) folds the values of the others
+	 * without atomic operation, prior to the local atomic operation onto
+	 * the owner. It performs only one atomic operation per warp and group,
+	 * instead of per thread, so it reduces contention when a few grouping
+	 * keys are dominant. warp_peers is a bitmap of the group, only valid
+	 * on the warp leader.
+	 *
+	 * NOTE: warp_mask is same value on all the lanes in a warp, so the
+	 * loop below is executed by all the lanes.
+	 */
+	warp_mask = __ballot(get_global_id() < nitems &&
+						 get_local_id() != owner_index);
+	while (warp_mask != 0)
+	{
+		cl_uint		leader = __ffs(warp_mask) - 1;
+		cl_uint		leader_owner = __shfl((int)owner_index, leader);
+		cl_uint		peers = __ballot(get_global_id() < nitems &&
+									 get_local_id() != owner_index &&
+									 owner_index == leader_owner);
+		if (lane_id == leader)
+			warp_peers = peers;
+		warp_mask &= ~peers;
+	}
+
 	/*
 	 * Local reduction for each column
 	 *
@@ -905,14 +937,29 @@ gpupreagg_local_reduction(kern_gpupreagg *kgpreagg,
 		}
 		__syncthreads();
 
-		/* Reduction, using local atomic operation */
-		if (get_global_id() < nitems &&
-			get_local_id() != owner_index)
+		/*
+		 * Reduction, using local atomic operation by the warp leader,
+		 * after the fold of values in the warp.
+		 */
+		if (warp_peers != 0)
 		{
+			pagg_datum *l_leader = l_datum + get_local_id();
+			cl_uint		peers = (warp_peers & ~(1U << lane_id));
+
+			while (peers != 0)
+			{
+				cl_uint		peer = __ffs(peers) - 1;
+
+				gpupreagg_nogroup_calc(&kcxt,
+									   i,
+									   l_leader,
+									   l_leader - lane_id + peer);
+				peers &= ~(1U << peer);
+			}
 			gpupreagg_local_calc(&kcxt,
 								 i,
 								 l_datum + owner_index,
-								 l_datum + get_local_id());
+								 l_leader);
 		}
 		__syncthreads();
 
@@ -1941,6 +1988,9 @@ gpupreagg_main(kern_gpupreagg *kgpreagg,
 
 		TIMEVAL_RECORD(kgpreagg,kern_gagg,tv_start);
 
+		/* # of distinct keys (multiplied by key_dist_salt) in this chunk */
+		kgpreagg->num_distinct = kresults_dst->nitems;
+
 		/* swap */
 		kresults_tmp = kresults_src;
 		kresults_src = kresults_dst;
@@ -128,7 +128,8 @@ gpuscan_exec_quals(kern_gpuscan *kgpuscan,
 	__shared__ cl_uint base;
 
 	/* sanity checks */
-	assert(kds_src->format == KDS_FORMAT_ROW);
+	assert(kds_src->format == KDS_FORMAT_ROW ||
+		   kds_src->format == KDS_FORMAT_COLUMN);
 	assert(!kresults->all_visible);
 
 	INIT_KERNEL_CONTEXT(&kcxt,gpuscan_exec_quals,kparams);
@@ -154,10 +155,13 @@ gpuscan_exec_quals(kern_gpuscan *kgpuscan,
 		}
 		else if (rc)
 		{
-			/* OK, store the result */
-			kresults->results[base + offset] = (cl_uint)
-				((char *)KERN_DATA_STORE_TUPITEM(kds_src, kds_index) -
-				 (char *)kds_src);
+			/* OK, store the result; row index if column format */
+			if (kds_src->format == KDS_FORMAT_COLUMN)
+				kresults->results[base + offset] = (cl_uint) kds_index;
+			else
+				kresults->results[base + offset] = (cl_uint)
+					((char *)KERN_DATA_STORE_TUPITEM(kds_src, kds_index) -
+					 (char *)kds_src);
 		}
 	}
 	__syncthreads();
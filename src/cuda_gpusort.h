@@ -30,6 +30,10 @@ typedef struct
 	kern_errorbuf	kerror;
 	cl_uint			segid;		/* segment id to be loaded */
 	cl_uint			n_loaded;	/* number of items already loaded */
+	cl_uint			radix_nbits;/* width of radix sort key, or 0 if bitonic */
+	cl_bool			radix_nulls_first; /* NULLS FIRST on radix sort key */
+	cl_bool			bound_compact;	/* compaction of the top-K rows */
+	cl_uint			bound_nitems;	/* top-K if bounded, or 0 */
 	/* performance counter */
 	struct {
 		cl_uint		num_kern_lsort;
@@ -56,6 +60,50 @@ typedef struct
 #define KERN_GPUSORT_DMARECV_LENGTH(kgpusort)						\
 	offsetof(kern_gpusort, kparams)
 
+/*
+ * NOTE: Radix sort - if sorting key is a single fixed-length key, and its
+ * ordering is equivalent to unsigned integer comparison once normalized,
+ * GpuSort applies LSD radix sort instead of bitonic sorting. It needs an
+ * extra index array (to ping-pong with results[]) and histogram of the
+ * digits per tile, next to the results[] of kern_resultbuf on the device
+ * memory. The first item of the histogram area counts number of NULLs.
+ */
+#define GPUSORT_RADIX_BITS			8
+#define GPUSORT_RADIX_NBUCKETS		(1U << GPUSORT_RADIX_BITS)
+#define GPUSORT_RADIX_TILE_SZ		4096
+#define GPUSORT_RADIX_NULLS_PASS	64
+#define GPUSORT_RADIX_NTILES(nitems)							\
+	(((nitems) + GPUSORT_RADIX_TILE_SZ - 1) / GPUSORT_RADIX_TILE_SZ)
+#define GPUSORT_RADIX_BUFSZ(nrooms)								\
+	(STROMALIGN(sizeof(cl_uint) * (nrooms)) +					\
+	 STROMALIGN(sizeof(cl_uint) * (GPUSORT_RADIX_NBUCKETS *		\
+								   GPUSORT_RADIX_NTILES(nrooms) + 1)))
+#define KERN_GPUSORT_RADIX_INDEX(kresults)						\
+	((cl_uint *)((char *)(kresults) +							\
+				 STROMALIGN(offsetof(kern_resultbuf,			\
+									 results[(kresults)->nrooms]))))
+#define KERN_GPUSORT_RADIX_NULLS(kresults)						\
+	((cl_uint *)((char *)KERN_GPUSORT_RADIX_INDEX(kresults) +	\
+				 STROMALIGN(sizeof(cl_uint) * (kresults)->nrooms)))
+#define KERN_GPUSORT_RADIX_HIST(kresults)						\
+	(KERN_GPUSORT_RADIX_NULLS(kresults) + 1)
+
+/*
+ * NOTE: Bounded sort - if GpuSort is located under Limit with a constant
+ * bound (K), sorting segment keeps only the top-K items once sorted, so
+ * host side fetches and merges only K items per segment.
+ * If all the columns are inline and radix sort is used (never leads CPU
+ * fallback), the top-K rows are also moved to the head of kds_slot, then
+ * DMA receive is also limited to the K rows. It needs a temporary buffer
+ * for K rows in addition to the radix sort buffer.
+ */
+#define GPUSORT_BOUND_BUFSZ(ncols,bound)						\
+	STROMALIGN(KDS_CALCULATE_SLOT_LENGTH((ncols),(bound)) -		\
+			   KDS_CALCULATE_SLOT_LENGTH((ncols),0))
+#define KERN_GPUSORT_BOUND_BUFFER(kresults)						\
+	((char *)KERN_GPUSORT_RADIX_INDEX(kresults) +				\
+	 GPUSORT_RADIX_BUFSZ((kresults)->nrooms))
+
 /*
  * NOTE: Persistent segment - GpuSort have two persistent data structure
  * with longer duration than individual GpuSort tasks.
@@ -79,6 +127,67 @@ gpusort_keycomp(kern_context *kcxt,
 				size_t x_index,
 				size_t y_index);
 
+/*
+ * Sorting key normalization for radix sort - to be generated by PG-Strom
+ * on the fly. It returns the sorting key as an unsigned integer in the
+ * same order (including the direction), or sets *p_isnull.
+ */
+STATIC_FUNCTION(cl_ulong)
+gpusort_radix_key(kern_context *kcxt,
+				  kern_data_store *kds_slot,
+				  size_t kds_index,
+				  cl_bool *p_isnull);
+
+/*
+ * gpusort_radix_float4/float8 - normalization of floating point values.
+ * Negative values are inverted, and sign bit is set on the positive values,
+ * so unsigned comparison is equivalent to the comparison of float values.
+ * NaN is larger than any other values, as PostgreSQL doing.
+ */
+STATIC_INLINE(cl_ulong)
+gpusort_radix_float4(cl_float fval)
+{
+	cl_uint		bits = (isnan(fval) ? 0x7fc00000U : __float_as_uint(fval));
+
+	return (cl_ulong)((bits & 0x80000000U) != 0 ? ~bits : bits | 0x80000000U);
+}
+
+STATIC_INLINE(cl_ulong)
+gpusort_radix_float8(cl_double fval)
+{
+	cl_ulong	bits = (isnan(fval)
+						? 0x7ff8000000000000UL
+						: (cl_ulong)__double_as_longlong(fval));
+
+	return ((bits & 0x8000000000000000UL) != 0
+			? ~bits
+			: bits | 0x8000000000000000UL);
+}
+
+/*
+ * gpusort_radix_digit - digit of the key in the current pass. NULLs are
+ * sorted on the last pass (GPUSORT_RADIX_NULLS_PASS) only.
+ */
+STATIC_INLINE(cl_uint)
+gpusort_radix_digit(kern_context *kcxt,
+					kern_data_store *kds_slot,
+					cl_uint kds_index,
+					cl_uint shift,
+					cl_bool nulls_first,
+					cl_bool *p_isnull)
+{
+	cl_ulong	key;
+	cl_bool		isnull;
+
+	key = gpusort_radix_key(kcxt, kds_slot, kds_index, &isnull);
+	*p_isnull = isnull;
+	if (shift == GPUSORT_RADIX_NULLS_PASS)
+		return (isnull == nulls_first ? 0 : 1);
+	if (isnull)
+		return 0;
+	return (cl_uint)(key >> shift) & (GPUSORT_RADIX_NBUCKETS - 1);
+}
+
 /*
  * gpusort_projection
  *
@@ -508,6 +617,584 @@ gpusort_fixup_pointers(kern_gpusort *kgpusort,
 	kern_writeback_error_status(&kgpusort->kerror, kcxt.e);
 }
 
+/*
+ * gpusort_radix_histogram
+ *
+ * It counts number of the digits for each tile, then writes back to the
+ * histogram area as hist[digit * ntiles + tile] form, to calculate the
+ * destination of the items by a simple prefix-sum.
+ */
+KERNEL_FUNCTION(void)
+gpusort_radix_histogram(kern_gpusort *kgpusort,
+						kern_resultbuf *kresults,
+						kern_data_store *kds_slot,
+						cl_uint *src_index,
+						size_t shift)
+{
+	kern_parambuf  *kparams = KERN_GPUSORT_PARAMBUF(kgpusort);
+	kern_context	kcxt;
+	cl_uint		   *l_hist = SHARED_WORKMEM(cl_uint);
+	cl_uint		   *hist = KERN_GPUSORT_RADIX_HIST(kresults);
+	cl_uint			nitems = kresults->nitems;
+	cl_uint			ntiles = GPUSORT_RADIX_NTILES(nitems);
+	cl_uint			tile_base = get_global_index() * GPUSORT_RADIX_TILE_SZ;
+	cl_uint			tile_limit = Min(tile_base + GPUSORT_RADIX_TILE_SZ,
+									 nitems);
+	cl_uint			nnulls = 0;
+	cl_uint			digit;
+	cl_bool			isnull;
+	cl_uint			i;
+
+	INIT_KERNEL_CONTEXT(&kcxt, gpusort_radix_histogram, kparams);
+
+	for (i = get_local_id(); i < GPUSORT_RADIX_NBUCKETS; i += get_local_size())
+		l_hist[i] = 0;
+	__syncthreads();
+
+	for (i = tile_base + get_local_id(); i < tile_limit; i += get_local_size())
+	{
+		digit = gpusort_radix_digit(&kcxt, kds_slot, src_index[i], shift,
+									kgpusort->radix_nulls_first, &isnull);
+		if (isnull)
+			nnulls++;
+		atomicAdd(&l_hist[digit], 1);
+	}
+	__syncthreads();
+
+	for (i = get_local_id(); i < GPUSORT_RADIX_NBUCKETS; i += get_local_size())
+		hist[i * ntiles + get_global_index()] = l_hist[i];
+	/* the first pass also counts NULLs, to skip the last pass if none */
+	if (shift == 0 && nnulls > 0)
+		atomicAdd(KERN_GPUSORT_RADIX_NULLS(kresults), nnulls);
+
+	kern_writeback_error_status(&kresults->kerror, kcxt.e);
+}
+
+/*
+ * gpusort_radix_prefix
+ *
+ * It replaces the histogram by its exclusive prefix-sum; that is the first
+ * destination of the digit on the tile. It runs on a single block.
+ */
+KERNEL_FUNCTION_MAXTHREADS(void)
+gpusort_radix_prefix(kern_gpusort *kgpusort,
+					 kern_resultbuf *kresults)
+{
+	cl_uint		   *hist = KERN_GPUSORT_RADIX_HIST(kresults);
+	cl_uint			nhist = (GPUSORT_RADIX_NBUCKETS *
+							 GPUSORT_RADIX_NTILES(kresults->nitems));
+	cl_uint			unitsz = (nhist + get_local_size() - 1) / get_local_size();
+	cl_uint			base = Min(get_local_id() * unitsz, nhist);
+	cl_uint			limit = Min(base + unitsz, nhist);
+	cl_uint			offset;
+	cl_uint			total;
+	cl_uint			temp;
+	cl_uint			sum = 0;
+	cl_uint			i;
+
+	for (i = base; i < limit; i++)
+		sum += hist[i];
+	offset = pgstromStairlikeSum(sum, &total);
+	for (i = base; i < limit; i++)
+	{
+		temp = hist[i];
+		hist[i] = offset;
+		offset += temp;
+	}
+}
+
+/*
+ * gpusort_radix_scatter
+ *
+ * It moves the items of the tile to the destination according to the digit,
+ * with keeping the order of items in same digit; LSD radix sort requires
+ * every pass is stable. Rank of the item among the same digits is computed
+ * per warp using __ballot(), then per warp counters are accumulated.
+ */
+KERNEL_FUNCTION_MAXTHREADS(void)
+gpusort_radix_scatter(kern_gpusort *kgpusort,
+					  kern_resultbuf *kresults,
+					  kern_data_store *kds_slot,
+					  cl_uint *src_index,
+					  cl_uint *dst_index,
+					  size_t shift)
+{
+	kern_parambuf  *kparams = KERN_GPUSORT_PARAMBUF(kgpusort);
+	kern_context	kcxt;
+	cl_uint		   *hist = KERN_GPUSORT_RADIX_HIST(kresults);
+	cl_uint			nitems = kresults->nitems;
+	cl_uint			ntiles = GPUSORT_RADIX_NTILES(nitems);
+	cl_uint			tile_base = get_global_index() * GPUSORT_RADIX_TILE_SZ;
+	cl_uint			tile_limit = Min(tile_base + GPUSORT_RADIX_TILE_SZ,
+									 nitems);
+	cl_uint			nwarps = (get_local_size() + warpSize - 1) / warpSize;
+	cl_uint			warp_id = get_local_id() / warpSize;
+	cl_uint			lane_id = (get_local_id() & (warpSize - 1));
+	cl_uint		   *w_count = SHARED_WORKMEM(cl_uint);
+	cl_uint		   *c_count = w_count + nwarps * GPUSORT_RADIX_NBUCKETS;
+	cl_uint		   *t_base = c_count + GPUSORT_RADIX_NBUCKETS;
+	cl_uint			base;
+	cl_uint			kds_index = 0;
+	cl_uint			digit = 0;
+	cl_uint			peers;
+	cl_uint			rank = 0;
+	cl_uint			sum, temp;
+	cl_bool			isnull;
+	cl_bool			valid;
+	cl_uint			i, j;
+
+	INIT_KERNEL_CONTEXT(&kcxt, gpusort_radix_scatter, kparams);
+
+	for (i = get_local_id(); i < GPUSORT_RADIX_NBUCKETS; i += get_local_size())
+		t_base[i] = hist[i * ntiles + get_global_index()];
+	__syncthreads();
+
+	for (base = tile_base; base < tile_limit; base += get_local_size())
+	{
+		for (i = get_local_id();
+			 i < nwarps * GPUSORT_RADIX_NBUCKETS;
+			 i += get_local_size())
+			w_count[i] = 0;
+		__syncthreads();
+
+		i = base + get_local_id();
+		valid = (i < tile_limit);
+		if (valid)
+		{
+			kds_index = src_index[i];
+			digit = gpusort_radix_digit(&kcxt, kds_slot, kds_index, shift,
+										kgpusort->radix_nulls_first,
+										&isnull);
+		}
+		/* lanes in this warp that have same digit */
+		peers = __ballot(valid);
+		for (j=0; j < GPUSORT_RADIX_BITS; j++)
+		{
+			cl_uint		mask = __ballot((digit >> j) & 1);
+
+			peers &= (((digit >> j) & 1) != 0 ? mask : ~mask);
+		}
+		if (valid)
+		{
+			rank = __popc(peers & ((1U << lane_id) - 1));
+			if (rank == 0)
+				w_count[warp_id * GPUSORT_RADIX_NBUCKETS + digit]
+					= __popc(peers);
+		}
+		__syncthreads();
+
+		/* w_count[] becomes the base position of the warp in this round */
+		for (i = get_local_id(); i < GPUSORT_RADIX_NBUCKETS; i += get_local_size())
+		{
+			sum = 0;
+			for (j=0; j < nwarps; j++)
+			{
+				temp = w_count[j * GPUSORT_RADIX_NBUCKETS + i];
+				w_count[j * GPUSORT_RADIX_NBUCKETS + i] = sum;
+				sum += temp;
+			}
+			c_count[i] = sum;
+		}
+		__syncthreads();
+
+		if (valid)
+			dst_index[t_base[digit] +
+					  w_count[warp_id * GPUSORT_RADIX_NBUCKETS + digit] +
+					  rank] = kds_index;
+		__syncthreads();
+
+		for (i = get_local_id(); i < GPUSORT_RADIX_NBUCKETS; i += get_local_size())
+			t_base[i] += c_count[i];
+		__syncthreads();
+	}
+	kern_writeback_error_status(&kresults->kerror, kcxt.e);
+}
+
+/*
+ * gpusort_radix_copyback
+ *
+ * It copies the sorted index to results[], if the last pass wrote back
+ * to the extra index array.
+ */
+KERNEL_FUNCTION(void)
+gpusort_radix_copyback(kern_gpusort *kgpusort,
+					   kern_resultbuf *kresults,
+					   cl_uint *src_index)
+{
+	if (get_global_id() < kresults->nitems)
+		kresults->results[get_global_id()] = src_index[get_global_id()];
+}
+
+/*
+ * gpusort_radix_main
+ *
+ * Controller of the radix sort, instead of bitonic sorting. It runs
+ * (radix_nbits / GPUSORT_RADIX_BITS) passes from the least significant
+ * digit, and an additional pass to sort NULLs if any.
+ */
+STATIC_FUNCTION(void)
+gpusort_radix_main(kern_context *kcxt,
+				   kern_gpusort *kgpusort,
+				   kern_resultbuf *kresults,
+				   kern_data_store *kds_slot)
+{
+	void		  **kern_args;
+	cl_uint			nitems = kresults->nitems;
+	cl_uint			ntiles = GPUSORT_RADIX_NTILES(nitems);
+	cl_uint		   *index_buf[2];
+	cl_uint			nwarps;
+	cl_uint			shift;
+	cl_int			curr = 0;
+	dim3			grid_sz;
+	dim3			block_sz;
+	dim3			scatter_sz;
+	cl_ulong		tv_start;
+	cudaError_t		status = cudaSuccess;
+
+	index_buf[0] = kresults->results;
+	index_buf[1] = KERN_GPUSORT_RADIX_INDEX(kresults);
+	*KERN_GPUSORT_RADIX_NULLS(kresults) = 0;
+
+	/* block size of the scatter kernel depends on shared memory usage */
+	status = largest_workgroup_size(&grid_sz,
+									&scatter_sz,
+									(const void *)gpusort_radix_scatter,
+									nitems,
+									2 * sizeof(cl_uint) *
+									GPUSORT_RADIX_NBUCKETS,
+									sizeof(cl_uint) *
+									GPUSORT_RADIX_NBUCKETS / warpSize);
+	if (status != cudaSuccess)
+	{
+		STROM_SET_RUNTIME_ERROR(&kcxt->e, status);
+		return;
+	}
+	nwarps = (scatter_sz.x + warpSize - 1) / warpSize;
+
+	for (shift = 0;
+		 shift <= GPUSORT_RADIX_NULLS_PASS;
+		 shift += GPUSORT_RADIX_BITS)
+	{
+		if (shift >= kgpusort->radix_nbits)
+		{
+			/* no need to run the NULLs pass, if no NULLs */
+			if (*KERN_GPUSORT_RADIX_NULLS(kresults) == 0)
+				break;
+			shift = GPUSORT_RADIX_NULLS_PASS;
+		}
+
+		/*
+		 * KERNEL_FUNCTION(void)
+		 * gpusort_radix_histogram(kern_gpusort *kgpusort,
+		 *                         kern_resultbuf *kresults,
+		 *                         kern_data_store *kds_slot,
+		 *                         cl_uint *src_index,
+		 *                         size_t shift)
+		 */
+		tv_start = GlobalTimer();
+		kern_args = (void **)
+			cudaGetParameterBuffer(sizeof(void *),
+								   sizeof(void *) * 5);
+		if (!kern_args)
+		{
+			STROM_SET_ERROR(&kcxt->e, StromError_OutOfKernelArgs);
+			return;
+		}
+		kern_args[0] = kgpusort;
+		kern_args[1] = kresults;
+		kern_args[2] = kds_slot;
+		kern_args[3] = index_buf[curr];
+		kern_args[4] = (void *)(size_t)shift;
+
+		status = optimal_workgroup_size(&grid_sz,
+										&block_sz,
+										(const void *)
+										gpusort_radix_histogram,
+										GPUSORT_RADIX_TILE_SZ,
+										sizeof(cl_uint) *
+										GPUSORT_RADIX_NBUCKETS, 0);
+		if (status != cudaSuccess)
+		{
+			STROM_SET_RUNTIME_ERROR(&kcxt->e, status);
+			return;
+		}
+		grid_sz.x = ntiles;
+		status = cudaLaunchDevice((void *)gpusort_radix_histogram,
+								  kern_args, grid_sz, block_sz,
+								  sizeof(cl_uint) * GPUSORT_RADIX_NBUCKETS,
+								  NULL);
+		if (status != cudaSuccess)
+		{
+			STROM_SET_RUNTIME_ERROR(&kcxt->e, status);
+			return;
+		}
+
+		/*
+		 * KERNEL_FUNCTION_MAXTHREADS(void)
+		 * gpusort_radix_prefix(kern_gpusort *kgpusort,
+		 *                      kern_resultbuf *kresults)
+		 */
+		kern_args = (void **)
+			cudaGetParameterBuffer(sizeof(void *),
+								   sizeof(void *) * 2);
+		if (!kern_args)
+		{
+			STROM_SET_ERROR(&kcxt->e, StromError_OutOfKernelArgs);
+			return;
+		}
+		kern_args[0] = kgpusort;
+		kern_args[1] = kresults;
+
+		status = largest_workgroup_size(&grid_sz,
+										&block_sz,
+										(const void *)gpusort_radix_prefix,
+										GPUSORT_RADIX_NBUCKETS * ntiles,
+										0, sizeof(cl_uint));
+		if (status != cudaSuccess)
+		{
+			STROM_SET_RUNTIME_ERROR(&kcxt->e, status);
+			return;
+		}
+		grid_sz.x = 1;
+		status = cudaLaunchDevice((void *)gpusort_radix_prefix,
+								  kern_args, grid_sz, block_sz,
+								  sizeof(cl_uint) * block_sz.x,
+								  NULL);
+		if (status != cudaSuccess)
+		{
+			STROM_SET_RUNTIME_ERROR(&kcxt->e, status);
+			return;
+		}
+		status = cudaDeviceSynchronize();
+		if (status != cudaSuccess)
+		{
+			STROM_SET_RUNTIME_ERROR(&kcxt->e, status);
+			return;
+		}
+		TIMEVAL_RECORD(kgpusort,kern_lsort,tv_start);
+
+		/*
+		 * KERNEL_FUNCTION_MAXTHREADS(void)
+		 * gpusort_radix_scatter(kern_gpusort *kgpusort,
+		 *                       kern_resultbuf *kresults,
+		 *                       kern_data_store *kds_slot,
+		 *                       cl_uint *src_index,
+		 *                       cl_uint *dst_index,
+		 *                       size_t shift)
+		 */
+		tv_start = GlobalTimer();
+		kern_args = (void **)
+			cudaGetParameterBuffer(sizeof(void *),
+								   sizeof(void *) * 6);
+		if (!kern_args)
+		{
+			STROM_SET_ERROR(&kcxt->e, StromError_OutOfKernelArgs);
+			return;
+		}
+		kern_args[0] = kgpusort;
+		kern_args[1] = kresults;
+		kern_args[2] = kds_slot;
+		kern_args[3] = index_buf[curr];
+		kern_args[4] = index_buf[1 - curr];
+		kern_args[5] = (void *)(size_t)shift;
+
+		grid_sz.x = ntiles;
+		grid_sz.y = 1;
+		grid_sz.z = 1;
+		status = cudaLaunchDevice((void *)gpusort_radix_scatter,
+								  kern_args, grid_sz, scatter_sz,
+								  sizeof(cl_uint) * (nwarps + 2) *
+								  GPUSORT_RADIX_NBUCKETS,
+								  NULL);
+		if (status != cudaSuccess)
+		{
+			STROM_SET_RUNTIME_ERROR(&kcxt->e, status);
+			return;
+		}
+		status = cudaDeviceSynchronize();
+		if (status != cudaSuccess)
+		{
+			STROM_SET_RUNTIME_ERROR(&kcxt->e, status);
+			return;
+		}
+		TIMEVAL_RECORD(kgpusort,kern_ssort,tv_start);
+		curr = 1 - curr;
+	}
+
+	/* write back the sorted index to results[], if needed */
+	if (curr != 0)
+	{
+		/*
+		 * KERNEL_FUNCTION(void)
+		 * gpusort_radix_copyback(kern_gpusort *kgpusort,
+		 *                        kern_resultbuf *kresults,
+		 *                        cl_uint *src_index)
+		 */
+		kern_args = (void **)
+			cudaGetParameterBuffer(sizeof(void *),
+								   sizeof(void *) * 3);
+		if (!kern_args)
+		{
+			STROM_SET_ERROR(&kcxt->e, StromError_OutOfKernelArgs);
+			return;
+		}
+		kern_args[0] = kgpusort;
+		kern_args[1] = kresults;
+		kern_args[2] = index_buf[curr];
+
+		status = optimal_workgroup_size(&grid_sz,
+										&block_sz,
+										(const void *)
+										gpusort_radix_copyback,
+										nitems, 0, 0);
+		if (status != cudaSuccess)
+		{
+			STROM_SET_RUNTIME_ERROR(&kcxt->e, status);
+			return;
+		}
+		status = cudaLaunchDevice((void *)gpusort_radix_copyback,
+								  kern_args, grid_sz, block_sz,
+								  0, NULL);
+		if (status != cudaSuccess)
+		{
+			STROM_SET_RUNTIME_ERROR(&kcxt->e, status);
+			return;
+		}
+		status = cudaDeviceSynchronize();
+		if (status != cudaSuccess)
+		{
+			STROM_SET_RUNTIME_ERROR(&kcxt->e, status);
+			return;
+		}
+	}
+}
+
+/*
+ * gpusort_bound_gather / gpusort_bound_scatter
+ *
+ * They move the top-K rows to the head of kds_slot, through the temporary
+ * buffer, because destination may be overlapped with the source rows.
+ */
+KERNEL_FUNCTION(void)
+gpusort_bound_gather(kern_gpusort *kgpusort,
+					 kern_resultbuf *kresults,
+					 kern_data_store *kds_slot)
+{
+	char	   *temp = KERN_GPUSORT_BOUND_BUFFER(kresults);
+	size_t		rowsz = KDS_CALCULATE_SLOT_LENGTH(kds_slot->ncols, 1) -
+						KDS_CALCULATE_SLOT_LENGTH(kds_slot->ncols, 0);
+
+	if (get_global_id() < kgpusort->bound_nitems)
+	{
+		cl_uint		kds_index = kresults->results[get_global_id()];
+
+		memcpy(temp + rowsz * get_global_id(),
+			   KERN_DATA_STORE_VALUES(kds_slot, kds_index),
+			   rowsz);
+	}
+}
+
+KERNEL_FUNCTION(void)
+gpusort_bound_scatter(kern_gpusort *kgpusort,
+					  kern_resultbuf *kresults,
+					  kern_data_store *kds_slot)
+{
+	char	   *temp = KERN_GPUSORT_BOUND_BUFFER(kresults);
+	size_t		rowsz = KDS_CALCULATE_SLOT_LENGTH(kds_slot->ncols, 1) -
+						KDS_CALCULATE_SLOT_LENGTH(kds_slot->ncols, 0);
+
+	if (get_global_id() < kgpusort->bound_nitems)
+	{
+		memcpy(KERN_DATA_STORE_VALUES(kds_slot, get_global_id()),
+			   temp + rowsz * get_global_id(),
+			   rowsz);
+		kresults->results[get_global_id()] = get_global_id();
+	}
+}
+
+/*
+ * gpusort_bound_main
+ *
+ * It truncates the sorted results to the top-K items, and also moves the
+ * rows to the head of kds_slot if bound_compact.
+ */
+STATIC_FUNCTION(void)
+gpusort_bound_main(kern_context *kcxt,
+				   kern_gpusort *kgpusort,
+				   kern_resultbuf *kresults,
+				   kern_data_store *kds_slot)
+{
+	const void	   *kern_funcs[2];
+	void		  **kern_args;
+	dim3			grid_sz;
+	dim3			block_sz;
+	cl_int			i;
+	cudaError_t		status = cudaSuccess;
+
+	/* CPU fallback needs all the items, if keycomp() failed */
+	if (kgpusort->bound_nitems == 0 ||
+		kgpusort->bound_nitems >= kresults->nitems ||
+		kresults->kerror.errcode != StromError_Success)
+		return;
+
+	if (kgpusort->bound_compact)
+	{
+		/*
+		 * KERNEL_FUNCTION(void)
+		 * gpusort_bound_gather(kern_gpusort *kgpusort,
+		 *                      kern_resultbuf *kresults,
+		 *                      kern_data_store *kds_slot)
+		 * KERNEL_FUNCTION(void)
+		 * gpusort_bound_scatter(kern_gpusort *kgpusort,
+		 *                       kern_resultbuf *kresults,
+		 *                       kern_data_store *kds_slot)
+		 */
+		kern_funcs[0] = (const void *)gpusort_bound_gather;
+		kern_funcs[1] = (const void *)gpusort_bound_scatter;
+		for (i=0; i < 2; i++)
+		{
+			kern_args = (void **)
+				cudaGetParameterBuffer(sizeof(void *),
+									   sizeof(void *) * 3);
+			if (!kern_args)
+			{
+				STROM_SET_ERROR(&kcxt->e, StromError_OutOfKernelArgs);
+				return;
+			}
+			kern_args[0] = kgpusort;
+			kern_args[1] = kresults;
+			kern_args[2] = kds_slot;
+
+			status = optimal_workgroup_size(&grid_sz,
+											&block_sz,
+											kern_funcs[i],
+											kgpusort->bound_nitems,
+											0, 0);
+			if (status != cudaSuccess)
+			{
+				STROM_SET_RUNTIME_ERROR(&kcxt->e, status);
+				return;
+			}
+			status = cudaLaunchDevice((void *)kern_funcs[i],
+									  kern_args, grid_sz, block_sz,
+									  0, NULL);
+			if (status != cudaSuccess)
+			{
+				STROM_SET_RUNTIME_ERROR(&kcxt->e, status);
+				return;
+			}
+			status = cudaDeviceSynchronize();
+			if (status != cudaSuccess)
+			{
+				STROM_SET_RUNTIME_ERROR(&kcxt->e, status);
+				return;
+			}
+		}
+		kds_slot->nitems = kgpusort->bound_nitems;
+	}
+	kresults->nitems = kgpusort->bound_nitems;
+}
+
 KERNEL_FUNCTION(void)
 gpusort_main(kern_gpusort *kgpusort,
 			 kern_resultbuf *kresults,
@@ -528,6 +1215,15 @@ gpusort_main(kern_gpusort *kgpusort,
 
 	INIT_KERNEL_CONTEXT(&kcxt, gpusort_main, kparams);
 
+	/* radix sort, if sorting key is available */
+	if (kgpusort->radix_nbits > 0)
+	{
+		gpusort_radix_main(&kcxt, kgpusort, kresults, kds_slot);
+		if (kcxt.e.errcode != StromError_Success)
+			goto out;
+		goto bounded_sort;
+	}
+
 	/*
 	 * NOTE: Because of the bitonic sorting algorithm characteristics,
 	 * block size has to be 2^N value and common in the three kernel
@@ -701,6 +1397,12 @@ gpusort_main(kern_gpusort *kgpusort,
 		TIMEVAL_RECORD(kgpusort,kern_msort,tv_start);
 	}
 
+bounded_sort:
+	/* keep only the top-K items, if bounded */
+	gpusort_bound_main(&kcxt, kgpusort, kresults, kds_slot);
+	if (kcxt.e.errcode != StromError_Success)
+		goto out;
+
 	/*
 	 * If kds_slot contains any attribute of pointer reference, we have to
 	 * fix up device pointer to host pointer, prior to receive DMA.
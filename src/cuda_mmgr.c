@@ -17,8 +17,15 @@
  */
 #include "postgres.h"
 
+#include "miscadmin.h"
+#include "storage/ipc.h"
+#include "storage/shmem.h"
+#include "storage/spin.h"
+#include "utils/guc.h"
 #include "utils/memdebug.h"
 #include "utils/memutils.h"
+#include <sys/syscall.h>
+#include <unistd.h>
 
 #include "pg_strom.h"
 
@@ -57,13 +64,49 @@ typedef struct cudaHostMemBlock
 	dlist_node			chain;			/* link to active_blocks */
 	dlist_head			addr_chunks;	/* list of chunks in address order, or
 										 * zero if external block. */
+	Size				arena_length;	/* length on the shared arena, or
+										 * zero if cuMemAllocHost'ed block */
 	cudaHostMemChunk	first_chunk;	/* first chunk of this block */
 } cudaHostMemBlock;
 
+/*
+ * Shared host memory arena
+ *
+ * Postmaster acquires a shared memory segment and touches all the pages
+ * preliminary, then backends carve blocks from the arena in the unit of
+ * HOSTMEM_ARENA_PAGESZ, instead of cuMemAllocHost(). The carved block is
+ * registered by cuMemHostRegister() on the CUDA context of the backend,
+ * because page-locking is a property of the process, not memory itself.
+ * Suballocation from the block is the same buddy logic as usual.
+ * On the NUMA system, the arena is partitioned to the NUMA nodes where the
+ * devices are connected to, then backends carve the pages local to their
+ * preferable NUMA node first.
+ */
+#define HOSTMEM_ARENA_PAGESZ		(2UL << 20)		/* 2MB */
+
+typedef struct
+{
+	slock_t		lock;
+	cl_uint		num_pages;		/* number of pages in the arena */
+	cl_uint		num_free_pages;	/* number of free pages */
+	char	   *base;			/* base address of the arena */
+	cl_short   *numa_node;		/* NUMA node of the pages, or -1 */
+	pid_t		owner[FLEXIBLE_ARRAY_MEMBER];	/* 0, if free page */
+} cudaHostMemArena;
+
+#define HOSTMEM_ARENA_HEAD_SIZE(num_pages)						\
+	(MAXALIGN(offsetof(cudaHostMemArena, owner[(num_pages)])) +	\
+	 MAXALIGN(sizeof(cl_short) * (num_pages)))
+
+static int			hostmem_arena_size_kb;	/* GUC */
+static cudaHostMemArena *hostmem_arena = NULL;
+static shmem_startup_hook_type shmem_startup_next = NULL;
+
 typedef struct
 {
 	MemoryContextData	header;
 	CUcontext			cuda_context;
+	cl_int				numa_node;		/* preferable NUMA node, or -1 */
 	cl_int				keep_freemem;	/* if > 0, try to keep free chunk */
 	cl_int				num_host_malloc;/* # of cuMemAllocHost calls */
 	cl_int				num_host_mfree;	/* # of cuMemFreeHost calls */
@@ -86,6 +129,251 @@ cudaHostMemAssert(void *pointer)
 	Assert(HOSTMEM_CHUNK_MAGIC(chunk) == HOSTMEM_CHUNK_MAGIC_CODE);
 }
 
+/*
+ * Memory policy of the host pinned memory
+ *
+ * cuMemAllocHost() allocates and touches the pages according to the memory
+ * policy of the calling thread, so we temporarily switch the policy to
+ * prefer the NUMA node of the context. libnuma is not required, because
+ * we use only a few system calls.
+ */
+#ifndef BITS_PER_LONG
+#define BITS_PER_LONG				(8 * sizeof(unsigned long))
+#endif
+#define HOSTMEM_NUMA_MAXNODES		1024
+#define HOSTMEM_NUMA_MASKLEN		(HOSTMEM_NUMA_MAXNODES / BITS_PER_LONG)
+#ifndef MPOL_DEFAULT
+#define MPOL_DEFAULT				0
+#endif
+#ifndef MPOL_PREFERRED
+#define MPOL_PREFERRED				1
+#endif
+
+typedef struct
+{
+	int				mode;
+	unsigned long	nodemask[HOSTMEM_NUMA_MASKLEN];
+} cudaHostMemPolicy;
+
+static inline void
+hostmem_numa_nodemask(unsigned long *nodemask, int numa_node)
+{
+	memset(nodemask, 0, sizeof(unsigned long) * HOSTMEM_NUMA_MASKLEN);
+	nodemask[numa_node / BITS_PER_LONG] |= (1UL << (numa_node % BITS_PER_LONG));
+}
+
+/*
+ * hostmem_numa_prefer
+ *
+ * It switches the memory policy of the current thread to prefer the
+ * supplied NUMA node, and saves the previous one. It returns false if
+ * nothing were changed.
+ */
+static bool
+hostmem_numa_prefer(int numa_node, cudaHostMemPolicy *saved)
+{
+#if defined(SYS_get_mempolicy) && defined(SYS_set_mempolicy)
+	unsigned long	nodemask[HOSTMEM_NUMA_MASKLEN];
+
+	if (numa_node < 0 || numa_node >= HOSTMEM_NUMA_MAXNODES)
+		return false;
+	if (syscall(SYS_get_mempolicy, &saved->mode, saved->nodemask,
+				HOSTMEM_NUMA_MAXNODES, NULL, 0) != 0)
+		return false;
+	hostmem_numa_nodemask(nodemask, numa_node);
+	if (syscall(SYS_set_mempolicy, MPOL_PREFERRED, nodemask,
+				HOSTMEM_NUMA_MAXNODES + 1) != 0)
+		return false;
+	return true;
+#else
+	return false;
+#endif
+}
+
+/*
+ * hostmem_numa_restore
+ *
+ * It restores the memory policy saved by hostmem_numa_prefer()
+ */
+static void
+hostmem_numa_restore(cudaHostMemPolicy *saved)
+{
+#if defined(SYS_set_mempolicy)
+	if (syscall(SYS_set_mempolicy, saved->mode,
+				saved->mode == MPOL_DEFAULT ? NULL : saved->nodemask,
+				HOSTMEM_NUMA_MAXNODES + 1) != 0)
+		elog(WARNING, "failed to restore memory policy: %m");
+#endif
+}
+
+/*
+ * hostmem_numa_bind
+ *
+ * It sets the memory policy of the supplied address range to prefer the
+ * NUMA node. It has to be called prior to the first touch of the pages.
+ */
+static bool
+hostmem_numa_bind(void *addr, Size length, int numa_node)
+{
+#if defined(SYS_mbind)
+	unsigned long	nodemask[HOSTMEM_NUMA_MASKLEN];
+
+	if (numa_node < 0 || numa_node >= HOSTMEM_NUMA_MAXNODES)
+		return false;
+	hostmem_numa_nodemask(nodemask, numa_node);
+	if (syscall(SYS_mbind, addr, length, MPOL_PREFERRED, nodemask,
+				HOSTMEM_NUMA_MAXNODES + 1, 0) != 0)
+	{
+		elog(LOG, "failed on mbind to NUMA node %d: %m", numa_node);
+		return false;
+	}
+	return true;
+#else
+	return false;
+#endif
+}
+
+/*
+ * cudaHostMemArenaCleanup
+ *
+ * It releases all the pages owned by the backend on exit, because host
+ * pinned memory context is not released explicitly on process exit.
+ */
+static void
+cudaHostMemArenaCleanup(int code, Datum arg)
+{
+	cl_uint		i;
+
+	SpinLockAcquire(&hostmem_arena->lock);
+	for (i=0; i < hostmem_arena->num_pages; i++)
+	{
+		if (hostmem_arena->owner[i] == MyProcPid)
+		{
+			hostmem_arena->owner[i] = 0;
+			hostmem_arena->num_free_pages++;
+		}
+	}
+	SpinLockRelease(&hostmem_arena->lock);
+}
+
+/*
+ * cudaHostMemArenaAlloc
+ *
+ * It carves out a series of free pages from the shared arena. NULL means
+ * no arena is configured, or no room to allocate. Pages on the supplied
+ * NUMA node are preferred, if any.
+ */
+static void *
+cudaHostMemArenaAlloc(Size required, int numa_node)
+{
+	static bool	on_shmem_callback_registered = false;
+	cl_uint		npages = (required + HOSTMEM_ARENA_PAGESZ - 1) /
+		HOSTMEM_ARENA_PAGESZ;
+	cl_uint		i, j;
+	int			pass;
+	void	   *result = NULL;
+
+	if (!hostmem_arena || npages > hostmem_arena->num_pages)
+		return NULL;
+
+	if (!on_shmem_callback_registered)
+	{
+		on_shmem_exit(cudaHostMemArenaCleanup, 0);
+		on_shmem_callback_registered = true;
+	}
+
+	SpinLockAcquire(&hostmem_arena->lock);
+	/* first fit; local pages at the first pass, then any pages */
+	for (pass = (numa_node < 0 ? 1 : 0);
+		 pass < 2 && !result && npages <= hostmem_arena->num_free_pages;
+		 pass++)
+	{
+		for (i=0; i + npages <= hostmem_arena->num_pages; i = j + 1)
+		{
+			for (j=i; j < i + npages; j++)
+			{
+				if (hostmem_arena->owner[j] != 0 ||
+					(pass == 0 && hostmem_arena->numa_node[j] != numa_node))
+					break;
+			}
+			if (j == i + npages)
+			{
+				for (j=i; j < i + npages; j++)
+					hostmem_arena->owner[j] = MyProcPid;
+				hostmem_arena->num_free_pages -= npages;
+				result = hostmem_arena->base + i * HOSTMEM_ARENA_PAGESZ;
+				break;
+			}
+		}
+	}
+	SpinLockRelease(&hostmem_arena->lock);
+
+	return result;
+}
+
+/*
+ * cudaHostMemArenaFree
+ *
+ * It gives back the pages to the shared arena.
+ */
+static void
+cudaHostMemArenaFree(void *pointer, Size length)
+{
+	cl_uint		npages = (length + HOSTMEM_ARENA_PAGESZ - 1) /
+		HOSTMEM_ARENA_PAGESZ;
+	cl_uint		i, index;
+
+	Assert((char *)pointer >= hostmem_arena->base &&
+		   ((char *)pointer - hostmem_arena->base) % HOSTMEM_ARENA_PAGESZ == 0);
+	index = ((char *)pointer - hostmem_arena->base) / HOSTMEM_ARENA_PAGESZ;
+
+	SpinLockAcquire(&hostmem_arena->lock);
+	for (i=index; i < index + npages; i++)
+	{
+		Assert(hostmem_arena->owner[i] == MyProcPid);
+		hostmem_arena->owner[i] = 0;
+	}
+	hostmem_arena->num_free_pages += npages;
+	SpinLockRelease(&hostmem_arena->lock);
+}
+
+/*
+ * cudaHostMemFreeBlock
+ *
+ * It releases the host pinned memory block, according to the way to
+ * allocate. Caller has to detach the block from the list.
+ */
+static void
+cudaHostMemFreeBlock(cudaHostMemHead *chm_head, cudaHostMemBlock *chm_block)
+{
+	CUresult	rc;
+
+	if (chm_block->arena_length == 0)
+	{
+		rc = cuMemFreeHost(chm_block);
+		if (rc != CUDA_SUCCESS)
+			elog(ERROR, "failed on cuMemFreeHost: %s", errorText(rc));
+	}
+	else
+	{
+		Size	arena_length = chm_block->arena_length;
+
+		rc = cuCtxPushCurrent(chm_head->cuda_context);
+		if (rc != CUDA_SUCCESS)
+			elog(ERROR, "failed on cuCtxPushCurrent: %s", errorText(rc));
+
+		rc = cuMemHostUnregister(chm_block);
+		if (rc != CUDA_SUCCESS)
+			elog(ERROR, "failed on cuMemHostUnregister: %s", errorText(rc));
+
+		rc = cuCtxPopCurrent(NULL);
+		if (rc != CUDA_SUCCESS)
+			elog(ERROR, "failed on cuCtxPopCurrent: %s", errorText(rc));
+
+		cudaHostMemArenaFree(chm_block, arena_length);
+	}
+}
+
 static bool
 cudaHostMemSplit(cudaHostMemHead *chm_head, int chm_class)
 {
@@ -130,6 +418,7 @@ cudaHostMemAllocBlock(cudaHostMemHead *chm_head, int least_class)
 	cudaHostMemChunk *chm_chunk;
 	Size		block_size = chm_head->block_size_next;
 	Size		least_size = (1UL << least_class);
+	Size		arena_length;
 	int			index;
 	CUresult	rc;
 	struct timeval tv1, tv2;
@@ -142,17 +431,41 @@ cudaHostMemAllocBlock(cudaHostMemHead *chm_head, int least_class)
 	Assert((block_size & (block_size - 1)) == 0);
 
 	/*
-	 * Allocation of the host pinned memory
+	 * Allocation of the host pinned memory; from the shared arena if any,
+	 * or cuMemAllocHost() elsewhere.
 	 */
 	gettimeofday(&tv1, NULL);
 	rc = cuCtxPushCurrent(chm_head->cuda_context);
 	if (rc != CUDA_SUCCESS)
 		elog(ERROR, "failed on cuCtxPushCurrent: %s", errorText(rc));
 
-	rc = cuMemAllocHost((void **)&chm_block,
-						offsetof(cudaHostMemBlock, first_chunk) + block_size);
-	if (rc != CUDA_SUCCESS)
-		elog(ERROR, "failed on cuMemAllocHost: %s", errorText(rc));
+	arena_length = offsetof(cudaHostMemBlock, first_chunk) + block_size;
+	chm_block = cudaHostMemArenaAlloc(arena_length, chm_head->numa_node);
+	if (chm_block)
+	{
+		rc = cuMemHostRegister(chm_block, arena_length,
+							   CU_MEMHOSTREGISTER_PORTABLE);
+		if (rc != CUDA_SUCCESS)
+		{
+			cudaHostMemArenaFree(chm_block, arena_length);
+			elog(ERROR, "failed on cuMemHostRegister: %s", errorText(rc));
+		}
+	}
+	else
+	{
+		cudaHostMemPolicy	mpol;
+		bool		numa_bound;
+
+		arena_length = 0;
+		numa_bound = hostmem_numa_prefer(chm_head->numa_node, &mpol);
+		rc = cuMemAllocHost((void **)&chm_block,
+							offsetof(cudaHostMemBlock,
+									 first_chunk) + block_size);
+		if (numa_bound)
+			hostmem_numa_restore(&mpol);
+		if (rc != CUDA_SUCCESS)
+			elog(ERROR, "failed on cuMemAllocHost: %s", errorText(rc));
+	}
 
 	rc = cuCtxPopCurrent(NULL);
 	if (rc != CUDA_SUCCESS)
@@ -163,6 +476,7 @@ cudaHostMemAllocBlock(cudaHostMemHead *chm_head, int least_class)
 
 	/* init block */
 	dlist_init(&chm_block->addr_chunks);
+	chm_block->arena_length = arena_length;
 	dlist_push_tail(&chm_head->blocks, &chm_block->chain);
 
 	/* init first chunk */
@@ -233,7 +547,6 @@ cudaHostMemFree(MemoryContext context, void *pointer)
 	dlist_node		   *dnode;
 	uintptr_t			offset;
 	int					index;
-	CUresult			rc;
 	struct timeval		tv1, tv2;
 
 	chunk = HOSTMEM_CHUNK_BY_POINTER(pointer);
@@ -322,9 +635,7 @@ cudaHostMemFree(MemoryContext context, void *pointer)
 
 		gettimeofday(&tv1, NULL);
 
-		rc = cuMemFreeHost(chm_block);
-		if (rc != CUDA_SUCCESS)
-			elog(ERROR, "failed on cuMemFreeHost: %s", errorText(rc));
+		cudaHostMemFreeBlock(chm_head, chm_block);
 
 		gettimeofday(&tv2, NULL);
 		chm_head->num_host_mfree++;
@@ -384,7 +695,6 @@ cudaHostMemReset(MemoryContext context)
 	cudaHostMemHead	   *chm_head = (cudaHostMemHead *) context;
 	cudaHostMemBlock   *chm_block;
 	dlist_mutable_iter	miter;
-	CUresult			rc;
 	int					i;
 
 	dlist_foreach_modify(miter, &chm_head->blocks)
@@ -392,9 +702,7 @@ cudaHostMemReset(MemoryContext context)
 		chm_block = dlist_container(cudaHostMemBlock, chain, miter.cur);
 		dlist_delete(&chm_block->chain);
 
-		rc = cuMemFreeHost(chm_block);
-		if (rc != CUDA_SUCCESS)
-			elog(ERROR, "failed on cuMemFreeHost: %s", errorText(rc));
+		cudaHostMemFreeBlock(chm_head, chm_block);
 	}
 	Assert(dlist_is_empty(&chm_head->blocks));
 	for (i=0; i <= HOSTMEM_CHUNKSZ_MAX_BIT; i++)
@@ -564,6 +872,7 @@ MemoryContext
 HostPinMemContextCreate(MemoryContext parent,
 						const char *name,
 						CUcontext cuda_context,
+						cl_int numa_node,
 						Size block_size_init,
 						Size block_size_max,
 						cl_int **pp_keep_freemem,
@@ -583,6 +892,7 @@ HostPinMemContextCreate(MemoryContext parent,
 							name);
 	/* save the reference to cuda_context */
 	chm_head->cuda_context = cuda_context;
+	chm_head->numa_node = numa_node;
 
 	/*
 	 * keep_freemem shall be incremented on creation or rescan of GpuTaskState,
@@ -618,3 +928,103 @@ HostPinMemContextCreate(MemoryContext parent,
 
 	return &chm_head->header;
 }
+
+/*
+ * pgstrom_startup_cuda_mmgr
+ *
+ * It acquires the shared host memory arena, and touches all the pages
+ * to make them resident prior to the registration by backends. If devices
+ * are connected to multiple NUMA nodes, the arena is partitioned to these
+ * nodes evenly prior to the first touch.
+ */
+static void
+pgstrom_startup_cuda_mmgr(void)
+{
+	cl_uint		num_pages = ((Size)hostmem_arena_size_kb << 10) /
+		HOSTMEM_ARENA_PAGESZ;
+	Size		arena_size = (Size)num_pages * HOSTMEM_ARENA_PAGESZ;
+	Size		head_size;
+	List	   *numa_nodes = NIL;
+	ListCell   *lc;
+	cl_uint		i, j, k;
+	bool		found;
+
+	if (shmem_startup_next)
+		(*shmem_startup_next)();
+
+	head_size = HOSTMEM_ARENA_HEAD_SIZE(num_pages);
+	hostmem_arena = ShmemInitStruct("PG-Strom host pinned memory arena",
+									head_size + HOSTMEM_ARENA_PAGESZ +
+									arena_size, &found);
+	if (found)
+		elog(ERROR, "Bug? shared memory for host memory arena already exists");
+
+	memset(hostmem_arena, 0, head_size);
+	SpinLockInit(&hostmem_arena->lock);
+	hostmem_arena->num_pages = num_pages;
+	hostmem_arena->num_free_pages = num_pages;
+	hostmem_arena->base = (char *)TYPEALIGN(HOSTMEM_ARENA_PAGESZ,
+											(char *)hostmem_arena + head_size);
+	hostmem_arena->numa_node = (cl_short *)
+		((char *)hostmem_arena +
+		 MAXALIGN(offsetof(cudaHostMemArena, owner[num_pages])));
+	for (i=0; i < num_pages; i++)
+		hostmem_arena->numa_node[i] = -1;
+
+	/* NUMA nodes where the devices are connected to */
+	foreach (lc, gpuNumaNodes())
+	{
+		if (lfirst_int(lc) >= 0)
+			numa_nodes = list_append_unique_int(numa_nodes, lfirst_int(lc));
+	}
+	if (list_length(numa_nodes) > 1)
+	{
+		k = 0;
+		foreach (lc, numa_nodes)
+		{
+			cl_uint		head = (num_pages * k) / list_length(numa_nodes);
+			cl_uint		tail = (num_pages * (k+1)) / list_length(numa_nodes);
+			int			numa_node = lfirst_int(lc);
+
+			if (head < tail &&
+				hostmem_numa_bind(hostmem_arena->base +
+								  (Size)head * HOSTMEM_ARENA_PAGESZ,
+								  (Size)(tail - head) * HOSTMEM_ARENA_PAGESZ,
+								  numa_node))
+			{
+				for (j=head; j < tail; j++)
+					hostmem_arena->numa_node[j] = numa_node;
+			}
+			k++;
+		}
+	}
+	memset(hostmem_arena->base, 0, arena_size);
+}
+
+void
+pgstrom_init_cuda_mmgr(void)
+{
+	Size		arena_size;
+	cl_uint		num_pages;
+
+	DefineCustomIntVariable("pg_strom.host_pinned_arena_size",
+							"size of shared host memory arena to be pinned",
+							NULL,
+							&hostmem_arena_size_kb,
+							0,
+							0,
+							INT_MAX,
+							PGC_POSTMASTER,
+							GUC_NOT_IN_SAMPLE | GUC_UNIT_KB,
+							NULL, NULL, NULL);
+	arena_size = (Size)hostmem_arena_size_kb << 10;
+	num_pages = arena_size / HOSTMEM_ARENA_PAGESZ;
+	if (num_pages == 0)
+		return;		/* shared host memory arena is disabled */
+
+	RequestAddinShmemSpace(HOSTMEM_ARENA_HEAD_SIZE(num_pages) +
+						   HOSTMEM_ARENA_PAGESZ +
+						   (Size)num_pages * HOSTMEM_ARENA_PAGESZ);
+	shmem_startup_next = shmem_startup_hook;
+	shmem_startup_hook = pgstrom_startup_cuda_mmgr;
+}
@@ -538,6 +538,7 @@ pg_numeric_to_datum(cl_ulong value)
 /* to avoid conflicts with auto-generated data type */
 #define PG_NUMERIC_TYPE_DEFINED
 
+#ifndef PGSTROM_DEVICE_LIBRARY_LINKED
 /*
  * Numeric format translation functions
  * ----------------------------------------------------------------
@@ -1376,7 +1377,102 @@ pgfn_numeric_min(kern_context *kcxt, pg_numeric_t arg1, pg_numeric_t arg2)
 	}
 	return (v.value ? arg2 : arg1);
 }
+#else	/* PGSTROM_DEVICE_LIBRARY_LINKED */
+/*
+ * Numeric functions are supplied by the precompiled device library
+ * (pg_strom_devlib.a) that shall be linked to the run-time built
+ * module, so we put only declarations here.
+ */
+DEVICE_LIBRARY_FUNCTION(pg_int8_t)
+numeric_to_integer(kern_context *kcxt, pg_numeric_t arg, cl_int size);
+
+DEVICE_LIBRARY_FUNCTION(pg_float8_t)
+numeric_to_float(kern_context *kcxt, pg_numeric_t arg);
+
+DEVICE_LIBRARY_FUNCTION(pg_int2_t)
+pgfn_numeric_int2(kern_context *kcxt, pg_numeric_t arg);
+
+DEVICE_LIBRARY_FUNCTION(pg_int4_t)
+pgfn_numeric_int4(kern_context *kcxt, pg_numeric_t arg);
+
+DEVICE_LIBRARY_FUNCTION(pg_int8_t)
+pgfn_numeric_int8(kern_context *kcxt, pg_numeric_t arg);
+
+DEVICE_LIBRARY_FUNCTION(pg_float4_t)
+pgfn_numeric_float4(kern_context *kcxt, pg_numeric_t arg);
+
+DEVICE_LIBRARY_FUNCTION(pg_float8_t)
+pgfn_numeric_float8(kern_context *kcxt, pg_numeric_t arg);
+
+DEVICE_LIBRARY_FUNCTION(pg_numeric_t)
+integer_to_numeric(kern_context *kcxt, pg_int8_t arg, cl_int size);
+
+DEVICE_LIBRARY_FUNCTION(pg_numeric_t)
+float_to_numeric(kern_context *kcxt, pg_float8_t arg, int dig);
+
+DEVICE_LIBRARY_FUNCTION(pg_numeric_t)
+pgfn_int2_numeric(kern_context *kcxt, pg_int2_t arg);
+
+DEVICE_LIBRARY_FUNCTION(pg_numeric_t)
+pgfn_int4_numeric(kern_context *kcxt, pg_int4_t arg);
+
+DEVICE_LIBRARY_FUNCTION(pg_numeric_t)
+pgfn_int8_numeric(kern_context *kcxt, pg_int8_t arg);
+
+DEVICE_LIBRARY_FUNCTION(pg_numeric_t)
+pgfn_float4_numeric(kern_context *kcxt, pg_float4_t arg);
+
+DEVICE_LIBRARY_FUNCTION(pg_numeric_t)
+pgfn_float8_numeric(kern_context *kcxt, pg_float8_t arg);
+
+DEVICE_LIBRARY_FUNCTION(pg_numeric_t)
+pgfn_numeric_uplus(kern_context *kcxt, pg_numeric_t arg);
+
+DEVICE_LIBRARY_FUNCTION(pg_numeric_t)
+pgfn_numeric_uminus(kern_context *kcxt, pg_numeric_t arg);
+
+DEVICE_LIBRARY_FUNCTION(pg_numeric_t)
+pgfn_numeric_abs(kern_context *kcxt, pg_numeric_t arg);
+
+DEVICE_LIBRARY_FUNCTION(pg_numeric_t)
+pgfn_numeric_add(kern_context *kcxt, pg_numeric_t arg1, pg_numeric_t arg2);
+
+DEVICE_LIBRARY_FUNCTION(pg_numeric_t)
+pgfn_numeric_sub(kern_context *kcxt, pg_numeric_t arg1, pg_numeric_t arg2);
+
+DEVICE_LIBRARY_FUNCTION(pg_numeric_t)
+pgfn_numeric_mul(kern_context *kcxt, pg_numeric_t arg1, pg_numeric_t arg2);
+
+DEVICE_LIBRARY_FUNCTION(int)
+numeric_cmp(kern_context *kcxt, pg_numeric_t arg1, pg_numeric_t arg2);
+
+DEVICE_LIBRARY_FUNCTION(pg_bool_t)
+pgfn_numeric_eq(kern_context *kcxt, pg_numeric_t arg1, pg_numeric_t arg2);
+
+DEVICE_LIBRARY_FUNCTION(pg_bool_t)
+pgfn_numeric_ne(kern_context *kcxt, pg_numeric_t arg1, pg_numeric_t arg2);
+
+DEVICE_LIBRARY_FUNCTION(pg_bool_t)
+pgfn_numeric_lt(kern_context *kcxt, pg_numeric_t arg1, pg_numeric_t arg2);
+
+DEVICE_LIBRARY_FUNCTION(pg_bool_t)
+pgfn_numeric_le(kern_context *kcxt, pg_numeric_t arg1, pg_numeric_t arg2);
+
+DEVICE_LIBRARY_FUNCTION(pg_bool_t)
+pgfn_numeric_gt(kern_context *kcxt, pg_numeric_t arg1, pg_numeric_t arg2);
+
+DEVICE_LIBRARY_FUNCTION(pg_bool_t)
+pgfn_numeric_ge(kern_context *kcxt, pg_numeric_t arg1, pg_numeric_t arg2);
+
+DEVICE_LIBRARY_FUNCTION(pg_int4_t)
+pgfn_numeric_cmp(kern_context *kcxt, pg_numeric_t arg1, pg_numeric_t arg2);
+
+DEVICE_LIBRARY_FUNCTION(pg_numeric_t)
+pgfn_numeric_max(kern_context *kcxt, pg_numeric_t arg1, pg_numeric_t arg2);
 
+DEVICE_LIBRARY_FUNCTION(pg_numeric_t)
+pgfn_numeric_min(kern_context *kcxt, pg_numeric_t arg1, pg_numeric_t arg2);
+#endif	/* PGSTROM_DEVICE_LIBRARY_LINKED */
 
 /*
  * Atomic operation support
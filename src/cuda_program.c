@@ -16,21 +16,30 @@
  * GNU General Public License for more details.
  */
 #include "postgres.h"
+#include "access/hash.h"
 #include "access/twophase.h"
 #include "access/xact.h"
 #include "catalog/catalog.h"
 #include "catalog/pg_tablespace.h"
 #include "catalog/pg_type.h"
+#include "commands/prepare.h"
+#include "executor/executor.h"
 #include "funcapi.h"
 #include "postmaster/bgworker.h"
+#include "storage/fd.h"
 #include "storage/ipc.h"
 #include "storage/proc.h"
 #include "storage/shmem.h"
+#include "tcop/dest.h"
+#include "tcop/utility.h"
 #include "utils/builtins.h"
 #include "utils/guc.h"
 #include "utils/lsyscache.h"
 #include "utils/memutils.h"
 #include "utils/pg_crc.h"
+#include "utils/plancache.h"
+#include "utils/resowner.h"
+#include "utils/snapmgr.h"
 #include <nvrtc.h>
 #include <sys/stat.h>
 #include <sys/types.h>
@@ -39,6 +48,30 @@
 #include "cuda_timelib.h"
 #include "cuda_textlib.h"
 
+/*
+ * program_tuning - result of the kernel launch autotuner for a particular
+ * kernel function on a particular device. Candidates are the block size
+ * by the occupancy calculation, shifted by 0, 1 or 2 bits; each of them
+ * is measured PGCACHE_TUNING_NTRIALS times, then the best one per item
+ * is chosen.
+ */
+#define PGCACHE_TUNING_NSLOTS		4
+#define PGCACHE_TUNING_NSHIFTS		3
+#define PGCACHE_TUNING_NTRIALS		3
+#define PGCACHE_TUNING_MIN_NITEMS	(64 * 1024)
+
+typedef struct
+{
+	cl_uint			kern_hash;	/* hash value of the kernel name, or 0 */
+	cl_uint			cuda_index;	/* index of the device */
+	bool			decided;	/* true, if best_shift is determined */
+	cl_uint			best_shift;	/* block size shift to be applied */
+	cl_uint			next_trial;	/* next candidate to be measured */
+	cl_uint			num_trials[PGCACHE_TUNING_NSHIFTS];
+	cl_double		elapsed[PGCACHE_TUNING_NSHIFTS];	/* in ms */
+	cl_ulong		nitems[PGCACHE_TUNING_NSHIFTS];
+} program_tuning;
+
 typedef struct
 {
 	dlist_node		hash_chain;
@@ -56,6 +89,7 @@ typedef struct
 	char		   *bin_image;
 	size_t			bin_length;
 	char		   *error_msg;
+	program_tuning	tuning[PGCACHE_TUNING_NSLOTS];	/* autotuner */
 	char			data[FLEXIBLE_ARRAY_MEMBER];
 } program_cache_entry;
 
@@ -86,6 +120,23 @@ typedef struct
 #define PGCACHE_MAX_BITS		24		/* 16MB */	
 #define PGCACHE_HASH_SIZE		1024
 
+/*
+ * Header of the persistent program binary file. The flat source is stored
+ * next to the header for verification, then the binary image follows.
+ */
+#define PGCACHE_FILE_MAGIC		0x50475342		/* 'PGSB' */
+
+typedef struct
+{
+	cl_uint			magic;
+	cl_uint			pgstrom_version;/* PGSTROM_VERSION_NUM */
+	cl_int			cuda_version;	/* CUDA_VERSION on build */
+	cl_int			extra_flags;
+	cl_ulong		capability;		/* baseline device capability */
+	cl_ulong		source_len;		/* length of the flat source */
+	cl_ulong		bin_length;		/* length of the binary image */
+} program_file_header;
+
 #define WORDNUM(x)		((x) / BITS_PER_BITMAPWORD)
 #define BITNUM(x)		((x) % BITS_PER_BITMAPWORD)
 
@@ -103,9 +154,21 @@ typedef struct
 /* ---- GUC variables ---- */
 static Size		program_cache_size;
 static bool		pgstrom_enable_cuda_coredump;
+static char	   *pgstrom_program_cache_dir;
+static bool		pgstrom_enable_device_library;
+static bool		pgstrom_enable_kernel_autotune;
+static char	   *pgstrom_program_prewarm_file;
+static bool		pgstrom_program_prewarm_on_prepare;
+
+/* ---- true, if ExecutorStart is invoked only to prewarm the programs ---- */
+bool			pgstrom_program_prewarm_in_progress = false;
+
+/* ---- availability of the precompiled device library ---- */
+static bool		cuda_devlib_available = false;
 
 /* ---- static variables ---- */
 static shmem_startup_hook_type shmem_startup_next;
+static ProcessUtility_hook_type process_utility_next = NULL;
 static program_cache_head *pgcache_head = NULL;
 
 /* ---- static functions ---- */
@@ -355,6 +418,39 @@ pgstrom_put_cuda_program(program_cache_entry *entry)
 	SpinLockRelease(&pgcache_head->lock);
 }
 
+/*
+ * cuda_program_crc
+ *
+ * It makes a hash value of the program; identical to the one of the
+ * program cache entry.
+ */
+static pg_crc32
+cuda_program_crc(cl_uint extra_flags, const char *kern_source)
+{
+	pg_crc32	crc;
+
+	INIT_LEGACY_CRC32(crc);
+	COMP_LEGACY_CRC32(crc, &extra_flags, sizeof(int32));
+	COMP_LEGACY_CRC32(crc, kern_source, strlen(kern_source));
+	FIN_LEGACY_CRC32(crc);
+
+	return crc;
+}
+
+/*
+ * cuda_program_with_devlib
+ *
+ * It checks whether the precompiled device library shall be linked,
+ * instead of the run-time compile of the library portion.
+ */
+static bool
+cuda_program_with_devlib(uint32 extra_flags)
+{
+	if (!pgstrom_enable_device_library || !cuda_devlib_available)
+		return false;
+	return ((extra_flags & DEVKERNEL_NEEDS_NUMERIC) != 0);
+}
+
 /*
  * construct_flat_cuda_source
  *
@@ -362,7 +458,8 @@ pgstrom_put_cuda_program(program_cache_entry *entry)
  */
 static char *
 construct_flat_cuda_source(const char *kern_source,
-						   const char *kern_define, uint32 extra_flags)
+						   const char *kern_define, uint32 extra_flags,
+						   bool with_devlib)
 {
 	StringInfoData		source;
 
@@ -398,6 +495,11 @@ construct_flat_cuda_source(const char *kern_source,
 	/* Per session definition if any */
 	appendStringInfoString(&source, kern_define);
 
+	/* Functions supplied by the precompiled device library */
+	if (with_devlib)
+		appendStringInfoString(&source,
+							   "#define PGSTROM_DEVICE_LIBRARY_LINKED 1\n");
+
 	/* PG-Strom CUDA device code libraries */
 
 	/* cuda dynpara.h */
@@ -459,6 +561,7 @@ construct_flat_cuda_source(const char *kern_source,
  */
 static void
 link_cuda_libraries(char *ptx_image, size_t ptx_length, cl_uint extra_flags,
+					bool with_devlib,
 					void **p_bin_image, size_t *p_bin_length)
 {
 	GpuContext	   *gcontext;
@@ -472,7 +575,7 @@ link_cuda_libraries(char *ptx_image, size_t ptx_length, cl_uint extra_flags,
 	char			pathname[MAXPGPATH];
 
 	/* at least one library has to be specified */
-	Assert((extra_flags & DEVKERNEL_NEEDS_DYNPARA) != 0);
+	Assert((extra_flags & DEVKERNEL_NEEDS_DYNPARA) != 0 || with_devlib);
 
 	/*
 	 * NOTE: cuLinkXXXX() APIs works under a particular CUDA context,
@@ -530,6 +633,16 @@ link_cuda_libraries(char *ptx_image, size_t ptx_length, cl_uint extra_flags,
 				 pathname, errorText(rc));
 	}
 
+	/* precompiled device library, if any */
+	if (with_devlib)
+	{
+		rc = cuLinkAddFile(lstate, CU_JIT_INPUT_LIBRARY, CUDA_DEVLIB_PATH,
+						   0, NULL, NULL);
+		if (rc != CUDA_SUCCESS)
+			elog(ERROR, "failed on cuLinkAddFile(\"%s\"): %s",
+				 CUDA_DEVLIB_PATH, errorText(rc));
+	}
+
 	/* do the linkage */
 	rc = cuLinkComplete(lstate, &bin_image, &bin_length);
 	if (rc != CUDA_SUCCESS)
@@ -622,17 +735,188 @@ writeout_cuda_source_file(char *cuda_source)
 const char *
 pgstrom_cuda_source_file(GpuTaskState *gts)
 {
+	bool	with_devlib = cuda_program_with_devlib(gts->extra_flags);
 	char   *cuda_source = construct_flat_cuda_source(gts->kern_source,
 													 gts->kern_define,
-													 gts->extra_flags);
+													 gts->extra_flags,
+													 with_devlib);
 	return writeout_cuda_source_file(cuda_source);
 }
 
+/*
+ * program_cache_filename
+ *
+ * It makes a pathname of the persistent program binary file. The key
+ * is a hash of the flat source (that already contains extra_flags and
+ * every device code libraries), device capability and the build-id of
+ * PG-Strom itself.
+ */
+static void
+program_cache_filename(char *pathname, const char *source,
+					   const program_file_header *phead)
+{
+	pg_crc32	crc_source;
+	pg_crc32	crc_build;
+
+	INIT_LEGACY_CRC32(crc_source);
+	COMP_LEGACY_CRC32(crc_source, source, phead->source_len);
+	FIN_LEGACY_CRC32(crc_source);
+
+	INIT_LEGACY_CRC32(crc_build);
+	COMP_LEGACY_CRC32(crc_build, phead, offsetof(program_file_header,
+												 source_len));
+	FIN_LEGACY_CRC32(crc_build);
+
+	snprintf(pathname, MAXPGPATH, "%s/pgstrom_%08x%08x.gpubin",
+			 pgstrom_program_cache_dir, crc_source, crc_build);
+}
+
+static void
+program_cache_setup_header(program_file_header *phead,
+						   const char *source, int extra_flags)
+{
+	memset(phead, 0, sizeof(program_file_header));
+	phead->magic = PGCACHE_FILE_MAGIC;
+	phead->pgstrom_version = PGSTROM_VERSION_NUM;
+	phead->cuda_version = CUDA_VERSION;
+	phead->extra_flags = extra_flags;
+	phead->capability = pgstrom_baseline_cuda_capability();
+	phead->source_len = strlen(source);
+	phead->bin_length = 0;
+}
+
+/*
+ * load_cuda_program_file
+ *
+ * It tries to load a binary image already built from the persistent
+ * program cache. Any troubles are not an error; caller will build the
+ * program by itself, if false is returned.
+ */
+static bool
+load_cuda_program_file(const char *source, int extra_flags,
+					   void **p_bin_image, size_t *p_bin_length,
+					   char **p_pathname)
+{
+	program_file_header	fhead;
+	program_file_header	phead;
+	char		pathname[MAXPGPATH];
+	char	   *buffer = NULL;
+	char	   *bin_image = NULL;
+	int			fdesc;
+
+	if (!pgstrom_program_cache_dir || pgstrom_program_cache_dir[0] == '\0')
+		return false;
+
+	program_cache_setup_header(&phead, source, extra_flags);
+	program_cache_filename(pathname, source, &phead);
+
+	fdesc = OpenTransientFile(pathname, O_RDONLY | PG_BINARY, 0);
+	if (fdesc < 0)
+	{
+		if (errno != ENOENT)
+			elog(LOG, "could not open file \"%s\": %m", pathname);
+		return false;
+	}
+
+	if (read(fdesc, &fhead, sizeof(fhead)) != sizeof(fhead) ||
+		memcmp(&fhead, &phead, offsetof(program_file_header,
+										bin_length)) != 0 ||
+		fhead.bin_length == 0)
+		goto out;
+
+	buffer = palloc(phead.source_len);
+	if (read(fdesc, buffer, phead.source_len) != phead.source_len ||
+		memcmp(buffer, source, phead.source_len) != 0)
+		goto out;
+
+	bin_image = palloc(fhead.bin_length);
+	if (read(fdesc, bin_image, fhead.bin_length) != fhead.bin_length)
+	{
+		pfree(bin_image);
+		bin_image = NULL;
+		goto out;
+	}
+	*p_bin_image = bin_image;
+	*p_bin_length = fhead.bin_length;
+	*p_pathname = pstrdup(pathname);
+out:
+	if (buffer)
+		pfree(buffer);
+	CloseTransientFile(fdesc);
+
+	return (bin_image != NULL);
+}
+
+/*
+ * save_cuda_program_file
+ *
+ * It writes out the binary image to the persistent program cache. The
+ * file is once written to a temporary file, then renamed, so concurrent
+ * readers never see a partial image.
+ */
+static void
+save_cuda_program_file(const char *source, int extra_flags,
+					   void *bin_image, size_t bin_length)
+{
+	program_file_header	phead;
+	char		pathname[MAXPGPATH];
+	char		tempname[MAXPGPATH];
+	int			fdesc;
+
+	if (!pgstrom_program_cache_dir || pgstrom_program_cache_dir[0] == '\0')
+		return;
+
+	program_cache_setup_header(&phead, source, extra_flags);
+	phead.bin_length = bin_length;
+	program_cache_filename(pathname, source, &phead);
+	snprintf(tempname, sizeof(tempname), "%s.%d.tmp", pathname, MyProcPid);
+
+	fdesc = OpenTransientFile(tempname,
+							  O_WRONLY | O_CREAT | O_TRUNC | PG_BINARY,
+							  S_IRUSR | S_IWUSR);
+	if (fdesc < 0 && errno == ENOENT)
+	{
+		/*
+		 * Cache directory might not be created yet. Error on mkdir is
+		 * not checked here; concurrent backend might create it.
+		 */
+		mkdir(pgstrom_program_cache_dir, S_IRWXU);
+		fdesc = OpenTransientFile(tempname,
+								  O_WRONLY | O_CREAT | O_TRUNC | PG_BINARY,
+								  S_IRUSR | S_IWUSR);
+	}
+	if (fdesc < 0)
+	{
+		elog(LOG, "could not create file \"%s\": %m", tempname);
+		return;
+	}
+
+	if (write(fdesc, &phead, sizeof(phead)) != sizeof(phead) ||
+		write(fdesc, source, phead.source_len) != phead.source_len ||
+		write(fdesc, bin_image, bin_length) != bin_length ||
+		pg_fsync(fdesc) != 0)
+	{
+		elog(LOG, "could not write file \"%s\": %m", tempname);
+		CloseTransientFile(fdesc);
+		unlink(tempname);
+		return;
+	}
+	CloseTransientFile(fdesc);
+
+	if (rename(tempname, pathname) != 0)
+	{
+		elog(LOG, "could not rename file \"%s\" to \"%s\": %m",
+			 tempname, pathname);
+		unlink(tempname);
+	}
+}
+
 static void
 __build_cuda_program(program_cache_entry *old_entry)
 {
 	char		   *source;
 	const char	   *source_pathname = NULL;
+	char		   *cache_pathname = NULL;
 	nvrtcProgram	program;
 	nvrtcResult		rc;
 	const char	   *options[10];
@@ -646,13 +930,32 @@ __build_cuda_program(program_cache_entry *old_entry)
 	int				hindex;
 	bool			build_failure = false;
 	program_cache_entry *new_entry;
+	bool			with_devlib;
+	struct timeval	tv1, tv2;
 
 	/*
 	 * Make a nvrtcProgram object
 	 */
+	with_devlib = cuda_program_with_devlib(old_entry->extra_flags);
 	source = construct_flat_cuda_source(old_entry->kern_source,
 										old_entry->kern_define,
-										old_entry->extra_flags);
+										old_entry->extra_flags,
+										with_devlib);
+
+	/*
+	 * Try to load the binary image already built, from the persistent
+	 * program cache, if any.
+	 */
+	if (load_cuda_program_file(source, old_entry->extra_flags,
+							   &bin_image, &bin_length,
+							   &cache_pathname))
+	{
+		build_log = psprintf("loaded from %s\n", cache_pathname);
+		pgstrom_gpustat_program_build(true, false, 0.0);
+		goto setup_entry;
+	}
+
+	gettimeofday(&tv1, NULL);
 	rc = nvrtcCreateProgram(&program,
 							source,
 							"pg_strom",
@@ -676,7 +979,7 @@ __build_cuda_program(program_cache_entry *old_entry)
 #endif
 	options[opt_index++] = "--use_fast_math";
 	/* library linkage needs relocatable PTX */
-	if (old_entry->extra_flags & DEVKERNEL_NEEDS_DYNPARA)
+	if ((old_entry->extra_flags & DEVKERNEL_NEEDS_DYNPARA) || with_devlib)
 		options[opt_index++] = "--relocatable-device-code=true";
 
 	/*
@@ -726,10 +1029,11 @@ __build_cuda_program(program_cache_entry *old_entry)
 		/*
 		 * Link the required run-time libraries, if any
 		 */
-		if (old_entry->extra_flags & DEVKERNEL_NEEDS_DYNPARA)
+		if ((old_entry->extra_flags & DEVKERNEL_NEEDS_DYNPARA) || with_devlib)
 		{
 			link_cuda_libraries(ptx_image, ptx_length,
 								old_entry->extra_flags,
+								with_devlib,
 								&bin_image, &bin_length);
 			pfree(ptx_image);
 		}
@@ -755,9 +1059,21 @@ __build_cuda_program(program_cache_entry *old_entry)
 			 nvrtcGetErrorString(rc));
 	build_log[length] = '\0';	/* may not be necessary? */
 
+	gettimeofday(&tv2, NULL);
+	pgstrom_gpustat_program_build(false, build_failure,
+								  1000.0 * PFMON_TIMEVAL_DIFF(&tv1, &tv2));
+
+	/*
+	 * Save the binary image to the persistent program cache
+	 */
+	if (!build_failure)
+		save_cuda_program_file(source, old_entry->extra_flags,
+							   bin_image, bin_length);
+
 	/*
 	 * Make a new entry, instead of the old one
 	 */
+setup_entry:
 	required = MAXALIGN(strlen(old_entry->kern_source) + 1);
 	required += MAXALIGN(strlen(old_entry->kern_define) + 1);
 	if (bin_image)
@@ -936,13 +1252,11 @@ __pgstrom_load_cuda_program(GpuContext *gcontext,
 	CUresult		rc;
 	CUmodule	   *cuda_modules = NULL;
 	int				i, num_context;
+	bool			cache_miss = false;
 	BackgroundWorker worker;
 
 	/* makes a hash value */
-	INIT_LEGACY_CRC32(crc);
-	COMP_LEGACY_CRC32(crc, &extra_flags, sizeof(int32));
-	COMP_LEGACY_CRC32(crc, kern_source, kern_source_len);
-	FIN_LEGACY_CRC32(crc);
+	crc = cuda_program_crc(extra_flags, kern_source);
 
 retry:
 	hindex = crc % PGCACHE_HASH_SIZE;
@@ -985,6 +1299,14 @@ retry:
 				return NULL;
 			}
 			/* OK, this kernel is already built */
+			if (!gcontext)
+			{
+				/* prewarm only, no need to load the module */
+				SpinLockRelease(&pgcache_head->lock);
+				if (!cache_miss)
+					pgstrom_gpustat_program_cache(true);
+				return NULL;
+			}
 			Assert(entry->refcnt > 0);
 			entry->refcnt++;
 
@@ -992,6 +1314,9 @@ retry:
 				*tv_build_end = entry->tv_build_end;
 
 			SpinLockRelease(&pgcache_head->lock);
+			/* gpuStatBoard->lock shall not be nested */
+			if (!cache_miss)
+				pgstrom_gpustat_program_cache(true);
 
 			/*
 			 * Let's load this module for each context
@@ -1104,6 +1429,7 @@ retry:
 		if (RegisterDynamicBackgroundWorker(&worker, NULL))
 		{
 			SpinLockRelease(&pgcache_head->lock);
+			pgstrom_gpustat_program_cache(false);
 			return NULL;	/* now bgworker building the device kernel */
 		}
 		else if (is_preload)
@@ -1130,8 +1456,10 @@ retry:
 		elog(LOG, "failed to launch async NVRTC build, try sync mode");
 	}
 	SpinLockRelease(&pgcache_head->lock);
+	pgstrom_gpustat_program_cache(false);
 	/* build the device kernel synchronously */
 	pgstrom_build_cuda_program(entry);
+	cache_miss = true;
 	goto retry;
 }
 
@@ -1152,11 +1480,211 @@ pgstrom_load_cuda_program(GpuTaskState *gts, bool is_preload)
 	if (cuda_modules)
 	{
 		gts->cuda_modules = cuda_modules;
+		gts->program_crc = cuda_program_crc(gts->extra_flags,
+											gts->kern_source);
 		return true;
 	}
 	return false;
 }
 
+/*
+ * lookup_program_tuning
+ *
+ * It looks up the autotuner slot of the kernel function on the program
+ * cache entry; a new slot is assigned if 'create'. Results are just hints,
+ * so we don't care about hash collision of the program.
+ *
+ * NOTE: caller must hold pgcache_head->lock
+ */
+static program_tuning *
+lookup_program_tuning(GpuTaskState *gts, cl_uint kern_hash,
+					  cl_uint cuda_index, bool create)
+{
+	int			hindex = gts->program_crc % PGCACHE_HASH_SIZE;
+	dlist_iter	iter;
+	int			i;
+
+	dlist_foreach (iter, &pgcache_head->active_list[hindex])
+	{
+		program_cache_entry *entry
+			= dlist_container(program_cache_entry, hash_chain, iter.cur);
+		program_tuning *ptune = NULL;
+
+		if (entry->crc != gts->program_crc ||
+			entry->extra_flags != gts->extra_flags ||
+			!entry->bin_image ||
+			entry->bin_image == CUDA_PROGRAM_BUILD_FAILURE)
+			continue;
+
+		for (i=0; i < PGCACHE_TUNING_NSLOTS; i++)
+		{
+			if (entry->tuning[i].kern_hash == kern_hash &&
+				entry->tuning[i].cuda_index == cuda_index)
+				return &entry->tuning[i];
+			if (!ptune && entry->tuning[i].kern_hash == 0)
+				ptune = &entry->tuning[i];
+		}
+		if (!create || !ptune)
+			return NULL;
+		memset(ptune, 0, sizeof(program_tuning));
+		ptune->kern_hash = kern_hash;
+		ptune->cuda_index = cuda_index;
+		return ptune;
+	}
+	return NULL;
+}
+
+static cl_uint
+program_tuning_hash(const char *kern_name)
+{
+	cl_uint		kern_hash;
+
+	kern_hash = DatumGetUInt32(hash_any((const unsigned char *) kern_name,
+										strlen(kern_name)));
+	return (kern_hash != 0 ? kern_hash : 1);	/* 0 means unused slot */
+}
+
+/*
+ * pgstrom_tuning_begin
+ *
+ * It determines the block size shift for the kernel launch. If the best
+ * one is not determined yet, this launch is measured as a trial of the
+ * next candidate. Caller has to adjust the block size according to the
+ * tune->block_shift, then call pgstrom_tuning_end() just after the launch
+ * and pgstrom_tuning_feedback() on the task completion.
+ */
+void
+pgstrom_tuning_begin(GpuTask *gtask, GpuTaskTuning *tune,
+					 const char *kern_name, size_t nitems)
+{
+	GpuTaskState   *gts = gtask->gts;
+	program_tuning *ptune;
+	CUresult		rc;
+
+	pgstrom_tuning_cleanup(tune);
+	tune->block_shift = 0;
+	tune->nitems = nitems;
+	if (!pgstrom_enable_kernel_autotune || gts->program_crc == 0)
+		return;
+
+	SpinLockAcquire(&pgcache_head->lock);
+	ptune = lookup_program_tuning(gts, program_tuning_hash(kern_name),
+								  gtask->cuda_index, true);
+	if (ptune)
+	{
+		if (ptune->decided)
+			tune->block_shift = ptune->best_shift;
+		else if (nitems >= PGCACHE_TUNING_MIN_NITEMS)
+		{
+			/* small chunks are not a reliable measurement */
+			tune->block_shift = (ptune->next_trial++ %
+								 PGCACHE_TUNING_NSHIFTS);
+			tune->under_trial = true;
+		}
+	}
+	SpinLockRelease(&pgcache_head->lock);
+
+	if (tune->under_trial)
+	{
+		rc = cuEventCreate(&tune->ev_start, CU_EVENT_DEFAULT);
+		if (rc != CUDA_SUCCESS)
+			elog(ERROR, "failed on cuEventCreate: %s", errorText(rc));
+		rc = cuEventCreate(&tune->ev_stop, CU_EVENT_DEFAULT);
+		if (rc != CUDA_SUCCESS)
+			elog(ERROR, "failed on cuEventCreate: %s", errorText(rc));
+		rc = cuEventRecord(tune->ev_start, gtask->cuda_stream);
+		if (rc != CUDA_SUCCESS)
+			elog(ERROR, "failed on cuEventRecord: %s", errorText(rc));
+	}
+}
+
+void
+pgstrom_tuning_end(GpuTask *gtask, GpuTaskTuning *tune)
+{
+	CUresult	rc;
+
+	if (!tune->under_trial)
+		return;
+	rc = cuEventRecord(tune->ev_stop, gtask->cuda_stream);
+	if (rc != CUDA_SUCCESS)
+		elog(ERROR, "failed on cuEventRecord: %s", errorText(rc));
+}
+
+/*
+ * pgstrom_tuning_feedback
+ *
+ * It records the elapsed time of the trial launch, then determines the
+ * best block size shift once all the candidates are measured enough.
+ * Caller has to ensure the task is successfully completed.
+ */
+void
+pgstrom_tuning_feedback(GpuTask *gtask, GpuTaskTuning *tune,
+						const char *kern_name)
+{
+	GpuTaskState   *gts = gtask->gts;
+	program_tuning *ptune;
+	float			elapsed;
+	cl_uint			shift;
+	int				i;
+	CUresult		rc;
+
+	if (!tune->under_trial)
+		return;
+	rc = cuEventElapsedTime(&elapsed, tune->ev_start, tune->ev_stop);
+	if (rc != CUDA_SUCCESS)
+	{
+		elog(DEBUG1, "failed on cuEventElapsedTime: %s", errorText(rc));
+		goto out;
+	}
+	shift = tune->block_shift;
+	Assert(shift < PGCACHE_TUNING_NSHIFTS);
+
+	SpinLockAcquire(&pgcache_head->lock);
+	ptune = lookup_program_tuning(gts, program_tuning_hash(kern_name),
+								  gtask->cuda_index, false);
+	if (ptune && !ptune->decided)
+	{
+		ptune->num_trials[shift]++;
+		ptune->elapsed[shift] += (double) elapsed;
+		ptune->nitems[shift] += tune->nitems;
+
+		for (i=0; i < PGCACHE_TUNING_NSHIFTS; i++)
+		{
+			if (ptune->num_trials[i] < PGCACHE_TUNING_NTRIALS)
+				break;
+		}
+		if (i == PGCACHE_TUNING_NSHIFTS)
+		{
+			double	best_score = -1.0;
+
+			for (i=0; i < PGCACHE_TUNING_NSHIFTS; i++)
+			{
+				double	score = (ptune->elapsed[i] /
+								 (double) Max(ptune->nitems[i], 1));
+				if (best_score < 0.0 || score < best_score)
+				{
+					best_score = score;
+					ptune->best_shift = i;
+				}
+			}
+			ptune->decided = true;
+			elog(DEBUG1, "autotuner: %s on GPU%u, block size shift=%u",
+				 kern_name, gtask->cuda_index, ptune->best_shift);
+		}
+	}
+	SpinLockRelease(&pgcache_head->lock);
+out:
+	pgstrom_tuning_cleanup(tune);
+}
+
+void
+pgstrom_tuning_cleanup(GpuTaskTuning *tune)
+{
+	CUDA_EVENT_DESTROY(tune, ev_start);
+	CUDA_EVENT_DESTROY(tune, ev_stop);
+	tune->under_trial = false;
+}
+
 /*
  * plcuda_load_cuda_program
  *
@@ -1182,15 +1710,19 @@ plcuda_load_cuda_program(GpuContext *gcontext,
  * construct_kern_parambuf
  *
  * It construct a kernel parameter buffer to deliver Const/Param nodes.
+ * Transition table of the session timezone is also delivered here, if
+ * the kernel needs cuda_timelib.h.
  */
 static kern_parambuf *
-construct_kern_parambuf(List *used_params, ExprContext *econtext)
+construct_kern_parambuf(List *used_params, ExprContext *econtext,
+						cl_uint extra_flags)
 {
 	StringInfoData	str;
 	kern_parambuf  *kparams;
 	char		padding[STROMALIGN_LEN];
 	ListCell   *cell;
 	Size		offset;
+	Size		session_tz_offset = 0;
 	int			index = 0;
 	int			nparams = list_length(used_params);
 
@@ -1311,10 +1843,22 @@ construct_kern_parambuf(List *used_params, ExprContext *econtext)
 								   STROMALIGN(str.len) - str.len);
 		index++;
 	}
+
+	/* transition table of the session timezone */
+	if ((extra_flags & DEVKERNEL_NEEDS_TIMELIB) != 0)
+	{
+		Size	tz_length = assign_timelib_session_tz(NULL);
+
+		enlargeStringInfo(&str, tz_length);
+		assign_timelib_session_tz((kern_session_tz *)(str.data + str.len));
+		session_tz_offset = str.len;
+		str.len += tz_length;
+	}
 	Assert(STROMALIGN(str.len) == str.len);
 	kparams = (kern_parambuf *)str.data;
 	kparams->hostptr = (hostptr_t) &kparams->hostptr;
 	kparams->xactStartTimestamp = GetCurrentTransactionStartTimestamp();
+	kparams->session_tz_offset = session_tz_offset;
 	kparams->length = str.len;
 	kparams->nparams = nparams;
 
@@ -1334,8 +1878,7 @@ pgstrom_build_session_info(GpuTaskState *gts,
 {
 	StringInfoData	buf;
 
-	if ((extra_flags & (DEVKERNEL_NEEDS_TIMELIB |
-						DEVKERNEL_NEEDS_MONEY   |
+	if ((extra_flags & (DEVKERNEL_NEEDS_MONEY   |
 						DEVKERNEL_NEEDS_TEXTLIB |
 						DEVKERNEL_NEEDS_GPUSCAN |
 						DEVKERNEL_NEEDS_GPUJOIN |
@@ -1347,9 +1890,6 @@ pgstrom_build_session_info(GpuTaskState *gts,
 										  DEVKERNEL_NEEDS_GPUSORT)) == 0);
 	initStringInfo(&buf);
 
-	/* put timezone info */
-	if ((extra_flags & DEVKERNEL_NEEDS_TIMELIB) != 0)
-		assign_timelib_session_info(&buf);
 	/* put currency info */
 	if ((extra_flags & DEVKERNEL_NEEDS_MONEY) != 0)
 		assign_moneylib_session_info(&buf);
@@ -1387,12 +1927,568 @@ pgstrom_assign_cuda_program(GpuTaskState *gts,
 	const char	   *kern_define
 		= pgstrom_build_session_info(gts, kern_source, extra_flags);
 
-	gts->kern_params = construct_kern_parambuf(used_params, econtext);
+	gts->kern_params = construct_kern_parambuf(used_params, econtext,
+											   extra_flags);
 	gts->kern_source = kern_source;
 	gts->kern_define = kern_define;
 	gts->extra_flags = extra_flags;
 }
 
+/* ----------------------------------------------------------------
+ *
+ * Prewarm of the program cache
+ *
+ * The program cache is volatile, so a fresh server (e.g, standby server
+ * just promoted) has to build every CUDA program on the first execution
+ * of the queries. pgstrom_program_prewarm_save() dumps the kernel sources
+ * of the ready programs to pg_strom.program_prewarm_file, then a background
+ * worker replays them at the server startup (or by explicit invocation of
+ * pgstrom_program_prewarm_load()). Individual program can be also loaded
+ * using pgstrom_program_prewarm(), with the attributes captured from the
+ * pgstrom_program_info().
+ * In addition, PREPARE statement kicks the build of the CUDA programs of
+ * the generic plan, if pg_strom.program_prewarm_on_prepare is enabled.
+ *
+ * ----------------------------------------------------------------
+ */
+#define PGCACHE_PREWARM_MAGIC		0x50475357		/* 'PGSW' */
+
+typedef struct
+{
+	cl_uint		magic;
+	cl_uint		pgstrom_version;/* PGSTROM_VERSION_NUM */
+	cl_uint		nitems;			/* number of the programs */
+} program_prewarm_header;
+
+typedef struct
+{
+	cl_int		extra_flags;
+	cl_uint		define_len;		/* length of kern_define */
+	cl_uint		source_len;		/* length of kern_source */
+	/* kern_define and kern_source follow */
+} program_prewarm_item;
+
+typedef struct
+{
+	cl_int		extra_flags;
+	char	   *kern_define;
+	char	   *kern_source;
+} program_prewarm_entry;
+
+/*
+ * prewarm_program_cache
+ *
+ * It ensures the program cache entry of the supplied kernel source. If
+ * with_async_build, the build is kicked on a background worker, elsewhere
+ * the caller builds it by itself.
+ */
+static inline void
+prewarm_program_cache(cl_uint extra_flags,
+					  const char *kern_source,
+					  const char *kern_define,
+					  bool with_async_build)
+{
+	__pgstrom_load_cuda_program(NULL,
+								extra_flags,
+								kern_source,
+								kern_define,
+								true,
+								with_async_build,
+								NULL, NULL);
+}
+
+static List *
+__collect_prewarm_entries(void)
+{
+	program_cache_entry *entry = pgcache_head->entry_begin;
+	List	   *results = NIL;
+
+	while (entry < pgcache_head->entry_end)
+	{
+		if (PGCACHE_ACTIVE_ENTRY(entry) &&
+			entry->bin_image != NULL &&
+			entry->bin_image != CUDA_PROGRAM_BUILD_FAILURE)
+		{
+			program_prewarm_entry *pwent
+				= palloc(sizeof(program_prewarm_entry));
+
+			pwent->extra_flags = entry->extra_flags;
+			pwent->kern_define = pstrdup(entry->kern_define);
+			pwent->kern_source = pstrdup(entry->kern_source);
+			results = lappend(results, pwent);
+		}
+		entry = (program_cache_entry *)((char *)entry + (1UL << entry->shift));
+	}
+	return results;
+}
+
+/*
+ * pgstrom_program_prewarm_save
+ *
+ * A SQL function to dump the kernel sources of the ready programs to the
+ * pg_strom.program_prewarm_file. It returns number of the programs saved.
+ */
+Datum
+pgstrom_program_prewarm_save(PG_FUNCTION_ARGS)
+{
+	program_prewarm_header phead;
+	char		tempname[MAXPGPATH];
+	List	   *pwent_list;
+	ListCell   *lc;
+	FILE	   *filp;
+
+	if (!superuser())
+		ereport(ERROR,
+				(errcode(ERRCODE_INSUFFICIENT_PRIVILEGE),
+				 errmsg("must be superuser to save the program cache")));
+	if (!pgstrom_program_prewarm_file || pgstrom_program_prewarm_file[0] == '\0')
+		ereport(ERROR,
+				(errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
+				 errmsg("pg_strom.program_prewarm_file is not set")));
+
+	SpinLockAcquire(&pgcache_head->lock);
+	PG_TRY();
+	{
+		pwent_list = __collect_prewarm_entries();
+	}
+	PG_CATCH();
+	{
+		SpinLockRelease(&pgcache_head->lock);
+		PG_RE_THROW();
+	}
+	PG_END_TRY();
+	SpinLockRelease(&pgcache_head->lock);
+
+	snprintf(tempname, sizeof(tempname), "%s.%d.tmp",
+			 pgstrom_program_prewarm_file, MyProcPid);
+	filp = AllocateFile(tempname, PG_BINARY_W);
+	if (!filp)
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				 errmsg("could not create file \"%s\": %m", tempname)));
+
+	memset(&phead, 0, sizeof(program_prewarm_header));
+	phead.magic = PGCACHE_PREWARM_MAGIC;
+	phead.pgstrom_version = PGSTROM_VERSION_NUM;
+	phead.nitems = list_length(pwent_list);
+	if (fwrite(&phead, sizeof(phead), 1, filp) != 1)
+		goto write_error;
+
+	foreach (lc, pwent_list)
+	{
+		program_prewarm_entry *pwent = lfirst(lc);
+		program_prewarm_item pitem;
+
+		pitem.extra_flags = pwent->extra_flags;
+		pitem.define_len = strlen(pwent->kern_define);
+		pitem.source_len = strlen(pwent->kern_source);
+		if (fwrite(&pitem, sizeof(pitem), 1, filp) != 1 ||
+			fwrite(pwent->kern_define, 1, pitem.define_len,
+				   filp) != pitem.define_len ||
+			fwrite(pwent->kern_source, 1, pitem.source_len,
+				   filp) != pitem.source_len)
+			goto write_error;
+	}
+	if (FreeFile(filp) != 0)
+	{
+		filp = NULL;
+		goto write_error;
+	}
+
+	if (rename(tempname, pgstrom_program_prewarm_file) != 0)
+	{
+		unlink(tempname);
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				 errmsg("could not rename file \"%s\" to \"%s\": %m",
+						tempname, pgstrom_program_prewarm_file)));
+	}
+	PG_RETURN_INT32(list_length(pwent_list));
+
+write_error:
+	if (filp)
+		FreeFile(filp);
+	unlink(tempname);
+	ereport(ERROR,
+			(errcode_for_file_access(),
+			 errmsg("could not write file \"%s\": %m", tempname)));
+	PG_RETURN_NULL();	/* be compiler quiet */
+}
+PG_FUNCTION_INFO_V1(pgstrom_program_prewarm_save);
+
+/*
+ * read_prewarm_file
+ *
+ * It reads the pg_strom.program_prewarm_file, then returns a list of
+ * program_prewarm_entry. Broken or obsolete file is not an error, but
+ * just ignored.
+ */
+static List *
+read_prewarm_file(const char *filename)
+{
+	program_prewarm_header phead;
+	program_prewarm_item pitem;
+	List	   *results = NIL;
+	FILE	   *filp;
+	cl_uint		i;
+
+	filp = AllocateFile(filename, PG_BINARY_R);
+	if (!filp)
+	{
+		if (errno != ENOENT)
+			elog(LOG, "could not open file \"%s\": %m", filename);
+		return NIL;
+	}
+
+	if (fread(&phead, sizeof(phead), 1, filp) != 1 ||
+		phead.magic != PGCACHE_PREWARM_MAGIC ||
+		phead.pgstrom_version != PGSTROM_VERSION_NUM)
+	{
+		elog(LOG, "program prewarm file \"%s\" is broken or obsolete",
+			 filename);
+		goto out;
+	}
+
+	for (i=0; i < phead.nitems; i++)
+	{
+		program_prewarm_entry *pwent;
+
+		if (fread(&pitem, sizeof(pitem), 1, filp) != 1)
+			break;
+		pwent = palloc(sizeof(program_prewarm_entry));
+		pwent->extra_flags = pitem.extra_flags;
+		pwent->kern_define = palloc(pitem.define_len + 1);
+		pwent->kern_source = palloc(pitem.source_len + 1);
+		if (fread(pwent->kern_define, 1, pitem.define_len,
+				  filp) != pitem.define_len ||
+			fread(pwent->kern_source, 1, pitem.source_len,
+				  filp) != pitem.source_len)
+			break;
+		pwent->kern_define[pitem.define_len] = '\0';
+		pwent->kern_source[pitem.source_len] = '\0';
+		results = lappend(results, pwent);
+	}
+	if (i < phead.nitems)
+		elog(LOG, "program prewarm file \"%s\" is truncated", filename);
+out:
+	FreeFile(filp);
+
+	return results;
+}
+
+/*
+ * pgstrom_program_prewarm_main
+ *
+ * Main routine of the background worker to prewarm the program cache.
+ * Programs are built one by one in this worker, not to consume background
+ * worker slots for each.
+ */
+static void
+pgstrom_program_prewarm_main(Datum main_arg)
+{
+	List	   *pwent_list;
+	ListCell   *lc;
+
+	BackgroundWorkerUnblockSignals();
+	/* Set up a memory context and resource owner. */
+	Assert(CurrentResourceOwner == NULL);
+	CurrentResourceOwner = ResourceOwnerCreate(NULL, "CUDA Program Prewarm");
+	CurrentMemoryContext = AllocSetContextCreate(TopMemoryContext,
+												 "CUDA Program Prewarm",
+												 ALLOCSET_DEFAULT_MINSIZE,
+												 ALLOCSET_DEFAULT_INITSIZE,
+												 ALLOCSET_DEFAULT_MAXSIZE);
+	/* no particular database, but shared catalogs */
+	BackgroundWorkerInitializeConnection(NULL, NULL);
+
+	if (!pgstrom_program_prewarm_file || pgstrom_program_prewarm_file[0] == '\0')
+		return;
+
+	StartTransactionCommand();
+	pwent_list = read_prewarm_file(pgstrom_program_prewarm_file);
+	foreach (lc, pwent_list)
+	{
+		program_prewarm_entry *pwent = lfirst(lc);
+
+		CHECK_FOR_INTERRUPTS();
+		prewarm_program_cache(pwent->extra_flags,
+							  pwent->kern_source,
+							  pwent->kern_define,
+							  false);
+	}
+	CommitTransactionCommand();
+
+	elog(LOG, "PG-Strom: %d CUDA programs were prewarmed from \"%s\"",
+		 list_length(pwent_list), pgstrom_program_prewarm_file);
+}
+
+static void
+setup_program_prewarm_worker(BackgroundWorker *worker)
+{
+	memset(worker, 0, sizeof(BackgroundWorker));
+	snprintf(worker->bgw_name, sizeof(worker->bgw_name),
+			 "PG-Strom program prewarm");
+	worker->bgw_flags = (BGWORKER_SHMEM_ACCESS |
+						 BGWORKER_BACKEND_DATABASE_CONNECTION);
+	worker->bgw_start_time = BgWorkerStart_ConsistentState;
+	worker->bgw_restart_time = BGW_NEVER_RESTART;
+	worker->bgw_main = pgstrom_program_prewarm_main;
+	worker->bgw_main_arg = (Datum) 0;
+}
+
+/*
+ * pgstrom_program_prewarm_load
+ *
+ * A SQL function to replay the pg_strom.program_prewarm_file on the
+ * background worker.
+ */
+Datum
+pgstrom_program_prewarm_load(PG_FUNCTION_ARGS)
+{
+	BackgroundWorker worker;
+
+	if (!superuser())
+		ereport(ERROR,
+				(errcode(ERRCODE_INSUFFICIENT_PRIVILEGE),
+				 errmsg("must be superuser to prewarm the program cache")));
+	if (!pgstrom_program_prewarm_file || pgstrom_program_prewarm_file[0] == '\0')
+		ereport(ERROR,
+				(errcode(ERRCODE_OBJECT_NOT_IN_PREREQUISITE_STATE),
+				 errmsg("pg_strom.program_prewarm_file is not set")));
+
+	setup_program_prewarm_worker(&worker);
+	if (!RegisterDynamicBackgroundWorker(&worker, NULL))
+		ereport(ERROR,
+				(errcode(ERRCODE_INSUFFICIENT_RESOURCES),
+				 errmsg("could not register background process"),
+				 errhint("You may need to increase max_worker_processes.")));
+	PG_RETURN_VOID();
+}
+PG_FUNCTION_INFO_V1(pgstrom_program_prewarm_load);
+
+/*
+ * pgstrom_program_prewarm
+ *
+ * A SQL function to kick the build of a particular program, if not cached.
+ * Arguments are flags, kern_define and kern_source of pgstrom_program_info.
+ */
+Datum
+pgstrom_program_prewarm(PG_FUNCTION_ARGS)
+{
+	int32		extra_flags = PG_GETARG_INT32(0);
+	char	   *kern_define = text_to_cstring(PG_GETARG_TEXT_PP(1));
+	char	   *kern_source = text_to_cstring(PG_GETARG_TEXT_PP(2));
+
+	if (!superuser())
+		ereport(ERROR,
+				(errcode(ERRCODE_INSUFFICIENT_PRIVILEGE),
+				 errmsg("must be superuser to prewarm the program cache")));
+
+	prewarm_program_cache(extra_flags, kern_source, kern_define, true);
+
+	PG_RETURN_VOID();
+}
+PG_FUNCTION_INFO_V1(pgstrom_program_prewarm);
+
+/*
+ * prewarm_plan_has_gpu_nodes
+ *
+ * It checks whether the plan tree contains any PG-Strom node.
+ */
+static bool
+prewarm_plan_has_gpu_nodes(Plan *plan)
+{
+	ListCell   *lc;
+
+	if (!plan)
+		return false;
+
+	switch (nodeTag(plan))
+	{
+		case T_CustomScan:
+			if (pgstrom_plan_is_gpuscan(plan) ||
+				pgstrom_plan_is_gpujoin(plan) ||
+				pgstrom_plan_is_gpupreagg(plan) ||
+				pgstrom_plan_is_gpusort(plan))
+				return true;
+			foreach (lc, ((CustomScan *) plan)->custom_plans)
+			{
+				if (prewarm_plan_has_gpu_nodes(lfirst(lc)))
+					return true;
+			}
+			break;
+		case T_ModifyTable:
+			foreach (lc, ((ModifyTable *) plan)->plans)
+			{
+				if (prewarm_plan_has_gpu_nodes(lfirst(lc)))
+					return true;
+			}
+			break;
+		case T_Append:
+			foreach (lc, ((Append *) plan)->appendplans)
+			{
+				if (prewarm_plan_has_gpu_nodes(lfirst(lc)))
+					return true;
+			}
+			break;
+		case T_MergeAppend:
+			foreach (lc, ((MergeAppend *) plan)->mergeplans)
+			{
+				if (prewarm_plan_has_gpu_nodes(lfirst(lc)))
+					return true;
+			}
+			break;
+		case T_SubqueryScan:
+			if (prewarm_plan_has_gpu_nodes(((SubqueryScan *) plan)->subplan))
+				return true;
+			break;
+		default:
+			break;
+	}
+	return (prewarm_plan_has_gpu_nodes(plan->lefttree) ||
+			prewarm_plan_has_gpu_nodes(plan->righttree));
+}
+
+static bool
+prewarm_stmt_has_gpu_nodes(PlannedStmt *plannedstmt)
+{
+	ListCell   *lc;
+
+	if (!IsA(plannedstmt, PlannedStmt) ||
+		plannedstmt->utilityStmt != NULL)
+		return false;
+	if (prewarm_plan_has_gpu_nodes(plannedstmt->planTree))
+		return true;
+	foreach (lc, plannedstmt->subplans)
+	{
+		if (prewarm_plan_has_gpu_nodes(lfirst(lc)))
+			return true;
+	}
+	return false;
+}
+
+/*
+ * prewarm_prepared_statement
+ *
+ * It runs ExecutorStart with EXEC_FLAG_EXPLAIN_ONLY on the generic plan
+ * of the prepared statement, to kick the build of CUDA programs, if it
+ * contains any PG-Strom node.
+ * It is an optimization, so PREPARE must not fail by the prewarm; e.g,
+ * ExecutorStart checks the permission of the tables. So the prewarm is
+ * done in a subtransaction, and its errors are reported as DEBUG1.
+ */
+static void
+prewarm_prepared_statement(const char *stmt_name)
+{
+	PreparedStatement  *pstmt;
+	CachedPlan		   *volatile cplan = NULL;
+	MemoryContext		oldcxt = CurrentMemoryContext;
+	ResourceOwner		oldowner = CurrentResourceOwner;
+
+	pstmt = FetchPreparedStatement(stmt_name, false);
+	if (!pstmt)
+		return;
+
+	BeginInternalSubTransaction(NULL);
+	MemoryContextSwitchTo(oldcxt);
+	PG_TRY();
+	{
+		ListCell   *lc;
+		bool		has_gpu_nodes = false;
+
+		cplan = GetCachedPlan(pstmt->plansource, NULL, false);
+		foreach (lc, cplan->stmt_list)
+		{
+			if (prewarm_stmt_has_gpu_nodes(lfirst(lc)))
+				has_gpu_nodes = true;
+		}
+
+		if (has_gpu_nodes)
+		{
+			PushActiveSnapshot(GetTransactionSnapshot());
+			pgstrom_program_prewarm_in_progress = true;
+			foreach (lc, cplan->stmt_list)
+			{
+				PlannedStmt	   *plannedstmt = lfirst(lc);
+				QueryDesc	   *qdesc;
+
+				if (!prewarm_stmt_has_gpu_nodes(plannedstmt))
+					continue;
+
+				qdesc = CreateQueryDesc(plannedstmt,
+										pstmt->plansource->query_string,
+										GetActiveSnapshot(),
+										InvalidSnapshot,
+										None_Receiver,
+										NULL, 0);
+				ExecutorStart(qdesc, EXEC_FLAG_EXPLAIN_ONLY);
+				ExecutorEnd(qdesc);
+				FreeQueryDesc(qdesc);
+			}
+			pgstrom_program_prewarm_in_progress = false;
+			PopActiveSnapshot();
+		}
+		ReleaseCachedPlan(cplan, false);
+		cplan = NULL;
+
+		ReleaseCurrentSubTransaction();
+		MemoryContextSwitchTo(oldcxt);
+		CurrentResourceOwner = oldowner;
+	}
+	PG_CATCH();
+	{
+		ErrorData  *edata;
+
+		pgstrom_program_prewarm_in_progress = false;
+		MemoryContextSwitchTo(oldcxt);
+		edata = CopyErrorData();
+		FlushErrorState();
+
+		RollbackAndReleaseCurrentSubTransaction();
+		MemoryContextSwitchTo(oldcxt);
+		CurrentResourceOwner = oldowner;
+
+		/* cached plan is not tracked by the resource owner */
+		if (cplan)
+			ReleaseCachedPlan(cplan, false);
+
+		/* query cancel has to be raised as is */
+		if (edata->sqlerrcode == ERRCODE_QUERY_CANCELED)
+			ReThrowError(edata);
+
+		elog(DEBUG1, "failed on prewarm of prepared statement \"%s\": %s",
+			 stmt_name, edata->message);
+		FreeErrorData(edata);
+	}
+	PG_END_TRY();
+}
+
+/*
+ * pgstrom_process_utility
+ *
+ * ProcessUtility_hook to prewarm the program cache on PREPARE
+ */
+static void
+pgstrom_process_utility(Node *parsetree,
+						const char *queryString,
+						ProcessUtilityContext context,
+						ParamListInfo params,
+						DestReceiver *dest,
+						char *completionTag)
+{
+	if (process_utility_next)
+		(*process_utility_next)(parsetree, queryString, context,
+								params, dest, completionTag);
+	else
+		standard_ProcessUtility(parsetree, queryString, context,
+								params, dest, completionTag);
+
+	if (pgstrom_enabled &&
+		pgstrom_program_prewarm_on_prepare &&
+		IsA(parsetree, PrepareStmt))
+		prewarm_prepared_statement(((PrepareStmt *) parsetree)->name);
+}
+
 /*
  * pgstrom_program_info
  *
@@ -1653,6 +2749,7 @@ void
 pgstrom_init_cuda_program(void)
 {
 	static int	__program_cache_size;
+	struct stat	stbuf;
 	int			major;
 	int			minor;
 	nvrtcResult	rc;
@@ -1672,6 +2769,67 @@ pgstrom_init_cuda_program(void)
 							NULL, NULL, NULL);
 	program_cache_size = (Size)__program_cache_size * 1024L;
 
+	/*
+	 * directory of the persistent program cache
+	 */
+	DefineCustomStringVariable("pg_strom.program_cache_dir",
+							   "directory of the persistent program cache",
+							   NULL,
+							   &pgstrom_program_cache_dir,
+							   NULL,
+							   PGC_SIGHUP,
+							   GUC_NOT_IN_SAMPLE,
+							   NULL, NULL, NULL);
+
+	/*
+	 * turn on/off the precompiled device library
+	 */
+	DefineCustomBoolVariable("pg_strom.enable_device_library",
+							 "Enables to link the precompiled device library",
+							 NULL,
+							 &pgstrom_enable_device_library,
+							 true,
+							 PGC_SUSET,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
+	/*
+	 * turn on/off the kernel launch autotuner
+	 */
+	DefineCustomBoolVariable("pg_strom.enable_kernel_autotune",
+							 "Enables to tune block size of kernel launch",
+							 NULL,
+							 &pgstrom_enable_kernel_autotune,
+							 true,
+							 PGC_USERSET,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
+
+	/*
+	 * prewarm of the program cache
+	 */
+	DefineCustomStringVariable("pg_strom.program_prewarm_file",
+							   "file of the CUDA programs to be prewarmed",
+							   NULL,
+							   &pgstrom_program_prewarm_file,
+							   NULL,
+							   PGC_SIGHUP,
+							   GUC_NOT_IN_SAMPLE,
+							   NULL, NULL, NULL);
+	DefineCustomBoolVariable("pg_strom.program_prewarm_on_prepare",
+							 "Enables to build CUDA programs on PREPARE",
+							 NULL,
+							 &pgstrom_program_prewarm_on_prepare,
+							 true,
+							 PGC_USERSET,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
+
+	if (stat(CUDA_DEVLIB_PATH, &stbuf) == 0 && S_ISREG(stbuf.st_mode))
+		cuda_devlib_available = true;
+	else
+		elog(LOG, "precompiled device library \"%s\" is not available",
+			 CUDA_DEVLIB_PATH);
+
 	/*
 	 * turn on/off cuda coredump feature
 	 */
@@ -1707,4 +2865,17 @@ pgstrom_init_cuda_program(void)
 	RequestAddinShmemSpace(program_cache_size);
 	shmem_startup_next = shmem_startup_hook;
 	shmem_startup_hook = pgstrom_startup_cuda_program;
+
+	/* background worker to prewarm the program cache on startup */
+	if (pgstrom_program_prewarm_file && pgstrom_program_prewarm_file[0] != '\0')
+	{
+		BackgroundWorker	worker;
+
+		setup_program_prewarm_worker(&worker);
+		RegisterBackgroundWorker(&worker);
+	}
+
+	/* build CUDA programs on PREPARE */
+	process_utility_next = ProcessUtility_hook;
+	ProcessUtility_hook = pgstrom_process_utility;
 }
@@ -17,6 +17,28 @@
  */
 #ifndef CUDA_TEXTLIB_H
 #define CUDA_TEXTLIB_H
+
+/*
+ * kern_textpattern
+ *
+ * A LIKE or regular expression pattern compiled by the host code for the
+ * bit-parallel (shift-and) matching. Every position of the pattern has a
+ * bit in the masks; mask_chars[c] is a set of positions that accept the
+ * byte 'c'. It is delivered to the device as a bytea parameter.
+ */
+#define TEXTPATTERN_MAX_POSITIONS	64
+#define TEXTPATTERN_ANCHOR_HEAD		0x0001	/* match only at the head */
+#define TEXTPATTERN_ANCHOR_TAIL		0x0002	/* match only at the tail */
+
+typedef struct {
+	cl_uint		vl_len_;	/* varlena header (do not touch directly) */
+	cl_ushort	npos;		/* number of the positions */
+	cl_ushort	flags;		/* TEXTPATTERN_* flags */
+	cl_ulong	mask_opt;	/* positions that can be skipped */
+	cl_ulong	mask_rep;	/* positions that can be repeated */
+	cl_ulong	mask_chars[256];
+} kern_textpattern;
+
 #ifdef __CUDACC__
 
 /* ----------------------------------------------------------------
@@ -62,6 +84,55 @@ pg_bpchar_comp_crc32(const cl_uint *crc32_table,
 }
 #endif
 
+/*
+ * varlena_equal_bytes
+ *
+ * Equality check of two byte sequences with the same length. Unlike the
+ * comparison functions, it does not need to know which is larger, so it
+ * walks on the words if both of the pointers are aligned. Grouping keys
+ * and hash-join keys are mostly checked with equality operators, and
+ * rows that have same hash value usually have same key also, so the
+ * whole bytes have to be walked on in most cases.
+ * Note that this is an optimization of the byte comparison only; the keys
+ * are not dictionary-encoded, so hash value and width of the keys are
+ * still by the varlena bytes.
+ */
+STATIC_INLINE(cl_bool)
+varlena_equal_bytes(const cl_char *s1, const cl_char *s2, cl_int len)
+{
+	if ((((uintptr_t)s1 | (uintptr_t)s2) & (sizeof(cl_uint) - 1)) == 0)
+	{
+		while (len >= sizeof(cl_uint))
+		{
+			if (*((const cl_uint *)s1) != *((const cl_uint *)s2))
+				return false;
+			s1 += sizeof(cl_uint);
+			s2 += sizeof(cl_uint);
+			len -= sizeof(cl_uint);
+		}
+	}
+	while (len > 0)
+	{
+		if (*s1 != *s2)
+			return false;
+		s1++;
+		s2++;
+		len--;
+	}
+	return true;
+}
+
+STATIC_FUNCTION(cl_bool)
+bpchar_equal(kern_context *kcxt, varlena *arg1, varlena *arg2)
+{
+	cl_int		len1 = bpchar_truelen(arg1);
+	cl_int		len2 = bpchar_truelen(arg2);
+
+	if (len1 != len2)
+		return false;
+	return varlena_equal_bytes(VARDATA_ANY(arg1), VARDATA_ANY(arg2), len1);
+}
+
 STATIC_FUNCTION(cl_int)
 bpchar_compare(kern_context *kcxt, varlena *arg1, varlena *arg2)
 {
@@ -93,9 +164,7 @@ pgfn_bpchareq(kern_context *kcxt, pg_bpchar_t arg1, pg_bpchar_t arg2)
 
 	result.isnull = (arg1.isnull | arg2.isnull);
 	if (!result.isnull)
-		result.value = (cl_bool)(bpchar_compare(kcxt,
-												arg1.value,
-												arg2.value) == 0);
+		result.value = bpchar_equal(kcxt, arg1.value, arg2.value);
 	return result;
 }
 
@@ -106,9 +175,7 @@ pgfn_bpcharne(kern_context *kcxt, pg_bpchar_t arg1, pg_bpchar_t arg2)
 
 	result.isnull = (arg1.isnull | arg2.isnull);
 	if (!result.isnull)
-		result.value = (cl_bool)(bpchar_compare(kcxt,
-												arg1.value,
-												arg2.value) != 0);
+		result.value = !bpchar_equal(kcxt, arg1.value, arg2.value);
 	return result;
 }
 
@@ -200,6 +267,18 @@ pgfn_bpcharlen(kern_context *kcxt, pg_bpchar_t arg1)
 STROMCL_VARLENA_TYPE_TEMPLATE(text)
 #endif
 
+STATIC_FUNCTION(cl_bool)
+text_equal(kern_context *kcxt, varlena *arg1, varlena *arg2)
+{
+	cl_int		len1 = VARSIZE_ANY_EXHDR(arg1);
+	cl_int		len2 = VARSIZE_ANY_EXHDR(arg2);
+
+	/* length mismatch means not-equal, without walking on the bytes */
+	if (len1 != len2)
+		return false;
+	return varlena_equal_bytes(VARDATA_ANY(arg1), VARDATA_ANY(arg2), len1);
+}
+
 STATIC_FUNCTION(cl_int)
 text_compare(kern_context *kcxt, varlena *arg1, varlena *arg2)
 {
@@ -232,9 +311,7 @@ pgfn_texteq(kern_context *kcxt, pg_text_t arg1, pg_text_t arg2)
 
 	result.isnull = (arg1.isnull | arg2.isnull);
 	if (!result.isnull)
-		result.value = (cl_bool)(text_compare(kcxt,
-											  arg1.value,
-											  arg2.value) == 0);
+		result.value = text_equal(kcxt, arg1.value, arg2.value);
 	return result;
 }
 
@@ -245,9 +322,7 @@ pgfn_textne(kern_context *kcxt, pg_text_t arg1, pg_text_t arg2)
 
 	result.isnull = (arg1.isnull | arg2.isnull);
 	if (!result.isnull)
-		result.value = (cl_bool)(text_compare(kcxt,
-											  arg1.value,
-											  arg2.value) != 0);
+		result.value = !text_equal(kcxt, arg1.value, arg2.value);
 	return result;
 }
 
@@ -660,6 +735,101 @@ pgfn_texticnlike(kern_context *kcxt, pg_text_t arg1, pg_text_t arg2)
 #undef LIKE_FALSE
 #undef LIKE_ABORT
 
+/*
+ * Support for compiled patterns
+ *
+ * When the pattern of LIKE/ILIKE or regular expression is a constant,
+ * the host code compiles it into kern_textpattern; then we can walk on
+ * the text with no backtracking. The positions that can be skipped
+ * (like '%' or 'x?') are expanded to the epsilon closure for each step.
+ */
+STATIC_INLINE(cl_ulong)
+textpattern_closure(const kern_textpattern *tpat,
+					cl_ulong state, cl_bool head_active)
+{
+	cl_ulong	temp;
+
+	if (tpat->mask_opt != 0)
+	{
+		for (;;)
+		{
+			temp = state | (((state << 1) | (head_active ? 1UL : 0UL)) &
+							tpat->mask_opt);
+			if (temp == state)
+				break;
+			state = temp;
+		}
+	}
+	return state;
+}
+
+STATIC_FUNCTION(cl_bool)
+textpattern_match(const kern_textpattern *tpat,
+				  const cl_uchar *s, cl_uint slen)
+{
+	cl_bool		anchor_head = ((tpat->flags & TEXTPATTERN_ANCHOR_HEAD) != 0);
+	cl_bool		anchor_tail = ((tpat->flags & TEXTPATTERN_ANCHOR_TAIL) != 0);
+	cl_ulong	accept;
+	cl_ulong	state;
+	cl_ulong	chmask;
+	cl_uint		i;
+
+	/* empty pattern */
+	if (tpat->npos == 0)
+		return (!anchor_head || !anchor_tail || slen == 0);
+
+	accept = (1UL << (tpat->npos - 1));
+	state = textpattern_closure(tpat, 0UL, true);
+	if (!anchor_tail && (state & accept) != 0)
+		return true;
+
+	for (i=0; i < slen; i++)
+	{
+		chmask = tpat->mask_chars[s[i]];
+		state = ((((state << 1) | (i == 0 || !anchor_head ? 1UL : 0UL))
+				  & chmask) |
+				 (state & tpat->mask_rep & chmask));
+		state = textpattern_closure(tpat, state, !anchor_head);
+		if (!anchor_tail && (state & accept) != 0)
+			return true;
+		if (state == 0 && anchor_head)
+			return false;
+	}
+	return ((state & accept) != 0);
+}
+
+#define PGFN_TEXTPATTERN_TEMPLATE(FUNCNAME, NEGATIVE)					\
+	STATIC_FUNCTION(pg_bool_t)											\
+	pgfn_##FUNCNAME##_bitap(kern_context *kcxt,							\
+							pg_text_t arg1, pg_bytea_t arg2)			\
+	{																	\
+		pg_bool_t	result;												\
+																		\
+		result.isnull = arg1.isnull | arg2.isnull;						\
+		if (!result.isnull)												\
+		{																\
+			const kern_textpattern *tpat =								\
+				(const kern_textpattern *) arg2.value;					\
+			cl_bool		matched;										\
+																		\
+			matched = textpattern_match(tpat,							\
+								(cl_uchar *)VARDATA_ANY(arg1.value),	\
+								VARSIZE_ANY_EXHDR(arg1.value));			\
+			result.value = (NEGATIVE ? !matched : matched);				\
+		}																\
+		return result;													\
+	}
+
+PGFN_TEXTPATTERN_TEMPLATE(textlike, false)
+PGFN_TEXTPATTERN_TEMPLATE(textnlike, true)
+PGFN_TEXTPATTERN_TEMPLATE(texticlike, false)
+PGFN_TEXTPATTERN_TEMPLATE(texticnlike, true)
+PGFN_TEXTPATTERN_TEMPLATE(textregexeq, false)
+PGFN_TEXTPATTERN_TEMPLATE(textregexne, true)
+PGFN_TEXTPATTERN_TEMPLATE(texticregexeq, false)
+PGFN_TEXTPATTERN_TEMPLATE(texticregexne, true)
+#undef PGFN_TEXTPATTERN_TEMPLATE
+
 
 
 #else	/* __CUDACC__ */
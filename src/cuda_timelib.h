@@ -18,8 +18,88 @@
 #ifndef CUDA_TIMELIB_H
 #define CUDA_TIMELIB_H
 
+/*
+ * kern_session_tz
+ *
+ * Transition table of the session timezone. Host side builds it on the
+ * executor startup, then it is delivered to the device as a part of the
+ * kern_parambuf (at kparams->session_tz_offset), so GPU kernel code itself
+ * does not depend on the session timezone.
+ * Variable length arrays follow the header in order of ats[timecnt],
+ * ttis[typecnt], lsis[leapcnt] and types[timecnt].
+ */
+typedef struct
+{
+	cl_long		tt_gmtoff;		/* UTC offset in seconds */
+	cl_int		tt_isdst;		/* used to set tm_isdst */
+	cl_int		tt_abbrind;		/* abbreviation list index */
+	cl_int		tt_ttisstd;		/* TRUE if transition is std time */
+	cl_int		tt_ttisgmt;		/* TRUE if transition is UTC */
+} tz_ttinfo;
+
+typedef struct
+{
+	cl_long		ls_trans;		/* pg_time_t in original */
+	cl_long		ls_corr;		/* correction to apply */
+} tz_lsinfo;
+
+typedef struct
+{
+	cl_int		leapcnt;
+	cl_int		timecnt;
+	cl_int		typecnt;
+	cl_int		charcnt;
+	cl_int		goback;
+	cl_int		goahead;
+	cl_long		data[FLEXIBLE_ARRAY_MEMBER];
+} kern_session_tz;
+
+#define KERN_SESSION_TZ_LENGTH(leapcnt,timecnt,typecnt)		\
+	STROMALIGN(offsetof(kern_session_tz, data[(timecnt)]) +	\
+			   sizeof(tz_ttinfo) * (typecnt) +				\
+			   sizeof(tz_lsinfo) * (leapcnt) +				\
+			   sizeof(cl_uchar) * (timecnt))
+
 #ifdef __CUDACC__
 
+/*
+ * tz_state - device side reference to kern_session_tz
+ */
+typedef struct
+{
+	cl_int		leapcnt;
+	cl_int		timecnt;
+	cl_int		typecnt;
+	cl_int		charcnt;
+	cl_int		goback;
+	cl_int		goahead;
+	const cl_long	*ats;		/* pg_time_t in original */
+	const cl_uchar	*types;
+	const tz_ttinfo	*ttis;
+	const tz_lsinfo	*lsis;
+	/* GPU kernel does not use chars[] */
+} tz_state;
+
+STATIC_INLINE(void)
+session_timezone_state(kern_context *kcxt, tz_state *sp)
+{
+	kern_parambuf	   *kparams = kcxt->kparams;
+	kern_session_tz	   *ktz;
+
+	assert(kparams->session_tz_offset > 0);
+	ktz = (kern_session_tz *)((char *)kparams + kparams->session_tz_offset);
+	sp->leapcnt = ktz->leapcnt;
+	sp->timecnt = ktz->timecnt;
+	sp->typecnt = ktz->typecnt;
+	sp->charcnt = ktz->charcnt;
+	sp->goback  = ktz->goback;
+	sp->goahead = ktz->goahead;
+	sp->ats     = ktz->data;
+	sp->ttis    = (const tz_ttinfo *)(sp->ats + ktz->timecnt);
+	sp->lsis    = (const tz_lsinfo *)(sp->ttis + ktz->typecnt);
+	sp->types   = (const cl_uchar *)(sp->lsis + ktz->leapcnt);
+}
+
 /* definitions copied from date.h */
 typedef cl_int		DateADT;
 typedef cl_long		TimeADT;
@@ -1090,16 +1170,21 @@ overflow:
 
 /* simplified version; no timezone support now */
 STATIC_INLINE(cl_bool)
-timestamp2tm(Timestamp dt, int *tzp, struct pg_tm *tm, fsec_t *fsec,
+timestamp2tm(kern_context *kcxt,
+			 Timestamp dt, int *tzp, struct pg_tm *tm, fsec_t *fsec,
 			 const tz_state *sp)	/* pg_tz *attimezone in original */
 {
 	cl_long		date;	/* Timestamp in original */
 	cl_long		time;	/* Timestamp in original */
 	cl_long		utime;	/* pg_time_t in original */
+	tz_state	session_tz;
 
 	/* Use session timezone if caller asks for default */
-    if (sp == NULL)
-        sp = &session_timezone_state;
+	if (sp == NULL)
+	{
+		session_timezone_state(kcxt, &session_tz);
+		sp = &session_tz;
+	}
 
 	time = dt;
 	TMODULO(time, date, USECS_PER_DAY);
@@ -1215,7 +1300,7 @@ tm2timestamp(struct pg_tm * tm, fsec_t fsec, int *tzp, Timestamp *result)
  * date2timestamptz
  *
  * It translates pg_date_t to pg_timestamptz_t based on the session
- * timezone information (session_timezone_state)
+ * timezone information (kern_session_tz in kparams)
  */
 STATIC_FUNCTION(pg_timestamptz_t)
 date2timestamptz(kern_context *kcxt, pg_date_t arg)
@@ -1223,6 +1308,7 @@ date2timestamptz(kern_context *kcxt, pg_date_t arg)
 	pg_timestamptz_t	result;
 	struct pg_tm	tm;
 	int				tz;
+	tz_state		session_tz;
 
 	if (arg.isnull)
 	{
@@ -1245,7 +1331,8 @@ date2timestamptz(kern_context *kcxt, pg_date_t arg)
         tm.tm_hour = 0;
         tm.tm_min = 0;
         tm.tm_sec = 0;
-        tz = DetermineTimeZoneOffset(&tm, &session_timezone_state);
+        session_timezone_state(kcxt, &session_tz);
+        tz = DetermineTimeZoneOffset(&tm, &session_tz);
 
 		result.isnull = false;
 		result.value = arg.value * USECS_PER_DAY + tz * USECS_PER_SEC;
@@ -1263,7 +1350,7 @@ date2timestamptz(kern_context *kcxt, pg_date_t arg)
  * timestamp2timestamptz
  *
  * It translates pg_timestamp_t to pg_timestamptz_t based on the session
- * timezone information (session_timezone_state)
+ * timezone information (kern_session_tz in kparams)
  */
 STATIC_FUNCTION(pg_timestamptz_t)
 timestamp2timestamptz(kern_context *kcxt, pg_timestamp_t arg)
@@ -1272,6 +1359,7 @@ timestamp2timestamptz(kern_context *kcxt, pg_timestamp_t arg)
 	struct pg_tm		tm;
 	fsec_t				fsec;
 	int					tz;
+	tz_state			session_tz;
 
 	if (arg.isnull)
 	{
@@ -1282,14 +1370,15 @@ timestamp2timestamptz(kern_context *kcxt, pg_timestamp_t arg)
 		result.isnull = false;
         result.value  = arg.value;
 	}
-	else if (!timestamp2tm(arg.value, NULL, &tm, &fsec, NULL))
+	else if (!timestamp2tm(kcxt, arg.value, NULL, &tm, &fsec, NULL))
 	{
 		result.isnull = true;
 		STROM_SET_ERROR(&kcxt->e, StromError_CpuReCheck);
 	}
 	else
 	{
-        tz = DetermineTimeZoneOffset(&tm, &session_timezone_state);
+        session_timezone_state(kcxt, &session_tz);
+        tz = DetermineTimeZoneOffset(&tm, &session_tz);
 		if (!tm2timestamp(&tm, fsec, &tz, &result.value))
 		{
 			result.isnull = true;
@@ -1318,7 +1407,7 @@ GetCurrentDateTime(kern_context *kcxt, struct pg_tm * tm)
 	// TimestampTz dt = GetCurrentTransactionStartTimestamp();
 	TimestampTz dt = kcxt->kparams->xactStartTimestamp;
 
-	timestamp2tm(dt, &tz, tm, &fsec, NULL);
+	timestamp2tm(kcxt, dt, &tz, tm, &fsec, NULL);
     /* Note: don't pass NULL tzp to timestamp2tm; affects behavior */
 }
 
@@ -1425,7 +1514,7 @@ pgfn_timestamp_date(kern_context *kcxt, pg_timestamp_t arg1)
 		result.isnull = false;
 		DATE_NOEND(result.value);
 	}
-	else if (!timestamp2tm(arg1.value, NULL, &tm, &fsec, NULL))
+	else if (!timestamp2tm(kcxt, arg1.value, NULL, &tm, &fsec, NULL))
 	{
 		result.isnull = true;
 		STROM_SET_ERROR(&kcxt->e, StromError_CpuReCheck);
@@ -1462,7 +1551,7 @@ pgfn_timestamptz_date(kern_context *kcxt, pg_timestamptz_t arg1)
 		result.isnull = false;
 		DATE_NOEND(result.value);
 	}
-	else if (!timestamp2tm(arg1.value, &tz, &tm, &fsec, NULL))
+	else if (!timestamp2tm(kcxt, arg1.value, &tz, &tm, &fsec, NULL))
 	{
 		result.isnull = true;
 		STROM_SET_ERROR(&kcxt->e, StromError_CpuReCheck);
@@ -1502,7 +1591,7 @@ pgfn_timestamp_time(kern_context *kcxt, pg_timestamp_t arg1)
 		result.isnull = true;
 	else if (TIMESTAMP_NOT_FINITE(arg1.value))
 		result.isnull = true;
-	else if (!timestamp2tm(arg1.value, NULL, &tm, &fsec, NULL))
+	else if (!timestamp2tm(kcxt, arg1.value, NULL, &tm, &fsec, NULL))
 	{
 		result.isnull = true;
 		STROM_SET_ERROR(&kcxt->e, StromError_CpuReCheck);
@@ -1531,7 +1620,7 @@ pgfn_timestamptz_time(kern_context *kcxt, pg_timestamptz_t arg1)
 		result.isnull = true;
 	else if (TIMESTAMP_NOT_FINITE(arg1.value))
 		result.isnull = true;
-	else if (!timestamp2tm(arg1.value, &tz, &tm, &fsec, NULL))
+	else if (!timestamp2tm(kcxt, arg1.value, &tz, &tm, &fsec, NULL))
 	{
 		result.isnull = true;
 		STROM_SET_ERROR(&kcxt->e, StromError_CpuReCheck);
@@ -1555,6 +1644,7 @@ pgfn_time_timetz(kern_context *kcxt, pg_time_t arg1)
 	struct pg_tm	tm;
 	fsec_t			fsec;
 	int				tz;
+	tz_state		session_tz;
 
 
 	if (arg1.isnull)
@@ -1563,7 +1653,8 @@ pgfn_time_timetz(kern_context *kcxt, pg_time_t arg1)
 	{
 		GetCurrentDateTime(kcxt, &tm);
 		time2tm(arg1.value, &tm, &fsec);
-		tz = DetermineTimeZoneOffset(&tm, &session_timezone_state);
+		session_timezone_state(kcxt, &session_tz);
+		tz = DetermineTimeZoneOffset(&tm, &session_tz);
 
 		result.isnull     = false;
 		result.value.time = arg1.value;
@@ -1586,7 +1677,7 @@ pgfn_timestamptz_timetz(kern_context *kcxt, pg_timestamptz_t arg1)
 		result.isnull = true;
 	else if (TIMESTAMP_NOT_FINITE(arg1.value))
 		result.isnull = true;
-	else if (timestamp2tm(arg1.value, &tz, &tm, &fsec, NULL) != 0)
+	else if (timestamp2tm(kcxt, arg1.value, &tz, &tm, &fsec, NULL) != 0)
 	{
 		// ERRCODE_DATETIME_VALUE_OUT_OF_RANGE
 		STROM_SET_ERROR(&kcxt->e, StromError_CpuReCheck);
@@ -1673,7 +1764,7 @@ pgfn_timestamptz_timestamp(kern_context *kcxt, pg_timestamptz_t arg1)
 		result.isnull = false;
         result.value  = arg1.value;
 	}
-	else if (!timestamp2tm(arg1.value, &tz, &tm, &fsec, NULL))
+	else if (!timestamp2tm(kcxt, arg1.value, &tz, &tm, &fsec, NULL))
 	{
 		result.isnull = true;
 		STROM_SET_ERROR(&kcxt->e, StromError_CpuReCheck);
@@ -1911,7 +2002,7 @@ pgfn_timestamptz_pl_interval(kern_context *kcxt,
 			struct pg_tm tm;
 			fsec_t fsec;
 
-			if (timestamp2tm(arg1.value, NULL, &tm, &fsec, NULL) != 0)
+			if (timestamp2tm(kcxt, arg1.value, NULL, &tm, &fsec, NULL) != 0)
 			{
 				// ERRCODE_DATETIME_VALUE_OUT_OF_RANGE
 				STROM_SET_ERROR(&kcxt->e, StromError_CpuReCheck);
@@ -1950,7 +2041,7 @@ pgfn_timestamptz_pl_interval(kern_context *kcxt,
 			fsec_t fsec;
 			int julian;
 
-			if (timestamp2tm(arg1.value, NULL, &tm, &fsec, NULL) != 0)
+			if (timestamp2tm(kcxt, arg1.value, NULL, &tm, &fsec, NULL) != 0)
 			{
 				// ERRCODE_DATETIME_VALUE_OUT_OF_RANGE
 				STROM_SET_ERROR(&kcxt->e, StromError_CpuReCheck);
@@ -3338,11 +3429,11 @@ pgfn_overlaps_timestamptz(kern_context *kcxt,
 #include "pgtime.h"
 
 /*
- * assign_timelib_session_info
+ * assign_timelib_session_tz
  *
- * It constructs per-session information around cuda_timelib.h.
- * At this moment, items below has to be informed.
- * - session_timezone information
+ * It constructs the kern_session_tz of the current session timezone on
+ * the given buffer, and returns its length. If NULL is given, it returns
+ * the required length only.
  */
 
 /* copied from src/timezone/tzfile.h */
@@ -3393,153 +3484,55 @@ struct pg_tz
 	struct state	state;
 };
 
-STATIC_INLINE(void)
-assign_timelib_session_info(StringInfo buf)
+STATIC_INLINE(Size)
+assign_timelib_session_tz(kern_session_tz *ktz)
 {
-	const struct state *sp;
+	const struct state *sp = &session_timezone->state;
+	/* at least one ttinfo for the lookup of the standard type */
+	cl_int		typecnt = Max(sp->typecnt, 1);
+	cl_long	   *ats;
+	tz_ttinfo  *ttis;
+	tz_lsinfo  *lsis;
+	cl_uchar   *types;
 	int			i;
 
-	appendStringInfo(
-		buf,
-		"#ifdef __CUDACC__\n"
-		"/* ================================================\n"
-		" * session information for cuda_timelib.h\n"
-		" * ================================================ */\n");
+	if (!ktz)
+		return KERN_SESSION_TZ_LENGTH(sp->leapcnt, sp->timecnt, typecnt);
 
-	sp = &session_timezone->state;
-	/*
-	 * type declaration of tz_state structure
-	 */
-	appendStringInfo(
-		buf,
-		"typedef struct {\n"
-		"        cl_long     ls_trans; /* pg_time_t in original */ \n"
-		"        long        ls_corr;\n"
-		"} tz_lsinfo;\n"
-		"\n"
-		"typedef struct {\n"
-		"        cl_long     tt_gmtoff;\n"
-		"        cl_int      tt_isdst;\n"
-		"        cl_int      tt_abbrind;\n"
-		"        cl_int      tt_ttisstd;\n"
-		"        cl_int      tt_ttisgmt;\n"
-		"} tz_ttinfo;\n"
-		"\n"
-		"typedef struct {\n"
-		"    cl_int          leapcnt;\n"
-		"    cl_int          timecnt;\n"
-		"    cl_int          typecnt;\n"
-		"    cl_int          charcnt;\n"
-		"    cl_int          goback;\n"
-		"    cl_int          goahead;\n"
-		"    cl_long         ats[%d];\n"
-		"    cl_uchar        types[%d];\n"
-		"    tz_ttinfo       ttis[%d];\n"
-		"    /* GPU kernel does not use chars[] */\n"
-		"    tz_lsinfo       lsis[%d];\n"
-		"} tz_state;\n"
-		"\n",
-		sp->timecnt <= 0 ? 1 : sp->timecnt,
-		sp->timecnt <= 0 ? 1 : sp->timecnt,
-		sp->typecnt,
-		sp->leapcnt <= 0 ? 1 : sp->leapcnt
-		);
-	/*
-	 * initializer of session_timezone_state
-	 */
-	appendStringInfo(
-        buf,
-		"static const tz_state session_timezone_state =\n"
-		"{\n"
-		"    %d,    /* leapcnt */\n"
-		"    %d,    /* timecnt */\n"
-		"    %d,    /* typecnt */\n"
-		"    %d,    /* charcnt */\n"
-		"    %d,    /* goback */\n"
-		"    %d,    /* goahead */\n"
-		"    {      /* ats[] */\n",
-		sp->leapcnt,
-		sp->timecnt,
-		sp->typecnt,
-		sp->charcnt,
-		sp->goback,
-		sp->goahead);
-
-	if (sp->timecnt <= 0)
-		appendStringInfo(buf, "        0\n");
-	else 
-	{
-		for (i=0; i < sp->timecnt; i++)
-		{
-			appendStringInfo(
-				buf,
-				"        %ld,\n",
-				sp->ats[i]);
-		}
-	}
+	memset(ktz, 0, KERN_SESSION_TZ_LENGTH(sp->leapcnt, sp->timecnt, typecnt));
+	ktz->leapcnt = sp->leapcnt;
+	ktz->timecnt = sp->timecnt;
+	ktz->typecnt = typecnt;
+	ktz->charcnt = sp->charcnt;
+	ktz->goback  = sp->goback;
+	ktz->goahead = sp->goahead;
 
-	appendStringInfo(
-		buf,
-		"    },\n"
-		"    {    /* types[] */");
-
-	if (sp->timecnt <= 0)
-		appendStringInfo(buf, "\n        0");
-	else 
-	{
-		for (i=0; i < sp->timecnt; i++)
-		{
-			if ((i % 12) == 0)
-				appendStringInfo(buf, "\n       ");
-			appendStringInfo(buf, " %d,", sp->types[i]);
-		}
-	}
-
-	appendStringInfo(
-		buf,
-		"\n"
-		"    },\n"
-		"    {    /* ttis[] */\n");
+	ats = ktz->data;
+	for (i=0; i < sp->timecnt; i++)
+		ats[i] = sp->ats[i];
 
+	ttis = (tz_ttinfo *)(ats + sp->timecnt);
 	for (i=0; i < sp->typecnt; i++)
 	{
-		appendStringInfo(
-			buf,
-			"        { %ld, %d, %d, %d, %d },\n",
-			sp->ttis[i].tt_gmtoff,
-			sp->ttis[i].tt_isdst,
-			sp->ttis[i].tt_abbrind,
-			sp->ttis[i].tt_ttisstd,
-			sp->ttis[i].tt_ttisgmt);
+		ttis[i].tt_gmtoff  = sp->ttis[i].tt_gmtoff;
+		ttis[i].tt_isdst   = sp->ttis[i].tt_isdst;
+		ttis[i].tt_abbrind = sp->ttis[i].tt_abbrind;
+		ttis[i].tt_ttisstd = sp->ttis[i].tt_ttisstd;
+		ttis[i].tt_ttisgmt = sp->ttis[i].tt_ttisgmt;
 	}
 
-	appendStringInfo(
-		buf,
-		"    },\n"
-		"    {    /* lsis[] */\n");
-
-	if (sp->leapcnt <= 0)
-		appendStringInfo(buf, "        { 0, 0 }\n");
-	else 
+	lsis = (tz_lsinfo *)(ttis + typecnt);
+	for (i=0; i < sp->leapcnt; i++)
 	{
-		for (i=0; i < sp->leapcnt; i++)
-		{
-			appendStringInfo(
-				buf,
-				"        { %ld, %ld },\n",
-				sp->lsis[i].ls_trans,
-				sp->lsis[i].ls_corr);
-		}
+		lsis[i].ls_trans = sp->lsis[i].ls_trans;
+		lsis[i].ls_corr  = sp->lsis[i].ls_corr;
 	}
 
-	appendStringInfo(
-		buf,
-		"    },\n"
-		"};\n");
+	types = (cl_uchar *)(lsis + sp->leapcnt);
+	for (i=0; i < sp->timecnt; i++)
+		types[i] = sp->types[i];
 
-	appendStringInfo(
-		buf,
-		"#endif /* __CUDACC__ */\n");
+	return KERN_SESSION_TZ_LENGTH(sp->leapcnt, sp->timecnt, typecnt);
 }
 
 #endif	/* __CUDACC__ */
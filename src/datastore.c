@@ -17,14 +17,19 @@
  * GNU General Public License for more details.
  */
 #include "postgres.h"
+#include "access/htup_details.h"
 #include "access/relscan.h"
+#include "access/visibilitymap.h"
+#include "access/xact.h"
 #include "catalog/catalog.h"
 #include "catalog/pg_tablespace.h"
 #include "catalog/pg_type.h"
 #include "optimizer/cost.h"
+#include "storage/buf_internals.h"
 #include "storage/bufmgr.h"
 #include "storage/fd.h"
 #include "storage/predicate.h"
+#include "storage/smgr.h"
 #include "utils/builtins.h"
 #include "utils/bytea.h"
 #include "utils/guc.h"
@@ -43,6 +48,12 @@
  */
 static int		pgstrom_chunk_size_kb;
 static int		pgstrom_chunk_limit_kb = INT_MAX;
+static bool		pgstrom_enable_direct_load;
+static bool		pgstrom_debug_force_direct_load;
+static bool		pgstrom_enable_adaptive_chunk;
+static bool		pgstrom_enable_dma_compress;
+
+static Size kds_column_fixed_length(kern_data_store *kds);
 
 /*
  * pgstrom_chunk_size - configured chunk size
@@ -87,6 +98,65 @@ check_guc_chunk_limit(int *newval, void **extra, GucSource source)
 	return true;
 }
 
+/*
+ * pgstrom_adaptive_chunk_size
+ *
+ * It returns the length of the next chunk to be loaded by the GpuTaskState.
+ * Its initial value is pg_strom.chunk_size, then pgstrom_update_chunk_size()
+ * tunes it according to the run-time feedback.
+ */
+Size
+pgstrom_adaptive_chunk_size(GpuTaskState *gts)
+{
+	if (!pgstrom_enable_adaptive_chunk || gts->chunk_size_curr == 0)
+		return pgstrom_chunk_size();
+	return gts->chunk_size_curr;
+}
+
+/*
+ * pgstrom_update_chunk_size
+ *
+ * It is called on completion of each GpuTask, to tune the chunk size for
+ * the next chunk.
+ * - If result buffer overflow happened (chunk_overflow), we halve the chunk
+ *   size and never expand it over the size any more; retry of the task is
+ *   much more expensive than overhead of the task launch.
+ * - If ready tasks are waiting for the consumer, GPU is faster than CPU,
+ *   so larger chunk reduces the per-chunk overhead.
+ * - If no task is running or pending even though the scan is in progress,
+ *   the pipeline is starving; smaller chunk makes the next task earlier.
+ */
+void
+pgstrom_update_chunk_size(GpuTaskState *gts)
+{
+	Size		chunk_size = pgstrom_chunk_size();
+	Size		chunk_step = chunk_size / 8;
+	Size		chunk_min = Max(chunk_size / 8, (Size) BLCKSZ * 128);
+	Size		chunk_max = pgstrom_chunk_size_limit();
+	Size		curr;
+
+	if (!pgstrom_enable_adaptive_chunk)
+		return;
+
+	curr = (gts->chunk_size_curr > 0 ? gts->chunk_size_curr : chunk_size);
+	if (gts->chunk_overflow > 0)
+	{
+		curr /= 2;
+		gts->chunk_size_ceil = Max(curr, chunk_min);
+		gts->chunk_overflow = 0;
+	}
+	else if (gts->num_ready_tasks > 0)
+		curr += chunk_step;
+	else if (gts->num_running_tasks + gts->num_pending_tasks == 0 &&
+			 !gts->scan_done)
+		curr = (curr > chunk_step ? curr - chunk_step : chunk_min);
+
+	if (gts->chunk_size_ceil > 0)
+		chunk_max = Min(chunk_max, gts->chunk_size_ceil);
+	curr = Max(Min(curr, chunk_max), chunk_min);
+	gts->chunk_size_curr = TYPEALIGN(BLCKSZ, curr);
+}
+
 /*
  * pgstrom_bulk_exec_supported - returns true, if supplied planstate
  * supports bulk execution mode.
@@ -224,6 +294,42 @@ kern_fetch_data_store(TupleTableSlot *slot,
 		ExecStoreVirtualTuple(slot);
 		return true;
 	}
+	/* in case of KDS_FORMAT_COLUMN */
+	if (kds->format == KDS_FORMAT_COLUMN)
+	{
+		cl_uint	   *column_offset = KERN_DATA_STORE_COLUMN_OFFSET(kds);
+		int			i, natts = slot->tts_tupleDescriptor->natts;
+
+		ExecClearTuple(slot);
+		for (i=0; i < natts; i++)
+		{
+			kern_colmeta   *cmeta = &kds->colmeta[i];
+			char		   *values;
+
+			/* attributes not loaded are considered as NULL */
+			if (i >= kds->ncols || column_offset[i] == 0 ||
+				att_isnull(row_index, KERN_DATA_STORE_COLUMN_NULLMAP(kds, i)))
+			{
+				slot->tts_values[i] = (Datum) 0;
+				slot->tts_isnull[i] = true;
+				continue;
+			}
+			values = KERN_DATA_STORE_COLUMN_VALUES(kds, i);
+			if (cmeta->attlen > 0)
+				slot->tts_values[i] =
+					fetch_att(values +
+							  KDS_COLUMN_UNITSZ(cmeta->attlen,
+												cmeta->attalign) * row_index,
+							  cmeta->attbyval,
+							  cmeta->attlen);
+			else
+				slot->tts_values[i] = PointerGetDatum((char *)kds +
+										((cl_uint *)values)[row_index]);
+			slot->tts_isnull[i] = false;
+		}
+		ExecStoreVirtualTuple(slot);
+		return true;
+	}
 	elog(ERROR, "Bug? unexpected data-store format: %d", kds->format);
 	return false;
 }
@@ -490,6 +596,40 @@ PDS_shrink_size(pgstrom_data_store *pds)
 		if (kds->usage > 0)
 			elog(ERROR, "cannot shirink KDS_SLOT with extra region");
 	}
+	else if (kds->format == KDS_FORMAT_COLUMN)
+	{
+		cl_uint	   *column_offset = KERN_DATA_STORE_COLUMN_OFFSET(kds);
+		size_t		shift;
+		char	   *extra;
+		cl_uint		i, j;
+
+		shift = STROMALIGN_DOWN(kds->length -
+								(kds_column_fixed_length(kds) + kds->usage));
+		if (shift < BLCKSZ)
+			return;
+
+		/* move the extra area of variable-length values */
+		extra = (char *)kds + kds->length - kds->usage;
+		memmove(extra - shift, extra, kds->usage);
+
+		/* adjust offset of the variable-length values */
+		for (i=0; i < kds->ncols; i++)
+		{
+			cl_uchar   *nullmap;
+			cl_uint	   *values;
+
+			if (column_offset[i] == 0 || kds->colmeta[i].attlen >= 0)
+				continue;
+			nullmap = KERN_DATA_STORE_COLUMN_NULLMAP(kds, i);
+			values = (cl_uint *)KERN_DATA_STORE_COLUMN_VALUES(kds, i);
+			for (j=0; j < kds->nitems; j++)
+			{
+				if (nullmap[j / BITS_PER_BYTE] & (1 << (j % BITS_PER_BYTE)))
+					values[j] -= shift;
+			}
+		}
+		new_length = kds->length - shift;
+	}
 	else
 		elog(ERROR, "Bug? unexpected PDS to be shrinked");
 
@@ -580,11 +720,257 @@ PDS_create_hash(GpuContext *gcontext,
 	return pds;
 }
 
+/*
+ * PDS_create_column
+ *
+ * It creates a data store of column format that has arrays of the
+ * referenced attributes only. 'referenced' is a set of attribute numbers
+ * to be loaded. 'nrooms' is reduced if arrays don't fit the 'length';
+ * a half of the buffer is kept for the extra area if any variable-length
+ * column is referenced.
+ */
+pgstrom_data_store *
+PDS_create_column(GpuContext *gcontext,
+				  TupleDesc tupdesc,
+				  Bitmapset *referenced,
+				  cl_uint nrooms,
+				  Size length)
+{
+	pgstrom_data_store *pds;
+	MemoryContext	gmcxt = gcontext->memcxt;
+	kern_data_store *kds;
+	cl_uint		   *column_offset;
+	Size			head_length;
+	Size			unitsz = 0;
+	Size			limit;
+	Size			offset;
+	cl_uint			nrefs = 0;
+	bool			has_varlena = false;
+	int				i;
+
+	length = STROMALIGN_DOWN(length);
+	head_length = KDS_CALCULATE_COLUMN_HEAD_LENGTH(tupdesc->natts);
+	for (i=0; i < tupdesc->natts; i++)
+	{
+		Form_pg_attribute	attr = tupdesc->attrs[i];
+
+		if (!bms_is_member(attr->attnum, referenced))
+			continue;
+		unitsz += KDS_COLUMN_UNITSZ(attr->attlen,
+									typealign_get_width(attr->attalign));
+		if (attr->attlen < 0)
+			has_varlena = true;
+		nrefs++;
+	}
+	if (nrefs == 0)
+		elog(ERROR, "Bug? KDS-Column needs at least one referenced column");
+
+	/* compute the maximum 'nrooms' that fits the buffer */
+	if (length <= head_length + 2 * STROMALIGN_LEN * nrefs)
+		elog(ERROR, "Required length for KDS-Column is too short");
+	limit = length - head_length;
+	if (has_varlena)
+		limit /= 2;
+	limit -= 2 * STROMALIGN_LEN * nrefs;
+	nrooms = Min(nrooms, ((limit * BITS_PER_BYTE) /
+						  (unitsz * BITS_PER_BYTE + nrefs)));
+	if (nrooms < MaxHeapTuplesPerPage)
+		elog(ERROR, "Required length for KDS-Column is too short");
+
+	/* allocation of pds */
+	pds = MemoryContextAllocZero(gmcxt, sizeof(pgstrom_data_store));
+	pds->refcnt = 1;	/* owned by the caller at least */
+
+	/* allocation of kds */
+	pds->kds_length = length;
+	pds->kds = kds = MemoryContextAllocHuge(gmcxt, pds->kds_length);
+
+	init_kernel_data_store(kds, tupdesc, pds->kds_length,
+						   KDS_FORMAT_COLUMN, nrooms, false);
+
+	/* assign the arrays of referenced columns */
+	column_offset = KERN_DATA_STORE_COLUMN_OFFSET(kds);
+	offset = head_length;
+	for (i=0; i < tupdesc->natts; i++)
+	{
+		Form_pg_attribute	attr = tupdesc->attrs[i];
+
+		if (!bms_is_member(attr->attnum, referenced))
+			column_offset[i] = 0;
+		else
+		{
+			column_offset[i] = offset;
+			/* all the values are NULL at the beginning */
+			memset((char *)kds + offset, 0,
+				   KDS_COLUMN_NULLMAP_LENGTH(nrooms));
+			offset += KDS_CALCULATE_COLUMN_LENGTH(
+				attr->attlen, typealign_get_width(attr->attalign), nrooms);
+		}
+	}
+	Assert(offset <= kds->length);
+	pds->column_fixed_length = offset;
+
+	/* OK, it is now tracked by GpuContext */
+	dlist_push_tail(&gcontext->pds_list, &pds->pds_chain);
+
+	return pds;
+}
+
+/*
+ * kds_column_fixed_length - length of the portion except for extra area
+ */
+static Size
+kds_column_fixed_length(kern_data_store *kds)
+{
+	cl_uint	   *column_offset = KERN_DATA_STORE_COLUMN_OFFSET(kds);
+	Size		length = KDS_CALCULATE_COLUMN_HEAD_LENGTH(kds->ncols);
+	cl_uint		i;
+
+	for (i=0; i < kds->ncols; i++)
+	{
+		if (column_offset[i] == 0)
+			continue;
+		length = Max(length,
+					 column_offset[i] +
+					 KDS_CALCULATE_COLUMN_LENGTH(kds->colmeta[i].attlen,
+												 kds->colmeta[i].attalign,
+												 kds->nrooms));
+	}
+	return length;
+}
+
+/*
+ * kds_column_put_values
+ *
+ * It transposes a set of values/isnull to the 'rowidx'-th position of
+ * the referenced column arrays. It returns false if extra area has no
+ * space for the variable-length values, without any update of 'usage'.
+ */
+static bool
+kds_column_put_values(pgstrom_data_store *pds, cl_uint rowidx,
+					  Datum *values, bool *isnull)
+{
+	kern_data_store *kds = pds->kds;
+	cl_uint	   *column_offset = KERN_DATA_STORE_COLUMN_OFFSET(kds);
+	Size		required = 0;
+	cl_uint		i;
+
+	Assert(kds->format == KDS_FORMAT_COLUMN && rowidx < kds->nrooms);
+	for (i=0; i < kds->ncols; i++)
+	{
+		if (column_offset[i] != 0 && !isnull[i] &&
+			kds->colmeta[i].attlen < 0)
+			required += MAXALIGN(VARSIZE_ANY(DatumGetPointer(values[i])));
+	}
+	if (pds->column_fixed_length +
+		kds->usage + required > kds->length)
+		return false;
+
+	for (i=0; i < kds->ncols; i++)
+	{
+		kern_colmeta   *cmeta = &kds->colmeta[i];
+		cl_uchar	   *nullmap;
+		char		   *dest;
+
+		if (column_offset[i] == 0)
+			continue;
+		nullmap = KERN_DATA_STORE_COLUMN_NULLMAP(kds, i);
+		if (isnull[i])
+		{
+			nullmap[rowidx / BITS_PER_BYTE] &= ~(1 << (rowidx % BITS_PER_BYTE));
+			continue;
+		}
+		nullmap[rowidx / BITS_PER_BYTE] |= (1 << (rowidx % BITS_PER_BYTE));
+
+		dest = KERN_DATA_STORE_COLUMN_VALUES(kds, i);
+		if (cmeta->attlen > 0)
+		{
+			dest += KDS_COLUMN_UNITSZ(cmeta->attlen, cmeta->attalign) * rowidx;
+			if (cmeta->attbyval)
+				store_att_byval(dest, values[i], cmeta->attlen);
+			else
+				memcpy(dest, DatumGetPointer(values[i]), cmeta->attlen);
+		}
+		else
+		{
+			char   *vl_val = DatumGetPointer(values[i]);
+			Size	vl_len = VARSIZE_ANY(vl_val);
+			char   *extra;
+
+			kds->usage += MAXALIGN(vl_len);
+			extra = (char *)kds + kds->length - kds->usage;
+			memcpy(extra, vl_val, vl_len);
+			((cl_uint *)dest)[rowidx] = (cl_uint)(extra - (char *)kds);
+		}
+	}
+	return true;
+}
+
+/*
+ * PDS_direct_load_block
+ *
+ * It reads an all-visible block of the relation into 'pagebuf' from the
+ * storage directly, without shared buffers. It is worth for large and
+ * cold tables, because it avoids buffer replacement, pin and content lock
+ * on the buffer, and visibility checks of individual tuples.
+ * If the block is cached by shared buffers, buffer may be newer than the
+ * on-disk image, so caller has to read the block via shared buffers.
+ * We hold the buffer mapping partition lock across the read; nobody can
+ * load the block onto shared buffers meanwhile, thus nobody can modify
+ * and write out the block to the storage. Elsewhere, a concurrent write
+ * could give us a torn image with the old PD_ALL_VISIBLE flag.
+ * Once the image is read, modification by the concurrent backends is
+ * invisible to the snapshot of this scan, and clears PD_ALL_VISIBLE;
+ * so we can use the image as long as the flag is set.
+ */
+static bool
+PDS_direct_load_block(Relation rel, BlockNumber blknum, char *pagebuf)
+{
+	BufferTag	tag;
+	uint32		hashcode;
+	LWLock	   *partition_lock;
+	int			buf_id;
+	Buffer		vmbuffer = InvalidBuffer;
+	bool		all_visible;
+
+#if PG_VERSION_NUM < 90600
+	all_visible = visibilitymap_test(rel, blknum, &vmbuffer);
+#else
+	all_visible = VM_ALL_VISIBLE(rel, blknum, &vmbuffer);
+#endif
+	if (BufferIsValid(vmbuffer))
+		ReleaseBuffer(vmbuffer);
+	if (!all_visible)
+		return false;
+
+	RelationOpenSmgr(rel);
+	INIT_BUFFERTAG(tag, rel->rd_smgr->smgr_rnode.node, MAIN_FORKNUM, blknum);
+	hashcode = BufTableHashCode(&tag);
+	partition_lock = BufMappingPartitionLock(hashcode);
+	LWLockAcquire(partition_lock, LW_SHARED);
+	buf_id = BufTableLookup(&tag, hashcode);
+	if (buf_id >= 0)
+	{
+		LWLockRelease(partition_lock);
+		return false;
+	}
+	smgrread(rel->rd_smgr, MAIN_FORKNUM, blknum, pagebuf);
+	LWLockRelease(partition_lock);
+
+	if (PageIsNew((Page) pagebuf) ||
+		!PageIsVerified((Page) pagebuf, blknum) ||
+		!PageIsAllVisible((Page) pagebuf))
+		return false;
+
+	return true;
+}
+
 int
 PDS_insert_block(pgstrom_data_store *pds,
 				 Relation rel, BlockNumber blknum,
 				 Snapshot snapshot,
-				 BufferAccessStrategy strategy)
+				 BufferAccessStrategy strategy,
+				 GpuTaskState *gts)
 {
 	kern_data_store	*kds = pds->kds;
 	Buffer			buffer;
@@ -597,12 +983,38 @@ PDS_insert_block(pgstrom_data_store *pds,
 	kern_tupitem   *tup_item;
 	bool			all_visible;
 	Size			max_consume;
+	Size			usage_saved = kds->usage;
+	Datum		   *tup_values = gts->scan_tup_values;
+	bool		   *tup_isnull = gts->scan_tup_isnull;
 
-	/* only row-store can block read */
-	Assert(kds->format == KDS_FORMAT_ROW && kds->nslots == 0);
+	/* only row- or column-store can block read */
+	Assert((kds->format == KDS_FORMAT_ROW ||
+			kds->format == KDS_FORMAT_COLUMN) && kds->nslots == 0);
 
 	CHECK_FOR_INTERRUPTS();
 
+	/*
+	 * Direct load is applied on the scan with bulk-read strategy only,
+	 * that implies the relation is larger than shared buffers, unless
+	 * pg_strom.debug_force_direct_load is set for testing. It is not
+	 * applied on serializable transaction, because no buffer is available
+	 * for the predicate locks.
+	 */
+	if (pgstrom_enable_direct_load &&
+		gts->scan_pagebuf != NULL &&
+		(strategy != NULL || pgstrom_debug_force_direct_load) &&
+		!IsolationIsSerializable() &&
+		IsMVCCSnapshot(snapshot) &&
+		!snapshot->takenDuringRecovery)
+	{
+		if (PDS_direct_load_block(rel, blknum, gts->scan_pagebuf))
+		{
+			buffer = InvalidBuffer;
+			page = (Page) gts->scan_pagebuf;
+			goto page_loaded;
+		}
+	}
+
 	/* Load the target buffer */
 	//buffer = ReadBuffer(rel, blknum);
 	buffer = ReadBufferExtended(rel, MAIN_FORKNUM, blknum,
@@ -619,6 +1031,7 @@ PDS_insert_block(pgstrom_data_store *pds,
 	/* we will check tuple's visibility under the shared lock */
 	LockBuffer(buffer, BUFFER_LOCK_SHARE);
 	page = (Page) BufferGetPage(buffer);
+page_loaded:
 	lines = PageGetMaxOffsetNumber(page);
 	ntup = 0;
 
@@ -628,15 +1041,30 @@ PDS_insert_block(pgstrom_data_store *pds,
 	 * the items in a block, we inform the caller this block shall be
 	 * loaded on the next data store.
 	 */
-	max_consume = KDS_CALCULATE_HASH_LENGTH(kds->ncols,
-											kds->nitems + lines,
-											offsetof(kern_tupitem,
-													 htup) * lines +
-											BLCKSZ + kds->usage);
-	if (max_consume > kds->length)
+	if (kds->format == KDS_FORMAT_COLUMN)
 	{
-		UnlockReleaseBuffer(buffer);
-		return -1;
+		/* extra area shall be checked for each tuple */
+		if (kds->nitems + lines > kds->nrooms)
+		{
+			if (BufferIsValid(buffer))
+				UnlockReleaseBuffer(buffer);
+			return -1;
+		}
+		Assert(tup_values != NULL && tup_isnull != NULL);
+	}
+	else
+	{
+		max_consume = KDS_CALCULATE_HASH_LENGTH(kds->ncols,
+												kds->nitems + lines,
+												offsetof(kern_tupitem,
+														 htup) * lines +
+												BLCKSZ + kds->usage);
+		if (max_consume > kds->length)
+		{
+			if (BufferIsValid(buffer))
+				UnlockReleaseBuffer(buffer);
+			return -1;
+		}
 	}
 
 	/*
@@ -673,6 +1101,24 @@ PDS_insert_block(pgstrom_data_store *pds,
 		if (!valid)
 			continue;
 
+		/* transpose the tuple, if column format */
+		if (kds->format == KDS_FORMAT_COLUMN)
+		{
+			heap_deform_tuple(&tup, RelationGetDescr(rel),
+							  tup_values, tup_isnull);
+			if (!kds_column_put_values(pds, kds->nitems + ntup,
+									   tup_values, tup_isnull))
+			{
+				/* revert this block; to be loaded on the next chunk */
+				kds->usage = usage_saved;
+				if (BufferIsValid(buffer))
+					UnlockReleaseBuffer(buffer);
+				return -1;
+			}
+			ntup++;
+			continue;
+		}
+
 		/* put tuple */
 		kds->usage += LONGALIGN(offsetof(kern_tupitem, htup) + tup.t_len);
 		tup_item = (kern_tupitem *)((char *)kds + kds->length - kds->usage);
@@ -683,7 +1129,8 @@ PDS_insert_block(pgstrom_data_store *pds,
 
 		ntup++;
 	}
-	UnlockReleaseBuffer(buffer);
+	if (BufferIsValid(buffer))
+		UnlockReleaseBuffer(buffer);
 	Assert(ntup <= MaxHeapTuplesPerPage);
 	Assert(kds->nitems + ntup <= kds->nrooms);
 	kds->nitems += ntup;
@@ -713,6 +1160,18 @@ PDS_insert_tuple(pgstrom_data_store *pds, TupleTableSlot *slot)
 		return false;
 	Assert(kds->ncols == slot->tts_tupleDescriptor->natts);
 
+	/* column format takes the values/isnull of the slot */
+	if (kds->format == KDS_FORMAT_COLUMN)
+	{
+		slot_getallattrs(slot);
+		if (!kds_column_put_values(pds, kds->nitems,
+								   slot->tts_values,
+								   slot->tts_isnull))
+			return false;
+		kds->nitems++;
+		return true;
+	}
+
 	if (kds->format != KDS_FORMAT_ROW)
 		elog(ERROR, "Bug? unexpected data-store format: %d", kds->format);
 
@@ -785,6 +1244,7 @@ PDS_insert_hashitem(pgstrom_data_store *pds,
 	khitem->hash = hash_value;
 	khitem->next = 0x7f7f7f7f;	/* to be set later */
 	khitem->rowid = kds->nitems++;
+	khitem->heavy_base = 0;
 	khitem->t.t_len = tuple->t_len;
 	khitem->t.t_self = tuple->t_self;
 	memcpy(&khitem->t.htup, tuple->t_data, tuple->t_len);
@@ -826,6 +1286,262 @@ PDS_build_hashtable(pgstrom_data_store *pds)
 	kds->nslots = nslots;
 }
 
+/*
+ * Compression of kern_data_store for DMA send
+ *
+ * It is a lightweight LZ77 variant, to reduce the redundant tuple headers
+ * and paddings in the chunk; see the comment at kern_compressed_kds for
+ * the format. The compressed image is decompressed by kern_decompress_kds
+ * on the device prior to the main kernels. It makes sense only if DMA
+ * is the bottleneck, thus disabled by default.
+ */
+#define KDS_COMPRESS_HASH_BITS		12
+#define KDS_COMPRESS_HASH_SIZE		(1U << KDS_COMPRESS_HASH_BITS)
+#define KDS_COMPRESS_MIN_LENGTH		(1UL << 20)	/* less than 1MB is waste */
+#define KDS_COMPRESS_MAX_RATIO		0.75	/* gives up if larger than 75% */
+#define KDS_COMPRESS_TRIAL_NSEGS	64		/* check the ratio at this point */
+#define KDS_DECOMPRESS_BLOCK_SZ		256		/* multiple of warpSize */
+#define KDS_DECOMPRESS_WARP_SZ		32
+
+static inline cl_uint
+kds_compress_read32(const cl_uchar *pos)
+{
+	cl_uint		value;
+
+	memcpy(&value, pos, sizeof(cl_uint));
+	return value;
+}
+
+static inline cl_uchar *
+kds_compress_put_length(cl_uchar *op, cl_uint length)
+{
+	Assert(length >= 15);
+	length -= 15;
+	while (length >= 255)
+	{
+		*op++ = 255;
+		length -= 255;
+	}
+	*op++ = length;
+	return op;
+}
+
+#define KDS_COMPRESS_EXTRA_LENGTH(len)	\
+	((len) < 15 ? 0 : ((len) - 15) / 255 + 1)
+
+/*
+ * kds_compress_segment
+ *
+ * It compresses a segment, then returns length of the compressed image.
+ * If it would not be smaller than the original, it returns 'rawsz'.
+ * 'htab' keeps (offset + 1) of the recent 4-bytes sequences from the head
+ * of the kds; entries less than or equal to 'base' belong to the previous
+ * segments, thus ignored.
+ */
+static cl_uint
+kds_compress_segment(const cl_uchar *src, cl_uint rawsz, cl_uint base,
+					 cl_uchar *dst, cl_uint *htab)
+{
+	cl_uchar   *op = dst;
+	cl_uchar   *oend = dst + rawsz;
+	cl_uint		ip = 0;
+	cl_uint		anchor = 0;
+	cl_uint		nmisses = 0;
+	cl_uint		nlit;
+
+	while (ip + KDS_COMPRESS_MIN_MATCH <= rawsz)
+	{
+		cl_uint		value = kds_compress_read32(src + ip);
+		cl_uint		hindex = ((value * 2654435761U) >>
+							  (32 - KDS_COMPRESS_HASH_BITS));
+		cl_uint		ref = htab[hindex];
+		cl_uint		rpos;
+		cl_uint		mlen;
+
+		htab[hindex] = base + ip + 1;
+		if (ref <= base ||
+			kds_compress_read32(src + (rpos = ref - 1 - base)) != value)
+		{
+			/* skip faster on the incompressible area */
+			nmisses++;
+			ip += 1 + (nmisses >> 5);
+			continue;
+		}
+		mlen = KDS_COMPRESS_MIN_MATCH;
+		while (ip + mlen < rawsz && src[rpos + mlen] == src[ip + mlen])
+			mlen++;
+
+		/* emit a sequence */
+		nlit = ip - anchor;
+		if (op + 1 + KDS_COMPRESS_EXTRA_LENGTH(nlit) + nlit + 2 +
+			KDS_COMPRESS_EXTRA_LENGTH(mlen - KDS_COMPRESS_MIN_MATCH) >= oend)
+			return rawsz;
+		*op++ = ((Min(nlit, 15) << 4) |
+				 Min(mlen - KDS_COMPRESS_MIN_MATCH, 15));
+		if (nlit >= 15)
+			op = kds_compress_put_length(op, nlit);
+		memcpy(op, src + anchor, nlit);
+		op += nlit;
+		*op++ = ((ip - rpos) & 0xff);
+		*op++ = ((ip - rpos) >> 8);
+		if (mlen - KDS_COMPRESS_MIN_MATCH >= 15)
+			op = kds_compress_put_length(op, mlen - KDS_COMPRESS_MIN_MATCH);
+
+		ip += mlen;
+		anchor = ip;
+		nmisses = 0;
+	}
+
+	/* last literals, if any */
+	nlit = rawsz - anchor;
+	if (nlit > 0)
+	{
+		if (op + 1 + KDS_COMPRESS_EXTRA_LENGTH(nlit) + nlit >= oend)
+			return rawsz;
+		*op++ = (Min(nlit, 15) << 4);
+		if (nlit >= 15)
+			op = kds_compress_put_length(op, nlit);
+		memcpy(op, src + anchor, nlit);
+		op += nlit;
+	}
+	return op - dst;
+}
+
+/*
+ * pgstrom_compress_kds
+ *
+ * It makes a compressed image of the kern_data_store on the host pinned
+ * memory, if pg_strom.enable_dma_compress is on. NULL means the data store
+ * is not compressible enough, so caller has to send the original one.
+ */
+kern_compressed_kds *
+pgstrom_compress_kds(GpuContext *gcontext,
+					 kern_data_store *kds,
+					 pgstrom_perfmon *pfm)
+{
+	kern_compressed_kds *kcmp;
+	cl_uint	   *htab;
+	cl_uint		nsegments;
+	cl_uint		i, offset;
+	struct timeval tv1, tv2;
+
+	if (!pgstrom_enable_dma_compress ||
+		kds->length < KDS_COMPRESS_MIN_LENGTH)
+		return NULL;
+
+	PERFMON_BEGIN(pfm, &tv1);
+	nsegments = (kds->length + KDS_COMPRESS_SEGMENT_SZ - 1) /
+		KDS_COMPRESS_SEGMENT_SZ;
+	offset = KERN_COMPRESSED_KDS_HEAD_LENGTH(nsegments);
+	kcmp = MemoryContextAllocHuge(gcontext->memcxt, offset + kds->length);
+	kcmp->length = kds->length;
+	kcmp->nsegments = nsegments;
+	htab = palloc0(sizeof(cl_uint) * KDS_COMPRESS_HASH_SIZE);
+
+	for (i=0; i < nsegments; i++)
+	{
+		cl_uint		base = i * KDS_COMPRESS_SEGMENT_SZ;
+		cl_uint		rawsz = Min(KDS_COMPRESS_SEGMENT_SZ, kds->length - base);
+		cl_uchar   *src = (cl_uchar *)kds + base;
+		cl_uchar   *dst = (cl_uchar *)kcmp + offset;
+		cl_uint		length;
+
+		length = kds_compress_segment(src, rawsz, base, dst, htab);
+		if (length >= rawsz)
+		{
+			memcpy(dst, src, rawsz);
+			length = rawsz;
+		}
+		kcmp->seg_offset[i] = offset;
+		offset += length;
+
+		/* early give up, if not compressible */
+		if (i + 1 == KDS_COMPRESS_TRIAL_NSEGS &&
+			(double)(offset - kcmp->seg_offset[0]) >
+			KDS_COMPRESS_MAX_RATIO * (double)(base + rawsz))
+			break;
+	}
+	kcmp->seg_offset[nsegments] = offset;
+	pfree(htab);
+
+	if (i < nsegments ||
+		(double)offset > KDS_COMPRESS_MAX_RATIO * (double)kds->length)
+	{
+		pfree(kcmp);
+		kcmp = NULL;
+	}
+	else
+	{
+		pfm->num_dma_compress++;
+		pfm->bytes_dma_compress += kds->length;
+	}
+	PERFMON_END(pfm, time_dma_compress, &tv1, &tv2);
+
+	return kcmp;
+}
+
+/*
+ * pgstrom_dma_send_kds
+ *
+ * It enqueues DMA send of the kern_data_store onto the device memory
+ * 'm_kds'. If compressed image is supplied, it is sent to 'm_kcmp'
+ * instead, then decompressed onto the 'm_kds' by kern_decompress_kds.
+ * It returns the length actually sent.
+ */
+size_t
+pgstrom_dma_send_kds(GpuTask *gtask,
+					 CUdeviceptr m_kds, kern_data_store *kds,
+					 CUdeviceptr m_kcmp, kern_compressed_kds *kcmp)
+{
+	CUfunction	kern_decompress;
+	void	   *kern_args[2];
+	size_t		length;
+	size_t		grid_size;
+	CUresult	rc;
+
+	if (!kcmp)
+	{
+		length = KERN_DATA_STORE_LENGTH(kds);
+		rc = cuMemcpyHtoDAsync(m_kds, kds, length, gtask->cuda_stream);
+		if (rc != CUDA_SUCCESS)
+			elog(ERROR, "failed on cuMemcpyHtoDAsync: %s", errorText(rc));
+		return length;
+	}
+	Assert(kcmp->length == KERN_DATA_STORE_LENGTH(kds));
+
+	length = KERN_COMPRESSED_KDS_LENGTH(kcmp);
+	rc = cuMemcpyHtoDAsync(m_kcmp, kcmp, length, gtask->cuda_stream);
+	if (rc != CUDA_SUCCESS)
+		elog(ERROR, "failed on cuMemcpyHtoDAsync: %s", errorText(rc));
+
+	/*
+	 * KERNEL_FUNCTION(void)
+	 * kern_decompress_kds(kern_compressed_kds *kcmp,
+	 *                     kern_data_store *kds_dst)
+	 */
+	rc = cuModuleGetFunction(&kern_decompress,
+							 gtask->cuda_module,
+							 "kern_decompress_kds");
+	if (rc != CUDA_SUCCESS)
+		elog(ERROR, "failed on cuModuleGetFunction: %s", errorText(rc));
+
+	grid_size = ((size_t)kcmp->nsegments * KDS_DECOMPRESS_WARP_SZ +
+				 KDS_DECOMPRESS_BLOCK_SZ - 1) / KDS_DECOMPRESS_BLOCK_SZ;
+	kern_args[0] = &m_kcmp;
+	kern_args[1] = &m_kds;
+	rc = cuLaunchKernel(kern_decompress,
+						grid_size, 1, 1,
+						KDS_DECOMPRESS_BLOCK_SZ, 1, 1,
+						0,
+						gtask->cuda_stream,
+						kern_args,
+						NULL);
+	if (rc != CUDA_SUCCESS)
+		elog(ERROR, "failed on cuLaunchKernel: %s", errorText(rc));
+
+	return length;
+}
+
 void
 pgstrom_init_datastore(void)
 {
@@ -849,4 +1565,36 @@ pgstrom_init_datastore(void)
 							PGC_USERSET,
 							GUC_NOT_IN_SAMPLE | GUC_UNIT_KB,
 							check_guc_chunk_limit, NULL, NULL);
+	DefineCustomBoolVariable("pg_strom.enable_adaptive_chunk",
+							 "Enables to adjust chunk size according to the run-time feedback",
+							 NULL,
+							 &pgstrom_enable_adaptive_chunk,
+							 true,
+							 PGC_USERSET,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
+	DefineCustomBoolVariable("pg_strom.enable_dma_compress",
+							 "Enables to compress chunks prior to DMA send",
+							 NULL,
+							 &pgstrom_enable_dma_compress,
+							 false,
+							 PGC_USERSET,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
+	DefineCustomBoolVariable("pg_strom.enable_direct_load",
+							 "Enables to load all-visible blocks of large tables bypassing shared buffers",
+							 NULL,
+							 &pgstrom_enable_direct_load,
+							 false,
+							 PGC_USERSET,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
+	DefineCustomBoolVariable("pg_strom.debug_force_direct_load",
+							 "Force direct load regardless of the relation size (debug)",
+							 NULL,
+							 &pgstrom_debug_force_direct_load,
+							 false,
+							 PGC_USERSET,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
 }
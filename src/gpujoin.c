@@ -17,6 +17,8 @@
  * GNU General Public License for more details.
  */
 #include "postgres.h"
+#include "access/htup_details.h"
+#include "access/nbtree.h"
 #include "access/sysattr.h"
 #include "access/xact.h"
 #include "catalog/heap.h"
@@ -40,6 +42,7 @@
 #include "utils/pg_crc.h"
 #include "utils/rel.h"
 #include "utils/ruleutils.h"
+#include "utils/sortsupport.h"
 #include <math.h>
 #include "pg_strom.h"
 #include "cuda_numeric.h"
@@ -93,6 +96,10 @@ typedef struct
 	List	   *nloops_major;
 	List	   *hash_inner_keys;	/* if hash-join */
 	List	   *hash_outer_keys;	/* if hash-join */
+	List	   *range_inner_keys;	/* if range-join */
+	List	   *range_lower_quals;	/* if range-join */
+	List	   *range_upper_quals;	/* if range-join */
+	List	   *range_sortops;		/* if range-join */
 	/* supplemental information of ps_tlist */
 	List	   *ps_src_depth;	/* source depth of the ps_tlist entry */
 	List	   *ps_src_resno;	/* source resno of the ps_tlist entry */
@@ -124,6 +131,10 @@ form_gpujoin_info(CustomScan *cscan, GpuJoinInfo *gj_info)
 	privs = lappend(privs, gj_info->nloops_major);
 	exprs = lappend(exprs, gj_info->hash_inner_keys);
 	exprs = lappend(exprs, gj_info->hash_outer_keys);
+	exprs = lappend(exprs, gj_info->range_inner_keys);
+	exprs = lappend(exprs, gj_info->range_lower_quals);
+	exprs = lappend(exprs, gj_info->range_upper_quals);
+	privs = lappend(privs, gj_info->range_sortops);
 
 	privs = lappend(privs, gj_info->ps_src_depth);
 	privs = lappend(privs, gj_info->ps_src_resno);
@@ -161,6 +172,10 @@ deform_gpujoin_info(CustomScan *cscan)
 	gj_info->nloops_major = list_nth(privs, pindex++);
 	gj_info->hash_inner_keys = list_nth(exprs, eindex++);
     gj_info->hash_outer_keys = list_nth(exprs, eindex++);
+	gj_info->range_inner_keys = list_nth(exprs, eindex++);
+	gj_info->range_lower_quals = list_nth(exprs, eindex++);
+	gj_info->range_upper_quals = list_nth(exprs, eindex++);
+	gj_info->range_sortops = list_nth(privs, pindex++);
 
 	gj_info->ps_src_depth = list_nth(privs, pindex++);
 	gj_info->ps_src_resno = list_nth(privs, pindex++);
@@ -212,11 +227,24 @@ typedef struct
 	cl_uint				hgram_width;
 	Size			   *hgram_size;
 	Size			   *hgram_nitems;
+	cl_uint			   *bloom_filter;	/* bloom filter of hash values */
+	cl_uint				bloom_nbits;	/* number of bits; power of 2 */
+	Size				bloom_nitems;	/* number of entries on the filter */
 	List			   *hash_outer_keys;
 	List			   *hash_inner_keys;
 	List			   *hash_keylen;
 	List			   *hash_keybyval;
 	List			   *hash_keytype;
+	char			   *icache_ident;	/* identifier on the inner hash
+										 * cache, or NULL if not cacheable */
+	Oid					icache_relid;	/* OID of the inner relation */
+	bool				icache_hit;		/* true, if picked up from cache */
+
+	/*
+	 * Join properties; only range-join
+	 */
+	AttrNumber			range_attno;	/* attribute of the range key */
+	Oid					range_sortop;	/* sort operator of the range key */
 
 	/* CPU Fallback related */
 	AttrNumber		   *inner_dst_resno;
@@ -293,6 +321,21 @@ typedef struct
 	 * Properties of underlying inner relations
 	 */
 	bool			inner_preloaded;
+	bool			inner_partitioned;	/* true, if depth-1 is partitioned */
+
+	/*
+	 * Grace hash-join; outer rows which shall be joined with the later
+	 * depth-1 chunks are written to the spill files on the first outer
+	 * scan, instead of the rescan of outer relation for each chunk.
+	 */
+	bool			outer_spill;		/* true, if outer rows are spilled */
+	int				spill_nparts;		/* number of depth-1 chunks */
+	pg_crc32	   *spill_hash_max;		/* upper bound of hash per chunk */
+	Tuplestorestate **spill_tupstore;	/* spill files per depth-1 chunk */
+	Tuplestorestate *spill_curr;		/* spill file being read, if any */
+	TupleTableSlot *spill_slot;			/* slot to read the spill files */
+	TupleTableSlot *spill_hslot;		/* slot to compute outer hash */
+	size_t			spill_ntuples;		/* number of spilled outer rows */
 	innerState		inners[FLEXIBLE_ARRAY_MEMBER];
 } GpuJoinState;
 
@@ -312,6 +355,11 @@ typedef struct pgstrom_multirels
 	CUevent		   *ev_loaded;	/* Sync object for each CUDA context */
 	CUdeviceptr	   *m_ojmaps;	/* GPU memory for outer join maps */
 	cl_bool		   *host_ojmaps;/* Host memory for outer join maps */
+	/*
+	 * In case of partitioned inner, depth-1 has individual hash-table for
+	 * each CUDA context. It is located next to the replicated portion.
+	 */
+	pgstrom_data_store **part_chunks;	/* depth-1 PDS per context, or NULL */
 	kern_multirels	kern;
 } pgstrom_multirels;
 
@@ -331,7 +379,9 @@ typedef struct
 	CUevent			ev_dma_send_stop;
 	CUevent			ev_dma_recv_start;
 	CUevent			ev_dma_recv_stop;
+	GpuTaskTuning	tune_main;		/* autotuner of gpujoin_main */
 	bool			is_inner_loader;
+	cl_int			part_index;		/* index of inner partition, or -1 */
 	pgstrom_multirels  *pmrels;		/* inner multi relations (heap or hash) */
 	pgstrom_data_store *pds_src;	/* data store of outer relation */
 	pgstrom_data_store *pds_dst;	/* data store of result buffer */
@@ -345,6 +395,21 @@ static CustomScanMethods	gpujoin_plan_methods;
 static CustomExecMethods	gpujoin_exec_methods;
 static bool					enable_gpunestloop;
 static bool					enable_gpuhashjoin;
+static bool					enable_gpujoin_partition;
+static bool					enable_gpujoin_spill;
+static bool					enable_gpujoin_bloom;
+static bool					enable_gpujoin_heavy_hitter;
+static bool					enable_gpujoin_range;
+static int					debug_gpujoin_inner_limit;
+
+/*
+ * Hash keys which have more than GPUJOIN_HEAVY_HITTER_MIN_NITEMS entries
+ * are heavy-hitters; up to GPUJOIN_HEAVY_HITTER_MAX_KEYS keys per chunk,
+ * by sampling of GPUJOIN_HEAVY_HITTER_NSAMPLES entries.
+ */
+#define GPUJOIN_HEAVY_HITTER_MIN_NITEMS		256
+#define GPUJOIN_HEAVY_HITTER_MAX_KEYS		32
+#define GPUJOIN_HEAVY_HITTER_NSAMPLES		8192
 
 /* static functions */
 static bool	gpujoin_task_process(GpuTask *gtask);
@@ -353,6 +418,8 @@ static void	gpujoin_task_release(GpuTask *gtask);
 static GpuTask *gpujoin_next_chunk(GpuTaskState *gts);
 static void gpujoin_switch_task(GpuTaskState *gts, GpuTask *gtask);
 static TupleTableSlot *gpujoin_next_tuple(GpuTaskState *gts);
+static pgstrom_data_store *gpujoin_exec_bulk(GpuTaskState *gts,
+											 size_t chunk_size);
 static TupleTableSlot *gpujoin_next_tuple_fallback(GpuJoinState *gjs,
 												   pgstrom_gpujoin *pgjoin);
 static pg_crc32 get_tuple_hashvalue(innerState *istate,
@@ -365,8 +432,16 @@ static char *gpujoin_codegen(PlannerInfo *root,
 							 GpuJoinInfo *gj_info,
 							 codegen_context *context);
 
+static char *gpujoin_inner_cache_ident(GpuJoinState *gjs,
+									   innerState *istate,
+									   List *hash_inner_keys);
 static void gpujoin_inner_unload(GpuJoinState *gjs, bool needs_rescan);
 static pgstrom_multirels *gpujoin_inner_getnext(GpuJoinState *gjs);
+static void gpujoin_outer_spill_begin(GpuJoinState *gjs);
+static void gpujoin_outer_spill_end(GpuJoinState *gjs);
+static void gpujoin_outer_spill_write(GpuJoinState *gjs,
+									  pgstrom_data_store *pds);
+static pgstrom_data_store *gpujoin_outer_spill_read(GpuJoinState *gjs);
 static pgstrom_multirels *multirels_attach_buffer(pgstrom_multirels *pmrels);
 static bool multirels_get_buffer(pgstrom_multirels *pmrels,
 								 pgstrom_gpujoin *pgjoin);
@@ -378,6 +453,27 @@ static void colocate_outer_join_maps_to_device(pgstrom_multirels *pmrels,
 static void multirels_detach_buffer(pgstrom_multirels *pmrels,
 									bool may_kick_outer_join,
 									const char *caller);
+
+/*
+ * multirels_inner_chunk
+ *
+ * It returns the inner PDS of the depth, as visible to the task. In case
+ * of partitioned inner, part_index is also index of the CUDA context that
+ * owns the partition.
+ */
+static inline pgstrom_data_store *
+multirels_inner_chunk(pgstrom_multirels *pmrels, int depth, cl_int part_index)
+{
+	Assert(depth > 0 && depth <= pmrels->kern.nrels);
+	if (depth == 1 && pmrels->part_chunks)
+	{
+		Assert(part_index >= 0 &&
+			   part_index < pmrels->gjs->gts.gcontext->num_context);
+		Assert(pmrels->part_chunks[part_index] != NULL);
+		return pmrels->part_chunks[part_index];
+	}
+	return pmrels->inner_chunks[depth - 1];
+}
 /*
  * misc declarations
  */
@@ -447,6 +543,23 @@ __dump_gpujoin_path(StringInfo buf, PlannerInfo *root, Path *pathnode)
 		appendStringInfo(buf, ")");
 }
 
+/*
+ * gpujoin_inner_buffer_limit
+ *
+ * Half of the max allocatable GPU memory (and minus some margin) is the
+ * hard limit of the inner multi-relations buffer. It can be restricted
+ * more by pg_strom.debug_gpujoin_inner_limit, to test the split case.
+ */
+static Size
+gpujoin_inner_buffer_limit(int num_rels)
+{
+	Size	limit = gpuMemMaxAllocSize() / 2 - BLCKSZ * num_rels;
+
+	if (debug_gpujoin_inner_limit > 0)
+		limit = Min(limit, (Size) debug_gpujoin_inner_limit << 10);
+	return limit;
+}
+
 /*
  * estimate_buffersize_gpujoin 
  *
@@ -649,7 +762,7 @@ retry_major:
 	 * large, so it often leads 32bit integer overflow. Please be
 	 * careful.
 	 */
-	inner_limit_sz = gpuMemMaxAllocSize() / 2 - BLCKSZ * num_rels;
+	inner_limit_sz = gpujoin_inner_buffer_limit(num_rels);
 	if (inner_total_sz > inner_limit_sz)
 	{
 		double	nloops_major_next;
@@ -671,6 +784,33 @@ retry_major:
 	return true;	/* probably, reasonable plan for buffer usage */
 }
 
+/*
+ * gpujoin_path_spill_available
+ *
+ * It checks whether the outer rows can be spilled according to the hash-
+ * value of depth-1, instead of rescan of the outer relation for each
+ * split inner chunk (Grace hash-join).
+ */
+static bool
+gpujoin_path_spill_available(GpuJoinPath *gpath)
+{
+	int		i;
+
+	if (!enable_gpujoin_spill ||
+		gpath->inners[0].hash_quals == NIL ||
+		gpath->inners[0].nloops_major <= 1.0)
+		return false;
+
+	for (i=1; i < gpath->num_rels; i++)
+	{
+		if (gpath->inners[i].nloops_major > 1.0 ||
+			gpath->inners[i].join_type == JOIN_RIGHT ||
+			gpath->inners[i].join_type == JOIN_FULL)
+			return false;
+	}
+	return true;
+}
+
 /*
  * cost_gpujoin
  *
@@ -811,9 +951,30 @@ cost_gpujoin(PlannerInfo *root,
 				 total_nloops_minor * 0.20);
 
 	/*
-	 * Major inner split makes iteration of entire process multiple times
+	 * Major inner split makes iteration of entire process multiple times,
+	 * unless outer rows are spilled by the hash-value of depth-1. In this
+	 * case, outer relation is scanned only once, then GPU kernel runs on
+	 * the spilled rows again.
 	 */
-	run_cost *= total_nloops_major;
+	if (gpujoin_path_spill_available(gpath))
+	{
+		Cost	outer_cost = outer_path->total_cost - outer_path->startup_cost;
+		double	nsplits = gpath->inners[0].nloops_major;
+		double	spill_ratio = (nsplits - 1.0) / nsplits;
+		double	spill_pages = (spill_ratio * outer_path->rows *
+							   (double) outer_path->parent->width /
+							   (double) BLCKSZ);
+
+		run_cost = outer_cost + (run_cost - outer_cost) * (1.0 + spill_ratio);
+		/* cost to compute outer hash value by CPU */
+		run_cost += (cpu_operator_cost *
+					 list_length(gpath->inners[0].hash_quals) *
+					 outer_path->rows);
+		/* cost to write and read the spill files */
+		run_cost += 2.0 * seq_page_cost * spill_pages;
+	}
+	else
+		run_cost *= total_nloops_major;
 
 	/*
 	 * cost discount by GPU projection, if this join is the last level
@@ -1692,6 +1853,7 @@ build_device_tlist_tentative(GpuJoinPath *gpath,
 	build_device_tlist_walker((Node *)gj_info->other_quals, &context);
 	build_device_tlist_walker((Node *)gj_info->hash_inner_keys, &context);
 	build_device_tlist_walker((Node *)gj_info->hash_outer_keys, &context);
+	build_device_tlist_walker((Node *)gj_info->range_inner_keys, &context);
 
 	Assert(list_length(context.ps_tlist) == list_length(context.ps_depth) &&
 		   list_length(context.ps_tlist) == list_length(context.ps_resno));
@@ -1701,6 +1863,174 @@ build_device_tlist_tentative(GpuJoinPath *gpath,
 	cscan->custom_scan_tlist = context.ps_tlist;
 }
 
+/*
+ * gpujoin_range_join_keys
+ *
+ * It picks up a range key of the inner relation from the join qualifiers
+ * of GpuNestLoop, if any. A btree comparison between a Var of the inner
+ * relation and an expression of the outer relation can restrict the inner
+ * rows to be checked, once inner rows are sorted by the Var. Qualifiers
+ * are transformed to the form of (Var < expr) or (Var <= expr); it is true
+ * on the leading portion of the sorted inner rows, so GPU kernel can look
+ * up the lower and upper bound by binary search.
+ * Only INNER and LEFT OUTER JOIN are supported, because inner rows with
+ * NULL key are never referenced then.
+ */
+static bool
+gpujoin_range_join_keys(GpuJoinPath *gpath, int depth_index,
+						List *join_quals,
+						Var **p_range_key, Oid *p_sortop,
+						Expr **p_lower_qual, Expr **p_upper_qual)
+{
+	RelOptInfo *scan_rel = gpath->inners[depth_index].scan_path->parent;
+	JoinType	join_type = gpath->inners[depth_index].join_type;
+	Var		   *range_key = NULL;
+	Oid			range_opfamily = InvalidOid;
+	Oid			sortop = InvalidOid;
+	Expr	   *lower_qual = NULL;
+	Expr	   *upper_qual = NULL;
+	ListCell   *lc1;
+	ListCell   *lc2;
+
+	if (!enable_gpujoin_range ||
+		gpath->inners[depth_index].hash_quals != NIL ||
+		(join_type != JOIN_INNER && join_type != JOIN_LEFT))
+		return false;
+
+	foreach (lc1, join_quals)
+	{
+		OpExpr	   *op = lfirst(lc1);
+		Node	   *arg1;
+		Node	   *arg2;
+		Var		   *var;
+		Node	   *expr;
+		bool		commuted;
+
+		if (!is_opclause(op) || list_length(op->args) != 2)
+			continue;
+		arg1 = linitial(op->args);
+		arg2 = lsecond(op->args);
+		if (IsA(arg1, Var) &&
+			bms_is_subset(pull_varnos(arg1), scan_rel->relids) &&
+			!bms_overlap(pull_varnos(arg2), scan_rel->relids))
+		{
+			var = (Var *) arg1;
+			expr = arg2;
+			commuted = false;
+		}
+		else if (IsA(arg2, Var) &&
+				 bms_is_subset(pull_varnos(arg2), scan_rel->relids) &&
+				 !bms_overlap(pull_varnos(arg1), scan_rel->relids))
+		{
+			var = (Var *) arg2;
+			expr = arg1;
+			commuted = true;
+		}
+		else
+			continue;
+
+		/* only one range key per depth */
+		if (range_key ? !equal(range_key, var) : var->varattno <= 0)
+			continue;
+		/* sort order on the host must be identical to the device */
+		if (type_is_collatable(var->vartype) ||
+			contain_volatile_functions(expr))
+			continue;
+
+		foreach (lc2, get_op_btree_interpretation(op->opno))
+		{
+			OpBtreeInterpretation *oinfo = lfirst(lc2);
+			Oid			lefttype = var->vartype;
+			Oid			righttype = exprType(expr);
+			int			strategy = oinfo->strategy;
+			Oid			lower_opno = InvalidOid;
+			Oid			upper_opno = InvalidOid;
+			Oid			lt_opno;
+			Oid			le_opno;
+
+			if (strategy < BTLessStrategyNumber ||
+				strategy > BTGreaterStrategyNumber)
+				continue;
+			if (OidIsValid(range_opfamily) &&
+				range_opfamily != oinfo->opfamily_id)
+				continue;
+			if (!OidIsValid(range_opfamily))
+			{
+				sortop = get_opfamily_member(oinfo->opfamily_id,
+											 lefttype, lefttype,
+											 BTLessStrategyNumber);
+				if (!OidIsValid(sortop))
+					continue;
+			}
+			/* normalize to (Var OP expr) */
+			if (commuted)
+				strategy = BTMaxStrategyNumber + 1 - strategy;
+			lt_opno = get_opfamily_member(oinfo->opfamily_id,
+										  lefttype, righttype,
+										  BTLessStrategyNumber);
+			le_opno = get_opfamily_member(oinfo->opfamily_id,
+										  lefttype, righttype,
+										  BTLessEqualStrategyNumber);
+			switch (strategy)
+			{
+				case BTLessStrategyNumber:
+					upper_opno = lt_opno;
+					break;
+				case BTLessEqualStrategyNumber:
+					upper_opno = le_opno;
+					break;
+				case BTEqualStrategyNumber:
+					lower_opno = lt_opno;
+					upper_opno = le_opno;
+					break;
+				case BTGreaterEqualStrategyNumber:
+					lower_opno = lt_opno;
+					break;
+				case BTGreaterStrategyNumber:
+					lower_opno = le_opno;
+					break;
+			}
+			if (!lower_qual && OidIsValid(lower_opno))
+			{
+				Expr   *qual = make_opclause(lower_opno, BOOLOID, false,
+											 copyObject(var),
+											 copyObject(expr),
+											 InvalidOid, op->inputcollid);
+				set_opfuncid((OpExpr *) qual);
+				if (pgstrom_device_expression(qual))
+				{
+					lower_qual = qual;
+					range_key = var;
+					range_opfamily = oinfo->opfamily_id;
+				}
+			}
+			if (!upper_qual && OidIsValid(upper_opno))
+			{
+				Expr   *qual = make_opclause(upper_opno, BOOLOID, false,
+											 copyObject(var),
+											 copyObject(expr),
+											 InvalidOid, op->inputcollid);
+				set_opfuncid((OpExpr *) qual);
+				if (pgstrom_device_expression(qual))
+				{
+					upper_qual = qual;
+					range_key = var;
+					range_opfamily = oinfo->opfamily_id;
+				}
+			}
+			break;
+		}
+	}
+
+	if (!range_key)
+		return false;
+	*p_range_key = range_key;
+	*p_sortop = sortop;
+	*p_lower_qual = lower_qual;
+	*p_upper_qual = upper_qual;
+	return true;
+}
+
 /*
  * create_gpujoin_plan
  *
@@ -1750,6 +2080,10 @@ create_gpujoin_plan(PlannerInfo *root,
 		List	   *hash_outer_keys = NIL;
 		List	   *join_quals = NIL;
 		List	   *other_quals = NIL;
+		Var		   *range_key = NULL;
+		Oid			range_sortop = InvalidOid;
+		Expr	   *range_lower = NULL;
+		Expr	   *range_upper = NULL;
 		float		nrows_ratio;
 
 		foreach (lc, gpath->inners[i].hash_quals)
@@ -1819,6 +2153,18 @@ create_gpujoin_plan(PlannerInfo *root,
 										  hash_inner_keys);
 		gj_info.hash_outer_keys = lappend(gj_info.hash_outer_keys,
 										  hash_outer_keys);
+
+		gpujoin_range_join_keys(gpath, i, join_quals,
+								&range_key, &range_sortop,
+								&range_lower, &range_upper);
+		gj_info.range_inner_keys = lappend(gj_info.range_inner_keys,
+										   range_key);
+		gj_info.range_lower_quals = lappend(gj_info.range_lower_quals,
+											range_lower);
+		gj_info.range_upper_quals = lappend(gj_info.range_upper_quals,
+											range_upper);
+		gj_info.range_sortops = lappend_oid(gj_info.range_sortops,
+											range_sortop);
 		outer_nrows = gpath->inners[i].join_nrows;
 	}
 
@@ -2807,7 +3153,7 @@ gpujoin_begin(CustomScanState *node, EState *estate, int eflags)
 	if (pgstrom_bulkexec_enabled &&
 		gjs->gts.css.ss.ps.qual == NIL &&
 		gjs->gts.css.ss.ps.ps_ProjInfo == NULL)
-		gjs->gts.cb_bulk_exec = pgstrom_exec_chunk_gputask;
+		gjs->gts.cb_bulk_exec = gpujoin_exec_bulk;
 
 	/*
 	 * NOTE: outer_quals, hash_outer_keys and join_quals are intended
@@ -3048,6 +3394,27 @@ gpujoin_begin(CustomScanState *node, EState *estate, int eflags)
 			istate->hgram_nitems = palloc0(sizeof(Size) * istate->hgram_width);
 			istate->hgram_shift = sizeof(cl_uint) * BITS_PER_BYTE - shift;
 			istate->hgram_curr = 0;
+
+			/* identifier on the inner hash cache, if available */
+			istate->icache_ident = gpujoin_inner_cache_ident(gjs, istate,
+															 hash_inner_keys);
+		}
+
+		/* range key to sort the inner rows, if range-join */
+		if (list_nth(gj_info->range_inner_keys, i) != NULL)
+		{
+			List   *range_keys;
+			Var	   *range_key;
+
+			range_keys = list_make1(list_nth(gj_info->range_inner_keys, i));
+			range_keys = fixup_varnode_to_origin(i+1,
+												 gj_info->ps_src_depth,
+												 gj_info->ps_src_resno,
+												 range_keys);
+			range_key = linitial(range_keys);
+			Assert(IsA(range_key, Var) && range_key->varno == INNER_VAR);
+			istate->range_attno = range_key->varattno;
+			istate->range_sortop = list_nth_oid(gj_info->range_sortops, i);
 		}
 
 		/*
@@ -3101,7 +3468,7 @@ gpujoin_begin(CustomScanState *node, EState *estate, int eflags)
 								gj_info->used_params,
 								gj_info->kern_source,
 								gj_info->extra_flags);
-	if ((eflags & EXEC_FLAG_EXPLAIN_ONLY) == 0)
+	if (PGSTROM_PRELOAD_CUDA_PROGRAM(eflags))
 		pgstrom_load_cuda_program(&gjs->gts, true);
 
 	/* expected kresults buffer expand rate */
@@ -3138,6 +3505,7 @@ gpujoin_end(CustomScanState *node)
 		gjs->curr_pmrels = NULL;
 	}
 	gpujoin_inner_unload(gjs, false);
+	gpujoin_outer_spill_end(gjs);
 
 	/*
 	 * Clean up subtree (if any)
@@ -3185,6 +3553,8 @@ gpujoin_rescan(CustomScanState *node)
 		ExecReScan(outerPlanState(gjs));
 	gjs->gts.scan_overflow = NULL;
 	gjs->outer_scan_done = false;
+	/* spilled outer rows are no longer valid */
+	gpujoin_outer_spill_end(gjs);
 
 	/*
 	 * Detach previous inner relations buffer
@@ -3317,6 +3687,13 @@ gpujoin_explain(CustomScanState *node, List *ancestors, ExplainState *es)
                                       context, true, false);
 			appendStringInfo(&str, ", HashKeys: (%s)", temp);
 		}
+		else if (list_nth(gj_info->range_inner_keys, depth - 1) != NULL)
+		{
+			temp = deparse_expression(list_nth(gj_info->range_inner_keys,
+											   depth - 1),
+									  context, true, false);
+			appendStringInfo(&str, ", RangeKey: (%s)", temp);
+		}
 		snprintf(qlabel, sizeof(qlabel), "Depth% 2d", depth);
 		ExplainPropertyText(qlabel, str.data, es);
 		resetStringInfo(&str);
@@ -3402,6 +3779,13 @@ gpujoin_explain(CustomScanState *node, List *ancestors, ExplainState *es)
 				format_bytesz(istate->ichunk_size),
 				istate->nbatches_exec,
 				istate->nbatches_plan);
+			if (depth == 1 && gjs->inner_partitioned)
+				appendStringInfo(&str, ", partitioned over %d GPUs",
+								 gjs->gts.gcontext->num_context);
+			if (istate->bloom_filter)
+				appendStringInfo(&str, ", bloom filter: %s",
+								 format_bytesz(istate->bloom_nbits /
+											   BITS_PER_BYTE));
 		}
 		else
 		{
@@ -3466,6 +3850,10 @@ gpujoin_explain(CustomScanState *node, List *ancestors, ExplainState *es)
 			ExplainPropertyLong("Size of Inner-DMA",
 								pfm->gjoin.bytes_inner_dma_send, es);
 		}
+		/* number of outer rows spilled by Grace hash-join */
+		if (gjs->spill_ntuples > 0)
+			ExplainPropertyLong("Outer Spilled Rows",
+								gjs->spill_ntuples, es);
 	}
 	/* other common field */
 	pgstrom_explain_gputaskstate(&gjs->gts, es);
@@ -3883,6 +4271,70 @@ gpujoin_codegen_hash_value(StringInfo source,
 	pfree(body.data);
 }
 
+/*
+ * codegen for:
+ * STATIC_FUNCTION(cl_bool)
+ * gpujoin_range_qual_depth%u(kern_context *kcxt,
+ *                            kern_data_store *kds,
+ *                            kern_multirels *kmrels,
+ *                            cl_uint *o_buffer,
+ *                            HeapTupleHeaderData *i_htup,
+ *                            cl_bool is_upper)
+ */
+static void
+gpujoin_codegen_range_qual(StringInfo source,
+						   GpuJoinInfo *gj_info,
+						   int cur_depth,
+						   codegen_context *context)
+{
+	Expr	   *lower_qual;
+	Expr	   *upper_qual;
+	char	   *lower_code = NULL;
+	char	   *upper_code = NULL;
+
+	Assert(cur_depth > 0 && cur_depth <= gj_info->num_rels);
+	lower_qual = list_nth(gj_info->range_lower_quals, cur_depth - 1);
+	upper_qual = list_nth(gj_info->range_upper_quals, cur_depth - 1);
+
+	context->used_vars = NIL;
+	context->param_refs = NULL;
+	if (lower_qual)
+		lower_code = pgstrom_codegen_expression((Node *)lower_qual, context);
+	if (upper_qual)
+		upper_code = pgstrom_codegen_expression((Node *)upper_qual, context);
+
+	appendStringInfo(
+		source,
+		"STATIC_FUNCTION(cl_bool)\n"
+		"gpujoin_range_qual_depth%d(kern_context *kcxt,\n"
+		"                           kern_data_store *kds,\n"
+		"                           kern_multirels *kmrels,\n"
+		"                           cl_uint *o_buffer,\n"
+		"                           HeapTupleHeaderData *i_htup,\n"
+		"                           cl_bool is_upper)\n"
+		"{\n",
+		cur_depth);
+
+	/*
+	 * variable/params declaration & initialization
+	 */
+	gpujoin_codegen_var_param_decl(source, gj_info, cur_depth, context);
+
+	/*
+	 * no lower bound qualifier means the first row, and no upper bound
+	 * qualifier means the last row.
+	 */
+	appendStringInfo(
+		source,
+		"  if (is_upper)\n"
+		"    return %s;\n"
+		"  return %s;\n"
+		"}\n"
+		"\n",
+		upper_code ? psprintf("EVAL(%s)", upper_code) : "true",
+		lower_code ? psprintf("EVAL(%s)", lower_code) : "false");
+}
+
 static char *
 gpujoin_codegen(PlannerInfo *root,
 				CustomScan *cscan,
@@ -3933,6 +4385,53 @@ gpujoin_codegen(PlannerInfo *root,
 		"}\n\n");
 
 
+	depth = 1;
+	foreach (cell, gj_info->range_inner_keys)
+	{
+		if (lfirst(cell) != NULL)
+			gpujoin_codegen_range_qual(&source, gj_info, depth, context);
+		depth++;
+	}
+
+	/* gpujoin_range_qual */
+	appendStringInfo(
+		&source,
+		"STATIC_FUNCTION(cl_bool)\n"
+		"gpujoin_range_qual(kern_context *kcxt,\n"
+		"                   kern_data_store *kds,\n"
+		"                   kern_multirels *kmrels,\n"
+		"                   cl_int depth,\n"
+		"                   cl_uint *o_buffer,\n"
+		"                   HeapTupleHeaderData *i_htup,\n"
+		"                   cl_bool is_upper)\n"
+		"{\n"
+		"  switch (depth)\n"
+		"  {\n");
+	depth = 1;
+	foreach (cell, gj_info->range_inner_keys)
+	{
+		if (lfirst(cell) != NULL)
+		{
+			appendStringInfo(
+				&source,
+				"  case %u:\n"
+				"    return gpujoin_range_qual_depth%u(kcxt,kds,kmrels,\n"
+				"                                      o_buffer,i_htup,\n"
+				"                                      is_upper);\n",
+				depth, depth);
+		}
+		depth++;
+	}
+	appendStringInfo(
+		&source,
+		"  default:\n"
+		"    STROM_SET_ERROR(&kcxt->e, StromError_SanityCheckViolation);\n"
+		"    break;\n"
+		"  }\n"
+		"  return false;\n"
+		"}\n"
+		"\n");
+
 	depth = 1;
 	foreach (cell, gj_info->hash_outer_keys)
 	{
@@ -4091,7 +4590,9 @@ gpujoin_exec_estimate_nitems(GpuJoinState *gjs,
 		}
 		else
 		{
-			pgstrom_data_store *pds_in = pmrels->inner_chunks[depth - 1];
+			pgstrom_data_store *pds_in
+				= multirels_inner_chunk(pmrels, depth,
+										pgjoin->part_index);
 			cl_uint				nitems_in = pds_in->kds->nitems;
 
 			plan_ratio = istate->nrows_ratio;
@@ -4119,7 +4620,8 @@ gpujoin_exec_estimate_nitems(GpuJoinState *gjs,
 	if (!pgjoin->pds_src && (istate->join_type == JOIN_RIGHT ||
 							 istate->join_type == JOIN_FULL))
 	{
-		pgstrom_data_store *pds_in = pmrels->inner_chunks[depth - 1];
+		pgstrom_data_store *pds_in
+			= multirels_inner_chunk(pmrels, depth, pgjoin->part_index);
 
 		if (jscale[depth].window_size > 0)
 		{
@@ -4321,7 +4823,8 @@ static GpuTask *
 gpujoin_create_task(GpuJoinState *gjs,
 					pgstrom_multirels *pmrels,
 					pgstrom_data_store *pds_src,
-					kern_join_scale *jscale_old)
+					kern_join_scale *jscale_old,
+					cl_int part_index)
 {
 	GpuContext		   *gcontext = gjs->gts.gcontext;
 	pgstrom_gpujoin	   *pgjoin;
@@ -4347,6 +4850,11 @@ gpujoin_create_task(GpuJoinState *gjs,
 				STROMALIGN(gjs->gts.kern_params->length));
 	pgjoin = MemoryContextAllocZero(gcontext->memcxt, required);
 	pgstrom_init_gputask(&gjs->gts, &pgjoin->task);
+	/* partitioned inner is processed on the device that owns it */
+	Assert(part_index < 0 || pmrels->part_chunks != NULL);
+	pgjoin->part_index = part_index;
+	if (part_index >= 0)
+		pgjoin->task.cuda_index = part_index;
 	pgjoin->pmrels = multirels_attach_buffer(pmrels);
 	pgjoin->pds_src = pds_src;
 	pgjoin->pds_dst = NULL;		/* to be set later */
@@ -4378,7 +4886,8 @@ gpujoin_create_task(GpuJoinState *gjs,
 		if (i == 0)
 			nitems = (!pgjoin->pds_src ? 0 : pgjoin->pds_src->kds->nitems);
 		else
-			nitems = pmrels->inner_chunks[i-1]->kds->nitems;
+			nitems = multirels_inner_chunk(pmrels, i,
+										   pgjoin->part_index)->kds->nitems;
 
 		if (!jscale_old)
 		{
@@ -4614,13 +5123,28 @@ gpujoin_next_chunk(GpuTaskState *gts)
 
 			gjs->curr_pmrels = pmrels_new;
 
+			/*
+			 * The first depth-1 chunk scans the outer relation, and spills
+			 * the outer rows for the later chunks, if Grace hash-join.
+			 */
+			if (gjs->inners[0].pds_index == 1)
+				gpujoin_outer_spill_begin(gjs);
+
 			/*
 			 * Rewind the outer scan pointer,
 			 * if it is not the first time
 			 */
 			if (gjs->outer_scan_done)
 			{
-				if (gjs->gts.css.ss.ss_currentRelation)
+				if (gjs->outer_spill)
+				{
+					Assert(gjs->inners[0].pds_index > 1 &&
+						   gjs->inners[0].pds_index <= gjs->spill_nparts);
+					gjs->spill_curr =
+						gjs->spill_tupstore[gjs->inners[0].pds_index - 1];
+					Assert(gjs->spill_curr != NULL);
+				}
+				else if (gjs->gts.css.ss.ss_currentRelation)
 					pgstrom_rewind_scan_chunk(&gjs->gts);
 				else
 					ExecReScan(outerPlanState(gjs));
@@ -4629,10 +5153,18 @@ gpujoin_next_chunk(GpuTaskState *gts)
 		}
 
 		PERFMON_BEGIN(&gts->pfm, &tv1);
-		if (gjs->gts.css.ss.ss_currentRelation)
+		if (gjs->spill_curr)
+		{
+			/* Load the outer rows from the spill file */
+			pds = gpujoin_outer_spill_read(gjs);
+			if (!pds)
+				gjs->outer_scan_done = true;
+		}
+		else if (gjs->gts.css.ss.ss_currentRelation)
 		{
 			/* Scan and load the outer relation by itself */
-			pds = pgstrom_exec_scan_chunk(gts, pgstrom_chunk_size());
+			pds = pgstrom_exec_scan_chunk(gts,
+										  pgstrom_adaptive_chunk_size(gts));
 			if (!pds)
 				gjs->outer_scan_done = true;
 		}
@@ -4676,6 +5208,10 @@ gpujoin_next_chunk(GpuTaskState *gts)
 				}
 			}
 		}
+
+		/* Spill the outer rows for the later depth-1 chunks */
+		if (pds && gjs->outer_spill && !gjs->spill_curr)
+			gpujoin_outer_spill_write(gjs, pds);
 		PERFMON_END(&gjs->gts.pfm, time_outer_load, &tv1, &tv2);
 
 		/*
@@ -4686,7 +5222,39 @@ gpujoin_next_chunk(GpuTaskState *gts)
 		 */
 	} while (!pds);
 
-	return gpujoin_create_task(gjs, gjs->curr_pmrels, pds, NULL);
+	/*
+	 * In case of partitioned inner, every outer chunk has to be joined
+	 * with all the partitions; so we enqueue a task for each device that
+	 * owns a partition. Each device only probes the outer rows whose hash
+	 * value is in the range of its own partition.
+	 */
+	if (gjs->curr_pmrels->part_chunks)
+	{
+		pgstrom_multirels  *pmrels = gjs->curr_pmrels;
+		GpuTask			   *gtask_first = NULL;
+		GpuTask			   *gtask;
+		int					i;
+
+		for (i=0; i < gts->gcontext->num_context; i++)
+		{
+			if (!pmrels->part_chunks[i])
+				continue;
+			if (!gtask_first)
+			{
+				gtask_first = gpujoin_create_task(gjs, pmrels, pds, NULL, i);
+				continue;
+			}
+			gtask = gpujoin_create_task(gjs, pmrels, PDS_retain(pds),
+										NULL, i);
+			SpinLockAcquire(&gts->lock);
+			dlist_push_tail(&gts->pending_tasks, &gtask->chain);
+			gts->num_pending_tasks++;
+			SpinLockRelease(&gts->lock);
+		}
+		Assert(gtask_first != NULL);
+		return gtask_first;
+	}
+	return gpujoin_create_task(gjs, gjs->curr_pmrels, pds, NULL, -1);
 }
 
 /*
@@ -4774,6 +5342,56 @@ gpujoin_next_tuple(GpuTaskState *gts)
 	return slot;
 }
 
+/*
+ * gpujoin_exec_bulk
+ *
+ * Bulk-exec interface of GpuJoin. If the upper node asked for the row-
+ * format (be_row_format) and the result buffer of the current task is
+ * not consumed yet, we can hand over the result buffer to the upper node
+ * as is, instead of the tuple-by-tuple copy into another data store by
+ * pgstrom_exec_chunk_gputask(). Its length is already clamped by
+ * gpujoin_attach_result_buffer() not to exceed pgstrom_chunk_size_limit().
+ * Elsewhere, e.g, CPU fallback or partially fetched buffer, it falls back
+ * to the generic bulk-exec logic.
+ */
+static pgstrom_data_store *
+gpujoin_exec_bulk(GpuTaskState *gts, size_t chunk_size)
+{
+	pgstrom_gpujoin	   *pgjoin;
+	pgstrom_data_store *pds_dst;
+
+	if (!gts->be_row_format)
+		return pgstrom_exec_chunk_gputask(gts, chunk_size);
+
+	if (!gts->curr_task)
+	{
+		GpuTask	   *gtask = pgstrom_fetch_gputask(gts);
+
+		if (!gtask)
+			return NULL;	/* end of the scan */
+		gts->curr_task = gtask;
+		gts->curr_index = 0;
+		if (gts->cb_switch_task)
+			gts->cb_switch_task(gts, gtask);
+	}
+	pgjoin = (pgstrom_gpujoin *) gts->curr_task;
+	pds_dst = pgjoin->pds_dst;
+
+	if (pgjoin->task.cpu_fallback ||
+		gts->curr_index > 0 ||
+		pds_dst->kds->format != KDS_FORMAT_ROW ||
+		pds_dst->kds->nitems == 0)
+		return pgstrom_exec_chunk_gputask(gts, chunk_size);
+
+	/* hand over the result buffer, then detach the current task */
+	pds_dst = PDS_retain(pds_dst);
+	pgstrom_release_gputask(&pgjoin->task);
+	gts->curr_task = NULL;
+	gts->curr_index = 0;
+
+	return pds_dst;
+}
+
 /* ----------------------------------------------------------------
  *
  * Routines for CPU fallback, if kernel code returned CpuReCheck
@@ -4983,7 +5601,8 @@ gpujoin_fallback_inner_recurse(GpuJoinState *gjs,
 	bool				reload_inner_next;
 
 	Assert(depth > 0 && depth <= gjs->num_rels);
-	kds_in = pmrels->inner_chunks[depth-1]->kds;
+	kds_in = multirels_inner_chunk(pmrels, depth,
+								   pgjoin->part_index)->kds;
 	jscale = &pgjoin->kern.jscale[depth];
 
 	reload_inner_next = (istate->fallback_inner_index < 0 ||
@@ -5072,6 +5691,14 @@ gpujoin_fallback_inner_recurse(GpuJoinState *gjs,
 										   false,
 										   slot_fallback,
 										   &is_null_keys);
+				/*
+				 * Is the hash-value in range of the kds_in?
+				 * NOTE: It has to be checked prior to the NULL-keys,
+				 * because other partitions also see the same row.
+				 */
+				if (hash < kds_in->hash_min || hash > kds_in->hash_max)
+					return false;
+
 				/* all-NULL keys will never match to inner rows */
 				if (is_null_keys)
 				{
@@ -5085,10 +5712,6 @@ gpujoin_fallback_inner_recurse(GpuJoinState *gjs,
 					return false;
 				}
 
-				/* Is the hash-value in range of the kds_in? */
-				if (hash < kds_in->hash_min || hash > kds_in->hash_max)
-					return false;
-
 				khitem = KERN_HASH_FIRST_ITEM(kds_in, hash);
 				if (!khitem)
 				{
@@ -5375,6 +5998,7 @@ gpujoin_cleanup_cuda_resources(pgstrom_gpujoin *pgjoin)
 	CUDA_EVENT_DESTROY(pgjoin, ev_dma_send_stop);
 	CUDA_EVENT_DESTROY(pgjoin, ev_dma_recv_start);
 	CUDA_EVENT_DESTROY(pgjoin, ev_dma_recv_stop);
+	pgstrom_tuning_cleanup(&pgjoin->tune_main);
 
 	if (pgjoin->m_kgjoin)
 		gpuMemFree(&pgjoin->task, pgjoin->m_kgjoin);
@@ -5420,9 +6044,10 @@ gpujoin_task_complete(GpuTask *gtask)
 	GpuJoinState	   *gjs = (GpuJoinState *) gtask->gts;
 	pgstrom_perfmon	   *pfm = &gjs->gts.pfm;
 
+	/* number of tasks is counted regardless of perfmon, for gpustat */
+	pfm->num_tasks++;
 	if (pfm->enabled)
 	{
-		pfm->num_tasks++;
 		if (pgjoin->is_inner_loader)
 		{
 			CUevent ev_inner_loaded =
@@ -5487,6 +6112,10 @@ gpujoin_task_complete(GpuTask *gtask)
 		pfm->gjoin.num_minor_retry += pgjoin->kern.pfm.num_minor_retry;
 	}
 skip:
+	if (pgjoin->task.kerror.errcode == StromError_Success)
+		pgstrom_tuning_feedback(&pgjoin->task, &pgjoin->tune_main,
+								"gpujoin_main");
+
 	if (pgjoin->task.kerror.errcode == StromError_Success)
 	{
 		pgstrom_data_store *pds_src = pgjoin->pds_src;
@@ -5537,7 +6166,9 @@ skip:
 				nitems = (!pgjoin->pds_src ? 0 : pgjoin->pds_src->kds->nitems);
 			else
 			{
-				pgstrom_data_store *pds = pmrels->inner_chunks[i-1];
+				pgstrom_data_store *pds
+					= multirels_inner_chunk(pmrels, i,
+											pgjoin->part_index);
 				nitems = pds->kds->nitems;
 			}
 
@@ -5566,7 +6197,9 @@ skip:
 				{
 					for (i=0; i < gjs->num_rels; i++)
 					{
-						pgstrom_data_store *pds = pmrels->inner_chunks[i];
+						pgstrom_data_store *pds
+							= multirels_inner_chunk(pmrels, i+1,
+													pgjoin->part_index);
 
 						jscale[i+1].window_size = (pds->kds->nitems -
 												   jscale[i+1].window_base);
@@ -5587,7 +6220,8 @@ skip:
 					gpujoin_create_task(gjs,
 										pgjoin->pmrels,
 										pds_src,
-										jscale);
+										jscale,
+										pgjoin->part_index);
 
 				/* add this new task to the pending list */
 				SpinLockAcquire(&gjs->gts.lock);
@@ -5597,6 +6231,7 @@ skip:
 				SpinLockRelease(&gjs->gts.lock);
 
 				gjs->gts.pfm.gjoin.num_global_retry++;
+				gjs->gts.chunk_overflow++;
 				break;
 			}
 			Assert(jscale[i].window_base + jscale[i].window_size == nitems);
@@ -5624,7 +6259,6 @@ static void
 gpujoin_task_respond(CUstream stream, CUresult status, void *private)
 {
 	pgstrom_gpujoin	   *pgjoin = private;
-	GpuTaskState	   *gts = pgjoin->task.gts;
 
 	/* See comments in pgstrom_respond_gpuscan() */
 	if (status == CUDA_ERROR_INVALID_CONTEXT || !IsTransactionState())
@@ -5650,25 +6284,10 @@ gpujoin_task_respond(CUstream stream, CUresult status, void *private)
 	}
 
 	/*
-	 * Remove the GpuTask from the running_tasks list, and attach it
-	 * on the completed_tasks list again. Note that this routine may
-	 * be called by CUDA runtime, prior to attachment of GpuTask on
-	 * the running_tasks by cuda_control.c.
+	 * Informs completion of the GpuTask to the backend; it shall be
+	 * moved from the running_tasks to the completed_tasks later.
 	 */
-	SpinLockAcquire(&gts->lock);
-	if (pgjoin->task.chain.prev && pgjoin->task.chain.next)
-	{
-		dlist_delete(&pgjoin->task.chain);
-		gts->num_running_tasks--;
-	}
-	if (pgjoin->task.kerror.errcode == StromError_Success)
-		dlist_push_tail(&gts->completed_tasks, &pgjoin->task.chain);
-	else
-		dlist_push_head(&gts->completed_tasks, &pgjoin->task.chain);
-	gts->num_completed_tasks++;
-	SpinLockRelease(&gts->lock);
-
-	SetLatch(&MyProc->procLatch);
+	pgstrom_complete_gputask(&pgjoin->task);
 }
 
 static bool
@@ -5743,6 +6362,17 @@ __gpujoin_task_process(pgstrom_gpujoin *pgjoin)
 
 	/* inner multi relations */
 	multirels_send_buffer(pmrels, &pgjoin->task);
+
+	/*
+	 * Block size of the child kernels launched by gpujoin_main is shrunk
+	 * according to the autotuner. Because kern_gpujoin carries the hint,
+	 * the trial measurement also contains the DMA send of outer chunk,
+	 * but it is proportional to the number of items, so harmless.
+	 */
+	pgstrom_tuning_begin(&pgjoin->task, &pgjoin->tune_main,
+						 "gpujoin_main", pgjoin->kern.jscale[0].window_size);
+	pgjoin->kern.block_size_shift = pgjoin->tune_main.block_shift;
+
 	/* kern_gpujoin + static portion of kern_resultbuf */
 	length = KERN_GPUJOIN_HEAD_LENGTH(&pgjoin->kern);
 	rc = cuMemcpyHtoDAsync(pgjoin->m_kgjoin,
@@ -5811,6 +6441,7 @@ __gpujoin_task_process(pgstrom_gpujoin *pgjoin)
 						NULL);
 	if (rc != CUDA_SUCCESS)
 		elog(ERROR, "failed on cuLaunchKernel: %s", errorText(rc));
+	pgstrom_tuning_end(&pgjoin->task, &pgjoin->tune_main);
 	gjs->gts.pfm.gjoin.num_kern_main++;
 
 	CUDA_EVENT_RECORD(pgjoin, ev_dma_recv_start);
@@ -5960,20 +6591,142 @@ add_extra_randomness(pgstrom_data_store *pds)
 }
 
 /*
- * gpujoin_inner_unload - it release inner relations and its data stores.
+ * gpujoin_inner_heavy_hitters
  *
- * TODO: We like to retain a part of inner relations if it is not
- * parametalized.
+ * It detects heavy-hitter hash keys of the inner hash table, then moves
+ * the entries of each key to the head of row index with sequential rowid.
+ * Because hash-chain is built in order of rowid, these entries are always
+ * located on the tail of the chain, and kern_hashitem->heavy_base tells
+ * the range of rowid. Then, gpujoin_exec_hashjoin processes outer rows that
+ * reference heavy-hitter by all the threads in a block, instead of a long
+ * chain walk by a particular thread.
+ * It has to be called prior to PDS_build_hashtable().
  */
+static int
+compare_hash_value(const void *p1, const void *p2)
+{
+	cl_uint		hash1 = *((const cl_uint *) p1);
+	cl_uint		hash2 = *((const cl_uint *) p2);
+
+	if (hash1 < hash2)
+		return -1;
+	if (hash1 > hash2)
+		return 1;
+	return 0;
+}
+
 static void
-gpujoin_inner_unload(GpuJoinState *gjs, bool needs_rescan)
+gpujoin_inner_heavy_hitters(pgstrom_data_store *pds)
 {
-	ListCell   *lc;
-	cl_int		i;
+	kern_data_store	   *kds = pds->kds;
+	cl_uint			   *row_index = KERN_DATA_STORE_ROWINDEX(kds);
+	cl_uint			   *new_index;
+	cl_uint			   *samples;
+	cl_uint				nsamples;
+	cl_uint				stride;
+	cl_uint				heavy_hash[2 * GPUJOIN_HEAVY_HITTER_MAX_KEYS];
+	cl_uint				heavy_count[2 * GPUJOIN_HEAVY_HITTER_MAX_KEYS];
+	cl_uint				heavy_base[2 * GPUJOIN_HEAVY_HITTER_MAX_KEYS];
+	cl_uint				nheavy = 0;
+	cl_uint				i, j, k;
+
+	Assert(kds->format == KDS_FORMAT_HASH && kds->nslots == 0);
+	if (!enable_gpujoin_heavy_hitter ||
+		kds->nitems < 4 * GPUJOIN_HEAVY_HITTER_MIN_NITEMS)
+		return;
 
-	for (i=0; i < gjs->num_rels; i++)
-	{
-		innerState *istate = &gjs->inners[i];
+	/*
+	 * Pick up candidates by sampling; keys which have half of the threshold
+	 * in the samples at least.
+	 */
+	stride = Max(kds->nitems / GPUJOIN_HEAVY_HITTER_NSAMPLES, 1);
+	samples = palloc(sizeof(cl_uint) * (kds->nitems / stride + 1));
+	for (i=0, nsamples=0; i < kds->nitems; i += stride)
+		samples[nsamples++] = KERN_DATA_STORE_HASHITEM(kds, i)->hash;
+	qsort(samples, nsamples, sizeof(cl_uint), compare_hash_value);
+
+	for (i=0; i < nsamples && nheavy < lengthof(heavy_hash); i = j)
+	{
+		for (j=i+1; j < nsamples && samples[j] == samples[i]; j++);
+		if ((j - i) * stride >= GPUJOIN_HEAVY_HITTER_MIN_NITEMS / 2)
+		{
+			heavy_hash[nheavy] = samples[i];
+			heavy_count[nheavy] = 0;
+			nheavy++;
+		}
+	}
+	pfree(samples);
+	if (nheavy == 0)
+		return;
+
+	/* exact count of the candidates; heavy_hash[] is already sorted */
+	for (i=0; i < kds->nitems; i++)
+	{
+		cl_uint		hash = KERN_DATA_STORE_HASHITEM(kds, i)->hash;
+		cl_uint	   *hitem = bsearch(&hash, heavy_hash, nheavy,
+									sizeof(cl_uint), compare_hash_value);
+		if (hitem)
+			heavy_count[hitem - heavy_hash]++;
+	}
+
+	/* assign the range of rowid for each heavy-hitter */
+	for (i=0, k=0; i < nheavy; i++)
+	{
+		if (heavy_count[i] >= GPUJOIN_HEAVY_HITTER_MIN_NITEMS &&
+			i < GPUJOIN_HEAVY_HITTER_MAX_KEYS)
+		{
+			heavy_base[i] = k;
+			k += heavy_count[i];
+		}
+		else
+			heavy_base[i] = UINT_MAX;	/* not a heavy-hitter */
+		heavy_count[i] = 0;
+	}
+	if (k == 0)
+		return;
+
+	/* OK, reorder the row index */
+	new_index = palloc(sizeof(cl_uint) * kds->nitems);
+	for (i=0; i < kds->nitems; i++)
+	{
+		kern_hashitem  *khitem = KERN_DATA_STORE_HASHITEM(kds, i);
+		cl_uint		   *hitem = bsearch(&khitem->hash, heavy_hash, nheavy,
+										sizeof(cl_uint), compare_hash_value);
+
+		Assert(khitem->rowid == i);
+		if (hitem && heavy_base[hitem - heavy_hash] != UINT_MAX)
+		{
+			j = hitem - heavy_hash;
+			khitem->rowid = heavy_base[j] + heavy_count[j]++;
+			khitem->heavy_base = heavy_base[j] + 1;
+		}
+		else
+		{
+			khitem->rowid = k++;
+			khitem->heavy_base = 0;
+		}
+		new_index[khitem->rowid] = row_index[i];
+	}
+	Assert(k == kds->nitems);
+	memcpy(row_index, new_index, sizeof(cl_uint) * kds->nitems);
+	pfree(new_index);
+}
+
+/*
+ * gpujoin_inner_unload - it release inner relations and its data stores.
+ *
+ * TODO: We like to retain a part of inner relations if it is not
+ * parametalized.
+ */
+static void
+gpujoin_inner_unload(GpuJoinState *gjs, bool needs_rescan)
+{
+	ListCell   *lc;
+	cl_int		i;
+
+	for (i=0; i < gjs->num_rels; i++)
+	{
+		innerState *istate = &gjs->inners[i];
 
 		/*
 		 * If chgParam of subnode is not null then plan will be
@@ -5989,6 +6742,11 @@ gpujoin_inner_unload(GpuJoinState *gjs, bool needs_rescan)
 		istate->consumed = 0;
 		istate->ntuples = 0;
 		istate->tupstore = NULL;
+		if (istate->bloom_filter)
+			pfree(istate->bloom_filter);
+		istate->bloom_filter = NULL;
+		istate->bloom_nbits = 0;
+		istate->bloom_nitems = 0;
 	}
 	gjs->inner_preloaded = false;
 }
@@ -6105,6 +6863,7 @@ gpujoin_inner_hash_preload_TS(GpuJoinState *gjs,
 	List			   *hash_max_list = NIL;
 	Size				curr_size = 0;
 	Size				curr_nitems = 0;
+	Size				part_size = 0;
 	Size				kds_length;
 	pg_crc32			hash_min;
 	pg_crc32			hash_max;
@@ -6115,6 +6874,17 @@ gpujoin_inner_hash_preload_TS(GpuJoinState *gjs,
 	/* tuplestore must be built */
 	Assert(tupstore != NULL);
 
+	/*
+	 * In case of partitioned inner, hash-table is split into (at least)
+	 * number of devices, with almost same size.
+	 */
+	if (gjs->inner_partitioned && istate == &gjs->inners[0])
+	{
+		for (i=0; i < istate->hgram_width; i++)
+			part_size += istate->hgram_size[i];
+		part_size /= gjs->gts.gcontext->num_context;
+	}
+
 	hash_min = 0;
 	for (i=0; i < istate->hgram_width; i++)
 	{
@@ -6125,7 +6895,8 @@ gpujoin_inner_hash_preload_TS(GpuJoinState *gjs,
 		next_length = KDS_CALCULATE_HASH_LENGTH(scan_desc->natts,
 												curr_nitems + next_nitems,
 												curr_size + next_size);
-		if (next_length > istate->pds_limit)
+		if (next_length > istate->pds_limit ||
+			(part_size > 0 && curr_size >= part_size))
 		{
 			if (curr_size == 0)
 				elog(ERROR, "Too extreme hash-key distribution");
@@ -6257,6 +7028,7 @@ next:
 		{
 			pgstrom_data_store *pds = lfirst(lc);
 			add_extra_randomness(pds);
+			gpujoin_inner_heavy_hitters(pds);
 			PDS_build_hashtable(pds);
 		}
 		return false;
@@ -6274,6 +7046,17 @@ next:
 						 istate->join_type == JOIN_LEFT))
 		goto next;
 
+	/* Update bloom filter, if any */
+	if (istate->bloom_filter && !is_null_keys)
+	{
+		cl_uint	   *bloom = istate->bloom_filter;
+		cl_uint		nbits = istate->bloom_nbits;
+
+		BLOOM_FILTER_SET(bloom, BLOOM_FILTER_HASH1(hash, nbits));
+		BLOOM_FILTER_SET(bloom, BLOOM_FILTER_HASH2(hash, nbits));
+		istate->bloom_nitems++;
+	}
+
 	scan_desc = scan_slot->tts_tupleDescriptor;
 	if (istate->pds_list != NIL)
 		pds_hash = (pgstrom_data_store *) llast(istate->pds_list);
@@ -6320,8 +7103,13 @@ retry:
 													   istate->consumed +
 													   consumption))
 	{
-		if (istate->join_type == JOIN_INNER ||
-			istate->join_type == JOIN_LEFT)
+		/*
+		 * NOTE: Grace hash-join also needs the depth-1 chunks to be
+		 * partitioned by hash-value, to spill the outer rows.
+		 */
+		if ((istate->join_type == JOIN_INNER ||
+			 istate->join_type == JOIN_LEFT) &&
+			!(enable_gpujoin_spill && istate == &gjs->inners[0]))
 		{
 			PDS_shrink_size(pds_hash);
 
@@ -6381,6 +7169,79 @@ retry:
 	return true;
 }
 
+/*
+ * gpujoin_inner_range_sort
+ *
+ * It sorts the inner rows of range-join by the range key. Rows with NULL
+ * key are removed from the row index, because they never match to any
+ * outer rows in INNER or LEFT OUTER JOIN.
+ */
+typedef struct
+{
+	Datum		value;
+	cl_uint		offset;
+} range_sort_item;
+
+static int
+compare_range_sort_item(const void *p1, const void *p2, void *arg)
+{
+	const range_sort_item *item1 = p1;
+	const range_sort_item *item2 = p2;
+
+	return ApplySortComparator(item1->value, false,
+							   item2->value, false,
+							   (SortSupport) arg);
+}
+
+static void
+gpujoin_inner_range_sort(innerState *istate, pgstrom_data_store *pds)
+{
+	kern_data_store	   *kds = pds->kds;
+	cl_uint			   *row_index = KERN_DATA_STORE_ROWINDEX(kds);
+	TupleDesc			tupdesc;
+	SortSupportData		ssup;
+	range_sort_item	   *items;
+	HeapTupleData		tuple;
+	cl_uint				i, nitems = 0;
+
+	Assert(kds->format == KDS_FORMAT_ROW);
+	if (kds->nitems == 0)
+		return;
+	tupdesc = istate->state->ps_ResultTupleSlot->tts_tupleDescriptor;
+
+	memset(&ssup, 0, sizeof(SortSupportData));
+	ssup.ssup_cxt = CurrentMemoryContext;
+	ssup.ssup_collation = InvalidOid;
+	ssup.ssup_nulls_first = false;
+	ssup.ssup_attno = istate->range_attno;
+	PrepareSortSupportFromOrderingOp(istate->range_sortop, &ssup);
+
+	items = palloc(sizeof(range_sort_item) * kds->nitems);
+	for (i=0; i < kds->nitems; i++)
+	{
+		kern_tupitem   *tupitem = KERN_DATA_STORE_TUPITEM(kds, i);
+		bool			isnull;
+
+		tuple.t_len = tupitem->t_len;
+		tuple.t_self = tupitem->t_self;
+		tuple.t_tableOid = InvalidOid;
+		tuple.t_data = &tupitem->htup;
+		items[nitems].value = heap_getattr(&tuple, istate->range_attno,
+										   tupdesc, &isnull);
+		if (isnull)
+			continue;
+		items[nitems].offset = row_index[i];
+		nitems++;
+	}
+	qsort_arg(items, nitems, sizeof(range_sort_item),
+			  compare_range_sort_item, &ssup);
+
+	for (i=0; i < nitems; i++)
+		row_index[i] = items[i].offset;
+	kds->nitems = nitems;
+	pfree(items);
+}
+
 /*
  * gpujoin_inner_heap_preload
  *
@@ -6421,7 +7282,12 @@ gpujoin_inner_heap_preload(GpuJoinState *gjs,
 		}
 		/* add extra randomness for better key distribution */
 		foreach (lc, istate->pds_list)
-			add_extra_randomness((pgstrom_data_store *) lfirst(lc));
+		{
+			pgstrom_data_store *pds = lfirst(lc);
+			add_extra_randomness(pds);
+			if (OidIsValid(istate->range_sortop))
+				gpujoin_inner_range_sort(istate, pds);
+		}
 		return false;
 	}
 	scan_desc = scan_slot->tts_tupleDescriptor;
@@ -6516,6 +7382,7 @@ gpujoin_create_multirels(GpuJoinState *gjs)
 		STROMALIGN(sizeof(CUdeviceptr) * gcontext->num_context) +
 		STROMALIGN(sizeof(CUevent) * gcontext->num_context) +
 		STROMALIGN(sizeof(CUdeviceptr) * gcontext->num_context) +
+		STROMALIGN(sizeof(pgstrom_data_store *) * gcontext->num_context) +
 		2 * sizeof(cl_bool) * STROMALIGN(ojmap_length);
 
 	pmrels = MemoryContextAllocZero(gcontext->memcxt, alloc_length);
@@ -6535,6 +7402,9 @@ gpujoin_create_multirels(GpuJoinState *gjs)
 	pos += STROMALIGN(sizeof(CUevent) * gcontext->num_context);
 	pmrels->m_ojmaps = (CUdeviceptr *) pos;
 	pos += STROMALIGN(sizeof(CUdeviceptr) * gcontext->num_context);
+	if (gjs->inner_partitioned)
+		pmrels->part_chunks = (pgstrom_data_store **) pos;
+	pos += STROMALIGN(sizeof(pgstrom_data_store *) * gcontext->num_context);
 	pmrels->host_ojmaps = (cl_bool *)(ojmap_length > 0 ? pos : NULL);
 
 	memcpy(pmrels->kern.pg_crc32_table,
@@ -6542,6 +7412,8 @@ gpujoin_create_multirels(GpuJoinState *gjs)
 		   sizeof(cl_uint) * 256);
 	pmrels->kern.nrels = gjs->num_rels;
 	pmrels->kern.ojmap_length = 0;
+	pmrels->kern.bloom_offset = 0;
+	pmrels->kern.bloom_nbits = 0;
 	memset(pmrels->kern.chunks,
 		   0,
 		   offsetof(pgstrom_multirels, kern.chunks[gjs->num_rels]) -
@@ -6554,8 +7426,12 @@ gpujoin_create_multirels(GpuJoinState *gjs)
 											   istate->pds_index - 1);
 
 		pmrels->inner_chunks[i] = PDS_retain(pds);
-		pmrels->kern.chunks[i].chunk_offset = pmrels->usage_length;
-		pmrels->usage_length += STROMALIGN(pds->kds->length);
+		/* partitioned chunk shall be located on the tail */
+		if (i > 0 || !pmrels->part_chunks)
+		{
+			pmrels->kern.chunks[i].chunk_offset = pmrels->usage_length;
+			pmrels->usage_length += STROMALIGN(pds->kds->length);
+		}
 
 		if (!istate->hash_outer_keys)
 			pmrels->kern.chunks[i].is_nestloop = true;
@@ -6571,11 +7447,197 @@ gpujoin_create_multirels(GpuJoinState *gjs)
 		if (istate->join_type == JOIN_LEFT ||
 			istate->join_type == JOIN_FULL)
 			pmrels->kern.chunks[i].left_outer = true;
+		if (OidIsValid(istate->range_sortop))
+			pmrels->kern.chunks[i].is_rangejoin = true;
 	}
 	Assert(pmrels->kern.ojmap_length == ojmap_length);
+
+	/* bloom filter of depth-1, if any */
+	if (gjs->inners[0].bloom_filter)
+	{
+		pmrels->kern.bloom_offset = pmrels->usage_length;
+		pmrels->kern.bloom_nbits = gjs->inners[0].bloom_nbits;
+		pmrels->usage_length += STROMALIGN(gjs->inners[0].bloom_nbits /
+										   BITS_PER_BYTE);
+	}
+
+	/*
+	 * Assignment of the inner partitions for each CUDA context. The first
+	 * one is also kept in inner_chunks[0], so an extra reference is taken
+	 * on the partitions for the other contexts only.
+	 */
+	if (pmrels->part_chunks)
+	{
+		innerState *istate = &gjs->inners[0];
+
+		pmrels->kern.chunks[0].chunk_offset = pmrels->usage_length;
+		for (i=0; i < gcontext->num_context; i++)
+		{
+			int		index = istate->pds_index - 1 + i;
+
+			if (index >= list_length(istate->pds_list))
+				pmrels->part_chunks[i] = NULL;
+			else if (i == 0)
+				pmrels->part_chunks[i] = pmrels->inner_chunks[0];
+			else
+				pmrels->part_chunks[i] =
+					PDS_retain(list_nth(istate->pds_list, index));
+		}
+	}
 	return pmrels;
 }
 
+/*
+ * gpujoin_bloom_filter_available
+ *
+ * It checks whether bloom filter of the depth-1 inner hash values can be
+ * applied on the outer scan. Only INNER or RIGHT OUTER JOIN can drop the
+ * outer rows without inner pair.
+ */
+static bool
+gpujoin_bloom_filter_available(GpuJoinState *gjs)
+{
+	innerState *istate = &gjs->inners[0];
+
+	if (!enable_gpujoin_bloom || istate->hash_outer_keys == NIL)
+		return false;
+	return (istate->join_type == JOIN_INNER ||
+			istate->join_type == JOIN_RIGHT);
+}
+
+/*
+ * gpujoin_inner_cache_ident
+ *
+ * It makes an identifier of the inner hash table on the shared inner hash
+ * cache, or returns NULL if not cacheable. Its contents have to be fully
+ * determined by the identifier and snapshot, so we only allow a simple
+ * scan on a relation without parameters and mutable functions.
+ */
+static char *
+gpujoin_inner_cache_ident(GpuJoinState *gjs,
+						  innerState *istate,
+						  List *hash_inner_keys)
+{
+	EState		   *estate = gjs->gts.css.ss.ps.state;
+	Plan		   *plan = istate->state->plan;
+	List		   *index_quals = NIL;
+	RangeTblEntry  *rte;
+	StringInfoData	str;
+
+	if (!pgstrom_icache_available())
+		return NULL;
+	/* parametalized inner shall be rebuilt on rescan */
+	if (plan->allParam != NULL || plan->initPlan != NIL)
+		return NULL;
+
+	switch (nodeTag(plan))
+	{
+		case T_SeqScan:
+			break;
+		case T_IndexScan:
+			index_quals = ((IndexScan *) plan)->indexqualorig;
+			break;
+		case T_IndexOnlyScan:
+			index_quals = ((IndexOnlyScan *) plan)->indexqual;
+			break;
+		default:
+			return NULL;
+	}
+	rte = rt_fetch(((Scan *) plan)->scanrelid, estate->es_range_table);
+	if (rte->rtekind != RTE_RELATION)
+		return NULL;
+
+	if (contain_mutable_functions((Node *) plan->targetlist) ||
+		contain_mutable_functions((Node *) plan->qual) ||
+		contain_mutable_functions((Node *) index_quals) ||
+		contain_mutable_functions((Node *) hash_inner_keys))
+		return NULL;
+
+	initStringInfo(&str);
+	appendStringInfo(&str, "relid=%u join_type=%d ",
+					 rte->relid, (int) istate->join_type);
+	appendStringInfoString(&str, nodeToString(plan));
+	appendStringInfoChar(&str, ' ');
+	appendStringInfoString(&str, nodeToString(hash_inner_keys));
+	istate->icache_relid = rte->relid;
+
+	return str.data;
+}
+
+/*
+ * gpujoin_inner_cache_usable
+ *
+ * It checks whether the inner hash table of the depth can be picked up
+ * from, or saved to, the shared inner hash cache. Partitioned depth-1 is
+ * always built per execution, because it depends on number of devices.
+ */
+static bool
+gpujoin_inner_cache_usable(GpuJoinState *gjs, int depth)
+{
+	innerState *istate = &gjs->inners[depth - 1];
+
+	if (!istate->icache_ident)
+		return false;
+	if (gjs->inner_partitioned && depth == 1)
+		return false;
+	return true;
+}
+
+/*
+ * gpujoin_inner_cache_bloom
+ *
+ * It reconstructs the bloom filter from the hash values of the inner hash
+ * table picked up from the shared inner hash cache.
+ */
+static void
+gpujoin_inner_cache_bloom(innerState *istate, kern_data_store *kds)
+{
+	cl_uint	   *bloom = istate->bloom_filter;
+	cl_uint		nbits = istate->bloom_nbits;
+	cl_uint	   *row_index = KERN_DATA_STORE_ROWINDEX(kds);
+	cl_uint		i;
+
+	Assert(kds->format == KDS_FORMAT_HASH);
+	for (i=0; i < kds->nitems; i++)
+	{
+		kern_hashitem  *khitem = (kern_hashitem *)
+			((char *)kds + row_index[i] - offsetof(kern_hashitem, t));
+
+		BLOOM_FILTER_SET(bloom, BLOOM_FILTER_HASH1(khitem->hash, nbits));
+		BLOOM_FILTER_SET(bloom, BLOOM_FILTER_HASH2(khitem->hash, nbits));
+	}
+	istate->bloom_nitems = kds->nitems;
+}
+
+/*
+ * gpujoin_inner_partition_available
+ *
+ * It checks whether the depth-1 hash table can be partitioned across the
+ * multiple devices, instead of the replication.
+ */
+static bool
+gpujoin_inner_partition_available(GpuJoinState *gjs)
+{
+	int		i;
+
+	if (!enable_gpujoin_partition || gjs->gts.gcontext->num_context < 2)
+		return false;
+	/* only hash-join can be partitioned by hash-value */
+	if (gjs->inners[0].hash_inner_keys == NIL)
+		return false;
+	/*
+	 * RIGHT/FULL OUTER JOIN needs outer-join map to be merged across the
+	 * devices, it assumes all the devices have identical inner buffer.
+	 */
+	for (i=0; i < gjs->num_rels; i++)
+	{
+		if (gjs->inners[i].join_type == JOIN_RIGHT ||
+			gjs->inners[i].join_type == JOIN_FULL)
+			return false;
+	}
+	return true;
+}
+
 /*
  * gpujoin_inner_preload
  *
@@ -6587,10 +7649,13 @@ static bool
 gpujoin_inner_preload(GpuJoinState *gjs)
 {
 	innerState	  **istate_buf;
-	cl_int			istate_nums = gjs->num_rels;
+	cl_int			istate_nums;
 	Size			total_limit;
 	Size			total_usage;
 	bool			kmrels_size_fixed = false;
+	Size			part_usage = 0;
+	Snapshot		snapshot = gjs->gts.css.ss.ps.state->es_snapshot;
+	bool			use_icache = pgstrom_icache_enabled(snapshot);
 	int				i;
 	struct timeval	tv1, tv2;
 
@@ -6600,12 +7665,85 @@ gpujoin_inner_preload(GpuJoinState *gjs)
 	 * Half of the max allocatable GPU memory (and minus some margin) is
 	 * the current hard limit of the inner relations buffer.
 	 */
-	total_limit = gpuMemMaxAllocSize() / 2 - BLCKSZ * gjs->num_rels;
+	total_limit = gpujoin_inner_buffer_limit(gjs->num_rels);
 	total_usage = STROMALIGN(offsetof(kern_multirels,
 									  chunks[gjs->num_rels]));
+
+	/*
+	 * In case of partitioned inner, depth-1 is always loaded to the
+	 * tuple-store first, then split by hash-value into the partitions
+	 * for each device. It can use half of the buffer (or entire buffer
+	 * if no other inner relations), for each device.
+	 */
+	gjs->inner_partitioned = gpujoin_inner_partition_available(gjs);
+	if (gjs->inner_partitioned)
+	{
+		innerState *istate = &gjs->inners[0];
+
+		if (gjs->num_rels > 1)
+		{
+			istate->pds_limit = total_limit / 2;
+			total_limit -= istate->pds_limit;
+		}
+		else
+			istate->pds_limit = total_limit;
+		istate->tupstore = tuplestore_begin_heap(false, false, work_mem);
+	}
+
+	/*
+	 * Bloom filter of the depth-1 inner hash values, to drop the outer
+	 * rows which never match prior to the join. Its size is determined
+	 * by the estimated number of inner rows; 8 bits per entry.
+	 */
+	if (gpujoin_bloom_filter_available(gjs))
+	{
+		innerState *istate = &gjs->inners[0];
+		double		plan_rows = Max(istate->state->plan->plan_rows, 1.0);
+		int			nshift = get_next_log2((Size)(8.0 * plan_rows));
+
+		nshift = Max(Min(nshift, 28), 16);
+		istate->bloom_nbits = (1U << nshift);
+		istate->bloom_filter = palloc0(istate->bloom_nbits / BITS_PER_BYTE);
+		istate->bloom_nitems = 0;
+	}
+
+	/*
+	 * Pick up the inner hash tables already built by the equivalent inner
+	 * plan under the equivalent snapshot, from the shared inner hash cache.
+	 * Rest of the depths are loaded from the inner relations.
+	 */
 	istate_buf = palloc0(sizeof(innerState *) * gjs->num_rels);
-	for (i=0; i < istate_nums; i++)
-		istate_buf[i] = &gjs->inners[i];
+	istate_nums = 0;
+	for (i=0; i < gjs->num_rels; i++)
+	{
+		innerState *istate = &gjs->inners[i];
+
+		istate->icache_hit = false;
+		if (use_icache && gpujoin_inner_cache_usable(gjs, i+1))
+		{
+			pgstrom_data_store *pds_hash
+				= pgstrom_icache_lookup(gjs->gts.gcontext,
+										istate->icache_ident,
+										snapshot);
+			if (pds_hash)
+			{
+				kern_data_store *kds = pds_hash->kds;
+
+				istate->pds_list = list_make1(pds_hash);
+				istate->ntuples = kds->nitems;
+				istate->consumed = (KDS_CALCULATE_HEAD_LENGTH(kds->ncols) +
+									kds->usage);
+				istate->icache_hit = true;
+				total_usage += KDS_CALCULATE_HASH_LENGTH(kds->ncols,
+														 kds->nitems,
+														 kds->usage);
+				if (istate->bloom_filter)
+					gpujoin_inner_cache_bloom(istate, kds);
+				continue;
+			}
+		}
+		istate_buf[istate_nums++] = &gjs->inners[i];
+	}
 
 	/* load tuples from the inner relations with round-robin policy */
 	while (istate_nums > 0)
@@ -6613,10 +7751,14 @@ gpujoin_inner_preload(GpuJoinState *gjs)
 		for (i=0; i < istate_nums; i++)
 		{
 			innerState *istate = istate_buf[i];
+			Size	   *p_usage = &total_usage;
+
+			if (gjs->inner_partitioned && istate == &gjs->inners[0])
+				p_usage = &part_usage;
 
 			if (!(istate->hash_inner_keys != NIL
-				  ? gpujoin_inner_hash_preload(gjs, istate, &total_usage)
-				  : gpujoin_inner_heap_preload(gjs, istate, &total_usage)))
+				  ? gpujoin_inner_hash_preload(gjs, istate, p_usage)
+				  : gpujoin_inner_heap_preload(gjs, istate, p_usage)))
 			{
 				memmove(istate_buf + i,
 						istate_buf + i + 1,
@@ -6634,10 +7776,14 @@ gpujoin_inner_preload(GpuJoinState *gjs)
 			 */
 			for (i=0; i < gjs->num_rels; i++)
 			{
-				innerState	   *istate = istate_buf[i];
+				innerState	   *istate = &gjs->inners[i];
 				TupleTableSlot *scan_slot = istate->state->ps_ResultTupleSlot;
 				TupleDesc	 	scan_desc = scan_slot->tts_tupleDescriptor;
 
+				/* partitioned inner has its own limitation */
+				if (gjs->inner_partitioned && i == 0)
+					continue;
+
 				gjs->inners[i].pds_limit =
 					(istate->hash_inner_keys != NIL
 					 ? KDS_CALCULATE_HASH_LENGTH(scan_desc->natts,
@@ -6652,6 +7798,23 @@ gpujoin_inner_preload(GpuJoinState *gjs)
 	}
 	PERFMON_END(&gjs->gts.pfm, time_inner_load, &tv1, &tv2);
 
+	/* save the inner hash tables built in this time, if cacheable */
+	if (use_icache)
+	{
+		for (i=0; i < gjs->num_rels; i++)
+		{
+			innerState *istate = &gjs->inners[i];
+
+			if (!istate->icache_hit &&
+				gpujoin_inner_cache_usable(gjs, i+1) &&
+				list_length(istate->pds_list) == 1)
+				pgstrom_icache_insert(istate->icache_ident,
+									  snapshot,
+									  istate->icache_relid,
+									  linitial(istate->pds_list));
+		}
+	}
+
 	/*
 	 * XXX - It is ideal case; all the inner chunk can be loaded to
 	 * a single multi-relations buffer.
@@ -6659,7 +7822,11 @@ gpujoin_inner_preload(GpuJoinState *gjs)
 	if (!kmrels_size_fixed)
 	{
 		for (i=0; i < gjs->num_rels; i++)
+		{
+			if (gjs->inner_partitioned && i == 0)
+				continue;
 			gjs->inners[i].pds_limit = gjs->inners[i].consumed;
+		}
 	}
 	pfree(istate_buf);
 
@@ -6694,6 +7861,18 @@ gpujoin_inner_preload(GpuJoinState *gjs)
 		Assert(nbatches_exec > 0);
 		gjs->inners[i].nbatches_exec = nbatches_exec;
 	}
+
+	/*
+	 * Bloom filter is not worth to apply if too many entries than the
+	 * estimation, because false-positive ratio gets too high.
+	 */
+	if (gjs->inners[0].bloom_filter &&
+		gjs->inners[0].bloom_nitems * 4 > gjs->inners[0].bloom_nbits)
+	{
+		pfree(gjs->inners[0].bloom_filter);
+		gjs->inners[0].bloom_filter = NULL;
+		gjs->inners[0].bloom_nbits = 0;
+	}
 	return true;
 }
 
@@ -6725,10 +7904,15 @@ gpujoin_inner_getnext(GpuJoinState *gjs)
 		for (i=gjs->num_rels; i > 0; i--)
 		{
 			innerState	   *istate = &gjs->inners[i-1];
+			int				nsteps = 1;
+
+			/* partitioned inner moves to the next set of partitions */
+			if (gjs->inner_partitioned && i == 1)
+				nsteps = gjs->gts.gcontext->num_context;
 
-			if (istate->pds_index < list_length(istate->pds_list))
+			if (istate->pds_index + nsteps <= list_length(istate->pds_list))
 			{
-				istate->pds_index++;
+				istate->pds_index += nsteps;
 				for (j=i; j < gjs->num_rels; j++)
 					gjs->inners[j].pds_index = 1;
 				break;
@@ -6744,6 +7928,233 @@ gpujoin_inner_getnext(GpuJoinState *gjs)
 	return gpujoin_create_multirels(gjs);
 }
 
+/*
+ * gpujoin_outer_spill_available
+ *
+ * It checks whether the outer rows can be spilled according to the hash-
+ * value range of the depth-1 chunks, instead of rescan of the outer
+ * relation for each chunk.
+ */
+static bool
+gpujoin_outer_spill_available(GpuJoinState *gjs)
+{
+	innerState *istate = &gjs->inners[0];
+	pg_crc32	hash_min = 0;
+	ListCell   *lc;
+	int			i;
+
+	if (!enable_gpujoin_spill || gjs->inner_partitioned)
+		return false;
+	if (istate->hash_outer_keys == NIL || list_length(istate->pds_list) < 2)
+		return false;
+
+	/* depth-1 chunks have to be strictly partitioned by hash-value */
+	foreach (lc, istate->pds_list)
+	{
+		kern_data_store *kds = ((pgstrom_data_store *) lfirst(lc))->kds;
+
+		if (kds->hash_min != hash_min ||
+			(lnext(lc) != NULL
+			 ? kds->hash_max == UINT_MAX
+			 : kds->hash_max != UINT_MAX))
+			return false;
+		hash_min = kds->hash_max + 1;
+	}
+
+	/*
+	 * Spilled outer rows are read only once for each depth-1 chunk, so
+	 * deeper depth must have a single chunk. Also, RIGHT/FULL OUTER JOIN
+	 * on the deeper depth needs all the outer rows for each window.
+	 */
+	for (i=1; i < gjs->num_rels; i++)
+	{
+		if (list_length(gjs->inners[i].pds_list) != 1 ||
+			gjs->inners[i].join_type == JOIN_RIGHT ||
+			gjs->inners[i].join_type == JOIN_FULL)
+			return false;
+	}
+	return true;
+}
+
+/*
+ * gpujoin_outer_spill_begin
+ *
+ * It sets up the spill files for each depth-1 chunk (except for the first
+ * one being joined with the outer scan), if Grace hash-join is available.
+ */
+static void
+gpujoin_outer_spill_begin(GpuJoinState *gjs)
+{
+	innerState *istate = &gjs->inners[0];
+	ListCell   *lc;
+	int			i;
+
+	gpujoin_outer_spill_end(gjs);
+	if (!gpujoin_outer_spill_available(gjs))
+		return;
+
+	if (!gjs->spill_slot)
+	{
+		TupleDesc	tupdesc;
+
+		if (gjs->gts.css.ss.ss_currentRelation)
+			tupdesc = RelationGetDescr(gjs->gts.css.ss.ss_currentRelation);
+		else
+			tupdesc = ExecGetResultType(outerPlanState(gjs));
+		gjs->spill_slot = MakeSingleTupleTableSlot(tupdesc);
+		gjs->spill_hslot = MakeSingleTupleTableSlot(gjs->slot_fallback->
+													tts_tupleDescriptor);
+	}
+	gjs->spill_nparts = list_length(istate->pds_list);
+	gjs->spill_hash_max = palloc(sizeof(pg_crc32) * gjs->spill_nparts);
+	gjs->spill_tupstore = palloc0(sizeof(Tuplestorestate *) *
+								  gjs->spill_nparts);
+	i = 0;
+	foreach (lc, istate->pds_list)
+	{
+		pgstrom_data_store *pds = lfirst(lc);
+
+		gjs->spill_hash_max[i] = pds->kds->hash_max;
+		if (i > 0)
+			gjs->spill_tupstore[i] = tuplestore_begin_heap(false, false,
+														   work_mem);
+		i++;
+	}
+	gjs->outer_spill = true;
+}
+
+/*
+ * gpujoin_outer_spill_end
+ *
+ * It releases the spill files, if any.
+ */
+static void
+gpujoin_outer_spill_end(GpuJoinState *gjs)
+{
+	int		i;
+
+	if (gjs->spill_tupstore)
+	{
+		for (i=0; i < gjs->spill_nparts; i++)
+		{
+			if (gjs->spill_tupstore[i])
+				tuplestore_end(gjs->spill_tupstore[i]);
+		}
+		pfree(gjs->spill_tupstore);
+		pfree(gjs->spill_hash_max);
+	}
+	gjs->outer_spill = false;
+	gjs->spill_nparts = 0;
+	gjs->spill_hash_max = NULL;
+	gjs->spill_tupstore = NULL;
+	gjs->spill_curr = NULL;
+}
+
+/*
+ * gpujoin_outer_spill_write
+ *
+ * It computes hash-value of the outer rows on the supplied chunk, then
+ * writes out the rows to the spill file of the depth-1 chunk to be
+ * joined. Rows for the first chunk are joined with this chunk as is.
+ */
+static void
+gpujoin_outer_spill_write(GpuJoinState *gjs, pgstrom_data_store *pds)
+{
+	innerState	   *istate = &gjs->inners[0];
+	kern_data_store *kds = pds->kds;
+	TupleDesc		tupdesc = gjs->spill_slot->tts_tupleDescriptor;
+	TupleTableSlot *hslot = gjs->spill_hslot;
+	HeapTupleData	tupData;
+	pg_crc32		hash;
+	bool			is_null_keys;
+	cl_uint			i, j;
+
+	Assert(kds->format == KDS_FORMAT_ROW);
+	for (i=0; i < kds->nitems; i++)
+	{
+		kern_tupitem   *tupitem = KERN_DATA_STORE_TUPITEM(kds, i);
+
+		ExecStoreAllNullTuple(hslot);
+		gpujoin_fallback_tuple_extract(hslot,
+									   tupdesc,
+									   kds->table_oid,
+									   tupitem,
+									   gjs->outer_dst_resno,
+									   gjs->outer_src_anum_min,
+									   gjs->outer_src_anum_max);
+		hash = get_tuple_hashvalue(istate, false, hslot, &is_null_keys);
+		/* joined with the first chunk on this scan */
+		if (hash <= gjs->spill_hash_max[0])
+			continue;
+		/* all-NULL keys will never match to inner rows */
+		if (is_null_keys && (istate->join_type == JOIN_INNER ||
+							 istate->join_type == JOIN_RIGHT))
+			continue;
+
+		for (j=1; j < gjs->spill_nparts - 1; j++)
+		{
+			if (hash <= gjs->spill_hash_max[j])
+				break;
+		}
+		tupData.t_len = tupitem->t_len;
+		tupData.t_self = tupitem->t_self;
+		tupData.t_tableOid = kds->table_oid;
+		tupData.t_data = &tupitem->htup;
+		tuplestore_puttuple(gjs->spill_tupstore[j], &tupData);
+		gjs->spill_ntuples++;
+	}
+}
+
+/*
+ * gpujoin_outer_spill_read
+ *
+ * It loads the spilled outer rows for the current depth-1 chunk, or
+ * returns NULL if no more rows. The spill file is released at the end.
+ */
+static pgstrom_data_store *
+gpujoin_outer_spill_read(GpuJoinState *gjs)
+{
+	TupleTableSlot *slot = gjs->spill_slot;
+	pgstrom_data_store *pds = NULL;
+
+	Assert(gjs->spill_curr != NULL);
+	while (true)
+	{
+		if (gjs->gts.scan_overflow)
+		{
+			slot = gjs->gts.scan_overflow;
+			gjs->gts.scan_overflow = NULL;
+		}
+		else if (!tuplestore_gettupleslot(gjs->spill_curr, true, false, slot))
+		{
+			int		index = gjs->inners[0].pds_index - 1;
+
+			Assert(gjs->spill_tupstore[index] == gjs->spill_curr);
+			tuplestore_end(gjs->spill_curr);
+			gjs->spill_tupstore[index] = NULL;
+			gjs->spill_curr = NULL;
+			break;
+		}
+
+		if (!pds)
+		{
+			pds = PDS_create_row(gjs->gts.gcontext,
+								 slot->tts_tupleDescriptor,
+								 pgstrom_chunk_size());
+			if (gjs->gts.css.ss.ss_currentRelation)
+				pds->kds->table_oid =
+					RelationGetRelid(gjs->gts.css.ss.ss_currentRelation);
+		}
+
+		if (!PDS_insert_tuple(pds, slot))
+		{
+			gjs->gts.scan_overflow = slot;
+			break;
+		}
+	}
+	return pds;
+}
+
 /*
  * multirels_attach_buffer
  *
@@ -6760,7 +8171,14 @@ multirels_attach_buffer(pgstrom_multirels *pmrels)
 	/* also, data store */
 	for (i=0; i < num_rels; i++)
 		PDS_retain(pmrels->inner_chunks[i]);
-
+	if (pmrels->part_chunks)
+	{
+		for (i=1; i < pmrels->gjs->gts.gcontext->num_context; i++)
+		{
+			if (pmrels->part_chunks[i])
+				PDS_retain(pmrels->part_chunks[i]);
+		}
+	}
 	return pmrels;
 }
 
@@ -6777,9 +8195,19 @@ multirels_get_buffer(pgstrom_multirels *pmrels, pgstrom_gpujoin *pgjoin)
 	{
 		CUdeviceptr	m_kmrels = 0UL;
 		CUdeviceptr	m_ojmaps = 0UL;
+		Size		kmrels_length = pmrels->usage_length;
+
+		/* partitioned chunk is put on the tail, if any */
+		if (pmrels->part_chunks)
+		{
+			pgstrom_data_store *pds = pmrels->part_chunks[cuda_index];
+
+			Assert(pgjoin->part_index == cuda_index);
+			kmrels_length += STROMALIGN(pds->kds->length);
+		}
 
 		/* buffer for the inner multi-relations */
-		m_kmrels = gpuMemAlloc(&pgjoin->task, pmrels->usage_length);
+		m_kmrels = gpuMemAlloc(&pgjoin->task, kmrels_length);
 		if (!m_kmrels)
 			return false;
 
@@ -6877,7 +8305,8 @@ multirels_send_buffer(pgstrom_multirels *pmrels, GpuTask *gtask)
 
 		for (i=0; i < pmrels->kern.nrels; i++)
 		{
-			pgstrom_data_store *pds = pmrels->inner_chunks[i];
+			pgstrom_data_store *pds = multirels_inner_chunk(pmrels, i+1,
+															cuda_index);
 			kern_data_store	   *kds = pds->kds;
 			Size				offset = pmrels->kern.chunks[i].chunk_offset;
 
@@ -6887,6 +8316,17 @@ multirels_send_buffer(pgstrom_multirels *pmrels, GpuTask *gtask)
 				elog(ERROR, "failed on cuMemcpyHtoDAsync: %s", errorText(rc));
 			total_length += kds->length;
 		}
+		/* bloom filter of depth-1, if any */
+		if (pmrels->kern.bloom_nbits > 0)
+		{
+			length = pmrels->kern.bloom_nbits / BITS_PER_BYTE;
+			rc = cuMemcpyHtoDAsync(m_kmrels + pmrels->kern.bloom_offset,
+								   gjs->inners[0].bloom_filter, length,
+								   cuda_stream);
+			if (rc != CUDA_SUCCESS)
+				elog(ERROR, "failed on cuMemcpyHtoDAsync: %s", errorText(rc));
+			total_length += length;
+		}
 		/* DMA Send synchronization */
 		rc = cuEventRecord(ev_loaded, cuda_stream);
 		if (rc != CUDA_SUCCESS)
@@ -7088,7 +8528,7 @@ multirels_detach_buffer(pgstrom_multirels *pmrels, bool may_kick_outer_join,
 	{
 		GpuJoinState	   *gjs = pmrels->gjs;
 		pgstrom_gpujoin	   *pgjoin_new = (pgstrom_gpujoin *)
-			gpujoin_create_task(gjs, pmrels, NULL, NULL);
+			gpujoin_create_task(gjs, pmrels, NULL, NULL, -1);
 
 		/* Enqueue OUTER JOIN task here */
 		SpinLockAcquire(&gjs->gts.lock);
@@ -7103,6 +8543,14 @@ multirels_detach_buffer(pgstrom_multirels *pmrels, bool may_kick_outer_join,
 	/* release data store */
 	for (i=0; i < num_rels; i++)
 		PDS_release(pmrels->inner_chunks[i]);
+	if (pmrels->part_chunks)
+	{
+		for (i=1; i < pmrels->gjs->gts.gcontext->num_context; i++)
+		{
+			if (pmrels->part_chunks[i])
+				PDS_release(pmrels->part_chunks[i]);
+		}
+	}
 
 	/* Also, this pmrels */
 	if (--pmrels->n_attached == 0)
@@ -7146,6 +8594,62 @@ pgstrom_init_gpujoin(void)
 							 PGC_USERSET,
 							 GUC_NOT_IN_SAMPLE,
 							 NULL, NULL, NULL);
+	/* turn on/off partitioned inner hash table across multiple GPUs */
+	DefineCustomBoolVariable("pg_strom.enable_gpujoin_partition",
+							 "Enables to partition inner hash table across multiple GPUs",
+							 NULL,
+							 &enable_gpujoin_partition,
+							 false,
+							 PGC_USERSET,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
+	/* turn on/off outer spill by hash-value (Grace hash-join) */
+	DefineCustomBoolVariable("pg_strom.enable_gpujoin_spill",
+							 "Enables to spill outer rows by hash-value, instead of rescan, if inner hash table is split",
+							 NULL,
+							 &enable_gpujoin_spill,
+							 true,
+							 PGC_USERSET,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
+	/* turn on/off bloom filter of inner hash values on outer scan */
+	DefineCustomBoolVariable("pg_strom.enable_gpujoin_bloom",
+							 "Enables to drop outer rows by bloom filter of inner hash values",
+							 NULL,
+							 &enable_gpujoin_bloom,
+							 true,
+							 PGC_USERSET,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
+	/* turn on/off range-join on the sorted inner rows */
+	DefineCustomBoolVariable("pg_strom.enable_gpujoin_range",
+							 "Enables to apply binary search on the sorted inner rows of GpuNestLoop",
+							 NULL,
+							 &enable_gpujoin_range,
+							 true,
+							 PGC_USERSET,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
+	/* turn on/off block-wide processing of heavy-hitter hash keys */
+	DefineCustomBoolVariable("pg_strom.enable_gpujoin_heavy_hitter",
+							 "Enables to process heavy-hitter keys of GpuHashJoin by all the threads in a block",
+							 NULL,
+							 &enable_gpujoin_heavy_hitter,
+							 true,
+							 PGC_USERSET,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
+	/* upper limit of inner multi-relations buffer (debug) */
+	DefineCustomIntVariable("pg_strom.debug_gpujoin_inner_limit",
+							"Upper limit of the inner multi-relations buffer (debug)",
+							"0 means the device limitation",
+							&debug_gpujoin_inner_limit,
+							0,
+							0,
+							INT_MAX,
+							PGC_USERSET,
+							GUC_NOT_IN_SAMPLE | GUC_UNIT_KB,
+							NULL, NULL, NULL);
 	/* setup path methods */
 	gpujoin_path_methods.CustomName				= "GpuJoin";
 	gpujoin_path_methods.PlanCustomPath			= create_gpujoin_plan;
@@ -16,6 +16,7 @@
  * GNU General Public License for more details.
  */
 #include "postgres.h"
+#include "access/htup_details.h"
 #include "access/sysattr.h"
 #include "access/xact.h"
 #include "catalog/pg_cast.h"
@@ -50,6 +51,9 @@ static CustomScanMethods		gpupreagg_scan_methods;
 static CustomExecMethods		gpupreagg_exec_methods;
 static bool						enable_gpupreagg;
 static bool						debug_force_gpupreagg;
+static bool						enable_gpupreagg_adaptive;
+static bool						enable_gpupreagg_distinct;
+static bool						enable_gpupreagg_numeric_fixed;
 
 #if 0
 /* list of reduction mode */
@@ -155,6 +159,16 @@ typedef struct
 	TupleTableSlot *outer_overflow;
 	pgstrom_data_store *outer_pds;
 
+	/*
+	 * Simple outer_quals evaluated on the whole chunk at once, prior to
+	 * the row-by-row CPU fallback
+	 */
+	List		   *fallback_filter;	/* list of fallback_filter_key */
+	pgstrom_data_store *fallback_pds;	/* chunk of the fallback_visible */
+	cl_uint			fallback_nrooms;	/* length of the buffers below */
+	bool		   *fallback_visible;	/* visibility map of the chunk */
+	char		   *fallback_values;	/* column buffer for the filter */
+
 	/*
 	 * segment is a set of chunks to be aggregated
 	 */
@@ -230,12 +244,15 @@ typedef struct
 	CUdeviceptr		m_kds_row;		/* source row-buffer */
 	CUdeviceptr		m_kds_slot;		/* internal slot-buffer */
 	CUdeviceptr		m_ghash;		/* global hash slot */
+	CUdeviceptr		m_kcmp_row;		/* compressed image of pds_in */
 	CUevent			ev_dma_send_start;
 	CUevent			ev_dma_send_stop;
 	CUevent			ev_kern_fixvar;
 	CUevent			ev_dma_recv_start;
 	CUevent			ev_dma_recv_stop;
 	pgstrom_data_store *pds_in;		/* source data-store */
+	kern_compressed_kds *kcmp_in;	/* compressed image of pds_in, if any */
+	bool			kcmp_checked;	/* true, if compression is tried */
 	kern_data_store	   *kds_head;	/* header of intermediation data store */
 	kern_resultbuf *kresults;
 	kern_gpupreagg	kern;
@@ -247,6 +264,7 @@ static bool		gpupreagg_task_complete(GpuTask *gtask);
 static void		gpupreagg_task_release(GpuTask *gtask);
 static GpuTask *gpupreagg_next_chunk(GpuTaskState *gts);
 static TupleTableSlot *gpupreagg_next_tuple(GpuTaskState *gts);
+static List *gpupreagg_build_fallback_filter(List *outer_quals);
 
 /*
  * Arguments of alternative functions.
@@ -261,6 +279,9 @@ static TupleTableSlot *gpupreagg_next_tuple(GpuTaskState *gts);
 #define ALTFUNC_EXPR_PCOV_X2		108	/* PCOV_X2(X,Y) */
 #define ALTFUNC_EXPR_PCOV_Y2		109	/* PCOV_Y2(X,Y) */
 #define ALTFUNC_EXPR_PCOV_XY		110	/* PCOV_XY(X,Y) */
+#define ALTFUNC_EXPR_PSUM_FIXED_HI	111	/* PSUM(FIXED(X) >> 32) */
+#define ALTFUNC_EXPR_PSUM_FIXED_LO	112	/* PSUM(FIXED(X) & 0xffffffff) */
+#define ALTFUNC_EXPR_FIXED_SCALE	113	/* scale of FIXED(X), as constant */
 
 /*
  * XXX - GpuPreAgg with Numeric arguments are problematic because
@@ -705,6 +726,85 @@ static aggfunc_catalog_t  aggfunc_catalog[] = {
 	},
 };
 
+/*
+ * Fixed-point variants of SUM(numeric) and AVG(numeric)
+ *
+ * If the argument has typmod of numeric(p,s) with p <= 18, any value of
+ * X * 10^s fits int64; call it FIXED(X). Partial sums of its upper and
+ * lower 32bits never overflow, and are accumulated by the native 64bit
+ * atomic operations, instead of the CAS loop on the packed numeric.
+ */
+#define NUMERIC_FIXED_MAX_PRECISION		18
+
+static aggfunc_catalog_t  aggfunc_numeric_fixed_catalog[] = {
+	/* SUM(X) = EX_SUM_FIXED(PSUM(FIXED_HI(X)), PSUM(FIXED_LO(X)), SCALE) */
+	{ "sum",	1, {NUMERICOID},
+	  "s:sum_numeric_fixed", 3, {INT8OID, INT8OID, INT4OID},
+	  {ALTFUNC_EXPR_PSUM_FIXED_HI,
+	   ALTFUNC_EXPR_PSUM_FIXED_LO,
+	   ALTFUNC_EXPR_FIXED_SCALE}, DEVKERNEL_NEEDS_NUMERIC, INT_MAX
+	},
+	/* AVG(X) = EX_AVG_FIXED(NROWS(X), PSUM(FIXED_HI(X)),
+	 *                       PSUM(FIXED_LO(X)), SCALE) */
+	{ "avg",	1, {NUMERICOID},
+	  "s:avg_numeric_fixed", 4, {INT4OID, INT8OID, INT8OID, INT4OID},
+	  {ALTFUNC_EXPR_NROWS,
+	   ALTFUNC_EXPR_PSUM_FIXED_HI,
+	   ALTFUNC_EXPR_PSUM_FIXED_LO,
+	   ALTFUNC_EXPR_FIXED_SCALE}, DEVKERNEL_NEEDS_NUMERIC, INT_MAX
+	},
+};
+
+/*
+ * aggfunc_numeric_fixed_scale
+ *
+ * It returns the scale of the numeric argument if fixed-point variant is
+ * applicable, or -1.
+ */
+static int
+aggfunc_numeric_fixed_scale(Aggref *aggref)
+{
+	TargetEntry *tle;
+	int32		typmod;
+	int			precision;
+
+	if (!enable_gpupreagg_numeric_fixed ||
+		list_length(aggref->args) != 1)
+		return -1;
+	tle = linitial(aggref->args);
+	if (exprType((Node *) tle->expr) != NUMERICOID)
+		return -1;
+	typmod = exprTypmod((Node *) tle->expr);
+	if (typmod < (int32) VARHDRSZ)
+		return -1;
+	precision = ((typmod - VARHDRSZ) >> 16) & 0xffff;
+	if (precision > NUMERIC_FIXED_MAX_PRECISION)
+		return -1;
+	return (typmod - VARHDRSZ) & 0xffff;
+}
+
+static const aggfunc_catalog_t *
+aggfunc_lookup_numeric_fixed(const aggfunc_catalog_t *aggfn_cat,
+							 Aggref *aggref)
+{
+	int			i;
+
+	if (aggfunc_numeric_fixed_scale(aggref) < 0)
+		return aggfn_cat;
+	for (i=0; i < lengthof(aggfunc_numeric_fixed_catalog); i++)
+	{
+		aggfunc_catalog_t  *catalog = &aggfunc_numeric_fixed_catalog[i];
+
+		if (strcmp(catalog->aggfn_name, aggfn_cat->aggfn_name) == 0 &&
+			catalog->aggfn_nargs == aggfn_cat->aggfn_nargs &&
+			memcmp(catalog->aggfn_argtypes,
+				   aggfn_cat->aggfn_argtypes,
+				   sizeof(Oid) * catalog->aggfn_nargs) == 0)
+			return catalog;
+	}
+	return aggfn_cat;
+}
+
 static const aggfunc_catalog_t *
 aggfunc_lookup_by_oid(Oid aggfnoid)
 {
@@ -1143,6 +1243,80 @@ make_altfunc_expr(const char *func_name, List *args)
 	return expr;
 }
 
+/*
+ * make_altfunc_psum_fixed_expr - makes PSUM() of the upper or lower 32bits
+ * of the numeric argument in fixed-point.
+ */
+static Expr *
+make_altfunc_psum_fixed_expr(Aggref *aggref, bool is_upper)
+{
+	TargetEntry *tle = linitial(aggref->args);
+	Expr	   *expr = tle->expr;
+	int			scale = aggfunc_numeric_fixed_scale(aggref);
+	char		buf[40];
+	Datum		value;
+
+	Assert(scale >= 0);
+	/* FIXED(X) = (X * 10^scale)::int8 */
+	snprintf(buf, sizeof(buf), "1e%d", scale);
+	value = DirectFunctionCall3(numeric_in,
+								CStringGetDatum(buf),
+								ObjectIdGetDatum(InvalidOid),
+								Int32GetDatum(-1));
+	expr = (Expr *) makeFuncExpr(F_NUMERIC_MUL,
+								 NUMERICOID,
+								 list_make2(expr,
+											makeConst(NUMERICOID,
+													  -1,
+													  InvalidOid,
+													  -1,
+													  value,
+													  false,
+													  false)),
+								 InvalidOid,
+								 InvalidOid,
+								 COERCE_EXPLICIT_CALL);
+	expr = (Expr *) makeFuncExpr(F_NUMERIC_INT8,
+								 INT8OID,
+								 list_make1(expr),
+								 InvalidOid,
+								 InvalidOid,
+								 COERCE_EXPLICIT_CAST);
+	if (is_upper)
+		expr = (Expr *) makeFuncExpr(F_INT8SHR,
+									 INT8OID,
+									 list_make2(expr,
+												makeConst(INT4OID,
+														  -1,
+														  InvalidOid,
+														  sizeof(int32),
+														  Int32GetDatum(32),
+														  false,
+														  true)),
+									 InvalidOid,
+									 InvalidOid,
+									 COERCE_EXPLICIT_CALL);
+	else
+		expr = (Expr *) makeFuncExpr(F_INT8AND,
+									 INT8OID,
+									 list_make2(expr,
+												makeConst(INT8OID,
+														  -1,
+														  InvalidOid,
+														  sizeof(int64),
+														  Int64GetDatum(INT64CONST(0xffffffff)),
+														  false,
+														  FLOAT8PASSBYVAL)),
+									 InvalidOid,
+									 InvalidOid,
+									 COERCE_EXPLICIT_CALL);
+	if (aggref->aggfilter)
+		expr = make_expr_conditional(expr, aggref->aggfilter,
+									 (Expr *) makeZeroConst(INT8OID, -1,
+															InvalidOid));
+	return make_altfunc_expr("psum", list_make1(expr));
+}
+
 static Expr *
 make_altfunc_nrows_expr(Aggref *aggref)
 {
@@ -1222,6 +1396,8 @@ make_gpupreagg_refnode(Aggref *aggref, List **prep_tlist,
 	aggfn_cat = aggfunc_lookup_by_oid(aggref->aggfnoid);
 	if (!aggfn_cat)
 		return NULL;
+	/* fixed-point variant, if numeric argument is applicable */
+	aggfn_cat = aggfunc_lookup_numeric_fixed(aggfn_cat, aggref);
 
 	/* MEMO: Right now, functions below are not supported, so should not
 	 * be on the aggfunc_catalog.
@@ -1406,6 +1582,28 @@ make_gpupreagg_refnode(Aggref *aggref, List **prep_tlist,
 			case ALTFUNC_EXPR_PCOV_XY:
 				expr = make_altfunc_pcov_expr(aggref, "pcov_xy");
 				break;
+			case ALTFUNC_EXPR_PSUM_FIXED_HI:
+				expr = make_altfunc_psum_fixed_expr(aggref, true);
+				break;
+			case ALTFUNC_EXPR_PSUM_FIXED_LO:
+				expr = make_altfunc_psum_fixed_expr(aggref, false);
+				break;
+			case ALTFUNC_EXPR_FIXED_SCALE:
+				/* constant is referenced by Agg, not by GpuPreAgg */
+				expr = (Expr *)
+					makeConst(INT4OID,
+							  -1,
+							  InvalidOid,
+							  sizeof(int32),
+							  Int32GetDatum(aggfunc_numeric_fixed_scale(aggref)),
+							  false,
+							  true);
+				tle = makeTargetEntry(expr,
+									  list_length(altnode->args) + 1,
+									  NULL,
+									  false);
+				altnode->args = lappend(altnode->args, tle);
+				continue;
 			default:
 				elog(ERROR, "Bug? unexpected ALTFUNC_EXPR_* label");
 		}
@@ -1466,6 +1664,7 @@ typedef struct
 	List	   *tlist_gpa;
 	Bitmapset  *attr_refs;
 	AttrNumber *attr_maps;
+	List	   *distinct_aggs;
 	int			extra_flags;
 	int			safety_limit;
 	bool		not_available;
@@ -1483,6 +1682,15 @@ gpupreagg_rewrite_mutator(Node *node, gpupreagg_rewrite_context *context)
 		Aggref	   *orgagg = (Aggref *) node;
 		Aggref	   *altagg = NULL;
 
+		/*
+		 * Arguments of DISTINCT aggregate are already grouping keys of
+		 * GpuPreAgg, so Agg node can run the original aggregate function
+		 * towards the de-duplicated rows as is.
+		 */
+		if (list_member_ptr(context->distinct_aggs, orgagg))
+			return expression_tree_mutator(node, gpupreagg_rewrite_mutator,
+										   (void *)context);
+
 		altagg = make_gpupreagg_refnode(orgagg,
 										&context->tlist_gpa,
 										&context->extra_flags,
@@ -1517,6 +1725,65 @@ gpupreagg_rewrite_mutator(Node *node, gpupreagg_rewrite_context *context)
 								   (void *)context);
 }
 
+/*
+ * gpupreagg_distinct_keys_walker
+ *
+ * It picks up aggregate functions with DISTINCT clause, and references
+ * to the outer target-list by their arguments. Once these arguments are
+ * added to the grouping keys of GpuPreAgg, the Agg node receives rows
+ * de-duplicated on the device, then it can run the original aggregate
+ * function (that eliminates duplicated inputs by itself) without any
+ * alternative functions. Only simple Var or Const arguments are
+ * supported, because a grouping key of GpuPreAgg needs to be a simple
+ * reference to the outer target-list.
+ */
+typedef struct
+{
+	List	   *distinct_aggs;
+	Bitmapset  *distinct_keys;
+	bool		not_available;
+} gpupreagg_distinct_context;
+
+static bool
+gpupreagg_distinct_keys_walker(Node *node,
+							   gpupreagg_distinct_context *context)
+{
+	if (!node)
+		return false;
+	if (IsA(node, Aggref))
+	{
+		Aggref	   *aggref = (Aggref *) node;
+		Bitmapset  *keys = NULL;
+		ListCell   *cell;
+
+		if (!aggref->aggdistinct)
+			return false;
+		if (aggref->aggfilter || aggref->aggdirectargs)
+		{
+			context->not_available = true;
+			return true;
+		}
+		foreach (cell, aggref->args)
+		{
+			TargetEntry	   *tle = lfirst(cell);
+
+			if (IsA(tle->expr, Var))
+				keys = bms_add_member(keys, ((Var *) tle->expr)->varattno);
+			else if (!IsA(tle->expr, Const))
+			{
+				context->not_available = true;
+				return true;
+			}
+		}
+		context->distinct_aggs = lappend(context->distinct_aggs, aggref);
+		context->distinct_keys = bms_add_members(context->distinct_keys,
+												 keys);
+		return false;
+	}
+	return expression_tree_walker(node, gpupreagg_distinct_keys_walker,
+								  (void *) context);
+}
+
 static bool
 gpupreagg_rewrite_expr(Agg *agg,
 					   List **p_agg_tlist,
@@ -1524,6 +1791,8 @@ gpupreagg_rewrite_expr(Agg *agg,
 					   List **p_tlist_gpa,
 					   AttrNumber **p_attr_maps,
 					   Bitmapset **p_attr_refs,
+					   List **p_distinct_aggs,
+					   List **p_distinct_cols,
 					   int	*p_extra_flags,
 					   Size *p_varlena_unitsz,
 					   cl_int *p_safety_limit)
@@ -1536,11 +1805,13 @@ gpupreagg_rewrite_expr(Agg *agg,
 	AttrNumber *attr_maps;
 	Bitmapset  *attr_refs = NULL;
 	Bitmapset  *grouping_keys = NULL;
+	List	   *distinct_cols = NIL;
 	Size		varlena_unitsz = 0;
 	ListCell   *cell;
 	Size		final_length;
 	Size		final_nslots;
 	int			i, ncols;
+	gpupreagg_distinct_context dcontext;
 
 	/* In case of sort-aggregate, it has an underlying Sort node on top
 	 * of the scan node. GpuPreAgg shall be injected under the Sort node
@@ -1566,6 +1837,33 @@ gpupreagg_rewrite_expr(Agg *agg,
 										   subagg->grpColIdx[i]);
 	}
 
+	/*
+	 * Arguments of DISTINCT aggregate functions are also added to the
+	 * grouping keys of GpuPreAgg, if any.
+	 */
+	memset(&dcontext, 0, sizeof(gpupreagg_distinct_context));
+	if (enable_gpupreagg_distinct)
+	{
+		gpupreagg_distinct_keys_walker((Node *) agg->plan.targetlist,
+									   &dcontext);
+		gpupreagg_distinct_keys_walker((Node *) agg->plan.qual,
+									   &dcontext);
+		if (dcontext.not_available)
+		{
+			elog(DEBUG1, "Unable to apply GpuPreAgg because DISTINCT "
+				 "aggregate takes neither simple Var nor Const arguments");
+			return false;
+		}
+		i = -1;
+		while ((i = bms_next_member(dcontext.distinct_keys, i)) >= 0)
+		{
+			if (bms_is_member(i, grouping_keys))
+				continue;
+			distinct_cols = lappend_int(distinct_cols, i);
+			grouping_keys = bms_add_member(grouping_keys, i);
+		}
+	}
+
 	attr_maps = palloc0(sizeof(AttrNumber) *
 						list_length(outer_plan->targetlist));
 	foreach (cell, outer_plan->targetlist)
@@ -1663,6 +1961,7 @@ gpupreagg_rewrite_expr(Agg *agg,
 	context.tlist_gpa = tlist_gpa;
 	context.attr_refs = attr_refs;
 	context.attr_maps = attr_maps;
+	context.distinct_aggs = dcontext.distinct_aggs;
 	context.extra_flags = 0;
 	context.safety_limit = INT_MAX;
 
@@ -1713,6 +2012,8 @@ gpupreagg_rewrite_expr(Agg *agg,
 	*p_tlist_gpa = context.tlist_gpa;
 	*p_attr_maps = attr_maps;
 	*p_attr_refs = context.attr_refs;
+	*p_distinct_aggs = dcontext.distinct_aggs;
+	*p_distinct_cols = distinct_cols;
 	*p_extra_flags = context.extra_flags;
 	*p_varlena_unitsz = varlena_unitsz;
 	*p_safety_limit = context.safety_limit;
@@ -1781,7 +2082,12 @@ gpupreagg_codegen_qual_eval(GpuPreAggInfo *gpa_info,
 }
 
 /*
- *  
+ * gpupreagg_codegen_hashvalue
+ *
+ * NOTE: text grouping keys are hashed on the bytes of varlena, and
+ * gpupreagg_keymatch() compares them with texteq/bpchareq. Dictionary
+ * encoding of the keys into integer codes is not implemented; only the
+ * equality check is cheaper (see text_equal in cuda_textlib.h).
  *
  * static cl_uint
  * gpupreagg_hashvalue(kern_context *kcxt,
@@ -3111,6 +3417,8 @@ pgstrom_try_insert_gpupreagg(PlannedStmt *pstmt, Agg *agg)
 	List		   *agg_tlist = NIL;
 	AttrNumber	   *attr_maps = NULL;
 	Bitmapset	   *attr_refs = NULL;
+	List		   *distinct_aggs = NIL;
+	List		   *distinct_cols = NIL;
 	List		   *outer_tlist = NIL;
 	List		   *outer_quals = NIL;
 	List		   *tlist_dev = NIL;
@@ -3144,6 +3452,8 @@ pgstrom_try_insert_gpupreagg(PlannedStmt *pstmt, Agg *agg)
 								&tlist_gpa,
 								&attr_maps,
 								&attr_refs,
+								&distinct_aggs,
+								&distinct_cols,
 								&extra_flags,
 								&varlena_unitsz,
 								&safety_limit))
@@ -3202,6 +3512,13 @@ pgstrom_try_insert_gpupreagg(PlannedStmt *pstmt, Agg *agg)
 		outer_node = outerPlan(agg);
 		new_agg_strategy = AGG_HASHED;
 
+		/*
+		 * Agg node cannot run DISTINCT aggregate functions with hashed
+		 * basis, because they need per-group sorting.
+		 */
+		if (distinct_aggs != NIL)
+			return;
+
 		/*
 		 * NOTE: all the supported aggregate functions are available to
 		 * aggregate values with both of hashed and sorted basis.
@@ -3229,6 +3546,16 @@ pgstrom_try_insert_gpupreagg(PlannedStmt *pstmt, Agg *agg)
 	 * So, it is just a baseline parameter.
 	 */
 	num_groups = Max(agg->plan.plan_rows, 1.0);
+	if (distinct_cols != NIL)
+	{
+		/*
+		 * We have no statistics of the arguments of DISTINCT aggregate
+		 * here, so the number of groups (including the arguments) is
+		 * assumed to be the geometric mean of the final result and the
+		 * input rows. Reduction mode shall be revised in run-time.
+		 */
+		num_groups = sqrt(num_groups * Max(outerPlan(agg)->plan_rows, 1.0));
+	}
 	if (num_groups < (gpuMaxThreadsPerBlock() / 4))
 	{
 		key_dist_salt = (gpuMaxThreadsPerBlock() / 4) / (cl_uint) num_groups;
@@ -3333,10 +3660,12 @@ pgstrom_try_insert_gpupreagg(PlannedStmt *pstmt, Agg *agg)
 	/* also set up private information */
 	memset(&gpa_info, 0, sizeof(GpuPreAggInfo));
 	gpa_info.tlist_dev      = tlist_dev;
-	gpa_info.numCols        = agg->numCols;
-	gpa_info.grpColIdx      = palloc0(sizeof(AttrNumber) * agg->numCols);
+	gpa_info.numCols        = agg->numCols + list_length(distinct_cols);
+	gpa_info.grpColIdx      = palloc0(sizeof(AttrNumber) * gpa_info.numCols);
 	for (i=0; i < agg->numCols; i++)
 		gpa_info.grpColIdx[i] = attr_maps[agg->grpColIdx[i] - 1];
+	foreach (lc, distinct_cols)
+		gpa_info.grpColIdx[i++] = attr_maps[lfirst_int(lc) - 1];
 	gpa_info.num_groups     = num_groups;
 	gpa_info.num_chunks     = num_chunks;
 	gpa_info.varlena_unitsz = varlena_unitsz;
@@ -3513,7 +3842,7 @@ gpupreagg_begin(CustomScanState *node, EState *estate, int eflags)
 								gpa_info->used_params,
 								gpa_info->kern_source,
 								gpa_info->extra_flags);
-	if ((eflags & EXEC_FLAG_EXPLAIN_ONLY) == 0)
+	if (PGSTROM_PRELOAD_CUDA_PROGRAM(eflags))
         pgstrom_load_cuda_program(&gpas->gts, true);
 
 	/*
@@ -3533,6 +3862,12 @@ gpupreagg_begin(CustomScanState *node, EState *estate, int eflags)
 
 	gpas->outer_quals = (List *)
 		ExecInitExpr((Expr *) gpa_info->outer_quals, ps);
+	gpas->fallback_filter =
+		gpupreagg_build_fallback_filter(gpa_info->outer_quals);
+	gpas->fallback_pds = NULL;
+	gpas->fallback_nrooms = 0;
+	gpas->fallback_visible = NULL;
+	gpas->fallback_values = NULL;
 	gpas->outer_overflow = NULL;
 	gpas->outer_pds = NULL;
 	gpas->curr_segment = NULL;
@@ -3553,6 +3888,82 @@ gpupreagg_begin(CustomScanState *node, EState *estate, int eflags)
 	pgstrom_init_perfmon(&gpas->gts);
 }
 
+/*
+ * gpupreagg_adjust_reduction_mode
+ *
+ * It switches the reduction mode (and key distribution salt) of the tasks
+ * to be created later, according to the number of distinct grouping keys
+ * observed by the completed task, instead of the plan estimation.
+ * The thresholds are same as the initial choice in gpupreagg_begin().
+ */
+static void
+gpupreagg_adjust_reduction_mode(GpuPreAggState *gpas,
+								pgstrom_gpupreagg *gpreagg,
+								cl_uint nitems_in)
+{
+	cl_uint		local_limit = gpuMaxThreadsPerBlock() / 4;
+	cl_int		reduction_mode;
+	cl_int		key_dist_salt;
+	double		ndistinct;
+
+	if (!enable_gpupreagg_adaptive ||
+		gpas->reduction_mode == GPUPREAGG_NOGROUP_REDUCTION ||
+		gpreagg->kern.kerror.errcode != StromError_Success ||
+		nitems_in < local_limit)
+		return;
+
+	switch (gpreagg->kern.reduction_mode)
+	{
+		case GPUPREAGG_LOCAL_REDUCTION:
+		case GPUPREAGG_GLOBAL_REDUCTION:
+			/* number of distinct keys after the global reduction */
+			ndistinct = gpreagg->kern.num_distinct;
+			break;
+		case GPUPREAGG_FINAL_REDUCTION:
+			/*
+			 * Only final reduction does not count distinct keys per chunk,
+			 * however, new groups on the final buffer by the first task of
+			 * the segment are the ones.
+			 */
+			if (gpreagg->segment->total_ntasks != 1)
+				return;
+			ndistinct = gpreagg->kern.num_groups;
+			break;
+		default:
+			return;
+	}
+	/* key_dist_salt distributes a grouping key to multiple slots */
+	ndistinct = Max(ndistinct / (double) gpreagg->kern.key_dist_salt, 1.0);
+
+	if (ndistinct < (double) local_limit)
+	{
+		reduction_mode = GPUPREAGG_LOCAL_REDUCTION;
+		key_dist_salt = Max(local_limit / (cl_uint) ndistinct, 1);
+	}
+	else if (ndistinct < (double) nitems_in / 4.0)
+	{
+		reduction_mode = GPUPREAGG_GLOBAL_REDUCTION;
+		key_dist_salt = 1;
+	}
+	else
+	{
+		reduction_mode = GPUPREAGG_FINAL_REDUCTION;
+		key_dist_salt = 1;
+	}
+
+	if (reduction_mode != gpas->reduction_mode ||
+		key_dist_salt != gpas->key_dist_salt)
+	{
+		elog(DEBUG1, "GpuPreAgg: reduction mode %d -> %d, salt %d -> %d "
+			 "(%.0f distinct keys in %u rows)",
+			 gpas->reduction_mode, reduction_mode,
+			 gpas->key_dist_salt, key_dist_salt,
+			 ndistinct, nitems_in);
+		gpas->reduction_mode = reduction_mode;
+		gpas->key_dist_salt = key_dist_salt;
+	}
+}
+
 /*
  * gpupreagg_check_segment_capacity
  *
@@ -3707,7 +4118,7 @@ gpupreagg_create_segment(GpuPreAggState *gpas)
 	 * GPU device. At this moment, we don't support multiple device
 	 * mode to process GpuPreAgg. It's a TODO.
 	 */
-	cuda_index = gcontext->next_context++ % gcontext->num_context;
+	cuda_index = pgstrom_select_cuda_index(&gpas->gts);
 
 	/* pds_final buffer */
 	pds_final = PDS_create_slot(gcontext,
@@ -3995,8 +4406,9 @@ gpupreagg_task_create(GpuPreAggState *gpas,
 	gpreagg->is_terminator = is_terminator;
 
 	/*
-	 * FIXME: If num_groups is larger than expectation, we may need to
-	 * change the reduction policy on run-time
+	 * NOTE: reduction_mode and key_dist_salt might be changed on run-time
+	 * by gpupreagg_adjust_reduction_mode(), if observed number of groups
+	 * is different from the expectation.
 	 */
 	gpreagg->num_groups = gpas->stat_num_groups;
 	gpreagg->pds_in = pds_in;
@@ -4059,14 +4471,14 @@ gpupreagg_next_chunk(GpuTaskState *gts)
 		/* Load a bunch of records at once on the first time */
 		if (!gpas->outer_pds)
 			gpas->outer_pds = pgstrom_exec_scan_chunk(&gpas->gts,
-													  pgstrom_chunk_size());
+									pgstrom_adaptive_chunk_size(&gpas->gts));
 		/* Picks up the cached one to detect the final chunk */
 		pds = gpas->outer_pds;
 		if (!pds)
 			pgstrom_deactivate_gputaskstate(&gpas->gts);
 		else
 			gpas->outer_pds = pgstrom_exec_scan_chunk(&gpas->gts,
-													  pgstrom_chunk_size());
+									pgstrom_adaptive_chunk_size(&gpas->gts));
 		/* Any more chunk expected? */
 		if (!gpas->outer_pds)
 			is_terminator = true;
@@ -4180,6 +4592,284 @@ retry_segment:
 	return &gpreagg->task;
 }
 
+/*
+ * Filter of the CPU fallback
+ *
+ * Once a segment needs CPU fallback, all the rows in the chunks of the
+ * segment are filtered by outer_quals one by one, through the tuple-slot
+ * and the expression machinery. Simple qualifiers in the form of
+ * "Var OP Const" on the fixed-length numeric types are evaluated on the
+ * whole chunk at once, prior to the row-by-row process; values are
+ * gathered to a column buffer first, then compared by a tight loop
+ * without branches. It only drops rows that never satisfy the outer_quals,
+ * so the remaining rows are still checked by ExecQual.
+ */
+#define FALLBACK_FILTER_OP_LT		1
+#define FALLBACK_FILTER_OP_LE		2
+#define FALLBACK_FILTER_OP_EQ		3
+#define FALLBACK_FILTER_OP_NE		4
+#define FALLBACK_FILTER_OP_GE		5
+#define FALLBACK_FILTER_OP_GT		6
+
+typedef struct
+{
+	AttrNumber	attnum;		/* attribute number of the source tuple */
+	Oid			type_oid;	/* data type of the Var and Const */
+	cl_int		cmp_op;		/* one of FALLBACK_FILTER_OP_* */
+	Datum		value;		/* value of the Const */
+} fallback_filter_key;
+
+static struct {
+	Oid			func_oid;
+	Oid			type_oid;
+	cl_int		cmp_op;
+} fallback_filter_catalog[] = {
+	{ F_INT2LT,   INT2OID,   FALLBACK_FILTER_OP_LT },
+	{ F_INT2LE,   INT2OID,   FALLBACK_FILTER_OP_LE },
+	{ F_INT2EQ,   INT2OID,   FALLBACK_FILTER_OP_EQ },
+	{ F_INT2NE,   INT2OID,   FALLBACK_FILTER_OP_NE },
+	{ F_INT2GE,   INT2OID,   FALLBACK_FILTER_OP_GE },
+	{ F_INT2GT,   INT2OID,   FALLBACK_FILTER_OP_GT },
+	{ F_INT4LT,   INT4OID,   FALLBACK_FILTER_OP_LT },
+	{ F_INT4LE,   INT4OID,   FALLBACK_FILTER_OP_LE },
+	{ F_INT4EQ,   INT4OID,   FALLBACK_FILTER_OP_EQ },
+	{ F_INT4NE,   INT4OID,   FALLBACK_FILTER_OP_NE },
+	{ F_INT4GE,   INT4OID,   FALLBACK_FILTER_OP_GE },
+	{ F_INT4GT,   INT4OID,   FALLBACK_FILTER_OP_GT },
+	{ F_INT8LT,   INT8OID,   FALLBACK_FILTER_OP_LT },
+	{ F_INT8LE,   INT8OID,   FALLBACK_FILTER_OP_LE },
+	{ F_INT8EQ,   INT8OID,   FALLBACK_FILTER_OP_EQ },
+	{ F_INT8NE,   INT8OID,   FALLBACK_FILTER_OP_NE },
+	{ F_INT8GE,   INT8OID,   FALLBACK_FILTER_OP_GE },
+	{ F_INT8GT,   INT8OID,   FALLBACK_FILTER_OP_GT },
+	{ F_FLOAT4LT, FLOAT4OID, FALLBACK_FILTER_OP_LT },
+	{ F_FLOAT4LE, FLOAT4OID, FALLBACK_FILTER_OP_LE },
+	{ F_FLOAT4EQ, FLOAT4OID, FALLBACK_FILTER_OP_EQ },
+	{ F_FLOAT4NE, FLOAT4OID, FALLBACK_FILTER_OP_NE },
+	{ F_FLOAT4GE, FLOAT4OID, FALLBACK_FILTER_OP_GE },
+	{ F_FLOAT4GT, FLOAT4OID, FALLBACK_FILTER_OP_GT },
+	{ F_FLOAT8LT, FLOAT8OID, FALLBACK_FILTER_OP_LT },
+	{ F_FLOAT8LE, FLOAT8OID, FALLBACK_FILTER_OP_LE },
+	{ F_FLOAT8EQ, FLOAT8OID, FALLBACK_FILTER_OP_EQ },
+	{ F_FLOAT8NE, FLOAT8OID, FALLBACK_FILTER_OP_NE },
+	{ F_FLOAT8GE, FLOAT8OID, FALLBACK_FILTER_OP_GE },
+	{ F_FLOAT8GT, FLOAT8OID, FALLBACK_FILTER_OP_GT },
+};
+
+static List *
+gpupreagg_build_fallback_filter(List *outer_quals)
+{
+	List	   *result = NIL;
+	ListCell   *lc;
+
+	foreach (lc, outer_quals)
+	{
+		OpExpr	   *op = lfirst(lc);
+		Var		   *var;
+		Const	   *con;
+		Oid			opno;
+		Oid			func_oid;
+		fallback_filter_key *fkey;
+		int			i;
+
+		if (!IsA(op, OpExpr) || list_length(op->args) != 2)
+			continue;
+		if (IsA(linitial(op->args), Var) && IsA(lsecond(op->args), Const))
+		{
+			var = linitial(op->args);
+			con = lsecond(op->args);
+			opno = op->opno;
+		}
+		else if (IsA(linitial(op->args), Const) &&
+				 IsA(lsecond(op->args), Var))
+		{
+			con = linitial(op->args);
+			var = lsecond(op->args);
+			opno = get_commutator(op->opno);
+			if (!OidIsValid(opno))
+				continue;
+		}
+		else
+			continue;
+
+		if (var->varlevelsup > 0 || var->varattno <= 0 ||
+			con->constisnull || var->vartype != con->consttype)
+			continue;
+
+		func_oid = get_opcode(opno);
+		for (i=0; i < lengthof(fallback_filter_catalog); i++)
+		{
+			if (fallback_filter_catalog[i].func_oid == func_oid &&
+				fallback_filter_catalog[i].type_oid == var->vartype)
+				break;
+		}
+		if (i == lengthof(fallback_filter_catalog))
+			continue;
+
+		/* NaN never makes a row invisible; see below */
+		if ((con->consttype == FLOAT4OID &&
+			 isnan(DatumGetFloat4(con->constvalue))) ||
+			(con->consttype == FLOAT8OID &&
+			 isnan(DatumGetFloat8(con->constvalue))))
+			continue;
+
+		fkey = palloc0(sizeof(fallback_filter_key));
+		fkey->attnum = var->varattno;
+		fkey->type_oid = var->vartype;
+		fkey->cmp_op = fallback_filter_catalog[i].cmp_op;
+		fkey->value = con->constvalue;
+		result = lappend(result, fkey);
+	}
+	return result;
+}
+
+#define FALLBACK_FILTER_COMPARE(BASETYPE,IS_FLOAT)						\
+	do {																\
+		BASETYPE   *values = (BASETYPE *) gpas->fallback_values;		\
+		BASETYPE	cval = *((BASETYPE *) &cdatum);						\
+																		\
+		for (i=0; i < nitems; i++)										\
+			values[i] = (visible[i]										\
+						 ? *((BASETYPE *) &datums[i])					\
+						 : cval);										\
+		/*																\
+		 * NOTE: NaN is larger than any other values, and equivalent	\
+		 * to NaN itself in PostgreSQL. So, we keep rows with NaN	\
+		 * visible, then ExecQual makes the right decision.			\
+		 */																\
+		switch (fkey->cmp_op)											\
+		{																\
+			case FALLBACK_FILTER_OP_LT:									\
+				for (i=0; i < nitems; i++)								\
+					visible[i] &= ((values[i] < cval) |					\
+								   (IS_FLOAT && values[i] != values[i]));	\
+				break;													\
+			case FALLBACK_FILTER_OP_LE:									\
+				for (i=0; i < nitems; i++)								\
+					visible[i] &= ((values[i] <= cval) |				\
+								   (IS_FLOAT && values[i] != values[i]));	\
+				break;													\
+			case FALLBACK_FILTER_OP_EQ:									\
+				for (i=0; i < nitems; i++)								\
+					visible[i] &= ((values[i] == cval) |				\
+								   (IS_FLOAT && values[i] != values[i]));	\
+				break;													\
+			case FALLBACK_FILTER_OP_NE:									\
+				for (i=0; i < nitems; i++)								\
+					visible[i] &= ((values[i] != cval) |				\
+								   (IS_FLOAT && values[i] != values[i]));	\
+				break;													\
+			case FALLBACK_FILTER_OP_GE:									\
+				for (i=0; i < nitems; i++)								\
+					visible[i] &= ((values[i] >= cval) |				\
+								   (IS_FLOAT && values[i] != values[i]));	\
+				break;													\
+			case FALLBACK_FILTER_OP_GT:									\
+				for (i=0; i < nitems; i++)								\
+					visible[i] &= ((values[i] > cval) |					\
+								   (IS_FLOAT && values[i] != values[i]));	\
+				break;													\
+			default:													\
+				elog(ERROR, "Bug? unexpected fallback filter");			\
+		}																\
+	} while(0)
+
+static void
+gpupreagg_fallback_filter_chunk(GpuPreAggState *gpas,
+								pgstrom_data_store *pds,
+								TupleDesc tupdesc)
+{
+	kern_data_store *kds = pds->kds;
+	cl_uint		nitems = kds->nitems;
+	bool	   *visible;
+	Datum	   *datums;
+	ListCell   *lc;
+	cl_uint		i;
+
+	Assert(kds->format == KDS_FORMAT_ROW);
+	if (gpas->fallback_nrooms < nitems)
+	{
+		MemoryContext	memcxt = gpas->gts.css.ss.ps.state->es_query_cxt;
+
+		if (gpas->fallback_visible)
+			pfree(gpas->fallback_visible);
+		if (gpas->fallback_values)
+			pfree(gpas->fallback_values);
+		gpas->fallback_visible = MemoryContextAlloc(memcxt,
+													sizeof(bool) * nitems);
+		gpas->fallback_values = MemoryContextAlloc(memcxt,
+												   2 * sizeof(Datum) * nitems);
+		gpas->fallback_nrooms = nitems;
+	}
+	visible = gpas->fallback_visible;
+	datums = (Datum *)(gpas->fallback_values + sizeof(Datum) * nitems);
+	memset(visible, true, sizeof(bool) * nitems);
+
+	foreach (lc, gpas->fallback_filter)
+	{
+		fallback_filter_key *fkey = lfirst(lc);
+		Datum		cdatum;
+		HeapTupleData tuple;
+		bool		isnull;
+
+		/* gather the values; row-format needs deform for each row */
+		for (i=0; i < nitems; i++)
+		{
+			kern_tupitem   *tupitem;
+
+			if (!visible[i])
+				continue;
+			tupitem = KERN_DATA_STORE_TUPITEM(kds, i);
+			tuple.t_len = tupitem->t_len;
+			tuple.t_self = tupitem->t_self;
+			tuple.t_tableOid = kds->table_oid;
+			tuple.t_data = &tupitem->htup;
+			datums[i] = heap_getattr(&tuple, fkey->attnum, tupdesc, &isnull);
+			if (isnull)
+				visible[i] = false;		/* NULL never satisfies the quals */
+			else if (fkey->type_oid == INT2OID)
+				*((int16 *) &datums[i]) = DatumGetInt16(datums[i]);
+			else if (fkey->type_oid == INT4OID)
+				*((int32 *) &datums[i]) = DatumGetInt32(datums[i]);
+			else if (fkey->type_oid == INT8OID)
+				*((int64 *) &datums[i]) = DatumGetInt64(datums[i]);
+			else if (fkey->type_oid == FLOAT4OID)
+				*((float *) &datums[i]) = DatumGetFloat4(datums[i]);
+			else
+				*((double *) &datums[i]) = DatumGetFloat8(datums[i]);
+		}
+
+		/* then, compare them by the tight loop */
+		switch (fkey->type_oid)
+		{
+			case INT2OID:
+				*((int16 *) &cdatum) = DatumGetInt16(fkey->value);
+				FALLBACK_FILTER_COMPARE(int16, false);
+				break;
+			case INT4OID:
+				*((int32 *) &cdatum) = DatumGetInt32(fkey->value);
+				FALLBACK_FILTER_COMPARE(int32, false);
+				break;
+			case INT8OID:
+				*((int64 *) &cdatum) = DatumGetInt64(fkey->value);
+				FALLBACK_FILTER_COMPARE(int64, false);
+				break;
+			case FLOAT4OID:
+				*((float *) &cdatum) = DatumGetFloat4(fkey->value);
+				FALLBACK_FILTER_COMPARE(float, true);
+				break;
+			case FLOAT8OID:
+				*((double *) &cdatum) = DatumGetFloat8(fkey->value);
+				FALLBACK_FILTER_COMPARE(double, true);
+				break;
+			default:
+				elog(ERROR, "Bug? unexpected fallback filter type: %s",
+					 format_type_be(fkey->type_oid));
+		}
+	}
+	gpas->fallback_pds = pds;
+}
+
 /*
  * gpupreagg_next_tuple_fallback - a fallback routine if GPU returned
  * StromError_CpuReCheck, to suggest the backend to handle request
@@ -4204,6 +4894,20 @@ retry:
 
 	row_index = gpas->gts.curr_index++;
 
+	/*
+	 * Skip the rows obviously filtered out by the outer_quals
+	 */
+	if (gpas->fallback_filter != NIL &&
+		pds->kds->format == KDS_FORMAT_ROW &&
+		row_index < pds->kds->nitems)
+	{
+		if (gpas->fallback_pds != pds || row_index == 0)
+			gpupreagg_fallback_filter_chunk(gpas, pds,
+											slot->tts_tupleDescriptor);
+		if (!gpas->fallback_visible[row_index])
+			goto retry;
+	}
+
 	/*
      * Fetch a tuple from the data-store
      */
@@ -4389,6 +5093,7 @@ gpupreagg_cleanup_cuda_resources(pgstrom_gpupreagg *gpreagg)
 	gpreagg->m_kds_row = 0UL;
 	gpreagg->m_kds_slot = 0UL;
 	gpreagg->m_ghash = 0UL;
+	gpreagg->m_kcmp_row = 0UL;
 }
 
 static void
@@ -4401,6 +5106,8 @@ gpupreagg_task_release(GpuTask *gtask)
 
 	if (gpreagg->pds_in)
 		PDS_release(gpreagg->pds_in);
+	if (gpreagg->kcmp_in)
+		pfree(gpreagg->kcmp_in);
 	if (gpreagg->segment)
 		gpupreagg_put_segment(gpreagg->segment);
 	pfree(gpreagg);
@@ -4418,12 +5125,12 @@ gpupreagg_task_complete(GpuTask *gtask)
 	pgstrom_perfmon	   *pfm = &gpas->gts.pfm;
 	cl_uint				nitems_in = gpreagg->pds_in->kds->nitems;
 
+	/* number of tasks is counted regardless of perfmon, for gpustat */
+	pfm->num_tasks++;
 	if (pfm->enabled)
 	{
 		CUevent			ev_kern_main;
 
-		pfm->num_tasks++;
-
 		CUDA_EVENT_ELAPSED(gpreagg, time_dma_send,
 						   gpreagg->ev_dma_send_start,
 						   gpreagg->ev_dma_send_stop,
@@ -4498,6 +5205,10 @@ skip:
 	segment->total_varlena += gpreagg->kern.varlena_usage;
 	segment->delta_ngroups = gpreagg->kern.num_groups;
 
+	/* reduction policy for the later tasks, by the observed keys */
+	if (!gpreagg->task.cpu_fallback)
+		gpupreagg_adjust_reduction_mode(gpas, gpreagg, nitems_in);
+
 	if (!gpupreagg_check_segment_capacity(gpas, segment))
 	{
 		/*
@@ -4571,6 +5282,9 @@ skip:
 	 */
 	if (segment->needs_fallback)
 	{
+		/* final reduction buffer overflow; informs chunk size control */
+		if (gpreagg->task.kerror.errcode == StromError_DataStoreNoSpace)
+			gpas->gts.chunk_overflow++;
 		if (pgstrom_cpu_fallback_enabled &&
 			(gpreagg->task.kerror.errcode == StromError_CpuReCheck ||
 			 gpreagg->task.kerror.errcode == StromError_DataStoreNoSpace))
@@ -4630,7 +5344,6 @@ gpupreagg_task_respond(CUstream stream, CUresult status, void *private)
 {
 	pgstrom_gpupreagg  *gpreagg = (pgstrom_gpupreagg *) private;
 	gpupreagg_segment  *segment = gpreagg->segment;
-	GpuTaskState	   *gts = gpreagg->task.gts;
 
 	/* See comments in pgstrom_respond_gpuscan() */
 	if (status == CUDA_ERROR_INVALID_CONTEXT || !IsTransactionState())
@@ -4658,25 +5371,10 @@ gpupreagg_task_respond(CUstream stream, CUresult status, void *private)
 		segment->needs_fallback = true;
 
 	/*
-	 * Remove the GpuTask from the running_tasks list, and attach it
-	 * on the completed_tasks list again. Note that this routine may
-	 * be called by CUDA runtime, prior to attachment of GpuTask on
-	 * the running_tasks by cuda_control.c.
+	 * Informs completion of the GpuTask to the backend; it shall be
+	 * moved from the running_tasks to the completed_tasks later.
 	 */
-	SpinLockAcquire(&gts->lock);
-	if (gpreagg->task.chain.prev && gpreagg->task.chain.next)
-	{
-		dlist_delete(&gpreagg->task.chain);
-		gts->num_running_tasks--;
-	}
-	if (gpreagg->task.kerror.errcode == StromError_Success)
-		dlist_push_tail(&gts->completed_tasks, &gpreagg->task.chain);
-	else
-		dlist_push_head(&gts->completed_tasks, &gpreagg->task.chain);
-	gts->num_completed_tasks++;
-	SpinLockRelease(&gts->lock);
-
-	SetLatch(&MyProc->procLatch);
+	pgstrom_complete_gputask(&gpreagg->task);
 }
 
 /*
@@ -4737,11 +5435,24 @@ __gpupreagg_task_process(pgstrom_gpupreagg *gpreagg)
 	 */
 	if (gpreagg->kern.reduction_mode != GPUPREAGG_ONLY_TERMINATION)
 	{
+		/*
+		 * Compressed image of the source chunk, if enabled. It is kept
+		 * across the retry due to out of resources.
+		 */
+		if (!gpreagg->kcmp_checked)
+		{
+			gpreagg->kcmp_in = pgstrom_compress_kds(gpreagg->task.gts->gcontext,
+													pds_in->kds, pfm);
+			gpreagg->kcmp_checked = true;
+		}
+
 		length = (GPUMEMALIGN(KERN_GPUPREAGG_LENGTH(&gpreagg->kern)) +
 				  GPUMEMALIGN(KERN_DATA_STORE_LENGTH(pds_in->kds)) +
 				  GPUMEMALIGN(KERN_DATA_STORE_LENGTH(kds_head)) +
 				  GPUMEMALIGN(offsetof(kern_global_hashslot,
 									   hash_slot[gpreagg->kern.hash_size])));
+		if (gpreagg->kcmp_in)
+			length += GPUMEMALIGN(KERN_COMPRESSED_KDS_LENGTH(gpreagg->kcmp_in));
 
 		gpreagg->m_gpreagg = gpuMemAlloc(&gpreagg->task, length);
 		if (!gpreagg->m_gpreagg)
@@ -4752,6 +5463,12 @@ __gpupreagg_task_process(pgstrom_gpupreagg *gpreagg)
 			GPUMEMALIGN(KERN_DATA_STORE_LENGTH(pds_in->kds));
 		gpreagg->m_ghash = gpreagg->m_kds_slot +
 			GPUMEMALIGN(KERN_DATA_STORE_LENGTH(kds_head));
+		if (gpreagg->kcmp_in)
+			gpreagg->m_kcmp_row = gpreagg->m_ghash +
+				GPUMEMALIGN(offsetof(kern_global_hashslot,
+									 hash_slot[gpreagg->kern.hash_size]));
+		else
+			gpreagg->m_kcmp_row = 0UL;
 	}
 	else
 	{
@@ -4796,14 +5513,12 @@ __gpupreagg_task_process(pgstrom_gpupreagg *gpreagg)
 
 	if (gpreagg->kern.reduction_mode != GPUPREAGG_ONLY_TERMINATION)
 	{
-		/* source data to be reduced */
-		length = KERN_DATA_STORE_LENGTH(pds_in->kds);
-		rc = cuMemcpyHtoDAsync(gpreagg->m_kds_row,
-							   pds_in->kds,
-							   length,
-							   gpreagg->task.cuda_stream);
-		if (rc != CUDA_SUCCESS)
-			elog(ERROR, "failed on cuMemcpyHtoDAsync: %s", errorText(rc));
+		/* source data to be reduced, or its compressed image */
+		length = pgstrom_dma_send_kds(&gpreagg->task,
+									  gpreagg->m_kds_row,
+									  pds_in->kds,
+									  gpreagg->m_kcmp_row,
+									  gpreagg->kcmp_in);
 		pfm->bytes_dma_send += length;
 		pfm->num_dma_send++;
 
@@ -5021,6 +5736,33 @@ pgstrom_init_gpupreagg(void)
 							 PGC_USERSET,
                              GUC_NOT_IN_SAMPLE,
                              NULL, NULL, NULL);
+	/* pg_strom.enable_gpupreagg_distinct */
+	DefineCustomBoolVariable("pg_strom.enable_gpupreagg_distinct",
+							 "Enables GpuPreAgg to de-duplicate arguments of DISTINCT aggregates as grouping keys",
+							 NULL,
+							 &enable_gpupreagg_distinct,
+							 true,
+							 PGC_USERSET,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
+	/* pg_strom.enable_gpupreagg_numeric_fixed */
+	DefineCustomBoolVariable("pg_strom.enable_gpupreagg_numeric_fixed",
+							 "Enables GpuPreAgg to run sum/avg of numeric(p,s) in fixed-point",
+							 NULL,
+							 &enable_gpupreagg_numeric_fixed,
+							 true,
+							 PGC_USERSET,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
+	/* pg_strom.enable_gpupreagg_adaptive */
+	DefineCustomBoolVariable("pg_strom.enable_gpupreagg_adaptive",
+							 "Enables to switch reduction mode of GpuPreAgg by the observed number of groups",
+							 NULL,
+							 &enable_gpupreagg_adaptive,
+							 true,
+							 PGC_USERSET,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
 
 	/* initialization of plan method table */
 	memset(&gpupreagg_scan_methods, 0, sizeof(CustomScanMethods));
@@ -16,16 +16,19 @@
  * GNU General Public License for more details.
  */
 #include "postgres.h"
+#include "access/genam.h"
 #include "access/relscan.h"
 #include "access/sysattr.h"
 #include "access/xact.h"
 #include "catalog/heap.h"
+#include "catalog/pg_am.h"
 #include "catalog/pg_namespace.h"
 #include "catalog/pg_type.h"
 #include "executor/nodeCustom.h"
 #include "miscadmin.h"
 #include "nodes/makefuncs.h"
 #include "nodes/nodeFuncs.h"
+#include "nodes/tidbitmap.h"
 #include "optimizer/clauses.h"
 #include "optimizer/cost.h"
 #include "optimizer/pathnode.h"
@@ -52,6 +55,10 @@ static CustomScanMethods	gpuscan_plan_methods;
 static CustomExecMethods	gpuscan_exec_methods;
 static bool					enable_gpuscan;
 static bool					enable_pullup_outer_scan;
+static int					scan_prefetch_chunks;
+static bool					enable_column_format;
+static double				gpuscan_late_materialize;
+static bool					enable_brin_skip;
 
 /*
  * Path information of GpuScan
@@ -77,6 +84,11 @@ typedef struct {
 	cl_int      base_fixed_width; /* width of fixed fields on base rel */
     cl_int      proj_fixed_width; /* width of fixed fields on projection */
     cl_int      proj_extra_width; /* width of extra buffer on projection */
+	List	   *column_refs;	/* attnums to be loaded, if column format */
+	Oid			brin_index_oid;	/* BRIN index for block skipping, if any */
+	List	   *brin_keys;		/* (indexcol, strategy, subtype, collid,
+								 * opfuncid) for each key, as int list */
+	List	   *brin_exprs;		/* pseudo-constant side of the keys */
 } GpuScanInfo;
 
 static inline void
@@ -98,6 +110,10 @@ form_gpuscan_info(CustomScan *cscan, GpuScanInfo *gs_info)
 	privs = lappend(privs, makeInteger(gs_info->base_fixed_width));
 	privs = lappend(privs, makeInteger(gs_info->proj_fixed_width));
 	privs = lappend(privs, makeInteger(gs_info->proj_extra_width));
+	privs = lappend(privs, gs_info->column_refs);
+	privs = lappend(privs, makeInteger(gs_info->brin_index_oid));
+	privs = lappend(privs, gs_info->brin_keys);
+	exprs = lappend(exprs, gs_info->brin_exprs);
 
 	cscan->custom_private = privs;
     cscan->custom_exprs = exprs;
@@ -124,6 +140,10 @@ deform_gpuscan_info(CustomScan *cscan)
 	gs_info->base_fixed_width = intVal(list_nth(privs, pindex++));
 	gs_info->proj_fixed_width = intVal(list_nth(privs, pindex++));
 	gs_info->proj_extra_width = intVal(list_nth(privs, pindex++));
+	gs_info->column_refs = list_nth(privs, pindex++);
+	gs_info->brin_index_oid = intVal(list_nth(privs, pindex++));
+	gs_info->brin_keys = list_nth(privs, pindex++);
+	gs_info->brin_exprs = list_nth(exprs, eindex++);
 
 	return gs_info;
 }
@@ -137,14 +157,19 @@ typedef struct
 	CUdeviceptr		m_gpuscan;
 	CUdeviceptr		m_kds_src;
 	CUdeviceptr		m_kds_dst;
+	CUdeviceptr		m_kcmp_src;		/* compressed image of kds_src */
 	CUevent 		ev_dma_send_start;
 	CUevent			ev_dma_send_stop;
 	CUevent			ev_kern_exec_quals;
 	CUevent			ev_dma_recv_start;
 	CUevent			ev_dma_recv_stop;
+	GpuTaskTuning	tune_quals;		/* autotuner of kern_exec_quals */
 	pgstrom_data_store *pds_src;
 	pgstrom_data_store *pds_dst;
+	kern_compressed_kds *kcmp_src;	/* compressed image of pds_src, if any */
+	bool			kcmp_checked;	/* true, if compression is tried */
 	kern_resultbuf *kresults;
+	bool			late_materialize;	/* host projection on pds_src */
 	kern_gpuscan	kern;
 } pgstrom_gpuscan;
 
@@ -158,6 +183,18 @@ typedef struct {
 	cl_int			base_fixed_width; /* width of fixed fields on base rel */
 	cl_int			proj_fixed_width; /* width of fixed fields on projection */
 	cl_int			proj_extra_width; /* width of extra buffer on projection */
+	Bitmapset	   *column_refs;	/* columns to be loaded, if column format */
+	double			column_ntups;	/* estimated number of tuples per block */
+	bool			ccache_enabled;	/* true, if columnar cache is available */
+	/* run-time statistics for late materialization */
+	double			stat_nitems_in;	/* # of rows in the source chunks */
+	double			stat_nitems_out;/* # of rows passed the dev_quals */
+	double			plan_selectivity; /* estimation by the planner */
+	/* block skipping using BRIN index */
+	Oid				brin_index_oid;	/* InvalidOid, if not available */
+	List		   *brin_keys;		/* int list of the scan-key properties */
+	List		   *brin_exprs;		/* ExprState of the scan-key values */
+	bool			brin_map_ready;	/* true, if scan_block_map is built */
 	/* resource for CPU fallback */
 	TupleTableSlot *base_slot;
 	ProjectionInfo *base_proj;
@@ -169,6 +206,8 @@ static bool pgstrom_complete_gpuscan(GpuTask *gtask);
 static void pgstrom_release_gpuscan(GpuTask *gtask);
 static GpuTask *gpuscan_next_chunk(GpuTaskState *gts);
 static TupleTableSlot *gpuscan_next_tuple(GpuTaskState *gts);
+static pgstrom_data_store *gpuscan_exec_bulk(GpuTaskState *gts,
+											 size_t chunk_size);
 
 /* dummy kernel source if no device qualifier is given */
 #define GPUSCAN_KERN_SOURCE_NO_DEVQUAL					\
@@ -555,6 +594,112 @@ pgstrom_pullup_outer_scan(Plan *plannode,
 	return true;
 }
 
+/*
+ * gpuscan_choose_brin_index
+ *
+ * It looks for a BRIN index on the base relation that can summarize the
+ * scan qualifiers in the form of "Var OP pseudo-constant". If any, the
+ * executor consults the index prior to the scan, then skips the blocks
+ * that never contain the rows to be picked up.
+ */
+static void
+gpuscan_choose_brin_index(RelOptInfo *rel, List *quals,
+						  GpuScanInfo *gs_info)
+{
+	ListCell   *lc1;
+	ListCell   *lc2;
+	int			best_nkeys = 0;
+
+	if (!enable_brin_skip)
+		return;
+
+	foreach (lc1, rel->indexlist)
+	{
+		IndexOptInfo   *index = lfirst(lc1);
+		List		   *brin_keys = NIL;
+		List		   *brin_exprs = NIL;
+		int				nkeys = 0;
+
+		if (index->relam != BRIN_AM_OID || index->indpred != NIL)
+			continue;
+
+		foreach (lc2, quals)
+		{
+			OpExpr	   *op = lfirst(lc2);
+			Node	   *lnode;
+			Node	   *rnode;
+			Var		   *var;
+			Oid			opno;
+			int			indexcol;
+			int			strategy;
+			Oid			lefttype;
+			Oid			righttype;
+
+			if (!IsA(op, OpExpr) || list_length(op->args) != 2)
+				continue;
+			lnode = linitial(op->args);
+			rnode = lsecond(op->args);
+			if (IsA(lnode, RelabelType))
+				lnode = (Node *)((RelabelType *) lnode)->arg;
+			if (IsA(rnode, RelabelType))
+				rnode = (Node *)((RelabelType *) rnode)->arg;
+
+			/* Var OP pseudo-constant, or its commutator */
+			if (IsA(lnode, Var))
+			{
+				var = (Var *) lnode;
+				rnode = lsecond(op->args);
+				opno = op->opno;
+			}
+			else if (IsA(rnode, Var))
+			{
+				var = (Var *) rnode;
+				rnode = linitial(op->args);
+				opno = get_commutator(op->opno);
+				if (!OidIsValid(opno))
+					continue;
+			}
+			else
+				continue;
+
+			if (var->varno != rel->relid ||
+				var->varlevelsup > 0 ||
+				var->varattno <= 0 ||
+				contain_var_clause(rnode) ||
+				contain_volatile_functions(rnode))
+				continue;
+
+			for (indexcol = 0; indexcol < index->ncolumns; indexcol++)
+			{
+				if (index->indexkeys[indexcol] != var->varattno ||
+					!op_in_opfamily(opno, index->opfamily[indexcol]))
+					continue;
+				get_op_opfamily_properties(opno, index->opfamily[indexcol],
+										   false,
+										   &strategy,
+										   &lefttype,
+										   &righttype);
+				brin_keys = lappend_int(brin_keys, indexcol + 1);
+				brin_keys = lappend_int(brin_keys, strategy);
+				brin_keys = lappend_int(brin_keys, righttype);
+				brin_keys = lappend_int(brin_keys, op->inputcollid);
+				brin_keys = lappend_int(brin_keys, get_opcode(opno));
+				brin_exprs = lappend(brin_exprs, copyObject(rnode));
+				nkeys++;
+				break;
+			}
+		}
+
+		if (nkeys > best_nkeys)
+		{
+			gs_info->brin_index_oid = index->indexoid;
+			gs_info->brin_keys = brin_keys;
+			gs_info->brin_exprs = brin_exprs;
+			best_nkeys = nkeys;
+		}
+	}
+}
+
 /*
  * Code generator for GpuScan's qualifier
  */
@@ -658,6 +803,9 @@ create_gpuscan_plan(PlannerInfo *root,
 	gs_info.used_params = context.used_params;
 	gs_info.used_vars = context.used_vars;
 	gs_info.dev_quals = dev_quals;
+	gpuscan_choose_brin_index(rel, list_concat(list_copy(dev_quals),
+											   list_copy(host_quals)),
+							  &gs_info);
 	form_gpuscan_info(cscan, &gs_info);
 	cscan->flags = best_path->flags;
 	cscan->methods = &gpuscan_plan_methods;
@@ -1520,6 +1668,45 @@ build_device_projection(Index scanrelid,
 	return true;
 }
 
+/*
+ * gpuscan_column_references
+ *
+ * It returns a list of attribute numbers referenced by the GpuScan, if
+ * KDS_FORMAT_COLUMN is applicable for the source data store. We cannot
+ * use the column format if any system column or whole-row reference
+ * exists, because virtual tuples don't have them.
+ */
+static List *
+gpuscan_column_references(CustomScan *cscan, List *dev_quals,
+						  TupleDesc tupdesc)
+{
+	Index		scanrelid = cscan->scan.scanrelid;
+	Bitmapset  *varattnos = NULL;
+	List	   *column_refs = NIL;
+	int			prev = -1;
+
+	pull_varattnos((Node *) cscan->scan.plan.targetlist,
+				   scanrelid, &varattnos);
+	pull_varattnos((Node *) cscan->scan.plan.qual,
+				   scanrelid, &varattnos);
+	pull_varattnos((Node *) dev_quals,
+				   scanrelid, &varattnos);
+
+	while ((prev = bms_next_member(varattnos, prev)) >= 0)
+	{
+		int		anum = prev + FirstLowInvalidHeapAttributeNumber;
+
+		if (anum <= 0)
+			return NIL;
+		column_refs = lappend_int(column_refs, anum);
+	}
+	/* row format is cheaper if all the columns are referenced */
+	if (list_length(column_refs) >= tupdesc->natts)
+		return NIL;
+
+	return column_refs;
+}
+
 /*
  * pgstrom_post_planner_gpuscan
  *
@@ -1690,6 +1877,18 @@ pgstrom_post_planner_gpuscan(PlannedStmt *pstmt, Plan **p_curr_plan)
 	gs_info->used_params = context.used_params;
 	gs_info->used_vars = context.used_vars;
 	gs_info->force_row_format = force_row_format;
+	/*
+	 * Column format is valid only if no device projection; kern_resultbuf
+	 * shall have index of the visible rows on the source data store.
+	 */
+	gs_info->column_refs = NIL;
+	if (enable_column_format &&
+		force_row_format &&
+		cscan->custom_scan_tlist == NIL &&
+		gs_info->dev_quals != NIL)
+		gs_info->column_refs = gpuscan_column_references(cscan,
+														 gs_info->dev_quals,
+														 tupdesc);
 	form_gpuscan_info(cscan, gs_info);
 
 	heap_close(baserel, NoLock);
@@ -1746,6 +1945,7 @@ gpuscan_begin(CustomScanState *node, EState *estate, int eflags)
 	GpuScanState   *gss = (GpuScanState *) node;
 	CustomScan	   *cscan = (CustomScan *)node->ss.ps.plan;
 	GpuScanInfo	   *gs_info = deform_gpuscan_info(cscan);
+	ListCell	   *lc;
 
 	/* gpuscan should not have inner/outer plan right now */
 	Assert(outerPlan(node) == NULL);
@@ -1766,7 +1966,7 @@ gpuscan_begin(CustomScanState *node, EState *estate, int eflags)
 	if (pgstrom_bulkexec_enabled &&
 		gss->gts.css.ss.ps.qual == NIL &&
 		gss->gts.css.ss.ps.ps_ProjInfo == NULL)
-		gss->gts.cb_bulk_exec = pgstrom_exec_chunk_gputask;
+		gss->gts.cb_bulk_exec = gpuscan_exec_bulk;
 
 	/* Is 'row' format required? */
 	if (gs_info->force_row_format)
@@ -1784,6 +1984,33 @@ gpuscan_begin(CustomScanState *node, EState *estate, int eflags)
 	gss->base_fixed_width = gs_info->base_fixed_width;
 	gss->proj_fixed_width = gs_info->proj_fixed_width;
 	gss->proj_extra_width = gs_info->proj_extra_width;
+	/* columns to be loaded, if column format is applicable */
+	gss->column_refs = NULL;
+	foreach (lc, gs_info->column_refs)
+		gss->column_refs = bms_add_member(gss->column_refs, lfirst_int(lc));
+	if (scan_rel->rd_rel->relpages > 0)
+		gss->column_ntups = 1.25 * (scan_rel->rd_rel->reltuples /
+									(double) scan_rel->rd_rel->relpages);
+	else
+		gss->column_ntups = (double) MaxHeapTuplesPerPage;
+	gss->stat_nitems_in = 0.0;
+	gss->stat_nitems_out = 0.0;
+	if (scan_rel->rd_rel->reltuples > 0.0)
+		gss->plan_selectivity = (cscan->scan.plan.plan_rows /
+								 scan_rel->rd_rel->reltuples);
+	else
+		gss->plan_selectivity = 1.0;
+	gss->column_ntups = Max(Min(gss->column_ntups,
+								(double) MaxHeapTuplesPerPage), 1.0);
+	gss->ccache_enabled = (gss->column_refs != NULL &&
+						   pgstrom_ccache_enabled(scan_rel,
+												  estate->es_snapshot));
+	/* BRIN index to skip blocks, if any */
+	gss->brin_index_oid = gs_info->brin_index_oid;
+	gss->brin_keys = gs_info->brin_keys;
+	gss->brin_exprs = (List *)
+		ExecInitExpr((Expr *) gs_info->brin_exprs, &gss->gts.css.ss.ps);
+	gss->brin_map_ready = false;
 	/* 'tableoid' should not change during relation scan */
 	gss->scan_tuple.t_tableOid = RelationGetRelid(scan_rel);
 	/* assign kernel source and flags */
@@ -1792,7 +2019,7 @@ gpuscan_begin(CustomScanState *node, EState *estate, int eflags)
 								gs_info->kern_source,
 								gs_info->extra_flags);
 	/* preload the CUDA program, if actually executed */
-	if ((eflags & EXEC_FLAG_EXPLAIN_ONLY) == 0)
+	if (PGSTROM_PRELOAD_CUDA_PROGRAM(eflags))
 		pgstrom_load_cuda_program(&gss->gts, true);
 	/* initialize resource for CPU fallback */
 	gss->base_slot = MakeSingleTupleTableSlot(RelationGetDescr(scan_rel));
@@ -1829,13 +2056,49 @@ pgstrom_release_gpuscan(GpuTask *gputask)
 
 	if (gpuscan->pds_src)
 		PDS_release(gpuscan->pds_src);
+	gpuscan->pds_src = NULL;
 	if (gpuscan->pds_dst)
 		PDS_release(gpuscan->pds_dst);
+	gpuscan->pds_dst = NULL;
+	if (gpuscan->kcmp_src)
+		pfree(gpuscan->kcmp_src);
+	gpuscan->kcmp_src = NULL;
 	pgstrom_complete_gpuscan(&gpuscan->task);
 
 	pfree(gpuscan);
 }
 
+/*
+ * gpuscan_late_materialize_enabled
+ *
+ * It returns true, if the next chunk shall be processed by the late
+ * materialization mode. Once least rows can survive dev_quals, device
+ * projection is waste of device memory and DMA; kernel can return only
+ * the offset of the visible rows, then host can make a projection from
+ * the source data store that is already on the host memory.
+ * Selectivity is estimated using the run-time statistics if any, or the
+ * planner's estimation on the first chunk.
+ */
+static bool
+gpuscan_late_materialize_enabled(GpuScanState *gss,
+								 pgstrom_data_store *pds_src)
+{
+	double		selectivity;
+
+	if (gpuscan_late_materialize <= 0.0 ||
+		!gss->dev_projection ||
+		gss->dev_quals == NIL ||
+		pds_src->kds->format != KDS_FORMAT_ROW)
+		return false;
+
+	if (gss->stat_nitems_in > 0.0)
+		selectivity = gss->stat_nitems_out / gss->stat_nitems_in;
+	else
+		selectivity = gss->plan_selectivity;
+
+	return (selectivity < gpuscan_late_materialize);
+}
+
 static pgstrom_gpuscan *
 create_pgstrom_gpuscan_task(GpuScanState *gss, pgstrom_data_store *pds_src)
 {
@@ -1845,12 +2108,16 @@ create_pgstrom_gpuscan_task(GpuScanState *gss, pgstrom_data_store *pds_src)
 	kern_resultbuf	   *kresults;
 	kern_data_store	   *kds_src = pds_src->kds;
 	pgstrom_data_store *pds_dst;
+	bool				late_materialize;
 	Size				length;
 
 	/*
 	 * allocation of the destination buffer
 	 */
-	if (gss->gts.be_row_format)
+	late_materialize = gpuscan_late_materialize_enabled(gss, pds_src);
+	if (late_materialize)
+		pds_dst = NULL;		/* kernel returns offset of the rows only */
+	else if (gss->gts.be_row_format)
 	{
 		/*
 		 * NOTE: When we have no device projection and row-format
@@ -1893,6 +2160,7 @@ create_pgstrom_gpuscan_task(GpuScanState *gss, pgstrom_data_store *pds_src)
 
 	gpuscan->pds_src = pds_src;
 	gpuscan->pds_dst = pds_dst;
+	gpuscan->late_materialize = late_materialize;
 
 	/* setting up kern_parambuf */
 	memcpy(KERN_GPUSCAN_PARAMBUF(&gpuscan->kern),
@@ -1912,18 +2180,89 @@ create_pgstrom_gpuscan_task(GpuScanState *gss, pgstrom_data_store *pds_src)
 }
 
 /*
- * pgstrom_exec_scan_chunk
+ * pgstrom_scan_block_skippable
  *
- * It makes advance the scan pointer of the relation.
+ * It returns true if the block summary tells the block never contains
+ * the rows to be picked up.
  */
-pgstrom_data_store *
-pgstrom_exec_scan_chunk(GpuTaskState *gts, Size chunk_length)
+static inline bool
+pgstrom_scan_block_skippable(GpuTaskState *gts, BlockNumber blkno)
+{
+	if (!gts->scan_block_map || blkno >= gts->scan_block_map_nblocks)
+		return false;
+	return ((gts->scan_block_map[blkno / BITS_PER_BYTE] &
+			 (1 << (blkno % BITS_PER_BYTE))) == 0);
+}
+
+/*
+ * pgstrom_prefetch_scan_blocks
+ *
+ * It issues prefetch requests on the blocks to be loaded by the current
+ * and the next pg_strom.scan_prefetch_chunks chunks, prior to the
+ * synchronous PDS_insert_block() calls. Because the asynchronous tasks
+ * already in-flight keep GPU busy, kernel's read-ahead overlaps with the
+ * DMA and kernel execution, instead of the heap walking by ourselves.
+ *
+ * NOTE: PrefetchBuffer() does not load the blocks into shared buffers,
+ * so it never breaks the ring buffer of BufferAccessStrategy.
+ */
+static void
+pgstrom_prefetch_scan_blocks(GpuTaskState *gts, Size chunk_length)
+{
+#ifdef USE_PREFETCH
+	HeapScanDesc	scan = gts->css.ss.ss_currentScanDesc;
+	BlockNumber		curr_pos;
+	BlockNumber		last_pos;
+	BlockNumber		blkno;
+
+	if (scan_prefetch_chunks <= 0)
+		return;
+
+	/* position of the block to be read next, from the rs_startblock */
+	curr_pos = ((scan->rs_cblock + scan->rs_nblocks - scan->rs_startblock)
+				% scan->rs_nblocks);
+	last_pos = curr_pos + ((chunk_length / BLCKSZ) *
+						   (Size)(scan_prefetch_chunks + 1));
+	if (scan->rs_numblocks != InvalidBlockNumber)
+		last_pos = Min(last_pos, curr_pos + scan->rs_numblocks);
+	last_pos = Min(last_pos, scan->rs_nblocks);
+
+	if (gts->scan_prefetch_pos < curr_pos)
+		gts->scan_prefetch_pos = curr_pos;
+	while (gts->scan_prefetch_pos < last_pos)
+	{
+		blkno = ((scan->rs_startblock + gts->scan_prefetch_pos)
+				 % scan->rs_nblocks);
+		if (!pgstrom_scan_block_skippable(gts, blkno))
+			PrefetchBuffer(scan->rs_rd, MAIN_FORKNUM, blkno);
+		gts->scan_prefetch_pos++;
+	}
+#endif
+}
+
+/*
+ * __pgstrom_exec_scan_chunk
+ *
+ * It makes advance the scan pointer of the relation. If 'column_refs' is
+ * given, the data store shall be KDS_FORMAT_COLUMN that holds only the
+ * referenced columns. If 'use_ccache' is also true, it tries to pick up
+ * the chunk from the columnar cache, or put the loaded chunk on the cache.
+ */
+static pgstrom_data_store *
+__pgstrom_exec_scan_chunk(GpuTaskState *gts, Size chunk_length,
+						  Bitmapset *column_refs, cl_uint column_nrooms,
+						  bool use_ccache)
 {
 	Relation		base_rel = gts->css.ss.ss_currentRelation;
 	TupleDesc		tupdesc = RelationGetDescr(base_rel);
 	HeapScanDesc	scan = gts->css.ss.ss_currentScanDesc;
 	pgstrom_data_store *pds = NULL;
 	bool			finished = false;
+	BlockNumber		block_start;
+	BlockNumber		block_nums = 0;
+	bool			contiguous = true;
+	cl_ulong		generation = 0;
+	XLogRecPtr		load_lsn = InvalidXLogRecPtr;
 	struct timeval	tv1, tv2;
 
 	/* return NULL if relation is empty */
@@ -1935,14 +2274,63 @@ pgstrom_exec_scan_chunk(GpuTaskState *gts, Size chunk_length)
 	else if (scan->rs_cblock == scan->rs_startblock)
 		return NULL;	/* already goes around the relation */
 	Assert(scan->rs_cblock < scan->rs_nblocks);
+	block_start = scan->rs_cblock;
 
 	InstrStartNode(&gts->outer_instrument);
 	PERFMON_BEGIN(&gts->pfm, &tv1);
-	pds = PDS_create_row(gts->gcontext,
-						 tupdesc,
-						 chunk_length);
+	Assert(!use_ccache || column_refs != NULL);
+	if (use_ccache)
+	{
+		BlockNumber	block_limit;
+
+		/* a cached chunk never goes across the end of relation */
+		if (scan->rs_cblock < scan->rs_startblock)
+			block_limit = scan->rs_startblock - scan->rs_cblock;
+		else
+			block_limit = scan->rs_nblocks - scan->rs_cblock;
+		if (scan->rs_numblocks != InvalidBlockNumber)
+			block_limit = Min(block_limit, scan->rs_numblocks);
+
+		pds = pgstrom_ccache_lookup(gts->gcontext,
+									base_rel,
+									column_refs,
+									scan->rs_cblock,
+									block_limit,
+									&block_nums);
+		if (pds)
+		{
+			/* move to the next block of the cached chunk */
+			scan->rs_cblock += block_nums;
+			if (scan->rs_cblock >= scan->rs_nblocks)
+				scan->rs_cblock = 0;
+			if (scan->rs_syncscan)
+				ss_report_location(scan->rs_rd, scan->rs_cblock);
+			if (scan->rs_numblocks != InvalidBlockNumber)
+				scan->rs_numblocks -= block_nums;
+
+			PERFMON_END(&gts->pfm, time_outer_load, &tv1, &tv2);
+			InstrStopNode(&gts->outer_instrument,
+						  (double)pds->kds->nitems);
+			return pds;
+		}
+		generation = pgstrom_ccache_generation(base_rel, &load_lsn);
+	}
+
+	if (column_refs != NULL)
+		pds = PDS_create_column(gts->gcontext,
+								tupdesc,
+								column_refs,
+								column_nrooms,
+								chunk_length);
+	else
+		pds = PDS_create_row(gts->gcontext,
+							 tupdesc,
+							 chunk_length);
 	pds->kds->table_oid = RelationGetRelid(base_rel);
 
+	/* kick read-ahead of the blocks to be loaded soon */
+	pgstrom_prefetch_scan_blocks(gts, chunk_length);
+
 	/*
 	 * TODO: We have to stop block insert if and when device projection
 	 * will increase the buffer consumption than threshold.
@@ -1954,11 +2342,20 @@ pgstrom_exec_scan_chunk(GpuTaskState *gts, Size chunk_length)
 	/* fill up this data-store */
 	while (!finished)
 	{
-		if (PDS_insert_block(pds, base_rel,
-							 scan->rs_cblock,
-							 scan->rs_snapshot,
-							 scan->rs_strategy) < 0)
-			break;
+		if (pgstrom_scan_block_skippable(gts, scan->rs_cblock))
+			gts->scan_block_skipped++;
+		else
+		{
+			if (scan->rs_cblock != block_start + block_nums)
+				contiguous = false;
+			if (PDS_insert_block(pds, base_rel,
+								 scan->rs_cblock,
+								 scan->rs_snapshot,
+								 scan->rs_strategy,
+								 gts) < 0)
+				break;
+			block_nums++;
+		}
 
 		/* move to the next block */
 		scan->rs_cblock++;
@@ -1978,12 +2375,33 @@ pgstrom_exec_scan_chunk(GpuTaskState *gts, Size chunk_length)
 		PDS_release(pds);
 		pds = NULL;
 	}
+	else if (column_refs != NULL)
+	{
+		/* release unused extra area, then put on the columnar cache */
+		PDS_shrink_size(pds);
+		if (use_ccache && contiguous)
+			pgstrom_ccache_insert(base_rel, pds,
+								  block_start, block_nums,
+								  generation, load_lsn);
+	}
 	PERFMON_END(&gts->pfm, time_outer_load, &tv1, &tv2);
 	InstrStopNode(&gts->outer_instrument,
 				  !pds ? 0.0 : (double)pds->kds->nitems);
 	return pds;
 }
 
+/*
+ * pgstrom_exec_scan_chunk
+ *
+ * It makes advance the scan pointer of the relation, then returns a data
+ * store of KDS_FORMAT_ROW.
+ */
+pgstrom_data_store *
+pgstrom_exec_scan_chunk(GpuTaskState *gts, Size chunk_length)
+{
+	return __pgstrom_exec_scan_chunk(gts, chunk_length, NULL, 0, false);
+}
+
 /*
  * pgstrom_rewind_scan_chunk - rewind the position to read
  */
@@ -1993,17 +2411,138 @@ pgstrom_rewind_scan_chunk(GpuTaskState *gts)
 	InstrEndLoop(&gts->outer_instrument);
 	Assert(gts->css.ss.ss_currentRelation != NULL);
 	heap_rescan(gts->css.ss.ss_currentScanDesc, NULL);
+	gts->scan_prefetch_pos = 0;
 	ExecScanReScan(&gts->css.ss);
 }
 
+/*
+ * gpuscan_build_block_map
+ *
+ * It walks on the BRIN index prior to the first chunk, then marks the
+ * blocks that may contain the rows to be picked up. The rest of blocks
+ * shall be skipped by __pgstrom_exec_scan_chunk().
+ */
+static void
+gpuscan_build_block_map(GpuScanState *gss)
+{
+	GpuTaskState   *gts = &gss->gts;
+	EState		   *estate = gts->css.ss.ps.state;
+	ExprContext	   *econtext = gts->css.ss.ps.ps_ExprContext;
+	HeapScanDesc	scan = gts->css.ss.ss_currentScanDesc;
+	Relation		index_rel;
+	IndexScanDesc	index_scan;
+	ScanKey			scan_keys;
+	TIDBitmap	   *tbm;
+	TBMIterator	   *iterator;
+	TBMIterateResult *tbmres;
+	BlockNumber		nblocks = scan->rs_nblocks;
+	int				nkeys = list_length(gss->brin_exprs);
+	int				i = 0;
+	ListCell	   *lc1;
+	ListCell	   *lc2;
+
+	if (nblocks == 0)
+		return;
+
+	scan_keys = palloc0(sizeof(ScanKeyData) * nkeys);
+	lc1 = list_head(gss->brin_keys);
+	foreach (lc2, gss->brin_exprs)
+	{
+		ExprState  *expr_state = lfirst(lc2);
+		AttrNumber	indexcol;
+		int			strategy;
+		Oid			subtype;
+		Oid			collid;
+		Oid			opfuncid;
+		Datum		value;
+		bool		isnull;
+
+		indexcol = lfirst_int(lc1);
+		lc1 = lnext(lc1);
+		strategy = lfirst_int(lc1);
+		lc1 = lnext(lc1);
+		subtype = lfirst_int(lc1);
+		lc1 = lnext(lc1);
+		collid = lfirst_int(lc1);
+		lc1 = lnext(lc1);
+		opfuncid = lfirst_int(lc1);
+		lc1 = lnext(lc1);
+
+		value = ExecEvalExprSwitchContext(expr_state, econtext,
+										  &isnull, NULL);
+		/* NULL never matches, but we don't take the risk here */
+		if (isnull)
+		{
+			pfree(scan_keys);
+			return;
+		}
+		ScanKeyEntryInitialize(&scan_keys[i++],
+							   0,
+							   indexcol,
+							   strategy,
+							   subtype,
+							   collid,
+							   opfuncid,
+							   value);
+	}
+
+	tbm = tbm_create(work_mem * 1024L);
+	index_rel = index_open(gss->brin_index_oid, AccessShareLock);
+	index_scan = index_beginscan_bitmap(index_rel, estate->es_snapshot, nkeys);
+	index_rescan(index_scan, scan_keys, nkeys, NULL, 0);
+	index_getbitmap(index_scan, tbm);
+	index_endscan(index_scan);
+	index_close(index_rel, NoLock);
+	ResetExprContext(econtext);
+
+	gts->scan_block_map = MemoryContextAllocZero(estate->es_query_cxt,
+												 (nblocks + BITS_PER_BYTE - 1)
+												 / BITS_PER_BYTE);
+	gts->scan_block_map_nblocks = nblocks;
+	iterator = tbm_begin_iterate(tbm);
+	while ((tbmres = tbm_iterate(iterator)) != NULL)
+	{
+		if (tbmres->blockno < nblocks)
+			gts->scan_block_map[tbmres->blockno / BITS_PER_BYTE]
+				|= (1 << (tbmres->blockno % BITS_PER_BYTE));
+	}
+	tbm_end_iterate(iterator);
+	tbm_free(tbm);
+	pfree(scan_keys);
+}
+
 static GpuTask *
 gpuscan_next_chunk(GpuTaskState *gts)
 {
 	GpuScanState	   *gss = (GpuScanState *) gts;
 	pgstrom_gpuscan	   *gpuscan;
 	pgstrom_data_store *pds;
+	Size				chunk_size = pgstrom_adaptive_chunk_size(gts);
 
-	pds = pgstrom_exec_scan_chunk(gts, pgstrom_chunk_size());
+	/* setup the map of blocks to be loaded, if BRIN index is available */
+	if (!gss->brin_map_ready)
+	{
+		if (OidIsValid(gss->brin_index_oid))
+			gpuscan_build_block_map(gss);
+		gss->brin_map_ready = true;
+	}
+
+	/*
+	 * Column format is available only when no destination buffer is
+	 * needed, thus host code references the source data store directly.
+	 */
+	if (gss->column_refs != NULL &&
+		gts->be_row_format && !gss->dev_projection)
+	{
+		cl_uint		nrooms = (cl_uint)(gss->column_ntups *
+									   (double)(chunk_size / BLCKSZ));
+
+		pds = __pgstrom_exec_scan_chunk(gts, chunk_size,
+										gss->column_refs, nrooms,
+										gss->ccache_enabled);
+	}
+	else
+		pds = pgstrom_exec_scan_chunk(gts, chunk_size);
 	if (!pds)
 		return NULL;
 
@@ -2011,6 +2550,56 @@ gpuscan_next_chunk(GpuTaskState *gts)
 	return &gpuscan->task;
 }
 
+/*
+ * gpuscan_exec_bulk
+ *
+ * Bulk-exec interface of GpuScan. Once the device projection built the
+ * row-format destination buffer, it is already what the upper node
+ * (GpuSort, GpuJoin or GpuPreAgg) wants to load, so we hand over the
+ * buffer as is, instead of the tuple-by-tuple copy into another data
+ * store by pgstrom_exec_chunk_gputask(). Elsewhere, e.g, CPU fallback,
+ * result index on pds_src or partially fetched buffer, it falls back to
+ * the generic bulk-exec logic.
+ */
+static pgstrom_data_store *
+gpuscan_exec_bulk(GpuTaskState *gts, size_t chunk_size)
+{
+	pgstrom_gpuscan	   *gpuscan;
+	pgstrom_data_store *pds_dst;
+
+	if (!gts->be_row_format)
+		return pgstrom_exec_chunk_gputask(gts, chunk_size);
+
+	if (!gts->curr_task)
+	{
+		GpuTask	   *gtask = pgstrom_fetch_gputask(gts);
+
+		if (!gtask)
+			return NULL;	/* end of the scan */
+		gts->curr_task = gtask;
+		gts->curr_index = 0;
+		if (gts->cb_switch_task)
+			gts->cb_switch_task(gts, gtask);
+	}
+	gpuscan = (pgstrom_gpuscan *) gts->curr_task;
+	pds_dst = gpuscan->pds_dst;
+
+	if (gpuscan->task.cpu_fallback ||
+		gts->curr_index > 0 ||
+		!pds_dst ||
+		pds_dst->kds->format != KDS_FORMAT_ROW ||
+		pds_dst->kds->nitems == 0)
+		return pgstrom_exec_chunk_gputask(gts, chunk_size);
+
+	/* hand over the result buffer, then detach the current task */
+	pds_dst = PDS_retain(pds_dst);
+	pgstrom_release_gputask(&gpuscan->task);
+	gts->curr_task = NULL;
+	gts->curr_index = 0;
+
+	return pds_dst;
+}
+
 static TupleTableSlot *
 gpuscan_next_tuple(GpuTaskState *gts)
 {
@@ -2045,10 +2634,50 @@ gpuscan_next_tuple(GpuTaskState *gts)
 			 * We should not inject GpuScan for all-visible with no device
 			 * projection; GPU has no actual works in other words.
 			 * NOTE: kresults->results[] keeps offset from the head of
-			 * kds_src.
+			 * kds_src, or row index if KDS_FORMAT_COLUMN.
 			 */
 			Assert(!kresults->all_visible);
-			if (gss->gts.curr_index < kresults->nitems)
+			if (gpuscan->late_materialize)
+			{
+				ExprContext	   *econtext = gss->gts.css.ss.ps.ps_ExprContext;
+				ExprDoneCond	is_done;
+
+				/* makes a projection on the host side */
+				while (gss->gts.curr_index < kresults->nitems)
+				{
+					HeapTuple		tuple = &gss->scan_tuple;
+					kern_tupitem   *tupitem = (kern_tupitem *)
+						((char *)pds_src->kds +
+						 kresults->results[gss->gts.curr_index++]);
+
+					tuple->t_len = tupitem->t_len;
+					tuple->t_self = tupitem->t_self;
+					tuple->t_data = &tupitem->htup;
+					ExecStoreTuple(tuple, gss->base_slot,
+								   InvalidBuffer, false);
+
+					ResetExprContext(econtext);
+					econtext->ecxt_scantuple = gss->base_slot;
+					slot = ExecProject(gss->base_proj, &is_done);
+					if (is_done != ExprEndResult)
+						break;
+					slot = NULL;
+				}
+			}
+			else if (pds_src->kds->format == KDS_FORMAT_COLUMN)
+			{
+				if (gss->gts.curr_index < kresults->nitems)
+				{
+					cl_uint		index
+						= kresults->results[gss->gts.curr_index++];
+
+					slot = gss->gts.css.ss.ss_ScanTupleSlot;
+					if (!pgstrom_fetch_data_store(slot, pds_src, index,
+												  &gss->scan_tuple))
+						elog(ERROR, "failed to fetch a record from pds");
+				}
+			}
+			else if (gss->gts.curr_index < kresults->nitems)
 			{
 				HeapTuple		tuple = &gss->scan_tuple;
 				kern_tupitem   *tupitem = (kern_tupitem *)
@@ -2196,6 +2825,12 @@ gpuscan_rescan(CustomScanState *node)
     pgstrom_cleanup_gputaskstate(&gss->gts);
 	/* OK, rewind the position to read */
 	pgstrom_rewind_scan_chunk(&gss->gts);
+	/* parameters of the BRIN scan-keys may be changed */
+	if (gss->gts.scan_block_map)
+		pfree(gss->gts.scan_block_map);
+	gss->gts.scan_block_map = NULL;
+	gss->gts.scan_block_map_nblocks = 0;
+	gss->brin_map_ready = false;
 }
 
 static void
@@ -2223,6 +2858,15 @@ gpuscan_explain(CustomScanState *node, List *ancestors, ExplainState *es)
 							   &gss->gts.css.ss.ps, context,
                                ancestors, es, false, true);
 	// TODO: Add number of rows filtered by the device side
+	/* Show BRIN index for block skipping */
+	if (OidIsValid(gsinfo->brin_index_oid))
+	{
+		ExplainPropertyText("BRIN Index",
+							get_rel_name(gsinfo->brin_index_oid), es);
+		if (es->analyze)
+			ExplainPropertyLong("Skipped Blocks",
+								(long) gss->gts.scan_block_skipped, es);
+	}
 
 	pgstrom_explain_gputaskstate(&gss->gts, es);
 }
@@ -2248,6 +2892,46 @@ pgstrom_init_gpuscan(void)
 							 PGC_USERSET,
                              GUC_NOT_IN_SAMPLE,
                              NULL, NULL, NULL);
+	/* pg_strom.enable_column_format */
+	DefineCustomBoolVariable("pg_strom.enable_column_format",
+							 "Enables to load referenced columns only",
+							 NULL,
+							 &enable_column_format,
+							 true,
+							 PGC_USERSET,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
+	/* pg_strom.gpuscan_late_materialize */
+	DefineCustomRealVariable("pg_strom.gpuscan_late_materialize",
+							 "Selectivity of device qualifiers to switch GpuScan to the late materialization (0 to disable)",
+							 NULL,
+							 &gpuscan_late_materialize,
+							 0.01,
+							 0.0,
+							 1.0,
+							 PGC_USERSET,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
+	/* pg_strom.enable_brin_skip */
+	DefineCustomBoolVariable("pg_strom.enable_brin_skip",
+							 "Enables to skip blocks using BRIN index",
+							 NULL,
+							 &enable_brin_skip,
+							 true,
+							 PGC_USERSET,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
+	/* pg_strom.scan_prefetch_chunks */
+	DefineCustomIntVariable("pg_strom.scan_prefetch_chunks",
+							"Number of chunks to be prefetched by read-ahead",
+							NULL,
+							&scan_prefetch_chunks,
+							2,
+							0,
+							INT_MAX,
+							PGC_USERSET,
+							GUC_NOT_IN_SAMPLE,
+							NULL, NULL, NULL);
 
 	/* setup path methods */
 	memset(&gpuscan_path_methods, 0, sizeof(gpuscan_path_methods));
@@ -2281,6 +2965,7 @@ gpuscan_cleanup_cuda_resources(pgstrom_gpuscan *gpuscan)
 	CUDA_EVENT_DESTROY(gpuscan,ev_kern_exec_quals);
 	CUDA_EVENT_DESTROY(gpuscan,ev_dma_send_stop);
 	CUDA_EVENT_DESTROY(gpuscan,ev_dma_send_start);
+	pgstrom_tuning_cleanup(&gpuscan->tune_quals);
 
 	if (gpuscan->m_gpuscan)
 		gpuMemFree(&gpuscan->task, gpuscan->m_gpuscan);
@@ -2291,6 +2976,7 @@ gpuscan_cleanup_cuda_resources(pgstrom_gpuscan *gpuscan)
 	gpuscan->m_gpuscan = 0UL;
 	gpuscan->m_kds_src = 0UL;
 	gpuscan->m_kds_dst = 0UL;
+	gpuscan->m_kcmp_src = 0UL;
 }
 
 /*
@@ -2306,9 +2992,10 @@ pgstrom_complete_gpuscan(GpuTask *gtask)
 	pgstrom_gpuscan	   *gpuscan = (pgstrom_gpuscan *) gtask;
 	GpuTaskState	   *gts = gtask->gts;
 
+	/* number of tasks is counted regardless of perfmon, for gpustat */
+	gts->pfm.num_tasks++;
 	if (gts->pfm.enabled)
 	{
-		gts->pfm.num_tasks++;
 		CUDA_EVENT_ELAPSED(gpuscan,time_dma_send,
 						   gpuscan->ev_dma_send_start,
 						   gpuscan->ev_dma_send_stop,
@@ -2327,8 +3014,25 @@ pgstrom_complete_gpuscan(GpuTask *gtask)
 						   skip);
 	}
 skip:
+	if (gpuscan->task.kerror.errcode == StromError_Success)
+		pgstrom_tuning_feedback(&gpuscan->task, &gpuscan->tune_quals,
+								"gpuscan_exec_quals");
 	gpuscan_cleanup_cuda_resources(gpuscan);
 
+	/* run-time statistics for late materialization */
+	if (gpuscan->pds_src != NULL &&
+		gpuscan->task.kerror.errcode == StromError_Success &&
+		!gpuscan->task.cpu_fallback &&
+		!gpuscan->kresults->all_visible)
+	{
+		GpuScanState   *gss = (GpuScanState *) gts;
+
+		gss->stat_nitems_in += (double) gpuscan->pds_src->kds->nitems;
+		if (gpuscan->pds_dst)
+			gss->stat_nitems_out += (double) gpuscan->pds_dst->kds->nitems;
+		else
+			gss->stat_nitems_out += (double) gpuscan->kresults->nitems;
+	}
 	return true;
 }
 
@@ -2336,7 +3040,6 @@ static void
 pgstrom_respond_gpuscan(CUstream stream, CUresult status, void *private)
 {
 	pgstrom_gpuscan	   *gpuscan = private;
-	GpuTaskState	   *gts = gpuscan->task.gts;
 
 	/*
 	 * NOTE: We need to pay careful attention for invocation timing of
@@ -2389,25 +3092,10 @@ pgstrom_respond_gpuscan(CUstream stream, CUresult status, void *private)
 	}
 
 	/*
-	 * Remove the GpuTask from the running_tasks list, and attach it
-	 * on the completed_tasks list again. Note that this routine may
-	 * be called by CUDA runtime, prior to attachment of GpuTask on
-	 * the running_tasks by cuda_control.c.
+	 * Informs completion of the GpuTask to the backend; it shall be
+	 * moved from the running_tasks to the completed_tasks later.
 	 */
-	SpinLockAcquire(&gts->lock);
-	if (gpuscan->task.chain.prev && gpuscan->task.chain.next)
-	{
-		dlist_delete(&gpuscan->task.chain);
-		gts->num_running_tasks--;
-	}
-	if (gpuscan->task.kerror.errcode == StromError_Success)
-		dlist_push_tail(&gts->completed_tasks, &gpuscan->task.chain);
-	else
-		dlist_push_head(&gts->completed_tasks, &gpuscan->task.chain);
-	gts->num_completed_tasks++;
-	SpinLockRelease(&gts->lock);
-
-	SetLatch(&MyProc->procLatch);
+	pgstrom_complete_gputask(&gpuscan->task);
 }
 
 static bool
@@ -2445,6 +3133,18 @@ __pgstrom_process_gpuscan(pgstrom_gpuscan *gpuscan)
 			elog(ERROR, "failed on cuModuleGetFunction: %s", errorText(rc));
 	}
 
+	/*
+	 * Compressed image of the source chunk, if enabled. It is kept across
+	 * the retry due to out of resources.
+	 */
+	if (!gpuscan->kcmp_checked)
+	{
+		gpuscan->kcmp_src = pgstrom_compress_kds(gss->gts.gcontext,
+												 pds_src->kds,
+												 &gss->gts.pfm);
+		gpuscan->kcmp_checked = true;
+	}
+
 	/*
 	 * Allocation of device memory
 	 */
@@ -2452,6 +3152,8 @@ __pgstrom_process_gpuscan(pgstrom_gpuscan *gpuscan)
 			  GPUMEMALIGN(KERN_DATA_STORE_LENGTH(pds_src->kds)));
 	if (pds_dst)
 		length += GPUMEMALIGN(KERN_DATA_STORE_LENGTH(pds_dst->kds));
+	if (gpuscan->kcmp_src)
+		length += GPUMEMALIGN(KERN_COMPRESSED_KDS_LENGTH(gpuscan->kcmp_src));
 
 	gpuscan->m_gpuscan = gpuMemAlloc(&gpuscan->task, length);
 	if (!gpuscan->m_gpuscan)
@@ -2466,6 +3168,13 @@ __pgstrom_process_gpuscan(pgstrom_gpuscan *gpuscan)
 	else
 		gpuscan->m_kds_dst = 0UL;
 
+	if (gpuscan->kcmp_src)
+		gpuscan->m_kcmp_src = gpuscan->m_kds_src +
+			GPUMEMALIGN(KERN_DATA_STORE_LENGTH(pds_src->kds)) +
+			(pds_dst ? GPUMEMALIGN(KERN_DATA_STORE_LENGTH(pds_dst->kds)) : 0);
+	else
+		gpuscan->m_kcmp_src = 0UL;
+
 	/*
 	 * Creation of event objects, if any
 	 */
@@ -2491,14 +3200,12 @@ __pgstrom_process_gpuscan(pgstrom_gpuscan *gpuscan)
 	gss->gts.pfm.bytes_dma_send += length;
 	gss->gts.pfm.num_dma_send++;
 
-	/* kern_data_store *kds_src */
-	length = KERN_DATA_STORE_LENGTH(pds_src->kds);
-	rc = cuMemcpyHtoDAsync(gpuscan->m_kds_src,
-						   pds_src->kds,
-						   length,
-						   gpuscan->task.cuda_stream);
-	if (rc != CUDA_SUCCESS)
-		elog(ERROR, "failed on cuMemcpyHtoDAsync: %s", errorText(rc));
+	/* kern_data_store *kds_src, or its compressed image */
+	length = pgstrom_dma_send_kds(&gpuscan->task,
+								  gpuscan->m_kds_src,
+								  pds_src->kds,
+								  gpuscan->m_kcmp_src,
+								  gpuscan->kcmp_src);
 	gss->gts.pfm.bytes_dma_send += length;
 	gss->gts.pfm.num_dma_send++;
 
@@ -2528,6 +3235,12 @@ __pgstrom_process_gpuscan(pgstrom_gpuscan *gpuscan)
 							   gpuscan->task.cuda_device,
 							   src_nitems,
 							   0, sizeof(kern_errorbuf));
+		pgstrom_tuning_begin(&gpuscan->task, &gpuscan->tune_quals,
+							 "gpuscan_exec_quals", src_nitems);
+		tuning_workgroup_size(&grid_size,
+							  &block_size,
+							  src_nitems,
+							  gpuscan->tune_quals.block_shift);
 		kern_args[0] = &gpuscan->m_gpuscan;
 		kern_args[1] = &gpuscan->m_kds_src;
 
@@ -2540,6 +3253,7 @@ __pgstrom_process_gpuscan(pgstrom_gpuscan *gpuscan)
 							NULL);
 		if (rc != CUDA_SUCCESS)
 			elog(ERROR, "failed on cuLaunchKernel: %s", errorText(rc));
+		pgstrom_tuning_end(&gpuscan->task, &gpuscan->tune_quals);
 		gss->gts.pfm.gscan.num_kern_exec_quals++;
 	}
 	else
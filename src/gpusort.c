@@ -31,6 +31,8 @@
 #include "utils/memutils.h"
 #include "utils/ruleutils.h"
 #include "utils/snapmgr.h"
+#include "utils/tuplestore.h"
+#include "utils/typcache.h"
 #include "pg_strom.h"
 #include "cuda_gpusort.h"
 
@@ -51,6 +53,8 @@ typedef struct
 	Oid		   *collations;		/* OIDs of collations */
 	bool	   *nullsFirst;		/* NULLS FIRST/LAST directions */
 	bool		varlena_keys;	/* True, if here are varlena keys */
+	int			radix_nbits;	/* width of radix sort key, or 0 */
+	cl_uint		bound_nitems;	/* top-K if bounded, or 0 */
 } GpuSortInfo;
 
 static inline void
@@ -87,6 +91,10 @@ form_gpusort_info(CustomScan *cscan, GpuSortInfo *gs_info)
 	privs = lappend(privs, temp);
 	/* varlena_keys */
 	privs = lappend(privs, makeInteger(gs_info->varlena_keys));
+	/* radix_nbits */
+	privs = lappend(privs, makeInteger(gs_info->radix_nbits));
+	/* bound_nitems */
+	privs = lappend(privs, makeInteger(gs_info->bound_nitems));
 
 	cscan->custom_private = privs;
 }
@@ -143,6 +151,10 @@ deform_gpusort_info(CustomScan *cscan)
 		gs_info->nullsFirst[i++] = lfirst_int(cell);
 	/* varlena_keys */
 	gs_info->varlena_keys = intVal(list_nth(privs, pindex++));
+	/* radix_nbits */
+	gs_info->radix_nbits = intVal(list_nth(privs, pindex++));
+	/* bound_nitems */
+	gs_info->bound_nitems = intVal(list_nth(privs, pindex++));
 
 	return gs_info;
 }
@@ -197,6 +209,11 @@ typedef struct
 	cl_uint		   *seg_curpos;	/* current position to fetch */
 	cl_uint		  **seg_lstree;	/* large-small tree */
 	cl_uint			seg_lstree_depth;	/* depth of lstree */
+	Tuplestorestate **seg_spill;	/* spill file of the segment, or NULL */
+	TupleTableSlot **seg_spill_slot;/* head tuple of the spilled segment */
+	bool			spill_enabled;	/* true, if segments can be spilled */
+	Size			spill_usage;	/* host memory held by sorted segments */
+	cl_uint			num_spilled;	/* number of spilled segments */
 	gpusort_segment	*curr_segment; /* the latest segment */
 	Size			segment_nrooms;	/* planned best nrooms per segment */
 	Size			segment_extra;	/* planned best extra length */
@@ -209,6 +226,8 @@ typedef struct
 	Oid			   *collations;		/* OIDs of collations */
 	bool		   *nullsFirst;		/* NULLS FIRST/LAST directions */
 	bool			varlena_keys;	/* True, if varlena sorting key exists */
+	int				radix_nbits;	/* width of radix sort key, or 0 */
+	cl_uint			bound_nitems;	/* top-K if bounded, or 0 */
 	SortSupportData *ssup_keys;		/* XXX - used by fallback function */
 
 	/* misc stuff */
@@ -224,6 +243,8 @@ static CustomScanMethods	gpusort_scan_methods;
 static CustomExecMethods	gpusort_exec_methods;
 static bool					enable_gpusort;
 static bool					debug_force_gpusort;
+static bool					enable_gpusort_radix;
+static int					gpusort_spill_threshold;
 
 static GpuTask *gpusort_next_chunk(GpuTaskState *gts);
 static TupleTableSlot *gpusort_next_tuple(GpuTaskState *gts);
@@ -243,13 +264,14 @@ static void gpusort_fallback_quicksort(GpuSortState *gss,
 #define LOG2(x)		(log(x) / 0.693147180559945)
 
 static void
-cost_gpusort(PlannedStmt *pstmt, Sort *sort,
+cost_gpusort(PlannedStmt *pstmt, Sort *sort, double limit_tuples,
 			 Cost *p_startup_cost, Cost *p_total_cost,
 			 cl_uint *p_num_segments,
 			 Size *p_segment_nrooms, Size *p_segment_extra)
 {
 	Plan	   *outer_plan = outerPlan(sort);
 	double		ntuples = outer_plan->plan_rows;
+	double		ntuples_fetch;
 	double		ntuples_per_chunk;
 	int			plan_width = outer_plan->plan_width;
 	int			nattrs = list_length(outer_plan->targetlist);
@@ -270,6 +292,11 @@ cost_gpusort(PlannedStmt *pstmt, Sort *sort,
 
 	if (ntuples < 2.0)
 		ntuples = 2.0;
+	/* bounded sort fetches only limit_tuples rows at most */
+	if (limit_tuples > 0.0 && limit_tuples < ntuples)
+		ntuples_fetch = limit_tuples;
+	else
+		ntuples_fetch = ntuples;
 
 	/* Cost come from outer-plan and sub-plans */
 	startup_cost = outer_plan->total_cost;
@@ -374,9 +401,12 @@ cost_gpusort(PlannedStmt *pstmt, Sort *sort,
 							ntuples_per_segment *
 							LOG2(ntuples_per_segment));
 		/*
-		 * Cost to write back the sorted results
+		 * Cost to write back the sorted results; bounded sort writes back
+		 * only top-K rows per segment
 		 */
-		cost_dma_recv = pgstrom_gpu_dma_cost * nchunks_per_segment;
+		cost_dma_recv = pgstrom_gpu_dma_cost *
+			ceil(nchunks_per_segment *
+				 Min(ntuples_fetch / ntuples_per_segment, 1.0));
 
 		/*
 		 * Our cost model assumes asynchronous executions; each fraction of
@@ -408,7 +438,7 @@ cost_gpusort(PlannedStmt *pstmt, Sort *sort,
 						 cost_gpu_sorting,
 						 cost_dma_recv) * (double) k + cost_others;
 		/* fine grained segmentation also makes CPU busy... */
-		tentative += cpu_comp_cost * (k-1) * ntuples;
+		tentative += cpu_comp_cost * (k-1) * ntuples_fetch;
 
 		if (tentative < sorting_cost)
 		{
@@ -422,7 +452,7 @@ cost_gpusort(PlannedStmt *pstmt, Sort *sort,
 		break;
 	}
 	startup_cost += sorting_cost;
-	run_cost += cpu_operator_cost * ntuples;
+	run_cost += cpu_operator_cost * ntuples_fetch;
 
 	/* result */
 	*p_startup_cost = startup_cost;
@@ -432,8 +462,128 @@ cost_gpusort(PlannedStmt *pstmt, Sort *sort,
 	*p_segment_extra = (Size)(segment_extra * pgstrom_chunk_size_margin);
 }
 
+/*
+ * gpusort_codegen_radix_key
+ *
+ * It generates gpusort_radix_key() that normalizes the sorting key to
+ * an unsigned integer, if GpuSort can apply radix sort on the key; that
+ * is a single fixed-length key sorted by the default ordering operator
+ * of the data type. It returns width of the normalized key, or 0 if
+ * radix sort is not applicable.
+ *
+ * STATIC_FUNCTION(cl_ulong)
+ * gpusort_radix_key(kern_context *kcxt,
+ *                   kern_data_store *kds_slot,
+ *                   size_t kds_index,
+ *                   cl_bool *p_isnull);
+ */
+static int
+gpusort_codegen_radix_key(Sort *sort, StringInfo body,
+						  codegen_context *context)
+{
+	TargetEntry	   *tle;
+	TypeCacheEntry *tcache;
+	devtype_info   *dtype;
+	Oid				sort_type;
+	const char	   *norm_expr;
+	const char	   *norm_mask;
+	bool			is_reverse;
+	int				nbits;
+
+	appendStringInfo(
+		body,
+		"STATIC_FUNCTION(cl_ulong)\n"
+		"gpusort_radix_key(kern_context *kcxt,\n"
+		"                  kern_data_store *kds_slot,\n"
+		"                  size_t kds_index,\n"
+		"                  cl_bool *p_isnull)\n"
+		"{\n");
+
+	if (!enable_gpusort_radix || sort->numCols != 1)
+		goto not_available;
+
+	tle = get_tle_by_resno(sort->plan.targetlist, sort->sortColIdx[0]);
+	if (!tle || !IsA(tle->expr, Var))
+		goto not_available;
+	sort_type = exprType((Node *) tle->expr);
+
+	switch (sort_type)
+	{
+		case INT2OID:
+			norm_expr = "(cl_ulong)((cl_ushort)KVAR.value ^ 0x8000U)";
+			norm_mask = "0xffffUL";
+			nbits = 16;
+			break;
+		case INT4OID:
+		case DATEOID:
+			norm_expr = "(cl_ulong)((cl_uint)KVAR.value ^ 0x80000000U)";
+			norm_mask = "0xffffffffUL";
+			nbits = 32;
+			break;
+		case INT8OID:
+		case TIMEOID:
+		case TIMESTAMPOID:
+		case TIMESTAMPTZOID:
+			norm_expr = "((cl_ulong)KVAR.value ^ 0x8000000000000000UL)";
+			norm_mask = "~0UL";
+			nbits = 64;
+			break;
+		case FLOAT4OID:
+			norm_expr = "gpusort_radix_float4(KVAR.value)";
+			norm_mask = "0xffffffffUL";
+			nbits = 32;
+			break;
+		case FLOAT8OID:
+			norm_expr = "gpusort_radix_float8(KVAR.value)";
+			norm_mask = "~0UL";
+			nbits = 64;
+			break;
+		default:
+			goto not_available;
+	}
+
+	/* only default ordering operators are consistent to the normalization */
+	tcache = lookup_type_cache(sort_type,
+							   TYPECACHE_LT_OPR | TYPECACHE_GT_OPR);
+	if (sort->sortOperators[0] == tcache->lt_opr)
+		is_reverse = false;
+	else if (sort->sortOperators[0] == tcache->gt_opr)
+		is_reverse = true;
+	else
+		goto not_available;
+
+	dtype = pgstrom_devtype_lookup_and_track(sort_type, context);
+	if (!dtype)
+		elog(ERROR, "device type %u lookup failed", sort_type);
+
+	appendStringInfo(
+		body,
+		"  pg_%s_t KVAR = pg_%s_vref(kds_slot,kcxt,%d,kds_index);\n"
+		"\n"
+		"  *p_isnull = KVAR.isnull;\n"
+		"  if (KVAR.isnull)\n"
+		"    return 0UL;\n"
+		"  return %s%s%s & %s;\n"
+		"}\n",
+		dtype->type_name, dtype->type_name, sort->sortColIdx[0] - 1,
+		is_reverse ? "~(" : "",
+		norm_expr,
+		is_reverse ? ")" : "",
+		norm_mask);
+	return nbits;
+
+not_available:
+	appendStringInfo(
+		body,
+		"  *p_isnull = true;\n"
+		"  return 0UL;\n"
+		"}\n");
+	return 0;
+}
+
 static char *
-pgstrom_gpusort_codegen(Sort *sort, codegen_context *context)
+pgstrom_gpusort_codegen(Sort *sort, codegen_context *context,
+						int *p_radix_nbits)
 {
 	StringInfoData	kern;
 	StringInfoData	body;
@@ -542,7 +692,10 @@ pgstrom_gpusort_codegen(Sort *sort, codegen_context *context)
 	appendStringInfo(
 		&body,
 		"  return 0;\n"
-		"}\n");
+		"}\n\n");
+
+	/* key normalization for radix sort */
+	*p_radix_nbits = gpusort_codegen_radix_key(sort, &body, context);
 
 	/* functions declarations, if any */
 	pgstrom_codegen_func_declarations(&kern, context);
@@ -559,7 +712,8 @@ pgstrom_gpusort_codegen(Sort *sort, codegen_context *context)
 }
 
 void
-pgstrom_try_insert_gpusort(PlannedStmt *pstmt, Plan **p_plan)
+pgstrom_try_insert_gpusort(PlannedStmt *pstmt, Plan **p_plan,
+						   double limit_tuples)
 {
 	Sort	   *sort = (Sort *)(*p_plan);
 	List	   *tlist = sort->plan.targetlist;
@@ -619,7 +773,7 @@ pgstrom_try_insert_gpusort(PlannedStmt *pstmt, Plan **p_plan)
 	/*
 	 * OK, cost estimation with GpuSort
 	 */
-	cost_gpusort(pstmt, sort,
+	cost_gpusort(pstmt, sort, limit_tuples,
 				 &startup_cost, &total_cost,
 				 &num_segments, &segment_nrooms, &segment_extra);
 
@@ -695,7 +849,8 @@ pgstrom_try_insert_gpusort(PlannedStmt *pstmt, Plan **p_plan)
 	pgstrom_init_codegen_context(&context);
 	gs_info.startup_cost = startup_cost;
 	gs_info.total_cost = total_cost;
-	gs_info.kern_source = pgstrom_gpusort_codegen(sort, &context);
+	gs_info.kern_source = pgstrom_gpusort_codegen(sort, &context,
+												  &gs_info.radix_nbits);
 	gs_info.extra_flags = context.extra_flags |
 		DEVKERNEL_NEEDS_DYNPARA | DEVKERNEL_NEEDS_GPUSORT;
 	gs_info.used_params = context.used_params;
@@ -708,6 +863,10 @@ pgstrom_try_insert_gpusort(PlannedStmt *pstmt, Plan **p_plan)
 	gs_info.collations = sort->collations;
 	gs_info.nullsFirst = sort->nullsFirst;
 	gs_info.varlena_keys = varlena_keys;	// still used?
+	if (limit_tuples > 0.0 && limit_tuples < (double) UINT_MAX)
+		gs_info.bound_nitems = (cl_uint) limit_tuples;
+	else
+		gs_info.bound_nitems = 0;
 	form_gpusort_info(cscan, &gs_info);
 
 	*p_plan = &cscan->scan.plan;
@@ -775,7 +934,13 @@ gpusort_begin(CustomScanState *node, EState *estate, int eflags)
 	 * Unlike built-in Sort node doing, our GpuSort "always" provide
 	 * a materialized output, so it is unconditionally possible to run
 	 * backward scan, random accesses and rewind the position.
+	 * Only exception is spilled segments; see gpusort_spill_segment().
 	 */
+	gss->spill_enabled = (gpusort_spill_threshold > 0 &&
+						  (eflags & (EXEC_FLAG_BACKWARD |
+									 EXEC_FLAG_MARK)) == 0);
+	gss->spill_usage = 0;
+	gss->num_spilled = 0;
 	eflags &= ~(EXEC_FLAG_REWIND | EXEC_FLAG_BACKWARD | EXEC_FLAG_MARK);
 
 	gss->markpos_buf = NULL;	/* to be set later */
@@ -795,7 +960,7 @@ gpusort_begin(CustomScanState *node, EState *estate, int eflags)
 								gs_info->used_params,
 								gs_info->kern_source,
 								gs_info->extra_flags);
-	if ((eflags & EXEC_FLAG_EXPLAIN_ONLY) == 0)
+	if (PGSTROM_PRELOAD_CUDA_PROGRAM(eflags))
 		pgstrom_load_cuda_program(&gss->gts, true);
 
 	/* array for data-stores */
@@ -805,10 +970,16 @@ gpusort_begin(CustomScanState *node, EState *estate, int eflags)
 							 gss->num_segments_limit);
 	gss->seg_results = palloc0(sizeof(kern_resultbuf *) *
 							   gss->num_segments_limit);
+	gss->seg_spill = palloc0(sizeof(Tuplestorestate *) *
+							 gss->num_segments_limit);
+	gss->seg_spill_slot = palloc0(sizeof(TupleTableSlot *) *
+								  gss->num_segments_limit);
 	gss->seg_curpos = NULL;	/* to be set later */
 	gss->seg_lstree = NULL;	/* to be set later */
 	gss->segment_nrooms = gs_info->segment_nrooms;
 	gss->segment_extra = gs_info->segment_extra;
+	gss->radix_nbits = gs_info->radix_nbits;
+	gss->bound_nitems = gs_info->bound_nitems;
 
 	/* sorting keys */
 	gss->numCols = gs_info->numCols;
@@ -853,7 +1024,13 @@ gpusort_end(CustomScanState *node)
 	for (i=0; i < gss->num_segments; i++)
 	{
 		pds_slot = gss->seg_slots[i];
-		PDS_release(pds_slot);
+		if (pds_slot)
+			PDS_release(pds_slot);
+		if (gss->seg_spill[i])
+		{
+			tuplestore_end(gss->seg_spill[i]);
+			ExecDropSingleTupleTableSlot(gss->seg_spill_slot[i]);
+		}
 
 		segment = (gpusort_segment *)((char *)gss->seg_results[i] -
 									  offsetof(gpusort_segment, kresults));
@@ -908,11 +1085,21 @@ gpusort_rescan(CustomScanState *node)
 				((char *)gss->seg_results[i] - offsetof(gpusort_segment,
 														kresults));
 			Assert(gss->seg_slots[i] == segment->pds_slot);
-			PDS_release(gss->seg_slots[i]);
+			if (gss->seg_slots[i])
+				PDS_release(gss->seg_slots[i]);
+			if (gss->seg_spill[i])
+			{
+				tuplestore_end(gss->seg_spill[i]);
+				ExecDropSingleTupleTableSlot(gss->seg_spill_slot[i]);
+				gss->seg_spill[i] = NULL;
+				gss->seg_spill_slot[i] = NULL;
+			}
 			pfree(segment);
 		}
 		gss->curr_segment = NULL;
 		gss->num_segments = 0;
+		gss->spill_usage = 0;
+		gss->num_spilled = 0;
 	}
 }
 
@@ -996,6 +1183,8 @@ gpusort_explain(CustomScanState *node, List *ancestors, ExplainState *es)
 	}
 	if (sort_keys != NIL)
 		ExplainPropertyList("Sort Key", sort_keys, es);
+	if (gss->bound_nitems > 0)
+		ExplainPropertyLong("Sort Bound", gss->bound_nitems, es);
 
 	/*
 	 * shows resource consumption, if executed and have more than zero
@@ -1006,7 +1195,11 @@ gpusort_explain(CustomScanState *node, List *ancestors, ExplainState *es)
 		const char *sort_method;
 		Size		total_consumption = 0UL;
 
-		if (gss->num_segments > 1)
+		if (gss->radix_nbits > 0)
+			sort_method = (gss->num_segments > 1
+						   ? "GPU/Radix + CPU/Merge"
+						   : "GPU/Radix");
+		else if (gss->num_segments > 1)
 			sort_method = "GPU/Bitonic + CPU/Merge";
 		else
 			sort_method = "GPU/Bitonic";
@@ -1016,7 +1209,9 @@ gpusort_explain(CustomScanState *node, List *ancestors, ExplainState *es)
 			pgstrom_data_store *pds = gss->seg_slots[i];
 			kern_resultbuf	   *kresults = gss->seg_results[i];
 
-			total_consumption += GPUMEMALIGN(pds->kds_length) +
+			if (pds)
+				total_consumption += GPUMEMALIGN(pds->kds_length);
+			total_consumption +=
 				GPUMEMALIGN(offsetof(gpusort_segment, kresults) +
 							offsetof(kern_resultbuf, results) +
 							sizeof(cl_uint) * kresults->nrooms);
@@ -1036,6 +1231,8 @@ gpusort_explain(CustomScanState *node, List *ancestors, ExplainState *es)
 		}
 		/* number of segments */
 		ExplainPropertyInteger("Number of segments", gss->num_segments, es);
+		if (gss->num_spilled > 0)
+			ExplainPropertyInteger("Spilled segments", gss->num_spilled, es);
 	}
 	pgstrom_explain_gputaskstate(&gss->gts, es);
 }
@@ -1043,6 +1240,20 @@ gpusort_explain(CustomScanState *node, List *ancestors, ExplainState *es)
 /*
  * Create/Get/Put gpusort_segment
  */
+/*
+ * gpusort_bound_compact
+ *
+ * It returns true, if top-K rows of the bounded sort can be moved to the
+ * head of kds_slot on the device side. See the comment in cuda_gpusort.h.
+ */
+static inline bool
+gpusort_bound_compact(GpuSortState *gss, kern_data_store *kds_slot)
+{
+	return (gss->bound_nitems > 0 &&
+			gss->radix_nbits > 0 &&
+			!kds_slot->has_notbyval);
+}
+
 static gpusort_segment *
 gpusort_create_segment(GpuSortState *gss)
 {
@@ -1065,7 +1276,7 @@ gpusort_create_segment(GpuSortState *gss)
 	segment->segid = -1;	/* caller shall set */
 	segment->m_kds_slot = 0UL;
 	segment->m_kresults = 0UL;
-	segment->cuda_index = gcontext->next_context++ % gcontext->num_context;
+	segment->cuda_index = pgstrom_select_cuda_index(&gss->gts);
 	segment->num_chunks = 0;
 	segment->max_chunks = seg_nchunks;
 	segment->nitems_total = 0;
@@ -1109,8 +1320,9 @@ gpusort_put_segment(gpusort_segment *segment)
 		Assert(segment->m_kds_slot == 0UL);
 		Assert(segment->m_kresults == 0UL);
 
-		/* release the data store */
-		PDS_release(segment->pds_slot);
+		/* release the data store, unless it is already spilled */
+		if (segment->pds_slot)
+			PDS_release(segment->pds_slot);
 
 		/* event objects also */
 		rc = cuEventDestroy(segment->ev_setup_segment);
@@ -1153,6 +1365,8 @@ gpusort_create_task(GpuSortState *gss, pgstrom_data_store *pds_in,
 	memcpy(&pgsort->kern.kparams,
 		   gss->gts.kern_params,
 		   gss->gts.kern_params->length);
+	pgsort->kern.radix_nbits = gss->radix_nbits;
+	pgsort->kern.radix_nulls_first = gss->nullsFirst[0];
 
 	if (segment)
 	{
@@ -1186,10 +1400,18 @@ gpusort_create_task(GpuSortState *gss, pgstrom_data_store *pds_in,
 				gss->seg_results = repalloc(gss->seg_results,
 											sizeof(kern_resultbuf *) *
 											gss->num_segments_limit);
+				gss->seg_spill = repalloc(gss->seg_spill,
+										  sizeof(Tuplestorestate *) *
+										  gss->num_segments_limit);
+				gss->seg_spill_slot = repalloc(gss->seg_spill_slot,
+											   sizeof(TupleTableSlot *) *
+											   gss->num_segments_limit);
 			}
 			segment->segid = gss->num_segments;
 			gss->seg_slots[gss->num_segments] = segment->pds_slot;
 			gss->seg_results[gss->num_segments] = &segment->kresults;
+			gss->seg_spill[gss->num_segments] = NULL;
+			gss->seg_spill_slot[gss->num_segments] = NULL;
 			gss->num_segments++;
 			gss->curr_segment = segment;
 		}
@@ -1212,6 +1434,9 @@ gpusort_create_task(GpuSortState *gss, pgstrom_data_store *pds_in,
 	}
 	pgsort->segment = gpusort_get_segment(segment);
 	pgsort->kern.segid = pgsort->segment->segid;
+	pgsort->kern.bound_nitems = gss->bound_nitems;
+	pgsort->kern.bound_compact =
+		gpusort_bound_compact(gss, segment->pds_slot->kds);
 	pgsort->task.cuda_index = segment->cuda_index;	/* bind to the same GPU */
 	return &pgsort->task;
 }
@@ -1320,6 +1545,60 @@ gpusort_cpu_keycomp(GpuSortState *gss,
 	return 0;
 }
 
+/*
+ * gpusort_segment_head
+ *
+ * It returns values/isnull array of the current head record of the
+ * segment. Caller has to ensure the segment is not exhausted yet.
+ * If segment is already spilled out, the head record is kept by the
+ * seg_spill_slot[] and advanced by gpusort_segment_advance().
+ */
+static inline void
+gpusort_segment_head(GpuSortState *gss, cl_uint segid,
+					 Datum **p_values, bool **p_isnull)
+{
+	Assert(gss->seg_curpos[segid] < gss->seg_results[segid]->nitems);
+	if (gss->seg_spill[segid])
+	{
+		TupleTableSlot *spill_slot = gss->seg_spill_slot[segid];
+
+		Assert(!TupIsNull(spill_slot));
+		*p_values = spill_slot->tts_values;
+		*p_isnull = spill_slot->tts_isnull;
+	}
+	else
+	{
+		pgstrom_data_store *pds = gss->seg_slots[segid];
+		kern_resultbuf	   *kresults = gss->seg_results[segid];
+		cl_uint				index;
+
+		index = kresults->results[gss->seg_curpos[segid]];
+		*p_values = KERN_DATA_STORE_VALUES(pds->kds, index);
+		*p_isnull = KERN_DATA_STORE_ISNULL(pds->kds, index);
+	}
+}
+
+/*
+ * gpusort_segment_advance
+ *
+ * It loads the next record from the spill file, if segment is spilled.
+ */
+static inline void
+gpusort_segment_advance(GpuSortState *gss, cl_uint segid)
+{
+	TupleTableSlot *spill_slot = gss->seg_spill_slot[segid];
+
+	if (!gss->seg_spill[segid])
+		return;
+	if (gss->seg_curpos[segid] >= gss->seg_results[segid]->nitems)
+		ExecClearTuple(spill_slot);
+	else if (!tuplestore_gettupleslot(gss->seg_spill[segid],
+									  true, false, spill_slot))
+		elog(ERROR, "GpuSort: spill file of segment %u is truncated", segid);
+	else
+		slot_getallattrs(spill_slot);
+}
+
 static inline void
 gpusort_update_lstree(GpuSortState *gss, cl_uint depth, cl_uint index)
 {
@@ -1334,8 +1613,6 @@ gpusort_update_lstree(GpuSortState *gss, cl_uint depth, cl_uint index)
 	y_segid = gss->seg_lstree[depth+1][2 * index + 1];
 	if (x_segid < gss->num_segments && y_segid < gss->num_segments)
 	{
-		pgstrom_data_store *x_pds = gss->seg_slots[x_segid];
-		pgstrom_data_store *y_pds = gss->seg_slots[y_segid];
 		kern_resultbuf	   *x_kresults = gss->seg_results[x_segid];
 		kern_resultbuf	   *y_kresults = gss->seg_results[y_segid];
 		cl_uint				x_curpos = gss->seg_curpos[x_segid];
@@ -1344,13 +1621,13 @@ gpusort_update_lstree(GpuSortState *gss, cl_uint depth, cl_uint index)
 		if (x_curpos < x_kresults->nitems &&
 			y_curpos < y_kresults->nitems)
 		{
-			cl_uint		x_index = x_kresults->results[x_curpos];
-			cl_uint		y_index = y_kresults->results[y_curpos];
-			Datum	   *x_values = KERN_DATA_STORE_VALUES(x_pds->kds, x_index);
-			bool	   *x_isnull = KERN_DATA_STORE_ISNULL(x_pds->kds, x_index);
-			Datum	   *y_values = KERN_DATA_STORE_VALUES(y_pds->kds, y_index);
-			bool	   *y_isnull = KERN_DATA_STORE_ISNULL(y_pds->kds, y_index);
+			Datum	   *x_values;
+			bool	   *x_isnull;
+			Datum	   *y_values;
+			bool	   *y_isnull;
 
+			gpusort_segment_head(gss, x_segid, &x_values, &x_isnull);
+			gpusort_segment_head(gss, y_segid, &y_values, &y_isnull);
 			if (gpusort_cpu_keycomp(gss,
 									x_values, x_isnull,
 									y_values, y_isnull) < 0)
@@ -1392,11 +1669,7 @@ gpusort_next_tuple(GpuTaskState *gts)
 	pgstrom_gpusort	   *pgsort = (pgstrom_gpusort *) gss->gts.curr_task;
 	TupleTableSlot	   *slot = gss->gts.css.ss.ps.ps_ResultTupleSlot;
 	AttrNumber			natts = slot->tts_tupleDescriptor->natts;
-	pgstrom_data_store *pds;
-	kern_resultbuf	   *kresults;
 	cl_uint				segid;
-	cl_uint				curpos;
-	cl_uint				index;
 	Datum			   *values;
 	bool			   *isnull;
 	struct timeval		tv1, tv2, tv3;
@@ -1426,6 +1699,16 @@ gpusort_next_tuple(GpuTaskState *gts)
 		gss->seg_lstree_depth = depth;
 		MemoryContextSwitchTo(oldcxt);
 
+		/* load the first record of the spilled segments */
+		for (i=0; i < gss->num_segments; i++)
+		{
+			if (gss->seg_spill[i])
+			{
+				tuplestore_rescan(gss->seg_spill[i]);
+				gpusort_segment_advance(gss, i);
+			}
+		}
+
 		for (i=0, k = (1 << depth); i < k; i++)
 			gss->seg_lstree[depth][i] = i;	/* last depth */
 		for (i=gss->seg_lstree_depth-1; i >= 0; i--)
@@ -1448,6 +1731,7 @@ gpusort_next_tuple(GpuTaskState *gts)
 
 		Assert(last_segid >= 0 && last_segid < gss->num_segments);
 		gss->seg_curpos[last_segid]++;
+		gpusort_segment_advance(gss, last_segid);
 
 		for (i=gss->seg_lstree_depth-1; i >= 0; i--)
 		{
@@ -1467,12 +1751,7 @@ gpusort_next_tuple(GpuTaskState *gts)
 	if (segid < 0 || segid >= gss->num_segments)
 		return NULL;	/* end of the scan */
 
-	pds = gss->seg_slots[segid];
-	kresults = gss->seg_results[segid];
-	curpos = gss->seg_curpos[segid];
-	index = kresults->results[curpos];
-	values = KERN_DATA_STORE_VALUES(pds->kds, index);
-	isnull = KERN_DATA_STORE_ISNULL(pds->kds, index);
+	gpusort_segment_head(gss, segid, &values, &isnull);
 
 	memcpy(slot->tts_values, values, sizeof(Datum) * natts);
 	memcpy(slot->tts_isnull, isnull, sizeof(bool) * natts);
@@ -1543,6 +1822,60 @@ gpusort_task_release(GpuTask *gtask)
 	pfree(gtask);
 }
 
+/*
+ * gpusort_spill_segment
+ *
+ * It writes out the records of a sorted segment to the temporary file in
+ * the order of kern_resultbuf, then releases the host buffer, if host
+ * memory held by the sorted segments exceeds pg_strom.gpusort_spill_threshold.
+ * The spilled segment is read back one by one during the merge stage, so
+ * the amount of host memory does not depend on the number of input rows.
+ */
+static void
+gpusort_spill_segment(GpuSortState *gss, gpusort_segment *segment)
+{
+	EState			   *estate = gss->gts.css.ss.ps.state;
+	TupleDesc			tupdesc = GTS_GET_RESULT_TUPDESC(gss);
+	pgstrom_data_store *pds_slot = segment->pds_slot;
+	kern_resultbuf	   *kresults = &segment->kresults;
+	Tuplestorestate	   *tupstore;
+	TupleTableSlot	   *spill_slot;
+	MemoryContext		oldcxt;
+	cl_uint				segid = segment->segid;
+	cl_uint				i;
+
+	Assert(gss->spill_enabled);
+	Assert(segid < gss->num_segments && gss->seg_slots[segid] == pds_slot);
+	if (gss->spill_usage + pds_slot->kds_length <=
+		(Size) gpusort_spill_threshold * 1024L)
+	{
+		gss->spill_usage += pds_slot->kds_length;
+		return;
+	}
+
+	oldcxt = MemoryContextSwitchTo(estate->es_query_cxt);
+	tupstore = tuplestore_begin_heap(false, false, work_mem);
+	for (i=0; i < kresults->nitems; i++)
+	{
+		cl_uint		index = kresults->results[i];
+
+		tuplestore_putvalues(tupstore, tupdesc,
+							 KERN_DATA_STORE_VALUES(pds_slot->kds, index),
+							 KERN_DATA_STORE_ISNULL(pds_slot->kds, index));
+	}
+	spill_slot = MakeSingleTupleTableSlot(tupdesc);
+	MemoryContextSwitchTo(oldcxt);
+
+	gss->seg_spill[segid] = tupstore;
+	gss->seg_spill_slot[segid] = spill_slot;
+	gss->num_spilled++;
+
+	/* host buffer is no longer needed */
+	gss->seg_slots[segid] = NULL;
+	segment->pds_slot = NULL;
+	PDS_release(pds_slot);
+}
+
 static bool
 gpusort_task_complete(GpuTask *gtask)
 {
@@ -1551,9 +1884,10 @@ gpusort_task_complete(GpuTask *gtask)
 	gpusort_segment	   *segment = pgsort->segment;
 	pgstrom_perfmon	   *pfm = &gss->gts.pfm;
 
+	/* number of tasks is counted regardless of perfmon, for gpustat */
+	pfm->num_tasks++;
 	if (pfm->enabled)
 	{
-		pfm->num_tasks++;
 		CUDA_EVENT_ELAPSED(pgsort, time_dma_send,
 						   pgsort->ev_dma_send_start,
 						   pgsort->ev_dma_send_stop,
@@ -1618,9 +1952,17 @@ skip:
 								   &segment->kresults,
 								   segment->pds_slot->kds,
 								   0, segment->kresults.nitems - 1);
+		/* also keeps only top-K items, if bounded */
+		if (gss->bound_nitems > 0)
+			segment->kresults.nitems = Min(segment->kresults.nitems,
+										   gss->bound_nitems);
 		segment->cpu_fallback = false;
 	}
 
+	/* sorted segment may be moved to the temporary file */
+	if (pgsort->is_terminator && gss->spill_enabled)
+		gpusort_spill_segment(gss, segment);
+
 	/*
 	 * StromError_DataStoreNoSpace implies this gpusort task could not
 	 * move all the tuples on kds_in into the kds_slot of the segment
@@ -1759,7 +2101,6 @@ gpusort_task_respond(CUstream stream, CUresult status, void *private)
 {
 	pgstrom_gpusort	   *pgsort = (pgstrom_gpusort *) private;
 	gpusort_segment	   *segment = pgsort->segment;
-	GpuTaskState	   *gts = pgsort->task.gts;
 
 	/* See comments in pgstrom_respond_gpuscan() */
 	if (status == CUDA_ERROR_INVALID_CONTEXT || !IsTransactionState())
@@ -1801,25 +2142,10 @@ gpusort_task_respond(CUstream stream, CUresult status, void *private)
 	}
 
 	/*
-	 * Remove the GpuTask from the running_tasks list, and attach it
-	 * on the completed_tasks list again. Note that this routine may
-	 * be called by CUDA runtime, prior to attachment of GpuTask on
-	 * the running_tasks by cuda_control.c.
+	 * Informs completion of the GpuTask to the backend; it shall be
+	 * moved from the running_tasks to the completed_tasks later.
 	 */
-	SpinLockAcquire(&gts->lock);
-	if (pgsort->task.chain.prev && pgsort->task.chain.next)
-	{
-		dlist_delete(&pgsort->task.chain);
-		gts->num_running_tasks--;
-	}
-	if (pgsort->task.kerror.errcode == StromError_Success)
-		dlist_push_tail(&gts->completed_tasks, &pgsort->task.chain);
-	else
-		dlist_push_head(&gts->completed_tasks, &pgsort->task.chain);
-	gts->num_completed_tasks++;
-	SpinLockRelease(&gts->lock);
-
-	SetLatch(&MyProc->procLatch);
+	pgstrom_complete_gputask(&pgsort->task);
 }
 
 static bool
@@ -1838,9 +2164,23 @@ gpusort_setup_segment(GpuSortState *gss, pgstrom_gpusort *pgsort)
 		CUevent				ev_setup_segment;
 		Size				length;
 
-		length = (GPUMEMALIGN(kds_slot->length) +
-				  GPUMEMALIGN(offsetof(kern_resultbuf, results) +
-							  sizeof(cl_uint) * kresults->nrooms));
+		/* radix sort needs extra index and histogram next to results[] */
+		if (gss->radix_nbits > 0)
+		{
+			length = (STROMALIGN(offsetof(kern_resultbuf,
+										  results[kresults->nrooms])) +
+					  GPUSORT_RADIX_BUFSZ(kresults->nrooms));
+			/* also temporary buffer for compaction of the bounded sort */
+			if (gpusort_bound_compact(gss, kds_slot))
+				length += GPUSORT_BOUND_BUFSZ(kds_slot->ncols,
+											  Min(gss->bound_nitems,
+												  kresults->nrooms));
+			length = GPUMEMALIGN(length);
+		}
+		else
+			length = GPUMEMALIGN(offsetof(kern_resultbuf, results) +
+								 sizeof(cl_uint) * kresults->nrooms);
+		length += GPUMEMALIGN(kds_slot->length);
 		m_kds_slot = gpuMemAlloc(&pgsort->task, length);
 		if (!m_kds_slot)
 			return false;	/* retry to enqueue task */
@@ -2099,18 +2439,27 @@ __gpusort_task_process(GpuSortState *gss, pgstrom_gpusort *pgsort)
 	{
 		kern_data_store	   *kds_slot = segment->pds_slot->kds;
 		kern_resultbuf	   *kresults = &segment->kresults;
+		cl_uint				nrooms = kresults->nrooms;
 
+		/* bounded sort writes back only top-K items */
+		if (gss->bound_nitems > 0)
+			nrooms = Min(nrooms, gss->bound_nitems);
+
+		if (gpusort_bound_compact(gss, kds_slot))
+			length = KERN_DATA_STORE_SLOT_LENGTH(kds_slot, nrooms);
+		else
+			length = kds_slot->length;
 		rc = cuMemcpyDtoHAsync(kds_slot,
 							   segment->m_kds_slot,
-							   kds_slot->length,
+							   length,
 							   pgsort->task.cuda_stream);
 		if (rc != CUDA_SUCCESS)
 			elog(ERROR, "cuMemcpyDtoHAsync: %s", errorText(rc));
-		pfm->bytes_dma_recv += kds_slot->length;
+		pfm->bytes_dma_recv += length;
 		pfm->num_dma_recv++;
 
 		length = (offsetof(kern_resultbuf, results) +
-				  sizeof(cl_uint) * kresults->nrooms);
+				  sizeof(cl_uint) * nrooms);
 		rc = cuMemcpyDtoHAsync(kresults,
 							   segment->m_kresults,
 							   length,
@@ -2264,6 +2613,28 @@ pgstrom_init_gpusort(void)
 							 GUC_NOT_IN_SAMPLE,
 							 NULL, NULL, NULL);
 
+	/* pg_strom.enable_gpusort_radix */
+	DefineCustomBoolVariable("pg_strom.enable_gpusort_radix",
+							 "Enables radix sort on GpuSort, if sorting key is available",
+							 NULL,
+							 &enable_gpusort_radix,
+							 true,
+							 PGC_USERSET,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
+
+	/* pg_strom.gpusort_spill_threshold */
+	DefineCustomIntVariable("pg_strom.gpusort_spill_threshold",
+							"Host memory for sorted segments prior to spill-out to temporary files, or 0 to disable",
+							NULL,
+							&gpusort_spill_threshold,
+							0,
+							0,
+							INT_MAX,
+							PGC_USERSET,
+							GUC_NOT_IN_SAMPLE | GUC_UNIT_KB,
+							NULL, NULL, NULL);
+
 	/* initialize the plan method table */
 	memset(&gpusort_scan_methods, 0, sizeof(CustomScanMethods));
 	gpusort_scan_methods.CustomName			= "GpuSort";
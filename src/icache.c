@@ -0,0 +1,716 @@
+/*
+ * icache.c
+ *
+ * Shared cache of the GpuJoin inner hash tables
+ * ----
+ * Copyright 2011-2016 (C) KaiGai Kohei <kaigai@kaigai.gr.jp>
+ * Copyright 2014-2016 (C) The PG-Strom Development Team
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ */
+#include "postgres.h"
+#include "access/hash.h"
+#include "access/htup_details.h"
+#include "access/xact.h"
+#include "catalog/pg_type.h"
+#include "funcapi.h"
+#include "miscadmin.h"
+#include "storage/ipc.h"
+#include "storage/shmem.h"
+#include "utils/builtins.h"
+#include "utils/guc.h"
+#include "utils/tqual.h"
+#include "pg_strom.h"
+
+/*
+ * icache_entry - a KDS_FORMAT_HASH chunk with the hash table already built.
+ * Its contents are determined by the identifier of the inner plan and the
+ * snapshot; two MVCC snapshots with identical xmin, xmax and in-progress
+ * transactions see exactly the same tuples, so the entry can be shared
+ * by any backend that runs the same inner plan under such a snapshot.
+ *
+ * 'data' contains the identifier string, xip[] and subxip[] (sorted),
+ * then the KDS image.
+ */
+typedef struct
+{
+	dlist_node		hash_chain;	/* link to hash slot, or free list */
+	dlist_node		lru_chain;	/* link to LRU list, if active */
+	int				shift;		/* block class of this entry */
+	int				refcnt;		/* 0 means free entry */
+	Oid				database_oid; /* OID of the database */
+	Oid				table_oid;	/* OID of the inner relation */
+	cl_uint			hash;		/* hash value of the identifier */
+	TransactionId	xmin;		/* snapshot->xmin */
+	TransactionId	xmax;		/* snapshot->xmax */
+	cl_uint			xcnt;		/* snapshot->xcnt */
+	cl_int			subxcnt;	/* snapshot->subxcnt */
+	bool			suboverflowed; /* snapshot->suboverflowed */
+	cl_ulong		nhits;		/* number of hits on this entry */
+	Size			ident_len;	/* length of the identifier, including '\0' */
+	Size			kds_offset;	/* offset of the KDS image from 'data' */
+	Size			kds_length;	/* length of the KDS image */
+	char			data[FLEXIBLE_ARRAY_MEMBER];
+} icache_entry;
+
+#define ICACHE_ENTRY_IDENT(entry)				\
+	((char *)(entry)->data)
+#define ICACHE_ENTRY_XIP(entry)					\
+	((TransactionId *)((entry)->data + MAXALIGN((entry)->ident_len)))
+#define ICACHE_ENTRY_SUBXIP(entry)				\
+	(ICACHE_ENTRY_XIP(entry) + (entry)->xcnt)
+#define ICACHE_ENTRY_KDS(entry)					\
+	((kern_data_store *)((entry)->data + (entry)->kds_offset))
+#define ICACHE_ACTIVE_ENTRY(entry)				\
+	((entry)->lru_chain.prev && (entry)->lru_chain.next)
+
+#define ICACHE_MIN_BITS		16		/* 64KB */
+#define ICACHE_MAX_BITS		28		/* 256MB */
+#define ICACHE_HASH_SIZE	256
+
+typedef struct
+{
+	volatile slock_t lock;
+	dlist_head	free_list[ICACHE_MAX_BITS + 1];
+	dlist_head	hash_slot[ICACHE_HASH_SIZE];
+	dlist_head	lru_list;
+	/* statistics */
+	cl_ulong	num_hits;
+	cl_ulong	num_misses;
+	icache_entry *entry_begin;	/* start address of entries */
+	icache_entry *entry_end;	/* end address of entries */
+	char		data[FLEXIBLE_ARRAY_MEMBER];
+} icache_head;
+
+/*
+ * icache_key - normalized key of the lookup on the local memory
+ */
+typedef struct
+{
+	const char	   *ident;
+	Size			ident_len;
+	cl_uint			hash;
+	TransactionId	xmin;
+	TransactionId	xmax;
+	cl_uint			xcnt;
+	cl_int			subxcnt;
+	bool			suboverflowed;
+	TransactionId  *xip;
+	TransactionId  *subxip;
+} icache_key;
+
+/* ---- GUC variables ---- */
+static Size		icache_size;
+static bool		enable_icache;
+
+/* ---- static variables ---- */
+static shmem_startup_hook_type shmem_startup_next;
+static icache_head *ic_head = NULL;
+
+static void icache_free(icache_entry *entry);
+
+/*
+ * icache_setup_key
+ *
+ * It constructs a lookup key from the identifier and snapshot. Array of
+ * the in-progress transactions are sorted, because its order depends on
+ * the slot of the procarray.
+ */
+static void
+icache_setup_key(icache_key *key, const char *ident, Snapshot snapshot)
+{
+	key->ident = ident;
+	key->ident_len = strlen(ident) + 1;
+	key->hash = DatumGetUInt32(hash_any((unsigned char *)ident,
+										key->ident_len - 1));
+	key->xmin = snapshot->xmin;
+	key->xmax = snapshot->xmax;
+	key->xcnt = snapshot->xcnt;
+	key->subxcnt = snapshot->subxcnt;
+	key->suboverflowed = snapshot->suboverflowed;
+	key->xip = palloc(sizeof(TransactionId) *
+					  (key->xcnt + Max(key->subxcnt, 0) + 1));
+	key->subxip = key->xip + key->xcnt;
+	if (key->xcnt > 0)
+	{
+		memcpy(key->xip, snapshot->xip,
+			   sizeof(TransactionId) * key->xcnt);
+		qsort(key->xip, key->xcnt, sizeof(TransactionId), xidComparator);
+	}
+	if (key->subxcnt > 0)
+	{
+		memcpy(key->subxip, snapshot->subxip,
+			   sizeof(TransactionId) * key->subxcnt);
+		qsort(key->subxip, key->subxcnt, sizeof(TransactionId),
+			  xidComparator);
+	}
+}
+
+static bool
+icache_entry_matches(icache_entry *entry, icache_key *key)
+{
+	if (entry->database_oid != MyDatabaseId ||
+		entry->hash != key->hash ||
+		entry->ident_len != key->ident_len ||
+		entry->xmin != key->xmin ||
+		entry->xmax != key->xmax ||
+		entry->xcnt != key->xcnt ||
+		entry->subxcnt != key->subxcnt ||
+		entry->suboverflowed != key->suboverflowed)
+		return false;
+	if (memcmp(ICACHE_ENTRY_IDENT(entry), key->ident, key->ident_len) != 0)
+		return false;
+	if (key->xcnt > 0 &&
+		memcmp(ICACHE_ENTRY_XIP(entry), key->xip,
+			   sizeof(TransactionId) * key->xcnt) != 0)
+		return false;
+	if (key->subxcnt > 0 &&
+		memcmp(ICACHE_ENTRY_SUBXIP(entry), key->subxip,
+			   sizeof(TransactionId) * key->subxcnt) != 0)
+		return false;
+	return true;
+}
+
+/*
+ * icache_unlink - detach the entry from hash/LRU list, then release it
+ * if nobody references. Caller must hold ic_head->lock.
+ */
+static void
+icache_unlink(icache_entry *entry)
+{
+	Assert(ICACHE_ACTIVE_ENTRY(entry));
+	dlist_delete(&entry->hash_chain);
+	dlist_delete(&entry->lru_chain);
+	memset(&entry->hash_chain, 0, sizeof(dlist_node));
+	memset(&entry->lru_chain, 0, sizeof(dlist_node));
+	if (--entry->refcnt == 0)
+		icache_free(entry);
+}
+
+/*
+ * icache_reclaim - it tries to release entries according to LRU
+ */
+static bool
+icache_reclaim(int shift_min)
+{
+	icache_entry   *entry;
+	int				shift;
+
+	while (!dlist_is_empty(&ic_head->lru_list))
+	{
+		dlist_node *dnode = dlist_tail_node(&ic_head->lru_list);
+
+		entry = dlist_container(icache_entry, lru_chain, dnode);
+		icache_unlink(entry);
+
+		for (shift = shift_min; shift <= ICACHE_MAX_BITS; shift++)
+		{
+			if (!dlist_is_empty(&ic_head->free_list[shift]))
+				return true;
+		}
+	}
+	return false;
+}
+
+/*
+ * icache_split / icache_alloc / icache_free
+ *
+ * a simple buddy memory allocation on the shared memory segment, like
+ * as columnar cache doing.
+ */
+static bool
+icache_split(int shift)
+{
+	icache_entry   *entry;
+	dlist_node	   *dnode;
+
+	Assert(shift > ICACHE_MIN_BITS && shift <= ICACHE_MAX_BITS);
+	if (dlist_is_empty(&ic_head->free_list[shift]))
+	{
+		if (shift == ICACHE_MAX_BITS || !icache_split(shift + 1))
+			return false;
+	}
+	Assert(!dlist_is_empty(&ic_head->free_list[shift]));
+
+	dnode = dlist_pop_head_node(&ic_head->free_list[shift]);
+	entry = dlist_container(icache_entry, hash_chain, dnode);
+	Assert(entry->shift == shift);
+	shift--;
+
+	/* earlier half */
+	memset(entry, 0, offsetof(icache_entry, data));
+	entry->shift = shift;
+	dlist_push_tail(&ic_head->free_list[shift], &entry->hash_chain);
+
+	/* later half */
+	entry = (icache_entry *)((char *)entry + (1UL << shift));
+	memset(entry, 0, offsetof(icache_entry, data));
+	entry->shift = shift;
+	dlist_push_tail(&ic_head->free_list[shift], &entry->hash_chain);
+
+	return true;
+}
+
+static icache_entry *
+icache_alloc(Size total_size)
+{
+	icache_entry   *entry;
+	dlist_node	   *dnode;
+	int				shift;
+
+	total_size += offsetof(icache_entry, data);
+	if (total_size > (1UL << ICACHE_MAX_BITS))
+		return NULL;
+	shift = Max(get_next_log2(total_size), ICACHE_MIN_BITS);
+
+	while (dlist_is_empty(&ic_head->free_list[shift]) &&
+		   (shift == ICACHE_MAX_BITS || !icache_split(shift + 1)))
+	{
+		if (!icache_reclaim(shift))
+			return NULL;
+	}
+	Assert(!dlist_is_empty(&ic_head->free_list[shift]));
+
+	dnode = dlist_pop_head_node(&ic_head->free_list[shift]);
+	entry = dlist_container(icache_entry, hash_chain, dnode);
+	Assert(entry->shift == shift);
+
+	memset(entry, 0, offsetof(icache_entry, data));
+	entry->shift = shift;
+	entry->refcnt = 1;
+
+	return entry;
+}
+
+static void
+icache_free(icache_entry *entry)
+{
+	int			shift = entry->shift;
+	Size		offset;
+
+	Assert(entry->refcnt == 0);
+	Assert(!entry->hash_chain.next && !entry->hash_chain.prev);
+	Assert(!entry->lru_chain.next && !entry->lru_chain.prev);
+
+	/* try to merge buddy entry, if it is also free */
+	while (shift < ICACHE_MAX_BITS)
+	{
+		icache_entry   *buddy;
+
+		offset = (uintptr_t) entry - (uintptr_t) ic_head->entry_begin;
+		if ((offset & (1UL << shift)) == 0)
+			buddy = (icache_entry *)((char *)entry + (1UL << shift));
+		else
+			buddy = (icache_entry *)((char *)entry - (1UL << shift));
+
+		if (buddy >= ic_head->entry_end ||		/* out of range? */
+			buddy->shift != shift ||			/* same size? */
+			buddy->refcnt > 0)					/* and free entry? */
+			break;
+		/* OK, chunk and buddy can be merged */
+		dlist_delete(&buddy->hash_chain);		/* remove from free_list */
+		memset(&buddy->hash_chain, 0, sizeof(dlist_node));
+		if (buddy < entry)
+			entry = buddy;
+		entry->shift = ++shift;
+	}
+	dlist_push_head(&ic_head->free_list[shift], &entry->hash_chain);
+}
+
+/*
+ * pgstrom_icache_available
+ *
+ * It checks whether the inner hash cache is configured and enabled.
+ */
+bool
+pgstrom_icache_available(void)
+{
+	return (ic_head != NULL && enable_icache);
+}
+
+/*
+ * pgstrom_icache_enabled
+ *
+ * It checks whether the inner hash cache can be used under the snapshot.
+ * Only MVCC snapshot is identified by its contents. In addition, current
+ * transaction must not have its own modification, because the cached
+ * entry may be built by other transactions that never see them.
+ */
+bool
+pgstrom_icache_enabled(Snapshot snapshot)
+{
+	if (!pgstrom_icache_available())
+		return false;
+	if (!IsMVCCSnapshot(snapshot))
+		return false;
+	if (TransactionIdIsValid(GetTopTransactionIdIfAny()))
+		return false;
+	return true;
+}
+
+/*
+ * pgstrom_icache_lookup
+ *
+ * It looks up an inner hash table that was built by the inner plan with
+ * 'ident' under the equivalent snapshot, then returns a copy of them.
+ */
+pgstrom_data_store *
+pgstrom_icache_lookup(GpuContext *gcontext,
+					  const char *ident,
+					  Snapshot snapshot)
+{
+	icache_key		key;
+	icache_entry   *entry = NULL;
+	pgstrom_data_store *pds;
+	int				index;
+	dlist_iter		iter;
+
+	icache_setup_key(&key, ident, snapshot);
+	index = key.hash % ICACHE_HASH_SIZE;
+
+	SpinLockAcquire(&ic_head->lock);
+	dlist_foreach(iter, &ic_head->hash_slot[index])
+	{
+		icache_entry   *temp = dlist_container(icache_entry,
+											   hash_chain, iter.cur);
+		if (icache_entry_matches(temp, &key))
+		{
+			entry = temp;
+			break;
+		}
+	}
+
+	if (!entry)
+	{
+		ic_head->num_misses++;
+		SpinLockRelease(&ic_head->lock);
+		pfree(key.xip);
+		return NULL;
+	}
+	entry->refcnt++;
+	entry->nhits++;
+	dlist_move_head(&ic_head->lru_list, &entry->lru_chain);
+	ic_head->num_hits++;
+	SpinLockRelease(&ic_head->lock);
+	pfree(key.xip);
+
+	/* make a copy of the cached hash table, without lock */
+	PG_TRY();
+	{
+		pds = MemoryContextAllocZero(gcontext->memcxt,
+									 sizeof(pgstrom_data_store));
+		pds->refcnt = 1;
+		pds->kds_length = entry->kds_length;
+		pds->kds = MemoryContextAllocHuge(gcontext->memcxt,
+										  pds->kds_length);
+		memcpy(pds->kds, ICACHE_ENTRY_KDS(entry), entry->kds_length);
+		pds->kds->hostptr = (hostptr_t) &pds->kds->hostptr;
+		dlist_push_tail(&gcontext->pds_list, &pds->pds_chain);
+	}
+	PG_CATCH();
+	{
+		SpinLockAcquire(&ic_head->lock);
+		if (--entry->refcnt == 0)
+			icache_free(entry);
+		SpinLockRelease(&ic_head->lock);
+		PG_RE_THROW();
+	}
+	PG_END_TRY();
+
+	SpinLockAcquire(&ic_head->lock);
+	if (--entry->refcnt == 0)
+		icache_free(entry);
+	SpinLockRelease(&ic_head->lock);
+
+	return pds;
+}
+
+/*
+ * pgstrom_icache_insert
+ *
+ * It inserts a copy of the inner hash table that was built by the inner
+ * plan with 'ident' under the snapshot. If an equivalent entry is already
+ * cached by someone, we keep the older one.
+ */
+void
+pgstrom_icache_insert(const char *ident,
+					  Snapshot snapshot,
+					  Oid table_oid,
+					  pgstrom_data_store *pds)
+{
+	kern_data_store *kds = pds->kds;
+	icache_key		key;
+	icache_entry   *entry;
+	Size			xip_len;
+	Size			kds_offset;
+	int				index;
+	dlist_iter		iter;
+
+	Assert(kds->format == KDS_FORMAT_HASH && kds->nslots > 0);
+	icache_setup_key(&key, ident, snapshot);
+	index = key.hash % ICACHE_HASH_SIZE;
+	xip_len = sizeof(TransactionId) * (key.xcnt + Max(key.subxcnt, 0));
+	kds_offset = TYPEALIGN(STROMALIGN_LEN,
+						   offsetof(icache_entry, data) +
+						   MAXALIGN(key.ident_len) + xip_len)
+		- offsetof(icache_entry, data);
+
+	/* allocation of a new entry; invisible to others yet */
+	SpinLockAcquire(&ic_head->lock);
+	entry = icache_alloc(kds_offset + kds->length);
+	SpinLockRelease(&ic_head->lock);
+	if (!entry)
+	{
+		pfree(key.xip);
+		return;
+	}
+
+	entry->database_oid = MyDatabaseId;
+	entry->table_oid = table_oid;
+	entry->hash = key.hash;
+	entry->xmin = key.xmin;
+	entry->xmax = key.xmax;
+	entry->xcnt = key.xcnt;
+	entry->subxcnt = key.subxcnt;
+	entry->suboverflowed = key.suboverflowed;
+	entry->ident_len = key.ident_len;
+	entry->kds_offset = kds_offset;
+	entry->kds_length = kds->length;
+	memcpy(ICACHE_ENTRY_IDENT(entry), key.ident, key.ident_len);
+	if (xip_len > 0)
+		memcpy(ICACHE_ENTRY_XIP(entry), key.xip, xip_len);
+	memcpy(ICACHE_ENTRY_KDS(entry), kds, kds->length);
+
+	SpinLockAcquire(&ic_head->lock);
+	dlist_foreach(iter, &ic_head->hash_slot[index])
+	{
+		icache_entry   *temp = dlist_container(icache_entry,
+											   hash_chain, iter.cur);
+		if (icache_entry_matches(temp, &key))
+		{
+			/* someone already cached the equivalent one */
+			if (--entry->refcnt == 0)
+				icache_free(entry);
+			SpinLockRelease(&ic_head->lock);
+			pfree(key.xip);
+			return;
+		}
+	}
+	dlist_push_head(&ic_head->hash_slot[index], &entry->hash_chain);
+	dlist_push_head(&ic_head->lru_list, &entry->lru_chain);
+	SpinLockRelease(&ic_head->lock);
+	pfree(key.xip);
+}
+
+/*
+ * pgstrom_icache_info
+ *
+ * SQL function to dump the current inner hash cache entries
+ */
+typedef struct
+{
+	Oid				database_oid;
+	Oid				table_oid;
+	TransactionId	xmin;
+	TransactionId	xmax;
+	cl_uint			nitems;
+	Size			length;
+	int				refcnt;
+	cl_ulong		nhits;
+} icache_info;
+
+Datum
+pgstrom_icache_info(PG_FUNCTION_ARGS)
+{
+	FuncCallContext *fncxt;
+	icache_info	   *ic_info;
+	HeapTuple		tuple;
+	Datum			values[8];
+	bool			isnull[8];
+
+	if (SRF_IS_FIRSTCALL())
+	{
+		TupleDesc		tupdesc;
+		MemoryContext	oldcxt;
+		List		   *ic_info_list = NIL;
+		int				index;
+
+		fncxt = SRF_FIRSTCALL_INIT();
+		oldcxt = MemoryContextSwitchTo(fncxt->multi_call_memory_ctx);
+
+		tupdesc = CreateTemplateTupleDesc(8, false);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 1, "database_oid",
+						   OIDOID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 2, "table_oid",
+						   OIDOID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 3, "snapshot_xmin",
+						   XIDOID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 4, "snapshot_xmax",
+						   XIDOID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 5, "nitems",
+						   INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 6, "length",
+						   INT8OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 7, "refcnt",
+						   INT4OID, -1, 0);
+		TupleDescInitEntry(tupdesc, (AttrNumber) 8, "nhits",
+						   INT8OID, -1, 0);
+		fncxt->tuple_desc = BlessTupleDesc(tupdesc);
+
+		if (ic_head)
+		{
+			SpinLockAcquire(&ic_head->lock);
+			PG_TRY();
+			{
+				for (index=0; index < ICACHE_HASH_SIZE; index++)
+				{
+					dlist_iter	iter;
+
+					dlist_foreach(iter, &ic_head->hash_slot[index])
+					{
+						icache_entry   *entry
+							= dlist_container(icache_entry,
+											  hash_chain, iter.cur);
+
+						ic_info = palloc(sizeof(icache_info));
+						ic_info->database_oid = entry->database_oid;
+						ic_info->table_oid = entry->table_oid;
+						ic_info->xmin = entry->xmin;
+						ic_info->xmax = entry->xmax;
+						ic_info->nitems = ICACHE_ENTRY_KDS(entry)->nitems;
+						ic_info->length = entry->kds_length;
+						ic_info->refcnt = entry->refcnt;
+						ic_info->nhits = entry->nhits;
+						ic_info_list = lappend(ic_info_list, ic_info);
+					}
+				}
+			}
+			PG_CATCH();
+			{
+				SpinLockRelease(&ic_head->lock);
+				PG_RE_THROW();
+			}
+			PG_END_TRY();
+			SpinLockRelease(&ic_head->lock);
+		}
+		fncxt->user_fctx = ic_info_list;
+
+		MemoryContextSwitchTo(oldcxt);
+	}
+	fncxt = SRF_PERCALL_SETUP();
+
+	if (fncxt->user_fctx == NIL)
+		SRF_RETURN_DONE(fncxt);
+
+	ic_info = linitial((List *) fncxt->user_fctx);
+	fncxt->user_fctx = list_delete_first((List *) fncxt->user_fctx);
+
+	memset(isnull, 0, sizeof(isnull));
+	values[0] = ObjectIdGetDatum(ic_info->database_oid);
+	values[1] = ObjectIdGetDatum(ic_info->table_oid);
+	values[2] = TransactionIdGetDatum(ic_info->xmin);
+	values[3] = TransactionIdGetDatum(ic_info->xmax);
+	values[4] = Int64GetDatum(ic_info->nitems);
+	values[5] = Int64GetDatum(ic_info->length);
+	values[6] = Int32GetDatum(ic_info->refcnt);
+	values[7] = Int64GetDatum(ic_info->nhits);
+
+	tuple = heap_form_tuple(fncxt->tuple_desc, values, isnull);
+
+	SRF_RETURN_NEXT(fncxt, HeapTupleGetDatum(tuple));
+}
+PG_FUNCTION_INFO_V1(pgstrom_icache_info);
+
+static void
+pgstrom_startup_icache(void)
+{
+	icache_entry   *entry;
+	bool			found;
+	int				i;
+	int				shift;
+	char		   *curr_addr;
+	char		   *end_addr;
+
+	if (shmem_startup_next)
+		(*shmem_startup_next)();
+
+	ic_head = ShmemInitStruct("PG-Strom inner hash cache",
+							  icache_size, &found);
+	if (found)
+		elog(ERROR, "Bug? shared memory for inner hash cache already exists");
+
+	/* initialize inner hash cache header */
+	memset(ic_head, 0, offsetof(icache_head, data));
+	SpinLockInit(&ic_head->lock);
+	for (i=0; i <= ICACHE_MAX_BITS; i++)
+		dlist_init(&ic_head->free_list[i]);
+	for (i=0; i < ICACHE_HASH_SIZE; i++)
+		dlist_init(&ic_head->hash_slot[i]);
+	dlist_init(&ic_head->lru_list);
+	ic_head->entry_begin = (icache_entry *) BUFFERALIGN(ic_head->data);
+
+	/* makes free entries */
+	curr_addr = (char *) ic_head->entry_begin;
+	end_addr = ((char *) ic_head) + icache_size;
+	shift = ICACHE_MAX_BITS;
+	while (shift >= ICACHE_MIN_BITS)
+	{
+		if (curr_addr + (1UL << shift) > end_addr)
+		{
+			shift--;
+			continue;
+		}
+		entry = (icache_entry *) curr_addr;
+		memset(entry, 0, offsetof(icache_entry, data));
+		entry->shift = shift;
+		dlist_push_tail(&ic_head->free_list[shift], &entry->hash_chain);
+
+		curr_addr += (1UL << shift);
+	}
+	ic_head->entry_end = (icache_entry *) curr_addr;
+}
+
+void
+pgstrom_init_icache(void)
+{
+	static int	__icache_size;
+
+	/*
+	 * size of the inner hash cache; 0 means disabled
+	 */
+	DefineCustomIntVariable("pg_strom.icache_size",
+							"size of shared inner hash cache of GpuJoin",
+							NULL,
+							&__icache_size,
+							0,
+							0,
+							INT_MAX,
+							PGC_POSTMASTER,
+							GUC_NOT_IN_SAMPLE | GUC_UNIT_KB,
+							NULL, NULL, NULL);
+	icache_size = (Size)__icache_size * 1024L;
+
+	DefineCustomBoolVariable("pg_strom.enable_icache",
+							 "Enables to use the inner hash cache of GpuJoin",
+							 NULL,
+							 &enable_icache,
+							 true,
+							 PGC_USERSET,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
+
+	/* allocation of static shared memory, if enabled */
+	if (icache_size > 0)
+	{
+		RequestAddinShmemSpace(icache_size);
+		shmem_startup_next = shmem_startup_hook;
+		shmem_startup_hook = pgstrom_startup_icache;
+	}
+}
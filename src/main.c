@@ -187,6 +187,36 @@ pgstrom_init_misc_guc(void)
 							 NULL, NULL, NULL);
 }
 
+/*
+ * pgstrom_limit_tuples
+ *
+ * It returns number of rows required by the Limit node (OFFSET + LIMIT),
+ * if both of them are constant. Elsewhere, it returns -1.0.
+ */
+static double
+pgstrom_limit_tuples(Limit *limit)
+{
+	Const	   *con;
+	double		limit_tuples = 0.0;
+
+	if (!limit->limitCount)
+		return -1.0;
+	con = (Const *) limit->limitCount;
+	if (!IsA(con, Const) || con->constisnull)
+		return -1.0;
+	limit_tuples += (double) DatumGetInt64(con->constvalue);
+
+	if (limit->limitOffset)
+	{
+		con = (Const *) limit->limitOffset;
+		if (!IsA(con, Const))
+			return -1.0;
+		if (!con->constisnull)
+			limit_tuples += (double) DatumGetInt64(con->constvalue);
+	}
+	return (limit_tuples > 0.0 ? limit_tuples : -1.0);
+}
+
 /*
  * pgstrom_recursive_grafter
  *
@@ -197,6 +227,7 @@ static void
 pgstrom_recursive_grafter(PlannedStmt *pstmt, Plan *parent, Plan **p_curr_plan)
 {
 	Plan	   *plan = *p_curr_plan;
+	double		limit_tuples;
 	ListCell   *lc;
 
 	Assert(plan != NULL);
@@ -299,19 +330,25 @@ pgstrom_recursive_grafter(PlannedStmt *pstmt, Plan *parent, Plan **p_curr_plan)
 	{
 		case T_Sort:
 			/*
-			 * Heuristically, we should avoid to replace Sort-node just
-			 * below the Limit-node, because Limit-node informs Sort-node
-			 * minimum required number of rows then Sort-node takes special
-			 * optimization. It is not easy to win with GpuSort...
+			 * Limit-node informs Sort-node minimum required number of rows
+			 * then Sort-node takes bounded heap sort. GpuSort also supports
+			 * bounded mode, but only when the bound is a constant at the
+			 * planning time. Elsewhere, we don't replace the Sort-node,
+			 * because it is not easy to win with GpuSort...
 			 */
+			limit_tuples = -1.0;
 			if (parent && IsA(parent, Limit))
-				break;
+			{
+				limit_tuples = pgstrom_limit_tuples((Limit *) parent);
+				if (limit_tuples < 0.0)
+					break;
+			}
 
 			/*
 			 * Try to replace Sort node by GpuSort node if cost of
 			 * the alternative plan is enough reasonable to replace.
 			 */
-			pgstrom_try_insert_gpusort(pstmt, p_curr_plan);
+			pgstrom_try_insert_gpusort(pstmt, p_curr_plan, limit_tuples);
 			break;
 
 		case T_CustomScan:
@@ -388,8 +425,11 @@ _PG_init(void)
 	/* initialization of CUDA related stuff */
 	pgstrom_init_cuda_control();
 	pgstrom_init_cuda_program();
+	pgstrom_init_cuda_mmgr();
 	/* initialization of data store support */
 	pgstrom_init_datastore();
+	pgstrom_init_ccache();
+	pgstrom_init_icache();
 
 	/* registration of custom-scan providers */
 	pgstrom_init_gpuscan();
@@ -918,6 +958,16 @@ pgstrom_explain_perfmon(GpuTaskState *gts, ExplainState *es)
 		ExplainPropertyText("DMA recv", buf, es);
 	}
 
+	if (pfm->num_dma_compress > 0)
+	{
+		snprintf(buf, sizeof(buf),
+				 "len: %s, time: %s, count: %u",
+				 format_bytesz((double)pfm->bytes_dma_compress),
+				 format_millisec(pfm->time_dma_compress),
+				 pfm->num_dma_compress);
+		ExplainPropertyText("DMA compress", buf, es);
+	}
+
 	/* Time to build CUDA code */
 	if (pfm->tv_build_start.tv_sec > 0 &&
 		pfm->tv_build_end.tv_sec > 0 &&
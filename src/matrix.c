@@ -30,6 +30,7 @@
 #include "pg_strom.h"
 #include "cuda_matrix.h"
 #include <math.h>
+#include <cublas_v2.h>
 
 /* function declarations */
 extern Datum array_matrix_accum(PG_FUNCTION_ARGS);
@@ -89,6 +90,10 @@ extern Datum array_matrix_transpose_int4(PG_FUNCTION_ARGS);
 extern Datum array_matrix_transpose_int8(PG_FUNCTION_ARGS);
 extern Datum array_matrix_transpose_float4(PG_FUNCTION_ARGS);
 extern Datum array_matrix_transpose_float8(PG_FUNCTION_ARGS);
+extern Datum array_matrix_mul_float4(PG_FUNCTION_ARGS);
+extern Datum array_matrix_mul_float8(PG_FUNCTION_ARGS);
+extern Datum array_matrix_cov_float4(PG_FUNCTION_ARGS);
+extern Datum array_matrix_cov_float8(PG_FUNCTION_ARGS);
 extern Datum float4_as_int4(PG_FUNCTION_ARGS);
 extern Datum int4_as_float4(PG_FUNCTION_ARGS);
 extern Datum float8_as_int8(PG_FUNCTION_ARGS);
@@ -1582,6 +1587,277 @@ array_matrix_transpose_float8(PG_FUNCTION_ARGS)
 }
 PG_FUNCTION_INFO_V1(array_matrix_transpose_float8);
 
+/*
+ * matrix_gpu_gemm
+ *
+ * C := alpha * op(A) * B, using cuBLAS on the GPU device. op(A) is A itself
+ * or transposed A, according to trans_a. Both of array-matrix and cuBLAS
+ * assume column-major layout, so values are sent to the device as is.
+ * A and B may be the same buffer; it is sent only once in this case.
+ */
+static void
+matrix_gpu_gemm(bool is_double, bool trans_a,
+				int m, int n, int k, double alpha,
+				const void *A, int lda,
+				const void *B, int ldb,
+				void *C, int ldc)
+{
+	GpuContext	   *gcontext = pgstrom_get_gpucontext();
+	cl_int			cuda_index;
+	Size			unitsz = (is_double ? sizeof(double) : sizeof(float));
+	Size			len_a = unitsz * (Size) lda * (Size)(trans_a ? m : k);
+	Size			len_b = (A == B ? 0 : unitsz * (Size) ldb * (Size) n);
+	Size			len_c = unitsz * (Size) ldc * (Size) n;
+	CUdeviceptr		m_buffer = 0UL;
+	CUdeviceptr		m_a, m_b, m_c;
+	cublasHandle_t	handle = NULL;
+	cublasStatus_t	status;
+	CUresult		rc;
+
+	cuda_index = (gcontext->next_context++ % gcontext->num_context);
+	rc = cuCtxPushCurrent(gcontext->gpu[cuda_index].cuda_context);
+	if (rc != CUDA_SUCCESS)
+		elog(ERROR, "failed on cuCtxPushCurrent: %s", errorText(rc));
+
+	PG_TRY();
+	{
+		m_buffer = __gpuMemAlloc(gcontext, cuda_index,
+								 GPUMEMALIGN(len_a) +
+								 GPUMEMALIGN(len_b) +
+								 GPUMEMALIGN(len_c));
+		if (m_buffer == 0UL)
+			elog(ERROR, "out of device memory; %zu bytes required",
+				 GPUMEMALIGN(len_a) + GPUMEMALIGN(len_b) + GPUMEMALIGN(len_c));
+		m_a = m_buffer;
+		m_b = (A == B ? m_a : m_a + GPUMEMALIGN(len_a));
+		m_c = m_a + GPUMEMALIGN(len_a) + GPUMEMALIGN(len_b);
+
+		rc = cuMemcpyHtoD(m_a, A, len_a);
+		if (rc != CUDA_SUCCESS)
+			elog(ERROR, "failed on cuMemcpyHtoD: %s", errorText(rc));
+		if (A != B)
+		{
+			rc = cuMemcpyHtoD(m_b, B, len_b);
+			if (rc != CUDA_SUCCESS)
+				elog(ERROR, "failed on cuMemcpyHtoD: %s", errorText(rc));
+		}
+
+		status = cublasCreate(&handle);
+		if (status != CUBLAS_STATUS_SUCCESS)
+			elog(ERROR, "failed on cublasCreate: %d", (int) status);
+
+		if (is_double)
+		{
+			double	f_alpha = alpha;
+			double	f_beta = 0.0;
+
+			status = cublasDgemm(handle,
+								 trans_a ? CUBLAS_OP_T : CUBLAS_OP_N,
+								 CUBLAS_OP_N,
+								 m, n, k,
+								 &f_alpha,
+								 (const double *) m_a, lda,
+								 (const double *) m_b, ldb,
+								 &f_beta,
+								 (double *) m_c, ldc);
+		}
+		else
+		{
+			float	f_alpha = (float) alpha;
+			float	f_beta = 0.0;
+
+			status = cublasSgemm(handle,
+								 trans_a ? CUBLAS_OP_T : CUBLAS_OP_N,
+								 CUBLAS_OP_N,
+								 m, n, k,
+								 &f_alpha,
+								 (const float *) m_a, lda,
+								 (const float *) m_b, ldb,
+								 &f_beta,
+								 (float *) m_c, ldc);
+		}
+		if (status != CUBLAS_STATUS_SUCCESS)
+			elog(ERROR, "failed on cublas%sgemm: %d",
+				 is_double ? "D" : "S", (int) status);
+
+		/* synchronous; also waits for completion of the gemm kernel */
+		rc = cuMemcpyDtoH(C, m_c, len_c);
+		if (rc != CUDA_SUCCESS)
+			elog(ERROR, "failed on cuMemcpyDtoH: %s", errorText(rc));
+	}
+	PG_CATCH();
+	{
+		if (handle)
+			cublasDestroy(handle);
+		if (m_buffer != 0UL)
+			__gpuMemFree(gcontext, cuda_index, m_buffer);
+		rc = cuCtxPopCurrent(NULL);
+		if (rc != CUDA_SUCCESS)
+			elog(WARNING, "failed on cuCtxPopCurrent: %s", errorText(rc));
+		pgstrom_put_gpucontext(gcontext);
+		PG_RE_THROW();
+	}
+	PG_END_TRY();
+
+	status = cublasDestroy(handle);
+	if (status != CUBLAS_STATUS_SUCCESS)
+		elog(WARNING, "failed on cublasDestroy: %d", (int) status);
+	__gpuMemFree(gcontext, cuda_index, m_buffer);
+	rc = cuCtxPopCurrent(NULL);
+	if (rc != CUDA_SUCCESS)
+		elog(WARNING, "failed on cuCtxPopCurrent: %s", errorText(rc));
+	pgstrom_put_gpucontext(gcontext);
+}
+
+/*
+ * matrix_mul
+ *
+ * Product of two matrices; (m x k) * (k x n) => (m x n)
+ */
+static MatrixType *
+array_matrix_mul_common(MatrixType *X, MatrixType *Y, Oid elemtype)
+{
+	MatrixType *R;
+	cl_uint		m, n, k;
+	Size		length;
+
+	if (VARATT_IS_EXPANDED_HEADER(X) || !VALIDATE_ARRAY_MATRIX(X) ||
+		VARATT_IS_EXPANDED_HEADER(Y) || !VALIDATE_ARRAY_MATRIX(Y))
+		elog(ERROR, "Array is not like Matrix");
+	Assert(X->elemtype == elemtype && Y->elemtype == elemtype);
+
+	m = ARRAY_MATRIX_HEIGHT(X);
+	k = ARRAY_MATRIX_WIDTH(X);
+	n = ARRAY_MATRIX_WIDTH(Y);
+	if (k != ARRAY_MATRIX_HEIGHT(Y))
+		elog(ERROR, "matrix size mismatch: (%u x %u) * (%u x %u)",
+			 m, k, ARRAY_MATRIX_HEIGHT(Y), n);
+
+	length = ARRAY_MATRIX_RAWSIZE(elemtype == FLOAT8OID
+								  ? sizeof(double)
+								  : sizeof(float), m, n);
+	if (!AllocSizeIsValid(length))
+		elog(ERROR, "matrix array size too large");
+	R = create_empty_matrix(elemtype, n, m);
+
+	matrix_gpu_gemm(elemtype == FLOAT8OID, false,
+					m, n, k, 1.0,
+					ARRAY_MATRIX_DATAPTR(X), m,
+					ARRAY_MATRIX_DATAPTR(Y), k,
+					ARRAY_MATRIX_DATAPTR(R), m);
+	return R;
+}
+
+Datum
+array_matrix_mul_float4(PG_FUNCTION_ARGS)
+{
+	MatrixType *X = PG_GETARG_MATRIXTYPE_P(0);
+	MatrixType *Y = PG_GETARG_MATRIXTYPE_P(1);
+
+	PG_RETURN_MATRIXTYPE_P(array_matrix_mul_common(X, Y, FLOAT4OID));
+}
+PG_FUNCTION_INFO_V1(array_matrix_mul_float4);
+
+Datum
+array_matrix_mul_float8(PG_FUNCTION_ARGS)
+{
+	MatrixType *X = PG_GETARG_MATRIXTYPE_P(0);
+	MatrixType *Y = PG_GETARG_MATRIXTYPE_P(1);
+
+	PG_RETURN_MATRIXTYPE_P(array_matrix_mul_common(X, Y, FLOAT8OID));
+}
+PG_FUNCTION_INFO_V1(array_matrix_mul_float8);
+
+/*
+ * matrix_cov
+ *
+ * Sample covariance matrix of the columns; rows are observations.
+ * Columns are centered on the host side, then (Xc^T * Xc) / (height - 1)
+ * is computed on the GPU device.
+ */
+#define ARRAY_MATRIX_CENTERING_TEMPLATE(D,M,BASETYPE)					\
+	do {																\
+		Size		height = ARRAY_MATRIX_HEIGHT(M);					\
+		Size		width = ARRAY_MATRIX_WIDTH(M);						\
+		BASETYPE   *src = (BASETYPE *) ARRAY_MATRIX_DATAPTR(M);			\
+		BASETYPE   *dst = (BASETYPE *) (D);							\
+		Size		i, j;												\
+																		\
+		for (j=0; j < width; j++)										\
+		{																\
+			double	mean = 0.0;											\
+																		\
+			for (i=0; i < height; i++)									\
+				mean += (double) src[j * height + i];					\
+			mean /= (double) height;									\
+			for (i=0; i < height; i++)									\
+				dst[j * height + i] =									\
+					(BASETYPE)((double) src[j * height + i] - mean);	\
+		}																\
+	} while(0)
+
+static MatrixType *
+array_matrix_cov_common(MatrixType *X, Oid elemtype)
+{
+	MatrixType *R;
+	cl_uint		height;
+	cl_uint		width;
+	Size		unitsz = (elemtype == FLOAT8OID
+						  ? sizeof(double)
+						  : sizeof(float));
+	Size		length;
+	char	   *centered;
+
+	if (VARATT_IS_EXPANDED_HEADER(X) || !VALIDATE_ARRAY_MATRIX(X))
+		elog(ERROR, "Array is not like Matrix");
+	Assert(X->elemtype == elemtype);
+
+	height = ARRAY_MATRIX_HEIGHT(X);
+	width = ARRAY_MATRIX_WIDTH(X);
+	if (height < 2)
+		elog(ERROR, "covariance needs 2 or more rows");
+
+	length = ARRAY_MATRIX_RAWSIZE(unitsz, width, width);
+	if (!AllocSizeIsValid(length))
+		elog(ERROR, "matrix array size too large");
+	R = create_empty_matrix(elemtype, width, width);
+
+	centered = MemoryContextAllocHuge(CurrentMemoryContext,
+									  unitsz * (Size) height * (Size) width);
+	if (elemtype == FLOAT8OID)
+		ARRAY_MATRIX_CENTERING_TEMPLATE(centered, X, double);
+	else
+		ARRAY_MATRIX_CENTERING_TEMPLATE(centered, X, float);
+
+	matrix_gpu_gemm(elemtype == FLOAT8OID, true,
+					width, width, height,
+					1.0 / (double)(height - 1),
+					centered, height,
+					centered, height,
+					ARRAY_MATRIX_DATAPTR(R), width);
+	pfree(centered);
+
+	return R;
+}
+
+Datum
+array_matrix_cov_float4(PG_FUNCTION_ARGS)
+{
+	MatrixType *X = PG_GETARG_MATRIXTYPE_P(0);
+
+	PG_RETURN_MATRIXTYPE_P(array_matrix_cov_common(X, FLOAT4OID));
+}
+PG_FUNCTION_INFO_V1(array_matrix_cov_float4);
+
+Datum
+array_matrix_cov_float8(PG_FUNCTION_ARGS)
+{
+	MatrixType *X = PG_GETARG_MATRIXTYPE_P(0);
+
+	PG_RETURN_MATRIXTYPE_P(array_matrix_cov_common(X, FLOAT8OID));
+}
+PG_FUNCTION_INFO_V1(array_matrix_cov_float8);
+
 /*
  * float4_as_int4, int4_as_float4
  * float8_as_int8, int8_as_float8
@@ -25,6 +25,28 @@ CREATE FUNCTION pgstrom_scoreboard_info()
   AS 'MODULE_PATHNAME'
   LANGUAGE C STRICT;
 
+CREATE TYPE __pgstrom_perfmon_info AS (
+  node			text,
+  device		int4,
+  item			text,
+  count			int8,
+  bytes			int8,
+  time			float8,
+  stats_reset	timestamptz
+);
+CREATE FUNCTION pgstrom_perfmon_info()
+  RETURNS SETOF __pgstrom_perfmon_info
+  AS 'MODULE_PATHNAME'
+  LANGUAGE C STRICT;
+
+CREATE FUNCTION pgstrom_perfmon_reset()
+  RETURNS void
+  AS 'MODULE_PATHNAME'
+  LANGUAGE C STRICT;
+
+CREATE VIEW pgstrom.perfmon_stat AS
+  SELECT * FROM pgstrom_perfmon_info();
+
 CREATE TYPE __pgstrom_program_info AS (
   addr			int8,
   length		int8,
@@ -43,6 +65,50 @@ CREATE FUNCTION pgstrom_program_info()
   AS 'MODULE_PATHNAME'
   LANGUAGE C STRICT;
 
+CREATE FUNCTION pgstrom_program_prewarm(int4, text, text)
+  RETURNS void
+  AS 'MODULE_PATHNAME'
+  LANGUAGE C STRICT;
+
+CREATE FUNCTION pgstrom_program_prewarm_save()
+  RETURNS int4
+  AS 'MODULE_PATHNAME'
+  LANGUAGE C STRICT;
+
+CREATE FUNCTION pgstrom_program_prewarm_load()
+  RETURNS void
+  AS 'MODULE_PATHNAME'
+  LANGUAGE C STRICT;
+
+CREATE TYPE __pgstrom_ccache_info AS (
+  database_oid	oid,
+  table_oid		oid,
+  block_start	int8,
+  block_nums	int8,
+  nitems		int8,
+  length		int8,
+  refcnt		int4
+);
+CREATE FUNCTION pgstrom_ccache_info()
+  RETURNS SETOF __pgstrom_ccache_info
+  AS 'MODULE_PATHNAME'
+  LANGUAGE C STRICT;
+
+CREATE TYPE __pgstrom_icache_info AS (
+  database_oid	oid,
+  table_oid		oid,
+  snapshot_xmin	xid,
+  snapshot_xmax	xid,
+  nitems		int8,
+  length		int8,
+  refcnt		int4,
+  nhits			int8
+);
+CREATE FUNCTION pgstrom_icache_info()
+  RETURNS SETOF __pgstrom_icache_info
+  AS 'MODULE_PATHNAME'
+  LANGUAGE C STRICT;
+
 --
 -- functions for GpuPreAgg
 --
@@ -292,6 +358,44 @@ CREATE AGGREGATE pgstrom.avg_numeric(int4, numeric)
   finalfunc = pgstrom.numeric_avg_final
 );
 
+--
+-- Partial aggregates for numeric data type in fixed-point
+--
+CREATE FUNCTION pgstrom.sum_numeric_fixed_accum(internal, int8, int8, int4)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'pgstrom_sum_numeric_fixed_accum'
+  LANGUAGE C CALLED ON NULL INPUT;
+
+CREATE FUNCTION pgstrom.avg_numeric_fixed_accum(internal, int4,
+                                                int8, int8, int4)
+  RETURNS internal
+  AS 'MODULE_PATHNAME', 'pgstrom_avg_numeric_fixed_accum'
+  LANGUAGE C CALLED ON NULL INPUT;
+
+CREATE FUNCTION pgstrom.sum_numeric_fixed_final(internal)
+  RETURNS numeric
+  AS 'MODULE_PATHNAME', 'pgstrom_sum_numeric_fixed_final'
+  LANGUAGE C STRICT;
+
+CREATE FUNCTION pgstrom.avg_numeric_fixed_final(internal)
+  RETURNS numeric
+  AS 'MODULE_PATHNAME', 'pgstrom_avg_numeric_fixed_final'
+  LANGUAGE C STRICT;
+
+CREATE AGGREGATE pgstrom.sum_numeric_fixed(int8, int8, int4)
+(
+  sfunc = pgstrom.sum_numeric_fixed_accum,
+  stype = internal,
+  finalfunc = pgstrom.sum_numeric_fixed_final
+);
+
+CREATE AGGREGATE pgstrom.avg_numeric_fixed(int4, int8, int8, int4)
+(
+  sfunc = pgstrom.avg_numeric_fixed_accum,
+  stype = internal,
+  finalfunc = pgstrom.avg_numeric_fixed_final
+);
+
 --
 -- Partial aggregates for real/float data type
 --
@@ -1020,6 +1124,29 @@ CREATE FUNCTION pg_catalog.transpose(float8[])
   AS 'MODULE_PATHNAME','array_matrix_transpose_float8'
   LANGUAGE C STRICT;
 
+--
+-- Matrix operations on GPU device (cuBLAS)
+--
+CREATE FUNCTION pg_catalog.matrix_mul(float4[], float4[])
+  RETURNS float4[]
+  AS 'MODULE_PATHNAME','array_matrix_mul_float4'
+  LANGUAGE C STRICT;
+
+CREATE FUNCTION pg_catalog.matrix_mul(float8[], float8[])
+  RETURNS float8[]
+  AS 'MODULE_PATHNAME','array_matrix_mul_float8'
+  LANGUAGE C STRICT;
+
+CREATE FUNCTION pg_catalog.matrix_cov(float4[])
+  RETURNS float4[]
+  AS 'MODULE_PATHNAME','array_matrix_cov_float4'
+  LANGUAGE C STRICT;
+
+CREATE FUNCTION pg_catalog.matrix_cov(float8[])
+  RETURNS float8[]
+  AS 'MODULE_PATHNAME','array_matrix_cov_float8'
+  LANGUAGE C STRICT;
+
 --
 -- Type re-interpretation routines
 --
@@ -22,6 +22,7 @@
 #include "nodes/plannodes.h"
 #include "nodes/primnodes.h"
 #include "nodes/relation.h"
+#include "port/atomics.h"
 #include "storage/buf.h"
 #include "storage/fd.h"
 #include "storage/latch.h"
@@ -132,6 +133,9 @@ typedef struct {
 	cl_ulong	bytes_dma_recv;	/* bytes of DMA receive */
 	cl_double	time_dma_send;	/* time to send host=>device data */
 	cl_double	time_dma_recv;	/* time to receive device=>host data */
+	cl_uint		num_dma_compress;	/* number of compressed chunks */
+	cl_ulong	bytes_dma_compress;	/* original bytes of compressed chunks */
+	cl_double	time_dma_compress;	/* time to compress (including failed) */
 	/*-- specific items for each GPU logic --*/
 	cl_uint		num_tasks;			/* number of tasks completed */
 	cl_double	time_launch_cuda;	/* time to kick CUDA commands */
@@ -209,13 +213,14 @@ typedef struct {
  *
  *
  */
-struct GpuMemBlock;
+#define GPUMEM_CHUNKSZ_MIN_BIT		10		/* 1KB */
+#define GPUMEM_CHUNKSZ_MAX_BIT		34		/* 16GB */
+
 typedef struct
 {
-	struct GpuMemBlock *empty_block;
-	dlist_head		active_blocks;
-	dlist_head		unused_chunks;	/* cache for GpuMemChunk entries */
-	dlist_head		unused_blocks;	/* cache for GpuMemBlock entries */
+	dlist_head		blocks;			/* list of GpuMemBlock */
+	dlist_head		free_chunks[GPUMEM_CHUNKSZ_MAX_BIT + 1];
+	size_t			empty_size;		/* total size of empty blocks */
 	dlist_head		hash_slots[59];	/* hash to find out GpuMemChunk */
 } GpuMemHead;
 
@@ -242,11 +247,13 @@ typedef struct
 	dlist_head		pds_list;		/* list of pgstrom_data_store */
 	cl_int			num_context;	/* number of CUDA context */
 	cl_int			next_context;
+	cl_int			numa_node;		/* preferable NUMA node, or -1 */
 	struct {
 		CUdevice	cuda_device;
 		CUcontext	cuda_context;
 		GpuMemHead	cuda_memory;	/* wrapper of device memory allocation */
 		size_t		gmem_used;		/* device memory allocated */
+		cl_int		num_running;	/* tasks running on the device */
 	} gpu[FLEXIBLE_ARRAY_MEMBER];
 } GpuContext;
 
@@ -263,13 +270,27 @@ struct GpuTaskState
 	cl_uint			extra_flags;	/* flags for static inclusion */
 	const char	   *source_pathname;
 	CUmodule	   *cuda_modules;	/* CUmodules for each CUDA context */
+	pg_crc32		program_crc;	/* hash of the program, for autotuner */
 	bool			scan_done;		/* no rows to read, if true */
 	bool			be_row_format;	/* true, if KDS_FORMAT_ROW is required */
 	bool			outer_bulk_exec;/* true, if it bulk-exec on outer-node */
 	Instrumentation	outer_instrument; /* run time statistics */
 	TupleTableSlot *scan_overflow;	/* temp buffer, if unable to load */
+	BlockNumber		scan_prefetch_pos; /* position already prefetched */
+	char		   *scan_pagebuf;	/* BLCKSZ buffer for direct load */
+	Datum		   *scan_tup_values;/* buffer to deform a tuple on the */
+	bool		   *scan_tup_isnull;/* block load, for the column format */
+	bits8		   *scan_block_map;	/* blocks to be loaded, or NULL */
+	BlockNumber		scan_block_map_nblocks; /* # of blocks in the map */
+	BlockNumber		scan_block_skipped; /* # of blocks skipped by the map */
 	cl_long			curr_index;		/* current position on the curr_task */
+	Size			chunk_size_curr;/* length of the next chunk, or 0 */
+	Size			chunk_size_ceil;/* upper limit after overflow, or 0 */
+	cl_uint			chunk_overflow;	/* # of result buffer overflow */
 	struct GpuTask *curr_task;		/* a task currently processed */
+	pg_atomic_uint64 completed_stack; /* lock-free stack of tasks completed
+									   * by CUDA callbacks; see
+									   * pgstrom_complete_gputask() */
 	slock_t			lock;			/* protection of the fields below */
 	dlist_head		tracked_tasks;	/* for resource tracking */
 	dlist_head		running_tasks;	/* list for running tasks */
@@ -302,6 +323,7 @@ struct GpuTask
 {
 	dlist_node		chain;		/* link to task state list */
 	dlist_node		tracker;	/* link to task tracker list */
+	GpuTask		   *completed_next; /* link to completed_stack */
 	GpuTaskState   *gts;
 	bool			no_cuda_setup;	/* true, if no need to set up stream */
 	bool			cpu_fallback;	/* true, if task needs CPU fallback */
@@ -313,6 +335,19 @@ struct GpuTask
 	kern_errorbuf	kerror;		/* error status on CUDA kernel execution */
 };
 
+/*
+ * GpuTaskTuning - state of the kernel launch autotuner for a particular
+ * kernel launch of the task; see pgstrom_tuning_begin().
+ */
+typedef struct
+{
+	cl_uint			block_shift;	/* block size is shifted by this */
+	bool			under_trial;	/* true, if this launch is measured */
+	size_t			nitems;			/* number of items to be processed */
+	CUevent			ev_start;
+	CUevent			ev_stop;
+} GpuTaskTuning;
+
 /*
  * Type declarations for code generator
  */
@@ -360,8 +395,13 @@ typedef struct devfunc_info {
 	const char *func_sqlname;	/* name of the function in SQL side */
 	const char *func_devname;	/* name of the function in device side */
 	const char *func_decl;	/* declaration of device function, if any */
+	int32		func_pattern;	/* DEVFUNC_PATTERN_* flags, if pattern match */
 } devfunc_info;
 
+#define DEVFUNC_PATTERN_LIKE		0x0001	/* 2nd arg is LIKE pattern */
+#define DEVFUNC_PATTERN_REGEX		0x0002	/* 2nd arg is regular expression */
+#define DEVFUNC_PATTERN_ICASE		0x0004	/* case insensitive match */
+
 typedef struct devexpr_info {
 	NodeTag		expr_tag;		/* tag of the expression */
 	Oid			expr_collid;	/* OID of collation, if collation aware */
@@ -382,6 +422,8 @@ typedef struct pgstrom_data_store
 	dlist_node	pds_chain;	/* link to GpuContext->pds_list */
 	cl_int		refcnt;		/* reference counter */
 	Size		kds_length;	/* length of the kernel data store */
+	Size		column_fixed_length; /* KDS_FORMAT_COLUMN only; length of
+									  * the portion except for extra area */
 	kern_data_store *kds;
 } pgstrom_data_store;
 
@@ -402,6 +444,7 @@ extern MemoryContext
 HostPinMemContextCreate(MemoryContext parent,
                         const char *name,
 						CUcontext cuda_context,
+						cl_int numa_node,
                         Size block_size_init,
                         Size block_size_max,
 						cl_int **pp_keep_freemem,
@@ -409,6 +452,8 @@ HostPinMemContextCreate(MemoryContext parent,
 						cl_int **pp_num_host_mfree,
 						struct timeval **pp_tv_host_malloc,
 						struct timeval **pp_tv_host_mfree);
+extern void pgstrom_init_cuda_mmgr(void);
+
 /*
  * cuda_control.c
  */
@@ -433,14 +478,17 @@ extern void pgstrom_activate_gputaskstate(GpuTaskState *gts);
 extern void pgstrom_deactivate_gputaskstate(GpuTaskState *gts);
 extern void pgstrom_init_gputask(GpuTaskState *gts, GpuTask *gtask);
 extern void pgstrom_release_gputask(GpuTask *gtask);
+extern cl_uint pgstrom_select_cuda_index(GpuTaskState *gts);
 extern GpuTask *pgstrom_fetch_gputask(GpuTaskState *gts);
 extern pgstrom_data_store *pgstrom_exec_chunk_gputask(GpuTaskState *gts,
 													  size_t chunk_size);
 extern TupleTableSlot *pgstrom_exec_gputask(GpuTaskState *gts);
 extern bool pgstrom_recheck_gputask(GpuTaskState *gts, TupleTableSlot *slot);
 extern void pgstrom_cleanup_gputask_cuda_resources(GpuTask *gtask);
+extern void pgstrom_complete_gputask(GpuTask *gtask);
 extern size_t gpuLocalMemSize(void);
 extern cl_uint gpuMaxThreadsPerBlock(void);
+extern List *gpuNumaNodes(void);
 extern void optimal_workgroup_size(size_t *p_grid_size,
 								   size_t *p_block_size,
 								   CUfunction function,
@@ -455,11 +503,20 @@ extern void largest_workgroup_size(size_t *p_grid_size,
 								   size_t nitems,
 								   size_t dynamic_shmem_per_block,
 								   size_t dynamic_shmem_per_thread);
+extern void tuning_workgroup_size(size_t *p_grid_size,
+								  size_t *p_block_size,
+								  size_t nitems,
+								  cl_uint block_shift);
 extern void pgstrom_init_cuda_control(void);
 extern cl_ulong pgstrom_baseline_cuda_capability(void);
 extern const char *errorText(int errcode);
 extern const char *errorTextKernel(kern_errorbuf *kerror);
 extern Datum pgstrom_scoreboard_info(PG_FUNCTION_ARGS);
+extern void pgstrom_gpustat_program_cache(bool cache_hit);
+extern void pgstrom_gpustat_program_build(bool from_file, bool build_failed,
+										  cl_double tv_build);
+extern Datum pgstrom_perfmon_info(PG_FUNCTION_ARGS);
+extern Datum pgstrom_perfmon_reset(PG_FUNCTION_ARGS);
 extern Datum pgstrom_device_info(PG_FUNCTION_ARGS);
 
 /*
@@ -477,8 +534,30 @@ extern void pgstrom_assign_cuda_program(GpuTaskState *gts,
 										List *used_params,
 										const char *kern_source,
 										int extra_flags);
+extern void pgstrom_tuning_begin(GpuTask *gtask,
+								 GpuTaskTuning *tune,
+								 const char *kern_name,
+								 size_t nitems);
+extern void pgstrom_tuning_end(GpuTask *gtask, GpuTaskTuning *tune);
+extern void pgstrom_tuning_feedback(GpuTask *gtask,
+									GpuTaskTuning *tune,
+									const char *kern_name);
+extern void pgstrom_tuning_cleanup(GpuTaskTuning *tune);
 extern void pgstrom_init_cuda_program(void);
 extern Datum pgstrom_program_info(PG_FUNCTION_ARGS);
+extern Datum pgstrom_program_prewarm(PG_FUNCTION_ARGS);
+extern Datum pgstrom_program_prewarm_save(PG_FUNCTION_ARGS);
+extern Datum pgstrom_program_prewarm_load(PG_FUNCTION_ARGS);
+extern bool	pgstrom_program_prewarm_in_progress;
+
+/*
+ * PGSTROM_PRELOAD_CUDA_PROGRAM - true, if ExecInitNode of GPU nodes shall
+ * kick the build of the CUDA program. EXPLAIN (without ANALYZE) does not,
+ * except for the prewarm of the program on PREPARE.
+ */
+#define PGSTROM_PRELOAD_CUDA_PROGRAM(eflags)			\
+	(((eflags) & EXEC_FLAG_EXPLAIN_ONLY) == 0 ||		\
+	 pgstrom_program_prewarm_in_progress)
 
 /*
  * codegen.c
@@ -525,6 +604,8 @@ extern void pgstrom_init_codegen(void);
  * datastore.c
  */
 extern Size pgstrom_chunk_size(void);
+extern Size pgstrom_adaptive_chunk_size(GpuTaskState *gts);
+extern void pgstrom_update_chunk_size(GpuTaskState *gts);
 extern Size pgstrom_chunk_size_limit(void);
 extern bool pgstrom_bulk_exec_supported(const PlanState *planstate);
 extern cl_uint estimate_num_chunks(Path *pathnode);
@@ -562,19 +643,68 @@ extern pgstrom_data_store *PDS_create_slot(GpuContext *gcontext,
 extern pgstrom_data_store *PDS_create_hash(GpuContext *gcontext,
 										   TupleDesc tupdesc,
 										   Size length);
+extern pgstrom_data_store *PDS_create_column(GpuContext *gcontext,
+											 TupleDesc tupdesc,
+											 Bitmapset *referenced,
+											 cl_uint nrooms,
+											 Size length);
 extern int PDS_insert_block(pgstrom_data_store *pds,
 							Relation rel,
 							BlockNumber blknum,
 							Snapshot snapshot,
-							BufferAccessStrategy strategy);
+							BufferAccessStrategy strategy,
+							GpuTaskState *gts);
 extern bool PDS_insert_tuple(pgstrom_data_store *pds,
 							 TupleTableSlot *slot);
 extern bool PDS_insert_hashitem(pgstrom_data_store *pds,
 								TupleTableSlot *slot,
 								cl_uint hash_value);
 extern void PDS_build_hashtable(pgstrom_data_store *pds);
+extern kern_compressed_kds *pgstrom_compress_kds(GpuContext *gcontext,
+												 kern_data_store *kds,
+												 pgstrom_perfmon *pfm);
+extern size_t pgstrom_dma_send_kds(GpuTask *gtask,
+								   CUdeviceptr m_kds,
+								   kern_data_store *kds,
+								   CUdeviceptr m_kcmp,
+								   kern_compressed_kds *kcmp);
 extern void pgstrom_init_datastore(void);
 
+/*
+ * ccache.c
+ */
+extern bool pgstrom_ccache_enabled(Relation rel, Snapshot snapshot);
+extern cl_ulong pgstrom_ccache_generation(Relation rel, XLogRecPtr *p_lsn);
+extern pgstrom_data_store *pgstrom_ccache_lookup(GpuContext *gcontext,
+												 Relation rel,
+												 Bitmapset *column_refs,
+												 BlockNumber block_start,
+												 BlockNumber block_limit,
+												 BlockNumber *p_block_nums);
+extern void pgstrom_ccache_insert(Relation rel,
+								  pgstrom_data_store *pds,
+								  BlockNumber block_start,
+								  BlockNumber block_nums,
+								  cl_ulong generation,
+								  XLogRecPtr lsn);
+extern Datum pgstrom_ccache_info(PG_FUNCTION_ARGS);
+extern void pgstrom_init_ccache(void);
+
+/*
+ * icache.c
+ */
+extern bool pgstrom_icache_available(void);
+extern bool pgstrom_icache_enabled(Snapshot snapshot);
+extern pgstrom_data_store *pgstrom_icache_lookup(GpuContext *gcontext,
+												 const char *ident,
+												 Snapshot snapshot);
+extern void pgstrom_icache_insert(const char *ident,
+								  Snapshot snapshot,
+								  Oid table_oid,
+								  pgstrom_data_store *pds);
+extern Datum pgstrom_icache_info(PG_FUNCTION_ARGS);
+extern void pgstrom_init_icache(void);
+
 /*
  * gpuscan.c
  */
@@ -612,7 +742,8 @@ extern void pgstrom_init_gpupreagg(void);
 /*
  * gpusort.c
  */
-extern void pgstrom_try_insert_gpusort(PlannedStmt *pstmt, Plan **p_plan);
+extern void pgstrom_try_insert_gpusort(PlannedStmt *pstmt, Plan **p_plan,
+									   double limit_tuples);
 extern bool pgstrom_plan_is_gpusort(const Plan *plan);
 extern void assign_gpusort_session_info(StringInfo buf, GpuTaskState *gts);
 extern void pgstrom_init_gpusort(void);
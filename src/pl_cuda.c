@@ -16,6 +16,7 @@
  * GNU General Public License for more details.
  */
 #include "postgres.h"
+#include "access/hash.h"
 #include "access/tuptoaster.h"
 #include "access/xact.h"
 #include "catalog/dependency.h"
@@ -26,11 +27,13 @@
 #include "nodes/readfuncs.h"
 #include "parser/parse_func.h"
 #include "utils/builtins.h"
+#include "utils/guc.h"
 #include "utils/lsyscache.h"
 #include "utils/rel.h"
 #include "utils/syscache.h"
 #include "pg_strom.h"
 #include "cuda_plcuda.h"
+#include "cuda_timelib.h"
 
 typedef struct plcudaInfo
 {
@@ -336,6 +339,26 @@ typedef struct plcudaState
 	CUfunction		kern_main;
 	CUfunction		kern_post;
 	CUmodule	   *cuda_modules;
+	/* device buffers; kept across the invocations */
+	CUdeviceptr		m_kern_plcuda;
+	Size			kern_plcuda_bufsz;
+	CUdeviceptr		m_working_buf;
+	Size			working_bufsz;
+	CUdeviceptr		m_results_buf;
+	Size			results_bufsz;
+	/*
+	 * Stable arguments (Const or external Param) already on the device
+	 * buffer of kern_plcuda, if pg_strom.plcuda_keep_stable_args; these
+	 * are not sent again while the datum of same length and contents is
+	 * supplied at the same offset.
+	 */
+	bool		   *dev_args_valid;
+	Datum		   *dev_args;
+	cl_uint		   *dev_poffset;
+	Size		   *dev_arglen;
+	cl_uint		   *dev_arghash;
+	cl_uint		   *args_hash;		/* hash of the current arguments */
+	bool		   *args_skipped;	/* not copied to the current kplcuda */
 } plcudaState;
 
 /*
@@ -348,6 +371,9 @@ static void plcuda_exec_end(plcudaState *state);
 /* tracker of plcudaState */
 static dlist_head	plcuda_state_list;
 
+/* GUC variables */
+static bool		plcuda_keep_stable_args;
+
 /*
  * plcuda_parse_cmdline
  *
@@ -1069,12 +1095,59 @@ plcuda_codegen(Form_pg_proc procForm,
 	return kern.data;
 }
 
+/*
+ * plcuda_device_buffer
+ *
+ * It returns a device buffer at least 'required' bytes long. PL/CUDA
+ * function is usually invoked per row, so we keep the device buffers of
+ * the last invocation and reuse them as long as they are large enough.
+ * Large buffers are dedicated blocks of the device memory, so allocation
+ * and release per invocation means a pair of cuMemAlloc/cuMemFree for
+ * each row.
+ */
+static CUdeviceptr
+plcuda_device_buffer(plcudaState *state,
+					 CUdeviceptr *p_buffer, Size *p_bufsz, Size required)
+{
+	CUdeviceptr		m_buffer = *p_buffer;
+
+	if (m_buffer != 0UL)
+	{
+		if (*p_bufsz >= required)
+			return m_buffer;
+		__gpuMemFree(state->gcontext, state->cuda_index, m_buffer);
+		*p_buffer = 0UL;
+		*p_bufsz = 0;
+	}
+	m_buffer = __gpuMemAlloc(state->gcontext, state->cuda_index, required);
+	if (m_buffer == 0UL)
+		elog(ERROR, "out of device memory; %zu bytes required", required);
+	*p_buffer = m_buffer;
+	*p_bufsz = required;
+
+	return m_buffer;
+}
+
 static void
 __plcuda_cleanup_resources(plcudaState *state)
 {
 	GpuContext	   *gcontext = state->gcontext;
 	cl_uint			i, ndevs = gcontext->num_context;
 
+	if (state->m_kern_plcuda != 0UL)
+		__gpuMemFree(gcontext, state->cuda_index, state->m_kern_plcuda);
+	if (state->m_working_buf != 0UL)
+		__gpuMemFree(gcontext, state->cuda_index, state->m_working_buf);
+	if (state->m_results_buf != 0UL)
+		__gpuMemFree(gcontext, state->cuda_index, state->m_results_buf);
+	pfree(state->dev_args_valid);
+	pfree(state->dev_args);
+	pfree(state->dev_poffset);
+	pfree(state->dev_arglen);
+	pfree(state->dev_arghash);
+	pfree(state->args_hash);
+	pfree(state->args_skipped);
+
 	for (i=0; i < ndevs; i++)
 	{
 		CUresult	rc;
@@ -1191,6 +1264,23 @@ plcuda_exec_begin(Form_pg_proc procForm, plcudaInfo *cf_info)
 		kplcuda->__retval[sizeof(CUdeviceptr)] = true;
 	state->kplcuda_head = kplcuda;
 
+	/* tracker of the stable arguments on the device buffer */
+	i = Max(procForm->pronargs, 1);
+	state->dev_args_valid = MemoryContextAllocZero(gcontext->memcxt,
+												   sizeof(bool) * i);
+	state->dev_args = MemoryContextAllocZero(gcontext->memcxt,
+											 sizeof(Datum) * i);
+	state->dev_poffset = MemoryContextAllocZero(gcontext->memcxt,
+												sizeof(cl_uint) * i);
+	state->dev_arglen = MemoryContextAllocZero(gcontext->memcxt,
+											   sizeof(Size) * i);
+	state->dev_arghash = MemoryContextAllocZero(gcontext->memcxt,
+												sizeof(cl_uint) * i);
+	state->args_hash = MemoryContextAllocZero(gcontext->memcxt,
+											  sizeof(cl_uint) * i);
+	state->args_skipped = MemoryContextAllocZero(gcontext->memcxt,
+												 sizeof(bool) * i);
+
 	/* track state */
 	dlist_push_head(&plcuda_state_list, &state->chain);
 
@@ -1569,6 +1659,8 @@ __build_kern_plcuda(FunctionCallInfo fcinfo,
 			total_length += MAXALIGN(toast_raw_datum_size(fcinfo->arg[i]));
 	}
 	total_length = STROMALIGN(total_length);
+	if ((state->cf_info.extra_flags & DEVKERNEL_NEEDS_TIMELIB) != 0)
+		total_length += assign_timelib_session_tz(NULL);
 
 	/* setup kern_plcuda to be launched */
 	kplcuda = MemoryContextAlloc(gcontext->memcxt, total_length);
@@ -1590,6 +1682,7 @@ __build_kern_plcuda(FunctionCallInfo fcinfo,
 	{
 		kern_colmeta	cmeta = kplcuda_head->argmeta[i];
 
+		state->args_skipped[i] = false;
 		if (fcinfo->argnull[i])
 			kparams->poffset[i] = 0;	/* null */
 		else
@@ -1608,13 +1701,45 @@ __build_kern_plcuda(FunctionCallInfo fcinfo,
 				char   *vl_ptr = (char *)PG_DETOAST_DATUM(fcinfo->arg[i]);
 				Size	vl_len = VARSIZE_ANY(vl_ptr);
 
-				memcpy((char *)kparams + offset, vl_ptr, vl_len);
+				/*
+				 * Datum pointer is not a reliable identifier, because
+				 * a value of external Param may be released and another
+				 * one may be allocated at the same address. So, we also
+				 * check the length and the hash of the contents.
+				 */
+				if (plcuda_keep_stable_args)
+					state->args_hash[i] =
+						DatumGetUInt32(hash_any((unsigned char *) vl_ptr,
+												vl_len));
+				if (plcuda_keep_stable_args &&
+					state->dev_args_valid[i] &&
+					state->dev_args[i] == fcinfo->arg[i] &&
+					state->dev_poffset[i] == offset &&
+					state->dev_arglen[i] == vl_len &&
+					state->dev_arghash[i] == state->args_hash[i])
+				{
+					/* same stable argument is already on the device */
+					state->args_skipped[i] = true;
+				}
+				else
+					memcpy((char *)kparams + offset, vl_ptr, vl_len);
 				offset += MAXALIGN(vl_len);
 			}
 		}
 	}
 	kparams->nparams = fcinfo->nargs;
-	kparams->length = STROMALIGN(offset);
+	offset = STROMALIGN(offset);
+
+	/* transition table of the session timezone */
+	if ((state->cf_info.extra_flags & DEVKERNEL_NEEDS_TIMELIB) != 0)
+	{
+		kparams->session_tz_offset = offset;
+		offset += assign_timelib_session_tz((kern_session_tz *)
+											((char *)kparams + offset));
+	}
+	else
+		kparams->session_tz_offset = 0;
+	kparams->length = offset;
 
 	Assert(STROMALIGN(offsetof(kern_plcuda,
 							   argmeta[fcinfo->nargs])) +
@@ -1622,6 +1747,69 @@ __build_kern_plcuda(FunctionCallInfo fcinfo,
 	return kplcuda;
 }
 
+/*
+ * __plcuda_restore_skipped_args
+ *
+ * It copies the stable arguments skipped by __build_kern_plcuda, if the
+ * device buffer had to be allocated again, thus lost its contents.
+ */
+static void
+__plcuda_restore_skipped_args(FunctionCallInfo fcinfo,
+							  plcudaState *state,
+							  kern_plcuda *kplcuda)
+{
+	kern_parambuf  *kparams = KERN_PLCUDA_PARAMBUF(kplcuda);
+	int				i;
+
+	for (i=0; i < fcinfo->nargs; i++)
+	{
+		char   *vl_ptr;
+
+		if (!state->args_skipped[i])
+			continue;
+		vl_ptr = (char *)PG_DETOAST_DATUM(fcinfo->arg[i]);
+		memcpy((char *)kparams + kparams->poffset[i],
+			   vl_ptr, VARSIZE_ANY(vl_ptr));
+		state->args_skipped[i] = false;
+	}
+}
+
+/*
+ * __plcuda_track_stable_args
+ *
+ * It remembers the arguments that were sent to the device buffer and can
+ * be reused on the next invocation; only Const or external Param are
+ * stable during the query execution.
+ */
+static void
+__plcuda_track_stable_args(FunctionCallInfo fcinfo,
+						   plcudaState *state,
+						   kern_plcuda *kplcuda)
+{
+	kern_parambuf  *kparams = KERN_PLCUDA_PARAMBUF(kplcuda);
+	int				i;
+
+	for (i=0; i < fcinfo->nargs; i++)
+	{
+		if (!plcuda_keep_stable_args ||
+			fcinfo->argnull[i] ||
+			kplcuda->argmeta[i].attbyval ||
+			!get_fn_expr_arg_stable(fcinfo->flinfo, i))
+		{
+			state->dev_args_valid[i] = false;
+			continue;
+		}
+		if (!state->args_skipped[i])
+		{
+			state->dev_arglen[i] = toast_raw_datum_size(fcinfo->arg[i]);
+			state->dev_arghash[i] = state->args_hash[i];
+		}
+		state->dev_args[i] = fcinfo->arg[i];
+		state->dev_poffset[i] = kparams->poffset[i];
+		state->dev_args_valid[i] = true;
+	}
+}
+
 static Datum
 __launch_plcuda_kernels(plcudaState *state,
 						kern_plcuda *kplcuda,
@@ -1641,6 +1829,9 @@ __launch_plcuda_kernels(plcudaState *state,
 	CUdevice	cuda_device;
 	CUresult	rc;
 	Datum		retval;
+	kern_parambuf *kparams;
+	Size		dma_head;
+	int			i;
 
 	/* device to be used */
 	cuda_device = gcontext->gpu[state->cuda_index].cuda_device;
@@ -1657,13 +1848,37 @@ __launch_plcuda_kernels(plcudaState *state,
 
 	PG_TRY();
 	{
-		/* control block + argument buffer */
-		rc = cuMemcpyHtoDAsync(m_kern_plcuda,
-							   kplcuda,
-							   KERN_PLCUDA_DMASEND_LENGTH(kplcuda),
-							   stream);
-		if (rc != CUDA_SUCCESS)
-			elog(ERROR, "failed on cuMemcpyHtoDAsync: %s", errorText(rc));
+		/*
+		 * control block + argument buffer, except for the stable arguments
+		 * which are already on the device buffer
+		 */
+		kparams = KERN_PLCUDA_PARAMBUF(kplcuda);
+		dma_head = 0;
+		for (i=0; i <= kplcuda->nargs; i++)
+		{
+			Size	dma_tail;
+
+			if (i == kplcuda->nargs)
+				dma_tail = KERN_PLCUDA_DMASEND_LENGTH(kplcuda);
+			else if (state->args_skipped[i])
+				dma_tail = ((char *)kparams - (char *)kplcuda +
+							kparams->poffset[i]);
+			else
+				continue;
+
+			if (dma_tail > dma_head)
+			{
+				rc = cuMemcpyHtoDAsync(m_kern_plcuda + dma_head,
+									   (char *)kplcuda + dma_head,
+									   dma_tail - dma_head,
+									   stream);
+				if (rc != CUDA_SUCCESS)
+					elog(ERROR, "failed on cuMemcpyHtoDAsync: %s",
+						 errorText(rc));
+			}
+			if (i < kplcuda->nargs)
+				dma_head = dma_tail + MAXALIGN(state->dev_arglen[i]);
+		}
 
 		/* kernel arguments (common for all three kernels) */
 		kern_args[0] = &m_kern_plcuda;
@@ -2108,34 +2323,28 @@ plcuda_function_handler(PG_FUNCTION_ARGS)
 	PG_TRY();
 	{
 		/* kern_plcuda structure on the device side */
-		m_kern_plcuda = __gpuMemAlloc(state->gcontext,
-									  state->cuda_index,
-									  kplcuda->total_length);
-		if (m_kern_plcuda == 0UL)
-			elog(ERROR, "out of device memory; %u bytes required",
-				 kplcuda->total_length);
-
+		if (state->m_kern_plcuda == 0UL ||
+			state->kern_plcuda_bufsz < kplcuda->total_length)
+			__plcuda_restore_skipped_args(fcinfo, state, kplcuda);
+		m_kern_plcuda = plcuda_device_buffer(state,
+											 &state->m_kern_plcuda,
+											 &state->kern_plcuda_bufsz,
+											 kplcuda->total_length);
+		/* device buffer is unreliable until the DMA send gets completed */
+		memset(state->dev_args_valid, 0, sizeof(bool) * fcinfo->nargs);
 		/* working buffer on the device side */
 		if (working_bufsz > 0)
-		{
-			m_working_buf = __gpuMemAlloc(state->gcontext,
-										  state->cuda_index,
-										  working_bufsz);
-			if (m_working_buf == 0UL)
-				elog(ERROR, "out of device memory; %zu bytes required",
-					 working_bufsz);
-		}
-
+			m_working_buf = plcuda_device_buffer(state,
+												 &state->m_working_buf,
+												 &state->working_bufsz,
+												 working_bufsz);
 		/* results buffer on the device side */
 		if (results_bufsz > 0)
 		{
-			m_results_buf = __gpuMemAlloc(state->gcontext,
-										  state->cuda_index,
-										  results_bufsz);
-			if (m_results_buf == 0UL)
-				elog(ERROR, "out of device memory; %zu bytes required",
-					 results_bufsz);
-
+			m_results_buf = plcuda_device_buffer(state,
+												 &state->m_results_buf,
+												 &state->results_bufsz,
+												 results_bufsz);
 			/*
 			 * NOTE: We allocate host-side result buffer on the current
 			 * memory context (usually, per tuple), because we have no
@@ -2164,21 +2373,11 @@ plcuda_function_handler(PG_FUNCTION_ARGS)
 										 h_results_buf,
 										 &kerror,
 										 &isnull);
+		__plcuda_track_stable_args(fcinfo, state, kplcuda);
 	}
 	PG_CATCH();
 	{
-		__gpuMemFree(state->gcontext,
-					 state->cuda_index,
-					 m_kern_plcuda);
-		if (m_working_buf != 0UL)
-			__gpuMemFree(state->gcontext,
-						 state->cuda_index,
-						 m_working_buf);
-		if (m_results_buf != 0UL)
-			__gpuMemFree(state->gcontext,
-						 state->cuda_index,
-						 m_results_buf);
-
+		/* device buffers are released with plcudaState */
 		rc = cuCtxPopCurrent(NULL);
 		if (rc != CUDA_SUCCESS)
 			elog(WARNING, "failed on cuCtxPopCurrent: %s", errorText(rc));
@@ -2187,13 +2386,6 @@ plcuda_function_handler(PG_FUNCTION_ARGS)
 	}
 	PG_END_TRY();
 
-	/* release GPU resources */
-	__gpuMemFree(state->gcontext, state->cuda_index, m_kern_plcuda);
-	if (m_working_buf != 0UL)
-		__gpuMemFree(state->gcontext, state->cuda_index, m_working_buf);
-	if (m_results_buf != 0UL)
-		__gpuMemFree(state->gcontext, state->cuda_index, m_results_buf);
-
 	/* restore context */
 	rc = cuCtxPopCurrent(NULL);
 	if (rc != CUDA_SUCCESS)
@@ -2340,5 +2532,16 @@ pgstrom_init_plcuda(void)
 {
 	dlist_init(&plcuda_state_list);
 
+	DefineCustomBoolVariable("pg_strom.plcuda_keep_stable_args",
+							 "Keeps stable arguments of PL/CUDA functions "
+							 "on the device buffer across invocations",
+							 "PL/CUDA code must not modify its arguments "
+							 "on the device side, if enabled",
+							 &plcuda_keep_stable_args,
+							 false,
+							 PGC_USERSET,
+							 GUC_NOT_IN_SAMPLE,
+							 NULL, NULL, NULL);
+
 	RegisterResourceReleaseCallback(plcuda_cleanup_resources, NULL);
 }
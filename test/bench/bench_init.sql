@@ -0,0 +1,97 @@
+--
+-- Data generator of PG-Strom benchmark (SSB-like star schema)
+--
+-- psql -v scale=<scale factor> -f bench_init.sql
+--
+-- It builds the tables on the current schema (search_path). The fact table
+-- (lineorder) has 6M rows per scale factor; the dimension tables are sized
+-- according to the Star Schema Benchmark. Random values are seeded, so the
+-- same scale factor always produces the same data set.
+--
+DROP TABLE IF EXISTS lineorder;
+DROP TABLE IF EXISTS customer;
+DROP TABLE IF EXISTS supplier;
+DROP TABLE IF EXISTS part;
+DROP TABLE IF EXISTS date1;
+
+CREATE TABLE date1 (d_datekey int, d_date date, d_year int,
+                    d_yearmonthnum int, d_month int, d_weeknuminyear int);
+CREATE TABLE customer (c_custkey int, c_name text, c_city text,
+                       c_nation text, c_region text);
+CREATE TABLE supplier (s_suppkey int, s_name text, s_city text,
+                       s_nation text, s_region text);
+CREATE TABLE part (p_partkey int, p_name text, p_mfgr text,
+                   p_category text, p_brand1 text, p_size int);
+CREATE TABLE lineorder (lo_orderkey int, lo_linenumber int,
+                        lo_custkey int, lo_partkey int, lo_suppkey int,
+                        lo_orderdate int, lo_commitdate date,
+                        lo_shipts timestamp, lo_shipmode text,
+                        lo_quantity int, lo_extendedprice int,
+                        lo_ordtotalprice numeric, lo_discount int,
+                        lo_revenue int, lo_supplycost int, lo_tax int,
+                        lo_price money);
+
+SELECT setseed(0.5);
+
+INSERT INTO date1
+  (SELECT to_char(d, 'YYYYMMDD')::int, d, extract(year from d),
+          to_char(d, 'YYYYMM')::int, extract(month from d),
+          extract(week from d)
+     FROM generate_series('1992-01-01'::date,
+                          '1998-12-31'::date, '1 day') d);
+
+CREATE TEMP TABLE bench_nation (n_nationkey int, n_name text, n_region text);
+INSERT INTO bench_nation
+  (SELECT i - 1, n[i], r[(i - 1) / 5 + 1]
+     FROM (SELECT ARRAY['ALGERIA','ETHIOPIA','KENYA','MOROCCO','MOZAMBIQUE',
+                        'ARGENTINA','BRAZIL','CANADA','PERU','UNITED STATES',
+                        'CHINA','INDIA','INDONESIA','JAPAN','VIETNAM',
+                        'FRANCE','GERMANY','ROMANIA','RUSSIA','UNITED KINGDOM',
+                        'EGYPT','IRAN','IRAQ','JORDAN','SAUDI ARABIA'] n,
+                  ARRAY['AFRICA','AMERICA','ASIA','EUROPE','MIDDLE EAST'] r) a,
+          generate_series(1,25) i);
+
+INSERT INTO customer
+  (SELECT x, 'Customer#' || lpad(x::text, 9, '0'),
+          substr(n_name, 1, 9) || (x % 10), n_name, n_region
+     FROM (SELECT x, floor(random() * 25)::int nkey
+             FROM generate_series(1, 30000 * :scale) x) s, bench_nation
+    WHERE nkey = n_nationkey);
+
+INSERT INTO supplier
+  (SELECT x, 'Supplier#' || lpad(x::text, 9, '0'),
+          substr(n_name, 1, 9) || (x % 10), n_name, n_region
+     FROM (SELECT x, floor(random() * 25)::int nkey
+             FROM generate_series(1, 2000 * :scale) x) s, bench_nation
+    WHERE nkey = n_nationkey);
+
+INSERT INTO part
+  (SELECT x, md5(x::text), 'MFGR#' || m, 'MFGR#' || m || c,
+          'MFGR#' || m || c || b, 1 + floor(random() * 50)::int
+     FROM (SELECT x, 1 + floor(random() * 5)::int m,
+                  1 + floor(random() * 5)::int c,
+                  1 + floor(random() * 40)::int b
+             FROM generate_series(1, 200000 * :scale) x) s);
+
+INSERT INTO lineorder
+  (SELECT (x + 3) / 4, x % 4 + 1,
+          1 + floor(random() * 30000 * :scale)::int,
+          1 + floor(random() * 200000 * :scale)::int,
+          1 + floor(random() * 2000 * :scale)::int,
+          to_char(d, 'YYYYMMDD')::int, d + 30 + (x % 60),
+          d + (x % 86400) * '1 second'::interval,
+          (ARRAY['AIR','FOB','MAIL','RAIL','REG AIR','SHIP','TRUCK'])[x % 7 + 1],
+          q, p * q, (p * q)::numeric * 1.05, disc,
+          p * q * (100 - disc) / 100, p * 6 / 10, x % 9,
+          (p * q)::numeric::money
+     FROM (SELECT x, '1992-01-01'::date + floor(random() * 2557)::int d,
+                  1 + floor(random() * 50)::int q,
+                  900 + floor(random() * 100000)::int p,
+                  floor(random() * 11)::int disc
+             FROM generate_series(1, 6000000 * :scale) x) s);
+
+VACUUM ANALYZE date1;
+VACUUM ANALYZE customer;
+VACUUM ANALYZE supplier;
+VACUUM ANALYZE part;
+VACUUM ANALYZE lineorder;
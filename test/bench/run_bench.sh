@@ -0,0 +1,176 @@
+#!/bin/sh
+#
+# run_bench.sh - benchmark driver of PG-Strom
+#
+# It builds the SSB-like data set for each scale factor (once), then runs
+# every query in sql/ with and without PG-Strom, and records the minimum
+# and the median of the execution time reported by EXPLAIN ANALYZE.
+# The perfmon breakdown of the GPU run is also saved for each query.
+#
+# Parameters are given by environment variables, usually by 'make bench'.
+#
+#   PSQL             : psql command (default: psql)
+#   BENCH_DB         : database to run the benchmark (default: postgres)
+#   BENCH_SCALES     : list of scale factors (default: 1)
+#   BENCH_LOOPS      : number of measured runs per query (default: 5)
+#   BENCH_QUERIES    : list of query names; all in sql/ if empty
+#   BENCH_REGEN      : rebuild the data set even if exists, if 1
+#   BENCH_RESULT_DIR : directory to save the results (default: ./bench_result)
+#   BENCH_BASELINE   : results.tsv of the previous run to be compared
+#   BENCH_THRESHOLD  : percentage of the slowdown to report as regression
+#                      (default: 10)
+#
+# The query file may have 'SET ...;' lines at the head; these are run prior
+# to the query, and the rest of the file is the query to be measured.
+#
+PSQL=${PSQL:-psql}
+BENCH_DB=${BENCH_DB:-postgres}
+BENCH_SCALES=${BENCH_SCALES:-1}
+BENCH_LOOPS=${BENCH_LOOPS:-5}
+BENCH_RESULT_DIR=${BENCH_RESULT_DIR:-./bench_result}
+BENCH_THRESHOLD=${BENCH_THRESHOLD:-10}
+BENCH_DIR=`dirname $0`
+
+PSQL_CMD="$PSQL -X -q -At -v ON_ERROR_STOP=1 -d $BENCH_DB"
+
+if [ -z "$BENCH_QUERIES" ]; then
+    BENCH_QUERIES=`ls $BENCH_DIR/sql/*.sql | xargs -n1 basename | sed -e 's/\.sql$//g'`
+fi
+
+mkdir -p $BENCH_RESULT_DIR || exit 1
+RESULT_TSV=$BENCH_RESULT_DIR/results.tsv
+printf "scale\tquery\tmode\tmin_ms\tmedian_ms\n" > $RESULT_TSV
+
+#
+# run_query <schema> <query name> <enabled> <explain options> [<command>...]
+#
+# It prints the EXPLAIN ANALYZE output of the query
+#
+run_query()
+{
+    __schema=$1
+    __qfile=$BENCH_DIR/sql/$2.sql
+    __enabled=$3
+    __options=$4
+    shift 4
+    (
+        echo "SET search_path = $__schema, public;"
+        echo "SET pg_strom.enabled = $__enabled;"
+        grep -i '^SET ' $__qfile
+        for __cmd in "$@"; do
+            echo "$__cmd"
+        done
+        echo "EXPLAIN ($__options)"
+        grep -iv '^SET ' $__qfile
+    ) | $PSQL_CMD -f -
+}
+
+for scale in $BENCH_SCALES
+do
+    schema="bench_sf$scale"
+    mkdir -p $BENCH_RESULT_DIR/sf$scale || exit 1
+
+    #
+    # Build the data set, if not exists
+    #
+    exists=`$PSQL_CMD -c "SELECT count(*) FROM pg_tables WHERE schemaname = '$schema' AND tablename = 'lineorder'"` || exit 1
+    if [ "$exists" = "0" -o "$BENCH_REGEN" = "1" ]; then
+        echo "building data set of scale factor $scale ..."
+        (
+            echo "CREATE SCHEMA IF NOT EXISTS $schema;"
+            echo "SET search_path = $schema, public;"
+            cat $BENCH_DIR/bench_init.sql
+        ) | $PSQL_CMD -v scale=$scale -o /dev/null -f - || exit 1
+    fi
+
+    for query in $BENCH_QUERIES
+    do
+        for mode in gpu cpu
+        do
+            if [ "$mode" = "gpu" ]; then
+                enabled=on
+            else
+                enabled=off
+            fi
+            # warm-up; also waits for the run-time build of the GPU kernel
+            run_query $schema $query $enabled "ANALYZE, TIMING OFF" \
+                > /dev/null || exit 1
+
+            times=""
+            i=0
+            while [ $i -lt $BENCH_LOOPS ]
+            do
+                t=`run_query $schema $query $enabled "ANALYZE, TIMING OFF" | \
+                   awk '/^Execution time:/{print $3}'` || exit 1
+                times="$times $t"
+                i=`expr $i + 1`
+            done
+            echo $times | tr ' ' '\n' | sort -n | awk -v sf=$scale \
+                -v q=$query -v m=$mode '
+                NF > 0 { v[++n] = $1 }
+                END {
+                    if (n == 0) exit;
+                    if (n % 2) med = v[(n + 1) / 2];
+                    else med = (v[n / 2] + v[n / 2 + 1]) / 2.0;
+                    printf "%s\t%s\t%s\t%.3f\t%.3f\n", sf, q, m, v[1], med;
+                }' >> $RESULT_TSV
+        done
+
+        #
+        # Perfmon breakdown of the GPU run, and the cumulative statistics
+        # (needs superuser privilege to reset the statistics)
+        #
+        run_query $schema $query on "ANALYZE, VERBOSE" \
+            "SELECT pgstrom_perfmon_reset();" \
+            "SET pg_strom.perfmon = on;" \
+            > $BENCH_RESULT_DIR/sf$scale/$query.perfmon || exit 1
+        $PSQL_CMD -F "	" -c "SELECT node, device, item, count, bytes, round(time::numeric, 3) AS time FROM pgstrom.perfmon_stat WHERE count > 0 OR bytes > 0 ORDER BY node, device, item" \
+            >> $BENCH_RESULT_DIR/sf$scale/$query.perfmon || exit 1
+    done
+done
+
+#
+# Summary of the results
+#
+echo
+awk -F '\t' '
+NR > 1 {
+    key = $1 "\t" $2;
+    if (!(key in seen)) { seen[key] = 1; keys[n++] = key; }
+    t[key, $3] = $5;
+}
+END {
+    printf "%-6s %-20s %12s %12s %8s\n", "scale", "query", "gpu (ms)", "cpu (ms)", "speedup";
+    for (i=0; i < n; i++) {
+        split(keys[i], k, "\t");
+        g = t[keys[i], "gpu"];
+        c = t[keys[i], "cpu"];
+        printf "%-6s %-20s %12.3f %12.3f %7.2fx\n", k[1], k[2], g, c,
+               (g > 0.0 ? c / g : 0.0);
+    }
+}' $RESULT_TSV
+
+#
+# Comparison to the baseline, if any
+#
+if [ -n "$BENCH_BASELINE" ]; then
+    echo
+    awk -F '\t' -v threshold=$BENCH_THRESHOLD '
+    FNR == 1 { next }
+    NR == FNR { base[$1, $2, $3] = $5; next }
+    {
+        if (!(($1, $2, $3) in base) || base[$1, $2, $3] <= 0.0)
+            next;
+        ratio = $5 / base[$1, $2, $3];
+        if (ratio > 1.0 + threshold / 100.0) {
+            printf "REGRESSION: scale %s, %s (%s): %.3f ms -> %.3f ms (%+.1f%%)\n",
+                   $1, $2, $3, base[$1, $2, $3], $5, (ratio - 1.0) * 100.0;
+            nfail++;
+        }
+    }
+    END {
+        if (nfail > 0) exit 1;
+        print "no regression larger than " threshold "% from the baseline";
+    }' $BENCH_BASELINE $RESULT_TSV || exit 1
+fi
+exit 0
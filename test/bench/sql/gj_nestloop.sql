@@ -0,0 +1,6 @@
+-- GpuNestLoop: non-equivalent join condition
+SELECT count(*)
+  FROM lineorder, date1
+ WHERE lo_orderdate < d_datekey
+   AND d_year = 1998 AND d_month = 12 AND d_weeknuminyear = 52
+   AND lo_quantity = 1;
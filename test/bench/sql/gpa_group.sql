@@ -0,0 +1,5 @@
+-- GpuPreAgg: aggregation with small number of groups
+SELECT lo_orderdate / 100 AS yearmonth, count(*),
+       sum(lo_revenue), avg(lo_discount)
+  FROM lineorder
+ GROUP BY lo_orderdate / 100;
@@ -0,0 +1,4 @@
+-- GpuPreAgg: aggregation with large number of groups
+SELECT lo_suppkey, count(*), sum(lo_revenue), stddev(lo_quantity)
+  FROM lineorder
+ GROUP BY lo_suppkey;
@@ -0,0 +1,4 @@
+-- GpuPreAgg: aggregation without grouping keys
+SELECT count(*), sum(lo_revenue), avg(lo_quantity),
+       min(lo_extendedprice), max(lo_extendedprice)
+  FROM lineorder;
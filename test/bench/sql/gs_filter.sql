@@ -0,0 +1,4 @@
+-- GpuScan: simple qualifiers on the fact table
+SELECT lo_orderkey, lo_linenumber, lo_revenue
+  FROM lineorder
+ WHERE lo_discount BETWEEN 4 AND 6 AND lo_quantity > 40;
@@ -0,0 +1,5 @@
+-- GpuScan: qualifiers with arithmetic projection
+SELECT lo_orderkey, lo_extendedprice * (100 - lo_discount) / 100 AS net,
+       lo_extendedprice * (100 + lo_tax) / 100 AS gross
+  FROM lineorder
+ WHERE lo_quantity * lo_discount < 60;
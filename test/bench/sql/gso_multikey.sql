@@ -0,0 +1,6 @@
+-- GpuSort: multiple sort keys
+SET pg_strom.enable_gpusort = on;
+SELECT lo_custkey, lo_orderdate, lo_revenue
+  FROM lineorder
+ WHERE lo_discount = 0
+ ORDER BY lo_custkey, lo_orderdate DESC, lo_revenue;
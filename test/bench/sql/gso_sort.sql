@@ -0,0 +1,6 @@
+-- GpuSort: single sort key
+SET pg_strom.enable_gpusort = on;
+SELECT lo_orderkey, lo_linenumber, lo_revenue
+  FROM lineorder
+ WHERE lo_quantity < 10
+ ORDER BY lo_revenue DESC;
@@ -0,0 +1,4 @@
+-- micro benchmark of cuda_mathlib.h
+SELECT count(*)
+  FROM lineorder
+ WHERE sqrt(lo_extendedprice::float8) + sin(lo_revenue::float8) > 1000.0;
@@ -0,0 +1,4 @@
+-- micro benchmark of cuda_money.h
+SELECT count(*)
+  FROM lineorder
+ WHERE lo_price * 0.9 > '2500000.00'::money;
@@ -0,0 +1,4 @@
+-- micro benchmark of cuda_numeric.h
+SELECT count(*)
+  FROM lineorder
+ WHERE lo_ordtotalprice * 0.95 - lo_supplycost::numeric > 1000000.0;
@@ -0,0 +1,4 @@
+-- micro benchmark of cuda_textlib.h
+SELECT count(*)
+  FROM lineorder
+ WHERE lo_shipmode LIKE '%AIR%' OR lo_shipmode = 'TRUCK';
@@ -0,0 +1,5 @@
+-- micro benchmark of cuda_timelib.h
+SELECT count(*)
+  FROM lineorder
+ WHERE lo_commitdate - 45 > '1995-01-01'::date
+   AND lo_shipts < '1997-06-30 12:00:00'::timestamp;
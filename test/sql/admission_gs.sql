@@ -0,0 +1,117 @@
+--#
+--#       Admission control TestCases (run alone; it checks the number
+--#       of running tasks on the devices)
+--#
+
+set enable_seqscan to off;
+set enable_bitmapscan to off;
+set enable_indexscan to off;
+set random_page_cost=1000000;   --# force off index_scan.
+set pg_strom.gpu_setup_cost=0;
+set pg_strom.enable_gpupreagg to off;
+set pg_strom.enable_gpusort to off;
+set client_min_messages to warning;
+
+CREATE EXTENSION IF NOT EXISTS dblink;
+
+--# a device memory block is 8 times of the chunk size; 32MB
+set pg_strom.chunk_size = '4MB';
+
+DROP TABLE IF EXISTS strom_admission_test;
+CREATE TABLE strom_admission_test (
+       id  integer,
+       a   integer,
+       b   float,
+       pad text
+);
+INSERT INTO strom_admission_test SELECT
+       x, x % 1000, x / 7.0, md5(x::text)
+  FROM generate_series(1,500000) x;
+ANALYZE strom_admission_test;
+
+CREATE TEMP VIEW admission_running AS
+SELECT coalesce(sum(value::int), 0) running
+  FROM pgstrom_device_info()
+ WHERE property = 'Admission control: number of running tasks';
+
+set pg_strom.enabled to off;
+CREATE TEMP TABLE admission_cpu1 AS
+SELECT id, a, b FROM strom_admission_test WHERE a % 7 = 3;
+CREATE TEMP TABLE admission_cpu2 AS
+SELECT o.id, o.b, i.pad FROM strom_admission_test o
+  JOIN strom_admission_test i ON o.id = i.a + 1
+ WHERE i.id < 5000;
+reset pg_strom.enabled;
+
+--# one task in flight per device
+set pg_strom.max_device_tasks = 1;
+CREATE TEMP TABLE admission_gpu1 AS
+SELECT id, a, b FROM strom_admission_test WHERE a % 7 = 3;
+CREATE TEMP TABLE admission_gpu2 AS
+SELECT o.id, o.b, i.pad FROM strom_admission_test o
+  JOIN strom_admission_test i ON o.id = i.a + 1
+ WHERE i.id < 5000;
+SELECT running = 0 AS released FROM admission_running;
+
+SELECT count(*) > 0 AS nonempty FROM admission_gpu1;
+SELECT count(*) FROM (SELECT * FROM admission_gpu1 EXCEPT ALL
+                      SELECT * FROM admission_cpu1) d;
+SELECT count(*) FROM (SELECT * FROM admission_cpu1 EXCEPT ALL
+                      SELECT * FROM admission_gpu1) d;
+SELECT count(*) > 0 AS nonempty FROM admission_gpu2;
+SELECT count(*) FROM (SELECT * FROM admission_gpu2 EXCEPT ALL
+                      SELECT * FROM admission_cpu2) d;
+SELECT count(*) FROM (SELECT * FROM admission_cpu2 EXCEPT ALL
+                      SELECT * FROM admission_gpu2) d;
+
+--# another backend runs under the same limitation concurrently
+SELECT dblink_connect('admission_conn', 'dbname=' || current_database() ||
+                      ' port=' || current_setting('port')) = 'OK' AS connected;
+SELECT dblink_exec('admission_conn',
+       'set pg_strom.max_device_tasks = 1') AS config;
+SELECT dblink_exec('admission_conn',
+       'set pg_strom.chunk_size = ''4MB''') AS config;
+SELECT dblink_send_query('admission_conn',
+       'SELECT count(*), sum(id) FROM strom_admission_test
+         WHERE a % 7 = 3') AS sent;
+CREATE TEMP TABLE admission_gpu3 AS
+SELECT id, a, b FROM strom_admission_test WHERE a % 7 = 3;
+SELECT t.cnt = c.cnt AND t.sum_id = c.sum_id AS matched
+  FROM dblink_get_result('admission_conn') AS t(cnt bigint, sum_id numeric),
+       (SELECT count(*) cnt, sum(id) sum_id FROM admission_cpu1) c;
+SELECT count(*) FROM dblink_get_result('admission_conn')
+                  AS t(cnt bigint, sum_id numeric);
+SELECT dblink_disconnect('admission_conn');
+SELECT running = 0 AS released FROM admission_running;
+
+SELECT count(*) FROM (SELECT * FROM admission_gpu3 EXCEPT ALL
+                      SELECT * FROM admission_cpu1) d;
+SELECT count(*) FROM (SELECT * FROM admission_cpu1 EXCEPT ALL
+                      SELECT * FROM admission_gpu3) d;
+
+--# running tasks are returned on the error, too
+SELECT count(*) FROM strom_admission_test WHERE 1 / (id - 250000) = 0;
+SELECT running = 0 AS released FROM admission_running;
+reset pg_strom.max_device_tasks;
+
+--# device memory quota less than a block; only the first block is allowed
+set pg_strom.gpu_memory_quota = '1MB';
+CREATE TEMP TABLE admission_gpu4 AS
+SELECT id, a, b FROM strom_admission_test WHERE a % 7 = 3;
+CREATE TEMP TABLE admission_gpu5 AS
+SELECT o.id, o.b, i.pad FROM strom_admission_test o
+  JOIN strom_admission_test i ON o.id = i.a + 1
+ WHERE i.id < 5000;
+reset pg_strom.gpu_memory_quota;
+SELECT running = 0 AS released FROM admission_running;
+
+SELECT count(*) FROM (SELECT * FROM admission_gpu4 EXCEPT ALL
+                      SELECT * FROM admission_cpu1) d;
+SELECT count(*) FROM (SELECT * FROM admission_cpu1 EXCEPT ALL
+                      SELECT * FROM admission_gpu4) d;
+SELECT count(*) FROM (SELECT * FROM admission_gpu5 EXCEPT ALL
+                      SELECT * FROM admission_cpu2) d;
+SELECT count(*) FROM (SELECT * FROM admission_cpu2 EXCEPT ALL
+                      SELECT * FROM admission_gpu5) d;
+
+DROP TABLE strom_admission_test;
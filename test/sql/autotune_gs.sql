@@ -0,0 +1,95 @@
+--#
+--#       TestCases of the kernel launch autotuner; the block size is
+--#       tuned on the chunks with 64K rows or more
+--#
+
+set enable_seqscan to off;
+set enable_bitmapscan to off;
+set enable_indexscan to off;
+set random_page_cost=1000000;   --# force off index_scan.
+set pg_strom.gpu_setup_cost=0;
+set pg_strom.enable_gpupreagg to off;
+set pg_strom.enable_gpusort to off;
+set client_min_messages to warning;
+
+--# 4MB chunk contains about 100K rows of this table
+set pg_strom.chunk_size = '4MB';
+
+DROP TABLE IF EXISTS strom_autotune_outer;
+DROP TABLE IF EXISTS strom_autotune_inner;
+CREATE TABLE strom_autotune_outer (
+       id integer,
+       a  integer
+);
+CREATE TABLE strom_autotune_inner (
+       id integer,
+       k  integer
+);
+INSERT INTO strom_autotune_outer SELECT x, x % 100000
+  FROM generate_series(1,2000000) x;
+INSERT INTO strom_autotune_inner SELECT x, x * 1000
+  FROM generate_series(1,100) x;
+ANALYZE strom_autotune_outer;
+ANALYZE strom_autotune_inner;
+
+set pg_strom.enabled to off;
+CREATE TEMP TABLE autotune_cpu1 AS
+SELECT id, a FROM strom_autotune_outer WHERE a % 97 = 5;
+CREATE TEMP TABLE autotune_cpu2 AS
+SELECT o.id, i.id i_id FROM strom_autotune_outer o
+  JOIN strom_autotune_inner i ON o.a = i.k;
+reset pg_strom.enabled;
+
+--# the first run measures the candidates, then the later runs
+--# launch the kernels with the decided block size
+set pg_strom.enable_kernel_autotune to on;
+CREATE TEMP TABLE autotune_on1a AS
+SELECT id, a FROM strom_autotune_outer WHERE a % 97 = 5;
+CREATE TEMP TABLE autotune_on1b AS
+SELECT id, a FROM strom_autotune_outer WHERE a % 97 = 5;
+CREATE TEMP TABLE autotune_on2a AS
+SELECT o.id, i.id i_id FROM strom_autotune_outer o
+  JOIN strom_autotune_inner i ON o.a = i.k;
+CREATE TEMP TABLE autotune_on2b AS
+SELECT o.id, i.id i_id FROM strom_autotune_outer o
+  JOIN strom_autotune_inner i ON o.a = i.k;
+set pg_strom.enable_kernel_autotune to off;
+CREATE TEMP TABLE autotune_off1 AS
+SELECT id, a FROM strom_autotune_outer WHERE a % 97 = 5;
+CREATE TEMP TABLE autotune_off2 AS
+SELECT o.id, i.id i_id FROM strom_autotune_outer o
+  JOIN strom_autotune_inner i ON o.a = i.k;
+reset pg_strom.enable_kernel_autotune;
+
+--# GpuScan
+SELECT count(*) > 0 AS nonempty FROM autotune_on1a;
+SELECT count(*) FROM (SELECT * FROM autotune_on1a EXCEPT ALL
+                      SELECT * FROM autotune_cpu1) d;
+SELECT count(*) FROM (SELECT * FROM autotune_cpu1 EXCEPT ALL
+                      SELECT * FROM autotune_on1a) d;
+SELECT count(*) FROM (SELECT * FROM autotune_on1b EXCEPT ALL
+                      SELECT * FROM autotune_cpu1) d;
+SELECT count(*) FROM (SELECT * FROM autotune_cpu1 EXCEPT ALL
+                      SELECT * FROM autotune_on1b) d;
+SELECT count(*) FROM (SELECT * FROM autotune_off1 EXCEPT ALL
+                      SELECT * FROM autotune_cpu1) d;
+SELECT count(*) FROM (SELECT * FROM autotune_cpu1 EXCEPT ALL
+                      SELECT * FROM autotune_off1) d;
+
+--# GpuJoin
+SELECT count(*) > 0 AS nonempty FROM autotune_on2a;
+SELECT count(*) FROM (SELECT * FROM autotune_on2a EXCEPT ALL
+                      SELECT * FROM autotune_cpu2) d;
+SELECT count(*) FROM (SELECT * FROM autotune_cpu2 EXCEPT ALL
+                      SELECT * FROM autotune_on2a) d;
+SELECT count(*) FROM (SELECT * FROM autotune_on2b EXCEPT ALL
+                      SELECT * FROM autotune_cpu2) d;
+SELECT count(*) FROM (SELECT * FROM autotune_cpu2 EXCEPT ALL
+                      SELECT * FROM autotune_on2b) d;
+SELECT count(*) FROM (SELECT * FROM autotune_off2 EXCEPT ALL
+                      SELECT * FROM autotune_cpu2) d;
+SELECT count(*) FROM (SELECT * FROM autotune_cpu2 EXCEPT ALL
+                      SELECT * FROM autotune_off2) d;
+
+DROP TABLE strom_autotune_outer;
+DROP TABLE strom_autotune_inner;
@@ -0,0 +1,120 @@
+--#
+--#       GpuHashJoin TestCases with/without bloom filter on outer scan
+--#
+
+set pg_strom.gpu_setup_cost=0;
+set pg_strom.enable_gpunestloop to off;
+set pg_strom.enable_gpupreagg to off;
+set pg_strom.enable_gpusort to off;
+set enable_nestloop to off;
+set enable_mergejoin to off;
+set random_page_cost=1000000;   --# force off index_scan.
+set client_min_messages to warning;
+
+DROP TABLE IF EXISTS strom_bloom_outer;
+DROP TABLE IF EXISTS strom_bloom_inner;
+CREATE TABLE strom_bloom_outer (
+       id integer,
+       a  integer,
+       b  bigint,
+       t  text
+);
+CREATE TABLE strom_bloom_inner (
+       id integer,
+       k  integer,
+       k8 bigint,
+       t  text
+);
+INSERT INTO strom_bloom_outer SELECT
+       x,
+       case when x % 31 = 0 then null else (x * 7) % 50000 end,
+       (x * 13) % 50,
+       case when x % 37 = 0 then null else 'str_' || (x % 500)::text end
+  FROM generate_series(1,50000) x;
+--# only a few percent of the outer keys have inner pair
+INSERT INTO strom_bloom_inner SELECT
+       x,
+       case when x % 17 = 0 then null else (x * 11) % 50000 end,
+       x % 50,
+       case when x % 19 = 0 then null else 'str_' || (x * 3)::text end
+  FROM generate_series(1,1000) x;
+ANALYZE strom_bloom_outer;
+ANALYZE strom_bloom_inner;
+
+--# INNER JOIN with a selective inner
+CREATE TEMP TABLE bloom_on1 AS
+SELECT o.id o_id, i.id i_id FROM strom_bloom_outer o JOIN strom_bloom_inner i
+    ON o.a = i.k;
+set pg_strom.enable_gpujoin_bloom to off;
+CREATE TEMP TABLE bloom_off1 AS
+SELECT o.id o_id, i.id i_id FROM strom_bloom_outer o JOIN strom_bloom_inner i
+    ON o.a = i.k;
+reset pg_strom.enable_gpujoin_bloom;
+set pg_strom.enabled to off;
+CREATE TEMP TABLE bloom_cpu1 AS
+SELECT o.id o_id, i.id i_id FROM strom_bloom_outer o JOIN strom_bloom_inner i
+    ON o.a = i.k;
+reset pg_strom.enabled;
+
+SELECT count(*) > 0 AS nonempty FROM bloom_on1;
+SELECT count(*) FROM (SELECT * FROM bloom_on1 EXCEPT ALL
+                      SELECT * FROM bloom_cpu1) d;
+SELECT count(*) FROM (SELECT * FROM bloom_cpu1 EXCEPT ALL
+                      SELECT * FROM bloom_on1) d;
+SELECT count(*) FROM (SELECT * FROM bloom_off1 EXCEPT ALL
+                      SELECT * FROM bloom_cpu1) d;
+SELECT count(*) FROM (SELECT * FROM bloom_cpu1 EXCEPT ALL
+                      SELECT * FROM bloom_off1) d;
+
+--# multiple hash keys, including varlena
+CREATE TEMP TABLE bloom_on2 AS
+SELECT o.id o_id, i.id i_id FROM strom_bloom_outer o JOIN strom_bloom_inner i
+    ON o.b = i.k8 AND o.t = i.t;
+set pg_strom.enable_gpujoin_bloom to off;
+CREATE TEMP TABLE bloom_off2 AS
+SELECT o.id o_id, i.id i_id FROM strom_bloom_outer o JOIN strom_bloom_inner i
+    ON o.b = i.k8 AND o.t = i.t;
+reset pg_strom.enable_gpujoin_bloom;
+set pg_strom.enabled to off;
+CREATE TEMP TABLE bloom_cpu2 AS
+SELECT o.id o_id, i.id i_id FROM strom_bloom_outer o JOIN strom_bloom_inner i
+    ON o.b = i.k8 AND o.t = i.t;
+reset pg_strom.enabled;
+
+SELECT count(*) > 0 AS nonempty FROM bloom_on2;
+SELECT count(*) FROM (SELECT * FROM bloom_on2 EXCEPT ALL
+                      SELECT * FROM bloom_cpu2) d;
+SELECT count(*) FROM (SELECT * FROM bloom_cpu2 EXCEPT ALL
+                      SELECT * FROM bloom_on2) d;
+SELECT count(*) FROM (SELECT * FROM bloom_off2 EXCEPT ALL
+                      SELECT * FROM bloom_cpu2) d;
+SELECT count(*) FROM (SELECT * FROM bloom_cpu2 EXCEPT ALL
+                      SELECT * FROM bloom_off2) d;
+
+--# RIGHT JOIN; unmatched inner rows shall be kept
+CREATE TEMP TABLE bloom_on3 AS
+SELECT o.id o_id, i.id i_id FROM strom_bloom_outer o RIGHT JOIN strom_bloom_inner i
+    ON o.a = i.k;
+set pg_strom.enable_gpujoin_bloom to off;
+CREATE TEMP TABLE bloom_off3 AS
+SELECT o.id o_id, i.id i_id FROM strom_bloom_outer o RIGHT JOIN strom_bloom_inner i
+    ON o.a = i.k;
+reset pg_strom.enable_gpujoin_bloom;
+set pg_strom.enabled to off;
+CREATE TEMP TABLE bloom_cpu3 AS
+SELECT o.id o_id, i.id i_id FROM strom_bloom_outer o RIGHT JOIN strom_bloom_inner i
+    ON o.a = i.k;
+reset pg_strom.enabled;
+
+SELECT count(*) > 0 AS nonempty FROM bloom_on3 WHERE o_id IS NULL;
+SELECT count(*) FROM (SELECT * FROM bloom_on3 EXCEPT ALL
+                      SELECT * FROM bloom_cpu3) d;
+SELECT count(*) FROM (SELECT * FROM bloom_cpu3 EXCEPT ALL
+                      SELECT * FROM bloom_on3) d;
+SELECT count(*) FROM (SELECT * FROM bloom_off3 EXCEPT ALL
+                      SELECT * FROM bloom_cpu3) d;
+SELECT count(*) FROM (SELECT * FROM bloom_cpu3 EXCEPT ALL
+                      SELECT * FROM bloom_off3) d;
+
+DROP TABLE strom_bloom_outer;
+DROP TABLE strom_bloom_inner;
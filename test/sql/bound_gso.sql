@@ -0,0 +1,154 @@
+--#
+--#       GpuSort TestCases with bounded (top-K) sorting under LIMIT/OFFSET
+--#
+
+set pg_strom.debug_force_gpusort to on;
+set pg_strom.gpu_setup_cost=0;
+set random_page_cost=1000000;   --# force off index_scan.
+set pg_strom.enable_gpusort to on;
+set client_min_messages to warning;
+
+DROP TABLE IF EXISTS strom_bound;
+CREATE TABLE strom_bound (
+       id integer,
+       a  integer,
+       b  float,
+       t  text
+);
+INSERT INTO strom_bound SELECT
+       x,
+       case when x % 157 = 0 then null else (x * 37) % 5000 end,
+       ((x * 7919) % 20001 - 10000) / 7.0,
+       md5(x::text)
+  FROM generate_series(1,100000) x;
+ANALYZE strom_bound;
+
+--# LIMIT 1
+CREATE TEMP TABLE bound_gpu1 AS
+SELECT row_number() over () rn, s.* FROM
+    (SELECT a FROM strom_bound ORDER BY a LIMIT 1) s;
+set pg_strom.enabled to off;
+CREATE TEMP TABLE bound_cpu1 AS
+SELECT row_number() over () rn, s.* FROM
+    (SELECT a FROM strom_bound ORDER BY a LIMIT 1) s;
+reset pg_strom.enabled;
+
+SELECT count(*) FROM bound_gpu1;
+SELECT count(*) FROM (SELECT * FROM bound_gpu1 EXCEPT ALL
+                      SELECT * FROM bound_cpu1) d;
+SELECT count(*) FROM (SELECT * FROM bound_cpu1 EXCEPT ALL
+                      SELECT * FROM bound_gpu1) d;
+
+--# LIMIT with OFFSET, on the duplicated keys
+CREATE TEMP TABLE bound_gpu2 AS
+SELECT row_number() over () rn, s.* FROM
+    (SELECT a FROM strom_bound ORDER BY a LIMIT 100 OFFSET 50) s;
+set pg_strom.enabled to off;
+CREATE TEMP TABLE bound_cpu2 AS
+SELECT row_number() over () rn, s.* FROM
+    (SELECT a FROM strom_bound ORDER BY a LIMIT 100 OFFSET 50) s;
+reset pg_strom.enabled;
+
+SELECT count(*) FROM bound_gpu2;
+SELECT count(*) FROM (SELECT * FROM bound_gpu2 EXCEPT ALL
+                      SELECT * FROM bound_cpu2) d;
+SELECT count(*) FROM (SELECT * FROM bound_cpu2 EXCEPT ALL
+                      SELECT * FROM bound_gpu2) d;
+
+--# NULLs at the top
+CREATE TEMP TABLE bound_gpu3 AS
+SELECT row_number() over () rn, s.* FROM
+    (SELECT a FROM strom_bound ORDER BY a DESC NULLS FIRST LIMIT 300) s;
+set pg_strom.enabled to off;
+CREATE TEMP TABLE bound_cpu3 AS
+SELECT row_number() over () rn, s.* FROM
+    (SELECT a FROM strom_bound ORDER BY a DESC NULLS FIRST LIMIT 300) s;
+reset pg_strom.enabled;
+
+SELECT count(*) FROM bound_gpu3;
+SELECT count(*) FROM (SELECT * FROM bound_gpu3 EXCEPT ALL
+                      SELECT * FROM bound_cpu3) d;
+SELECT count(*) FROM (SELECT * FROM bound_cpu3 EXCEPT ALL
+                      SELECT * FROM bound_gpu3) d;
+
+--# OFFSET crosses the segments
+CREATE TEMP TABLE bound_gpu4 AS
+SELECT row_number() over () rn, s.* FROM
+    (SELECT a FROM strom_bound ORDER BY a NULLS FIRST LIMIT 10 OFFSET 60000) s;
+set pg_strom.enabled to off;
+CREATE TEMP TABLE bound_cpu4 AS
+SELECT row_number() over () rn, s.* FROM
+    (SELECT a FROM strom_bound ORDER BY a NULLS FIRST LIMIT 10 OFFSET 60000) s;
+reset pg_strom.enabled;
+
+SELECT count(*) FROM bound_gpu4;
+SELECT count(*) FROM (SELECT * FROM bound_gpu4 EXCEPT ALL
+                      SELECT * FROM bound_cpu4) d;
+SELECT count(*) FROM (SELECT * FROM bound_cpu4 EXCEPT ALL
+                      SELECT * FROM bound_gpu4) d;
+
+--# LIMIT larger than the relation
+CREATE TEMP TABLE bound_gpu5 AS
+SELECT row_number() over () rn, s.* FROM
+    (SELECT a FROM strom_bound ORDER BY a LIMIT 200000) s;
+set pg_strom.enabled to off;
+CREATE TEMP TABLE bound_cpu5 AS
+SELECT row_number() over () rn, s.* FROM
+    (SELECT a FROM strom_bound ORDER BY a LIMIT 200000) s;
+reset pg_strom.enabled;
+
+SELECT count(*) FROM bound_gpu5;
+SELECT count(*) FROM (SELECT * FROM bound_gpu5 EXCEPT ALL
+                      SELECT * FROM bound_cpu5) d;
+SELECT count(*) FROM (SELECT * FROM bound_cpu5 EXCEPT ALL
+                      SELECT * FROM bound_gpu5) d;
+
+--# OFFSET larger than the relation
+CREATE TEMP TABLE bound_gpu6 AS
+SELECT row_number() over () rn, s.* FROM
+    (SELECT a FROM strom_bound ORDER BY a LIMIT 10 OFFSET 200000) s;
+set pg_strom.enabled to off;
+CREATE TEMP TABLE bound_cpu6 AS
+SELECT row_number() over () rn, s.* FROM
+    (SELECT a FROM strom_bound ORDER BY a LIMIT 10 OFFSET 200000) s;
+reset pg_strom.enabled;
+
+SELECT count(*) FROM bound_gpu6;
+SELECT count(*) FROM (SELECT * FROM bound_gpu6 EXCEPT ALL
+                      SELECT * FROM bound_cpu6) d;
+SELECT count(*) FROM (SELECT * FROM bound_cpu6 EXCEPT ALL
+                      SELECT * FROM bound_gpu6) d;
+
+--# multiple keys; not radix sort
+CREATE TEMP TABLE bound_gpu7 AS
+SELECT row_number() over () rn, s.* FROM
+    (SELECT a, b FROM strom_bound ORDER BY b DESC, a LIMIT 500) s;
+set pg_strom.enabled to off;
+CREATE TEMP TABLE bound_cpu7 AS
+SELECT row_number() over () rn, s.* FROM
+    (SELECT a, b FROM strom_bound ORDER BY b DESC, a LIMIT 500) s;
+reset pg_strom.enabled;
+
+SELECT count(*) FROM bound_gpu7;
+SELECT count(*) FROM (SELECT * FROM bound_gpu7 EXCEPT ALL
+                      SELECT * FROM bound_cpu7) d;
+SELECT count(*) FROM (SELECT * FROM bound_cpu7 EXCEPT ALL
+                      SELECT * FROM bound_gpu7) d;
+
+--# varlena key
+CREATE TEMP TABLE bound_gpu8 AS
+SELECT row_number() over () rn, s.* FROM
+    (SELECT t FROM strom_bound ORDER BY t LIMIT 250 OFFSET 10) s;
+set pg_strom.enabled to off;
+CREATE TEMP TABLE bound_cpu8 AS
+SELECT row_number() over () rn, s.* FROM
+    (SELECT t FROM strom_bound ORDER BY t LIMIT 250 OFFSET 10) s;
+reset pg_strom.enabled;
+
+SELECT count(*) FROM bound_gpu8;
+SELECT count(*) FROM (SELECT * FROM bound_gpu8 EXCEPT ALL
+                      SELECT * FROM bound_cpu8) d;
+SELECT count(*) FROM (SELECT * FROM bound_cpu8 EXCEPT ALL
+                      SELECT * FROM bound_gpu8) d;
+
+DROP TABLE strom_bound;
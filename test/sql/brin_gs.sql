@@ -0,0 +1,199 @@
+--#
+--#       GpuScan TestCases with/without block skipping by BRIN index
+--#
+
+set enable_seqscan to off;
+set enable_bitmapscan to off;
+set enable_indexscan to off;
+set random_page_cost=1000000;   --# force off index_scan.
+set pg_strom.enable_gpuhashjoin to off;
+set pg_strom.enable_gpupreagg to off;
+set pg_strom.enable_gpusort to off;
+set client_min_messages to warning;
+
+DROP TABLE IF EXISTS strom_brin_test;
+CREATE TABLE strom_brin_test (
+       id integer,
+       d  integer,
+       b  float,
+       ts timestamp,
+       t  text
+);
+INSERT INTO strom_brin_test SELECT
+       x,
+       case when x % 101 = 0 then null else (x / 97) % 1000 end,
+       case when x % 53 = 0 then null else x / 7.0 end,
+       timestamp '2016-01-01 00:00:00' + x * interval '1 min',
+       md5(x::text)
+  FROM generate_series(1,100000) x;
+CREATE INDEX strom_brin_test_id ON strom_brin_test
+       USING brin (id, ts) WITH (pages_per_range = 4);
+CREATE INDEX strom_brin_test_d ON strom_brin_test
+       USING brin (d) WITH (pages_per_range = 8);
+--# rows appended after the index build, not summarized yet
+INSERT INTO strom_brin_test SELECT
+       x,
+       x % 1000,
+       x / 7.0,
+       timestamp '2016-01-01 00:00:00' + x * interval '1 min',
+       md5(x::text)
+  FROM generate_series(100001,110000) x;
+--# rows moved by UPDATE, to the blocks out of the original range
+UPDATE strom_brin_test SET id = id + 100000 WHERE id % 1000 = 7;
+ANALYZE strom_brin_test;
+
+--# range on the correlated column
+CREATE TEMP TABLE brin_on1 AS
+SELECT id, d, b, ts, t FROM strom_brin_test WHERE id BETWEEN 30001 AND 32000;
+set pg_strom.enable_brin_skip to off;
+CREATE TEMP TABLE brin_off1 AS
+SELECT id, d, b, ts, t FROM strom_brin_test WHERE id BETWEEN 30001 AND 32000;
+reset pg_strom.enable_brin_skip;
+set pg_strom.enabled to off;
+CREATE TEMP TABLE brin_cpu1 AS
+SELECT id, d, b, ts, t FROM strom_brin_test WHERE id BETWEEN 30001 AND 32000;
+reset pg_strom.enabled;
+
+SELECT count(*) > 0 AS nonempty FROM brin_on1;
+SELECT count(*) FROM (SELECT * FROM brin_on1 EXCEPT ALL
+                      SELECT * FROM brin_cpu1) d;
+SELECT count(*) FROM (SELECT * FROM brin_cpu1 EXCEPT ALL
+                      SELECT * FROM brin_on1) d;
+SELECT count(*) FROM (SELECT * FROM brin_off1 EXCEPT ALL
+                      SELECT * FROM brin_cpu1) d;
+SELECT count(*) FROM (SELECT * FROM brin_cpu1 EXCEPT ALL
+                      SELECT * FROM brin_off1) d;
+
+--# commuted form, on multiple columns
+CREATE TEMP TABLE brin_on2 AS
+SELECT id, d, b, ts, t FROM strom_brin_test WHERE 80000 < id AND d < 500;
+set pg_strom.enable_brin_skip to off;
+CREATE TEMP TABLE brin_off2 AS
+SELECT id, d, b, ts, t FROM strom_brin_test WHERE 80000 < id AND d < 500;
+reset pg_strom.enable_brin_skip;
+set pg_strom.enabled to off;
+CREATE TEMP TABLE brin_cpu2 AS
+SELECT id, d, b, ts, t FROM strom_brin_test WHERE 80000 < id AND d < 500;
+reset pg_strom.enabled;
+
+SELECT count(*) > 0 AS nonempty FROM brin_on2;
+SELECT count(*) FROM (SELECT * FROM brin_on2 EXCEPT ALL
+                      SELECT * FROM brin_cpu2) d;
+SELECT count(*) FROM (SELECT * FROM brin_cpu2 EXCEPT ALL
+                      SELECT * FROM brin_on2) d;
+SELECT count(*) FROM (SELECT * FROM brin_off2 EXCEPT ALL
+                      SELECT * FROM brin_cpu2) d;
+SELECT count(*) FROM (SELECT * FROM brin_cpu2 EXCEPT ALL
+                      SELECT * FROM brin_off2) d;
+
+--# timestamp column
+CREATE TEMP TABLE brin_on3 AS
+SELECT id, d, b, ts, t FROM strom_brin_test WHERE ts >= '2016-03-01' AND ts < '2016-03-02';
+set pg_strom.enable_brin_skip to off;
+CREATE TEMP TABLE brin_off3 AS
+SELECT id, d, b, ts, t FROM strom_brin_test WHERE ts >= '2016-03-01' AND ts < '2016-03-02';
+reset pg_strom.enable_brin_skip;
+set pg_strom.enabled to off;
+CREATE TEMP TABLE brin_cpu3 AS
+SELECT id, d, b, ts, t FROM strom_brin_test WHERE ts >= '2016-03-01' AND ts < '2016-03-02';
+reset pg_strom.enabled;
+
+SELECT count(*) > 0 AS nonempty FROM brin_on3;
+SELECT count(*) FROM (SELECT * FROM brin_on3 EXCEPT ALL
+                      SELECT * FROM brin_cpu3) d;
+SELECT count(*) FROM (SELECT * FROM brin_cpu3 EXCEPT ALL
+                      SELECT * FROM brin_on3) d;
+SELECT count(*) FROM (SELECT * FROM brin_off3 EXCEPT ALL
+                      SELECT * FROM brin_cpu3) d;
+SELECT count(*) FROM (SELECT * FROM brin_cpu3 EXCEPT ALL
+                      SELECT * FROM brin_off3) d;
+
+--# unsummarized block ranges shall not be skipped
+CREATE TEMP TABLE brin_on4 AS
+SELECT id, d, b, ts, t FROM strom_brin_test WHERE id > 105000;
+set pg_strom.enable_brin_skip to off;
+CREATE TEMP TABLE brin_off4 AS
+SELECT id, d, b, ts, t FROM strom_brin_test WHERE id > 105000;
+reset pg_strom.enable_brin_skip;
+set pg_strom.enabled to off;
+CREATE TEMP TABLE brin_cpu4 AS
+SELECT id, d, b, ts, t FROM strom_brin_test WHERE id > 105000;
+reset pg_strom.enabled;
+
+SELECT count(*) > 0 AS nonempty FROM brin_on4;
+SELECT count(*) FROM (SELECT * FROM brin_on4 EXCEPT ALL
+                      SELECT * FROM brin_cpu4) d;
+SELECT count(*) FROM (SELECT * FROM brin_cpu4 EXCEPT ALL
+                      SELECT * FROM brin_on4) d;
+SELECT count(*) FROM (SELECT * FROM brin_off4 EXCEPT ALL
+                      SELECT * FROM brin_cpu4) d;
+SELECT count(*) FROM (SELECT * FROM brin_cpu4 EXCEPT ALL
+                      SELECT * FROM brin_off4) d;
+
+--# OR-clause is not used for skipping
+CREATE TEMP TABLE brin_on5 AS
+SELECT id, d, b, ts, t FROM strom_brin_test WHERE id < 3000 OR id > 99000;
+set pg_strom.enable_brin_skip to off;
+CREATE TEMP TABLE brin_off5 AS
+SELECT id, d, b, ts, t FROM strom_brin_test WHERE id < 3000 OR id > 99000;
+reset pg_strom.enable_brin_skip;
+set pg_strom.enabled to off;
+CREATE TEMP TABLE brin_cpu5 AS
+SELECT id, d, b, ts, t FROM strom_brin_test WHERE id < 3000 OR id > 99000;
+reset pg_strom.enabled;
+
+SELECT count(*) > 0 AS nonempty FROM brin_on5;
+SELECT count(*) FROM (SELECT * FROM brin_on5 EXCEPT ALL
+                      SELECT * FROM brin_cpu5) d;
+SELECT count(*) FROM (SELECT * FROM brin_cpu5 EXCEPT ALL
+                      SELECT * FROM brin_on5) d;
+SELECT count(*) FROM (SELECT * FROM brin_off5 EXCEPT ALL
+                      SELECT * FROM brin_cpu5) d;
+SELECT count(*) FROM (SELECT * FROM brin_cpu5 EXCEPT ALL
+                      SELECT * FROM brin_off5) d;
+
+--# no rows match the other qualifier
+CREATE TEMP TABLE brin_on6 AS
+SELECT id, d, b, ts, t FROM strom_brin_test WHERE id = 50001 AND b IS NULL;
+set pg_strom.enable_brin_skip to off;
+CREATE TEMP TABLE brin_off6 AS
+SELECT id, d, b, ts, t FROM strom_brin_test WHERE id = 50001 AND b IS NULL;
+reset pg_strom.enable_brin_skip;
+set pg_strom.enabled to off;
+CREATE TEMP TABLE brin_cpu6 AS
+SELECT id, d, b, ts, t FROM strom_brin_test WHERE id = 50001 AND b IS NULL;
+reset pg_strom.enabled;
+
+SELECT count(*) = 0 AS empty FROM brin_on6;
+SELECT count(*) FROM (SELECT * FROM brin_on6 EXCEPT ALL
+                      SELECT * FROM brin_cpu6) d;
+SELECT count(*) FROM (SELECT * FROM brin_cpu6 EXCEPT ALL
+                      SELECT * FROM brin_on6) d;
+SELECT count(*) FROM (SELECT * FROM brin_off6 EXCEPT ALL
+                      SELECT * FROM brin_cpu6) d;
+SELECT count(*) FROM (SELECT * FROM brin_cpu6 EXCEPT ALL
+                      SELECT * FROM brin_off6) d;
+
+--# pseudo-constant supplied by the parameter
+PREPARE brin_q(int, int) AS
+SELECT id, d, b, ts, t FROM strom_brin_test WHERE id >= $1 AND id < $2;
+CREATE TEMP TABLE brin_on7 AS EXECUTE brin_q(60000, 61000);
+CREATE TEMP TABLE brin_on8 AS EXECUTE brin_q(100500, 101500);
+set pg_strom.enabled to off;
+CREATE TEMP TABLE brin_cpu7 AS EXECUTE brin_q(60000, 61000);
+CREATE TEMP TABLE brin_cpu8 AS EXECUTE brin_q(100500, 101500);
+reset pg_strom.enabled;
+DEALLOCATE brin_q;
+
+SELECT count(*) > 0 AS nonempty FROM brin_on7;
+SELECT count(*) FROM (SELECT * FROM brin_on7 EXCEPT ALL
+                      SELECT * FROM brin_cpu7) d;
+SELECT count(*) FROM (SELECT * FROM brin_cpu7 EXCEPT ALL
+                      SELECT * FROM brin_on7) d;
+SELECT count(*) > 0 AS nonempty FROM brin_on8;
+SELECT count(*) FROM (SELECT * FROM brin_on8 EXCEPT ALL
+                      SELECT * FROM brin_cpu8) d;
+SELECT count(*) FROM (SELECT * FROM brin_cpu8 EXCEPT ALL
+                      SELECT * FROM brin_on8) d;
+
+DROP TABLE strom_brin_test;
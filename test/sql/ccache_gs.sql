@@ -0,0 +1,136 @@
+--#
+--#       GpuScan TestCases with the columnar cache
+--#
+
+set enable_seqscan to off;
+set enable_bitmapscan to off;
+set enable_indexscan to off;
+set random_page_cost=1000000;   --# force off index_scan.
+set pg_strom.enable_gpuhashjoin to off;
+set pg_strom.enable_gpupreagg to off;
+set pg_strom.enable_gpusort to off;
+set client_min_messages to warning;
+
+DROP TABLE IF EXISTS strom_ccache_test;
+CREATE TABLE strom_ccache_test (
+       id integer,
+       a  integer,
+       b  float,
+       c  text
+);
+INSERT INTO strom_ccache_test SELECT
+       x, x % 1000, x / 7.0, md5(x::text)
+  FROM generate_series(1,100000) x;
+VACUUM strom_ccache_test;
+
+set pg_strom.enable_column_format to on;
+set pg_strom.enable_ccache to on;
+
+--# the first scan puts chunks on the cache, then the next one hits
+CREATE TEMP TABLE ccache_gs_gpu0 AS
+SELECT id, a, b, c FROM strom_ccache_test WHERE a < 500;
+SELECT count(*) > 0 AS cached FROM pgstrom_ccache_info()
+ WHERE table_oid = 'strom_ccache_test'::regclass;
+CREATE TEMP TABLE ccache_gs_gpu1 AS
+SELECT id, a, b, c FROM strom_ccache_test WHERE a < 500;
+set pg_strom.enabled to off;
+CREATE TEMP TABLE ccache_gs_cpu1 AS
+SELECT id, a, b, c FROM strom_ccache_test WHERE a < 500;
+reset pg_strom.enabled;
+
+SELECT count(*) FROM (SELECT * FROM ccache_gs_gpu0 EXCEPT ALL
+                      SELECT * FROM ccache_gs_cpu1) d;
+SELECT count(*) FROM (SELECT * FROM ccache_gs_gpu1 EXCEPT ALL
+                      SELECT * FROM ccache_gs_cpu1) d;
+SELECT count(*) FROM (SELECT * FROM ccache_gs_cpu1 EXCEPT ALL
+                      SELECT * FROM ccache_gs_gpu1) d;
+
+--# UPDATE/DELETE/INSERT without triggers
+UPDATE strom_ccache_test SET b = -b WHERE id % 100 = 0;
+DELETE FROM strom_ccache_test WHERE id % 1000 = 1;
+INSERT INTO strom_ccache_test VALUES (100001, 1, 1.0, 'new');
+CREATE TEMP TABLE ccache_gs_gpu2 AS
+SELECT id, a, b, c FROM strom_ccache_test WHERE a < 500;
+set pg_strom.enabled to off;
+CREATE TEMP TABLE ccache_gs_cpu2 AS
+SELECT id, a, b, c FROM strom_ccache_test WHERE a < 500;
+reset pg_strom.enabled;
+
+SELECT count(*) FROM (SELECT * FROM ccache_gs_gpu2 EXCEPT ALL
+                      SELECT * FROM ccache_gs_cpu2) d;
+SELECT count(*) FROM (SELECT * FROM ccache_gs_cpu2 EXCEPT ALL
+                      SELECT * FROM ccache_gs_gpu2) d;
+
+--# VACUUM makes the modified blocks all-visible again
+VACUUM strom_ccache_test;
+CREATE TEMP TABLE ccache_gs_gpu3 AS
+SELECT id, a, b, c FROM strom_ccache_test WHERE a < 500;
+CREATE TEMP TABLE ccache_gs_gpu4 AS
+SELECT id, a, b, c FROM strom_ccache_test WHERE a < 500;
+set pg_strom.enabled to off;
+CREATE TEMP TABLE ccache_gs_cpu4 AS
+SELECT id, a, b, c FROM strom_ccache_test WHERE a < 500;
+reset pg_strom.enabled;
+
+SELECT count(*) FROM (SELECT * FROM ccache_gs_gpu3 EXCEPT ALL
+                      SELECT * FROM ccache_gs_cpu4) d;
+SELECT count(*) FROM (SELECT * FROM ccache_gs_cpu4 EXCEPT ALL
+                      SELECT * FROM ccache_gs_gpu3) d;
+SELECT count(*) FROM (SELECT * FROM ccache_gs_gpu4 EXCEPT ALL
+                      SELECT * FROM ccache_gs_cpu4) d;
+SELECT count(*) FROM (SELECT * FROM ccache_gs_cpu4 EXCEPT ALL
+                      SELECT * FROM ccache_gs_gpu4) d;
+
+--# ALTER TABLE drops the cached chunks
+ALTER TABLE strom_ccache_test ADD COLUMN e integer;
+ALTER TABLE strom_ccache_test DROP COLUMN c;
+SELECT count(*) AS cached FROM pgstrom_ccache_info()
+ WHERE table_oid = 'strom_ccache_test'::regclass;
+CREATE TEMP TABLE ccache_gs_gpu5 AS
+SELECT id, a, b, e FROM strom_ccache_test WHERE a < 500;
+CREATE TEMP TABLE ccache_gs_gpu6 AS
+SELECT id, a, b, e FROM strom_ccache_test WHERE a < 500;
+set pg_strom.enabled to off;
+CREATE TEMP TABLE ccache_gs_cpu6 AS
+SELECT id, a, b, e FROM strom_ccache_test WHERE a < 500;
+reset pg_strom.enabled;
+
+SELECT count(*) FROM (SELECT * FROM ccache_gs_gpu5 EXCEPT ALL
+                      SELECT * FROM ccache_gs_cpu6) d;
+SELECT count(*) FROM (SELECT * FROM ccache_gs_cpu6 EXCEPT ALL
+                      SELECT * FROM ccache_gs_gpu5) d;
+SELECT count(*) FROM (SELECT * FROM ccache_gs_gpu6 EXCEPT ALL
+                      SELECT * FROM ccache_gs_cpu6) d;
+SELECT count(*) FROM (SELECT * FROM ccache_gs_cpu6 EXCEPT ALL
+                      SELECT * FROM ccache_gs_gpu6) d;
+
+--# TRUNCATE drops the cached chunks
+TRUNCATE strom_ccache_test;
+SELECT count(*) AS cached FROM pgstrom_ccache_info()
+ WHERE table_oid = 'strom_ccache_test'::regclass;
+INSERT INTO strom_ccache_test SELECT
+       x, x % 777, x / 3.0, x % 13
+  FROM generate_series(1,50000) x;
+VACUUM strom_ccache_test;
+CREATE TEMP TABLE ccache_gs_gpu7 AS
+SELECT id, a, b, e FROM strom_ccache_test WHERE a < 500;
+CREATE TEMP TABLE ccache_gs_gpu8 AS
+SELECT id, a, b, e FROM strom_ccache_test WHERE a < 500;
+set pg_strom.enabled to off;
+CREATE TEMP TABLE ccache_gs_cpu8 AS
+SELECT id, a, b, e FROM strom_ccache_test WHERE a < 500;
+reset pg_strom.enabled;
+
+SELECT count(*) > 0 AS nonempty FROM ccache_gs_gpu8;
+SELECT count(*) FROM (SELECT * FROM ccache_gs_gpu7 EXCEPT ALL
+                      SELECT * FROM ccache_gs_cpu8) d;
+SELECT count(*) FROM (SELECT * FROM ccache_gs_cpu8 EXCEPT ALL
+                      SELECT * FROM ccache_gs_gpu7) d;
+SELECT count(*) FROM (SELECT * FROM ccache_gs_gpu8 EXCEPT ALL
+                      SELECT * FROM ccache_gs_cpu8) d;
+SELECT count(*) FROM (SELECT * FROM ccache_gs_cpu8 EXCEPT ALL
+                      SELECT * FROM ccache_gs_gpu8) d;
+
+reset pg_strom.enable_ccache;
+reset pg_strom.enable_column_format;
+DROP TABLE strom_ccache_test;
@@ -0,0 +1,70 @@
+--#
+--#       GpuScan TestCases on the column format data store
+--#
+
+set enable_seqscan to off;
+set enable_bitmapscan to off;
+set enable_indexscan to off;
+set random_page_cost=1000000;   --# force off index_scan.
+set pg_strom.enable_gpuhashjoin to off;
+set pg_strom.enable_gpupreagg to off;
+set pg_strom.enable_gpusort to off;
+set client_min_messages to warning;
+
+--# timetz is 12 bytes but 'd' aligned; values on odd rows need padding.
+DROP TABLE IF EXISTS strom_column_test;
+CREATE TABLE strom_column_test (
+       id integer,
+       a  smallint,
+       b  time with time zone,
+       c  bigint,
+       d  text,
+       e  float,
+       f  time with time zone,
+       pad text
+);
+INSERT INTO strom_column_test SELECT
+       x,
+       case when x % 7 = 0 then null else x % 1000 end,
+       case when x % 11 = 0 then null
+            else '00:00:00+09'::timetz + (x % 86400) * '1 sec'::interval end,
+       x * 1000003,
+       case when x % 13 = 0 then null else md5(x::text) end,
+       x / 7.0,
+       '12:00:00-05'::timetz + (x % 3600) * '1 sec'::interval,
+       repeat('x', x % 50)
+  FROM generate_series(1,100000) x;
+ANALYZE strom_column_test;
+
+set pg_strom.enable_column_format to on;
+CREATE TEMP TABLE column_gs_gpu AS
+SELECT id, a, b, c, d, f FROM strom_column_test
+ WHERE a > 100 OR b > '12:00:00+09'::timetz;
+set pg_strom.enabled to off;
+CREATE TEMP TABLE column_gs_cpu AS
+SELECT id, a, b, c, d, f FROM strom_column_test
+ WHERE a > 100 OR b > '12:00:00+09'::timetz;
+reset pg_strom.enabled;
+
+SELECT count(*) > 0 AS nonempty FROM column_gs_gpu;
+SELECT count(*) FROM (SELECT * FROM column_gs_gpu EXCEPT ALL
+                      SELECT * FROM column_gs_cpu) d;
+SELECT count(*) FROM (SELECT * FROM column_gs_cpu EXCEPT ALL
+                      SELECT * FROM column_gs_gpu) d;
+
+--# NULL values and fixed-length columns only
+CREATE TEMP TABLE column_gs_gpu2 AS
+SELECT id, b, f FROM strom_column_test WHERE b IS NULL OR f < b;
+set pg_strom.enabled to off;
+CREATE TEMP TABLE column_gs_cpu2 AS
+SELECT id, b, f FROM strom_column_test WHERE b IS NULL OR f < b;
+reset pg_strom.enabled;
+
+SELECT count(*) > 0 AS nonempty FROM column_gs_gpu2;
+SELECT count(*) FROM (SELECT * FROM column_gs_gpu2 EXCEPT ALL
+                      SELECT * FROM column_gs_cpu2) d;
+SELECT count(*) FROM (SELECT * FROM column_gs_cpu2 EXCEPT ALL
+                      SELECT * FROM column_gs_gpu2) d;
+
+reset pg_strom.enable_column_format;
+DROP TABLE strom_column_test;
@@ -0,0 +1,79 @@
+--#
+--#       GpuScan TestCases with DMA compression of the chunks
+--#
+
+set enable_seqscan to off;
+set enable_bitmapscan to off;
+set enable_indexscan to off;
+set random_page_cost=1000000;   --# force off index_scan.
+set pg_strom.enable_gpuhashjoin to off;
+set pg_strom.enable_gpupreagg to off;
+set pg_strom.enable_gpusort to off;
+set client_min_messages to warning;
+
+--# chunks are larger than 1MB, and well compressible
+DROP TABLE IF EXISTS strom_compress_test;
+CREATE TABLE strom_compress_test (
+       id integer,
+       a  integer,
+       b  float,
+       c  text,
+       d  text
+);
+INSERT INTO strom_compress_test SELECT
+       x,
+       case when x % 7 = 0 then null else x % 100 end,
+       (x % 1000) / 3.0,
+       repeat(chr(65 + x % 26), 40 + x % 30),
+       case when x % 5 = 0 then null else md5(x::text) end
+  FROM generate_series(1,200000) x;
+ANALYZE strom_compress_test;
+
+set pg_strom.enable_dma_compress to on;
+CREATE TEMP TABLE compress_gs_on AS
+SELECT id, a, b, c, d FROM strom_compress_test
+ WHERE a < 50 OR b > 300.0;
+set pg_strom.enable_dma_compress to off;
+CREATE TEMP TABLE compress_gs_off AS
+SELECT id, a, b, c, d FROM strom_compress_test
+ WHERE a < 50 OR b > 300.0;
+set pg_strom.enabled to off;
+CREATE TEMP TABLE compress_gs_cpu AS
+SELECT id, a, b, c, d FROM strom_compress_test
+ WHERE a < 50 OR b > 300.0;
+reset pg_strom.enabled;
+
+SELECT count(*) > 0 AS nonempty FROM compress_gs_on;
+SELECT count(*) FROM (SELECT * FROM compress_gs_on EXCEPT ALL
+                      SELECT * FROM compress_gs_off) d;
+SELECT count(*) FROM (SELECT * FROM compress_gs_off EXCEPT ALL
+                      SELECT * FROM compress_gs_on) d;
+SELECT count(*) FROM (SELECT * FROM compress_gs_on EXCEPT ALL
+                      SELECT * FROM compress_gs_cpu) d;
+SELECT count(*) FROM (SELECT * FROM compress_gs_cpu EXCEPT ALL
+                      SELECT * FROM compress_gs_on) d;
+
+--# GpuPreAgg also sends the compressed chunks
+set pg_strom.enable_gpupreagg to on;
+set pg_strom.enable_dma_compress to on;
+CREATE TEMP TABLE compress_gpa_on AS
+SELECT a, count(*) cnt, sum(b) sum_b, max(c) max_c
+  FROM strom_compress_test GROUP BY a;
+set pg_strom.enable_dma_compress to off;
+CREATE TEMP TABLE compress_gpa_off AS
+SELECT a, count(*) cnt, sum(b) sum_b, max(c) max_c
+  FROM strom_compress_test GROUP BY a;
+reset pg_strom.enable_gpupreagg;
+
+SELECT count(*) > 0 AS nonempty FROM compress_gpa_on;
+SELECT count(*) FROM (SELECT a, cnt, round(sum_b::numeric, 3), max_c
+                        FROM compress_gpa_on EXCEPT ALL
+                      SELECT a, cnt, round(sum_b::numeric, 3), max_c
+                        FROM compress_gpa_off) d;
+SELECT count(*) FROM (SELECT a, cnt, round(sum_b::numeric, 3), max_c
+                        FROM compress_gpa_off EXCEPT ALL
+                      SELECT a, cnt, round(sum_b::numeric, 3), max_c
+                        FROM compress_gpa_on) d;
+
+reset pg_strom.enable_dma_compress;
+DROP TABLE strom_compress_test;
@@ -0,0 +1,95 @@
+--#
+--#       GpuScan TestCases of the direct load bypassing shared buffers
+--#
+
+set enable_seqscan to off;
+set enable_bitmapscan to off;
+set enable_indexscan to off;
+set random_page_cost=1000000;   --# force off index_scan.
+set pg_strom.enable_gpuhashjoin to off;
+set pg_strom.enable_gpupreagg to off;
+set pg_strom.enable_gpusort to off;
+set client_min_messages to warning;
+
+CREATE EXTENSION IF NOT EXISTS dblink;
+
+--# VACUUM FULL writes the blocks bypassing shared buffers, then VACUUM
+--# sets all-visible on them using a small ring buffer; so most of the
+--# blocks are all-visible and not cached by shared buffers.
+DROP TABLE IF EXISTS strom_direct_test;
+CREATE TABLE strom_direct_test (
+       id integer,
+       a  integer,
+       b  float,
+       pad text
+);
+INSERT INTO strom_direct_test SELECT
+       x, x % 1000, x / 7.0, md5(x::text)
+  FROM generate_series(1,200000) x;
+VACUUM FULL strom_direct_test;
+VACUUM strom_direct_test;
+
+set pg_strom.enable_direct_load to on;
+set pg_strom.debug_force_direct_load to on;
+
+SELECT dblink_connect('direct_conn', 'dbname=' || current_database() ||
+                      ' port=' || current_setting('port')) = 'OK' AS connected;
+
+--# concurrent UPDATE/VACUUM must be invisible to the snapshot of the scan
+BEGIN ISOLATION LEVEL REPEATABLE READ;
+set local pg_strom.enabled to off;
+CREATE TEMP TABLE direct_gs_base AS
+SELECT a, count(*) cnt, sum(id) sum_id, max(pad) max_pad
+  FROM strom_direct_test WHERE id % 3 <> 0 GROUP BY a;
+reset pg_strom.enabled;
+
+SELECT dblink_send_query('direct_conn',
+       'UPDATE strom_direct_test SET a = a + 1, pad = ''updated''
+         WHERE id <= 100000') AS sent;
+CREATE TEMP TABLE direct_gs_gpu1 AS
+SELECT a, count(*) cnt, sum(id) sum_id, max(pad) max_pad
+  FROM strom_direct_test WHERE id % 3 <> 0 GROUP BY a;
+SELECT status = 'UPDATE 100000' AS updated
+  FROM dblink_get_result('direct_conn') AS t(status text);
+SELECT count(*) FROM dblink_get_result('direct_conn') AS t(status text);
+
+SELECT dblink_send_query('direct_conn',
+       'VACUUM strom_direct_test') AS sent;
+CREATE TEMP TABLE direct_gs_gpu2 AS
+SELECT a, count(*) cnt, sum(id) sum_id, max(pad) max_pad
+  FROM strom_direct_test WHERE id % 3 <> 0 GROUP BY a;
+SELECT status = 'VACUUM' AS vacuumed
+  FROM dblink_get_result('direct_conn') AS t(status text);
+SELECT count(*) FROM dblink_get_result('direct_conn') AS t(status text);
+
+SELECT count(*) FROM (SELECT * FROM direct_gs_gpu1 EXCEPT ALL
+                      SELECT * FROM direct_gs_base) d;
+SELECT count(*) FROM (SELECT * FROM direct_gs_base EXCEPT ALL
+                      SELECT * FROM direct_gs_gpu1) d;
+SELECT count(*) FROM (SELECT * FROM direct_gs_gpu2 EXCEPT ALL
+                      SELECT * FROM direct_gs_base) d;
+SELECT count(*) FROM (SELECT * FROM direct_gs_base EXCEPT ALL
+                      SELECT * FROM direct_gs_gpu2) d;
+COMMIT;
+
+--# the committed UPDATE must be visible to the next scan
+VACUUM strom_direct_test;
+CREATE TEMP TABLE direct_gs_gpu3 AS
+SELECT a, count(*) cnt, sum(id) sum_id, max(pad) max_pad
+  FROM strom_direct_test WHERE id % 3 <> 0 GROUP BY a;
+set pg_strom.enabled to off;
+CREATE TEMP TABLE direct_gs_cpu3 AS
+SELECT a, count(*) cnt, sum(id) sum_id, max(pad) max_pad
+  FROM strom_direct_test WHERE id % 3 <> 0 GROUP BY a;
+reset pg_strom.enabled;
+
+SELECT count(*) > 0 AS nonempty FROM direct_gs_gpu3 WHERE max_pad = 'updated';
+SELECT count(*) FROM (SELECT * FROM direct_gs_gpu3 EXCEPT ALL
+                      SELECT * FROM direct_gs_cpu3) d;
+SELECT count(*) FROM (SELECT * FROM direct_gs_cpu3 EXCEPT ALL
+                      SELECT * FROM direct_gs_gpu3) d;
+
+SELECT dblink_disconnect('direct_conn') = 'OK' AS disconnected;
+reset pg_strom.debug_force_direct_load;
+reset pg_strom.enable_direct_load;
+DROP TABLE strom_direct_test;
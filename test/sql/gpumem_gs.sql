@@ -0,0 +1,96 @@
+--#
+--#       Device memory allocator TestCases (run alone; it checks the
+--#       statistics of the device memory allocator)
+--#
+
+set pg_strom.gpu_setup_cost=0;
+set random_page_cost=1000000;   --# force off index_scan.
+set enable_seqscan to off;
+set pg_strom.enable_gpupreagg to off;
+set pg_strom.enable_gpusort to off;
+set client_min_messages to warning;
+
+--# a device memory block is 8 times of the chunk size; 32MB
+set pg_strom.chunk_size = '4MB';
+
+CREATE TEMP VIEW gpumem_stat AS
+SELECT item, sum(count) count, sum(bytes) bytes
+  FROM pgstrom_perfmon_info()
+ WHERE node IS NULL AND device >= 0
+ GROUP BY item;
+
+--# no blocks are retained
+set pg_strom.gpumem_retain_size = 0;
+CREATE TEMP TABLE gpumem_gpu0 AS
+SELECT id, integer_x, float_x FROM strom_test WHERE integer_x % 3 = 0;
+SELECT bytes = 0 AS released FROM gpumem_stat WHERE item = 'retained memory';
+
+--# the block must be merged to one free chunk at the end of query,
+--# then it is retained up to the retain size
+set pg_strom.gpumem_retain_size = '32MB';
+CREATE TEMP TABLE gpumem_gpu1 AS
+SELECT id, integer_x, float_x FROM strom_test WHERE integer_x % 3 = 0;
+SELECT bytes > 0 AND bytes <= 32 * 1048576 * (SELECT count(DISTINCT device)
+                                                FROM pgstrom_perfmon_info()
+                                               WHERE node IS NULL)
+       AS retained
+  FROM gpumem_stat WHERE item = 'retained memory';
+CREATE TEMP TABLE gpumem_stat1 AS SELECT * FROM gpumem_stat;
+
+--# the next query reuses the retained block, without cuMemAlloc
+CREATE TEMP TABLE gpumem_gpu2 AS
+SELECT id, integer_x, float_x FROM strom_test WHERE integer_x % 3 = 0;
+SELECT s.count - s1.count AS num_malloc
+  FROM gpumem_stat s, gpumem_stat1 s1
+ WHERE s.item = s1.item AND s.item = 'cuMemAlloc';
+
+--# GpuJoin allocates chunks of various size classes on the blocks
+CREATE TEMP TABLE gpumem_gpu3 AS
+SELECT a.id, a.integer_x, b.float_x
+  FROM strom_test a JOIN strom_test b ON a.id = b.id AND a.key = b.key
+ WHERE a.integer_x % 3 = 0;
+CREATE TEMP TABLE gpumem_stat3 AS SELECT * FROM gpumem_stat;
+
+--# the retained blocks are released at the end of next query
+set pg_strom.gpumem_retain_size = 0;
+CREATE TEMP TABLE gpumem_gpu4 AS
+SELECT id, integer_x, float_x FROM strom_test WHERE integer_x % 3 = 0;
+SELECT bytes = 0 AS released FROM gpumem_stat WHERE item = 'retained memory';
+SELECT s.count - s3.count > 0 AS freed
+  FROM gpumem_stat s, gpumem_stat3 s3
+ WHERE s.item = s3.item AND s.item = 'cuMemFree';
+
+reset pg_strom.gpumem_retain_size;
+reset pg_strom.chunk_size;
+
+set pg_strom.enabled to off;
+CREATE TEMP TABLE gpumem_cpu0 AS
+SELECT id, integer_x, float_x FROM strom_test WHERE integer_x % 3 = 0;
+CREATE TEMP TABLE gpumem_cpu3 AS
+SELECT a.id, a.integer_x, b.float_x
+  FROM strom_test a JOIN strom_test b ON a.id = b.id AND a.key = b.key
+ WHERE a.integer_x % 3 = 0;
+reset pg_strom.enabled;
+
+SELECT count(*) > 0 AS nonempty FROM gpumem_gpu0;
+SELECT count(*) > 0 AS nonempty FROM gpumem_gpu3;
+SELECT count(*) FROM (SELECT * FROM gpumem_gpu0 EXCEPT ALL
+                      SELECT * FROM gpumem_cpu0) d;
+SELECT count(*) FROM (SELECT * FROM gpumem_cpu0 EXCEPT ALL
+                      SELECT * FROM gpumem_gpu0) d;
+SELECT count(*) FROM (SELECT * FROM gpumem_gpu1 EXCEPT ALL
+                      SELECT * FROM gpumem_cpu0) d;
+SELECT count(*) FROM (SELECT * FROM gpumem_cpu0 EXCEPT ALL
+                      SELECT * FROM gpumem_gpu1) d;
+SELECT count(*) FROM (SELECT * FROM gpumem_gpu2 EXCEPT ALL
+                      SELECT * FROM gpumem_cpu0) d;
+SELECT count(*) FROM (SELECT * FROM gpumem_cpu0 EXCEPT ALL
+                      SELECT * FROM gpumem_gpu2) d;
+SELECT count(*) FROM (SELECT * FROM gpumem_gpu3 EXCEPT ALL
+                      SELECT * FROM gpumem_cpu3) d;
+SELECT count(*) FROM (SELECT * FROM gpumem_cpu3 EXCEPT ALL
+                      SELECT * FROM gpumem_gpu3) d;
+SELECT count(*) FROM (SELECT * FROM gpumem_gpu4 EXCEPT ALL
+                      SELECT * FROM gpumem_cpu0) d;
+SELECT count(*) FROM (SELECT * FROM gpumem_cpu0 EXCEPT ALL
+                      SELECT * FROM gpumem_gpu4) d;
@@ -0,0 +1,110 @@
+--#
+--#       GpuHashJoin TestCases with the shared inner hash cache
+--#
+
+set pg_strom.gpu_setup_cost=0;
+set pg_strom.enable_gpunestloop to off;
+set pg_strom.enable_gpupreagg to off;
+set pg_strom.enable_gpusort to off;
+set enable_nestloop to off;
+set enable_mergejoin to off;
+set random_page_cost=1000000;   --# force off index_scan.
+set client_min_messages to warning;
+
+CREATE EXTENSION IF NOT EXISTS dblink;
+
+DROP TABLE IF EXISTS strom_icache_outer;
+DROP TABLE IF EXISTS strom_icache_inner;
+CREATE TABLE strom_icache_outer (
+       id integer,
+       a  integer
+);
+CREATE TABLE strom_icache_inner (
+       id integer,
+       k  integer
+);
+INSERT INTO strom_icache_outer SELECT x, x % 1000
+  FROM generate_series(1,20000) x;
+INSERT INTO strom_icache_inner SELECT x, x % 500
+  FROM generate_series(1,2000) x;
+ANALYZE strom_icache_outer;
+ANALYZE strom_icache_inner;
+
+CREATE VIEW icache_stat AS
+SELECT count(*) entries, coalesce(sum(nhits), 0) nhits
+  FROM pgstrom_icache_info()
+ WHERE table_oid = 'strom_icache_inner'::regclass;
+
+SELECT dblink_connect('icache_conn', 'dbname=' || current_database() ||
+                      ' port=' || current_setting('port')) = 'OK' AS connected;
+
+--# the first run builds the inner hash table and saves it, then the
+--# next runs under the identical snapshot pick it up
+BEGIN ISOLATION LEVEL REPEATABLE READ;
+SELECT count(*) cnt, sum(o.id + i.id) s
+  FROM strom_icache_outer o JOIN strom_icache_inner i ON o.a = i.k;
+SELECT * FROM icache_stat;
+SELECT count(*) cnt, sum(o.id + i.id) s
+  FROM strom_icache_outer o JOIN strom_icache_inner i ON o.a = i.k;
+SELECT * FROM icache_stat;
+--# a concurrent commit is invisible to the identical snapshot
+SELECT dblink_exec('icache_conn',
+       'INSERT INTO strom_icache_inner VALUES (2001, 1)') AS inserted;
+SELECT count(*) cnt, sum(o.id + i.id) s
+  FROM strom_icache_outer o JOIN strom_icache_inner i ON o.a = i.k;
+SELECT * FROM icache_stat;
+set local pg_strom.enabled to off;
+SELECT count(*) cnt, sum(o.id + i.id) s
+  FROM strom_icache_outer o JOIN strom_icache_inner i ON o.a = i.k;
+COMMIT;
+
+--# the snapshot after the concurrent commit does not match
+SELECT count(*) cnt, sum(o.id + i.id) s
+  FROM strom_icache_outer o JOIN strom_icache_inner i ON o.a = i.k;
+SELECT * FROM icache_stat;
+set pg_strom.enabled to off;
+SELECT count(*) cnt, sum(o.id + i.id) s
+  FROM strom_icache_outer o JOIN strom_icache_inner i ON o.a = i.k;
+reset pg_strom.enabled;
+
+--# parameterized inner is not cached
+SELECT x.n, (SELECT count(*)
+               FROM strom_icache_outer o JOIN strom_icache_inner i
+                 ON o.a = i.k
+              WHERE i.id < x.n)
+  FROM (VALUES (500), (1000), (1500)) x(n);
+SELECT * FROM icache_stat;
+set pg_strom.enabled to off;
+SELECT x.n, (SELECT count(*)
+               FROM strom_icache_outer o JOIN strom_icache_inner i
+                 ON o.a = i.k
+              WHERE i.id < x.n)
+  FROM (VALUES (500), (1000), (1500)) x(n);
+reset pg_strom.enabled;
+
+--# inner with volatile functions is not cached
+SELECT count(*) cnt, sum(o.id + i.id) s
+  FROM strom_icache_outer o JOIN strom_icache_inner i ON o.a = i.k
+ WHERE i.id < 1000 + (random() * 0)::int;
+SELECT * FROM icache_stat;
+set pg_strom.enabled to off;
+SELECT count(*) cnt, sum(o.id + i.id) s
+  FROM strom_icache_outer o JOIN strom_icache_inner i ON o.a = i.k
+ WHERE i.id < 1000 + (random() * 0)::int;
+reset pg_strom.enabled;
+
+--# transaction with its own XID neither picks up nor saves the cache
+BEGIN;
+INSERT INTO strom_icache_inner VALUES (2002, 2);
+SELECT count(*) cnt, sum(o.id + i.id) s
+  FROM strom_icache_outer o JOIN strom_icache_inner i ON o.a = i.k;
+SELECT * FROM icache_stat;
+set local pg_strom.enabled to off;
+SELECT count(*) cnt, sum(o.id + i.id) s
+  FROM strom_icache_outer o JOIN strom_icache_inner i ON o.a = i.k;
+ROLLBACK;
+
+SELECT dblink_disconnect('icache_conn');
+DROP VIEW icache_stat;
+DROP TABLE strom_icache_outer;
+DROP TABLE strom_icache_inner;
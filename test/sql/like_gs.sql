@@ -0,0 +1,255 @@
+--#
+--#       GpuScan TestCases of LIKE and regular expression
+--#
+
+set enable_seqscan to off;
+set enable_bitmapscan to off;
+set enable_indexscan to off;
+set random_page_cost=1000000;   --# force off index_scan.
+set pg_strom.enable_gpuhashjoin to off;
+set pg_strom.enable_gpupreagg to off;
+set pg_strom.enable_gpusort to off;
+set client_min_messages to warning;
+
+--# 'tc' is C-collation, so case-insensitive match can run on the device.
+--# Multibyte characters assume the database encoding is UTF-8.
+DROP TABLE IF EXISTS strom_like_test;
+CREATE TABLE strom_like_test (
+       id integer,
+       t  text,
+       tc text COLLATE "C"
+);
+INSERT INTO strom_like_test SELECT
+       x,
+       case when x % 37 = 0 then null
+            else substr(repeat('ab%_\cäd日本eAB', 3), 1 + x % 13, x % 11) end,
+       case when x % 41 = 0 then null
+            else substr(repeat('ab%_\cäd日本eAB', 3), 1 + x % 11, x % 13) end
+  FROM generate_series(1,4000) x;
+INSERT INTO strom_like_test VALUES
+       (4001, '', ''), (4002, 'ab', 'AB'), (4003, '%', '%'),
+       (4004, '_', '_'), (4005, '\', '\'), (4006, 'ä', 'Ä'),
+       (4007, '日本', '日本'), (4008, 'b%', 'B%'), (4009, 'ab\', 'Ab\');
+
+CREATE TEMP TABLE like_gpu AS
+SELECT 1 p, id FROM strom_like_test WHERE t LIKE 'ab%'
+UNION ALL
+SELECT 2 p, id FROM strom_like_test WHERE t LIKE '%ab'
+UNION ALL
+SELECT 3 p, id FROM strom_like_test WHERE t LIKE '%b%'
+UNION ALL
+SELECT 4 p, id FROM strom_like_test WHERE t LIKE '_b%'
+UNION ALL
+SELECT 5 p, id FROM strom_like_test WHERE t LIKE '%_'
+UNION ALL
+SELECT 6 p, id FROM strom_like_test WHERE t LIKE '_'
+UNION ALL
+SELECT 7 p, id FROM strom_like_test WHERE t LIKE '%'
+UNION ALL
+SELECT 8 p, id FROM strom_like_test WHERE t LIKE ''
+UNION ALL
+SELECT 9 p, id FROM strom_like_test WHERE t LIKE 'a%b'
+UNION ALL
+SELECT 10 p, id FROM strom_like_test WHERE t LIKE '%\%%'
+UNION ALL
+SELECT 11 p, id FROM strom_like_test WHERE t LIKE '%\_%'
+UNION ALL
+SELECT 12 p, id FROM strom_like_test WHERE t LIKE '\%%'
+UNION ALL
+SELECT 13 p, id FROM strom_like_test WHERE t LIKE '%\\%'
+UNION ALL
+SELECT 14 p, id FROM strom_like_test WHERE t LIKE '%\\'
+UNION ALL
+SELECT 15 p, id FROM strom_like_test WHERE t LIKE 'ab%%'
+UNION ALL
+SELECT 16 p, id FROM strom_like_test WHERE t LIKE '%%%b'
+UNION ALL
+SELECT 17 p, id FROM strom_like_test WHERE t LIKE '%ä%'
+UNION ALL
+SELECT 18 p, id FROM strom_like_test WHERE t LIKE 'ä%'
+UNION ALL
+SELECT 19 p, id FROM strom_like_test WHERE t LIKE '%日本'
+UNION ALL
+SELECT 20 p, id FROM strom_like_test WHERE t LIKE '日本%e%'
+UNION ALL
+SELECT 21 p, id FROM strom_like_test WHERE t LIKE '%d_本%'
+UNION ALL
+SELECT 22 p, id FROM strom_like_test WHERE t LIKE '%c_d%'
+UNION ALL
+SELECT 23 p, id FROM strom_like_test WHERE t NOT LIKE 'ab%'
+UNION ALL
+SELECT 24 p, id FROM strom_like_test WHERE t NOT LIKE '%\_%'
+UNION ALL
+SELECT 25 p, id FROM strom_like_test WHERE t NOT LIKE '%日本'
+UNION ALL
+SELECT 26 p, id FROM strom_like_test WHERE tc ILIKE '%AB%'
+UNION ALL
+SELECT 27 p, id FROM strom_like_test WHERE tc ILIKE 'Ab%'
+UNION ALL
+SELECT 28 p, id FROM strom_like_test WHERE tc ILIKE '%\%B%'
+UNION ALL
+SELECT 29 p, id FROM strom_like_test WHERE tc ILIKE '_B%'
+UNION ALL
+SELECT 30 p, id FROM strom_like_test WHERE tc ILIKE '%Ä%'
+UNION ALL
+SELECT 31 p, id FROM strom_like_test WHERE tc ILIKE '%E_b'
+UNION ALL
+SELECT 32 p, id FROM strom_like_test WHERE tc NOT ILIKE '%AB'
+UNION ALL
+SELECT 33 p, id FROM strom_like_test WHERE t ~ '^ab'
+UNION ALL
+SELECT 34 p, id FROM strom_like_test WHERE t ~ 'b$'
+UNION ALL
+SELECT 35 p, id FROM strom_like_test WHERE t ~ 'a.b'
+UNION ALL
+SELECT 36 p, id FROM strom_like_test WHERE t ~ '[a-c]+d'
+UNION ALL
+SELECT 37 p, id FROM strom_like_test WHERE t ~ '^[^a]'
+UNION ALL
+SELECT 38 p, id FROM strom_like_test WHERE t ~ 'b\%'
+UNION ALL
+SELECT 39 p, id FROM strom_like_test WHERE t ~ '日本e'
+UNION ALL
+SELECT 40 p, id FROM strom_like_test WHERE t ~ 'ä+'
+UNION ALL
+SELECT 41 p, id FROM strom_like_test WHERE t ~ 'ab*%'
+UNION ALL
+SELECT 42 p, id FROM strom_like_test WHERE t ~ '^$'
+UNION ALL
+SELECT 43 p, id FROM strom_like_test WHERE t ~ 'x?a'
+UNION ALL
+SELECT 44 p, id FROM strom_like_test WHERE t ~ '\\c'
+UNION ALL
+SELECT 45 p, id FROM strom_like_test WHERE t ~ '^_'
+UNION ALL
+SELECT 46 p, id FROM strom_like_test WHERE t ~ '%_?\\'
+UNION ALL
+SELECT 47 p, id FROM strom_like_test WHERE t !~ '^ab'
+UNION ALL
+SELECT 48 p, id FROM strom_like_test WHERE t !~ '日本'
+UNION ALL
+SELECT 49 p, id FROM strom_like_test WHERE tc ~* '^AB'
+UNION ALL
+SELECT 50 p, id FROM strom_like_test WHERE tc ~* '[A-C]d'
+UNION ALL
+SELECT 51 p, id FROM strom_like_test WHERE tc ~* 'E[a]'
+UNION ALL
+SELECT 52 p, id FROM strom_like_test WHERE tc ~* '[^b]B$'
+UNION ALL
+SELECT 53 p, id FROM strom_like_test WHERE tc !~* 'ab';
+set pg_strom.enabled to off;
+CREATE TEMP TABLE like_cpu AS
+SELECT 1 p, id FROM strom_like_test WHERE t LIKE 'ab%'
+UNION ALL
+SELECT 2 p, id FROM strom_like_test WHERE t LIKE '%ab'
+UNION ALL
+SELECT 3 p, id FROM strom_like_test WHERE t LIKE '%b%'
+UNION ALL
+SELECT 4 p, id FROM strom_like_test WHERE t LIKE '_b%'
+UNION ALL
+SELECT 5 p, id FROM strom_like_test WHERE t LIKE '%_'
+UNION ALL
+SELECT 6 p, id FROM strom_like_test WHERE t LIKE '_'
+UNION ALL
+SELECT 7 p, id FROM strom_like_test WHERE t LIKE '%'
+UNION ALL
+SELECT 8 p, id FROM strom_like_test WHERE t LIKE ''
+UNION ALL
+SELECT 9 p, id FROM strom_like_test WHERE t LIKE 'a%b'
+UNION ALL
+SELECT 10 p, id FROM strom_like_test WHERE t LIKE '%\%%'
+UNION ALL
+SELECT 11 p, id FROM strom_like_test WHERE t LIKE '%\_%'
+UNION ALL
+SELECT 12 p, id FROM strom_like_test WHERE t LIKE '\%%'
+UNION ALL
+SELECT 13 p, id FROM strom_like_test WHERE t LIKE '%\\%'
+UNION ALL
+SELECT 14 p, id FROM strom_like_test WHERE t LIKE '%\\'
+UNION ALL
+SELECT 15 p, id FROM strom_like_test WHERE t LIKE 'ab%%'
+UNION ALL
+SELECT 16 p, id FROM strom_like_test WHERE t LIKE '%%%b'
+UNION ALL
+SELECT 17 p, id FROM strom_like_test WHERE t LIKE '%ä%'
+UNION ALL
+SELECT 18 p, id FROM strom_like_test WHERE t LIKE 'ä%'
+UNION ALL
+SELECT 19 p, id FROM strom_like_test WHERE t LIKE '%日本'
+UNION ALL
+SELECT 20 p, id FROM strom_like_test WHERE t LIKE '日本%e%'
+UNION ALL
+SELECT 21 p, id FROM strom_like_test WHERE t LIKE '%d_本%'
+UNION ALL
+SELECT 22 p, id FROM strom_like_test WHERE t LIKE '%c_d%'
+UNION ALL
+SELECT 23 p, id FROM strom_like_test WHERE t NOT LIKE 'ab%'
+UNION ALL
+SELECT 24 p, id FROM strom_like_test WHERE t NOT LIKE '%\_%'
+UNION ALL
+SELECT 25 p, id FROM strom_like_test WHERE t NOT LIKE '%日本'
+UNION ALL
+SELECT 26 p, id FROM strom_like_test WHERE tc ILIKE '%AB%'
+UNION ALL
+SELECT 27 p, id FROM strom_like_test WHERE tc ILIKE 'Ab%'
+UNION ALL
+SELECT 28 p, id FROM strom_like_test WHERE tc ILIKE '%\%B%'
+UNION ALL
+SELECT 29 p, id FROM strom_like_test WHERE tc ILIKE '_B%'
+UNION ALL
+SELECT 30 p, id FROM strom_like_test WHERE tc ILIKE '%Ä%'
+UNION ALL
+SELECT 31 p, id FROM strom_like_test WHERE tc ILIKE '%E_b'
+UNION ALL
+SELECT 32 p, id FROM strom_like_test WHERE tc NOT ILIKE '%AB'
+UNION ALL
+SELECT 33 p, id FROM strom_like_test WHERE t ~ '^ab'
+UNION ALL
+SELECT 34 p, id FROM strom_like_test WHERE t ~ 'b$'
+UNION ALL
+SELECT 35 p, id FROM strom_like_test WHERE t ~ 'a.b'
+UNION ALL
+SELECT 36 p, id FROM strom_like_test WHERE t ~ '[a-c]+d'
+UNION ALL
+SELECT 37 p, id FROM strom_like_test WHERE t ~ '^[^a]'
+UNION ALL
+SELECT 38 p, id FROM strom_like_test WHERE t ~ 'b\%'
+UNION ALL
+SELECT 39 p, id FROM strom_like_test WHERE t ~ '日本e'
+UNION ALL
+SELECT 40 p, id FROM strom_like_test WHERE t ~ 'ä+'
+UNION ALL
+SELECT 41 p, id FROM strom_like_test WHERE t ~ 'ab*%'
+UNION ALL
+SELECT 42 p, id FROM strom_like_test WHERE t ~ '^$'
+UNION ALL
+SELECT 43 p, id FROM strom_like_test WHERE t ~ 'x?a'
+UNION ALL
+SELECT 44 p, id FROM strom_like_test WHERE t ~ '\\c'
+UNION ALL
+SELECT 45 p, id FROM strom_like_test WHERE t ~ '^_'
+UNION ALL
+SELECT 46 p, id FROM strom_like_test WHERE t ~ '%_?\\'
+UNION ALL
+SELECT 47 p, id FROM strom_like_test WHERE t !~ '^ab'
+UNION ALL
+SELECT 48 p, id FROM strom_like_test WHERE t !~ '日本'
+UNION ALL
+SELECT 49 p, id FROM strom_like_test WHERE tc ~* '^AB'
+UNION ALL
+SELECT 50 p, id FROM strom_like_test WHERE tc ~* '[A-C]d'
+UNION ALL
+SELECT 51 p, id FROM strom_like_test WHERE tc ~* 'E[a]'
+UNION ALL
+SELECT 52 p, id FROM strom_like_test WHERE tc ~* '[^b]B$'
+UNION ALL
+SELECT 53 p, id FROM strom_like_test WHERE tc !~* 'ab';
+reset pg_strom.enabled;
+
+SELECT count(*) > 0 AS nonempty FROM like_gpu;
+SELECT count(*) FROM (SELECT * FROM like_gpu EXCEPT ALL
+                      SELECT * FROM like_cpu) d;
+SELECT count(*) FROM (SELECT * FROM like_cpu EXCEPT ALL
+                      SELECT * FROM like_gpu) d;
+
+DROP TABLE strom_like_test;
@@ -0,0 +1,158 @@
+--#
+--#       Gpu PreAggregate TestCases with fixed-point sum/avg of numeric
+--#
+--#   Scale of numeric(p,s) is never negative on this version, so negative
+--#   values and scale 0 are tested instead.
+--#
+
+set pg_strom.debug_force_gpupreagg to on;
+set pg_strom.enable_gpusort to off;
+set client_min_messages to warning;
+
+DROP TABLE IF EXISTS strom_fixed_test;
+CREATE TABLE strom_fixed_test (
+       id  integer,
+       key integer,
+       a   numeric(18,0),
+       b   numeric(18,4),
+       c   numeric(18,18),
+       d   numeric(10,2),
+       e   numeric(20,4),
+       f   numeric
+);
+--# any of a, b, c and d are NULL on key = 9
+INSERT INTO strom_fixed_test SELECT
+       x,
+       x % 10,
+       case when x % 10 = 9 then null
+            when x % 3 = 0 then -999999999999999999 + x
+            else 999999999999999999 - x end,
+       case when x % 10 = 9 then null
+            else (((x * 2654435761::bigint) % 200000000000000)
+                  - 100000000000000)::numeric / 10000 end,
+       case when x % 10 = 9 then null
+            else (((x * 2654435761::bigint) % 2000000)
+                  - 1000000)::numeric / 1000001 end,
+       case when x % 10 = 9 then null
+            else -(x % 100000) / 100.0 end,
+       x * 1000000000.1234,
+       x / 7.0
+  FROM generate_series(1,100000) x;
+ANALYZE strom_fixed_test;
+
+--# GROUP BY; sum of numeric(18,0) overflows int64
+CREATE TEMP TABLE fixed_on1 AS
+SELECT key, sum(a) sum_a, avg(a) avg_a, sum(b) sum_b, avg(b) avg_b,
+       sum(c) sum_c, avg(c) avg_c, sum(d) sum_d, avg(d) avg_d
+  FROM strom_fixed_test GROUP BY key;
+set pg_strom.enable_gpupreagg_numeric_fixed to off;
+CREATE TEMP TABLE fixed_off1 AS
+SELECT key, sum(a) sum_a, avg(a) avg_a, sum(b) sum_b, avg(b) avg_b,
+       sum(c) sum_c, avg(c) avg_c, sum(d) sum_d, avg(d) avg_d
+  FROM strom_fixed_test GROUP BY key;
+reset pg_strom.enable_gpupreagg_numeric_fixed;
+set pg_strom.enabled to off;
+CREATE TEMP TABLE fixed_cpu1 AS
+SELECT key, sum(a) sum_a, avg(a) avg_a, sum(b) sum_b, avg(b) avg_b,
+       sum(c) sum_c, avg(c) avg_c, sum(d) sum_d, avg(d) avg_d
+  FROM strom_fixed_test GROUP BY key;
+reset pg_strom.enabled;
+
+SELECT count(*) > 0 AS nonempty FROM fixed_on1;
+SELECT count(*) FROM (SELECT * FROM fixed_on1 EXCEPT ALL
+                      SELECT * FROM fixed_cpu1) d;
+SELECT count(*) FROM (SELECT * FROM fixed_cpu1 EXCEPT ALL
+                      SELECT * FROM fixed_on1) d;
+SELECT count(*) FROM (SELECT * FROM fixed_off1 EXCEPT ALL
+                      SELECT * FROM fixed_cpu1) d;
+SELECT count(*) FROM (SELECT * FROM fixed_cpu1 EXCEPT ALL
+                      SELECT * FROM fixed_off1) d;
+
+--# no GROUP BY
+CREATE TEMP TABLE fixed_on2 AS
+SELECT sum(a) sum_a, avg(a) avg_a, sum(b) sum_b, avg(b) avg_b,
+       sum(c) sum_c, avg(c) avg_c, sum(d) sum_d, avg(d) avg_d
+  FROM strom_fixed_test;
+set pg_strom.enable_gpupreagg_numeric_fixed to off;
+CREATE TEMP TABLE fixed_off2 AS
+SELECT sum(a) sum_a, avg(a) avg_a, sum(b) sum_b, avg(b) avg_b,
+       sum(c) sum_c, avg(c) avg_c, sum(d) sum_d, avg(d) avg_d
+  FROM strom_fixed_test;
+reset pg_strom.enable_gpupreagg_numeric_fixed;
+set pg_strom.enabled to off;
+CREATE TEMP TABLE fixed_cpu2 AS
+SELECT sum(a) sum_a, avg(a) avg_a, sum(b) sum_b, avg(b) avg_b,
+       sum(c) sum_c, avg(c) avg_c, sum(d) sum_d, avg(d) avg_d
+  FROM strom_fixed_test;
+reset pg_strom.enabled;
+
+SELECT count(*) > 0 AS nonempty FROM fixed_on2;
+SELECT count(*) FROM (SELECT * FROM fixed_on2 EXCEPT ALL
+                      SELECT * FROM fixed_cpu2) d;
+SELECT count(*) FROM (SELECT * FROM fixed_cpu2 EXCEPT ALL
+                      SELECT * FROM fixed_on2) d;
+SELECT count(*) FROM (SELECT * FROM fixed_off2 EXCEPT ALL
+                      SELECT * FROM fixed_cpu2) d;
+SELECT count(*) FROM (SELECT * FROM fixed_cpu2 EXCEPT ALL
+                      SELECT * FROM fixed_off2) d;
+
+--# FILTER clause; numeric(20,4) and numeric without typmod are not fixed-point
+CREATE TEMP TABLE fixed_on3 AS
+SELECT key, sum(d) FILTER (WHERE id % 3 = 0) sum_d,
+       avg(b) FILTER (WHERE b < 0) avg_b,
+       sum(e) sum_e, avg(f) avg_f
+  FROM strom_fixed_test GROUP BY key;
+set pg_strom.enable_gpupreagg_numeric_fixed to off;
+CREATE TEMP TABLE fixed_off3 AS
+SELECT key, sum(d) FILTER (WHERE id % 3 = 0) sum_d,
+       avg(b) FILTER (WHERE b < 0) avg_b,
+       sum(e) sum_e, avg(f) avg_f
+  FROM strom_fixed_test GROUP BY key;
+reset pg_strom.enable_gpupreagg_numeric_fixed;
+set pg_strom.enabled to off;
+CREATE TEMP TABLE fixed_cpu3 AS
+SELECT key, sum(d) FILTER (WHERE id % 3 = 0) sum_d,
+       avg(b) FILTER (WHERE b < 0) avg_b,
+       sum(e) sum_e, avg(f) avg_f
+  FROM strom_fixed_test GROUP BY key;
+reset pg_strom.enabled;
+
+SELECT count(*) > 0 AS nonempty FROM fixed_on3;
+SELECT count(*) FROM (SELECT * FROM fixed_on3 EXCEPT ALL
+                      SELECT * FROM fixed_cpu3) d;
+SELECT count(*) FROM (SELECT * FROM fixed_cpu3 EXCEPT ALL
+                      SELECT * FROM fixed_on3) d;
+SELECT count(*) FROM (SELECT * FROM fixed_off3 EXCEPT ALL
+                      SELECT * FROM fixed_cpu3) d;
+SELECT count(*) FROM (SELECT * FROM fixed_cpu3 EXCEPT ALL
+                      SELECT * FROM fixed_off3) d;
+
+--# typmod of the expression
+CREATE TEMP TABLE fixed_on4 AS
+SELECT key % 3 k, sum((id / 8.0)::numeric(12,3)) sum_x,
+       avg((-id)::numeric(9,0)) avg_x
+  FROM strom_fixed_test GROUP BY key % 3;
+set pg_strom.enable_gpupreagg_numeric_fixed to off;
+CREATE TEMP TABLE fixed_off4 AS
+SELECT key % 3 k, sum((id / 8.0)::numeric(12,3)) sum_x,
+       avg((-id)::numeric(9,0)) avg_x
+  FROM strom_fixed_test GROUP BY key % 3;
+reset pg_strom.enable_gpupreagg_numeric_fixed;
+set pg_strom.enabled to off;
+CREATE TEMP TABLE fixed_cpu4 AS
+SELECT key % 3 k, sum((id / 8.0)::numeric(12,3)) sum_x,
+       avg((-id)::numeric(9,0)) avg_x
+  FROM strom_fixed_test GROUP BY key % 3;
+reset pg_strom.enabled;
+
+SELECT count(*) > 0 AS nonempty FROM fixed_on4;
+SELECT count(*) FROM (SELECT * FROM fixed_on4 EXCEPT ALL
+                      SELECT * FROM fixed_cpu4) d;
+SELECT count(*) FROM (SELECT * FROM fixed_cpu4 EXCEPT ALL
+                      SELECT * FROM fixed_on4) d;
+SELECT count(*) FROM (SELECT * FROM fixed_off4 EXCEPT ALL
+                      SELECT * FROM fixed_cpu4) d;
+SELECT count(*) FROM (SELECT * FROM fixed_cpu4 EXCEPT ALL
+                      SELECT * FROM fixed_off4) d;
+
+DROP TABLE strom_fixed_test;
@@ -0,0 +1,112 @@
+--#
+--#       GpuHashJoin TestCases with/without partitioned inner
+--#
+--# NOTE: inner hash table is partitioned only if two or more GPU devices
+--# are installed; elsewhere, these cases run as usual GpuHashJoin.
+--#
+
+set pg_strom.gpu_setup_cost=0;
+set pg_strom.enable_gpunestloop to off;
+set pg_strom.enable_gpupreagg to off;
+set pg_strom.enable_gpusort to off;
+set enable_nestloop to off;
+set enable_mergejoin to off;
+set random_page_cost=1000000;   --# force off index_scan.
+set client_min_messages to warning;
+
+DROP TABLE IF EXISTS strom_part_outer;
+DROP TABLE IF EXISTS strom_part_inner1;
+DROP TABLE IF EXISTS strom_part_inner2;
+CREATE TABLE strom_part_outer (
+       id integer,
+       a  integer,
+       b  integer
+);
+CREATE TABLE strom_part_inner1 (
+       id integer,
+       k  integer
+);
+CREATE TABLE strom_part_inner2 (
+       id integer,
+       k  integer
+);
+INSERT INTO strom_part_outer SELECT
+       x,
+       case when x % 31 = 0 then null else (x * 7) % 12000 end,
+       (x * 13) % 800
+  FROM generate_series(1,20000) x;
+INSERT INTO strom_part_inner1 SELECT
+       x,
+       case when x % 17 = 0 then null else (x * 3) % 10000 end
+  FROM generate_series(1,10000) x;
+INSERT INTO strom_part_inner2 SELECT
+       x,
+       x % 1000
+  FROM generate_series(1,1000) x;
+ANALYZE strom_part_outer;
+ANALYZE strom_part_inner1;
+ANALYZE strom_part_inner2;
+
+--# LEFT JOIN; unmatched outer rows shall be emitted only once, not per device
+set pg_strom.enable_gpujoin_partition to on;
+CREATE TEMP TABLE part_on1 AS
+SELECT o.id o_id, i.id i_id FROM strom_part_outer o LEFT JOIN strom_part_inner1 i
+    ON o.a = i.k;
+set pg_strom.enable_gpujoin_partition to off;
+CREATE TEMP TABLE part_off1 AS
+SELECT o.id o_id, i.id i_id FROM strom_part_outer o LEFT JOIN strom_part_inner1 i
+    ON o.a = i.k;
+set pg_strom.enabled to off;
+CREATE TEMP TABLE part_cpu1 AS
+SELECT o.id o_id, i.id i_id FROM strom_part_outer o LEFT JOIN strom_part_inner1 i
+    ON o.a = i.k;
+reset pg_strom.enabled;
+reset pg_strom.enable_gpujoin_partition;
+
+SELECT count(*) > 0 AS nonempty FROM part_on1 WHERE i_id IS NULL;
+SELECT count(*) FROM (SELECT o_id FROM part_on1 WHERE i_id IS NULL
+                      GROUP BY o_id HAVING count(*) > 1) d;
+SELECT count(*) FROM (SELECT * FROM part_on1 EXCEPT ALL
+                      SELECT * FROM part_cpu1) d;
+SELECT count(*) FROM (SELECT * FROM part_cpu1 EXCEPT ALL
+                      SELECT * FROM part_on1) d;
+SELECT count(*) FROM (SELECT * FROM part_off1 EXCEPT ALL
+                      SELECT * FROM part_cpu1) d;
+SELECT count(*) FROM (SELECT * FROM part_cpu1 EXCEPT ALL
+                      SELECT * FROM part_off1) d;
+
+--# LEFT JOIN on partitioned depth-1, then INNER JOIN on depth-2
+set pg_strom.enable_gpujoin_partition to on;
+CREATE TEMP TABLE part_on2 AS
+SELECT o.id o_id, i1.id i1_id, i2.id i2_id
+  FROM strom_part_outer o
+  LEFT JOIN strom_part_inner1 i1 ON o.a = i1.k
+  JOIN strom_part_inner2 i2 ON o.b = i2.k;
+set pg_strom.enable_gpujoin_partition to off;
+CREATE TEMP TABLE part_off2 AS
+SELECT o.id o_id, i1.id i1_id, i2.id i2_id
+  FROM strom_part_outer o
+  LEFT JOIN strom_part_inner1 i1 ON o.a = i1.k
+  JOIN strom_part_inner2 i2 ON o.b = i2.k;
+set pg_strom.enabled to off;
+CREATE TEMP TABLE part_cpu2 AS
+SELECT o.id o_id, i1.id i1_id, i2.id i2_id
+  FROM strom_part_outer o
+  LEFT JOIN strom_part_inner1 i1 ON o.a = i1.k
+  JOIN strom_part_inner2 i2 ON o.b = i2.k;
+reset pg_strom.enabled;
+reset pg_strom.enable_gpujoin_partition;
+
+SELECT count(*) > 0 AS nonempty FROM part_on2 WHERE i1_id IS NULL;
+SELECT count(*) FROM (SELECT * FROM part_on2 EXCEPT ALL
+                      SELECT * FROM part_cpu2) d;
+SELECT count(*) FROM (SELECT * FROM part_cpu2 EXCEPT ALL
+                      SELECT * FROM part_on2) d;
+SELECT count(*) FROM (SELECT * FROM part_off2 EXCEPT ALL
+                      SELECT * FROM part_cpu2) d;
+SELECT count(*) FROM (SELECT * FROM part_cpu2 EXCEPT ALL
+                      SELECT * FROM part_off2) d;
+
+DROP TABLE strom_part_outer;
+DROP TABLE strom_part_inner1;
+DROP TABLE strom_part_inner2;
@@ -0,0 +1,306 @@
+--#
+--#       GpuSort TestCases with/without radix sort of the fixed-width keys
+--#
+
+set pg_strom.debug_force_gpusort to on;
+set pg_strom.gpu_setup_cost=0;
+set random_page_cost=1000000;   --# force off index_scan.
+set pg_strom.enable_gpusort to on;
+set pg_strom.enable_gpusort_radix to on;
+set client_min_messages to warning;
+
+DROP TABLE IF EXISTS strom_radix;
+CREATE TABLE strom_radix (
+       id     integer,
+       c_i2   smallint,
+       c_i4   integer,
+       c_i8   bigint,
+       c_date date,
+       c_time time,
+       c_ts   timestamp,
+       c_tz   timestamptz,
+       c_f4   real,
+       c_f8   float
+);
+--# every 1000 rows have the extreme and special values
+INSERT INTO strom_radix SELECT
+       x,
+       case when x % 13 = 0 then null
+            when x % 1000 = 1 then -32768
+            when x % 1000 = 2 then 32767
+            else (x * 37) % 65536 - 32768 end,
+       case when x % 13 = 0 then null
+            when x % 1000 = 1 then -2147483648
+            when x % 1000 = 2 then 2147483647
+            else (x * 2654435761::bigint) % 4294967296 - 2147483648 end,
+       case when x % 13 = 0 then null
+            when x % 1000 = 1 then -9223372036854775808
+            when x % 1000 = 2 then 9223372036854775807
+            when x % 1000 = 3 then -1
+            when x % 1000 = 4 then 0
+            else ((x * 2654435761::bigint) % 4294967296 - 2147483648)
+                 * 2147483647 end,
+       case when x % 13 = 0 then null
+            else date '2000-01-01' + ((x * 37) % 20000 - 10000) end,
+       case when x % 13 = 0 then null
+            else time '00:00:00' + ((x * 37) % 86400) * interval '1 sec' end,
+       case when x % 13 = 0 then null
+            else timestamp '2000-01-01 00:00:00'
+                 + ((x * 7919) % 1000000 - 500000) * interval '1 min' end,
+       case when x % 13 = 0 then null
+            else timestamptz '2000-01-01 00:00:00+00'
+                 + ((x * 7919) % 1000000 - 500000) * interval '1 min' end,
+       case when x % 13 = 0 then null
+            when x % 1000 = 3 then '-0'::real
+            when x % 1000 = 4 then '0'::real
+            when x % 1000 = 5 then 'NaN'::real
+            when x % 1000 = 6 then 'Infinity'::real
+            when x % 1000 = 7 then '-Infinity'::real
+            when x % 1000 = 8 then '1e-37'::real
+            else ((x * 7919) % 20001 - 10000) / 7.0 end,
+       case when x % 13 = 0 then null
+            when x % 1000 = 3 then '-0'::float
+            when x % 1000 = 4 then '0'::float
+            when x % 1000 = 5 then 'NaN'::float
+            when x % 1000 = 6 then 'Infinity'::float
+            when x % 1000 = 7 then '-Infinity'::float
+            when x % 1000 = 8 then '1e-300'::float
+            else ((x * 7919) % 20001 - 10000) / 7.0 end
+  FROM generate_series(1,40000) x;
+ANALYZE strom_radix;
+
+--# int2
+CREATE TEMP TABLE radix_gpu_int2 AS
+SELECT 1 o, row_number() over (order by c_i2 asc nulls last) rn, c_i2 v FROM strom_radix
+UNION ALL
+SELECT 2 o, row_number() over (order by c_i2 asc nulls first) rn, c_i2 v FROM strom_radix
+UNION ALL
+SELECT 3 o, row_number() over (order by c_i2 desc nulls first) rn, c_i2 v FROM strom_radix
+UNION ALL
+SELECT 4 o, row_number() over (order by c_i2 desc nulls last) rn, c_i2 v FROM strom_radix;
+set pg_strom.enabled to off;
+CREATE TEMP TABLE radix_cpu_int2 AS
+SELECT 1 o, row_number() over (order by c_i2 asc nulls last) rn, c_i2 v FROM strom_radix
+UNION ALL
+SELECT 2 o, row_number() over (order by c_i2 asc nulls first) rn, c_i2 v FROM strom_radix
+UNION ALL
+SELECT 3 o, row_number() over (order by c_i2 desc nulls first) rn, c_i2 v FROM strom_radix
+UNION ALL
+SELECT 4 o, row_number() over (order by c_i2 desc nulls last) rn, c_i2 v FROM strom_radix;
+reset pg_strom.enabled;
+
+SELECT count(*) = 4 * 40000 AS nrows FROM radix_gpu_int2;
+SELECT count(*) FROM (SELECT * FROM radix_gpu_int2 EXCEPT ALL
+                      SELECT * FROM radix_cpu_int2) d;
+SELECT count(*) FROM (SELECT * FROM radix_cpu_int2 EXCEPT ALL
+                      SELECT * FROM radix_gpu_int2) d;
+
+--# int4
+CREATE TEMP TABLE radix_gpu_int4 AS
+SELECT 1 o, row_number() over (order by c_i4 asc nulls last) rn, c_i4 v FROM strom_radix
+UNION ALL
+SELECT 2 o, row_number() over (order by c_i4 asc nulls first) rn, c_i4 v FROM strom_radix
+UNION ALL
+SELECT 3 o, row_number() over (order by c_i4 desc nulls first) rn, c_i4 v FROM strom_radix
+UNION ALL
+SELECT 4 o, row_number() over (order by c_i4 desc nulls last) rn, c_i4 v FROM strom_radix;
+set pg_strom.enabled to off;
+CREATE TEMP TABLE radix_cpu_int4 AS
+SELECT 1 o, row_number() over (order by c_i4 asc nulls last) rn, c_i4 v FROM strom_radix
+UNION ALL
+SELECT 2 o, row_number() over (order by c_i4 asc nulls first) rn, c_i4 v FROM strom_radix
+UNION ALL
+SELECT 3 o, row_number() over (order by c_i4 desc nulls first) rn, c_i4 v FROM strom_radix
+UNION ALL
+SELECT 4 o, row_number() over (order by c_i4 desc nulls last) rn, c_i4 v FROM strom_radix;
+reset pg_strom.enabled;
+
+SELECT count(*) = 4 * 40000 AS nrows FROM radix_gpu_int4;
+SELECT count(*) FROM (SELECT * FROM radix_gpu_int4 EXCEPT ALL
+                      SELECT * FROM radix_cpu_int4) d;
+SELECT count(*) FROM (SELECT * FROM radix_cpu_int4 EXCEPT ALL
+                      SELECT * FROM radix_gpu_int4) d;
+
+--# int8
+CREATE TEMP TABLE radix_gpu_int8 AS
+SELECT 1 o, row_number() over (order by c_i8 asc nulls last) rn, c_i8 v FROM strom_radix
+UNION ALL
+SELECT 2 o, row_number() over (order by c_i8 asc nulls first) rn, c_i8 v FROM strom_radix
+UNION ALL
+SELECT 3 o, row_number() over (order by c_i8 desc nulls first) rn, c_i8 v FROM strom_radix
+UNION ALL
+SELECT 4 o, row_number() over (order by c_i8 desc nulls last) rn, c_i8 v FROM strom_radix;
+set pg_strom.enabled to off;
+CREATE TEMP TABLE radix_cpu_int8 AS
+SELECT 1 o, row_number() over (order by c_i8 asc nulls last) rn, c_i8 v FROM strom_radix
+UNION ALL
+SELECT 2 o, row_number() over (order by c_i8 asc nulls first) rn, c_i8 v FROM strom_radix
+UNION ALL
+SELECT 3 o, row_number() over (order by c_i8 desc nulls first) rn, c_i8 v FROM strom_radix
+UNION ALL
+SELECT 4 o, row_number() over (order by c_i8 desc nulls last) rn, c_i8 v FROM strom_radix;
+reset pg_strom.enabled;
+
+SELECT count(*) = 4 * 40000 AS nrows FROM radix_gpu_int8;
+SELECT count(*) FROM (SELECT * FROM radix_gpu_int8 EXCEPT ALL
+                      SELECT * FROM radix_cpu_int8) d;
+SELECT count(*) FROM (SELECT * FROM radix_cpu_int8 EXCEPT ALL
+                      SELECT * FROM radix_gpu_int8) d;
+
+--# date
+CREATE TEMP TABLE radix_gpu_date AS
+SELECT 1 o, row_number() over (order by c_date asc nulls last) rn, c_date v FROM strom_radix
+UNION ALL
+SELECT 2 o, row_number() over (order by c_date asc nulls first) rn, c_date v FROM strom_radix
+UNION ALL
+SELECT 3 o, row_number() over (order by c_date desc nulls first) rn, c_date v FROM strom_radix
+UNION ALL
+SELECT 4 o, row_number() over (order by c_date desc nulls last) rn, c_date v FROM strom_radix;
+set pg_strom.enabled to off;
+CREATE TEMP TABLE radix_cpu_date AS
+SELECT 1 o, row_number() over (order by c_date asc nulls last) rn, c_date v FROM strom_radix
+UNION ALL
+SELECT 2 o, row_number() over (order by c_date asc nulls first) rn, c_date v FROM strom_radix
+UNION ALL
+SELECT 3 o, row_number() over (order by c_date desc nulls first) rn, c_date v FROM strom_radix
+UNION ALL
+SELECT 4 o, row_number() over (order by c_date desc nulls last) rn, c_date v FROM strom_radix;
+reset pg_strom.enabled;
+
+SELECT count(*) = 4 * 40000 AS nrows FROM radix_gpu_date;
+SELECT count(*) FROM (SELECT * FROM radix_gpu_date EXCEPT ALL
+                      SELECT * FROM radix_cpu_date) d;
+SELECT count(*) FROM (SELECT * FROM radix_cpu_date EXCEPT ALL
+                      SELECT * FROM radix_gpu_date) d;
+
+--# time
+CREATE TEMP TABLE radix_gpu_time AS
+SELECT 1 o, row_number() over (order by c_time asc nulls last) rn, c_time v FROM strom_radix
+UNION ALL
+SELECT 2 o, row_number() over (order by c_time asc nulls first) rn, c_time v FROM strom_radix
+UNION ALL
+SELECT 3 o, row_number() over (order by c_time desc nulls first) rn, c_time v FROM strom_radix
+UNION ALL
+SELECT 4 o, row_number() over (order by c_time desc nulls last) rn, c_time v FROM strom_radix;
+set pg_strom.enabled to off;
+CREATE TEMP TABLE radix_cpu_time AS
+SELECT 1 o, row_number() over (order by c_time asc nulls last) rn, c_time v FROM strom_radix
+UNION ALL
+SELECT 2 o, row_number() over (order by c_time asc nulls first) rn, c_time v FROM strom_radix
+UNION ALL
+SELECT 3 o, row_number() over (order by c_time desc nulls first) rn, c_time v FROM strom_radix
+UNION ALL
+SELECT 4 o, row_number() over (order by c_time desc nulls last) rn, c_time v FROM strom_radix;
+reset pg_strom.enabled;
+
+SELECT count(*) = 4 * 40000 AS nrows FROM radix_gpu_time;
+SELECT count(*) FROM (SELECT * FROM radix_gpu_time EXCEPT ALL
+                      SELECT * FROM radix_cpu_time) d;
+SELECT count(*) FROM (SELECT * FROM radix_cpu_time EXCEPT ALL
+                      SELECT * FROM radix_gpu_time) d;
+
+--# timestamp
+CREATE TEMP TABLE radix_gpu_timestamp AS
+SELECT 1 o, row_number() over (order by c_ts asc nulls last) rn, c_ts v FROM strom_radix
+UNION ALL
+SELECT 2 o, row_number() over (order by c_ts asc nulls first) rn, c_ts v FROM strom_radix
+UNION ALL
+SELECT 3 o, row_number() over (order by c_ts desc nulls first) rn, c_ts v FROM strom_radix
+UNION ALL
+SELECT 4 o, row_number() over (order by c_ts desc nulls last) rn, c_ts v FROM strom_radix;
+set pg_strom.enabled to off;
+CREATE TEMP TABLE radix_cpu_timestamp AS
+SELECT 1 o, row_number() over (order by c_ts asc nulls last) rn, c_ts v FROM strom_radix
+UNION ALL
+SELECT 2 o, row_number() over (order by c_ts asc nulls first) rn, c_ts v FROM strom_radix
+UNION ALL
+SELECT 3 o, row_number() over (order by c_ts desc nulls first) rn, c_ts v FROM strom_radix
+UNION ALL
+SELECT 4 o, row_number() over (order by c_ts desc nulls last) rn, c_ts v FROM strom_radix;
+reset pg_strom.enabled;
+
+SELECT count(*) = 4 * 40000 AS nrows FROM radix_gpu_timestamp;
+SELECT count(*) FROM (SELECT * FROM radix_gpu_timestamp EXCEPT ALL
+                      SELECT * FROM radix_cpu_timestamp) d;
+SELECT count(*) FROM (SELECT * FROM radix_cpu_timestamp EXCEPT ALL
+                      SELECT * FROM radix_gpu_timestamp) d;
+
+--# timestamptz
+CREATE TEMP TABLE radix_gpu_timestamptz AS
+SELECT 1 o, row_number() over (order by c_tz asc nulls last) rn, c_tz v FROM strom_radix
+UNION ALL
+SELECT 2 o, row_number() over (order by c_tz asc nulls first) rn, c_tz v FROM strom_radix
+UNION ALL
+SELECT 3 o, row_number() over (order by c_tz desc nulls first) rn, c_tz v FROM strom_radix
+UNION ALL
+SELECT 4 o, row_number() over (order by c_tz desc nulls last) rn, c_tz v FROM strom_radix;
+set pg_strom.enabled to off;
+CREATE TEMP TABLE radix_cpu_timestamptz AS
+SELECT 1 o, row_number() over (order by c_tz asc nulls last) rn, c_tz v FROM strom_radix
+UNION ALL
+SELECT 2 o, row_number() over (order by c_tz asc nulls first) rn, c_tz v FROM strom_radix
+UNION ALL
+SELECT 3 o, row_number() over (order by c_tz desc nulls first) rn, c_tz v FROM strom_radix
+UNION ALL
+SELECT 4 o, row_number() over (order by c_tz desc nulls last) rn, c_tz v FROM strom_radix;
+reset pg_strom.enabled;
+
+SELECT count(*) = 4 * 40000 AS nrows FROM radix_gpu_timestamptz;
+SELECT count(*) FROM (SELECT * FROM radix_gpu_timestamptz EXCEPT ALL
+                      SELECT * FROM radix_cpu_timestamptz) d;
+SELECT count(*) FROM (SELECT * FROM radix_cpu_timestamptz EXCEPT ALL
+                      SELECT * FROM radix_gpu_timestamptz) d;
+
+--# float4
+CREATE TEMP TABLE radix_gpu_float4 AS
+SELECT 1 o, row_number() over (order by c_f4 asc nulls last) rn, c_f4 v FROM strom_radix
+UNION ALL
+SELECT 2 o, row_number() over (order by c_f4 asc nulls first) rn, c_f4 v FROM strom_radix
+UNION ALL
+SELECT 3 o, row_number() over (order by c_f4 desc nulls first) rn, c_f4 v FROM strom_radix
+UNION ALL
+SELECT 4 o, row_number() over (order by c_f4 desc nulls last) rn, c_f4 v FROM strom_radix;
+set pg_strom.enabled to off;
+CREATE TEMP TABLE radix_cpu_float4 AS
+SELECT 1 o, row_number() over (order by c_f4 asc nulls last) rn, c_f4 v FROM strom_radix
+UNION ALL
+SELECT 2 o, row_number() over (order by c_f4 asc nulls first) rn, c_f4 v FROM strom_radix
+UNION ALL
+SELECT 3 o, row_number() over (order by c_f4 desc nulls first) rn, c_f4 v FROM strom_radix
+UNION ALL
+SELECT 4 o, row_number() over (order by c_f4 desc nulls last) rn, c_f4 v FROM strom_radix;
+reset pg_strom.enabled;
+
+SELECT count(*) = 4 * 40000 AS nrows FROM radix_gpu_float4;
+SELECT count(*) FROM (SELECT * FROM radix_gpu_float4 EXCEPT ALL
+                      SELECT * FROM radix_cpu_float4) d;
+SELECT count(*) FROM (SELECT * FROM radix_cpu_float4 EXCEPT ALL
+                      SELECT * FROM radix_gpu_float4) d;
+
+--# float8
+CREATE TEMP TABLE radix_gpu_float8 AS
+SELECT 1 o, row_number() over (order by c_f8 asc nulls last) rn, c_f8 v FROM strom_radix
+UNION ALL
+SELECT 2 o, row_number() over (order by c_f8 asc nulls first) rn, c_f8 v FROM strom_radix
+UNION ALL
+SELECT 3 o, row_number() over (order by c_f8 desc nulls first) rn, c_f8 v FROM strom_radix
+UNION ALL
+SELECT 4 o, row_number() over (order by c_f8 desc nulls last) rn, c_f8 v FROM strom_radix;
+set pg_strom.enabled to off;
+CREATE TEMP TABLE radix_cpu_float8 AS
+SELECT 1 o, row_number() over (order by c_f8 asc nulls last) rn, c_f8 v FROM strom_radix
+UNION ALL
+SELECT 2 o, row_number() over (order by c_f8 asc nulls first) rn, c_f8 v FROM strom_radix
+UNION ALL
+SELECT 3 o, row_number() over (order by c_f8 desc nulls first) rn, c_f8 v FROM strom_radix
+UNION ALL
+SELECT 4 o, row_number() over (order by c_f8 desc nulls last) rn, c_f8 v FROM strom_radix;
+reset pg_strom.enabled;
+
+SELECT count(*) = 4 * 40000 AS nrows FROM radix_gpu_float8;
+SELECT count(*) FROM (SELECT * FROM radix_gpu_float8 EXCEPT ALL
+                      SELECT * FROM radix_cpu_float8) d;
+SELECT count(*) FROM (SELECT * FROM radix_cpu_float8 EXCEPT ALL
+                      SELECT * FROM radix_gpu_float8) d;
+
+DROP TABLE strom_radix;
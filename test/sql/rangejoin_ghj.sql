@@ -0,0 +1,138 @@
+--#
+--#       GpuNestLoop TestCases with/without range-join
+--#
+
+set pg_strom.gpu_setup_cost=0;
+set pg_strom.enable_gpuhashjoin to off;
+set pg_strom.enable_gpupreagg to off;
+set pg_strom.enable_gpusort to off;
+set enable_hashjoin to off;
+set enable_mergejoin to off;
+set random_page_cost=1000000;   --# force off index_scan.
+set client_min_messages to warning;
+
+DROP TABLE IF EXISTS strom_range_outer;
+DROP TABLE IF EXISTS strom_range_inner;
+CREATE TABLE strom_range_outer (
+       id integer,
+       a  integer,
+       b  bigint
+);
+CREATE TABLE strom_range_inner (
+       id integer,
+       k  integer,
+       k8 bigint
+);
+INSERT INTO strom_range_outer SELECT
+       x,
+       case when x % 31 = 0 then null else (x * 7) % 1000 end,
+       (x * 13) % 1000
+  FROM generate_series(1,2000) x;
+INSERT INTO strom_range_inner SELECT
+       x,
+       case when x % 17 = 0 then null else (x * 11) % 1000 end,
+       case when x % 19 = 0 then null else (x * 3) % 1000 end
+  FROM generate_series(1,3000) x;
+ANALYZE strom_range_outer;
+ANALYZE strom_range_inner;
+
+--# INNER JOIN with BETWEEN
+CREATE TEMP TABLE range_on1 AS
+SELECT o.id o_id, i.id i_id FROM strom_range_outer o JOIN strom_range_inner i
+    ON i.k BETWEEN o.a - 2 AND o.a + 2;
+set pg_strom.enable_gpujoin_range to off;
+CREATE TEMP TABLE range_off1 AS
+SELECT o.id o_id, i.id i_id FROM strom_range_outer o JOIN strom_range_inner i
+    ON i.k BETWEEN o.a - 2 AND o.a + 2;
+reset pg_strom.enable_gpujoin_range;
+
+SELECT count(*) > 0 AS nonempty FROM range_on1;
+SELECT count(*) FROM (SELECT * FROM range_on1 EXCEPT ALL
+                      SELECT * FROM range_off1) d;
+SELECT count(*) FROM (SELECT * FROM range_off1 EXCEPT ALL
+                      SELECT * FROM range_on1) d;
+
+--# LEFT JOIN with BETWEEN; also NULL outer keys
+CREATE TEMP TABLE range_on2 AS
+SELECT o.id o_id, i.id i_id FROM strom_range_outer o LEFT JOIN strom_range_inner i
+    ON i.k BETWEEN o.a AND o.a + 1;
+set pg_strom.enable_gpujoin_range to off;
+CREATE TEMP TABLE range_off2 AS
+SELECT o.id o_id, i.id i_id FROM strom_range_outer o LEFT JOIN strom_range_inner i
+    ON i.k BETWEEN o.a AND o.a + 1;
+reset pg_strom.enable_gpujoin_range;
+
+SELECT count(*) > 0 AS nonempty FROM range_on2 WHERE i_id IS NULL;
+SELECT count(*) FROM (SELECT * FROM range_on2 EXCEPT ALL
+                      SELECT * FROM range_off2) d;
+SELECT count(*) FROM (SELECT * FROM range_off2 EXCEPT ALL
+                      SELECT * FROM range_on2) d;
+
+--# commuted form (expr < Var)
+CREATE TEMP TABLE range_on3 AS
+SELECT o.id o_id, i.id i_id FROM strom_range_outer o JOIN strom_range_inner i
+    ON o.a + 3 < i.k AND o.a + 6 >= i.k;
+set pg_strom.enable_gpujoin_range to off;
+CREATE TEMP TABLE range_off3 AS
+SELECT o.id o_id, i.id i_id FROM strom_range_outer o JOIN strom_range_inner i
+    ON o.a + 3 < i.k AND o.a + 6 >= i.k;
+reset pg_strom.enable_gpujoin_range;
+
+SELECT count(*) > 0 AS nonempty FROM range_on3;
+SELECT count(*) FROM (SELECT * FROM range_on3 EXCEPT ALL
+                      SELECT * FROM range_off3) d;
+SELECT count(*) FROM (SELECT * FROM range_off3 EXCEPT ALL
+                      SELECT * FROM range_on3) d;
+
+--# equality only
+CREATE TEMP TABLE range_on4 AS
+SELECT o.id o_id, i.id i_id FROM strom_range_outer o LEFT JOIN strom_range_inner i
+    ON i.k = o.a;
+set pg_strom.enable_gpujoin_range to off;
+CREATE TEMP TABLE range_off4 AS
+SELECT o.id o_id, i.id i_id FROM strom_range_outer o LEFT JOIN strom_range_inner i
+    ON i.k = o.a;
+reset pg_strom.enable_gpujoin_range;
+
+SELECT count(*) > 0 AS nonempty FROM range_on4;
+SELECT count(*) FROM (SELECT * FROM range_on4 EXCEPT ALL
+                      SELECT * FROM range_off4) d;
+SELECT count(*) FROM (SELECT * FROM range_off4 EXCEPT ALL
+                      SELECT * FROM range_on4) d;
+
+--# NULL inner keys must never match, even on one-side bound
+CREATE TEMP TABLE range_on5 AS
+SELECT o.id o_id, i.id i_id FROM strom_range_outer o LEFT JOIN strom_range_inner i
+    ON i.k < o.a - 990
+ WHERE o.id <= 500;
+set pg_strom.enable_gpujoin_range to off;
+CREATE TEMP TABLE range_off5 AS
+SELECT o.id o_id, i.id i_id FROM strom_range_outer o LEFT JOIN strom_range_inner i
+    ON i.k < o.a - 990
+ WHERE o.id <= 500;
+reset pg_strom.enable_gpujoin_range;
+
+SELECT count(*) > 0 AS nonempty FROM range_on5 WHERE i_id IS NOT NULL;
+SELECT count(*) FROM (SELECT * FROM range_on5 EXCEPT ALL
+                      SELECT * FROM range_off5) d;
+SELECT count(*) FROM (SELECT * FROM range_off5 EXCEPT ALL
+                      SELECT * FROM range_on5) d;
+
+--# cross-type comparison (int8 Var / int4 expr, int4 Var / int8 expr)
+CREATE TEMP TABLE range_on6 AS
+SELECT o.id o_id, i.id i_id FROM strom_range_outer o JOIN strom_range_inner i
+    ON i.k8 >= o.a AND i.k8 < o.a + 2 AND i.k <= o.b;
+set pg_strom.enable_gpujoin_range to off;
+CREATE TEMP TABLE range_off6 AS
+SELECT o.id o_id, i.id i_id FROM strom_range_outer o JOIN strom_range_inner i
+    ON i.k8 >= o.a AND i.k8 < o.a + 2 AND i.k <= o.b;
+reset pg_strom.enable_gpujoin_range;
+
+SELECT count(*) > 0 AS nonempty FROM range_on6;
+SELECT count(*) FROM (SELECT * FROM range_on6 EXCEPT ALL
+                      SELECT * FROM range_off6) d;
+SELECT count(*) FROM (SELECT * FROM range_off6 EXCEPT ALL
+                      SELECT * FROM range_on6) d;
+
+DROP TABLE strom_range_outer;
+DROP TABLE strom_range_inner;
@@ -0,0 +1,129 @@
+--#
+--#       GpuHashJoin TestCases with/without heavy-hitter keys
+--#
+
+set pg_strom.gpu_setup_cost=0;
+set pg_strom.enable_gpunestloop to off;
+set pg_strom.enable_gpupreagg to off;
+set pg_strom.enable_gpusort to off;
+set enable_nestloop to off;
+set enable_mergejoin to off;
+set random_page_cost=1000000;   --# force off index_scan.
+set client_min_messages to warning;
+
+DROP TABLE IF EXISTS strom_skew_outer;
+DROP TABLE IF EXISTS strom_skew_inner1;
+DROP TABLE IF EXISTS strom_skew_inner2;
+CREATE TABLE strom_skew_outer (
+       id integer,
+       a  integer
+);
+CREATE TABLE strom_skew_inner1 (
+       id integer,
+       k  integer
+);
+CREATE TABLE strom_skew_inner2 (
+       id integer,
+       k  integer
+);
+INSERT INTO strom_skew_outer SELECT
+       x,
+       case when x % 31 = 0 then null else x % 3000 end
+  FROM generate_series(1,6000) x;
+--# key=0 by 1000 rows, key=1 by 300 rows, key=2 by 255 rows (not heavy),
+--# and unique keys for the rest
+INSERT INTO strom_skew_inner1 SELECT
+       x,
+       case when x <= 1000 then 0
+            when x <= 1300 then 1
+            when x <= 1555 then 2
+            when x % 23 = 0 then null
+            else x end
+  FROM generate_series(1,4000) x;
+--# more heavy-hitter keys (40 keys by 260 rows) than tracked per chunk
+INSERT INTO strom_skew_inner2 SELECT
+       x,
+       x % 40
+  FROM generate_series(1,10400) x;
+ANALYZE strom_skew_outer;
+ANALYZE strom_skew_inner1;
+ANALYZE strom_skew_inner2;
+
+--# INNER JOIN
+CREATE TEMP TABLE skew_on1 AS
+SELECT o.id o_id, i.id i_id FROM strom_skew_outer o JOIN strom_skew_inner1 i
+    ON o.a = i.k;
+set pg_strom.enable_gpujoin_heavy_hitter to off;
+CREATE TEMP TABLE skew_off1 AS
+SELECT o.id o_id, i.id i_id FROM strom_skew_outer o JOIN strom_skew_inner1 i
+    ON o.a = i.k;
+reset pg_strom.enable_gpujoin_heavy_hitter;
+set pg_strom.enabled to off;
+CREATE TEMP TABLE skew_cpu1 AS
+SELECT o.id o_id, i.id i_id FROM strom_skew_outer o JOIN strom_skew_inner1 i
+    ON o.a = i.k;
+reset pg_strom.enabled;
+
+SELECT count(*) > 0 AS nonempty FROM skew_on1 WHERE i_id <= 1000;
+SELECT count(*) FROM (SELECT * FROM skew_on1 EXCEPT ALL
+                      SELECT * FROM skew_cpu1) d;
+SELECT count(*) FROM (SELECT * FROM skew_cpu1 EXCEPT ALL
+                      SELECT * FROM skew_on1) d;
+SELECT count(*) FROM (SELECT * FROM skew_off1 EXCEPT ALL
+                      SELECT * FROM skew_cpu1) d;
+SELECT count(*) FROM (SELECT * FROM skew_cpu1 EXCEPT ALL
+                      SELECT * FROM skew_off1) d;
+
+--# LEFT JOIN
+CREATE TEMP TABLE skew_on2 AS
+SELECT o.id o_id, i.id i_id FROM strom_skew_outer o LEFT JOIN strom_skew_inner1 i
+    ON o.a = i.k;
+set pg_strom.enable_gpujoin_heavy_hitter to off;
+CREATE TEMP TABLE skew_off2 AS
+SELECT o.id o_id, i.id i_id FROM strom_skew_outer o LEFT JOIN strom_skew_inner1 i
+    ON o.a = i.k;
+reset pg_strom.enable_gpujoin_heavy_hitter;
+set pg_strom.enabled to off;
+CREATE TEMP TABLE skew_cpu2 AS
+SELECT o.id o_id, i.id i_id FROM strom_skew_outer o LEFT JOIN strom_skew_inner1 i
+    ON o.a = i.k;
+reset pg_strom.enabled;
+
+SELECT count(*) > 0 AS nonempty FROM skew_on2 WHERE i_id IS NULL;
+SELECT count(*) FROM (SELECT * FROM skew_on2 EXCEPT ALL
+                      SELECT * FROM skew_cpu2) d;
+SELECT count(*) FROM (SELECT * FROM skew_cpu2 EXCEPT ALL
+                      SELECT * FROM skew_on2) d;
+SELECT count(*) FROM (SELECT * FROM skew_off2 EXCEPT ALL
+                      SELECT * FROM skew_cpu2) d;
+SELECT count(*) FROM (SELECT * FROM skew_cpu2 EXCEPT ALL
+                      SELECT * FROM skew_off2) d;
+
+--# INNER JOIN with more heavy-hitters than tracked
+CREATE TEMP TABLE skew_on3 AS
+SELECT o.id o_id, i.id i_id FROM strom_skew_outer o JOIN strom_skew_inner2 i
+    ON o.a = i.k;
+set pg_strom.enable_gpujoin_heavy_hitter to off;
+CREATE TEMP TABLE skew_off3 AS
+SELECT o.id o_id, i.id i_id FROM strom_skew_outer o JOIN strom_skew_inner2 i
+    ON o.a = i.k;
+reset pg_strom.enable_gpujoin_heavy_hitter;
+set pg_strom.enabled to off;
+CREATE TEMP TABLE skew_cpu3 AS
+SELECT o.id o_id, i.id i_id FROM strom_skew_outer o JOIN strom_skew_inner2 i
+    ON o.a = i.k;
+reset pg_strom.enabled;
+
+SELECT count(*) > 0 AS nonempty FROM skew_on3;
+SELECT count(*) FROM (SELECT * FROM skew_on3 EXCEPT ALL
+                      SELECT * FROM skew_cpu3) d;
+SELECT count(*) FROM (SELECT * FROM skew_cpu3 EXCEPT ALL
+                      SELECT * FROM skew_on3) d;
+SELECT count(*) FROM (SELECT * FROM skew_off3 EXCEPT ALL
+                      SELECT * FROM skew_cpu3) d;
+SELECT count(*) FROM (SELECT * FROM skew_cpu3 EXCEPT ALL
+                      SELECT * FROM skew_off3) d;
+
+DROP TABLE strom_skew_outer;
+DROP TABLE strom_skew_inner1;
+DROP TABLE strom_skew_inner2;
@@ -0,0 +1,92 @@
+--#
+--#       GpuHashJoin TestCases with/without outer spill on split inner
+--#
+
+set pg_strom.gpu_setup_cost=0;
+set pg_strom.enable_gpunestloop to off;
+set pg_strom.enable_gpupreagg to off;
+set pg_strom.enable_gpusort to off;
+set enable_nestloop to off;
+set enable_mergejoin to off;
+set random_page_cost=1000000;   --# force off index_scan.
+set client_min_messages to warning;
+--# small enough to split the inner hash table to multiple chunks
+set pg_strom.debug_gpujoin_inner_limit = '256kB';
+
+DROP TABLE IF EXISTS strom_spill_outer;
+DROP TABLE IF EXISTS strom_spill_inner;
+CREATE TABLE strom_spill_outer (
+       id integer,
+       a  integer,
+       t  text
+);
+CREATE TABLE strom_spill_inner (
+       id integer,
+       k  integer,
+       t  text
+);
+INSERT INTO strom_spill_outer SELECT
+       x,
+       case when x % 29 = 0 then null else (x * 7) % 25000 end,
+       md5(x::text)
+  FROM generate_series(1,30000) x;
+INSERT INTO strom_spill_inner SELECT
+       x,
+       case when x % 23 = 0 then null else (x * 3) % 20000 end,
+       md5((x * 5)::text)
+  FROM generate_series(1,20000) x;
+ANALYZE strom_spill_outer;
+ANALYZE strom_spill_inner;
+
+--# INNER JOIN
+CREATE TEMP TABLE spill_on1 AS
+SELECT o.id o_id, i.id i_id, i.t FROM strom_spill_outer o JOIN strom_spill_inner i
+    ON o.a = i.k;
+set pg_strom.enable_gpujoin_spill to off;
+CREATE TEMP TABLE spill_off1 AS
+SELECT o.id o_id, i.id i_id, i.t FROM strom_spill_outer o JOIN strom_spill_inner i
+    ON o.a = i.k;
+reset pg_strom.enable_gpujoin_spill;
+set pg_strom.enabled to off;
+CREATE TEMP TABLE spill_cpu1 AS
+SELECT o.id o_id, i.id i_id, i.t FROM strom_spill_outer o JOIN strom_spill_inner i
+    ON o.a = i.k;
+reset pg_strom.enabled;
+
+SELECT count(*) > 0 AS nonempty FROM spill_on1;
+SELECT count(*) FROM (SELECT * FROM spill_on1 EXCEPT ALL
+                      SELECT * FROM spill_cpu1) d;
+SELECT count(*) FROM (SELECT * FROM spill_cpu1 EXCEPT ALL
+                      SELECT * FROM spill_on1) d;
+SELECT count(*) FROM (SELECT * FROM spill_off1 EXCEPT ALL
+                      SELECT * FROM spill_cpu1) d;
+SELECT count(*) FROM (SELECT * FROM spill_cpu1 EXCEPT ALL
+                      SELECT * FROM spill_off1) d;
+
+--# LEFT JOIN; every outer row shall appear once, even if unmatched
+CREATE TEMP TABLE spill_on2 AS
+SELECT o.id o_id, i.id i_id FROM strom_spill_outer o LEFT JOIN strom_spill_inner i
+    ON o.a = i.k;
+set pg_strom.enable_gpujoin_spill to off;
+CREATE TEMP TABLE spill_off2 AS
+SELECT o.id o_id, i.id i_id FROM strom_spill_outer o LEFT JOIN strom_spill_inner i
+    ON o.a = i.k;
+reset pg_strom.enable_gpujoin_spill;
+set pg_strom.enabled to off;
+CREATE TEMP TABLE spill_cpu2 AS
+SELECT o.id o_id, i.id i_id FROM strom_spill_outer o LEFT JOIN strom_spill_inner i
+    ON o.a = i.k;
+reset pg_strom.enabled;
+
+SELECT count(*) > 0 AS nonempty FROM spill_on2 WHERE i_id IS NULL;
+SELECT count(*) FROM (SELECT * FROM spill_on2 EXCEPT ALL
+                      SELECT * FROM spill_cpu2) d;
+SELECT count(*) FROM (SELECT * FROM spill_cpu2 EXCEPT ALL
+                      SELECT * FROM spill_on2) d;
+SELECT count(*) FROM (SELECT * FROM spill_off2 EXCEPT ALL
+                      SELECT * FROM spill_cpu2) d;
+SELECT count(*) FROM (SELECT * FROM spill_cpu2 EXCEPT ALL
+                      SELECT * FROM spill_off2) d;
+
+DROP TABLE strom_spill_outer;
+DROP TABLE strom_spill_inner;
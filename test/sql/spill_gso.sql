@@ -0,0 +1,93 @@
+--#
+--#       GpuSort TestCases with sorted segments spilled to temporary files
+--#
+
+set pg_strom.debug_force_gpusort to on;
+set pg_strom.gpu_setup_cost=0;
+set random_page_cost=1000000;   --# force off index_scan.
+set pg_strom.enable_gpusort to on;
+set client_min_messages to warning;
+
+DROP TABLE IF EXISTS strom_spill_sort;
+CREATE TABLE strom_spill_sort (
+       id integer,
+       a  integer,
+       t  text
+);
+INSERT INTO strom_spill_sort SELECT
+       x,
+       case when x % 157 = 0 then null else (x * 37) % 5000 end,
+       case when x % 113 = 0 then null else repeat(md5(x::text), 4) end
+  FROM generate_series(1,200000) x;
+ANALYZE strom_spill_sort;
+
+--# single key, radix sort
+--# every sorted segment shall be spilled out
+set pg_strom.gpusort_spill_threshold = '1kB';
+CREATE TEMP TABLE sort_spill1 AS
+SELECT a, row_number() over (order by a) rn FROM strom_spill_sort;
+reset pg_strom.gpusort_spill_threshold;
+CREATE TEMP TABLE sort_nospill1 AS
+SELECT a, row_number() over (order by a) rn FROM strom_spill_sort;
+set pg_strom.enabled to off;
+CREATE TEMP TABLE sort_cpu1 AS
+SELECT a, row_number() over (order by a) rn FROM strom_spill_sort;
+reset pg_strom.enabled;
+
+SELECT count(*) FROM sort_spill1;
+SELECT count(*) FROM (SELECT * FROM sort_spill1 EXCEPT ALL
+                      SELECT * FROM sort_cpu1) d;
+SELECT count(*) FROM (SELECT * FROM sort_cpu1 EXCEPT ALL
+                      SELECT * FROM sort_spill1) d;
+SELECT count(*) FROM (SELECT * FROM sort_nospill1 EXCEPT ALL
+                      SELECT * FROM sort_cpu1) d;
+SELECT count(*) FROM (SELECT * FROM sort_cpu1 EXCEPT ALL
+                      SELECT * FROM sort_nospill1) d;
+
+--# multiple keys with varlena
+--# every sorted segment shall be spilled out
+set pg_strom.gpusort_spill_threshold = '1kB';
+CREATE TEMP TABLE sort_spill2 AS
+SELECT a, t, row_number() over (order by a DESC NULLS FIRST, t) rn FROM strom_spill_sort;
+reset pg_strom.gpusort_spill_threshold;
+CREATE TEMP TABLE sort_nospill2 AS
+SELECT a, t, row_number() over (order by a DESC NULLS FIRST, t) rn FROM strom_spill_sort;
+set pg_strom.enabled to off;
+CREATE TEMP TABLE sort_cpu2 AS
+SELECT a, t, row_number() over (order by a DESC NULLS FIRST, t) rn FROM strom_spill_sort;
+reset pg_strom.enabled;
+
+SELECT count(*) FROM sort_spill2;
+SELECT count(*) FROM (SELECT * FROM sort_spill2 EXCEPT ALL
+                      SELECT * FROM sort_cpu2) d;
+SELECT count(*) FROM (SELECT * FROM sort_cpu2 EXCEPT ALL
+                      SELECT * FROM sort_spill2) d;
+SELECT count(*) FROM (SELECT * FROM sort_nospill2 EXCEPT ALL
+                      SELECT * FROM sort_cpu2) d;
+SELECT count(*) FROM (SELECT * FROM sort_cpu2 EXCEPT ALL
+                      SELECT * FROM sort_nospill2) d;
+
+--# varlena key; wide rows
+--# every sorted segment shall be spilled out
+set pg_strom.gpusort_spill_threshold = '1kB';
+CREATE TEMP TABLE sort_spill3 AS
+SELECT t, row_number() over (order by t) rn FROM strom_spill_sort;
+reset pg_strom.gpusort_spill_threshold;
+CREATE TEMP TABLE sort_nospill3 AS
+SELECT t, row_number() over (order by t) rn FROM strom_spill_sort;
+set pg_strom.enabled to off;
+CREATE TEMP TABLE sort_cpu3 AS
+SELECT t, row_number() over (order by t) rn FROM strom_spill_sort;
+reset pg_strom.enabled;
+
+SELECT count(*) FROM sort_spill3;
+SELECT count(*) FROM (SELECT * FROM sort_spill3 EXCEPT ALL
+                      SELECT * FROM sort_cpu3) d;
+SELECT count(*) FROM (SELECT * FROM sort_cpu3 EXCEPT ALL
+                      SELECT * FROM sort_spill3) d;
+SELECT count(*) FROM (SELECT * FROM sort_nospill3 EXCEPT ALL
+                      SELECT * FROM sort_cpu3) d;
+SELECT count(*) FROM (SELECT * FROM sort_cpu3 EXCEPT ALL
+                      SELECT * FROM sort_nospill3) d;
+
+DROP TABLE strom_spill_sort;
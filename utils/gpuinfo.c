@@ -184,7 +184,7 @@ static struct
 	ATTR_ENTRY(CU_DEVICE_ATTRIBUTE_MAXIMUM_TEXTURE3D_DEPTH_ALTERNATE,
 			   "Alternate maximum 3D texture depth", INT, 1),
 	ATTR_ENTRY(CU_DEVICE_ATTRIBUTE_PCI_DOMAIN_ID,
-			   "PCI domain ID of the device", INT, 1),
+			   "PCI domain ID of the device", INT, 0),
 	ATTR_ENTRY(CU_DEVICE_ATTRIBUTE_TEXTURE_PITCH_ALIGNMENT,
 			   "Pitch alignment requirement for textures", INT, 1),
 	ATTR_ENTRY(CU_DEVICE_ATTRIBUTE_MAXIMUM_TEXTURECUBEMAP_WIDTH,